@@ -18,7 +18,11 @@
 #define LOG_TAG "BootAnimation"
 #define ATRACE_TAG ATRACE_TAG_GRAPHICS
 
+#include <condition_variable>
 #include <filesystem>
+#include <mutex>
+#include <optional>
+#include <thread>
 #include <vector>
 
 #include <stdint.h>
@@ -289,6 +293,124 @@ static void* decodeImage(const void* encodedData, size_t dataLength, AndroidBitm
     return pixels;
 }
 
+namespace {
+
+// How many frames of a part may be decoded ahead of the one being drawn. Decoded frames are held
+// as raw pixels, so this is kept to the few needed to absorb a slow decode.
+constexpr size_t kDecodeAheadFrames = 3;
+
+struct DecodedFrame {
+    std::unique_ptr<void, decltype(free)*> pixels{nullptr, free};
+    AndroidBitmapInfo info{};
+};
+
+// Decodes the frames of a part in order on its own thread, so that decoding overlaps with drawing
+// and with waiting for the next vsync instead of adding to the time of each frame.
+class FrameDecoder {
+public:
+    explicit FrameDecoder(std::vector<FileMap*> maps)
+          : mMaps(std::move(maps)), mThread([this] { run(); }) {}
+
+    ~FrameDecoder() {
+        {
+            std::lock_guard lock(mLock);
+            mStopped = true;
+        }
+        mCondition.notify_all();
+        mThread.join();
+    }
+
+    // Returns the next frame, waiting for it to be decoded if necessary. Its pixels are null if
+    // it could not be decoded.
+    DecodedFrame next() {
+        std::unique_lock lock(mLock);
+        mCondition.wait(lock, [this] { return !mDecoded.empty(); });
+        DecodedFrame frame = std::move(mDecoded.front());
+        mDecoded.pop();
+        mCondition.notify_all();
+        return frame;
+    }
+
+private:
+    void run() {
+        for (FileMap* map : mMaps) {
+            {
+                std::unique_lock lock(mLock);
+                mCondition.wait(lock, [this] {
+                    return mStopped || mDecoded.size() < kDecodeAheadFrames;
+                });
+                if (mStopped) return;
+            }
+            DecodedFrame frame;
+            // Set decoding option to alpha unpremultiplied so that the R, G, B channels
+            // of transparent pixels are preserved.
+            frame.pixels.reset(decodeImage(map->getDataPtr(), map->getDataLength(), &frame.info,
+                                           false /* don't premultiply alpha */));
+            // FileMap memory is never released until application exit.
+            // Release it now as the packed frame is no longer needed.
+            delete map;
+            {
+                std::lock_guard lock(mLock);
+                mDecoded.push(std::move(frame));
+            }
+            mCondition.notify_all();
+        }
+    }
+
+    const std::vector<FileMap*> mMaps;
+    std::mutex mLock;
+    std::condition_variable mCondition;
+    std::queue<DecodedFrame> mDecoded;  // GUARDED_BY(mLock)
+    bool mStopped = false;              // GUARDED_BY(mLock)
+    std::thread mThread;                // last, as it starts running on construction
+};
+
+// Uploads decoded pixels to the currently bound texture.
+void uploadTexture(const void* pixels, const AndroidBitmapInfo& bitmapInfo, bool useNpotTextures) {
+    const int w = bitmapInfo.width;
+    const int h = bitmapInfo.height;
+
+    int tw = 1 << (31 - __builtin_clz(w));
+    int th = 1 << (31 - __builtin_clz(h));
+    if (tw < w) tw <<= 1;
+    if (th < h) th <<= 1;
+
+    switch (bitmapInfo.format) {
+        case ANDROID_BITMAP_FORMAT_RGBA_8888:
+            if (!useNpotTextures && (tw != w || th != h)) {
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tw, th, 0, GL_RGBA,
+                        GL_UNSIGNED_BYTE, nullptr);
+                glTexSubImage2D(GL_TEXTURE_2D, 0,
+                        0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+            } else {
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA,
+                        GL_UNSIGNED_BYTE, pixels);
+            }
+            break;
+
+        case ANDROID_BITMAP_FORMAT_RGB_565:
+            if (!useNpotTextures && (tw != w || th != h)) {
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, tw, th, 0, GL_RGB,
+                        GL_UNSIGNED_SHORT_5_6_5, nullptr);
+                glTexSubImage2D(GL_TEXTURE_2D, 0,
+                        0, 0, w, h, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, pixels);
+            } else {
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, w, h, 0, GL_RGB,
+                        GL_UNSIGNED_SHORT_5_6_5, pixels);
+            }
+            break;
+        default:
+            break;
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+} // namespace
+
 status_t BootAnimation::initTexture(Texture* texture, AssetManager& assets,
         const char* name, bool premultiplyAlpha) {
     ATRACE_CALL();
@@ -363,47 +485,10 @@ status_t BootAnimation::initTexture(FileMap* map, int* width, int* height,
         return NO_INIT;
     }
 
+    uploadTexture(pixels, bitmapInfo, mUseNpotTextures);
+
     const int w = bitmapInfo.width;
     const int h = bitmapInfo.height;
-
-    int tw = 1 << (31 - __builtin_clz(w));
-    int th = 1 << (31 - __builtin_clz(h));
-    if (tw < w) tw <<= 1;
-    if (th < h) th <<= 1;
-
-    switch (bitmapInfo.format) {
-        case ANDROID_BITMAP_FORMAT_RGBA_8888:
-            if (!mUseNpotTextures && (tw != w || th != h)) {
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tw, th, 0, GL_RGBA,
-                        GL_UNSIGNED_BYTE, nullptr);
-                glTexSubImage2D(GL_TEXTURE_2D, 0,
-                        0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
-            } else {
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA,
-                        GL_UNSIGNED_BYTE, pixels);
-            }
-            break;
-
-        case ANDROID_BITMAP_FORMAT_RGB_565:
-            if (!mUseNpotTextures && (tw != w || th != h)) {
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, tw, th, 0, GL_RGB,
-                        GL_UNSIGNED_SHORT_5_6_5, nullptr);
-                glTexSubImage2D(GL_TEXTURE_2D, 0,
-                        0, 0, w, h, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, pixels);
-            } else {
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, w, h, 0, GL_RGB,
-                        GL_UNSIGNED_SHORT_5_6_5, pixels);
-            }
-            break;
-        default:
-            break;
-    }
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
     *width = w;
     *height = h;
 
@@ -1587,6 +1672,7 @@ bool BootAnimation::playAnimation(const Animation& animation) {
 
     int fadedFramesCount = 0;
     int lastDisplayedProgress = 0;
+    size_t missedFrames = 0;
     int colorTransitionStart = animation.colorTransitionStart;
     int colorTransitionEnd = animation.colorTransitionEnd;
     for (size_t i=0 ; i<pcount ; i++) {
@@ -1641,6 +1727,20 @@ bool BootAnimation::playAnimation(const Animation& animation) {
             bool displayProgress = animation.progressEnabled &&
                 (i == (pcount -1)) && currentProgress != 0;
 
+            // The first time through, the frames of the part are decoded ahead of drawing them.
+            std::optional<FrameDecoder> decoder;
+            if (r == 0) {
+                std::vector<FileMap*> maps;
+                maps.reserve(fcount);
+                for (size_t j = 0; j < fcount; j++) {
+                    maps.push_back(part.frames[j].map);
+                }
+                decoder.emplace(std::move(maps));
+            }
+
+            // Frames are paced against a deadline that advances by frameDuration, so the time
+            // spent sleeping and waking up is not added to every frame.
+            nsecs_t nextFrameTime = systemTime();
             for (size_t j=0 ; j<fcount ; j++) {
                 if (shouldStopPlayingPart(part, fadedFramesCount, lastDisplayedProgress)) break;
 
@@ -1664,7 +1764,7 @@ bool BootAnimation::playAnimation(const Animation& animation) {
                 const int animationY = (mHeight - animation.height * ratio_h) / 2;
 
                 const Animation::Frame& frame(part.frames[j]);
-                nsecs_t lastFrame = systemTime();
+                nextFrameTime += frameDuration;
 
                 if (r > 0) {
                     glBindTexture(GL_TEXTURE_2D, frame.tid);
@@ -1673,10 +1773,10 @@ bool BootAnimation::playAnimation(const Animation& animation) {
                         glGenTextures(1, &frame.tid);
                         glBindTexture(GL_TEXTURE_2D, frame.tid);
                     }
-                    int w, h;
-                    // Set decoding option to alpha unpremultiplied so that the R, G, B channels
-                    // of transparent pixels are preserved.
-                    initTexture(frame.map, &w, &h, false /* don't premultiply alpha */);
+                    DecodedFrame decoded = decoder->next();
+                    if (decoded.pixels != nullptr) {
+                        uploadTexture(decoded.pixels.get(), decoded.info, mUseNpotTextures);
+                    }
                 }
 
                 const int trimWidth = frame.trimWidth * ratio_w;
@@ -1734,18 +1834,23 @@ bool BootAnimation::playAnimation(const Animation& animation) {
                 eglSwapBuffers(mDisplay, mSurface);
 
                 nsecs_t now = systemTime();
-                nsecs_t delay = frameDuration - (now - lastFrame);
-                //SLOGD("%lld, %lld", ns2ms(now - lastFrame), ns2ms(delay));
-                lastFrame = now;
-
-                if (delay > 0) {
+                if (now < nextFrameTime) {
                     struct timespec spec;
-                    spec.tv_sec  = (now + delay) / 1000000000;
-                    spec.tv_nsec = (now + delay) % 1000000000;
+                    spec.tv_sec  = nextFrameTime / 1000000000;
+                    spec.tv_nsec = nextFrameTime % 1000000000;
                     int err;
                     do {
                         err = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &spec, nullptr);
                     } while (err == EINTR);
+                } else {
+                    // The frame is late. Start over from now rather than rushing the frames
+                    // that follow to catch up. The progress display slows down the animation
+                    // on purpose, so it does not count as a miss.
+                    if (!displayProgress && now - nextFrameTime >= frameDuration) {
+                        missedFrames++;
+                        ATRACE_INT("BootAnimationMissedFrames", missedFrames);
+                    }
+                    nextFrameTime = now;
                 }
 
                 checkExit();
@@ -1787,6 +1892,7 @@ bool BootAnimation::playAnimation(const Animation& animation) {
 
     ALOGD("%sAnimationShownTiming End time: %" PRId64 "ms", mShuttingDown ? "Shutdown" : "Boot",
             elapsedRealtime());
+    ALOGD("%sAnimation missed %zu frames", mShuttingDown ? "Shutdown" : "Boot", missedFrames);
 
     return true;
 }
@@ -19,14 +19,19 @@
 #include <sys/stat.h>   // umask
 #include <sys/types.h>  // umask
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <limits>
 #include <memory>
+#include <numeric>
 #include <ostream>
 #include <string>
+#include <thread>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -54,6 +59,7 @@ using android::idmap2::utils::kIdmapCacheDir;
 using android::idmap2::utils::kIdmapFilePermissionMask;
 using android::idmap2::utils::RandomStringForPath;
 using android::idmap2::utils::UidHasWriteAccessToPath;
+using android::os::IdmapParams;
 
 using PolicyBitmask = android::ResTable_overlayable_policy_header::PolicyBitmask;
 
@@ -62,6 +68,15 @@ namespace {
 constexpr std::string_view kFrameworkPath = "/system/framework/framework-res.apk";
 constexpr std::string_view kLineagePath = "/system/framework/org.lineageos.platform-res.apk";
 
+// Every worker of a batched call may hold its own copy of a target, so keep their number small.
+constexpr size_t kMaxBatchWorkers = 4;
+
+// Overlays of one target are handed to workers in runs of at least this many.
+constexpr size_t kMinBatchRunSize = 8;
+
+// Parsed targets hold an AssetManager2 each, keep only the few that are reused the most.
+constexpr size_t kMaxCachedTargets = 8;
+
 Status ok() {
   return Status::ok();
 }
@@ -75,6 +90,68 @@ PolicyBitmask ConvertAidlArgToPolicyBitmask(int32_t arg) {
   return static_cast<PolicyBitmask>(arg);
 }
 
+std::unique_ptr<const IdmapHeader> ReadIdmapHeader(const std::string& idmap_path) {
+  std::ifstream fin(idmap_path);
+  std::unique_ptr<const IdmapHeader> header = IdmapHeader::FromBinaryStream(fin);
+  fin.close();
+  if (!header) {
+    LOG(WARNING) << "failed to parse idmap header of '" << idmap_path << "'";
+  }
+  return header;
+}
+
+bool IsIdmapUpToDate(const IdmapHeader& header, const TargetResourceContainer& target,
+                     const IdmapParams& params, const std::string& idmap_path) {
+  const auto overlay = OverlayResourceContainer::FromPath(params.overlay_path);
+  if (!overlay) {
+    LOG(WARNING) << "failed to load overlay '" << params.overlay_path << "'";
+    return false;
+  }
+
+  auto up_to_date = header.IsUpToDate(target, **overlay, params.overlay_name,
+                                      ConvertAidlArgToPolicyBitmask(params.fulfilled_policies),
+                                      params.enforce_overlayable);
+  if (!up_to_date) {
+    LOG(WARNING) << "idmap '" << idmap_path
+                 << "' not up to date : " << up_to_date.GetErrorMessage();
+  }
+  return static_cast<bool>(up_to_date);
+}
+
+// Maps the overlay onto the already loaded target and writes the idmap to idmap_path, which the
+// caller has checked for write access and unlinked.
+Status WriteIdmap(const TargetResourceContainer& target, const IdmapParams& params,
+                  const std::string& idmap_path, std::optional<std::string>* _aidl_return) {
+  const auto overlay = OverlayResourceContainer::FromPath(params.overlay_path);
+  if (!overlay) {
+    return error("failed to load apk overlay '%s'" + params.overlay_path);
+  }
+
+  const auto idmap = Idmap::FromContainers(target, **overlay, params.overlay_name,
+                                           ConvertAidlArgToPolicyBitmask(params.fulfilled_policies),
+                                           params.enforce_overlayable);
+  if (!idmap) {
+    return error(idmap.GetErrorMessage());
+  }
+
+  umask(kIdmapFilePermissionMask);
+  std::ofstream fout(idmap_path);
+  if (fout.fail()) {
+    return error("failed to open idmap path " + idmap_path);
+  }
+
+  BinaryStreamVisitor visitor(fout);
+  (*idmap)->accept(&visitor);
+  fout.close();
+  if (fout.fail()) {
+    unlink(idmap_path.c_str());
+    return error("failed to write to idmap path " + idmap_path);
+  }
+
+  *_aidl_return = idmap_path;
+  return ok();
+}
+
 }  // namespace
 
 namespace android::os {
@@ -84,6 +161,82 @@ const T* Idmap2Service::GetPointer(const OwningPtr<T>& ptr) {
     return std::visit([](auto&& ptr) { return ptr.get(); }, ptr);
 }
 
+template <typename Fn>
+void Idmap2Service::ForEachWithTarget(const std::vector<IdmapParams>& params, Fn&& fn) {
+  if (params.empty()) {
+    return;
+  }
+
+  // Visit the requests grouped by target, and hand them out in runs of the same target so that a
+  // worker loads each target at most once.
+  std::vector<size_t> order(params.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&params](size_t a, size_t b) {
+    return params[a].target_path < params[b].target_path;
+  });
+
+  const size_t worker_count =
+      std::min({kMaxBatchWorkers, size_t(std::max(1U, std::thread::hardware_concurrency())),
+                params.size()});
+  std::vector<std::pair<size_t, size_t>> runs;
+  for (size_t begin = 0; begin < order.size();) {
+    size_t end = begin + 1;
+    while (end < order.size() &&
+           params[order[end]].target_path == params[order[begin]].target_path) {
+      end++;
+    }
+    // Most overlays usually target framework-res, split them so that every worker gets a share.
+    const size_t run_size =
+        std::max(kMinBatchRunSize, (end - begin + worker_count - 1) / worker_count);
+    for (; begin < end; begin += run_size) {
+      runs.emplace_back(begin, std::min(begin + run_size, end));
+    }
+  }
+
+  std::mutex claimed_mutex;
+  std::unordered_set<std::string> claimed;
+  std::atomic<size_t> next_run = 0;
+  auto work = [&]() {
+    // A null container records a target that failed to load.
+    std::unordered_map<std::string, TargetResourceContainerPtr> targets;
+    for (size_t run; (run = next_run++) < runs.size();) {
+      for (size_t i = runs[run].first; i < runs[run].second; i++) {
+        const std::string& target_path = params[order[i]].target_path;
+        auto it = targets.find(target_path);
+        if (it == targets.end()) {
+          bool first_claim;
+          {
+            std::lock_guard lock(claimed_mutex);
+            first_claim = claimed.insert(target_path).second;
+          }
+          TargetResourceContainerPtr container;
+          if (first_claim) {
+            if (auto target = GetTargetContainer(target_path)) {
+              container = std::move(*target);
+            }
+          } else if (auto target = TargetResourceContainer::FromPath(target_path)) {
+            container = std::move(*target);
+          }
+          if (GetPointer(container) == nullptr) {
+            LOG(WARNING) << "failed to load target '" << target_path << "'";
+          }
+          it = targets.emplace(target_path, std::move(container)).first;
+        }
+        fn(GetPointer(it->second), order[i]);
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < worker_count; i++) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
 Status Idmap2Service::getIdmapPath(const std::string& overlay_path,
                                    int32_t user_id ATTRIBUTE_UNUSED, std::string* _aidl_return) {
   assert(_aidl_return);
@@ -119,12 +272,17 @@ Status Idmap2Service::verifyIdmap(const std::string& target_path, const std::str
   assert(_aidl_return);
 
   const std::string idmap_path = Idmap::CanonicalIdmapPathFor(kIdmapCacheDir, overlay_path);
-  std::ifstream fin(idmap_path);
-  const std::unique_ptr<const IdmapHeader> header = IdmapHeader::FromBinaryStream(fin);
-  fin.close();
+  const IdmapParams params{target_path, overlay_path, overlay_name, fulfilled_policies,
+                           enforce_overlayable};
+  if (IsKnownUpToDate(idmap_path, params)) {
+    *_aidl_return = true;
+    return ok();
+  }
+
+  const auto inputs = StampInputs(params);
+  const std::unique_ptr<const IdmapHeader> header = ReadIdmapHeader(idmap_path);
   if (!header) {
     *_aidl_return = false;
-    LOG(WARNING) << "failed to parse idmap header of '" << idmap_path << "'";
     return ok();
   }
 
@@ -135,21 +293,9 @@ Status Idmap2Service::verifyIdmap(const std::string& target_path, const std::str
     return ok();
   }
 
-  const auto overlay = OverlayResourceContainer::FromPath(overlay_path);
-  if (!overlay) {
-    *_aidl_return = false;
-    LOG(WARNING) << "failed to load overlay '" << overlay_path << "'";
-    return ok();
-  }
-
-  auto up_to_date =
-      header->IsUpToDate(*GetPointer(*target), **overlay, overlay_name,
-                         ConvertAidlArgToPolicyBitmask(fulfilled_policies), enforce_overlayable);
-
-  *_aidl_return = static_cast<bool>(up_to_date);
-  if (!up_to_date) {
-    LOG(WARNING) << "idmap '" << idmap_path
-                 << "' not up to date : " << up_to_date.GetErrorMessage();
+  *_aidl_return = IsIdmapUpToDate(*header, *GetPointer(*target), params, idmap_path);
+  if (*_aidl_return) {
+    MarkUpToDate(idmap_path, inputs);
   }
   return ok();
 }
@@ -162,8 +308,6 @@ Status Idmap2Service::createIdmap(const std::string& target_path, const std::str
   SYSTRACE << "Idmap2Service::createIdmap " << target_path << " " << overlay_path;
   _aidl_return->reset();
 
-  const PolicyBitmask policy_bitmask = ConvertAidlArgToPolicyBitmask(fulfilled_policies);
-
   const std::string idmap_path = Idmap::CanonicalIdmapPathFor(kIdmapCacheDir, overlay_path);
   const uid_t uid = IPCThreadState::self()->getCallingUid();
   if (!UidHasWriteAccessToPath(uid, idmap_path)) {
@@ -177,40 +321,162 @@ Status Idmap2Service::createIdmap(const std::string& target_path, const std::str
   // longer be usable.
   unlink(idmap_path.c_str());
 
+  const IdmapParams params{target_path, overlay_path, overlay_name, fulfilled_policies,
+                           enforce_overlayable};
+  const auto inputs = StampInputs(params);
   const auto target = GetTargetContainer(target_path);
   if (!target) {
     return error("failed to load target '%s'" + target_path);
   }
 
-  const auto overlay = OverlayResourceContainer::FromPath(overlay_path);
-  if (!overlay) {
-    return error("failed to load apk overlay '%s'" + overlay_path);
+  Status status = WriteIdmap(*GetPointer(*target), params, idmap_path, _aidl_return);
+  if (_aidl_return->has_value()) {
+    MarkUpToDate(idmap_path, inputs);
   }
+  return status;
+}
 
-  const auto idmap = Idmap::FromContainers(*GetPointer(*target), **overlay, overlay_name,
-                                           policy_bitmask, enforce_overlayable);
-  if (!idmap) {
-    return error(idmap.GetErrorMessage());
-  }
+Status Idmap2Service::createIdmaps(const std::vector<IdmapParams>& params,
+                                   int32_t user_id ATTRIBUTE_UNUSED,
+                                   std::vector<std::optional<std::string>>* _aidl_return) {
+  assert(_aidl_return);
+  SYSTRACE << "Idmap2Service::createIdmaps " << params.size();
+  _aidl_return->assign(params.size(), std::nullopt);
 
-  umask(kIdmapFilePermissionMask);
-  std::ofstream fout(idmap_path);
-  if (fout.fail()) {
-    return error("failed to open idmap path " + idmap_path);
+  // The calling uid is only known on the binder thread, so access is checked before the workers
+  // start. Each idmap is unlinked up front for the same reason createIdmap does it.
+  const uid_t uid = IPCThreadState::self()->getCallingUid();
+  std::vector<IdmapParams> writable;
+  std::vector<size_t> writable_indices;
+  std::vector<std::optional<VerifiedIdmap>> inputs;
+  for (size_t i = 0; i < params.size(); i++) {
+    const std::string idmap_path =
+        Idmap::CanonicalIdmapPathFor(kIdmapCacheDir, params[i].overlay_path);
+    if (!UidHasWriteAccessToPath(uid, idmap_path)) {
+      error(base::StringPrintf("will not write to %s: calling uid %d lacks write accesss",
+                               idmap_path.c_str(), uid));
+      continue;
+    }
+    unlink(idmap_path.c_str());
+    writable.push_back(params[i]);
+    writable_indices.push_back(i);
+    inputs.push_back(StampInputs(params[i]));
   }
 
-  BinaryStreamVisitor visitor(fout);
-  (*idmap)->accept(&visitor);
-  fout.close();
-  if (fout.fail()) {
-    unlink(idmap_path.c_str());
-    return error("failed to write to idmap path " + idmap_path);
+  ForEachWithTarget(writable, [&](const TargetResourceContainer* target, size_t i) {
+    if (target == nullptr) {
+      return;
+    }
+    // Failures are logged and leave the entry empty, they do not fail the other overlays.
+    const std::string idmap_path =
+        Idmap::CanonicalIdmapPathFor(kIdmapCacheDir, writable[i].overlay_path);
+    auto& result = (*_aidl_return)[writable_indices[i]];
+    WriteIdmap(*target, writable[i], idmap_path, &result);
+    if (result.has_value()) {
+      MarkUpToDate(idmap_path, inputs[i]);
+    }
+  });
+  return ok();
+}
+
+Status Idmap2Service::verifyIdmaps(const std::vector<IdmapParams>& params,
+                                   int32_t user_id ATTRIBUTE_UNUSED,
+                                   std::vector<bool>* _aidl_return) {
+  assert(_aidl_return);
+  SYSTRACE << "Idmap2Service::verifyIdmaps " << params.size();
+
+  // Not a std::vector<bool>, its elements cannot be written from several threads.
+  std::vector<uint8_t> up_to_date(params.size(), false);
+  std::vector<IdmapParams> unknown;
+  std::vector<size_t> unknown_indices;
+  std::vector<std::optional<VerifiedIdmap>> inputs;
+  for (size_t i = 0; i < params.size(); i++) {
+    const std::string idmap_path =
+        Idmap::CanonicalIdmapPathFor(kIdmapCacheDir, params[i].overlay_path);
+    if (IsKnownUpToDate(idmap_path, params[i])) {
+      up_to_date[i] = true;
+      continue;
+    }
+    unknown.push_back(params[i]);
+    unknown_indices.push_back(i);
+    inputs.push_back(StampInputs(params[i]));
   }
 
-  *_aidl_return = idmap_path;
+  ForEachWithTarget(unknown, [&](const TargetResourceContainer* target, size_t i) {
+    if (target == nullptr) {
+      return;
+    }
+    const std::string idmap_path =
+        Idmap::CanonicalIdmapPathFor(kIdmapCacheDir, unknown[i].overlay_path);
+    const auto header = ReadIdmapHeader(idmap_path);
+    if (header && IsIdmapUpToDate(*header, *target, unknown[i], idmap_path)) {
+      up_to_date[unknown_indices[i]] = true;
+      MarkUpToDate(idmap_path, inputs[i]);
+    }
+  });
+  _aidl_return->assign(up_to_date.begin(), up_to_date.end());
   return ok();
 }
 
+Idmap2Service::FileStamp Idmap2Service::FileStamp::FromStat(const struct stat& st) {
+  return FileStamp{
+      .dev = dev_t(st.st_dev),
+      .inode = ino_t(st.st_ino),
+      .size = st.st_size,
+      .mtime = st.st_mtim,
+  };
+}
+
+bool Idmap2Service::FileStamp::operator==(const FileStamp& other) const {
+  return dev == other.dev && inode == other.inode && size == other.size &&
+         mtime.tv_sec == other.mtime.tv_sec && mtime.tv_nsec == other.mtime.tv_nsec;
+}
+
+std::optional<Idmap2Service::FileStamp> Idmap2Service::StatFile(const std::string& path) {
+  struct stat st = {};
+  if (::stat(path.c_str(), &st) != 0) {
+    return std::nullopt;
+  }
+  return FileStamp::FromStat(st);
+}
+
+std::optional<Idmap2Service::VerifiedIdmap> Idmap2Service::StampInputs(
+    const IdmapParams& params) {
+  const auto target = StatFile(params.target_path);
+  const auto overlay = StatFile(params.overlay_path);
+  if (!target || !overlay) {
+    return std::nullopt;
+  }
+  return VerifiedIdmap{.params = params, .target = *target, .overlay = *overlay, .idmap = {}};
+}
+
+void Idmap2Service::MarkUpToDate(const std::string& idmap_path,
+                                 const std::optional<VerifiedIdmap>& inputs) {
+  const auto idmap = StatFile(idmap_path);
+  std::lock_guard lock(verified_idmaps_mutex_);
+  if (!inputs || !idmap) {
+    verified_idmaps_.erase(idmap_path);
+    return;
+  }
+  VerifiedIdmap& verified = verified_idmaps_.insert_or_assign(idmap_path, *inputs).first->second;
+  verified.idmap = *idmap;
+}
+
+bool Idmap2Service::IsKnownUpToDate(const std::string& idmap_path, const IdmapParams& params) {
+  std::optional<VerifiedIdmap> verified;
+  {
+    std::lock_guard lock(verified_idmaps_mutex_);
+    if (auto it = verified_idmaps_.find(idmap_path); it != verified_idmaps_.end()) {
+      verified = it->second;
+    }
+  }
+  if (!verified || verified->params != params) {
+    return false;
+  }
+  return verified->idmap == StatFile(idmap_path) && verified->target == StatFile(params.target_path)
+      && verified->overlay == StatFile(params.overlay_path);
+}
+
 idmap2::Result<Idmap2Service::TargetResourceContainerPtr> Idmap2Service::GetTargetContainer(
     const std::string& target_path) {
   const bool is_framework = target_path == kFrameworkPath;
@@ -228,9 +494,8 @@ idmap2::Result<Idmap2Service::TargetResourceContainerPtr> Idmap2Service::GetTarg
     std::lock_guard lock(container_cache_mutex_);
     if (auto cache_it = container_cache_.find(target_path); cache_it != container_cache_.end()) {
       const auto& item = cache_it->second;
-      if (is_framework ||
-        (item.dev == st.st_dev && item.inode == st.st_ino && item.size == st.st_size
-          && item.mtime.tv_sec == st.st_mtim.tv_sec && item.mtime.tv_nsec == st.st_mtim.tv_nsec)) {
+      if (is_framework || item.stamp == FileStamp::FromStat(st)) {
+        cache_it->second.last_used = ++container_cache_clock_;
         return {item.apk};
       }
       container_cache_.erase(cache_it);
@@ -247,12 +512,25 @@ idmap2::Result<Idmap2Service::TargetResourceContainerPtr> Idmap2Service::GetTarg
 
   auto res = std::shared_ptr(std::move(*target));
   std::lock_guard lock(container_cache_mutex_);
-  container_cache_.emplace(target_path, CachedContainer {
-    .dev = dev_t(st.st_dev),
-    .inode = ino_t(st.st_ino),
-    .size = st.st_size,
-    .mtime = st.st_mtim,
-    .apk = res
+  if (container_cache_.size() >= kMaxCachedTargets &&
+      container_cache_.find(target_path) == container_cache_.end()) {
+    // Callers that still use the evicted container keep it alive through their own reference.
+    auto lru_it = container_cache_.end();
+    for (auto it = container_cache_.begin(); it != container_cache_.end(); ++it) {
+      if (it->first != kFrameworkPath &&
+          (lru_it == container_cache_.end() || it->second.last_used < lru_it->second.last_used)) {
+        lru_it = it;
+      }
+    }
+    if (lru_it != container_cache_.end()) {
+      container_cache_.erase(lru_it);
+    }
+  }
+  // Another request may have parsed the same target meanwhile; the newest parse wins.
+  container_cache_.insert_or_assign(target_path, CachedContainer {
+    .stamp = FileStamp::FromStat(st),
+    .apk = res,
+    .last_used = ++container_cache_clock_
   });
   return {res};
 }
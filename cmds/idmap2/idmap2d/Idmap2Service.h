@@ -17,6 +17,8 @@
 #ifndef IDMAP2_IDMAP2D_IDMAP2SERVICE_H_
 #define IDMAP2_IDMAP2D_IDMAP2SERVICE_H_
 
+#include <sys/stat.h>
+
 #include <android-base/unique_fd.h>
 #include <android/os/BnIdmap2.h>
 #include <android/os/FabricatedOverlayInfo.h>
@@ -29,11 +31,24 @@
 #include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
 namespace android::os {
 
+// The arguments of createIdmap and verifyIdmap for a single overlay, as passed to the batched
+// createIdmaps and verifyIdmaps.
+struct IdmapParams {
+  std::string target_path;
+  std::string overlay_path;
+  std::string overlay_name;
+  int32_t fulfilled_policies = 0;
+  bool enforce_overlayable = false;
+
+  bool operator==(const IdmapParams& other) const = default;
+};
+
 class Idmap2Service : public BinderService<Idmap2Service>, public BnIdmap2 {
  public:
   static char const* getServiceName() {
@@ -56,6 +71,16 @@ class Idmap2Service : public BinderService<Idmap2Service>, public BnIdmap2 {
                              bool enforce_overlayable, int32_t user_id,
                              std::optional<std::string>* _aidl_return) override;
 
+  // Creates the idmaps of many overlays at once, e.g. after an OTA. Each target is opened once
+  // per worker thread and shared by all of its overlays that the worker handles. Returns the idmap
+  // path of each overlay in the order of params, or nullopt if its idmap could not be created.
+  binder::Status createIdmaps(const std::vector<IdmapParams>& params, int32_t user_id,
+                              std::vector<std::optional<std::string>>* _aidl_return);
+
+  // Verifies the idmaps of many overlays at once, returning whether each one is up to date.
+  binder::Status verifyIdmaps(const std::vector<IdmapParams>& params, int32_t user_id,
+                              std::vector<bool>* _aidl_return);
+
   binder::Status createFabricatedOverlay(
       const os::FabricatedOverlayInternal& overlay,
       std::optional<os::FabricatedOverlayInfo>* _aidl_return) override;
@@ -76,20 +101,50 @@ class Idmap2Service : public BinderService<Idmap2Service>, public BnIdmap2 {
   // idmap2d is killed after a period of inactivity, so any information stored on this class should
   // be able to be recalculated if idmap2 dies and restarts.
 
-  // A cache item for the resource containers (apks or frros), with all information needed to
-  // detect if it has changed since it was parsed:
+  // All information needed to detect if a file has changed since it was last read:
   //  - (dev, inode) pair uniquely identifies a file on a particular device partition (see stat(2)).
   //  - (mtime, size) ensure the file data hasn't changed inside that file.
-  struct CachedContainer {
+  struct FileStamp {
     dev_t dev;
     ino_t inode;
     int64_t size;
     struct timespec mtime;
+
+    static FileStamp FromStat(const struct stat& st);
+    bool operator==(const FileStamp& other) const;
+  };
+  static std::optional<FileStamp> StatFile(const std::string& path);
+
+  // A cache item for the resource containers (apks or frros), stamped when it was parsed.
+  // The cache is bounded: once full, the least recently used item is evicted to make room, except
+  // for the framework, which nearly every overlay targets.
+  struct CachedContainer {
+    FileStamp stamp;
     std::shared_ptr<idmap2::TargetResourceContainer> apk;
+    uint64_t last_used;
   };
   std::unordered_map<std::string, CachedContainer> container_cache_;
+  uint64_t container_cache_clock_ = 0;
   std::mutex container_cache_mutex_;
 
+  // The idmaps last found or written up to date, keyed by idmap path, with the arguments and the
+  // stamps of the files they were checked against. While none of these files change, verifyIdmap
+  // answers from here instead of reopening the target and overlay to compare their crcs.
+  struct VerifiedIdmap {
+    IdmapParams params;
+    FileStamp target;
+    FileStamp overlay;
+    FileStamp idmap;
+  };
+  std::unordered_map<std::string, VerifiedIdmap> verified_idmaps_;
+  std::mutex verified_idmaps_mutex_;
+
+  // Stamps the target and overlay of params. Must be called before they are read, so that a change
+  // made while the idmap is being checked or written invalidates the result.
+  static std::optional<VerifiedIdmap> StampInputs(const IdmapParams& params);
+  void MarkUpToDate(const std::string& idmap_path, const std::optional<VerifiedIdmap>& inputs);
+  bool IsKnownUpToDate(const std::string& idmap_path, const IdmapParams& params);
+
   int32_t frro_iter_id_ = 0;
   std::optional<std::filesystem::directory_iterator> frro_iter_;
   std::mutex frro_iter_mutex_;
@@ -102,6 +157,12 @@ class Idmap2Service : public BinderService<Idmap2Service>, public BnIdmap2 {
 
   template <typename T>
   WARN_UNUSED static const T* GetPointer(const OwningPtr<T>& ptr);
+
+  // Calls fn(target, index) for every entry of params on a few worker threads, with target null if
+  // it could not be loaded. A target container is never used by two workers at once: the first
+  // worker to need a target takes it from container_cache_, and the others open their own copy.
+  template <typename Fn>
+  void ForEachWithTarget(const std::vector<IdmapParams>& params, Fn&& fn);
 };
 
 }  // namespace android::os
@@ -24,6 +24,7 @@
 #include <istream>
 #include <map>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <unordered_map>
@@ -90,8 +91,17 @@ struct FabricatedOverlay {
     size_t size;
   };
 
+  // The manifest and crc of a fabricated overlay file, which can be read without parsing its
+  // entries.
+  struct Summary {
+    OverlayManifestInfo manifest_info;
+    // Only known for files of the current version; older files are migrated to compute it.
+    std::optional<uint32_t> crc;
+  };
+
   Result<Unit> ToBinaryStream(std::ostream& stream) const;
   static Result<FabricatedOverlay> FromBinaryStream(std::istream& stream);
+  static Result<Summary> ReadSummary(std::istream& stream);
 
  private:
   struct SerializedData {
@@ -139,7 +149,14 @@ struct FabricatedOverlayContainer : public OverlayResourceContainer {
 
  private:
   FabricatedOverlayContainer(FabricatedOverlay&& overlay, std::string&& path);
-  FabricatedOverlay overlay_;
+  FabricatedOverlayContainer(FabricatedOverlay::Summary&& summary, std::string&& path);
+
+  // The entries of a frro on disk are only parsed once GetOverlayData needs them. Listing frros
+  // and checking whether their idmaps are up to date only need the summary.
+  Result<const FabricatedOverlay*> GetOverlay() const;
+
+  mutable std::optional<FabricatedOverlay> overlay_;
+  FabricatedOverlay::Summary summary_;
   std::string path_;
 };
 
@@ -32,6 +32,7 @@
 #include <androidfw/Streams.h>
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/wire_format_lite.h>
 #include <utils/ByteOrder.h>
 #include <zlib.h>
 
@@ -59,6 +60,98 @@ void Write32(std::ostream& stream, uint32_t value) {
   uint32_t x = htodl(value);
   stream.write(reinterpret_cast<char*>(&x), sizeof(uint32_t));
 }
+
+// Reads everything that precedes the proto in a fabricated overlay file. The string pool is
+// skipped when sp_data is null.
+Result<Unit> ReadPreamble(std::istream& stream, uint32_t* version, uint32_t* crc,
+                          uint32_t* total_binary_bytes, std::string* sp_data) {
+  uint32_t magic;
+  if (!Read32(stream, &magic)) {
+    return Error("Failed to read fabricated overlay magic.");
+  }
+
+  if (magic != kFabricatedOverlayMagic) {
+    return Error("Not a fabricated overlay file.");
+  }
+
+  if (!Read32(stream, version)) {
+    return Error("Failed to read fabricated overlay version.");
+  }
+
+  if (*version < 1 || *version > 3) {
+    return Error("Invalid fabricated overlay version '%u'.", *version);
+  }
+
+  if (!Read32(stream, crc)) {
+    return Error("Failed to read fabricated overlay crc.");
+  }
+
+  *total_binary_bytes = 0;
+  if (*version == 3) {
+    if (!Read32(stream, total_binary_bytes)) {
+      return Error("Failed read total binary bytes.");
+    }
+    stream.seekg(*total_binary_bytes, std::istream::cur);
+  }
+  if (*version >= 2) {
+    uint32_t sp_size;
+    if (!Read32(stream, &sp_size)) {
+      return Error("Failed read string pool size.");
+    }
+    if (sp_data == nullptr) {
+      if (!stream.seekg(sp_size, std::istream::cur)) {
+        return Error("Failed to read string pool.");
+      }
+    } else {
+      std::string buf(sp_size, '\0');
+      if (!stream.read(buf.data(), sp_size)) {
+        return Error("Failed to read string pool.");
+      }
+      *sp_data = std::move(buf);
+    }
+  }
+  return Unit{};
+}
+
+// Reads only the manifest fields of the serialized pb::FabricatedOverlay. The packages, which hold
+// all of the entries, are skipped over without being parsed.
+Result<OverlayManifestInfo> ReadManifestInfo(std::istream& stream) {
+  using google::protobuf::internal::WireFormatLite;
+  google::protobuf::io::IstreamInputStream zero_copy_stream(&stream);
+  google::protobuf::io::CodedInputStream input(&zero_copy_stream);
+
+  OverlayManifestInfo info;
+  while (const uint32_t tag = input.ReadTag()) {
+    std::string* field = nullptr;
+    switch (WireFormatLite::GetTagFieldNumber(tag)) {
+      case pb::FabricatedOverlay::kPackageNameFieldNumber:
+        field = &info.package_name;
+        break;
+      case pb::FabricatedOverlay::kNameFieldNumber:
+        field = &info.name;
+        break;
+      case pb::FabricatedOverlay::kTargetPackageNameFieldNumber:
+        field = &info.target_package;
+        break;
+      case pb::FabricatedOverlay::kTargetOverlayableFieldNumber:
+        field = &info.target_name;
+        break;
+      default:
+        break;
+    }
+    const bool is_manifest_field =
+        field != nullptr &&
+        WireFormatLite::GetTagWireType(tag) == WireFormatLite::WIRETYPE_LENGTH_DELIMITED;
+    if (!(is_manifest_field ? WireFormatLite::ReadString(&input, field)
+                            : WireFormatLite::SkipField(&input, tag))) {
+      return Error("Failed read fabricated overlay proto.");
+    }
+  }
+  if (!input.ConsumedEntireMessage()) {
+    return Error("Failed read fabricated overlay proto.");
+  }
+  return info;
+}
 }  // namespace
 
 FabricatedOverlay::FabricatedOverlay(pb::FabricatedOverlay&& overlay,
@@ -292,49 +385,16 @@ Result<FabricatedOverlay> FabricatedOverlay::Builder::Build() {
 }
 
 Result<FabricatedOverlay> FabricatedOverlay::FromBinaryStream(std::istream& stream) {
-  uint32_t magic;
-  if (!Read32(stream, &magic)) {
-    return Error("Failed to read fabricated overlay magic.");
-  }
-
-  if (magic != kFabricatedOverlayMagic) {
-    return Error("Not a fabricated overlay file.");
-  }
-
   uint32_t version;
-  if (!Read32(stream, &version)) {
-    return Error("Failed to read fabricated overlay version.");
-  }
-
-  if (version < 1 || version > 3) {
-    return Error("Invalid fabricated overlay version '%u'.", version);
-  }
-
   uint32_t crc;
-  if (!Read32(stream, &crc)) {
-    return Error("Failed to read fabricated overlay crc.");
+  uint32_t total_binary_bytes;
+  std::string sp_data;
+  if (auto result = ReadPreamble(stream, &version, &crc, &total_binary_bytes, &sp_data);
+      !result) {
+    return result.GetError();
   }
 
   pb::FabricatedOverlay overlay{};
-  std::string sp_data;
-  uint32_t total_binary_bytes;
-  if (version == 3) {
-    if (!Read32(stream, &total_binary_bytes)) {
-      return Error("Failed read total binary bytes.");
-    }
-    stream.seekg(total_binary_bytes, std::istream::cur);
-  }
-  if (version >= 2) {
-    uint32_t sp_size;
-    if (!Read32(stream, &sp_size)) {
-      return Error("Failed read string pool size.");
-    }
-    std::string buf(sp_size, '\0');
-    if (!stream.read(buf.data(), sp_size)) {
-      return Error("Failed to read string pool.");
-    }
-    sp_data = buf;
-  }
   if (!overlay.ParseFromIstream(&stream)) {
     return Error("Failed read fabricated overlay proto.");
   }
@@ -348,6 +408,25 @@ Result<FabricatedOverlay> FabricatedOverlay::FromBinaryStream(std::istream& stre
                                                    : std::nullopt);
 }
 
+Result<FabricatedOverlay::Summary> FabricatedOverlay::ReadSummary(std::istream& stream) {
+  uint32_t version;
+  uint32_t crc;
+  uint32_t total_binary_bytes;
+  if (auto result = ReadPreamble(stream, &version, &crc, &total_binary_bytes, nullptr); !result) {
+    return result.GetError();
+  }
+
+  auto info = ReadManifestInfo(stream);
+  if (!info) {
+    return info.GetError();
+  }
+  return Summary{
+      .manifest_info = std::move(*info),
+      .crc = version == kFabricatedOverlayCurrentVersion ? std::optional<uint32_t>(crc)
+                                                         : std::nullopt,
+  };
+}
+
 Result<FabricatedOverlay::SerializedData*> FabricatedOverlay::InitializeData() const {
   if (!data_.has_value()) {
     auto pb_size = overlay_pb_.ByteSizeLong();
@@ -417,18 +496,29 @@ Result<Unit> FabricatedOverlay::ToBinaryStream(std::ostream& stream) const {
 using FabContainer = FabricatedOverlayContainer;
 FabContainer::FabricatedOverlayContainer(FabricatedOverlay&& overlay, std::string&& path)
     : overlay_(std::forward<FabricatedOverlay>(overlay)), path_(std::forward<std::string>(path)) {
+  const pb::FabricatedOverlay& overlay_pb = overlay_->overlay_pb_;
+  summary_.manifest_info = OverlayManifestInfo{
+      .package_name = overlay_pb.package_name(),
+      .name = overlay_pb.name(),
+      .target_package = overlay_pb.target_package_name(),
+      .target_name = overlay_pb.target_overlayable(),
+  };
+}
+
+FabContainer::FabricatedOverlayContainer(FabricatedOverlay::Summary&& summary, std::string&& path)
+    : summary_(std::move(summary)), path_(std::move(path)) {
 }
 
 FabContainer::~FabricatedOverlayContainer() = default;
 
 Result<std::unique_ptr<FabContainer>> FabContainer::FromPath(std::string path) {
-  std::fstream fin(path);
-  auto overlay = FabricatedOverlay::FromBinaryStream(fin);
-  if (!overlay) {
-    return overlay.GetError();
+  std::ifstream fin(path);
+  auto summary = FabricatedOverlay::ReadSummary(fin);
+  if (!summary) {
+    return summary.GetError();
   }
   return std::unique_ptr<FabContainer>(
-      new FabricatedOverlayContainer(std::move(*overlay), std::move(path)));
+      new FabricatedOverlayContainer(std::move(*summary), std::move(path)));
 }
 
 std::unique_ptr<FabricatedOverlayContainer> FabContainer::FromOverlay(FabricatedOverlay&& overlay) {
@@ -436,14 +526,20 @@ std::unique_ptr<FabricatedOverlayContainer> FabContainer::FromOverlay(Fabricated
       new FabricatedOverlayContainer(std::move(overlay), {} /* path */));
 }
 
+Result<const FabricatedOverlay*> FabContainer::GetOverlay() const {
+  if (!overlay_.has_value()) {
+    std::ifstream fin(path_);
+    auto overlay = FabricatedOverlay::FromBinaryStream(fin);
+    if (!overlay) {
+      return overlay.GetError();
+    }
+    overlay_ = std::move(*overlay);
+  }
+  return &*overlay_;
+}
+
 OverlayManifestInfo FabContainer::GetManifestInfo() const {
-  const pb::FabricatedOverlay& overlay_pb = overlay_.overlay_pb_;
-  return OverlayManifestInfo{
-      .package_name = overlay_pb.package_name(),
-      .name = overlay_pb.name(),
-      .target_package = overlay_pb.target_package_name(),
-      .target_name = overlay_pb.target_overlayable(),
-  };
+  return summary_.manifest_info;
 }
 
 Result<OverlayManifestInfo> FabContainer::FindOverlayInfo(const std::string& name) const {
@@ -455,10 +551,14 @@ Result<OverlayManifestInfo> FabContainer::FindOverlayInfo(const std::string& nam
 }
 
 Result<OverlayData> FabContainer::GetOverlayData(const OverlayManifestInfo& info) const {
-  const pb::FabricatedOverlay& overlay_pb = overlay_.overlay_pb_;
-  if (info.name != overlay_pb.name()) {
+  if (info.name != summary_.manifest_info.name) {
     return Error("Failed to find name '%s' in fabricated overlay", info.name.c_str());
   }
+  const auto overlay = GetOverlay();
+  if (!overlay) {
+    return overlay.GetError();
+  }
+  const pb::FabricatedOverlay& overlay_pb = (*overlay)->overlay_pb_;
 
   OverlayData result{};
   for (const auto& package : overlay_pb.packages()) {
@@ -474,19 +574,27 @@ Result<OverlayData> FabContainer::GetOverlayData(const OverlayManifestInfo& info
       }
     }
   }
-  const uint32_t string_pool_data_length = overlay_.string_pool_data_.length();
+  const std::string& string_pool_data = (*overlay)->string_pool_data_;
+  const uint32_t string_pool_data_length = string_pool_data.length();
   result.string_pool_data = OverlayData::InlineStringPoolData{
       .data = std::unique_ptr<uint8_t[]>(new uint8_t[string_pool_data_length]),
       .data_length = string_pool_data_length,
       .string_pool_offset = 0,
   };
-  memcpy(result.string_pool_data->data.get(), overlay_.string_pool_data_.data(),
+  memcpy(result.string_pool_data->data.get(), string_pool_data.data(),
        string_pool_data_length);
   return result;
 }
 
 Result<uint32_t> FabContainer::GetCrc() const {
-  return overlay_.GetCrc();
+  if (summary_.crc.has_value()) {
+    return *summary_.crc;
+  }
+  const auto overlay = GetOverlay();
+  if (!overlay) {
+    return overlay.GetError();
+  }
+  return (*overlay)->GetCrc();
 }
 
 const std::string& FabContainer::GetPath() const {
@@ -20,6 +20,7 @@
 #include "TestHelpers.h"
 
 #include <fstream>
+#include <sstream>
 #include <utility>
 
 namespace android::idmap2 {
@@ -183,4 +184,38 @@ TEST(FabricatedOverlayTests, SerializeAndDeserialize) {
   ASSERT_EQ(std::string("foobar"), string_pool.string8At(entry->value.data_value).value_or(""));
 }
 
+TEST(FabricatedOverlayTests, ReadSummary) {
+  auto overlay =
+      FabricatedOverlay::Builder("com.example.overlay", "SandTheme", "com.example.target")
+          .SetOverlayable("TestResources")
+          .SetResourceValue("com.example.target:integer/int1", Res_value::TYPE_INT_DEC, 1U, "")
+          .SetResourceValue(
+              "com.example.target:string/string1", Res_value::TYPE_STRING, "foobar", "")
+          .Build();
+  ASSERT_TRUE(overlay);
+  std::stringstream stream;
+  ASSERT_TRUE((*overlay).ToBinaryStream(stream));
+  const std::string data = stream.str();
+
+  std::stringstream summary_stream(data);
+  auto summary = FabricatedOverlay::ReadSummary(summary_stream);
+  ASSERT_TRUE(summary) << summary.GetErrorMessage();
+  EXPECT_EQ("com.example.overlay", summary->manifest_info.package_name);
+  EXPECT_EQ("SandTheme", summary->manifest_info.name);
+  EXPECT_EQ("com.example.target", summary->manifest_info.target_package);
+  EXPECT_EQ("TestResources", summary->manifest_info.target_name);
+
+  std::stringstream overlay_stream(data);
+  auto read_overlay = FabricatedOverlay::FromBinaryStream(overlay_stream);
+  ASSERT_TRUE(read_overlay) << read_overlay.GetErrorMessage();
+  auto container = FabricatedOverlayContainer::FromOverlay(std::move(*read_overlay));
+  auto crc = container->GetCrc();
+  ASSERT_TRUE(crc) << crc.GetErrorMessage();
+  ASSERT_TRUE(summary->crc.has_value());
+  EXPECT_EQ(*crc, *summary->crc);
+
+  std::stringstream truncated_stream(data.substr(0, data.size() - 1));
+  EXPECT_FALSE(FabricatedOverlay::ReadSummary(truncated_stream));
+}
+
 }  // namespace android::idmap2
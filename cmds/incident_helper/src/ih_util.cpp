@@ -20,6 +20,7 @@
 
 #include <algorithm>
 #include <sstream>
+#include <string.h>
 #include <unistd.h>
 
 bool isValidChar(char c) {
@@ -38,12 +39,40 @@ std::string trim(const std::string& s, const std::string& charset) {
     return s.substr(head, tail - head + 1);
 }
 
+std::string_view trimView(std::string_view s, std::string_view charset) {
+    const auto head = s.find_first_not_of(charset);
+    if (head == std::string_view::npos) return std::string_view();
+
+    const auto tail = s.find_last_not_of(charset);
+    return s.substr(head, tail - head + 1);
+}
+
+std::vector<std::string_view> splitLines(std::string_view text) {
+    std::vector<std::string_view> lines;
+    size_t base = 0;
+    while (base < text.size()) {
+        size_t found = text.find('\n', base);
+        if (found == std::string_view::npos) found = text.size();
+        std::string_view line = trimView(text.substr(base, found - base), DEFAULT_NEWLINE);
+        if (!line.empty()) {
+            lines.push_back(line);
+        }
+        base = found + 1;
+    }
+    return lines;
+}
+
 static inline std::string toLowerStr(const std::string& s) {
     std::string res(s);
     std::transform(res.begin(), res.end(), res.begin(), ::tolower);
     return res;
 }
 
+static inline bool equalsIgnoreCase(std::string_view s, std::string_view lower) {
+    return s.size() == lower.size() && std::equal(s.begin(), s.end(), lower.begin(),
+            [](char a, char b) { return ::tolower(a) == b; });
+}
+
 static inline std::string trimDefault(const std::string& s) {
     return trim(s, DEFAULT_WHITESPACE);
 }
@@ -52,8 +81,8 @@ static inline std::string trimHeader(const std::string& s) {
     return toLowerStr(trimDefault(s));
 }
 
-static inline bool isNumber(const std::string& s) {
-    std::string::const_iterator it = s.begin();
+static inline bool isNumber(std::string_view s) {
+    std::string_view::const_iterator it = s.begin();
     while (it != s.end() && std::isdigit(*it)) ++it;
     return !s.empty() && it == s.end();
 }
@@ -86,10 +115,27 @@ header_t parseHeader(const std::string& line, const std::string& delimiters) {
 }
 
 record_t parseRecord(const std::string& line, const std::string& delimiters) {
-    record_t record;
-    trans_func f = &trimDefault;
-    split(line, record, f, delimiters);
-    return record;
+    record_view_t view;
+    parseRecordView(line, &view, delimiters);
+    return record_t(view.begin(), view.end());
+}
+
+void parseRecordView(std::string_view line, record_view_t* record, std::string_view delimiters) {
+    record->clear();
+
+    size_t base = 0;
+    size_t found;
+    while (true) {
+        found = line.find_first_of(delimiters, base);
+        if (found != base) {
+            std::string_view word = trimView(line.substr(base, found - base), DEFAULT_WHITESPACE);
+            if (!word.empty()) {
+                record->push_back(word);
+            }
+        }
+        if (found == line.npos) break;
+        base = found + 1;
+    }
 }
 
 bool getColumnIndices(std::vector<int>& indices, const char** headerNames, const std::string& line) {
@@ -113,7 +159,14 @@ bool getColumnIndices(std::vector<int>& indices, const char** headerNames, const
 }
 
 record_t parseRecordByColumns(const std::string& line, const std::vector<int>& indices, const std::string& delimiters) {
-    record_t record;
+    record_view_t view;
+    parseRecordByColumnsView(line, indices, &view, delimiters);
+    return record_t(view.begin(), view.end());
+}
+
+void parseRecordByColumnsView(std::string_view line, const std::vector<int>& indices,
+        record_view_t* record, std::string_view delimiters) {
+    record->clear();
     int lastIndex = 0;
     int lastBeginning = 0;
     int lineSize = (int)line.size();
@@ -132,25 +185,24 @@ record_t parseRecordByColumns(const std::string& line, const std::vector<int>& i
             }
             // If we're past the end of the line AND we've already saved everything up to the end.
             fprintf(stderr, "index wrong: lastIndex: %d, idx: %d, lineSize: %d\n", lastIndex, idx, lineSize);
-            record.clear(); // The indices are wrong, return empty.
-            return record;
+            record->clear(); // The indices are wrong, return empty.
+            return;
         }
-        while (idx < lineSize && delimiters.find(line[idx++]) == std::string::npos);
-        record.push_back(trimDefault(line.substr(lastIndex, idx - lastIndex)));
+        while (idx < lineSize && delimiters.find(line[idx++]) == std::string_view::npos);
+        record->push_back(trimView(line.substr(lastIndex, idx - lastIndex), DEFAULT_WHITESPACE));
         lastBeginning = lastIndex;
         lastIndex = idx;
     }
     if (lineSize - lastIndex > 0) {
         int beginning = lastIndex;
-        if (record.size() == indices.size() && !record.empty()) {
+        if (record->size() == indices.size() && !record->empty()) {
             // We've already encountered all of the columns...put whatever is
             // left in the last column.
-            record.pop_back();
+            record->pop_back();
             beginning = lastBeginning;
         }
-        record.push_back(trimDefault(line.substr(beginning, lineSize - beginning)));
+        record->push_back(trimView(line.substr(beginning, lineSize - beginning), DEFAULT_WHITESPACE));
     }
-    return record;
 }
 
 void printRecord(const record_t& record) {
@@ -166,6 +218,19 @@ void printRecord(const record_t& record) {
     fprintf(stderr, "\" }\n");
 }
 
+void printRecord(const record_view_t& record) {
+    fprintf(stderr, "Record: { ");
+    if (record.size() == 0) {
+        fprintf(stderr, "}\n");
+        return;
+    }
+    for(size_t i = 0; i < record.size(); ++i) {
+        if(i != 0) fprintf(stderr, "\", ");
+        fprintf(stderr, "\"%.*s", (int)record[i].size(), record[i].data());
+    }
+    fprintf(stderr, "\" }\n");
+}
+
 bool stripPrefix(std::string* line, const char* key, bool endAtDelimiter) {
     const auto head = line->find_first_not_of(DEFAULT_WHITESPACE);
     if (head == std::string::npos) return false;
@@ -233,6 +298,16 @@ double toDouble(const std::string& s) {
     return atof(s.c_str());
 }
 
+// Copies a number out of the text into buf so it can be converted without allocating.
+template <typename T>
+static T convertView(std::string_view s, T (*convert)(const char*)) {
+    char buf[64];
+    size_t size = std::min(s.size(), sizeof(buf) - 1);
+    memcpy(buf, s.data(), size);
+    buf[size] = '\0';
+    return convert(buf);
+}
+
 // ==============================================================================
 Reader::Reader(const int fd)
 {
@@ -295,7 +370,7 @@ Table::addEnumTypeMap(const char* field, const char* enumNames[], const int enum
         return;
     }
 
-    std::map<std::string, int> enu;
+    std::map<std::string, int, std::less<>> enu;
     for (int i = 0; i < enumSize; i++) {
         enu[enumNames[i]] = enumValues[i];
     }
@@ -308,17 +383,36 @@ Table::addEnumNameToValue(const char* enumName, const int enumValue)
     mEnumValuesByName[enumName] = enumValue;
 }
 
+Table::Column
+Table::getColumn(const std::string& name) const
+{
+    Column column = { 0, nullptr };
+    auto field = mFields.find(name);
+    if (field == mFields.end()) return column;
+
+    column.fieldId = field->second;
+    auto enums = mEnums.find(name);
+    if (enums != mEnums.end()) column.enumValues = &enums->second;
+    return column;
+}
+
 bool
 Table::insertField(ProtoOutputStream* proto, const std::string& name, const std::string& value)
 {
-    if (mFields.find(name) == mFields.end()) return false;
+    return insertField(proto, getColumn(name), value);
+}
+
+bool
+Table::insertField(ProtoOutputStream* proto, const Column& column, std::string_view value) const
+{
+    if (column.fieldId == 0) return false;
 
-    uint64_t found = mFields[name];
-    record_t repeats; // used for repeated fields
+    uint64_t found = column.fieldId;
+    record_view_t repeats; // used for repeated fields
     switch ((found & FIELD_COUNT_MASK) | (found & FIELD_TYPE_MASK)) {
         case FIELD_COUNT_SINGLE | FIELD_TYPE_DOUBLE:
         case FIELD_COUNT_SINGLE | FIELD_TYPE_FLOAT:
-            proto->write(found, toDouble(value));
+            proto->write(found, convertView(value, &atof));
             break;
         case FIELD_COUNT_SINGLE | FIELD_TYPE_STRING:
         case FIELD_COUNT_SINGLE | FIELD_TYPE_BYTES:
@@ -329,30 +423,32 @@ Table::insertField(ProtoOutputStream* proto, const std::string& name, const std:
         case FIELD_COUNT_SINGLE | FIELD_TYPE_UINT64:
         case FIELD_COUNT_SINGLE | FIELD_TYPE_FIXED64:
         case FIELD_COUNT_SINGLE | FIELD_TYPE_SFIXED64:
-            proto->write(found, toLongLong(value));
+            proto->write(found, convertView(value, &atoll));
             break;
         case FIELD_COUNT_SINGLE | FIELD_TYPE_BOOL:
-            if (strcmp(toLowerStr(value).c_str(), "true") == 0 || strcmp(value.c_str(), "1") == 0) {
+            if (equalsIgnoreCase(value, "true") || value == "1") {
                 proto->write(found, true);
                 break;
             }
-            if (strcmp(toLowerStr(value).c_str(), "false") == 0 || strcmp(value.c_str(), "0") == 0) {
+            if (equalsIgnoreCase(value, "false") || value == "0") {
                 proto->write(found, false);
                 break;
             }
             return false;
         case FIELD_COUNT_SINGLE | FIELD_TYPE_ENUM:
             // if the field has its own enum mapping, use this, otherwise use general name to value mapping.
-            if (mEnums.find(name) != mEnums.end()) {
-                if (mEnums[name].find(value) != mEnums[name].end()) {
-                    proto->write(found, mEnums[name][value]);
+            if (column.enumValues != nullptr) {
+                auto enumValue = column.enumValues->find(value);
+                if (enumValue != column.enumValues->end()) {
+                    proto->write(found, enumValue->second);
                 } else {
                     proto->write(found, 0); // TODO: should get the default enum value (Unknown)
                 }
-            } else if (mEnumValuesByName.find(value) != mEnumValuesByName.end()) {
-                proto->write(found, mEnumValuesByName[value]);
+            } else if (auto enumValue = mEnumValuesByName.find(value);
+                    enumValue != mEnumValuesByName.end()) {
+                proto->write(found, enumValue->second);
             } else if (isNumber(value)) {
-                proto->write(found, toInt(value));
+                proto->write(found, convertView(value, &atoi));
             } else {
                 return false;
             }
@@ -362,17 +458,17 @@ Table::insertField(ProtoOutputStream* proto, const std::string& name, const std:
         case FIELD_COUNT_SINGLE | FIELD_TYPE_UINT32:
         case FIELD_COUNT_SINGLE | FIELD_TYPE_FIXED32:
         case FIELD_COUNT_SINGLE | FIELD_TYPE_SFIXED32:
-            proto->write(found, toInt(value));
+            proto->write(found, convertView(value, &atoi));
             break;
         // REPEATED TYPE below:
         case FIELD_COUNT_REPEATED | FIELD_TYPE_INT32:
-            repeats = parseRecord(value, COMMA_DELIMITER);
+            parseRecordView(value, &repeats, COMMA_DELIMITER);
             for (size_t i=0; i<repeats.size(); i++) {
-                proto->write(found, toInt(repeats[i]));
+                proto->write(found, convertView(repeats[i], &atoi));
             }
             break;
         case FIELD_COUNT_REPEATED | FIELD_TYPE_STRING:
-            repeats = parseRecord(value, COMMA_DELIMITER);
+            parseRecordView(value, &repeats, COMMA_DELIMITER);
             for (size_t i=0; i<repeats.size(); i++) {
                 proto->write(found, repeats[i]);
             }
@@ -20,6 +20,7 @@
 #include <map>
 #include <stack>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <android/util/ProtoOutputStream.h>
@@ -28,6 +29,7 @@ using namespace android::util;
 
 typedef std::vector<std::string> header_t;
 typedef std::vector<std::string> record_t;
+typedef std::vector<std::string_view> record_view_t;
 typedef std::string (*trans_func) (const std::string&);
 
 const std::string DEFAULT_WHITESPACE = " \t";
@@ -42,6 +44,13 @@ bool isValidChar(char c);
 
 // trim the string with the given charset
 std::string trim(const std::string& s, const std::string& charset);
+std::string_view trimView(std::string_view s, std::string_view charset);
+
+/**
+ * Splits text into its lines, trimmed of newline characters. Empty lines are skipped.
+ * The lines point into text, which must outlive them.
+ */
+std::vector<std::string_view> splitLines(std::string_view text);
 
 /**
  * When a text has a table format like this
@@ -72,8 +81,19 @@ bool getColumnIndices(std::vector<int>& indices, const char* headerNames[], cons
  */
 record_t parseRecordByColumns(const std::string& line, const std::vector<int>& indices, const std::string& delimiters = DEFAULT_WHITESPACE);
 
+/**
+ * Same as parseRecord and parseRecordByColumns, except that the values point into line instead
+ * of being copied, so line must outlive them. record is cleared first, so the same one can be
+ * reused for every line of a table.
+ */
+void parseRecordView(std::string_view line, record_view_t* record,
+        std::string_view delimiters = DEFAULT_WHITESPACE);
+void parseRecordByColumnsView(std::string_view line, const std::vector<int>& indices,
+        record_view_t* record, std::string_view delimiters = DEFAULT_WHITESPACE);
+
 /** Prints record_t to stderr */
 void printRecord(const record_t& record);
+void printRecord(const record_view_t& record);
 
 /**
  * When the line starts/ends with the given key, the function returns true
@@ -150,10 +170,22 @@ public:
     // Based on given name, find the right field id, parse the text value and insert to proto.
     // Return false if the given name can't be found.
     bool insertField(ProtoOutputStream* proto, const std::string& name, const std::string& value);
+
+    // The field of a column of the text, looked up once by getColumn() so the value of each row
+    // can be inserted without looking it up again.
+    struct Column {
+        uint64_t fieldId; // 0 if there is no field by the column's name.
+        const std::map<std::string, int, std::less<>>* enumValues; // the field's own enum mapping.
+    };
+    Column getColumn(const std::string& name) const;
+
+    // Same as above for a column from getColumn(). It only reads the table, so rows can be
+    // inserted from several threads at once, each into its own proto.
+    bool insertField(ProtoOutputStream* proto, const Column& column, std::string_view value) const;
 private:
     std::map<std::string, uint64_t> mFields;
-    std::map<std::string, std::map<std::string, int>> mEnums;
-    std::map<std::string, int> mEnumValuesByName;
+    std::map<std::string, std::map<std::string, int, std::less<>>> mEnums;
+    std::map<std::string, int, std::less<>> mEnumValuesByName;
 };
 
 /**
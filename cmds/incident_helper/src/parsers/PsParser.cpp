@@ -15,24 +15,34 @@
  */
 #define LOG_TAG "incident_helper"
 
+#include <android-base/file.h>
 #include <android/util/ProtoOutputStream.h>
 
+#include <algorithm>
+#include <thread>
+
 #include "frameworks/base/core/proto/android/os/ps.proto.h"
 #include "ih_util.h"
 #include "PsParser.h"
 
+using namespace android::base;
 using namespace android::os;
 
+// Each thread parses at least this many processes, so small tables are parsed on one thread.
+static const size_t MIN_ROWS_PER_THREAD = 256;
+static const size_t MAX_PARSE_THREADS = 4;
+
 status_t PsParser::Parse(const int in, const int out) const {
-    Reader reader(in);
-    string line;
+    string content;
+    if (!ReadFdToString(in, &content)) {
+        fprintf(stderr, "[%s]Failed to read data from incidentd\n", this->name.c_str());
+        return -1;
+    }
+    // The lines point into content, so the whole table is tokenized without copying it.
+    vector<string_view> lines = splitLines(content);
     header_t header;  // the header of /d/wakeup_sources
     vector<int> columnIndices; // task table can't be split by purely delimiter, needs column positions.
-    record_t record;  // retain each record
-    int nline = 0;
-    int diff = 0;
 
-    ProtoOutputStream proto;
     Table table(PsProto::Process::_FIELD_NAMES, PsProto::Process::_FIELD_IDS, PsProto::Process::_FIELD_COUNT);
     const char* pcyNames[] = { "fg", "bg", "ta" };
     const int pcyValues[] = {PsProto::Process::POLICY_FG, PsProto::Process::POLICY_BG, PsProto::Process::POLICY_TA};
@@ -41,55 +51,77 @@ status_t PsParser::Parse(const int in, const int out) const {
     const int sValues[] = {PsProto::Process::STATE_D, PsProto::Process::STATE_R, PsProto::Process::STATE_S, PsProto::Process::STATE_T, PsProto::Process::STATE_TRACING, PsProto::Process::STATE_X, PsProto::Process::STATE_Z};
     table.addEnumTypeMap("s", sNames, sValues, 7);
 
-    // Parse line by line
-    while (reader.readLine(&line)) {
-        if (line.empty()) continue;
+    vector<Table::Column> columns;
+    if (!lines.empty()) {
+        string line(lines[0]);
+        header = parseHeader(line, DEFAULT_WHITESPACE);
 
-        if (nline++ == 0) {
-            header = parseHeader(line, DEFAULT_WHITESPACE);
-
-            const char* headerNames[] = { "LABEL", "USER", "PID", "TID", "PPID", "VSZ", "RSS", "WCHAN", "ADDR", "S", "PRI", "NI", "RTPRIO", "SCH", "PCY", "TIME", "CMD", nullptr };
-            if (!getColumnIndices(columnIndices, headerNames, line)) {
-                return -1;
-            }
-
-            continue;
+        const char* headerNames[] = { "LABEL", "USER", "PID", "TID", "PPID", "VSZ", "RSS", "WCHAN", "ADDR", "S", "PRI", "NI", "RTPRIO", "SCH", "PCY", "TIME", "CMD", nullptr };
+        if (!getColumnIndices(columnIndices, headerNames, line)) {
+            return -1;
+        }
+        for (const string& name : header) {
+            columns.push_back(table.getColumn(name));
         }
+    }
 
-        record = parseRecordByColumns(line, columnIndices);
+    // Every process is a top-level PsProto.processes entry, so the rows can be split in
+    // contiguous ranges, each written to its own proto, and the protos written out in order.
+    const size_t rows = lines.empty() ? 0 : lines.size() - 1;
+    const size_t threads = std::clamp(rows / MIN_ROWS_PER_THREAD, (size_t)1, MAX_PARSE_THREADS);
+    vector<ProtoOutputStream> protos(threads);
+    auto parseRows = [&](size_t part) {
+        ProtoOutputStream& proto = protos[part];
+        record_view_t record;  // retain each record
+        const size_t end = 1 + rows * (part + 1) / threads;
+        for (size_t nline = 1 + rows * part / threads; nline < end; nline++) {
+            string_view line = lines[nline];
+            parseRecordByColumnsView(line, columnIndices, &record);
 
-        diff = record.size() - header.size();
-        if (diff < 0) {
-            // TODO: log this to incident report!
-            fprintf(stderr, "[%s]Line %d has %d missing fields\n%s\n", this->name.c_str(), nline, -diff, line.c_str());
-            printRecord(record);
-            continue;
-        } else if (diff > 0) {
-            // TODO: log this to incident report!
-            fprintf(stderr, "[%s]Line %d has %d extra fields\n%s\n", this->name.c_str(), nline, diff, line.c_str());
-            printRecord(record);
-            continue;
-        }
+            int diff = record.size() - header.size();
+            if (diff < 0) {
+                // TODO: log this to incident report!
+                fprintf(stderr, "[%s]Line %zu has %d missing fields\n%.*s\n", this->name.c_str(),
+                        nline + 1, -diff, (int)line.size(), line.data());
+                printRecord(record);
+                continue;
+            } else if (diff > 0) {
+                // TODO: log this to incident report!
+                fprintf(stderr, "[%s]Line %zu has %d extra fields\n%.*s\n", this->name.c_str(),
+                        nline + 1, diff, (int)line.size(), line.data());
+                printRecord(record);
+                continue;
+            }
 
-        uint64_t token = proto.start(PsProto::PROCESSES);
-        for (int i=0; i<(int)record.size(); i++) {
-            if (!table.insertField(&proto, header[i], record[i])) {
-                fprintf(stderr, "[%s]Line %d has bad value %s of %s\n",
-                        this->name.c_str(), nline, header[i].c_str(), record[i].c_str());
+            uint64_t token = proto.start(PsProto::PROCESSES);
+            for (size_t i = 0; i < record.size(); i++) {
+                if (!table.insertField(&proto, columns[i], record[i])) {
+                    fprintf(stderr, "[%s]Line %zu has bad value %s of %.*s\n",
+                            this->name.c_str(), nline + 1, header[i].c_str(),
+                            (int)record[i].size(), record[i].data());
+                }
             }
+            proto.end(token);
         }
-        proto.end(token);
-    }
+    };
 
-    if (!reader.ok(&line)) {
-        fprintf(stderr, "Bad read from fd %d: %s\n", in, line.c_str());
-        return -1;
+    vector<std::thread> workers;
+    for (size_t part = 1; part < threads; part++) {
+        workers.emplace_back(parseRows, part);
+    }
+    parseRows(0);
+    for (std::thread& worker : workers) {
+        worker.join();
     }
 
-    if (!proto.flush(out)) {
-        fprintf(stderr, "[%s]Error writing proto back\n", this->name.c_str());
-        return -1;
+    size_t size = 0;
+    for (ProtoOutputStream& proto : protos) {
+        if (!proto.flush(out)) {
+            fprintf(stderr, "[%s]Error writing proto back\n", this->name.c_str());
+            return -1;
+        }
+        size += proto.size();
     }
-    fprintf(stderr, "[%s]Proto size: %zu bytes\n", this->name.c_str(), proto.size());
+    fprintf(stderr, "[%s]Proto size: %zu bytes\n", this->name.c_str(), size);
     return NO_ERROR;
 }
@@ -99,6 +99,36 @@ TEST(IhUtilTest, ParseRecordByColumns) {
     EXPECT_EQ(expected, result);
 }
 
+TEST(IhUtilTest, ParseRecordView) {
+    record_view_t result;
+    std::string line = "   abc , 1234 ,,, ";
+
+    parseRecordView(line, &result, ",");
+    record_view_t expected = { "abc", "1234" };
+    EXPECT_EQ(expected, result);
+    // The values are not copied out of the line.
+    EXPECT_EQ(line.data() + 3, result[0].data());
+
+    // The record is cleared before it is reused.
+    parseRecordView("a b", &result);
+    expected = { "a", "b" };
+    EXPECT_EQ(expected, result);
+
+    std::vector<int> indices = { 3, 10 };
+    parseRecordByColumnsView("abc \t2345  6789 ", indices, &result);
+    expected = { "abc", "2345  6789" };
+    EXPECT_EQ(expected, result);
+
+    parseRecordByColumnsView("12345", indices, &result);
+    EXPECT_TRUE(result.empty());
+}
+
+TEST(IhUtilTest, SplitLines) {
+    std::vector<std::string_view> expected = { "line 1", "  line 2", "line 3" };
+    EXPECT_EQ(expected, splitLines("line 1\r\n\n  line 2\n\nline 3"));
+    EXPECT_TRUE(splitLines("\n\r\n").empty());
+}
+
 TEST(IhUtilTest, stripPrefix) {
     string data1 = "Swap: abc ";
     EXPECT_TRUE(stripPrefix(&data1, "Swap:"));
@@ -23,9 +23,13 @@
 
 #include <android-base/file.h>
 #include <android/util/protobuf.h>
+#include <android/util/ProtoBufferReader.h>
 #include <android/util/ProtoFileReader.h>
 #include <log/log.h>
 
+#include <algorithm>
+#include <string.h>
+
 namespace android {
 namespace os {
 namespace incidentd {
@@ -77,170 +81,253 @@ void write_field_or_skip(ProtoOutputStream* out, const sp<ProtoReader>& in,
     }
 }
 
+// ================================================================================
 /**
- * Strip next field based on its private policy and request spec, then stores data in buf.
- * Return NO_ERROR if succeeds, otherwise BAD_VALUE is returned to indicate bad data in
- * FdBuffer.
- *
- * The iterator must point to the head of a protobuf formatted field for successful operation.
- * After exit with NO_ERROR, iterator points to the next protobuf field's head.
- *
- * depth is the depth of recursion, for debugging.
+ * The size of the buffer each privacy level is written through.
  */
-status_t strip_field(ProtoOutputStream* out, const sp<ProtoReader>& in,
-        const Privacy* parentPolicy, const PrivacySpec& spec, int depth) {
-    if (!in->hasNext() || parentPolicy == NULL) {
-        return BAD_VALUE;
-    }
-    uint32_t fieldTag = in->readRawVarint();
-    uint32_t fieldId = read_field_id(fieldTag);
-    const Privacy* policy = lookup(parentPolicy, fieldId);
+static const size_t LEVEL_BUFFER_SIZE = 16 * 1024;
 
-    if (policy == NULL || policy->children == NULL) {
-        bool skip = !spec.CheckPremission(policy, parentPolicy->policy);
-        // iterator will point to head of next field
-        size_t currentAt = in->bytesRead();
-        write_field_or_skip(out, in, fieldTag, skip);
-        return NO_ERROR;
-    }
-    // current field is message type and its sub-fields have extra privacy policies
-    uint32_t msgSize = in->readRawVarint();
-    size_t start = in->bytesRead();
-    uint64_t token = out->start(encode_field_id(policy));
-    while (in->bytesRead() - start != msgSize) {
-        status_t err = strip_field(out, in, policy, spec, depth + 1);
-        if (err != NO_ERROR) {
-            ALOGW("Bad value when stripping id %d, wiretype %d, tag %#x, depth %d, size %d, "
-                    "relative pos %zu, ", fieldId, read_wire_type(fieldTag), fieldTag, depth,
-                    msgSize, in->bytesRead() - start);
-            return err;
-        }
-    }
-    out->end(token);
-    return NO_ERROR;
-}
-
-// ================================================================================
-class FieldStripper {
-public:
-    FieldStripper(const Privacy* restrictions, const sp<ProtoReader>& data,
-            uint8_t bufferLevel);
-
-    ~FieldStripper();
-
-    /**
-     * Take the data that we have, and filter it down so that no fields
-     * are more sensitive than the given privacy policy.
-     */
-    status_t strip(uint8_t privacyPolicy);
+/**
+ * The outputs that want the data filtered to one privacy level, and the buffer
+ * their data is written through.
+ */
+struct PrivacyLevel {
+    PrivacyLevel(uint8_t privacyPolicy);
 
     /**
-     * At the current filter level, how many bytes of data there is.
+     * Append data for all of the outputs, writing the buffer out when it is full.
      */
-    ssize_t dataSize() const { return mSize; }
+    void append(uint8_t const* data, size_t size);
 
     /**
-     * Write the data from the current filter level to the file descriptor.
+     * Write what is left in the buffer to the outputs. Outputs that fail are
+     * told so and dropped.
      */
-    status_t writeData(int fd);
+    void flush();
 
-private:
-    /**
-     * The global set of field --> required privacy level mapping.
-     */
-    const Privacy* mRestrictions;
+    uint8_t privacyPolicy;
+    PrivacySpec spec;
+    vector<sp<FilterFd>> outputs;
 
     /**
-     * The current buffer.
+     * The size of the data filtered to this level.
      */
-    sp<ProtoReader> mData;
+    size_t size;
 
-    /**
-     * The current size of the buffer inside mData.
-     */
-    ssize_t mSize;
+    vector<uint8_t> buffer;
+    size_t used;
+};
 
-    /**
-     * The current privacy policy that the data is filtered to, as an optimization
-     * so we don't always re-filter data that has already been filtered.
-     */
-    uint8_t mCurrentLevel;
+PrivacyLevel::PrivacyLevel(uint8_t policy)
+        :privacyPolicy(policy),
+         spec(policy),
+         outputs(),
+         size(0),
+         buffer(),
+         used(0) {
+}
 
-    sp<EncodedBuffer> mEncodedBuffer;
-};
+void PrivacyLevel::append(uint8_t const* data, size_t dataSize) {
+    if (buffer.empty()) {
+        buffer.resize(LEVEL_BUFFER_SIZE);
+    }
+    while (dataSize > 0) {
+        if (used == buffer.size()) {
+            flush();
+        }
+        size_t n = std::min(dataSize, buffer.size() - used);
+        memcpy(buffer.data() + used, data, n);
+        used += n;
+        data += n;
+        dataSize -= n;
+    }
+}
 
-FieldStripper::FieldStripper(const Privacy* restrictions, const sp<ProtoReader>& data,
-            uint8_t bufferLevel)
-        :mRestrictions(restrictions),
-         mData(data),
-         mSize(data->size()),
-         mCurrentLevel(bufferLevel),
-         mEncodedBuffer(get_buffer_from_pool()) {
-    if (mSize < 0) {
-        ALOGW("FieldStripper constructed with a ProtoReader that doesn't support size."
-                " Data will be missing.");
+void PrivacyLevel::flush() {
+    for (auto it = outputs.begin(); it != outputs.end();) {
+        if (!WriteFully((*it)->getFd(), buffer.data(), used)) {
+            (*it)->onWriteError(-errno);
+            it = outputs.erase(it);
+        } else {
+            it++;
+        }
     }
+    used = 0;
 }
 
-FieldStripper::~FieldStripper() {
-    return_buffer_to_pool(mEncodedBuffer);
+/**
+ * Move past the payload of the field. Return how many bytes copy_field() writes for it.
+ */
+static size_t skip_field(ProtoBufferReader* in, uint32_t fieldTag) {
+    size_t size;
+    switch (read_wire_type(fieldTag)) {
+        case WIRE_TYPE_VARINT:
+            return get_varint_size(fieldTag) + get_varint_size(in->readRawVarint());
+        case WIRE_TYPE_FIXED64:
+            in->move(8);
+            return get_varint_size(fieldTag) + 8;
+        case WIRE_TYPE_LENGTH_DELIMITED:
+            size = in->readRawVarint();
+            in->move(size);
+            return get_varint_size(fieldTag) + get_varint_size(size) + size;
+        case WIRE_TYPE_FIXED32:
+            in->move(4);
+            return get_varint_size(fieldTag) + 4;
+        default:
+            return 0;
+    }
 }
 
-status_t FieldStripper::strip(const uint8_t privacyPolicy) {
-    // If the current strip level is less (fewer fields retained) than what's already in the
-    // buffer, then we can skip it.
-    if (mCurrentLevel < privacyPolicy) {
-        PrivacySpec spec(privacyPolicy);
-        mEncodedBuffer->clear();
-        ProtoOutputStream proto(mEncodedBuffer);
+/**
+ * Copy the field to each of the levels in the keep mask, or just move past it if there
+ * are none.
+ */
+static void copy_field(ProtoBufferReader* in, uint32_t fieldTag, vector<PrivacyLevel>* levels,
+        uint32_t keep) {
+    if (keep == 0) {
+        skip_field(in, fieldTag);
+        return;
+    }
 
-        // Optimization when no strip happens.
-        if (mRestrictions == NULL || spec.RequireAll()
-                // Do not iterate through fields if primitive data
-                || !mRestrictions->children /* != FieldDescriptor::TYPE_MESSAGE */) {
-            if (spec.CheckPremission(mRestrictions)) {
-                mSize = mData->size();
+    // A tag and a length, or a tag and a varint.
+    uint8_t header[20];
+    uint8_t* headerEnd = write_raw_varint(header, fieldTag);
+    size_t payloadSize = 0;
+    switch (read_wire_type(fieldTag)) {
+        case WIRE_TYPE_VARINT:
+            headerEnd = write_raw_varint(headerEnd, in->readRawVarint());
+            break;
+        case WIRE_TYPE_FIXED64:
+            payloadSize = 8;
+            break;
+        case WIRE_TYPE_LENGTH_DELIMITED:
+            payloadSize = in->readRawVarint();
+            headerEnd = write_raw_varint(headerEnd, payloadSize);
+            break;
+        case WIRE_TYPE_FIXED32:
+            payloadSize = 4;
+            break;
+        default:
+            return;
+    }
+
+    for (size_t i = 0; i < levels->size(); i++) {
+        if ((keep & (1u << i)) != 0) {
+            (*levels)[i].append(header, headerEnd - header);
+        }
+    }
+    while (payloadSize > 0) {
+        size_t n = std::min(payloadSize, in->currentToRead());
+        for (size_t i = 0; i < levels->size(); i++) {
+            if ((keep & (1u << i)) != 0) {
+                (*levels)[i].append(in->readBuffer(), n);
             }
-            return NO_ERROR;
         }
+        in->move(n);
+        payloadSize -= n;
+    }
+}
 
-        while (mData->hasNext()) {
-            status_t err = strip_field(&proto, mData, mRestrictions, spec, 0);
-            if (err != NO_ERROR) {
-                return err; // Error logged in strip_field.
+/**
+ * Measure the next field as it will be stripped for each of the levels, and add its size to
+ * sizes. For each message whose fields have privacy policies of their own, the size of its
+ * stripped fields at each level is appended to messageSizes, in the order the messages are met.
+ *
+ * Return NO_ERROR if succeeds, otherwise BAD_VALUE is returned to indicate bad data in
+ * FdBuffer. The iterator must point to the head of a protobuf formatted field for successful
+ * operation. After exit with NO_ERROR, iterator points to the next protobuf field's head.
+ *
+ * depth is the depth of recursion, for debugging.
+ */
+static status_t measure_field(ProtoBufferReader* in, const Privacy* parentPolicy,
+        const vector<PrivacyLevel>& levels, size_t* sizes, vector<size_t>* messageSizes,
+        int depth) {
+    if (!in->hasNext() || parentPolicy == NULL) {
+        return BAD_VALUE;
+    }
+    uint32_t fieldTag = in->readRawVarint();
+    uint32_t fieldId = read_field_id(fieldTag);
+    const Privacy* policy = lookup(parentPolicy, fieldId);
+
+    if (policy == NULL || policy->children == NULL) {
+        size_t fieldSize = skip_field(in, fieldTag);
+        for (size_t i = 0; i < levels.size(); i++) {
+            if (levels[i].spec.CheckPremission(policy, parentPolicy->policy)) {
+                sizes[i] += fieldSize;
             }
         }
-
-        if (mData->bytesRead() != mData->size()) {
-            ALOGW("Buffer corrupted: expect %zu bytes, read %zu bytes", mData->size(),
-                    mData->bytesRead());
-            return BAD_VALUE;
+        return NO_ERROR;
+    }
+    // current field is message type and its sub-fields have extra privacy policies
+    uint32_t msgSize = in->readRawVarint();
+    size_t start = in->bytesRead();
+    size_t index = messageSizes->size();
+    messageSizes->resize(index + levels.size(), 0);
+    vector<size_t> childSizes(levels.size(), 0);
+    while (in->bytesRead() - start != msgSize) {
+        status_t err = measure_field(in, policy, levels, childSizes.data(), messageSizes,
+                depth + 1);
+        if (err != NO_ERROR) {
+            ALOGW("Bad value when stripping id %d, wiretype %d, tag %#x, depth %d, size %d, "
+                    "relative pos %zu, ", fieldId, read_wire_type(fieldTag), fieldTag, depth,
+                    msgSize, in->bytesRead() - start);
+            return err;
+        }
+    }
+    // Like ProtoOutputStream, messages that end up empty are left out entirely.
+    size_t tagSize = get_varint_size((policy->field_id << FIELD_ID_SHIFT)
+            | WIRE_TYPE_LENGTH_DELIMITED);
+    for (size_t i = 0; i < levels.size(); i++) {
+        (*messageSizes)[index + i] = childSizes[i];
+        if (childSizes[i] > 0) {
+            sizes[i] += tagSize + get_varint_size(childSizes[i]) + childSizes[i];
         }
-
-        mData = proto.data();
-        mSize = proto.size();
-        mCurrentLevel = privacyPolicy;
     }
     return NO_ERROR;
 }
 
-status_t FieldStripper::writeData(int fd) {
-    status_t err = NO_ERROR;
-    sp<ProtoReader> reader = mData;
-    if (mData == nullptr) {
-        // There had been an error processing the data. We won't write anything,
-        // but we also won't return an error, because errors are fatal.
-        return NO_ERROR;
+/**
+ * Write the next field, stripped, to each of the levels in the active mask. The field must
+ * have been measured by measure_field(), nextMessage is the index of the next message in
+ * messageSizes.
+ */
+static void write_field(ProtoBufferReader* in, const Privacy* parentPolicy,
+        vector<PrivacyLevel>* levels, uint32_t active, const vector<size_t>& messageSizes,
+        size_t* nextMessage) {
+    uint32_t fieldTag = in->readRawVarint();
+    const Privacy* policy = lookup(parentPolicy, read_field_id(fieldTag));
+
+    if (policy == NULL || policy->children == NULL) {
+        uint32_t keep = 0;
+        for (size_t i = 0; i < levels->size(); i++) {
+            if ((active & (1u << i)) != 0
+                    && (*levels)[i].spec.CheckPremission(policy, parentPolicy->policy)) {
+                keep |= 1u << i;
+            }
+        }
+        copy_field(in, fieldTag, levels, keep);
+        return;
+    }
+    uint32_t msgSize = in->readRawVarint();
+    size_t start = in->bytesRead();
+    size_t index = *nextMessage;
+    *nextMessage += levels->size();
+    uint32_t keep = 0;
+    for (size_t i = 0; i < levels->size(); i++) {
+        size_t childSize = messageSizes[index + i];
+        if ((active & (1u << i)) != 0 && childSize > 0) {
+            uint8_t header[20];
+            uint8_t* headerEnd = write_length_delimited_tag_header(header, policy->field_id,
+                    childSize);
+            (*levels)[i].append(header, headerEnd - header);
+            keep |= 1u << i;
+        }
     }
-    while (reader->readBuffer() != NULL) {
-        err = WriteFully(fd, reader->readBuffer(), reader->currentToRead()) ? NO_ERROR : -errno;
-        reader->move(reader->currentToRead());
-        if (err != NO_ERROR) return err;
+    while (in->bytesRead() - start != msgSize) {
+        write_field(in, policy, levels, keep, messageSizes, nextMessage);
     }
-    return NO_ERROR;
 }
 
-
 // ================================================================================
 FilterFd::FilterFd(uint8_t privacyPolicy, int fd)
         :mPrivacyPolicy(privacyPolicy),
@@ -266,52 +353,125 @@ void PrivacyFilter::addFd(const sp<FilterFd>& output) {
 
 status_t PrivacyFilter::writeData(const FdBuffer& buffer, uint8_t bufferLevel,
         size_t* maxSize) {
-    status_t err;
+    status_t err = NO_ERROR;
 
     if (maxSize != NULL) {
         *maxSize = 0;
     }
 
-    // Order the writes by privacy filter, with increasing levels of filtration,k
-    // so we can do the filter once, and then write many times.
-    sort(mOutputs.begin(), mOutputs.end(),
-        [](const sp<FilterFd>& a, const sp<FilterFd>& b) -> bool {
-            return a->getPrivacyPolicy() < b->getPrivacyPolicy();
-        });
-
-    uint8_t privacyPolicy = PRIVACY_POLICY_LOCAL; // a.k.a. no filtering
-    FieldStripper fieldStripper(mRestrictions, buffer.data()->read(), bufferLevel);
+    // Group the outputs by privacy policy. The outputs that need no filtering are written
+    // straight from the buffer, the others are filtered to all of their levels at once.
+    // Since a nested message's size is written before its fields, the data is walked twice:
+    // once to measure each level, and once to write each level through a small buffer. The
+    // filtered data is never held in memory as a whole.
+    vector<PrivacyLevel> rawLevels;
+    vector<PrivacyLevel> strippedLevels;
     for (const sp<FilterFd>& output: mOutputs) {
-        // Do another level of filtering if necessary
-        if (privacyPolicy != output->getPrivacyPolicy()) {
-            privacyPolicy = output->getPrivacyPolicy();
-            err = fieldStripper.strip(privacyPolicy);
+        uint8_t privacyPolicy = output->getPrivacyPolicy();
+        PrivacySpec spec(privacyPolicy);
+        // Optimization when no strip happens.
+        bool raw = privacyPolicy <= bufferLevel || mRestrictions == NULL || spec.RequireAll()
+                // Do not iterate through fields if primitive data
+                || !mRestrictions->children /* != FieldDescriptor::TYPE_MESSAGE */;
+        vector<PrivacyLevel>* levels = raw ? &rawLevels : &strippedLevels;
+        auto level = std::find_if(levels->begin(), levels->end(),
+                [privacyPolicy](const PrivacyLevel& l) {
+                    return l.privacyPolicy == privacyPolicy;
+                });
+        if (level == levels->end()) {
+            levels->emplace_back(privacyPolicy);
+            level = levels->end() - 1;
+        }
+        level->outputs.push_back(output);
+    }
+
+    for (PrivacyLevel& level: rawLevels) {
+        level.size = buffer.size();
+    }
+
+    // The data is walked in place, chunk by chunk.
+    vector<struct iovec> iovecs;
+    buffer.data()->getIovecs(&iovecs);
+
+    vector<size_t> messageSizes;
+    if (!strippedLevels.empty()) {
+        vector<size_t> sizes(strippedLevels.size(), 0);
+        ProtoBufferReader reader(iovecs);
+        while (reader.hasNext()) {
+            err = measure_field(&reader, mRestrictions, strippedLevels, sizes.data(),
+                    &messageSizes, 0);
             if (err != NO_ERROR) {
-                // We can't successfully strip this data.  We will skip
-                // the rest of this section.
-                return NO_ERROR;
+                break; // Error logged in measure_field.
             }
         }
+        if (err == NO_ERROR && !reader.ok()) {
+            ALOGW("Buffer corrupted: expect %zu bytes, the last field runs past them",
+                    reader.size());
+            err = BAD_VALUE;
+        }
+        if (err != NO_ERROR) {
+            // We can't successfully strip this data.  We will skip
+            // the rest of this section.
+            strippedLevels.clear();
+        }
+        for (size_t i = 0; i < strippedLevels.size(); i++) {
+            strippedLevels[i].size = sizes[i];
+        }
+    }
 
-        // Write the resultant buffer to the fd, along with the header.
-        ssize_t dataSize = fieldStripper.dataSize();
-        if (dataSize > 0) {
-            err = write_section_header(output->getFd(), mSectionId, dataSize);
-            if (err != NO_ERROR) {
-                output->onWriteError(err);
-                continue;
+    // The section header goes out along with the data, in the same writev() for the data that
+    // is written as is, and through the level's buffer for the data that is stripped.
+    for (PrivacyLevel& level: rawLevels) {
+        if (level.size == 0) {
+            continue;
+        }
+        uint8_t header[20];
+        uint8_t* headerEnd = write_length_delimited_tag_header(header, mSectionId, level.size);
+        for (auto output = level.outputs.begin(); output != level.outputs.end();) {
+            vector<struct iovec> sectionIovecs = {{header, (size_t)(headerEnd - header)}};
+            sectionIovecs.insert(sectionIovecs.end(), iovecs.begin(), iovecs.end());
+            if (!writev_fully((*output)->getFd(), &sectionIovecs)) {
+                (*output)->onWriteError(-errno);
+                output = level.outputs.erase(output);
+            } else {
+                output++;
             }
+        }
+    }
 
-            err = fieldStripper.writeData(output->getFd());
-            if (err != NO_ERROR) {
-                output->onWriteError(err);
-                continue;
+    for (PrivacyLevel& level: strippedLevels) {
+        if (level.size > 0) {
+            uint8_t header[20];
+            uint8_t* headerEnd = write_length_delimited_tag_header(header, mSectionId,
+                    level.size);
+            level.append(header, headerEnd - header);
+        }
+    }
+
+    if (!strippedLevels.empty()) {
+        uint32_t active = 0;
+        for (size_t i = 0; i < strippedLevels.size(); i++) {
+            if (strippedLevels[i].size > 0) {
+                active |= 1u << i;
             }
         }
+        ProtoBufferReader reader(iovecs);
+        size_t nextMessage = 0;
+        while (reader.hasNext()) {
+            write_field(&reader, mRestrictions, &strippedLevels, active, messageSizes,
+                    &nextMessage);
+        }
+        for (PrivacyLevel& level: strippedLevels) {
+            level.flush();
+        }
+    }
 
-        if (maxSize != NULL) {
-            if (dataSize > *maxSize) {
-                *maxSize = dataSize;
+    if (maxSize != NULL) {
+        for (vector<PrivacyLevel>* levels : {&rawLevels, &strippedLevels}) {
+            for (const PrivacyLevel& level: *levels) {
+                if (!level.outputs.empty() && level.size > *maxSize) {
+                    *maxSize = level.size;
+                }
             }
         }
     }
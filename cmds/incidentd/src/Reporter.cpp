@@ -32,13 +32,16 @@
 #include <private/android_filesystem_config.h>
 #include <utils/SystemClock.h>
 
+#include <deque>
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <sys/prctl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <string>
+#include <thread>
 #include <time.h>
 #include <wait.h>
 
@@ -56,6 +59,12 @@ const int FIELD_ID_METADATA = 2;
 // Args for exec gzip
 static const char* GZIP[] = {"/system/bin/gzip", NULL};
 
+/**
+ * How many sections execute at the same time. Slow sections, like dumpsys ones, then no longer
+ * hold up the fast ones behind them.
+ */
+static const size_t MAX_CONCURRENT_SECTIONS = 4;
+
 IncidentMetadata_Destination privacy_policy_to_dest(uint8_t privacyPolicy) {
     switch (privacyPolicy) {
         case PRIVACY_POLICY_AUTOMATIC:
@@ -385,7 +394,9 @@ void ReportBatch::removeRequest(const sp<ReportRequest>& request) {
 ReportWriter::ReportWriter(const sp<ReportBatch>& batch)
         :mBatch(batch),
          mPersistedFile(),
-         mMaxPersistedPrivacyPolicy(PRIVACY_POLICY_UNSET) {
+         mMaxPersistedPrivacyPolicy(PRIVACY_POLICY_UNSET),
+         mMaxSectionDataFilteredSize(0),
+         mDeferred(false) {
 }
 
 ReportWriter::~ReportWriter() {
@@ -411,6 +422,8 @@ void ReportWriter::startSection(int sectionId) {
     mSectionBufferSuccess = false;
     mHadError = false;
     mSectionErrors.clear();
+    mMaxSectionDataFilteredSize = 0;
+    mDeferredData = nullptr;
 }
 
 void ReportWriter::setSectionStats(const FdBuffer& buffer) {
@@ -493,6 +506,17 @@ void ReportWriter::vflog(const Section* section, status_t err, int level, const
 
 // Reads data from FdBuffer and writes it to the requests file descriptor.
 status_t ReportWriter::writeSection(const FdBuffer& buffer) {
+    if (mDeferred) {
+        // The section's buffer goes back to the pool once it returns, so keep a copy.
+        FdBuffer copy(new EncodedBuffer());
+        status_t err = copy.write(buffer.data()->read());
+        if (err != NO_ERROR) {
+            return err;
+        }
+        mDeferredData = copy.data();
+        return NO_ERROR;
+    }
+
     PrivacyFilter filter(mCurrentSectionId, get_privacy_of_section(mCurrentSectionId));
 
     // Add the fd for the persisted requests
@@ -514,6 +538,21 @@ status_t ReportWriter::writeSection(const FdBuffer& buffer) {
     return filter.writeData(buffer, PRIVACY_POLICY_LOCAL, &mMaxSectionDataFilteredSize);
 }
 
+void ReportWriter::setDeferred(bool deferred) {
+    mDeferred = deferred;
+}
+
+status_t ReportWriter::writeDeferredSection(IncidentMetadata::SectionStats* sectionMetadata) {
+    if (mDeferredData == nullptr) {
+        return NO_ERROR;
+    }
+    mDeferred = false;
+    status_t err = writeSection(FdBuffer(mDeferredData));
+    mDeferredData = nullptr;
+    sectionMetadata->set_report_size_bytes(mMaxSectionDataFilteredSize);
+    return err;
+}
+
 
 // ================================================================================
 Reporter::Reporter(const sp<WorkDirectory>& workDirectory,
@@ -635,19 +674,15 @@ void Reporter::runReport(size_t* reportByteSize) {
 
     // For each of the report fields, see if we need it, and if so, execute the command
     // and report to those that care that we're doing it.
-    for (const Section** section = SECTION_LIST; *section; section++) {
-        if (execute_section(*section, &metadata, reportByteSize) != NO_ERROR) {
-            goto DONE;
+    {
+        vector<const Section*> sections;
+        for (const Section** section = SECTION_LIST; *section; section++) {
+            sections.push_back(*section);
         }
+        sections.insert(sections.end(), mRegisteredSections.begin(), mRegisteredSections.end());
+        execute_sections(sections, &metadata, reportByteSize);
     }
 
-    for (const Section* section : mRegisteredSections) {
-        if (execute_section(section, &metadata, reportByteSize) != NO_ERROR) {
-            goto DONE;
-        }
-    }
-
-DONE:
     // Finish up the persisted file.
     if (mPersistedFile != nullptr) {
         mPersistedFile->closeDataFile();
@@ -702,17 +737,66 @@ DONE:
     ALOGI("Done taking incident report err=%s", strerror(-err));
 }
 
-status_t Reporter::execute_section(const Section* section, IncidentMetadata* metadata,
-        size_t* reportByteSize) {
-    const int sectionId = section->id;
+/**
+ * A section executing on a thread of its own, with a ReportWriter that keeps its data until it
+ * is its turn to be written.
+ */
+struct Reporter::SectionRun {
+    const Section* section;
+    ReportWriter writer;
+    IncidentMetadata::SectionStats stats;
+    status_t err;
+    int64_t cpuTimeMs;
+    std::thread thread;
+
+    SectionRun(const Section* s, const ReportWriter& w)
+            :section(s),
+             writer(w),
+             err(NO_ERROR),
+             cpuTimeMs(0) {
+    }
+};
 
-    // If nobody wants this section, skip it.
-    if (!mBatch->containsSection(sectionId)) {
-        return NO_ERROR;
+static int64_t thread_cpu_time_ms() {
+    struct timespec spec;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &spec);
+    return spec.tv_sec * 1000 + spec.tv_nsec / 1000000;
+}
+
+status_t Reporter::execute_sections(const vector<const Section*>& sections,
+        IncidentMetadata* metadata, size_t* reportByteSize) {
+    // Sections are written strictly in order, so a section only starts once the one
+    // MAX_CONCURRENT_SECTIONS before it has been written. That also bounds how much finished
+    // but unwritten data is kept in memory.
+    std::deque<unique_ptr<SectionRun>> running;
+    status_t err = NO_ERROR;
+    auto next = sections.begin();
+    while (err == NO_ERROR) {
+        while (next != sections.end() && running.size() < MAX_CONCURRENT_SECTIONS) {
+            const Section* section = *next++;
+            // If nobody wants this section, skip it.
+            if (mBatch->containsSection(section->id)) {
+                running.push_back(start_section(section));
+            }
+        }
+        if (running.empty()) {
+            break;
+        }
+        unique_ptr<SectionRun> run = std::move(running.front());
+        running.pop_front();
+        err = finish_section(run.get(), metadata, reportByteSize);
     }
 
+    // After a fatal error, the sections that already started are waited for and dropped.
+    for (const unique_ptr<SectionRun>& run : running) {
+        run->thread.join();
+    }
+    return err;
+}
+
+unique_ptr<Reporter::SectionRun> Reporter::start_section(const Section* section) {
+    const int sectionId = section->id;
     ALOGD("Start incident report section %d '%s'", sectionId, section->name.c_str());
-    IncidentMetadata::SectionStats* sectionMetadata = metadata->add_sections();
 
     // Notify listener of starting
     mBatch->forEachListener(sectionId, [sectionId](const auto& listener) {
@@ -720,19 +804,42 @@ status_t Reporter::execute_section(const Section* section, IncidentMetadata* met
                 sectionId, IIncidentReportStatusListener::STATUS_STARTING);
     });
 
-    // Go get the data and write it into the file descriptors.
-    mWriter.startSection(sectionId);
-    status_t err = section->Execute(&mWriter);
-    mWriter.endSection(sectionMetadata);
+    // Go get the data, it is written into the file descriptors by finish_section().
+    unique_ptr<SectionRun> run = make_unique<SectionRun>(section, mWriter);
+    run->writer.setDeferred(true);
+    SectionRun* r = run.get();
+    r->thread = std::thread([r]() {
+        const int64_t cpuStartMs = thread_cpu_time_ms();
+        r->writer.startSection(r->section->id);
+        r->err = r->section->Execute(&r->writer);
+        r->writer.endSection(&r->stats);
+        r->cpuTimeMs = thread_cpu_time_ms() - cpuStartMs;
+    });
+    return run;
+}
+
+status_t Reporter::finish_section(SectionRun* run, IncidentMetadata* metadata,
+        size_t* reportByteSize) {
+    run->thread.join();
+    const Section* section = run->section;
+    const int sectionId = section->id;
+
+    // The persisted file may have been dropped since the section started.
+    run->writer.setPersistedFile(mPersistedFile);
+    status_t err = run->err;
+    if (err == NO_ERROR) {
+        err = run->writer.writeDeferredSection(&run->stats);
+    }
+    *metadata->add_sections() = run->stats;
 
     // Sections returning errors are fatal. Most errors should not be fatal.
     if (err != NO_ERROR) {
-        mWriter.error(section, err, "Section failed. Stopping report.");
+        run->writer.error(section, err, "Section failed. Stopping report.");
         return err;
     }
 
     // The returned max data size is used for throttling too many incident reports.
-    (*reportByteSize) += sectionMetadata->report_size_bytes();
+    (*reportByteSize) += run->stats.report_size_bytes();
 
     // For any requests that failed during this section, remove them now.  We do this
     // before calling back about section finished, so listeners do not erroniously get the
@@ -747,7 +854,9 @@ status_t Reporter::execute_section(const Section* section, IncidentMetadata* met
                     sectionId, IIncidentReportStatusListener::STATUS_FINISHED);
     });
 
-    ALOGD("Finish incident report section %d '%s'", sectionId, section->name.c_str());
+    ALOGD("Finish incident report section %d '%s' (%" PRId64 " ms, %" PRId64 " ms cpu)",
+            sectionId, section->name.c_str(), (int64_t)run->stats.exec_duration_ms(),
+            run->cpuTimeMs);
     return NO_ERROR;
 }
 
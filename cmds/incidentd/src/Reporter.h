@@ -27,6 +27,7 @@
 #include <android/util/protobuf.h>
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -207,6 +208,19 @@ public:
 
     status_t writeSection(const FdBuffer& buffer);
 
+    /**
+     * Makes writeSection() keep a copy of the data instead of writing it out, so that the
+     * section can execute on a thread of its own. writeDeferredSection() writes it out later,
+     * once the sections before it have been written.
+     */
+    void setDeferred(bool deferred);
+
+    /**
+     * Writes the data kept by a deferred writeSection(), if any, and sets the report size in
+     * the stats that endSection() filled in.
+     */
+    status_t writeDeferredSection(IncidentMetadata::SectionStats* sectionStats);
+
 private:
     // Data about all requests
     sp<ReportBatch> mBatch;
@@ -251,6 +265,12 @@ private:
     string mSectionErrors;
     size_t mMaxSectionDataFilteredSize;
 
+    /**
+     * Whether writeSection() keeps the data in mDeferredData instead of writing it.
+     */
+    bool mDeferred;
+    sp<EncodedBuffer> mDeferredData;
+
     void vflog(const Section* section, status_t err, int level, const char* levelText,
         const char* format, va_list args);
 };
@@ -274,8 +294,12 @@ private:
     sp<ReportFile> mPersistedFile;
     const vector<BringYourOwnSection*>& mRegisteredSections;
 
-    status_t execute_section(const Section* section, IncidentMetadata* metadata,
+    struct SectionRun;
+
+    status_t execute_sections(const vector<const Section*>& sections, IncidentMetadata* metadata,
         size_t* reportByteSize);
+    unique_ptr<SectionRun> start_section(const Section* section);
+    status_t finish_section(SectionRun* run, IncidentMetadata* metadata, size_t* reportByteSize);
 
     void cancel_and_remove_failed_requests();
 };
@@ -503,16 +503,22 @@ status_t ReportFile::save_envelope_impl(bool cleanup) {
     status_t err;
     err = write_proto(mEnvelope, mEnvelopeFileName);
     if (err != NO_ERROR) {
+        mWorkDirectory->forget_envelope(mEnvelopeFileName);
         // If there was an error writing the envelope, then delete the whole thing.
         if (cleanup) {
             mWorkDirectory->remove(this);
         }
         return err;
     }
+    mWorkDirectory->cache_envelope(mEnvelopeFileName, mEnvelope);
     return NO_ERROR;
 }
 
 status_t ReportFile::load_envelope_impl(bool cleanup) {
+    if (mWorkDirectory->get_cached_envelope(mEnvelopeFileName, &mEnvelope)) {
+        return NO_ERROR;
+    }
+
     status_t err;
     err = read_proto(&mEnvelope, mEnvelopeFileName);
     if (err != NO_ERROR) {
@@ -522,6 +528,7 @@ status_t ReportFile::load_envelope_impl(bool cleanup) {
         }
         return err;
     }
+    mWorkDirectory->cache_envelope(mEnvelopeFileName, mEnvelope);
     return NO_ERROR;
 }
 
@@ -667,7 +674,12 @@ void WorkDirectory::commitAll(const string& pkg) {
             continue;
         }
 
+        // Most of the reports aren't for pkg, so leave those alone on disk.
+        const int reportCount = reportFile->getEnvelope().report_size();
         reportFile->removeReports(pkg);
+        if (reportFile->getEnvelope().report_size() == reportCount) {
+            continue;
+        }
 
         delete_files_for_report_if_necessary(reportFile);
     }
@@ -675,10 +687,38 @@ void WorkDirectory::commitAll(const string& pkg) {
 
 void WorkDirectory::remove(const sp<ReportFile>& report) {
     unique_lock<mutex> lock(mLock);
+    unlink_report_files_locked(report->getEnvelopeFileName(), report->getDataFileName());
+}
+
+bool WorkDirectory::get_cached_envelope(const string& envelopeFileName,
+        ReportFileProto* envelope) {
+    unique_lock<mutex> lock(mEnvelopeCacheLock);
+    map<string, ReportFileProto>::const_iterator it = mEnvelopeCache.find(envelopeFileName);
+    if (it == mEnvelopeCache.end()) {
+        return false;
+    }
+    *envelope = it->second;
+    return true;
+}
+
+void WorkDirectory::cache_envelope(const string& envelopeFileName,
+        const ReportFileProto& envelope) {
+    unique_lock<mutex> lock(mEnvelopeCacheLock);
+    mEnvelopeCache[envelopeFileName] = envelope;
+}
+
+void WorkDirectory::forget_envelope(const string& envelopeFileName) {
+    unique_lock<mutex> lock(mEnvelopeCacheLock);
+    mEnvelopeCache.erase(envelopeFileName);
+}
+
+void WorkDirectory::unlink_report_files_locked(const string& envelopeFileName,
+        const string& dataFileName) {
     // Set this to false to leave files around for debugging.
     if (DO_UNLINK) {
-        unlink(report->getDataFileName().c_str());
-        unlink(report->getEnvelopeFileName().c_str());
+        unlink(dataFileName.c_str());
+        unlink(envelopeFileName.c_str());
+        forget_envelope(envelopeFileName);
     }
 }
 
@@ -826,8 +866,7 @@ void WorkDirectory::clean_directory_locked() {
                 it != files.end() && (totalSize >= mMaxDiskUsageBytes
                     || totalCount >= mMaxFileCount);
                 it++) {
-            unlink(it->second.envelope.c_str());
-            unlink(it->second.data.c_str());
+            unlink_report_files_locked(it->second.envelope, it->second.data);
             totalSize -= it->second.size;
             totalCount--;
         }
@@ -837,10 +876,12 @@ void WorkDirectory::clean_directory_locked() {
 void WorkDirectory::delete_files_for_report_if_necessary(const sp<ReportFile>& report) {
     if (report->getEnvelope().report_size() == 0) {
         ALOGI("Report %s is finished. Deleting from storage.", report->getId().c_str());
-        if (DO_UNLINK) {
-            unlink(report->getDataFileName().c_str());
-            unlink(report->getEnvelopeFileName().c_str());
-        }
+        unlink_report_files_locked(report->getEnvelopeFileName(), report->getDataFileName());
+    } else {
+        // Save which receivers are left, so the ones that have committed aren't sent
+        // the report again after incidentd restarts. The lock is held, so don't let a
+        // failed save remove the files.
+        report->trySaveEnvelope();
     }
 }
 
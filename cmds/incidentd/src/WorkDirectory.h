@@ -23,6 +23,7 @@
 
 #include <utils/RefBase.h>
 
+#include <map>
 #include <mutex>
 #include <string>
 
@@ -260,11 +261,24 @@ private:
     // the directory consistent.
     mutex mLock;
 
+    // The last envelope saved to or loaded from each envelope file, so loading an
+    // envelope again, e.g. for every broadcast or commit, doesn't read it from disk.
+    // Only incidentd writes the directory, so the cache can't go stale as long as
+    // every path that unlinks an envelope file also forgets it.
+    mutex mEnvelopeCacheLock;
+    map<string, ReportFileProto> mEnvelopeCache;
+
+    friend class ReportFile;
+    bool get_cached_envelope(const string& envelopeFileName, ReportFileProto* envelope);
+    void cache_envelope(const string& envelopeFileName, const ReportFileProto& envelope);
+    void forget_envelope(const string& envelopeFileName);
+
     int64_t make_timestamp_ns_locked();
     bool file_exists_locked(int64_t timestampNs);    
     off_t get_directory_contents_locked(map<string,WorkDirectoryEntry>* files, int64_t after);
     void clean_directory_locked();
     void delete_files_for_report_if_necessary(const sp<ReportFile>& report);
+    void unlink_report_files_locked(const string& envelopeFileName, const string& dataFileName);
 
     string make_filename(int64_t timestampNs, const string& extension);
 };
@@ -36,6 +36,11 @@
 #include <system/graphics.h>
 #include <ui/GraphicTypes.h>
 #include <ui/PixelFormat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <future>
+#include <vector>
 
 using namespace android;
 
@@ -136,7 +141,7 @@ static status_t notifyMediaScanner(const char* fileName) {
         close(fd);
         exit(result);
     }
-    wait(&status);
+    waitpid(pid, &status, 0);
 
     if (status < 0) {
         fprintf(stderr, "Unable to broadcast intent for media scanner.\n");
@@ -145,12 +150,54 @@ static status_t notifyMediaScanner(const char* fileName) {
     return NO_ERROR;
 }
 
-status_t capture(const DisplayId displayId,
-            const gui::CaptureArgs& captureArgs,
-            ScreenCaptureResults& outResult) {
+// Writes all of data to fd, retrying on short writes, which are common when stdout is a pipe.
+static bool writeFully(int fd, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t written = TEMP_FAILURE_RETRY(write(fd, p, size));
+        if (written <= 0) {
+            return false;
+        }
+        p += written;
+        size -= written;
+    }
+    return true;
+}
+
+static bool writeToFd(void* fdPtr, const void* data, size_t size) {
+    return writeFully(*static_cast<int*>(fdPtr), data, size);
+}
+
+// Writes h rows of rowBytes each, spaced strideBytes apart. Rows are gathered into large chunks
+// so that a padded buffer does not cost one write per row.
+static bool writeRows(int fd, const char* base, size_t rowBytes, size_t strideBytes, size_t h) {
+    if (rowBytes == strideBytes) {
+        return writeFully(fd, base, rowBytes * h);
+    }
+    constexpr size_t kChunkBytes = 1 << 20;
+    const size_t rowsPerChunk = std::max<size_t>(1, kChunkBytes / rowBytes);
+    std::vector<char> chunk(std::min(rowsPerChunk, h) * rowBytes);
+    for (size_t y = 0; y < h;) {
+        const size_t rows = std::min(rowsPerChunk, h - y);
+        for (size_t i = 0; i < rows; i++, y++) {
+            memcpy(chunk.data() + i * rowBytes, base + y * strideBytes, rowBytes);
+        }
+        if (!writeFully(fd, chunk.data(), rows * rowBytes)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+sp<SyncScreenCaptureListener> requestCapture(const DisplayId displayId,
+            const gui::CaptureArgs& captureArgs) {
     sp<SyncScreenCaptureListener> captureListener = new SyncScreenCaptureListener();
     ScreenshotClient::captureDisplay(displayId, captureArgs, captureListener);
+    return captureListener;
+}
 
+status_t waitForCapture(const sp<SyncScreenCaptureListener>& captureListener,
+            ScreenCaptureResults& outResult) {
     ScreenCaptureResults captureResults = captureListener->waitForResults();
     if (!captureResults.fenceResult.ok()) {
         fprintf(stderr, "Failed to take screenshot. Status: %d\n",
@@ -236,22 +283,10 @@ status_t saveImage(const char* fn, std::optional<AndroidBitmapCompressFormat> fo
         if (gainmapBase) {
             result = ABitmap_compressWithGainmap(&info, static_cast<ADataSpace>(dataspace), base,
                                                  gainmapBase, captureResults.hdrSdrRatio, *format,
-                                                 100, &fd,
-                                                 [](void* fdPtr, const void* data,
-                                                    size_t size) -> bool {
-                                                     int bytesWritten =
-                                                             write(*static_cast<int*>(fdPtr), data,
-                                                                   size);
-                                                     return bytesWritten == size;
-                                                 });
+                                                 100, &fd, writeToFd);
         } else {
             result = AndroidBitmap_compress(&info, static_cast<int32_t>(dataspace), base, *format,
-                                            100, &fd,
-                                            [](void* fdPtr, const void* data, size_t size) -> bool {
-                                                int bytesWritten = write(*static_cast<int*>(fdPtr),
-                                                                         data, size);
-                                                return bytesWritten == size;
-                                            });
+                                            100, &fd, writeToFd);
         }
 
         if (result != ANDROID_BITMAP_RESULT_SUCCESS) {
@@ -268,14 +303,11 @@ status_t saveImage(const char* fn, std::optional<AndroidBitmapCompressFormat> fo
         uint32_t f = buffer->getPixelFormat();
         uint32_t c = dataSpaceToInt(dataspace);
 
-        write(fd, &w, 4);
-        write(fd, &h, 4);
-        write(fd, &f, 4);
-        write(fd, &c, 4);
+        const uint32_t header[] = {w, h, f, c};
         size_t Bpp = bytesPerPixel(f);
-        for (size_t y=0 ; y<h ; y++) {
-            write(fd, base, w*Bpp);
-            base = (void *)((char *)base + s*Bpp);
+        if (!writeFully(fd, header, sizeof(header)) ||
+            !writeRows(fd, static_cast<const char*>(base), w * Bpp, s * Bpp, h)) {
+            fprintf(stderr, "Error writing image (%s)\n", strerror(errno));
         }
     }
     close(fd);
@@ -426,22 +458,31 @@ int main(int argc, char** argv)
     ProcessState::self()->setThreadPoolMaxThreadCount(0);
     ProcessState::self()->startThreadPool();
 
-    std::vector<ScreenCaptureResults> results;
     const size_t numDisplays = displaysToCapture.size();
-    for (int i=0; i<numDisplays; i++) {
-        ScreenCaptureResults result;
-
-        // 1. Capture the screen
-        if (const status_t captureStatus =
-            capture(displaysToCapture[i], captureArgs, result) != 0) {
 
+    // 1. Capture the screens. All of the captures are requested before waiting for any of them,
+    // so that SurfaceFlinger can work on the displays concurrently.
+    std::vector<sp<SyncScreenCaptureListener>> captureListeners;
+    captureListeners.reserve(numDisplays);
+    for (const DisplayId displayId : displaysToCapture) {
+        captureListeners.push_back(requestCapture(displayId, captureArgs));
+    }
+    std::vector<ScreenCaptureResults> results(numDisplays);
+    for (int i=0; i<numDisplays; i++) {
+        if (const status_t captureStatus = waitForCapture(captureListeners[i], results[i]) != 0) {
             fprintf(stderr, "Capturing failed.\n");
             return captureStatus;
         }
+    }
 
-        // 2. Save the capture result as an image.
+    // 2. Save the capture results as images. Each display goes to its own file, so they are
+    // encoded in parallel; output to stdout is written one display at a time to keep it in order.
+    const bool saveInParallel = numDisplays > 1 && !baseName.empty();
+    std::vector<std::string> filenames(numDisplays);
+    std::vector<std::future<status_t>> saves;
+    for (int i=0; i<numDisplays; i++) {
         // When there's more than one file to capture, add the index as postfix.
-        std::string filename;
+        std::string& filename = filenames[i];
         if (!baseName.empty()) {
             filename = baseName;
             if (numDisplays > 1) {
@@ -454,7 +495,16 @@ int main(int argc, char** argv)
         if (!filename.empty()) {
             fn = filename.c_str();
         }
-        if (const status_t saveImageStatus = saveImage(fn, format, result) != 0) {
+        if (saveInParallel) {
+            saves.push_back(std::async(std::launch::async, saveImage, fn, format,
+                                       std::cref(results[i])));
+        } else if (const status_t saveImageStatus = saveImage(fn, format, results[i]) != 0) {
+            fprintf(stderr, "Saving image failed.\n");
+            return saveImageStatus;
+        }
+    }
+    for (auto& save : saves) {
+        if (const status_t saveImageStatus = save.get() != 0) {
             fprintf(stderr, "Saving image failed.\n");
             return saveImageStatus;
         }
@@ -48,6 +48,8 @@ namespace uinput {
 using src::com::android::commands::uinput::InputAbsInfo;
 
 static constexpr const char* UINPUT_PATH = "/dev/uinput";
+// Upper bound on the events buffered between SYN_REPORTs before they are written anyway.
+static constexpr size_t MAX_PENDING_EVENTS = 64;
 
 static struct {
     jmethodID onDeviceConfigure;
@@ -147,6 +149,7 @@ std::unique_ptr<UinputDevice> UinputDevice::open(int32_t id, const char* name, i
 UinputDevice::UinputDevice(int32_t id, android::base::unique_fd fd,
                            std::unique_ptr<DeviceCallback> callback)
       : mId(id), mFd(std::move(fd)), mDeviceCallback(std::move(callback)) {
+    mPendingEvents.reserve(MAX_PENDING_EVENTS);
     ALooper* aLooper = ALooper_forThread();
     if (aLooper == nullptr) {
         ALOGE("Could not get ALooper, ALooper_forThread returned NULL");
@@ -163,6 +166,7 @@ UinputDevice::UinputDevice(int32_t id, android::base::unique_fd fd,
 }
 
 UinputDevice::~UinputDevice() {
+    flushEvents();
     ::ioctl(mFd, UI_DEV_DESTROY);
 }
 
@@ -174,13 +178,33 @@ void UinputDevice::injectEvent(std::chrono::microseconds timestamp, uint16_t typ
     event.value = value;
     event.time.tv_sec = timestamp.count() / 1'000'000;
     event.time.tv_usec = timestamp.count() % 1'000'000;
+    mPendingEvents.push_back(event);
 
-    if (::write(mFd, &event, sizeof(input_event)) < 0) {
-        ALOGE("Could not write event %" PRIu16 " %" PRIu16 " with value %" PRId32 " : %s", type,
-              code, value, strerror(errno));
+    // evdev clients only see the events of a frame once its SYN_REPORT arrives, so buffer the
+    // frame and hand it to the kernel with one write instead of one write per event. This keeps
+    // the per-event syscall cost off high rate (1 kHz) touch and stylus recordings.
+    if ((type == EV_SYN && code == SYN_REPORT) || mPendingEvents.size() >= MAX_PENDING_EVENTS) {
+        flushEvents();
     }
 }
 
+void UinputDevice::flushEvents() {
+    if (mPendingEvents.empty()) {
+        return;
+    }
+    const size_t size = mPendingEvents.size() * sizeof(input_event);
+    ssize_t written = ::write(mFd, mPendingEvents.data(), size);
+    if (written < 0 || static_cast<size_t>(written) != size) {
+        const size_t failed = written < 0 ? 0 : written / sizeof(input_event);
+        const input_event& event = mPendingEvents[failed];
+        ALOGE("Could not write event %" PRIu16 " %" PRIu16 " with value %" PRId32
+              " (%zu of %zu events written) : %s",
+              event.type, event.code, event.value, failed, mPendingEvents.size(),
+              written < 0 ? strerror(errno) : "short write");
+    }
+    mPendingEvents.clear();
+}
+
 int UinputDevice::handleEvents(int events) {
     if (events & (ALOOPER_EVENT_ERROR | ALOOPER_EVENT_HANGUP)) {
         ALOGE("uinput node was closed or an error occurred. events=0x%x", events);
@@ -61,9 +61,14 @@ public:
 private:
     UinputDevice(int32_t id, android::base::unique_fd fd, std::unique_ptr<DeviceCallback> callback);
 
+    // Writes the pending events to the uinput node in a single call.
+    void flushEvents();
+
     int32_t mId;
     android::base::unique_fd mFd;
     std::unique_ptr<DeviceCallback> mDeviceCallback;
+    // Events of the current SYN_REPORT group, not yet written to the uinput node.
+    std::vector<input_event> mPendingEvents;
 };
 
 } // namespace uinput
@@ -14,11 +14,16 @@
  * limitations under the License.
  */
 
+#define ATRACE_TAG ATRACE_TAG_RESOURCES
+
 #include <jni.h>
 #include <core_jni_helpers.h>
 #include <utils/misc.h>
+#include <utils/Trace.h>
 #include <androidfw/ResourceTimer.h>
 
+#include <string>
+
 namespace android {
 
 // ----------------------------------------------------------------------------
@@ -41,6 +46,15 @@ static struct {
 
 // ----------------------------------------------------------------------------
 
+// Publish the percentiles of a timer as counter tracks, so that they can be lined up with the
+// rest of a trace.
+static void traceTimer(int counter, const ResourceTimer::Timer& timer) {
+  const std::string prefix = std::string("ResourceTimer.") +
+      ResourceTimer::toString(static_cast<ResourceTimer::Counter>(counter));
+  ATRACE_INT64((prefix + ".p50").c_str(), timer.pvalues.p50.nominal);
+  ATRACE_INT64((prefix + ".p90").c_str(), timer.pvalues.p90.nominal);
+  ATRACE_INT64((prefix + ".p99").c_str(), timer.pvalues.p99.nominal);
+}
 
 static int NativeGetTimers(JNIEnv* env, jobject /*clazz*/, jobjectArray timer, jboolean reset) {
   size_t size = ResourceTimer::counterSize;
@@ -71,6 +85,10 @@ static int NativeGetTimers(JNIEnv* env, jobject /*clazz*/, jobjectArray timer, j
     jintArray largest =
         reinterpret_cast<jintArray>(env->GetObjectField(dst, gTimerOffsets.largest));
     env->SetIntArrayRegion(largest, 0, ResourceTimer::Timer::MaxLargest, src.largest);
+
+    if (ATRACE_ENABLED()) {
+      traceTimer(i, src);
+    }
   }
   return size;
 }
@@ -31,6 +31,11 @@
 #include <utils/String16.h>
 #include <utils/String8.h>
 
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "android_database_SQLiteCommon.h"
 #include "core_jni_helpers.h"
 
@@ -53,6 +58,9 @@ namespace android {
  */
 static const int BUSY_TIMEOUT_MS = 2500;
 
+/* The number of finalized statements that a connection keeps prepared. */
+static const size_t MAX_CACHED_STATEMENTS = 16;
+
 static struct {
     jmethodID apply;
 } gUnaryOperator;
@@ -86,10 +94,52 @@ struct SQLiteConnection {
 
     volatile bool canceled;
 
+    // Statements that were finalized by the Java side but are kept prepared, keyed by their SQL,
+    // so that preparing the same SQL again does not compile it again. They have been reset and
+    // their bindings cleared. The most recently finalized statement is last.
+    std::vector<std::pair<std::string, sqlite3_stmt*>> cachedStatements;
+    uint32_t statementCacheHits;
+    uint32_t statementCacheMisses;
+
     SQLiteConnection(sqlite3* db, int openFlags, const String8& path, const String8& label) :
             db(db), openFlags(openFlags), path(path), label(label), tableQuery(nullptr),
-            canceled(false) { }
+            canceled(false), statementCacheHits(0), statementCacheMisses(0) { }
+
+    // Returns a cached statement for `sql` and removes it from the cache, or null.
+    sqlite3_stmt* takeCachedStatement(const char* sql) {
+        for (auto it = cachedStatements.rbegin(); it != cachedStatements.rend(); ++it) {
+            if (it->first == sql) {
+                sqlite3_stmt* statement = it->second;
+                cachedStatements.erase(std::next(it).base());
+                statementCacheHits++;
+                return statement;
+            }
+        }
+        statementCacheMisses++;
+        return nullptr;
+    }
+
+    // Keeps `statement` for reuse, finalizing it if it cannot be reset or the cache is full.
+    void cacheStatement(sqlite3_stmt* statement) {
+        const char* sql = sqlite3_sql(statement);
+        if (sql == nullptr || sqlite3_reset(statement) != SQLITE_OK ||
+                sqlite3_clear_bindings(statement) != SQLITE_OK) {
+            sqlite3_finalize(statement);
+            return;
+        }
+        if (cachedStatements.size() == MAX_CACHED_STATEMENTS) {
+            sqlite3_finalize(cachedStatements.front().second);
+            cachedStatements.erase(cachedStatements.begin());
+        }
+        cachedStatements.emplace_back(sql, statement);
+    }
 
+    void finalizeCachedStatements() {
+        for (const auto& [sql, statement] : cachedStatements) {
+            sqlite3_finalize(statement);
+        }
+        cachedStatements.clear();
+    }
 };
 
 // Called each time a statement begins execution, when tracing is enabled.
@@ -208,7 +258,9 @@ static void nativeClose(JNIEnv* env, jclass clazz, jlong connectionPtr) {
     SQLiteConnection* connection = reinterpret_cast<SQLiteConnection*>(connectionPtr);
 
     if (connection) {
-        ALOGV("Closing connection %p", connection->db);
+        ALOGV("Closing connection %p, statement cache hits=%u misses=%u", connection->db,
+                connection->statementCacheHits, connection->statementCacheMisses);
+        connection->finalizeCachedStatements();
         if (connection->tableQuery != nullptr) {
             sqlite3_finalize(connection->tableQuery);
         }
@@ -390,6 +442,16 @@ static jlong nativePrepareStatement(JNIEnv* env, jclass clazz, jlong connectionP
         jstring sqlString) {
     SQLiteConnection* connection = reinterpret_cast<SQLiteConnection*>(connectionPtr);
 
+    if (!connection->cachedStatements.empty()) {
+        const char* utf8Sql = env->GetStringUTFChars(sqlString, NULL);
+        sqlite3_stmt* statement = connection->takeCachedStatement(utf8Sql);
+        env->ReleaseStringUTFChars(sqlString, utf8Sql);
+        if (statement != nullptr) {
+            ALOGV("Reused statement %p on connection %p", statement, connection->db);
+            return reinterpret_cast<jlong>(statement);
+        }
+    }
+
     jsize sqlLength = env->GetStringLength(sqlString);
     const jchar* sql = env->GetStringCritical(sqlString, NULL);
     sqlite3_stmt* statement;
@@ -422,11 +484,11 @@ static void nativeFinalizeStatement(JNIEnv* env, jclass clazz, jlong connectionP
     SQLiteConnection* connection = reinterpret_cast<SQLiteConnection*>(connectionPtr);
     sqlite3_stmt* statement = reinterpret_cast<sqlite3_stmt*>(statementPtr);
 
-    // We ignore the result of sqlite3_finalize because it is really telling us about
-    // whether any errors occurred while executing the statement.  The statement itself
-    // is always finalized regardless.
+    // We ignore the result of sqlite3_reset and sqlite3_finalize because it is really telling
+    // us about whether any errors occurred while executing the statement.  The statement itself
+    // is always cached or finalized regardless.
     ALOGV("Finalized statement %p on connection %p", statement, connection->db);
-    sqlite3_finalize(statement);
+    connection->cacheStatement(statement);
 }
 
 static jint nativeGetParameterCount(JNIEnv* env, jclass clazz, jlong connectionPtr,
@@ -808,19 +870,25 @@ static CopyRowResult copyRow(JNIEnv* env, CursorWindow* window,
     return result;
 }
 
-static jlong nativeExecuteForCursorWindow(JNIEnv* env, jclass clazz,
-        jlong connectionPtr, jlong statementPtr, jlong windowPtr,
-        jint startPos, jint requiredPos, jboolean countAllRows) {
-    SQLiteConnection* connection = reinterpret_cast<SQLiteConnection*>(connectionPtr);
-    sqlite3_stmt* statement = reinterpret_cast<sqlite3_stmt*>(statementPtr);
-    CursorWindow* window = reinterpret_cast<CursorWindow*>(windowPtr);
+// The position of a statement that fills cursor windows. As long as the statement is not reset,
+// the next window can carry on from here instead of stepping over all the rows before its start
+// position again.
+struct WindowFillState {
+    // The number of rows that the statement has stepped over.
+    int totalRows = 0;
+    // Whether the statement is positioned on a row that did not fit into the previous window.
+    bool hasPendingRow = false;
+};
 
+// Clears the window and sets it up for the columns of `statement`.
+static bool prepareWindow(JNIEnv* env, SQLiteConnection* connection, sqlite3_stmt* statement,
+        CursorWindow* window) {
     status_t status = window->clear();
     if (status) {
         String8 msg;
         msg.appendFormat("Failed to clear the cursor window, status=%d", status);
         throw_sqlite3_exception(env, connection->db, msg.c_str());
-        return 0;
+        return false;
     }
 
     int numColumns = sqlite3_column_count(statement);
@@ -830,23 +898,38 @@ static jlong nativeExecuteForCursorWindow(JNIEnv* env, jclass clazz,
         msg.appendFormat("Failed to set the cursor window column count to %d, status=%d",
                 numColumns, status);
         throw_sqlite3_exception(env, connection->db, msg.c_str());
-        return 0;
+        return false;
     }
+    return true;
+}
 
+// Fills a prepared window with the rows of `statement` from `startPos`, moving `startPos`
+// forward if the window fills up before `requiredPos`. Stops at the first row that does not fit
+// unless `countAllRows` is set, in which case the remaining rows are stepped over and counted.
+//
+// Returns the number of rows added to the window. An exception may be pending afterwards.
+static int fillWindow(JNIEnv* env, SQLiteConnection* connection, sqlite3_stmt* statement,
+        CursorWindow* window, int& startPos, int requiredPos, bool countAllRows,
+        WindowFillState& state) {
+    const int numColumns = window->getNumColumns();
     int retryCount = 0;
-    int totalRows = 0;
     int addedRows = 0;
     bool windowFull = false;
     bool gotException = false;
     while (!gotException && (!windowFull || countAllRows)) {
-        int err = sqlite3_step(statement);
+        // A pending row was stepped to, but not copied, by the previous window.
+        int err = state.hasPendingRow ? SQLITE_ROW : sqlite3_step(statement);
         if (err == SQLITE_ROW) {
-            LOG_WINDOW("Stepped statement %p to row %d", statement, totalRows);
-            retryCount = 0;
-            totalRows += 1;
+            if (state.hasPendingRow) {
+                state.hasPendingRow = false;
+            } else {
+                LOG_WINDOW("Stepped statement %p to row %d", statement, state.totalRows);
+                retryCount = 0;
+                state.totalRows += 1;
+            }
 
             // Skip the row if the window is full or we haven't reached the start position yet.
-            if (startPos >= totalRows || windowFull) {
+            if (startPos >= state.totalRows || windowFull) {
                 continue;
             }
 
@@ -866,6 +949,8 @@ static jlong nativeExecuteForCursorWindow(JNIEnv* env, jclass clazz,
                 addedRows += 1;
             } else if (cpr == CPR_FULL) {
                 windowFull = true;
+                // Unless the remaining rows are counted, the statement stays on this row.
+                state.hasPendingRow = !countAllRows;
             } else {
                 gotException = true;
             }
@@ -891,12 +976,33 @@ static jlong nativeExecuteForCursorWindow(JNIEnv* env, jclass clazz,
         }
     }
 
-    LOG_WINDOW("Resetting statement %p after fetching %d rows and adding %d rows "
+    LOG_WINDOW("Stopped statement %p after fetching %d rows and adding %d rows "
             "to the window in %zu bytes",
-            statement, totalRows, addedRows, window->size() - window->freeSpace());
+            statement, state.totalRows, addedRows, window->size() - window->freeSpace());
+    return addedRows;
+}
+
+static jlong nativeExecuteForCursorWindow(JNIEnv* env, jclass clazz,
+        jlong connectionPtr, jlong statementPtr, jlong windowPtr,
+        jint startPos, jint requiredPos, jboolean countAllRows) {
+    SQLiteConnection* connection = reinterpret_cast<SQLiteConnection*>(connectionPtr);
+    sqlite3_stmt* statement = reinterpret_cast<sqlite3_stmt*>(statementPtr);
+    CursorWindow* window = reinterpret_cast<CursorWindow*>(windowPtr);
+
+    if (!prepareWindow(env, connection, statement, window)) {
+        return 0;
+    }
+
+    // The statement is reset before returning, so every call starts from the first row.
+    WindowFillState state;
+    int addedRows = fillWindow(env, connection, statement, window, startPos, requiredPos,
+            countAllRows, state);
+
+    LOG_WINDOW("Resetting statement %p", statement);
     sqlite3_reset(statement);
 
     // Report the total number of rows on request.
+    int totalRows = state.totalRows;
     if (startPos > totalRows) {
         ALOGE("startPos %d > actual rows %d", startPos, totalRows);
     }
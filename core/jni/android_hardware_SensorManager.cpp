@@ -394,8 +394,17 @@ private:
         ScopedLocalRef<jobject> receiverObj(env, GetReferent(env, mReceiverWeakGlobal));
 
         ssize_t n;
-        ASensorEvent buffer[16];
-        while ((n = q->read(buffer, 16)) > 0) {
+        // High-rate sensors fill the socket quickly, so drain it in large batches to keep the
+        // number of reads (and acks) per wakeup low.
+        constexpr size_t kEventBufferSize = 64;
+        ASensorEvent buffer[kEventBufferSize];
+        while ((n = q->read(buffer, kEventBufferSize)) > 0) {
+            if (!receiverObj.get()) {
+                // Nobody to deliver to; just acknowledge the events so wake-up sensors are
+                // released.
+                mSensorQueue->sendAck(buffer, n);
+                continue;
+            }
             for (int i=0 ; i<n ; i++) {
                 if (buffer[i].type == SENSOR_TYPE_STEP_COUNTER) {
                     // step-counter returns a uint64, but the java API only deals with floats
@@ -25,6 +25,7 @@
 #include <usbhost/usbhost_jni.h>
 
 #include <chrono>
+#include <vector>
 
 #include "core_jni_helpers.h"
 #include "jni.h"
@@ -35,6 +36,9 @@ using namespace std::chrono;
 
 static const int USB_CONTROL_READ_TIMEOUT_MS = 200;
 
+// Bulk transfer buffers up to this size are kept per thread and reused across transfers.
+static const size_t USB_BULK_BUFFER_RETAIN_SIZE = 64 * 1024;
+
 static jfieldID field_context;
 
 struct usb_device* get_device_from_object(JNIEnv* env, jobject connection)
@@ -191,21 +195,34 @@ android_hardware_UsbDeviceConnection_bulk_request(JNIEnv *env, jobject thiz,
     }
 
     bool is_dir_in = (endpoint & USB_ENDPOINT_DIR_MASK) == USB_DIR_IN;
-    std::unique_ptr<jbyte[]> bufferBytes(new (std::nothrow) jbyte[length]);
-    if (!bufferBytes) {
-        jniThrowException(env, "java/lang/OutOfMemoryError", NULL);
-        return -1;
+    // Streaming apps issue back-to-back transfers of the same size from one thread, so reuse the
+    // bounce buffer instead of allocating a new one for every transfer.
+    thread_local std::vector<jbyte> retainedBytes;
+    std::unique_ptr<jbyte[]> largeBytes;
+    jbyte* bufferBytes;
+    if (length >= 0 && (size_t)length <= USB_BULK_BUFFER_RETAIN_SIZE) {
+        if (retainedBytes.size() < (size_t)length) {
+            retainedBytes.resize(length);
+        }
+        bufferBytes = retainedBytes.data();
+    } else {
+        largeBytes.reset(new (std::nothrow) jbyte[length]);
+        if (!largeBytes) {
+            jniThrowException(env, "java/lang/OutOfMemoryError", NULL);
+            return -1;
+        }
+        bufferBytes = largeBytes.get();
     }
 
     if (!is_dir_in && buffer) {
-        env->GetByteArrayRegion(buffer, start, length, bufferBytes.get());
+        env->GetByteArrayRegion(buffer, start, length, bufferBytes);
     }
 
     jint bytes_transferred =
-            usb_device_bulk_transfer(device, endpoint, bufferBytes.get(), length, timeout);
+            usb_device_bulk_transfer(device, endpoint, bufferBytes, length, timeout);
 
     if (bytes_transferred > 0 && is_dir_in) {
-        env->SetByteArrayRegion(buffer, start, bytes_transferred, bufferBytes.get());
+        env->SetByteArrayRegion(buffer, start, bytes_transferred, bufferBytes);
     }
 
     return bytes_transferred;
@@ -90,10 +90,11 @@ android_hardware_UsbRequest_queue_array(JNIEnv *env, jobject thiz,
         request->buffer = malloc(length);
         if (!request->buffer)
             return JNI_FALSE;
-        memset(request->buffer, 0, length);
         if (out) {
             // copy data from Java buffer to native buffer
             env->GetByteArrayRegion(buffer, 0, length, (jbyte *)request->buffer);
+        } else {
+            memset(request->buffer, 0, length);
         }
     } else {
         request->buffer = NULL;
@@ -339,7 +339,9 @@ public:
     status_t close();
 private:
     enum {
-        BYTE_ARRAY_LENGTH = 4096
+        // Pixel data for large sensors is hundreds of MB, and each chunk costs a JNI upcall into
+        // OutputStream.write(), so use a chunk that covers many full rows at a time.
+        BYTE_ARRAY_LENGTH = 256 * 1024
     };
     jobject mOutputStream;
     JNIEnv* mEnv;
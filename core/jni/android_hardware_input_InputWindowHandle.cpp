@@ -88,6 +88,50 @@ static Mutex gHandleMutex;
 
 // --- NativeInputWindowHandle ---
 
+// Returns true if obj is a different object from the one cachedWeak refers to, and if so makes
+// cachedWeak refer to obj.  A null obj always counts as changed, since a cleared weak reference
+// would compare equal to it.
+static bool updateCachedRef(JNIEnv* env, jobject obj, jweak* cachedWeak) {
+    if (obj != nullptr && *cachedWeak != nullptr && env->IsSameObject(*cachedWeak, obj)) {
+        return false;
+    }
+    if (*cachedWeak != nullptr) {
+        env->DeleteWeakGlobalRef(*cachedWeak);
+    }
+    *cachedWeak = obj != nullptr ? env->NewWeakGlobalRef(obj) : nullptr;
+    return true;
+}
+
+// Strings are immutable, so the conversion is skipped if the field still holds the same one.
+static void updateStringField(JNIEnv* env, jobject obj, jfieldID fieldId, jweak* cachedWeak,
+                              std::string* out) {
+    ScopedLocalRef<jstring> strObj(env, jstring(env->GetObjectField(obj, fieldId)));
+    if (!updateCachedRef(env, strObj.get(), cachedWeak)) {
+        return;
+    }
+    if (strObj != nullptr) {
+        ScopedUtfChars chars(env, strObj.get());
+        out->assign(chars.c_str());
+    } else {
+        out->assign("<null>");
+    }
+}
+
+// A Java binder object always maps to the same IBinder, so the lookup is skipped if the field
+// still holds the same one and the IBinder has not been cleared in the meantime.
+static void updateBinderField(JNIEnv* env, jobject obj, jfieldID fieldId, jweak* cachedWeak,
+                              sp<IBinder>* out) {
+    ScopedLocalRef<jobject> binderObj(env, env->GetObjectField(obj, fieldId));
+    if (!updateCachedRef(env, binderObj.get(), cachedWeak) && *out != nullptr) {
+        return;
+    }
+    if (binderObj != nullptr) {
+        *out = ibinderForJavaObject(env, binderObj.get());
+    } else {
+        out->clear();
+    }
+}
+
 NativeInputWindowHandle::NativeInputWindowHandle(jweak objWeak) :
         mObjWeak(objWeak) {
 }
@@ -95,6 +139,12 @@ NativeInputWindowHandle::NativeInputWindowHandle(jweak objWeak) :
 NativeInputWindowHandle::~NativeInputWindowHandle() {
     JNIEnv* env = AndroidRuntime::getJNIEnv();
     env->DeleteWeakGlobalRef(mObjWeak);
+    for (jweak cachedWeak : {mNameWeak, mPackageNameWeak, mTokenWeak, mWindowTokenWeak,
+                             mFocusTransferTargetWeak}) {
+        if (cachedWeak != nullptr) {
+            env->DeleteWeakGlobalRef(cachedWeak);
+        }
+    }
 
     // Clear the weak reference to the layer handle and flush any binder ref count operations so we
     // do not hold on to any binder references.
@@ -117,15 +167,9 @@ bool NativeInputWindowHandle::updateInfo() {
 
     mInfo.touchableRegion.clear();
 
-    jobject tokenObj = env->GetObjectField(obj, gInputWindowHandleClassInfo.token);
-    if (tokenObj) {
-        mInfo.token = ibinderForJavaObject(env, tokenObj);
-        env->DeleteLocalRef(tokenObj);
-    } else {
-        mInfo.token.clear();
-    }
+    updateBinderField(env, obj, gInputWindowHandleClassInfo.token, &mTokenWeak, &mInfo.token);
 
-    mInfo.name = getStringField(env, obj, gInputWindowHandleClassInfo.name, "<null>");
+    updateStringField(env, obj, gInputWindowHandleClassInfo.name, &mNameWeak, &mInfo.name);
 
     mInfo.dispatchingTimeout = std::chrono::milliseconds(
             env->GetLongField(obj, gInputWindowHandleClassInfo.dispatchingTimeoutMillis));
@@ -164,7 +208,8 @@ bool NativeInputWindowHandle::updateInfo() {
     mInfo.ownerPid = gui::Pid{env->GetIntField(obj, gInputWindowHandleClassInfo.ownerPid)};
     mInfo.ownerUid = gui::Uid{
             static_cast<uid_t>(env->GetIntField(obj, gInputWindowHandleClassInfo.ownerUid))};
-    mInfo.packageName = getStringField(env, obj, gInputWindowHandleClassInfo.packageName, "<null>");
+    updateStringField(env, obj, gInputWindowHandleClassInfo.packageName, &mPackageNameWeak,
+                      &mInfo.packageName);
     mInfo.displayId =
             ui::LogicalDisplayId{env->GetIntField(obj, gInputWindowHandleClassInfo.displayId)};
 
@@ -206,24 +251,11 @@ bool NativeInputWindowHandle::updateInfo() {
         mInfo.touchableRegionCropHandle.clear();
     }
 
-    jobject windowTokenObj = env->GetObjectField(obj, gInputWindowHandleClassInfo.windowToken);
-    if (windowTokenObj) {
-        mInfo.windowToken = ibinderForJavaObject(env, windowTokenObj);
-        env->DeleteLocalRef(windowTokenObj);
-    } else {
-        mInfo.windowToken.clear();
-    }
+    updateBinderField(env, obj, gInputWindowHandleClassInfo.windowToken, &mWindowTokenWeak,
+                      &mInfo.windowToken);
 
-    ScopedLocalRef<jobject>
-            focusTransferTargetObj(env,
-                                   env->GetObjectField(obj,
-                                                       gInputWindowHandleClassInfo
-                                                               .focusTransferTarget));
-    if (focusTransferTargetObj.get()) {
-        mInfo.focusTransferTarget = ibinderForJavaObject(env, focusTransferTargetObj.get());
-    } else {
-        mInfo.focusTransferTarget.clear();
-    }
+    updateBinderField(env, obj, gInputWindowHandleClassInfo.focusTransferTarget,
+                      &mFocusTransferTargetWeak, &mInfo.focusTransferTarget);
 
     env->DeleteLocalRef(obj);
     return true;
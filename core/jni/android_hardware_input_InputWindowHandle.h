@@ -35,6 +35,14 @@ public:
 
 private:
     jweak mObjWeak;
+
+    // The objects that the string and binder fields held at the last updateInfo().  A field that
+    // still holds the same object is not converted again.
+    jweak mNameWeak = nullptr;
+    jweak mPackageNameWeak = nullptr;
+    jweak mTokenWeak = nullptr;
+    jweak mWindowTokenWeak = nullptr;
+    jweak mFocusTransferTargetWeak = nullptr;
 };
 
 extern sp<NativeInputWindowHandle> android_view_InputWindowHandle_getHandle(
@@ -31,6 +31,8 @@
 #include <utils/Log.h>
 
 #include <cinttypes>
+#include <type_traits>
+#include <vector>
 
 #include "android_media_AudioAttributes.h"
 #include "android_media_AudioErrors.h"
@@ -634,6 +636,26 @@ void envReleaseArrayElements(JNIEnv *env, jfloatArray array, jfloat *elems, jint
     env->ReleaseFloatArrayElements(array, elems, mode);
 }
 
+static inline
+void envGetArrayRegion(JNIEnv *env, jbyteArray array, jsize start, jsize len, jbyte *buf) {
+    env->GetByteArrayRegion(array, start, len, buf);
+}
+
+static inline
+void envGetArrayRegion(JNIEnv *env, jshortArray array, jsize start, jsize len, jshort *buf) {
+    env->GetShortArrayRegion(array, start, len, buf);
+}
+
+static inline
+void envGetArrayRegion(JNIEnv *env, jfloatArray array, jsize start, jsize len, jfloat *buf) {
+    env->GetFloatArrayRegion(array, start, len, buf);
+}
+
+// Writes up to this size are copied out of the Java array through a reused buffer. Small arrays
+// are movable, so getting their elements would copy the whole array into a fresh allocation
+// instead; low-latency streaming does that once per period.
+static constexpr size_t kMaxRegionCopyBytes = 16 * 1024;
+
 static inline
 jint interpretWriteSizeError(ssize_t writeSize) {
     if (writeSize == WOULD_BLOCK) {
@@ -700,6 +722,20 @@ static jint android_media_AudioTrack_writeArray(JNIEnv *env, jobject thiz,
     // AudioSystem callback to be called while in critical section (in case of media server
     // process crash for instance)
 
+    using Sample = std::remove_pointer_t<decltype(envGetArrayElements(env, javaAudioData, NULL))>;
+    if (sizeInSamples >= 0 && (size_t)sizeInSamples * sizeof(Sample) <= kMaxRegionCopyBytes) {
+        thread_local std::vector<Sample> region;
+        region.resize(sizeInSamples);
+        envGetArrayRegion(env, javaAudioData, offsetInSamples, sizeInSamples, region.data());
+        if (env->ExceptionCheck()) {
+            env->ExceptionClear();
+            ALOGE("Error retrieving source of audio data to play");
+            return (jint)AUDIO_JAVA_BAD_VALUE;
+        }
+        return writeToTrack(lpTrack, javaAudioFormat, region.data(), 0 /* offsetInSamples */,
+                sizeInSamples, isWriteBlocking == JNI_TRUE /* blocking */);
+    }
+
     // get the pointer for the audio data from the java array
     auto cAudioData = envGetArrayElements(env, javaAudioData, NULL);
     if (cAudioData == NULL) {
@@ -710,7 +746,8 @@ static jint android_media_AudioTrack_writeArray(JNIEnv *env, jobject thiz,
     jint samplesWritten = writeToTrack(lpTrack, javaAudioFormat, cAudioData,
             offsetInSamples, sizeInSamples, isWriteBlocking == JNI_TRUE /* blocking */);
 
-    envReleaseArrayElements(env, javaAudioData, cAudioData, 0);
+    // The data is only read, so there is nothing to copy back.
+    envReleaseArrayElements(env, javaAudioData, cAudioData, JNI_ABORT);
 
     //ALOGV("write wrote %d (tried %d) samples in the native AudioTrack with offset %d",
     //        (int)samplesWritten, (int)(sizeInSamples), (int)offsetInSamples);
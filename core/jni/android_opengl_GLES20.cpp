@@ -69,6 +69,10 @@ nativeClassInit(JNIEnv *_env, jclass glImplClass)
 {
 }
 
+// Uniform uploads are typically a few values taken from a larger array. For small uploads copy
+// just the needed range onto the stack rather than pinning (and possibly copying) the whole array.
+#define UNIFORM_COPY_MAX_VALUES 64
+
 static void *
 getPointer(JNIEnv *_env, jobject buffer, jarray *array, jint *remaining, jint *offset)
 {
@@ -4846,6 +4850,7 @@ android_glUniform1fv__II_3FI
     GLfloat *v_base = (GLfloat *) 0;
     jint _remaining;
     GLfloat *v = (GLfloat *) 0;
+    GLfloat v_copy[UNIFORM_COPY_MAX_VALUES];
 
     if (!v_ref) {
         _exception = 1;
@@ -4866,9 +4871,14 @@ android_glUniform1fv__II_3FI
         _exceptionMessage = "length - offset < count < needed";
         goto exit;
     }
-    v_base = (GLfloat *)
-        _env->GetFloatArrayElements(v_ref, (jboolean *)0);
-    v = v_base + offset;
+    if (count >= 0 && count <= UNIFORM_COPY_MAX_VALUES) {
+        _env->GetFloatArrayRegion(v_ref, offset, count, (jfloat *)v_copy);
+        v = v_copy;
+    } else {
+        v_base = (GLfloat *)
+            _env->GetFloatArrayElements(v_ref, (jboolean *)0);
+        v = v_base + offset;
+    }
 
     glUniform1fv(
         (GLint)location,
@@ -4950,6 +4960,7 @@ android_glUniform1iv__II_3II
     GLint *v_base = (GLint *) 0;
     jint _remaining;
     GLint *v = (GLint *) 0;
+    GLint v_copy[UNIFORM_COPY_MAX_VALUES];
 
     if (!v_ref) {
         _exception = 1;
@@ -4970,9 +4981,14 @@ android_glUniform1iv__II_3II
         _exceptionMessage = "length - offset < count < needed";
         goto exit;
     }
-    v_base = (GLint *)
-        _env->GetIntArrayElements(v_ref, (jboolean *)0);
-    v = v_base + offset;
+    if (count >= 0 && count <= UNIFORM_COPY_MAX_VALUES) {
+        _env->GetIntArrayRegion(v_ref, offset, count, (jint *)v_copy);
+        v = v_copy;
+    } else {
+        v_base = (GLint *)
+            _env->GetIntArrayElements(v_ref, (jboolean *)0);
+        v = v_base + offset;
+    }
 
     glUniform1iv(
         (GLint)location,
@@ -5055,6 +5071,7 @@ android_glUniform2fv__II_3FI
     GLfloat *v_base = (GLfloat *) 0;
     jint _remaining;
     GLfloat *v = (GLfloat *) 0;
+    GLfloat v_copy[UNIFORM_COPY_MAX_VALUES];
 
     if (!v_ref) {
         _exception = 1;
@@ -5075,9 +5092,14 @@ android_glUniform2fv__II_3FI
         _exceptionMessage = "length - offset < count*2 < needed";
         goto exit;
     }
-    v_base = (GLfloat *)
-        _env->GetFloatArrayElements(v_ref, (jboolean *)0);
-    v = v_base + offset;
+    if (count >= 0 && count <= UNIFORM_COPY_MAX_VALUES / 2) {
+        _env->GetFloatArrayRegion(v_ref, offset, count*2, (jfloat *)v_copy);
+        v = v_copy;
+    } else {
+        v_base = (GLfloat *)
+            _env->GetFloatArrayElements(v_ref, (jboolean *)0);
+        v = v_base + offset;
+    }
 
     glUniform2fv(
         (GLint)location,
@@ -5160,6 +5182,7 @@ android_glUniform2iv__II_3II
     GLint *v_base = (GLint *) 0;
     jint _remaining;
     GLint *v = (GLint *) 0;
+    GLint v_copy[UNIFORM_COPY_MAX_VALUES];
 
     if (!v_ref) {
         _exception = 1;
@@ -5180,9 +5203,14 @@ android_glUniform2iv__II_3II
         _exceptionMessage = "length - offset < count*2 < needed";
         goto exit;
     }
-    v_base = (GLint *)
-        _env->GetIntArrayElements(v_ref, (jboolean *)0);
-    v = v_base + offset;
+    if (count >= 0 && count <= UNIFORM_COPY_MAX_VALUES / 2) {
+        _env->GetIntArrayRegion(v_ref, offset, count*2, (jint *)v_copy);
+        v = v_copy;
+    } else {
+        v_base = (GLint *)
+            _env->GetIntArrayElements(v_ref, (jboolean *)0);
+        v = v_base + offset;
+    }
 
     glUniform2iv(
         (GLint)location,
@@ -5266,6 +5294,7 @@ android_glUniform3fv__II_3FI
     GLfloat *v_base = (GLfloat *) 0;
     jint _remaining;
     GLfloat *v = (GLfloat *) 0;
+    GLfloat v_copy[UNIFORM_COPY_MAX_VALUES];
 
     if (!v_ref) {
         _exception = 1;
@@ -5286,9 +5315,14 @@ android_glUniform3fv__II_3FI
         _exceptionMessage = "length - offset < count*3 < needed";
         goto exit;
     }
-    v_base = (GLfloat *)
-        _env->GetFloatArrayElements(v_ref, (jboolean *)0);
-    v = v_base + offset;
+    if (count >= 0 && count <= UNIFORM_COPY_MAX_VALUES / 3) {
+        _env->GetFloatArrayRegion(v_ref, offset, count*3, (jfloat *)v_copy);
+        v = v_copy;
+    } else {
+        v_base = (GLfloat *)
+            _env->GetFloatArrayElements(v_ref, (jboolean *)0);
+        v = v_base + offset;
+    }
 
     glUniform3fv(
         (GLint)location,
@@ -5372,6 +5406,7 @@ android_glUniform3iv__II_3II
     GLint *v_base = (GLint *) 0;
     jint _remaining;
     GLint *v = (GLint *) 0;
+    GLint v_copy[UNIFORM_COPY_MAX_VALUES];
 
     if (!v_ref) {
         _exception = 1;
@@ -5392,9 +5427,14 @@ android_glUniform3iv__II_3II
         _exceptionMessage = "length - offset < count*3 < needed";
         goto exit;
     }
-    v_base = (GLint *)
-        _env->GetIntArrayElements(v_ref, (jboolean *)0);
-    v = v_base + offset;
+    if (count >= 0 && count <= UNIFORM_COPY_MAX_VALUES / 3) {
+        _env->GetIntArrayRegion(v_ref, offset, count*3, (jint *)v_copy);
+        v = v_copy;
+    } else {
+        v_base = (GLint *)
+            _env->GetIntArrayElements(v_ref, (jboolean *)0);
+        v = v_base + offset;
+    }
 
     glUniform3iv(
         (GLint)location,
@@ -5479,6 +5519,7 @@ android_glUniform4fv__II_3FI
     GLfloat *v_base = (GLfloat *) 0;
     jint _remaining;
     GLfloat *v = (GLfloat *) 0;
+    GLfloat v_copy[UNIFORM_COPY_MAX_VALUES];
 
     if (!v_ref) {
         _exception = 1;
@@ -5499,9 +5540,14 @@ android_glUniform4fv__II_3FI
         _exceptionMessage = "length - offset < count*4 < needed";
         goto exit;
     }
-    v_base = (GLfloat *)
-        _env->GetFloatArrayElements(v_ref, (jboolean *)0);
-    v = v_base + offset;
+    if (count >= 0 && count <= UNIFORM_COPY_MAX_VALUES / 4) {
+        _env->GetFloatArrayRegion(v_ref, offset, count*4, (jfloat *)v_copy);
+        v = v_copy;
+    } else {
+        v_base = (GLfloat *)
+            _env->GetFloatArrayElements(v_ref, (jboolean *)0);
+        v = v_base + offset;
+    }
 
     glUniform4fv(
         (GLint)location,
@@ -5586,6 +5632,7 @@ android_glUniform4iv__II_3II
     GLint *v_base = (GLint *) 0;
     jint _remaining;
     GLint *v = (GLint *) 0;
+    GLint v_copy[UNIFORM_COPY_MAX_VALUES];
 
     if (!v_ref) {
         _exception = 1;
@@ -5606,9 +5653,14 @@ android_glUniform4iv__II_3II
         _exceptionMessage = "length - offset < count*4 < needed";
         goto exit;
     }
-    v_base = (GLint *)
-        _env->GetIntArrayElements(v_ref, (jboolean *)0);
-    v = v_base + offset;
+    if (count >= 0 && count <= UNIFORM_COPY_MAX_VALUES / 4) {
+        _env->GetIntArrayRegion(v_ref, offset, count*4, (jint *)v_copy);
+        v = v_copy;
+    } else {
+        v_base = (GLint *)
+            _env->GetIntArrayElements(v_ref, (jboolean *)0);
+        v = v_base + offset;
+    }
 
     glUniform4iv(
         (GLint)location,
@@ -5680,6 +5732,7 @@ android_glUniformMatrix2fv__IIZ_3FI
     GLfloat *value_base = (GLfloat *) 0;
     jint _remaining;
     GLfloat *value = (GLfloat *) 0;
+    GLfloat value_copy[UNIFORM_COPY_MAX_VALUES];
 
     if (!value_ref) {
         _exception = 1;
@@ -5700,9 +5753,14 @@ android_glUniformMatrix2fv__IIZ_3FI
         _exceptionMessage = "length - offset < count*4 < needed";
         goto exit;
     }
-    value_base = (GLfloat *)
-        _env->GetFloatArrayElements(value_ref, (jboolean *)0);
-    value = value_base + offset;
+    if (count >= 0 && count <= UNIFORM_COPY_MAX_VALUES / 4) {
+        _env->GetFloatArrayRegion(value_ref, offset, count*4, (jfloat *)value_copy);
+        value = value_copy;
+    } else {
+        value_base = (GLfloat *)
+            _env->GetFloatArrayElements(value_ref, (jboolean *)0);
+        value = value_base + offset;
+    }
 
     glUniformMatrix2fv(
         (GLint)location,
@@ -5776,6 +5834,7 @@ android_glUniformMatrix3fv__IIZ_3FI
     GLfloat *value_base = (GLfloat *) 0;
     jint _remaining;
     GLfloat *value = (GLfloat *) 0;
+    GLfloat value_copy[UNIFORM_COPY_MAX_VALUES];
 
     if (!value_ref) {
         _exception = 1;
@@ -5796,9 +5855,14 @@ android_glUniformMatrix3fv__IIZ_3FI
         _exceptionMessage = "length - offset < count*9 < needed";
         goto exit;
     }
-    value_base = (GLfloat *)
-        _env->GetFloatArrayElements(value_ref, (jboolean *)0);
-    value = value_base + offset;
+    if (count >= 0 && count <= UNIFORM_COPY_MAX_VALUES / 9) {
+        _env->GetFloatArrayRegion(value_ref, offset, count*9, (jfloat *)value_copy);
+        value = value_copy;
+    } else {
+        value_base = (GLfloat *)
+            _env->GetFloatArrayElements(value_ref, (jboolean *)0);
+        value = value_base + offset;
+    }
 
     glUniformMatrix3fv(
         (GLint)location,
@@ -5872,6 +5936,7 @@ android_glUniformMatrix4fv__IIZ_3FI
     GLfloat *value_base = (GLfloat *) 0;
     jint _remaining;
     GLfloat *value = (GLfloat *) 0;
+    GLfloat value_copy[UNIFORM_COPY_MAX_VALUES];
 
     if (!value_ref) {
         _exception = 1;
@@ -5892,9 +5957,14 @@ android_glUniformMatrix4fv__IIZ_3FI
         _exceptionMessage = "length - offset < count*16 < needed";
         goto exit;
     }
-    value_base = (GLfloat *)
-        _env->GetFloatArrayElements(value_ref, (jboolean *)0);
-    value = value_base + offset;
+    if (count >= 0 && count <= UNIFORM_COPY_MAX_VALUES / 16) {
+        _env->GetFloatArrayRegion(value_ref, offset, count*16, (jfloat *)value_copy);
+        value = value_copy;
+    } else {
+        value_base = (GLfloat *)
+            _env->GetFloatArrayElements(value_ref, (jboolean *)0);
+        value = value_base + offset;
+    }
 
     glUniformMatrix4fv(
         (GLint)location,
@@ -52,7 +52,9 @@
 #include <vintf/KernelConfigs.h>
 
 #include <iomanip>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "jni.h"
@@ -182,6 +184,105 @@ static int read_memtrack_memory(int pid, struct graphics_memory_pss* graphics_me
     return err;
 }
 
+/*
+ * Walking smaps_rollup makes the kernel visit every VMA of the process, which adds up when
+ * ActivityManager samples every process in turn. A process that has taken no page faults since
+ * its last sample has not mapped in anything new, so when enabled by
+ * debug.pss.skip_unchanged the previous reading is returned instead. Only the process' own
+ * usage is cached; memtrack is still queried on every call.
+ */
+struct PssSample {
+    uint64_t startTime;
+    uint64_t faults;
+    MemUsage usage;
+};
+
+static constexpr size_t kMaxPssSamples = 1024;
+
+static bool gSkipUnchangedPss = false;
+static std::mutex gPssSamplesLock;
+static std::unordered_map<pid_t, PssSample> gPssSamples;
+
+/*
+ * Reads the start time and the minor plus major fault count of a process from
+ * /proc/pid/stat, without allocating.
+ */
+static bool read_fault_count(pid_t pid, uint64_t* startTime, uint64_t* faults)
+{
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    int fd = TEMP_FAILURE_RETRY(open(path, O_RDONLY | O_CLOEXEC));
+    if (fd < 0) {
+        return false;
+    }
+    char buf[1024];
+    ssize_t len = TEMP_FAILURE_RETRY(read(fd, buf, sizeof(buf) - 1));
+    close(fd);
+    if (len <= 0) {
+        return false;
+    }
+    buf[len] = '\0';
+
+    // The command name may contain spaces and parentheses, so fields are counted from the
+    // last ')'. It is followed by field 3, the state.
+    char* p = strrchr(buf, ')');
+    if (p == nullptr) {
+        return false;
+    }
+    uint64_t minFaults = 0;
+    uint64_t majFaults = 0;
+    int field = 2;
+    while (*p != '\0') {
+        if (*p != ' ') {
+            p++;
+            continue;
+        }
+        field++;
+        p++;
+        char* end;
+        switch (field) {
+            case 10: minFaults = strtoull(p, &end, 10); p = end; break;
+            case 12: majFaults = strtoull(p, &end, 10); p = end; break;
+            case 22:
+                *startTime = strtoull(p, &end, 10);
+                *faults = minFaults + majFaults;
+                return true;
+        }
+    }
+    return false;
+}
+
+static bool read_pss_usage(pid_t pid, MemUsage* usage)
+{
+    uint64_t startTime = 0;
+    uint64_t faults = 0;
+    bool sampled = gSkipUnchangedPss && read_fault_count(pid, &startTime, &faults);
+    if (sampled) {
+        std::lock_guard<std::mutex> lock(gPssSamplesLock);
+        auto it = gPssSamples.find(pid);
+        if (it != gPssSamples.end() && it->second.startTime == startTime &&
+                it->second.faults == faults) {
+            *usage = it->second.usage;
+            return true;
+        }
+    }
+
+    ProcMemInfo proc_mem(pid);
+    if (!proc_mem.SmapsOrRollup(usage)) {
+        return false;
+    }
+
+    if (sampled) {
+        std::lock_guard<std::mutex> lock(gPssSamplesLock);
+        if (gPssSamples.size() >= kMaxPssSamples && gPssSamples.count(pid) == 0) {
+            // Most of these are processes that have since died.
+            gPssSamples.clear();
+        }
+        gPssSamples[pid] = {startTime, faults, *usage};
+    }
+    return true;
+}
+
 static jboolean android_os_Debug_getDirtyPagesPid(JNIEnv *env, jobject clazz,
         jint pid, jobject object)
 {
@@ -275,9 +376,8 @@ static jlong android_os_Debug_getPssPid(JNIEnv *env, jobject clazz, jint pid,
         pss = uss = rss = memtrack = graphics_mem.graphics + graphics_mem.gl + graphics_mem.other;
     }
 
-    ::android::meminfo::ProcMemInfo proc_mem(pid);
     ::android::meminfo::MemUsage stats;
-    if (proc_mem.SmapsOrRollup(&stats)) {
+    if (read_pss_usage(pid, &stats)) {
         pss += stats.pss;
         uss += stats.uss;
         rss += stats.rss;
@@ -879,6 +979,8 @@ int register_android_os_Debug(JNIEnv *env)
                 env->GetFieldID(clazz, stat_field_names[i].swappedOutPss_name, "I");
     }
 
+    gSkipUnchangedPss = android::base::GetBoolProperty("debug.pss.skip_unchanged", false);
+
     return jniRegisterNativeMethods(env, "android/os/Debug", gMethods, NELEM(gMethods));
 }
 
@@ -27,7 +27,6 @@
 #include <android_runtime/AndroidRuntime.h>
 #include <hidl/Status.h>
 #include <nativehelper/ScopedLocalRef.h>
-#include <nativehelper/ScopedPrimitiveArray.h>
 
 #include "core_jni_helpers.h"
 
@@ -420,18 +419,14 @@ static void JHwBlob_native_copyToBoolArray(
         return;
     }
 
-    const bool *src =
-        reinterpret_cast<const bool *>(
-                static_cast<const uint8_t *>(blob->data()) + offset);
-
-    jboolean *dst = env->GetBooleanArrayElements(array, nullptr /* isCopy */);
-
-    for (jint i = 0; i < size; ++i) {
-        dst[i] = src[i];
-    }
-
-    env->ReleaseBooleanArrayElements(array, dst, 0 /* mode */);
-    dst = nullptr;
+    // bool and jboolean are both one byte holding 0 or 1, so the blob can be copied as is.
+    static_assert(sizeof(bool) == sizeof(jboolean));
+    env->SetBooleanArrayRegion(
+            array,
+            0 /* start */,
+            size,
+            reinterpret_cast<const jboolean *>(
+                static_cast<const uint8_t *>(blob->data()) + offset));
 }
 
 #define DEFINE_BLOB_PUTTER(Suffix,Type)                                        \
@@ -524,21 +519,27 @@ static void JHwBlob_native_putNativeHandle(JNIEnv *env, jobject thiz,
 #define DEFINE_BLOB_ARRAY_PUTTER(Suffix,Type,NewType)                          \
 static void JHwBlob_native_put ## Suffix ## Array(                             \
         JNIEnv *env, jobject thiz, jlong offset, Type ## Array array) {        \
-    Scoped ## NewType ## ArrayRO autoArray(env, array);                        \
-                                                                               \
     if (array == nullptr) {                                                    \
-        /* NullpointerException already pending */                             \
+        jniThrowException(env, "java/lang/NullPointerException", nullptr);     \
         return;                                                                \
     }                                                                          \
                                                                                \
     sp<JHwBlob> blob = JHwBlob::GetNativeContext(env, thiz);                   \
                                                                                \
-    status_t err = blob->write(                                                \
-            offset, autoArray.get(), autoArray.size() * sizeof(Type));         \
-                                                                               \
-    if (err != OK) {                                                           \
-        signalExceptionForError(env, err);                                     \
+    const jsize length = env->GetArrayLength(array);                           \
+    if ((offset + length * sizeof(Type)) > blob->size()) {                     \
+        signalExceptionForError(env, -ERANGE);                                 \
+        return;                                                                \
     }                                                                          \
+                                                                               \
+    /* Copy straight into the blob instead of through a pinned or copied */    \
+    /* view of the array. */                                                   \
+    env->Get ## NewType ## ArrayRegion(                                        \
+            array,                                                             \
+            0 /* start */,                                                     \
+            length,                                                            \
+            reinterpret_cast<Type *>(                                          \
+                static_cast<uint8_t *>(blob->data()) + offset));               \
 }
 
 DEFINE_BLOB_ARRAY_PUTTER(Int8,jbyte,Byte)
@@ -550,27 +551,27 @@ DEFINE_BLOB_ARRAY_PUTTER(Double,jdouble,Double)
 
 static void JHwBlob_native_putBoolArray(
         JNIEnv *env, jobject thiz, jlong offset, jbooleanArray array) {
-    ScopedBooleanArrayRO autoArray(env, array);
-
     if (array == nullptr) {
-        /* NullpointerException already pending */
+        jniThrowException(env, "java/lang/NullPointerException", nullptr);
         return;
     }
 
     sp<JHwBlob> blob = JHwBlob::GetNativeContext(env, thiz);
 
-    if ((offset + autoArray.size() * sizeof(bool)) > blob->size()) {
+    const jsize length = env->GetArrayLength(array);
+    if ((offset + length * sizeof(bool)) > blob->size()) {
         signalExceptionForError(env, -ERANGE);
         return;
     }
 
-    const jboolean *src = autoArray.get();
-
-    bool *dst = reinterpret_cast<bool *>(
+    jboolean *dst = reinterpret_cast<jboolean *>(
             static_cast<uint8_t *>(blob->data()) + offset);
 
-    for (size_t i = 0; i < autoArray.size(); ++i) {
-        dst[i] = src[i];
+    env->GetBooleanArrayRegion(array, 0 /* start */, length, dst);
+
+    // Make sure every element is a valid bool, whatever the array held.
+    for (jsize i = 0; i < length; ++i) {
+        dst[i] = dst[i] != JNI_FALSE;
     }
 }
 
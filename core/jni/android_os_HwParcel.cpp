@@ -513,17 +513,18 @@ static void JHwParcel_native_writeBoolVector(
 
     jsize len = env->GetArrayLength(valObj);
 
-    jboolean *src = env->GetBooleanArrayElements(valObj, nullptr);
+    jboolean *src =
+        (jboolean *)impl->getStorage()->allocTemporaryStorage(len * sizeof(jboolean));
 
-    bool *dst =
-        (bool *)impl->getStorage()->allocTemporaryStorage(len * sizeof(bool));
+    env->GetBooleanArrayRegion(valObj, 0 /* start */, len, src);
 
+    // Make sure every element is a valid bool, whatever the array held.
     for (jsize i = 0; i < len; ++i) {
-        dst[i] = src[i];
+        src[i] = src[i] != JNI_FALSE;
     }
 
-    env->ReleaseBooleanArrayElements(valObj, src, 0 /* mode */);
-    src = nullptr;
+    static_assert(sizeof(bool) == sizeof(jboolean));
+    bool *dst = reinterpret_cast<bool *>(src);
 
     vec->setToExternal(dst, len);
 
@@ -825,9 +826,11 @@ static jbooleanArray JHwParcel_native_readBoolVector(JNIEnv *env, jobject thiz)
 
     jbooleanArray valObj = env->NewBooleanArray(vec->size());
 
-    for (size_t i = 0; i < vec->size(); ++i) {
-        jboolean x = (*vec)[i];
-        env->SetBooleanArrayRegion(valObj, i, 1, &x);
+    if (valObj != nullptr) {
+        // bool and jboolean are both one byte holding 0 or 1.
+        static_assert(sizeof(bool) == sizeof(jboolean));
+        env->SetBooleanArrayRegion(valObj, 0 /* start */, vec->size(),
+                                   reinterpret_cast<const jboolean *>(vec->data()));
     }
 
     return valObj;
@@ -23,6 +23,8 @@
 #include <utils/Log.h>
 #include "android_os_MessageQueue.h"
 
+#include <atomic>
+
 #include "core_jni_helpers.h"
 
 namespace android {
@@ -70,6 +72,11 @@ private:
     JNIEnv* mPollEnv;
     jobject mPollObj;
     jthrowable mExceptionObj;
+
+    // Set once wake() has written to the looper's eventfd, and cleared when pollOnce() returns.
+    // Every thread that posts to a blocked queue calls wake(), so this saves all but the first
+    // of them a write.
+    std::atomic<bool> mWakePending;
 };
 
 
@@ -91,7 +98,7 @@ bool MessageQueue::raiseAndClearException(JNIEnv* env, const char* msg) {
 }
 
 NativeMessageQueue::NativeMessageQueue() :
-        mPollEnv(NULL), mPollObj(NULL), mExceptionObj(NULL) {
+        mPollEnv(NULL), mPollObj(NULL), mExceptionObj(NULL), mWakePending(false) {
     mLooper = Looper::getForThread();
     if (mLooper == NULL) {
         mLooper = new Looper(false);
@@ -122,7 +129,15 @@ void NativeMessageQueue::raiseException(JNIEnv* env, const char* msg, jthrowable
 void NativeMessageQueue::pollOnce(JNIEnv* env, jobject pollObj, int timeoutMillis) {
     mPollEnv = env;
     mPollObj = pollObj;
+    if (mWakePending.load()) {
+        // Something else may have polled the looper, e.g. native code running a message, and
+        // consumed the wake that the skipped ones relied on, so wake it again to be safe.
+        mLooper->wake();
+    }
     mLooper->pollOnce(timeoutMillis);
+    // The caller checks its queue after this returns, and sees whatever was posted before any
+    // wake() that was skipped up to here.
+    mWakePending.store(false);
     mPollObj = NULL;
     mPollEnv = NULL;
 
@@ -134,7 +149,9 @@ void NativeMessageQueue::pollOnce(JNIEnv* env, jobject pollObj, int timeoutMilli
 }
 
 void NativeMessageQueue::wake() {
-    mLooper->wake();
+    if (!mWakePending.exchange(true)) {
+        mLooper->wake();
+    }
 }
 
 void NativeMessageQueue::setFileDescriptorEvents(int fd, int events) {
@@ -195,6 +195,19 @@ static void android_os_Parcel_restoreAllowFds(CRITICAL_JNI_PARAMS_COMMA
     }
 }
 
+// Writes |length| followed by room for |size| bytes, which the caller fills in. Byte arrays and
+// strings are written this way, with the parcel grown once for both instead of once for each.
+// The result is laid out exactly as writeInt32() followed by writeInplace(size) would be.
+static void* writeLengthAndInplace(Parcel* parcel, int32_t length, size_t size)
+{
+    uint8_t* dest = reinterpret_cast<uint8_t*>(parcel->writeInplace(sizeof(int32_t) + size));
+    if (dest == NULL) {
+        return NULL;
+    }
+    *reinterpret_cast<int32_t*>(dest) = length;
+    return dest + sizeof(int32_t);
+}
+
 static void android_os_Parcel_writeByteArray(JNIEnv* env, jclass clazz, jlong nativePtr,
                                              jobject data, jint offset, jint length)
 {
@@ -203,23 +216,13 @@ static void android_os_Parcel_writeByteArray(JNIEnv* env, jclass clazz, jlong na
         return;
     }
 
-    const status_t err = parcel->writeInt32(length);
-    if (err != NO_ERROR) {
-        signalExceptionForError(env, clazz, err);
-        return;
-    }
-
-    void* dest = parcel->writeInplace(length);
+    void* dest = writeLengthAndInplace(parcel, length, length);
     if (dest == NULL) {
         signalExceptionForError(env, clazz, NO_MEMORY);
         return;
     }
 
-    jbyte* ar = (jbyte*)env->GetPrimitiveArrayCritical((jarray)data, 0);
-    if (ar) {
-        memcpy(dest, ar + offset, length);
-        env->ReleasePrimitiveArrayCritical((jarray)data, ar, 0);
-    }
+    env->GetByteArrayRegion((jbyteArray)data, offset, length, (jbyte*)dest);
 }
 
 static void android_os_Parcel_writeBlob(JNIEnv* env, jclass clazz, jlong nativePtr, jobject data,
@@ -294,8 +297,8 @@ static void android_os_Parcel_writeString8(JNIEnv *env, jclass clazz, jlong nati
             // NOTE: Keep this logic in sync with Parcel.cpp
             const size_t len = env->GetStringLength(val);
             const size_t allocLen = env->GetStringUTFLength(val);
-            err = parcel->writeInt32(allocLen);
-            char *data = reinterpret_cast<char*>(parcel->writeInplace(allocLen + sizeof(char)));
+            char *data = reinterpret_cast<char*>(
+                    writeLengthAndInplace(parcel, allocLen, allocLen + sizeof(char)));
             if (data != nullptr) {
                 env->GetStringUTFRegion(val, 0, len, data);
                 *(data + allocLen) = 0;
@@ -320,8 +323,8 @@ static void android_os_Parcel_writeString16(JNIEnv *env, jclass clazz, jlong nat
             // NOTE: Keep this logic in sync with Parcel.cpp
             const size_t len = env->GetStringLength(val);
             const size_t allocLen = len * sizeof(char16_t);
-            err = parcel->writeInt32(len);
-            char *data = reinterpret_cast<char*>(parcel->writeInplace(allocLen + sizeof(char16_t)));
+            char *data = reinterpret_cast<char*>(
+                    writeLengthAndInplace(parcel, len, allocLen + sizeof(char16_t)));
             if (data != nullptr) {
                 env->GetStringRegion(val, 0, len, reinterpret_cast<jchar*>(data));
                 *reinterpret_cast<char16_t*>(data + allocLen) = 0;
@@ -370,19 +373,11 @@ static jbyteArray android_os_Parcel_createByteArray(JNIEnv* env, jclass clazz, j
 
         // Validate the stored length against the true data size
         if (len >= 0 && len <= (int32_t)parcel->dataAvail()) {
-            ret = env->NewByteArray(len);
-
-            if (ret != NULL) {
-                jbyte* a2 = (jbyte*)env->GetPrimitiveArrayCritical(ret, 0);
-                if (a2) {
-                    const void* data = parcel->readInplace(len);
-                    if (data) {
-                        memcpy(a2, data, len);
-                    }
-                    env->ReleasePrimitiveArrayCritical(ret, a2, 0);
-                    if (!data) {
-                        ret = NULL;
-                    }
+            const void* data = parcel->readInplace(len);
+            if (data) {
+                ret = env->NewByteArray(len);
+                if (ret != NULL) {
+                    env->SetByteArrayRegion(ret, 0, len, (const jbyte*)data);
                 }
             }
         }
@@ -402,17 +397,10 @@ static jboolean android_os_Parcel_readByteArray(JNIEnv* env, jclass clazz, jlong
 
     int32_t len = parcel->readInt32();
     if (len >= 0 && len <= (int32_t)parcel->dataAvail() && len == destLen) {
-        jbyte* ar = (jbyte*)env->GetPrimitiveArrayCritical((jarray)dest, 0);
-        if (ar) {
-            const void* data = parcel->readInplace(len);
-            if (data) {
-                memcpy(ar, data, len);
-                ret = JNI_TRUE;
-            } else {
-                ret = JNI_FALSE;
-            }
-
-            env->ReleasePrimitiveArrayCritical((jarray)dest, ar, 0);
+        const void* data = parcel->readInplace(len);
+        if (data) {
+            env->SetByteArrayRegion((jbyteArray)dest, 0, len, (const jbyte*)data);
+            ret = JNI_TRUE;
         }
     }
     return ret;
@@ -59,9 +59,28 @@ void ReadProperty(const prop_info* prop, Functor&& functor)
 #endif
 }
 
+// Almost all property names fit here, letting by-name reads copy the key onto the stack instead
+// of allocating a copy for every lookup.
+constexpr size_t kKeyStackBufferSize = 128;
+
 template<typename Functor>
 void ReadProperty(JNIEnv* env, jstring keyJ, Functor&& functor)
 {
+#if defined(__BIONIC__)
+    if (keyJ != nullptr) {
+        const jsize keyUtfLength = env->GetStringUTFLength(keyJ);
+        if (static_cast<size_t>(keyUtfLength) < kKeyStackBufferSize) {
+            char key[kKeyStackBufferSize];
+            env->GetStringUTFRegion(keyJ, 0, env->GetStringLength(keyJ), key);
+            key[keyUtfLength] = '\0';
+            const prop_info* prop = __system_property_find(key);
+            if (prop) {
+                ReadProperty(prop, std::forward<Functor>(functor));
+            }
+            return;
+        }
+    }
+#endif
     ScopedUtfChars key(env, keyJ);
     if (!key.c_str()) {
         return;
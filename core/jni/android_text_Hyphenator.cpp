@@ -27,8 +27,14 @@
 
 namespace android {
 
+static constexpr char SYSTEM_HYPHENATOR_DIR[] = "/system/usr/hyphen-data";
+
+// The pattern directory, opened once for the duration of init() so that each of the many pattern
+// files is opened relative to it instead of resolving the full path every time.
+static int gPatternDirFd = AT_FDCWD;
+
 static std::string buildFileName(const std::string& locale) {
-    constexpr char SYSTEM_HYPHENATOR_PREFIX[] = "/system/usr/hyphen-data/hyph-";
+    constexpr char SYSTEM_HYPHENATOR_PREFIX[] = "hyph-";
     constexpr char SYSTEM_HYPHENATOR_SUFFIX[] = ".hyb";
     std::string lowerLocale;
     lowerLocale.reserve(locale.size());
@@ -37,8 +43,11 @@ static std::string buildFileName(const std::string& locale) {
 }
 
 static std::pair<const uint8_t*, size_t> mmapPatternFile(const std::string& locale) {
-    const std::string hyFilePath = buildFileName(locale);
-    const int fd = open(hyFilePath.c_str(), O_RDONLY | O_CLOEXEC);
+    std::string hyFilePath = buildFileName(locale);
+    if (gPatternDirFd == AT_FDCWD) {
+        hyFilePath = std::string(SYSTEM_HYPHENATOR_DIR) + '/' + hyFilePath;
+    }
+    const int fd = openat(gPatternDirFd, hyFilePath.c_str(), O_RDONLY | O_CLOEXEC);
     if (fd == -1) {
         return std::make_pair(nullptr, 0); // Open failed.
     }
@@ -85,6 +94,11 @@ static void init() {
     constexpr int INDIC_MIN_PREFIX = 2;
     constexpr int INDIC_MIN_SUFFIX = 2;
 
+    gPatternDirFd = open(SYSTEM_HYPHENATOR_DIR, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (gPatternDirFd == -1) {
+        gPatternDirFd = AT_FDCWD;
+    }
+
     addHyphenator("af", 1, 1);  // Afrikaans
     addHyphenator("am", 1, 1);  // Amharic
     addHyphenator("as", INDIC_MIN_PREFIX, INDIC_MIN_SUFFIX);  // Assamese
@@ -190,6 +204,11 @@ static void init() {
     addHyphenatorAlias("und-Orya", "or");  // Oriya
     addHyphenatorAlias("und-Taml", "ta");  // Tamil
     addHyphenatorAlias("und-Telu", "te");  // Telugu
+
+    if (gPatternDirFd != AT_FDCWD) {
+        close(gPatternDirFd);
+        gPatternDirFd = AT_FDCWD;
+    }
 }
 
 static const JNINativeMethod gMethods[] = {
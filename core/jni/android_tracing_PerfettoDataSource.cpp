@@ -210,7 +210,9 @@ void PerfettoDataSource::WritePackets(JNIEnv* env, jobjectArray packets) {
                                  buffer_size);
         PerfettoDsTracerPacketEnd(&gIterator, &trace_packet);
 
-        env->ReleaseByteArrayElements(packet_proto_buffer, raw_proto_buffer, 0 /* default mode */);
+        // The packet is only read, so there is nothing to copy back.
+        env->ReleaseByteArrayElements(packet_proto_buffer, raw_proto_buffer, JNI_ABORT);
+        env->DeleteLocalRef(packet_proto_buffer);
     }
 }
 
@@ -19,6 +19,7 @@
 
 #include "android_util_Binder.h"
 
+#include <android-base/properties.h>
 #include <android-base/stringprintf.h>
 #include <binder/BpBinder.h>
 #include <binder/IInterface.h>
@@ -46,9 +47,13 @@
 #include <utils/SystemClock.h>
 #include <utils/threads.h>
 
+#include <algorithm>
 #include <atomic>
+#include <map>
 #include <mutex>
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include "android_os_Parcel.h"
 #include "core_jni_helpers.h"
@@ -199,6 +204,149 @@ static void gcIfManyNewRefs(JNIEnv* env)
     }
 }
 
+// ****************************************************************************
+// ****************************************************************************
+// ****************************************************************************
+
+// Latency histograms of the transactions dispatched to Java binders, and of the synchronous
+// transactions Java makes on binder proxies, by interface descriptor and transaction code.
+// Recording is off unless the debug.binder.latency_histograms property is set when the
+// process starts; see dumpBinderLatencyHistograms().
+static bool gRecordLatencies = false;
+
+static constexpr size_t LATENCY_BUCKETS = 24;
+
+struct TransactionLatency
+{
+    uint64_t count = 0;
+    uint64_t totalNs = 0;
+    uint64_t maxNs = 0;
+    // Bucket i counts the transactions that took less than 2^(i+1) microseconds, but not less
+    // than 2^i. The last bucket also counts any that took longer.
+    uint64_t buckets[LATENCY_BUCKETS] = {};
+
+    void record(nsecs_t ns)
+    {
+        const uint64_t us = ns / 1000;
+        const size_t bucket = us < 2 ? 0 : 63 - __builtin_clzll(us);
+        buckets[std::min(bucket, LATENCY_BUCKETS - 1)]++;
+        count++;
+        totalNs += ns;
+        maxNs = std::max(maxNs, static_cast<uint64_t>(ns));
+    }
+
+    void add(const TransactionLatency& that)
+    {
+        for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+            buckets[i] += that.buckets[i];
+        }
+        count += that.count;
+        totalNs += that.totalNs;
+        maxNs = std::max(maxNs, that.maxNs);
+    }
+};
+
+// Whether the transaction was incoming, its interface descriptor and its code.
+typedef std::tuple<bool, String16, uint32_t> LatencyKey;
+typedef std::map<LatencyKey, TransactionLatency> LatencyMap;
+
+static void addLatencies(LatencyMap* to, const LatencyMap& from)
+{
+    for (const auto& [key, latency] : from) {
+        (*to)[key].add(latency);
+    }
+}
+
+struct ThreadLatencies;
+
+// Every thread records into its own histograms, which dumps merge. Leaked, since threads may
+// still exit while static destructors run.
+struct LatencyRegistry
+{
+    std::mutex lock;
+    std::vector<ThreadLatencies*> threads;
+    LatencyMap exited;  // The histograms of the threads that have exited.
+
+    static LatencyRegistry& get()
+    {
+        static LatencyRegistry* registry = new LatencyRegistry();
+        return *registry;
+    }
+};
+
+struct ThreadLatencies
+{
+    // Only contended while the histograms are being dumped.
+    std::mutex lock;
+    LatencyMap latencies;
+
+    ThreadLatencies()
+    {
+        LatencyRegistry& registry = LatencyRegistry::get();
+        std::lock_guard<std::mutex> registryGuard(registry.lock);
+        registry.threads.push_back(this);
+    }
+
+    ~ThreadLatencies()
+    {
+        LatencyRegistry& registry = LatencyRegistry::get();
+        std::lock_guard<std::mutex> registryGuard(registry.lock);
+        std::lock_guard<std::mutex> guard(lock);
+        addLatencies(&registry.exited, latencies);
+        registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), this));
+    }
+};
+
+static void recordTransactionLatency(bool incoming, const String16& descriptor, uint32_t code,
+                                     nsecs_t ns)
+{
+    thread_local ThreadLatencies threadLatencies;
+    std::lock_guard<std::mutex> guard(threadLatencies.lock);
+    threadLatencies.latencies[LatencyKey(incoming, descriptor, code)].record(ns);
+}
+
+namespace android {
+
+void dumpBinderLatencyHistograms(int fd)
+{
+    if (!gRecordLatencies) {
+        dprintf(fd, "Binder latency histograms are off; set debug.binder.latency_histograms\n");
+        return;
+    }
+
+    LatencyMap all;
+    {
+        LatencyRegistry& registry = LatencyRegistry::get();
+        std::lock_guard<std::mutex> registryGuard(registry.lock);
+        all = registry.exited;
+        for (ThreadLatencies* thread : registry.threads) {
+            std::lock_guard<std::mutex> guard(thread->lock);
+            addLatencies(&all, thread->latencies);
+        }
+    }
+
+    dprintf(fd, "Binder transaction latencies (count of transactions under each limit):\n");
+    for (const auto& [key, latency] : all) {
+        const auto& [incoming, descriptor, code] = key;
+        dprintf(fd, "  %s %s code=%" PRIu32 " count=%" PRIu64 " avg=%" PRIu64 "us max=%" PRIu64
+                "us:", incoming ? "incoming" : "outgoing", String8(descriptor).c_str(), code,
+                latency.count, latency.totalNs / latency.count / 1000, latency.maxNs / 1000);
+        for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+            if (latency.buckets[i] == 0) {
+                continue;
+            }
+            if (i == LATENCY_BUCKETS - 1) {
+                dprintf(fd, " >=%" PRIu64 "us=%" PRIu64, uint64_t(1) << i, latency.buckets[i]);
+            } else {
+                dprintf(fd, " <%" PRIu64 "us=%" PRIu64, uint64_t(2) << i, latency.buckets[i]);
+            }
+        }
+        dprintf(fd, "\n");
+    }
+}
+
+}
+
 static JavaVM* jnienv_to_javavm(JNIEnv* env)
 {
     JavaVM* vm;
@@ -406,8 +554,13 @@ protected:
         //printf("Transact from %p to Java code sending: ", this);
         //data.print();
         //printf("\n");
+        const nsecs_t start = gRecordLatencies ? systemTime(SYSTEM_TIME_MONOTONIC) : 0;
         jboolean res = env->CallBooleanMethod(mObject, gBinderOffsets.mExecTransact,
             code, reinterpret_cast<jlong>(&data), reinterpret_cast<jlong>(reply), flags);
+        if (gRecordLatencies) {
+            recordTransactionLatency(true, getInterfaceDescriptor(), code,
+                                     systemTime(SYSTEM_TIME_MONOTONIC) - start);
+        }
 
         if (env->ExceptionCheck()) {
             ScopedLocalRef<jthrowable> excep(env, env->ExceptionOccurred());
@@ -1531,7 +1684,15 @@ static jboolean android_os_BinderProxy_transact(JNIEnv* env, jobject obj,
             target, obj, code);
 
     //printf("Transact from Java code to %p sending: ", target); data->print();
+    // A oneway transaction returns once it is queued, so there's no latency worth recording.
+    const bool recordLatency = gRecordLatencies && (flags & IBinder::FLAG_ONEWAY) == 0;
+    const nsecs_t start = recordLatency ? systemTime(SYSTEM_TIME_MONOTONIC) : 0;
     status_t err = target->transact(code, *data, reply, flags);
+    if (recordLatency && err == NO_ERROR) {
+        // Proxies cache their descriptor, so this only costs a transaction the first time.
+        recordTransactionLatency(false, target->getInterfaceDescriptor(), code,
+                                 systemTime(SYSTEM_TIME_MONOTONIC) - start);
+    }
     //if (reply) printf("Transact from Java code to %p received: ", target); reply->print();
 
     if (err == NO_ERROR) {
@@ -1784,6 +1945,8 @@ static int int_register_android_os_BinderProxy(JNIEnv* env)
 
 int register_android_os_Binder(JNIEnv* env)
 {
+    gRecordLatencies = android::base::GetBoolProperty("debug.binder.latency_histograms", false);
+
     if (int_register_android_os_Binder(env) < 0)
         return -1;
     if (int_register_android_os_BinderInternal(env) < 0)
@@ -47,6 +47,9 @@ extern void signalExceptionForError(JNIEnv* env, jobject obj, status_t err,
 
 // does not take ownership of the exception, aborts if this is an error
 void binder_report_exception(JNIEnv* env, jthrowable excep, const char* msg);
+
+// Writes the latency histograms of this process's Java binder transactions to fd.
+void dumpBinderLatencyHistograms(int fd);
 }
 
 #endif
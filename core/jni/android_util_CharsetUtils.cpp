@@ -24,8 +24,11 @@ static jint android_util_CharsetUtils_toModifiedUtf8Bytes(JNIEnv *env, jobject c
     char *destPtr = reinterpret_cast<char*>(dest);
 
     // Quickly check if destination has plenty of room for worst-case
-    // 4-bytes-per-char encoded size
-    const jint worstLen = (srcLen * 4);
+    // 3-bytes-per-char encoded size; a UTF-16 char never needs more, since
+    // surrogate pairs take at most 4 bytes for 2 chars and lone surrogates
+    // take 3. The tighter bound lets more strings take this single pass
+    // instead of measuring them first.
+    const jint worstLen = (srcLen * 3);
     if (destOff >= 0 && destOff + worstLen < destLen) {
         env->GetStringUTFRegion(src, 0, srcLen, destPtr + destOff);
         return strlen(destPtr + destOff + srcLen) + srcLen;
@@ -37,6 +37,7 @@
 #include <limits>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "core_jni_helpers.h"
@@ -921,7 +922,7 @@ jboolean android_os_Process_parseProcLineArray(JNIEnv* env, jobject clazz,
     if (formatData == NULL || (NL > 0 && longsData == NULL)
             || (NR > 0 && floatsData == NULL)) {
         if (formatData != NULL) {
-            env->ReleaseIntArrayElements(format, formatData, 0);
+            env->ReleaseIntArrayElements(format, formatData, JNI_ABORT);
         }
         if (longsData != NULL) {
             env->ReleaseLongArrayElements(outLongs, longsData, 0);
@@ -1016,7 +1017,8 @@ jboolean android_os_Process_parseProcLineArray(JNIEnv* env, jobject clazz,
         }
     }
 
-    env->ReleaseIntArrayElements(format, formatData, 0);
+    // The format is only read, so don't copy it back on every parsed proc file.
+    env->ReleaseIntArrayElements(format, formatData, JNI_ABORT);
     if (longsData != NULL) {
         env->ReleaseLongArrayElements(outLongs, longsData, 0);
     }
@@ -1209,22 +1211,27 @@ static jlongArray android_os_Process_getRss(JNIEnv* env, jobject clazz, jint pid
 {
     // total, file, anon, swap, shmem
     jlong rss[5] = {0, 0, 0, 0, 0};
+    static constexpr std::string_view kRssFields[] = {"VmRSS:", "RssFile:", "RssAnon:", "VmSwap:",
+                                                      "RssShmem:"};
     std::string status_path =
             android::base::StringPrintf("/proc/%d/status", pid);
     UniqueFile file = MakeUniqueFile(status_path.c_str(), "re");
     char line[256];
-    while (file != nullptr && fgets(line, sizeof(line), file.get())) {
-        jlong v;
-        if ( sscanf(line, "VmRSS: %" SCNd64 " kB", &v) == 1) {
-            rss[0] = v;
-        } else if ( sscanf(line, "RssFile: %" SCNd64 " kB", &v) == 1) {
-            rss[1] = v;
-        } else if ( sscanf(line, "RssAnon: %" SCNd64 " kB", &v) == 1) {
-            rss[2] = v;
-        } else if ( sscanf(line, "VmSwap: %" SCNd64 " kB", &v) == 1) {
-            rss[3] = v;
-        } else if ( sscanf(line, "RssShmem: %" SCNd64 " kB", &v) == 1) {
-            rss[4] = v;
+    size_t found = 0;
+    // /proc/pid/status has ~50 lines, so match the field name before parsing a value, and stop
+    // once all fields were seen.
+    while (found < std::size(kRssFields) && file != nullptr &&
+           fgets(line, sizeof(line), file.get())) {
+        const std::string_view lineView(line);
+        for (size_t i = 0; i < std::size(kRssFields); i++) {
+            if (lineView.compare(0, kRssFields[i].size(), kRssFields[i]) == 0) {
+                jlong v;
+                if (sscanf(line + kRssFields[i].size(), " %" SCNd64 " kB", &v) == 1) {
+                    rss[i] = v;
+                    found++;
+                }
+                break;
+            }
         }
     }
 
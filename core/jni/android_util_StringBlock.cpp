@@ -23,14 +23,90 @@
 #include <core_jni_helpers.h>
 #include <utils/Log.h>
 
+#include <androidfw/ResIdMap.h>
+#include <androidfw/ResourceTimer.h>
 #include <androidfw/ResourceTypes.h>
 
 #include <stdio.h>
 
+#include <atomic>
+#include <mutex>
+
 namespace android {
 
 // ----------------------------------------------------------------------------
 
+// The Java strings created for the entries of a string pool. The strings are only weakly
+// referenced, so that a string the app still holds on to is returned again without decoding or
+// allocating, while unused strings can still be collected.
+class JavaStringCache : public ResStringPool::ClientCache {
+public:
+    ~JavaStringCache() override {
+        JNIEnv* env = AndroidRuntime::getJNIEnv();
+        if (env == nullptr) {
+            // The references cannot be deleted from a thread that is not attached to the VM, but
+            // they only keep a small table entry alive for each string.
+            return;
+        }
+        strings_.forEachItem([&](uint32_t, jweak string) { env->DeleteWeakGlobalRef(string); });
+        sTotalStrings.fetch_sub(strings_.size(), std::memory_order_relaxed);
+    }
+
+    // Returns a local reference to the cached string, or null if it is not cached.
+    jstring get(JNIEnv* env, size_t idx) {
+        std::lock_guard<std::mutex> lock(lock_);
+        if (jweak* string = strings_.find(key(idx))) {
+            return static_cast<jstring>(env->NewLocalRef(*string));
+        }
+        return nullptr;
+    }
+
+    void put(JNIEnv* env, size_t idx, jstring string) {
+        std::lock_guard<std::mutex> lock(lock_);
+        jweak& cached = strings_[key(idx)];
+        if (cached != nullptr) {
+            // The previous string was collected, or another thread created the same string.
+            env->DeleteWeakGlobalRef(cached);
+        } else if (sTotalStrings.fetch_add(1, std::memory_order_relaxed) >= kMaxTotalStrings) {
+            // Weak global references are a limited resource of the VM.
+            sTotalStrings.fetch_sub(1, std::memory_order_relaxed);
+            strings_.erase(key(idx));
+            return;
+        }
+        cached = env->NewWeakGlobalRef(string);
+    }
+
+private:
+    static constexpr size_t kMaxTotalStrings = 8192;
+    static std::atomic<size_t> sTotalStrings;
+
+    // Resource id 0 is reserved by ResIdMap.
+    static uint32_t key(size_t idx) {
+        return static_cast<uint32_t>(idx) + 1;
+    }
+
+    std::mutex lock_;
+    ResIdMap<jweak> strings_;
+};
+
+std::atomic<size_t> JavaStringCache::sTotalStrings = 0;
+
+static jstring newJavaString(JNIEnv* env, const ResStringPool* osb, jint idx) {
+    if (auto str8 = osb->string8At(idx); str8.has_value()) {
+        return env->NewStringUTF(str8->data());
+    }
+
+    auto str = osb->stringAt(idx);
+    if (IsIOError(str)) {
+        return NULL;
+    } else if (UNLIKELY(!str.has_value())) {
+        jniThrowException(env, "java/lang/IndexOutOfBoundsException", NULL);
+        return NULL;
+    }
+
+    return env->NewString((const jchar*)str->data(), str->size());
+}
+
 static jlong android_content_StringBlock_nativeCreate(JNIEnv* env, jobject clazz, jbyteArray bArray,
                                                       jint off, jint len) {
     if (bArray == NULL) {
@@ -75,19 +151,26 @@ static jstring android_content_StringBlock_nativeGetString(JNIEnv* env, jobject
         return NULL;
     }
 
-    if (auto str8 = osb->string8At(idx); str8.has_value()) {
-        return env->NewStringUTF(str8->data());
+    if (idx < 0 || static_cast<size_t>(idx) >= osb->size()) {
+        return newJavaString(env, osb, idx);
     }
 
-    auto str = osb->stringAt(idx);
-    if (IsIOError(str)) {
-        return NULL;
-    } else if (UNLIKELY(!str.has_value())) {
-        jniThrowException(env, "java/lang/IndexOutOfBoundsException", NULL);
-        return NULL;
+    auto cache = static_cast<JavaStringCache*>(osb->clientCache());
+    if (cache == nullptr) {
+        cache = static_cast<JavaStringCache*>(
+                osb->setClientCache(std::make_unique<JavaStringCache>()));
+    }
+    if (jstring cached = cache->get(env, idx); cached != NULL) {
+        ResourceTimer::count(ResourceTimer::Counter::StringBlockCacheHit);
+        return cached;
     }
 
-    return env->NewString((const jchar*)str->data(), str->size());
+    ResourceTimer::count(ResourceTimer::Counter::StringBlockCacheMiss);
+    jstring string = newJavaString(env, osb, idx);
+    if (string != NULL) {
+        cache->put(env, idx, string);
+    }
+    return string;
 }
 
 static jintArray android_content_StringBlock_nativeGetStyle(JNIEnv* env, jobject clazz, jlong token,
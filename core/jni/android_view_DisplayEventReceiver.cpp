@@ -28,6 +28,9 @@
 #include <utils/Looper.h>
 #include <utils/threads.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "android_os_MessageQueue.h"
 #include "core_jni_helpers.h"
 
@@ -86,8 +89,13 @@ protected:
 private:
     jobject mReceiverWeakGlobal;
     jobject mVsyncEventDataWeakGlobal;
+    // VsyncEventData.frameTimelines is final and its elements are allocated once, so the
+    // FrameTimeline objects are looked up on the first vsync and reused for every later one.
+    std::vector<jobject> mFrameTimelineGlobals;
     sp<MessageQueue> mMessageQueue;
 
+    void cacheFrameTimelines(JNIEnv* env, jobject vsyncEventDataObj);
+
     void dispatchVsync(nsecs_t timestamp, PhysicalDisplayId displayId, uint32_t count,
                        VsyncEventData vsyncEventData) override;
     void dispatchHotplug(nsecs_t timestamp, PhysicalDisplayId displayId, bool connected) override;
@@ -122,6 +130,10 @@ NativeDisplayEventReceiver::NativeDisplayEventReceiver(JNIEnv* env, jobject rece
 NativeDisplayEventReceiver::~NativeDisplayEventReceiver() {
     JNIEnv* env = AndroidRuntime::getJNIEnv();
     env->DeleteGlobalRef(mReceiverWeakGlobal);
+    env->DeleteGlobalRef(mVsyncEventDataWeakGlobal);
+    for (jobject frameTimeline : mFrameTimelineGlobals) {
+        env->DeleteGlobalRef(frameTimeline);
+    }
     ALOGV("receiver %p ~ dtor display event receiver.", this);
 }
 
@@ -168,6 +180,29 @@ static jobject createJavaVsyncEventData(JNIEnv* env, VsyncEventData vsyncEventDa
                           vsyncEventData.frameTimelinesLength, vsyncEventData.frameInterval);
 }
 
+void NativeDisplayEventReceiver::cacheFrameTimelines(JNIEnv* env, jobject vsyncEventDataObj) {
+    if (!mFrameTimelineGlobals.empty()) {
+        return;
+    }
+    ScopedLocalRef<jobjectArray>
+            frameTimelinesObj(env,
+                              reinterpret_cast<jobjectArray>(
+                                      env->GetObjectField(vsyncEventDataObj,
+                                                          gDisplayEventReceiverClassInfo
+                                                                  .vsyncEventDataClassInfo
+                                                                  .frameTimelines)));
+    if (!frameTimelinesObj.get()) {
+        return;
+    }
+    const jsize length = env->GetArrayLength(frameTimelinesObj.get());
+    mFrameTimelineGlobals.reserve(length);
+    for (jsize i = 0; i < length; i++) {
+        ScopedLocalRef<jobject>
+                frameTimelineObj(env, env->GetObjectArrayElement(frameTimelinesObj.get(), i));
+        mFrameTimelineGlobals.push_back(env->NewGlobalRef(frameTimelineObj.get()));
+    }
+}
+
 void NativeDisplayEventReceiver::dispatchVsync(nsecs_t timestamp, PhysicalDisplayId displayId,
                                                uint32_t count, VsyncEventData vsyncEventData) {
     JNIEnv* env = AndroidRuntime::getJNIEnv();
@@ -189,25 +224,21 @@ void NativeDisplayEventReceiver::dispatchVsync(nsecs_t timestamp, PhysicalDispla
                           gDisplayEventReceiverClassInfo.vsyncEventDataClassInfo.frameInterval,
                           vsyncEventData.frameInterval);
 
-        ScopedLocalRef<jobjectArray>
-                frameTimelinesObj(env,
-                                  reinterpret_cast<jobjectArray>(
-                                          env->GetObjectField(vsyncEventDataObj.get(),
-                                                              gDisplayEventReceiverClassInfo
-                                                                      .vsyncEventDataClassInfo
-                                                                      .frameTimelines)));
-        for (size_t i = 0; i < vsyncEventData.frameTimelinesLength; i++) {
+        cacheFrameTimelines(env, vsyncEventDataObj.get());
+        const size_t length =
+                std::min(static_cast<size_t>(vsyncEventData.frameTimelinesLength),
+                         mFrameTimelineGlobals.size());
+        for (size_t i = 0; i < length; i++) {
             VsyncEventData::FrameTimeline& frameTimeline = vsyncEventData.frameTimelines[i];
-            ScopedLocalRef<jobject>
-                    frameTimelineObj(env, env->GetObjectArrayElement(frameTimelinesObj.get(), i));
-            env->SetLongField(frameTimelineObj.get(),
+            jobject frameTimelineObj = mFrameTimelineGlobals[i];
+            env->SetLongField(frameTimelineObj,
                               gDisplayEventReceiverClassInfo.frameTimelineClassInfo.vsyncId,
                               frameTimeline.vsyncId);
-            env->SetLongField(frameTimelineObj.get(),
+            env->SetLongField(frameTimelineObj,
                               gDisplayEventReceiverClassInfo.frameTimelineClassInfo
                                       .expectedPresentationTime,
                               frameTimeline.expectedPresentationTime);
-            env->SetLongField(frameTimelineObj.get(),
+            env->SetLongField(frameTimelineObj,
                               gDisplayEventReceiverClassInfo.frameTimelineClassInfo.deadline,
                               frameTimeline.deadlineTimestamp);
         }
@@ -84,11 +84,29 @@ static void android_view_MotionEvent_setNativePtr(JNIEnv* env, ScopedLocalRef<jo
                       reinterpret_cast<jlong>(event));
 }
 
+static ScopedLocalRef<jobject> obtainMotionEventObject(JNIEnv* env) {
+    ScopedLocalRef<jobject> eventObj(env,
+                                     env->CallStaticObjectMethod(gMotionEventClassInfo.clazz,
+                                                                 gMotionEventClassInfo.obtain));
+    if (env->ExceptionCheck() || !eventObj.get()) {
+        LOGE_EX(env);
+        LOG_ALWAYS_FATAL("An exception occurred while obtaining a Java motion event.");
+    }
+    return eventObj;
+}
+
 ScopedLocalRef<jobject> android_view_MotionEvent_obtainAsCopy(JNIEnv* env,
                                                               const MotionEvent& event) {
-    std::unique_ptr<MotionEvent> destEvent = std::make_unique<MotionEvent>();
+    ScopedLocalRef<jobject> eventObj = obtainMotionEventObject(env);
+    // Recycled Java events keep their native event, so copy into it: its sample vectors already
+    // have room, which saves allocating and freeing a native event for every input event.
+    MotionEvent* destEvent = android_view_MotionEvent_getNativePtr(env, eventObj.get());
+    if (destEvent == nullptr) {
+        destEvent = new MotionEvent();
+        android_view_MotionEvent_setNativePtr(env, eventObj, destEvent);
+    }
     destEvent->copyFrom(&event, true);
-    return android_view_MotionEvent_obtainFromNative(env, std::move(destEvent));
+    return eventObj;
 }
 
 ScopedLocalRef<jobject> android_view_MotionEvent_obtainFromNative(
@@ -96,13 +114,7 @@ ScopedLocalRef<jobject> android_view_MotionEvent_obtainFromNative(
     if (event == nullptr) {
         return ScopedLocalRef<jobject>(env);
     }
-    ScopedLocalRef<jobject> eventObj(env,
-                                     env->CallStaticObjectMethod(gMotionEventClassInfo.clazz,
-                                                                 gMotionEventClassInfo.obtain));
-    if (env->ExceptionCheck() || !eventObj.get()) {
-        LOGE_EX(env);
-        LOG_ALWAYS_FATAL("An exception occurred while obtaining a Java motion event.");
-    }
+    ScopedLocalRef<jobject> eventObj = obtainMotionEventObject(env);
     MotionEvent* oldEvent = android_view_MotionEvent_getNativePtr(env, eventObj.get());
     delete oldEvent;
     android_view_MotionEvent_setNativePtr(env, eventObj, event.release());
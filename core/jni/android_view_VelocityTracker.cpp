@@ -48,21 +48,39 @@ public:
 private:
     VelocityTracker mVelocityTracker;
     VelocityTracker::ComputedVelocity mComputedVelocity;
+    // Whether mComputedVelocity is still valid for mComputedUnits and mComputedMaxVelocity, i.e.
+    // no movement was added or cleared since it was computed.
+    bool mComputedVelocityValid;
+    int32_t mComputedUnits;
+    float mComputedMaxVelocity;
 };
 
 VelocityTrackerState::VelocityTrackerState(const VelocityTracker::Strategy strategy)
-      : mVelocityTracker(strategy) {}
+      : mVelocityTracker(strategy),
+        mComputedVelocityValid(false),
+        mComputedUnits(0),
+        mComputedMaxVelocity(0) {}
 
 void VelocityTrackerState::clear() {
     mVelocityTracker.clear();
+    mComputedVelocityValid = false;
 }
 
 void VelocityTrackerState::addMovement(const MotionEvent& event) {
     mVelocityTracker.addMovement(event);
+    mComputedVelocityValid = false;
 }
 
 void VelocityTrackerState::computeCurrentVelocity(int32_t units, float maxVelocity) {
+    // Callers commonly compute again with the same arguments before any new movement arrives
+    // (e.g. once per axis query or per fling check), so skip refitting the strategy in that case.
+    if (mComputedVelocityValid && units == mComputedUnits && maxVelocity == mComputedMaxVelocity) {
+        return;
+    }
     mComputedVelocity = mVelocityTracker.getComputedVelocity(units, maxVelocity);
+    mComputedVelocityValid = true;
+    mComputedUnits = units;
+    mComputedMaxVelocity = maxVelocity;
 }
 
 float VelocityTrackerState::getVelocity(int32_t axis, int32_t id) {
@@ -18,6 +18,7 @@
 //#define LOG_NDEBUG 0
 
 #include <android-base/properties.h>
+#include <android-base/unique_fd.h>
 #include <androidfw/ApkParsing.h>
 #include <androidfw/ZipFileRO.h>
 #include <androidfw/ZipUtils.h>
@@ -36,8 +37,12 @@
 #include <utils/Log.h>
 #include <zlib.h>
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "com_android_internal_content_FileSystemUtils.h"
 #include "core_jni_helpers.h"
@@ -45,7 +50,6 @@
 #define RS_BITCODE_SUFFIX ".bc"
 
 #define TMP_FILE_PATTERN "/tmp.XXXXXX"
-#define TMP_FILE_PATTERN_LEN (sizeof(TMP_FILE_PATTERN) - 1)
 
 namespace android {
 
@@ -127,130 +131,192 @@ sumFiles(JNIEnv*, void* arg, ZipFileRO* zipFile, ZipEntryRO zipEntry, const char
     return INSTALL_SUCCEEDED;
 }
 
-static install_status_t extractNativeLibFromApk(ZipFileRO* zipFile, ZipEntryRO zipEntry,
-                                                const char* fileName,
-                                                const std::string nativeLibPath, uint32_t when,
-                                                uint32_t uncompLen, uint32_t crc) {
-    // Build local file path
-    const size_t fileNameLen = strlen(fileName);
-    char localFileName[nativeLibPath.size() + fileNameLen + 2];
+/*
+ * Extracts the native libraries queued by copyFileIfChanged. The entries are uncompressed into
+ * temporary files on a few worker threads, the filesystem is synced once for all of them, and only
+ * then are they renamed to their final names, so a crash never leaves a partial library behind.
+ */
+class NativeLibExtractor {
+public:
+    explicit NativeLibExtractor(ZipFileRO* zipFile) : mZipFile(zipFile) {}
 
-    if (strlcpy(localFileName, nativeLibPath.c_str(), sizeof(localFileName)) != nativeLibPath.size()) {
-        ALOGE("Couldn't allocate local file name for library");
-        return INSTALL_FAILED_INTERNAL_ERROR;
+    ~NativeLibExtractor() {
+        for (const PendingLib& lib : mLibs) {
+            if (!lib.tmpFileName.empty()) {
+                unlink(lib.tmpFileName.c_str());
+            }
+        }
     }
 
-    *(localFileName + nativeLibPath.size()) = '/';
+    // Queues zipEntry to be extracted as nativeLibPath/fileName, unless it is already there.
+    install_status_t add(ZipEntryRO zipEntry, const char* fileName, const char* nativeLibPath,
+                         uint32_t when, uint32_t uncompLen, uint32_t crc) {
+        PendingLib lib;
+        lib.localFileName = std::string(nativeLibPath) + '/' + fileName;
 
-    if (strlcpy(localFileName + nativeLibPath.size() + 1, fileName, sizeof(localFileName)
-                    - nativeLibPath.size() - 1) != fileNameLen) {
-        ALOGE("Couldn't allocate local file name for library");
-        return INSTALL_FAILED_INTERNAL_ERROR;
-    }
+        // Only copy out the native file if it's different.
+        struct tm t;
+        ZipUtils::zipTimeToTimespec(when, &t);
+        lib.modTime = mktime(&t);
+        struct stat64 st;
+        if (!isFileDifferent(lib.localFileName.c_str(), uncompLen, lib.modTime, crc, &st)) {
+            return INSTALL_SUCCEEDED;
+        }
+        lib.accessTime = st.st_atime;
 
-    // Only copy out the native file if it's different.
-    struct tm t;
-    ZipUtils::zipTimeToTimespec(when, &t);
-    const time_t modTime = mktime(&t);
-    struct stat64 st;
-    if (!isFileDifferent(localFileName, uncompLen, modTime, crc, &st)) {
-        return INSTALL_SUCCEEDED;
-    }
+        // The iteration reuses zipEntry for the next entry, so look it up again by name later.
+        char entryName[PATH_MAX];
+        if (mZipFile->getEntryFileName(zipEntry, entryName, sizeof(entryName))) {
+            ALOGE("Couldn't read zip entry name for %s\n", fileName);
+            return INSTALL_FAILED_INVALID_APK;
+        }
+        lib.entryName = entryName;
 
-    char localTmpFileName[nativeLibPath.size() + TMP_FILE_PATTERN_LEN + 1];
-    if (strlcpy(localTmpFileName, nativeLibPath.c_str(), sizeof(localTmpFileName))
-            != nativeLibPath.size()) {
-        ALOGE("Couldn't allocate local file name for library");
-        return INSTALL_FAILED_INTERNAL_ERROR;
+        mNativeLibPath = nativeLibPath;
+        mLibs.push_back(std::move(lib));
+        return INSTALL_SUCCEEDED;
     }
 
-    if (strlcpy(localTmpFileName + nativeLibPath.size(), TMP_FILE_PATTERN,
-                    TMP_FILE_PATTERN_LEN + 1) != TMP_FILE_PATTERN_LEN) {
-        ALOGE("Couldn't allocate temporary file name for library");
-        return INSTALL_FAILED_INTERNAL_ERROR;
-    }
+    install_status_t extractAll() {
+        if (mLibs.empty()) {
+            return INSTALL_SUCCEEDED;
+        }
 
-    int fd = mkstemp(localTmpFileName);
-    if (fd < 0) {
-        ALOGE("Couldn't open temporary file name: %s: %s\n", localTmpFileName, strerror(errno));
-        return INSTALL_FAILED_CONTAINER_ERROR;
-    }
+        std::atomic<size_t> nextLib = 0;
+        std::atomic<install_status_t> status = INSTALL_SUCCEEDED;
+        auto worker = [&] {
+            for (size_t i; status == INSTALL_SUCCEEDED && (i = nextLib++) < mLibs.size();) {
+                if (const install_status_t ret = extractToTmpFile(mLibs[i]);
+                    ret != INSTALL_SUCCEEDED) {
+                    status = ret;
+                }
+            }
+        };
+        const size_t numThreads = std::min(mLibs.size(), kMaxExtractionThreads);
+        std::vector<std::thread> threads;
+        threads.reserve(numThreads - 1);
+        for (size_t i = 1; i < numThreads; i++) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        if (status != INSTALL_SUCCEEDED) {
+            return status;
+        }
 
-    // If a filesystem like f2fs supports per-file compression, set the compression bit before data
-    // writes
-    unsigned int flags;
-    if (ioctl(fd, FS_IOC_GETFLAGS, &flags) == -1) {
-        ALOGE("Failed to call FS_IOC_GETFLAGS on %s: %s\n", localTmpFileName, strerror(errno));
-    } else if ((flags & FS_COMPR_FL) == 0) {
-        flags |= FS_COMPR_FL;
-        ioctl(fd, FS_IOC_SETFLAGS, &flags);
-    }
+        // One sync covers all of the temporary files, instead of an fsync for each of them.
+        android::base::unique_fd dirFd(
+                open(mNativeLibPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+        if (dirFd < 0 || syncfs(dirFd) < 0) {
+            ALOGE("Couldn't sync extracted libraries in %s: %s\n", mNativeLibPath.c_str(),
+                  strerror(errno));
+            return INSTALL_FAILED_INTERNAL_ERROR;
+        }
 
-    if (!zipFile->uncompressEntry(zipEntry, fd)) {
-        ALOGE("Failed uncompressing %s to %s\n", fileName, localTmpFileName);
-        close(fd);
-        unlink(localTmpFileName);
-        return INSTALL_FAILED_CONTAINER_ERROR;
-    }
+        for (PendingLib& lib : mLibs) {
+            // Finally, rename it to the final name.
+            if (rename(lib.tmpFileName.c_str(), lib.localFileName.c_str()) < 0) {
+                ALOGE("Couldn't rename %s to %s: %s\n", lib.tmpFileName.c_str(),
+                      lib.localFileName.c_str(), strerror(errno));
+                return INSTALL_FAILED_CONTAINER_ERROR;
+            }
+            ALOGV("Successfully moved %s to %s\n", lib.tmpFileName.c_str(),
+                  lib.localFileName.c_str());
+            lib.tmpFileName.clear();
 
-    if (fsync(fd) < 0) {
-        ALOGE("Coulnd't fsync temporary file name: %s: %s\n", localTmpFileName, strerror(errno));
-        close(fd);
-        unlink(localTmpFileName);
-        return INSTALL_FAILED_INTERNAL_ERROR;
-    }
+#ifdef ENABLE_PUNCH_HOLES
+            // punch extracted elf files as well. This will fail where compression is on (like
+            // f2fs) but it will be useful for ext4 based systems
+            struct statfs64 fsInfo;
+            int result = statfs64(lib.localFileName.c_str(), &fsInfo);
+            if (result < 0) {
+                ALOGW("Failed to stat file :%s", lib.localFileName.c_str());
+            }
 
-    close(fd);
+            if (result == 0 && fsInfo.f_type == EXT4_SUPER_MAGIC) {
+                ALOGD("Punching extracted elf file %s on fs:%" PRIu64 "", lib.entryName.c_str(),
+                      static_cast<uint64_t>(fsInfo.f_type));
+                if (!punchHolesInElf64(lib.localFileName.c_str(), 0)) {
+                    ALOGW("Failed to punch extracted elf file :%s from apk : %s",
+                          lib.entryName.c_str(), mZipFile->getZipFileName());
+                }
+            }
+#endif // ENABLE_PUNCH_HOLES
+        }
 
-    // Set the modification time for this file to the ZIP's mod time.
-    struct timeval times[2];
-    times[0].tv_sec = st.st_atime;
-    times[1].tv_sec = modTime;
-    times[0].tv_usec = times[1].tv_usec = 0;
-    if (utimes(localTmpFileName, times) < 0) {
-        ALOGE("Couldn't change modification time on %s: %s\n", localTmpFileName, strerror(errno));
-        unlink(localTmpFileName);
-        return INSTALL_FAILED_CONTAINER_ERROR;
+        return INSTALL_SUCCEEDED;
     }
 
-    // Set the mode to 755
-    static const mode_t mode = S_IRUSR | S_IWUSR | S_IXUSR | S_IRGRP |  S_IXGRP | S_IROTH | S_IXOTH;
-    if (chmod(localTmpFileName, mode) < 0) {
-        ALOGE("Couldn't change permissions on %s: %s\n", localTmpFileName, strerror(errno));
-        unlink(localTmpFileName);
-        return INSTALL_FAILED_CONTAINER_ERROR;
-    }
+private:
+    // Extraction is mostly inflate, so a few threads are enough to keep the storage busy.
+    static constexpr size_t kMaxExtractionThreads = 4;
+
+    struct PendingLib {
+        std::string entryName;
+        std::string localFileName;
+        std::string tmpFileName;
+        time_t modTime;
+        time_t accessTime;
+    };
+
+    install_status_t extractToTmpFile(PendingLib& lib) const {
+        std::string tmpFileName = mNativeLibPath + TMP_FILE_PATTERN;
+        int fd = mkstemp(tmpFileName.data());
+        if (fd < 0) {
+            ALOGE("Couldn't open temporary file name: %s: %s\n", tmpFileName.c_str(),
+                  strerror(errno));
+            return INSTALL_FAILED_CONTAINER_ERROR;
+        }
+        lib.tmpFileName = std::move(tmpFileName);
+        const char* localTmpFileName = lib.tmpFileName.c_str();
+
+        // If a filesystem like f2fs supports per-file compression, set the compression bit before
+        // data writes
+        unsigned int flags;
+        if (ioctl(fd, FS_IOC_GETFLAGS, &flags) == -1) {
+            ALOGE("Failed to call FS_IOC_GETFLAGS on %s: %s\n", localTmpFileName, strerror(errno));
+        } else if ((flags & FS_COMPR_FL) == 0) {
+            flags |= FS_COMPR_FL;
+            ioctl(fd, FS_IOC_SETFLAGS, &flags);
+        }
 
-    // Finally, rename it to the final name.
-    if (rename(localTmpFileName, localFileName) < 0) {
-        ALOGE("Couldn't rename %s to %s: %s\n", localTmpFileName, localFileName, strerror(errno));
-        unlink(localTmpFileName);
-        return INSTALL_FAILED_CONTAINER_ERROR;
-    }
+        ZipEntryRO zipEntry = mZipFile->findEntryByName(lib.entryName.c_str());
+        const bool uncompressed = zipEntry != nullptr && mZipFile->uncompressEntry(zipEntry, fd);
+        mZipFile->releaseEntry(zipEntry);
+        close(fd);
+        if (!uncompressed) {
+            ALOGE("Failed uncompressing %s to %s\n", lib.entryName.c_str(), localTmpFileName);
+            return INSTALL_FAILED_CONTAINER_ERROR;
+        }
 
-#ifdef ENABLE_PUNCH_HOLES
-    // punch extracted elf files as well. This will fail where compression is on (like f2fs) but it
-    // will be useful for ext4 based systems
-    struct statfs64 fsInfo;
-    int result = statfs64(localFileName, &fsInfo);
-    if (result < 0) {
-        ALOGW("Failed to stat file :%s", localFileName);
-    }
-
-    if (result == 0 && fsInfo.f_type == EXT4_SUPER_MAGIC) {
-        ALOGD("Punching extracted elf file %s on fs:%" PRIu64 "", fileName,
-              static_cast<uint64_t>(fsInfo.f_type));
-        if (!punchHolesInElf64(localFileName, 0)) {
-            ALOGW("Failed to punch extracted elf file :%s from apk : %s", fileName,
-                  zipFile->getZipFileName());
+        // Set the modification time for this file to the ZIP's mod time.
+        struct timeval times[2];
+        times[0].tv_sec = lib.accessTime;
+        times[1].tv_sec = lib.modTime;
+        times[0].tv_usec = times[1].tv_usec = 0;
+        if (utimes(localTmpFileName, times) < 0) {
+            ALOGE("Couldn't change modification time on %s: %s\n", localTmpFileName,
+                  strerror(errno));
+            return INSTALL_FAILED_CONTAINER_ERROR;
         }
-    }
-#endif // ENABLE_PUNCH_HOLES
 
-    ALOGV("Successfully moved %s to %s\n", localTmpFileName, localFileName);
+        // Set the mode to 755
+        static const mode_t mode =
+                S_IRUSR | S_IWUSR | S_IXUSR | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH;
+        if (chmod(localTmpFileName, mode) < 0) {
+            ALOGE("Couldn't change permissions on %s: %s\n", localTmpFileName, strerror(errno));
+            return INSTALL_FAILED_CONTAINER_ERROR;
+        }
 
-    return INSTALL_SUCCEEDED;
-}
+        return INSTALL_SUCCEEDED;
+    }
+
+    ZipFileRO* const mZipFile;
+    std::string mNativeLibPath;
+    std::vector<PendingLib> mLibs;
+};
 
 /*
  * Copy the native library if needed.
@@ -265,6 +331,7 @@ static install_status_t copyFileIfChanged(JNIEnv* env, void* arg, ZipFileRO* zip
     jboolean extractNativeLibs = *(jboolean*)args[1];
     jboolean debuggable = *(jboolean*)args[2];
     jboolean app_compat_16kb = *(jboolean*)args[3];
+    NativeLibExtractor* extractor = reinterpret_cast<NativeLibExtractor*>(args[4]);
     install_status_t ret = INSTALL_SUCCEEDED;
 
     ScopedUtfChars nativeLibPath(env, *javaNativeLibPath);
@@ -302,8 +369,8 @@ static install_status_t copyFileIfChanged(JNIEnv* env, void* arg, ZipFileRO* zip
                 ALOGI("16kB AppCompat: Library '%s' is not PAGE(%zu)-aligned - falling back to "
                       "extraction from apk\n",
                       fileName, kPageSize);
-                return extractNativeLibFromApk(zipFile, zipEntry, fileName, nativeLibPath.c_str(),
-                                               when, uncompLen, crc);
+                return extractor->add(zipEntry, fileName, nativeLibPath.c_str(), when, uncompLen,
+                                      crc);
             }
 
             ALOGE("Library '%s' is not PAGE(%zu)-aligned - will not be able to open it directly "
@@ -330,8 +397,7 @@ static install_status_t copyFileIfChanged(JNIEnv* env, void* arg, ZipFileRO* zip
         return INSTALL_SUCCEEDED;
     }
 
-    return extractNativeLibFromApk(zipFile, zipEntry, fileName, nativeLibPath.c_str(), when,
-                                   uncompLen, crc);
+    return extractor->add(zipEntry, fileName, nativeLibPath.c_str(), when, uncompLen, crc);
 }
 
 /*
@@ -537,9 +603,15 @@ com_android_internal_content_NativeLibraryHelper_copyNativeBinaries(JNIEnv *env,
         jboolean extractNativeLibs, jboolean debuggable)
 {
     jboolean app_compat_16kb = app_compat_16kb_enabled();
-    void* args[] = { &javaNativeLibPath, &extractNativeLibs, &debuggable, &app_compat_16kb };
-    return (jint) iterateOverNativeFiles(env, apkHandle, javaCpuAbi, debuggable,
+    NativeLibExtractor extractor(reinterpret_cast<ZipFileRO*>(apkHandle));
+    void* args[] = { &javaNativeLibPath, &extractNativeLibs, &debuggable, &app_compat_16kb,
+            &extractor };
+    install_status_t ret = iterateOverNativeFiles(env, apkHandle, javaCpuAbi, debuggable,
             copyFileIfChanged, reinterpret_cast<void*>(args));
+    if (ret == INSTALL_SUCCEEDED) {
+        ret = extractor.extractAll();
+    }
+    return (jint) ret;
 }
 
 static jlong
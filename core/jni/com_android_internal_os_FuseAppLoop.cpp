@@ -22,6 +22,7 @@
 
 #include <map>
 #include <memory>
+#include <vector>
 
 #include <android_runtime/Log.h>
 #include <android-base/logging.h>
@@ -29,7 +30,6 @@
 #include <jni.h>
 #include <libappfuse/FuseAppLoop.h>
 #include <nativehelper/ScopedLocalRef.h>
-#include <nativehelper/ScopedPrimitiveArray.h>
 
 #include "core_jni_helpers.h"
 
@@ -165,10 +165,14 @@ void com_android_internal_os_FuseAppLoop_replyWrite(
 
 void com_android_internal_os_FuseAppLoop_replyRead(
         JNIEnv* env, jobject self, jlong ptr, jlong unique, jint size, jbyteArray data) {
-    ScopedByteArrayRO array(env, data);
     CHECK_GE(size, 0);
-    CHECK_LE(static_cast<size_t>(size), array.size());
-    if (!reinterpret_cast<fuse::FuseAppLoop*>(ptr)->ReplyRead(unique, size, array.get())) {
+    CHECK_LE(size, env->GetArrayLength(data));
+    // The per-file buffer from onOpen is usually much larger than the read, so copy out only the
+    // bytes being replied with rather than the whole array.
+    thread_local std::vector<jbyte> buffer;
+    buffer.resize(size);
+    env->GetByteArrayRegion(data, 0, size, buffer.data());
+    if (!reinterpret_cast<fuse::FuseAppLoop*>(ptr)->ReplyRead(unique, size, buffer.data())) {
         reinterpret_cast<fuse::FuseAppLoop*>(ptr)->Break();
     }
 }
@@ -43,14 +43,16 @@ static jlongArray getUidArray(JNIEnv *env, jobject sparseAr, uint32_t uid, jsize
     return ar;
 }
 
-static void copy2DVecToArray(JNIEnv *env, jlongArray ar, std::vector<std::vector<uint64_t>> &vec) {
-    jsize start = 0;
-    for (auto &subVec : vec) {
-        for (uint32_t i = 0; i < subVec.size(); ++i) subVec[i] /= NSEC_PER_MSEC;
-        env->SetLongArrayRegion(ar, start, subVec.size(),
-                                reinterpret_cast<const jlong *>(subVec.data()));
-        start += subVec.size();
+// Flattens vec into buf, which is reused across UIDs, so that each UID is copied into Java with a
+// single JNI call rather than one per policy.
+static void copy2DVecToArray(JNIEnv *env, jlongArray ar,
+                             const std::vector<std::vector<uint64_t>> &vec,
+                             std::vector<jlong> &buf) {
+    buf.clear();
+    for (const auto &subVec : vec) {
+        for (uint64_t time : subVec) buf.push_back(time / NSEC_PER_MSEC);
     }
+    env->SetLongArrayRegion(ar, 0, buf.size(), buf.data());
 }
 
 static jboolean KernelCpuUidFreqTimeBpfMapReader_removeUidRange(JNIEnv *env, jclass, jint startUid,
@@ -70,13 +72,16 @@ static jboolean KernelCpuUidFreqTimeBpfMapReader_readBpfData(JNIEnv *env, jobjec
     if (!data.has_value()) return false;
 
     jsize s = 0;
+    std::vector<jlong> buf;
     for (auto &[uid, times] : *data) {
         if (s == 0) {
             for (const auto &subVec : times) s += subVec.size();
+            buf.reserve(s);
         }
         jlongArray ar = getUidArray(env, sparseAr, uid, s);
         if (ar == nullptr) return false;
-        copy2DVecToArray(env, ar, times);
+        copy2DVecToArray(env, ar, times, buf);
+        env->DeleteLocalRef(ar);
     }
     lastUpdate = newLastUpdate;
     return true;
@@ -102,6 +107,7 @@ static jboolean KernelCpuUidActiveTimeBpfMapReader_readBpfData(JNIEnv *env, jobj
         if (ar == nullptr) return false;
         env->SetLongArrayRegion(ar, 0, times.active.size(),
                                 reinterpret_cast<const jlong *>(times.active.data()));
+        env->DeleteLocalRef(ar);
     }
     lastUpdate = newLastUpdate;
     return true;
@@ -129,13 +135,16 @@ static jboolean KernelCpuUidClusterTimeBpfMapReader_readBpfData(JNIEnv *env, job
     if (!data.has_value()) return false;
 
     jsize s = 0;
+    std::vector<jlong> buf;
     for (auto &[uid, times] : *data) {
         if (s == 0) {
             for (const auto &subVec : times.policy) s += subVec.size();
+            buf.reserve(s);
         }
         jlongArray ar = getUidArray(env, sparseAr, uid, s);
         if (ar == nullptr) return false;
-        copy2DVecToArray(env, ar, times.policy);
+        copy2DVecToArray(env, ar, times.policy, buf);
+        env->DeleteLocalRef(ar);
     }
     lastUpdate = newLastUpdate;
     return true;
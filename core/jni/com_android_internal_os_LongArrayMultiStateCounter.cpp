@@ -266,21 +266,20 @@ static jlong native_getReleaseFunc_LongArrayContainer() {
 static void native_setValues_LongArrayContainer(JNIEnv *env, jclass, jlong nativePtr,
                                                 jlongArray jarray) {
     std::vector<uint64_t> *vector = reinterpret_cast<std::vector<uint64_t> *>(nativePtr);
-    ScopedLongArrayRO scopedArray(env, jarray);
-    const uint64_t *array = reinterpret_cast<const uint64_t *>(scopedArray.get());
-    uint8_t size = scopedArray.size();
 
-    // Boundary checks are performed in the Java layer
-    std::copy(array, array + size, vector->data());
+    // Boundary checks are performed in the Java layer. Copying the region straight into the
+    // container avoids pinning or copying out the whole Java array first.
+    env->GetLongArrayRegion(jarray, 0, vector->size(), reinterpret_cast<jlong *>(vector->data()));
 }
 
 static void native_getValues_LongArrayContainer(JNIEnv *env, jclass, jlong nativePtr,
                                                 jlongArray jarray) {
     std::vector<uint64_t> *vector = reinterpret_cast<std::vector<uint64_t> *>(nativePtr);
-    ScopedLongArrayRW scopedArray(env, jarray);
 
-    // Boundary checks are performed in the Java layer
-    std::copy(vector->data(), vector->data() + vector->size(), scopedArray.get());
+    // Boundary checks are performed in the Java layer. The array is only written, so there is
+    // no need to copy its old contents in as ScopedLongArrayRW would.
+    env->SetLongArrayRegion(jarray, 0, vector->size(),
+                            reinterpret_cast<const jlong *>(vector->data()));
 }
 
 static jboolean native_combineValues_LongArrayContainer(JNIEnv *env, jclass, jlong nativePtr,
@@ -54,7 +54,10 @@ constexpr size_t NICE_NAME_BYTES = 128;
 // close the descriptor.
 class NativeCommandBuffer {
  public:
-  NativeCommandBuffer(int sourceFd): mEnd(0), mNext(0), mLinesLeft(0), mFd(sourceFd) {}
+  NativeCommandBuffer(int sourceFd): mEnd(0), mNext(0), mLinesLeft(0), mFd(sourceFd) {
+    // The memory may be reused from an earlier buffer; the rest is never read before written.
+    mNiceName[0] = '\0';
+  }
 
   // Read mNext line from mFd, filling mBuffer from file descriptor, as needed.
   // Return a pair of pointers pointing to the first character, and one past the
@@ -290,18 +293,27 @@ class NativeCommandBuffer {
 
 static int buffersAllocd(0);
 
+// The Java code gets a buffer for every request it handles, so the zygote keeps the mapping
+// of the last freed buffer for the next one instead of mapping and faulting in new pages each
+// time. Only the process that mapped it keeps it; forked children unmap what they inherit.
+static void* gFreeBufferMem = nullptr;
+static pid_t gFreeBufferOwner = 0;
+
 // Get a new NativeCommandBuffer. Can only be called once between freeNativeBuffer calls,
 // so that only one buffer exists at a time.
 jlong com_android_internal_os_ZygoteCommandBuffer_getNativeBuffer(JNIEnv* env, jclass, jint fd) {
   CHECK(buffersAllocd == 0);
   ++buffersAllocd;
-  // MMap explicitly to get it page aligned.
-  void *bufferMem = mmap(NULL, sizeof(NativeCommandBuffer), PROT_READ | PROT_WRITE,
-                         MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
-  // Currently we mmap and unmap one for every request handled by the Java code.
-  // That could be improved, but unclear it matters.
-  if (bufferMem == MAP_FAILED) {
-    ZygoteFailure(env, nullptr, nullptr, "Failed to map argument buffer");
+  void *bufferMem = gFreeBufferMem;
+  gFreeBufferMem = nullptr;
+  if (bufferMem == nullptr) {
+    // MMap explicitly to get it page aligned.
+    bufferMem = mmap(NULL, sizeof(NativeCommandBuffer), PROT_READ | PROT_WRITE,
+                     MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (bufferMem == MAP_FAILED) {
+      ZygoteFailure(env, nullptr, nullptr, "Failed to map argument buffer");
+    }
+    gFreeBufferOwner = getpid();
   }
   return (jlong) new(bufferMem) NativeCommandBuffer(fd);
 }
@@ -312,10 +324,14 @@ void com_android_internal_os_ZygoteCommandBuffer_freeNativeBuffer(JNIEnv* env, j
   CHECK(buffersAllocd == 1);
   NativeCommandBuffer* n_buffer = reinterpret_cast<NativeCommandBuffer*>(j_buffer);
   n_buffer->~NativeCommandBuffer();
+  --buffersAllocd;
+  if (gFreeBufferOwner == getpid()) {
+    gFreeBufferMem = n_buffer;
+    return;
+  }
   if (munmap(n_buffer, sizeof(NativeCommandBuffer)) != 0) {
     ZygoteFailure(env, nullptr, nullptr, "Failed to unmap argument buffer");
   }
-  --buffersAllocd;
 }
 
 // Clear the buffer, read the line containing the count, and return the count.
@@ -50,6 +50,10 @@ int enableFsverityForFd(JNIEnv *env, jobject clazz, jint fd) {
     arg.salt_size = 0;
     arg.salt_ptr = reinterpret_cast<uintptr_t>(nullptr);
 
+    // Building the Merkle tree reads the whole file front to back through the page cache, so ask
+    // for the larger sequential readahead window. This is only a hint; failure is not an error.
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
     if (ioctl(fd, FS_IOC_ENABLE_VERITY, &arg) < 0) {
         return errno;
     }
@@ -17,7 +17,9 @@
 #ifndef FRAMEWORKS_BASE_CORE_JNI_EVENTLOG_HELPER_H_
 #define FRAMEWORKS_BASE_CORE_JNI_EVENTLOG_HELPER_H_
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #include <fcntl.h>
 
@@ -28,7 +30,6 @@
 
 #include <nativehelper/JNIHelp.h>
 #include <nativehelper/ScopedLocalRef.h>
-#include <nativehelper/ScopedPrimitiveArray.h>
 #include <nativehelper/ScopedUtfChars.h>
 #include "core_jni_helpers.h"
 #include "jni.h"
@@ -169,9 +170,12 @@ public:
             return;
         }
 
-        ScopedIntArrayRO tags(env);
+        // Sorted so that each event costs a binary search rather than a scan of every tag.
+        std::vector<int32_t> tags;
         if (jTags != nullptr) {
-            tags.reset(jTags);
+            tags.resize(env->GetArrayLength(jTags));
+            env->GetIntArrayRegion(jTags, 0, tags.size(), tags.data());
+            std::sort(tags.begin(), tags.end());
         }
 
         while (1) {
@@ -199,14 +203,8 @@ public:
 
             int32_t tag = * (int32_t *) log_msg.msg();
 
-            if (jTags != nullptr) {
-                bool found = false;
-                for (size_t i = 0; !found && i < tags.size(); ++i) {
-                    found = (tag == tags[i]);
-                }
-                if (!found) {
-                    continue;
-                }
+            if (jTags != nullptr && !std::binary_search(tags.begin(), tags.end(), tag)) {
+                continue;
             }
 
             jsize len = ret;
@@ -215,10 +213,8 @@ public:
                 return;
             }
 
-            {
-                ScopedByteArrayRW bytes(env, array.get());
-                memcpy(bytes.get(), log_msg.buf, len);
-            }
+            env->SetByteArrayRegion(array.get(), 0, len,
+                                    reinterpret_cast<const jbyte*>(log_msg.buf));
 
             ScopedLocalRef<jobject> event(env,
                     env->NewObject(gEventClass, gEventInitID, array.get()));
@@ -69,15 +69,8 @@ static bool IsArtMemfd(const std::string& path) {
 }
 
 bool FileDescriptorAllowlist::IsAllowed(const std::string& path) const {
-    // Check the static allowlist path.
-    for (const auto& allowlist_path : kPathAllowlist) {
-        if (path == allowlist_path) return true;
-    }
-
-    // Check any paths added to the dynamic allowlist.
-    for (const auto& allowlist_path : allowlist_) {
-        if (path == allowlist_path) return true;
-    }
+    // Check the static and dynamic allowlist paths.
+    if (allowlist_.count(path) != 0) return true;
 
     // Framework jars are allowed.
     static const char* kFrameworksPrefix[] = {
@@ -172,7 +165,8 @@ bool FileDescriptorAllowlist::IsAllowed(const std::string& path) const {
     return false;
 }
 
-FileDescriptorAllowlist::FileDescriptorAllowlist() : allowlist_() {}
+FileDescriptorAllowlist::FileDescriptorAllowlist()
+    : allowlist_(std::begin(kPathAllowlist), std::end(kPathAllowlist)) {}
 
 FileDescriptorAllowlist* FileDescriptorAllowlist::instance_ = nullptr;
 
@@ -346,28 +340,26 @@ void FileDescriptorInfo::ReopenOrDetach(fail_fn_t fail_fn) const {
     return;
   }
 
+  // This runs for every zygote fd on the fork path, so save the syscalls we can:
+  // the status flags that open() accepts are passed to it instead of F_SETFL,
+  // and the fd flags (only FD_CLOEXEC) are set on |fd| by dup3() below, so the
+  // temporary descriptor doesn't need them.
+  static const int kOpenableStatusFlags = (O_APPEND | O_DIRECT | O_NOATIME | O_NONBLOCK);
+  const int reopen_flags = open_flags | (fs_flags & kOpenableStatusFlags) | O_CLOEXEC;
+
   // NOTE: This might happen if the file was unlinked after being opened.
   // It's a common pattern in the case of temporary files and the like but
   // we should not allow such usage from the zygote.
-  const int new_fd = TEMP_FAILURE_RETRY(open(file_path.c_str(), open_flags));
+  const int new_fd = TEMP_FAILURE_RETRY(open(file_path.c_str(), reopen_flags));
 
   if (new_fd == -1) {
     fail_fn(android::base::StringPrintf("Failed open(%s, %i): %s",
                                         file_path.c_str(),
-                                        open_flags,
-                                        strerror(errno)));
-  }
-
-  if (TEMP_FAILURE_RETRY(fcntl(new_fd, F_SETFD, fd_flags)) == -1) {
-    close(new_fd);
-    fail_fn(android::base::StringPrintf("Failed fcntl(%d, F_SETFD, %d) (%s): %s",
-                                        new_fd,
-                                        fd_flags,
-                                        file_path.c_str(),
+                                        reopen_flags,
                                         strerror(errno)));
   }
 
-  if (TEMP_FAILURE_RETRY(fcntl(new_fd, F_SETFL, fs_flags)) == -1) {
+  if ((fs_flags & O_ASYNC) != 0 && TEMP_FAILURE_RETRY(fcntl(new_fd, F_SETFL, fs_flags)) == -1) {
     close(new_fd);
     fail_fn(android::base::StringPrintf("Failed fcntl(%d, F_SETFL, %d) (%s): %s",
                                         new_fd,
@@ -376,7 +368,8 @@ void FileDescriptorInfo::ReopenOrDetach(fail_fn_t fail_fn) const {
                                         strerror(errno)));
   }
 
-  if (offset != -1 && TEMP_FAILURE_RETRY(lseek64(new_fd, offset, SEEK_SET)) == -1) {
+  // A newly opened file is already at offset 0.
+  if (offset > 0 && TEMP_FAILURE_RETRY(lseek64(new_fd, offset, SEEK_SET)) == -1) {
     close(new_fd);
     fail_fn(android::base::StringPrintf("Failed lseek64(%d, SEEK_SET) (%s): %s",
                                         new_fd,
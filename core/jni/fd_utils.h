@@ -21,6 +21,7 @@
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <dirent.h>
@@ -52,7 +53,7 @@ public:
     static FileDescriptorAllowlist* Get();
 
     // Adds a path to the allowlist.
-    void Allow(const std::string& path) { allowlist_.push_back(path); }
+    void Allow(const std::string& path) { allowlist_.insert(path); }
 
     // Returns true iff. a given path is allowlisted. A path is allowlisted
     // if it belongs to the allowlist (see kPathAllowlist) or if it's a path
@@ -65,7 +66,8 @@ private:
 
     static FileDescriptorAllowlist* instance_;
 
-    std::vector<std::string> allowlist_;
+    // The exact paths that are allowed: kPathAllowlist and those passed to Allow().
+    std::unordered_set<std::string> allowlist_;
 
     DISALLOW_COPY_AND_ASSIGN(FileDescriptorAllowlist);
 };
@@ -110,13 +110,15 @@ DEFINE_ALLOC_VECTOR_METHODS(Int64,jlong,Long)
 DEFINE_ALLOC_VECTOR_METHODS(Float,jfloat,Float)
 DEFINE_ALLOC_VECTOR_METHODS(Double,jdouble,Double)
 
+// The arrays are only read while the parcel is written, so a copy made by
+// Get*ArrayElements() is dropped rather than written back.
 #define DEFINE_RELEASE_ARRAY_CASE(Suffix,Type,NewType)                         \
             case TYPE_ ## Suffix ## _ARRAY:                                    \
             {                                                                  \
                 env->Release ## NewType ## ArrayElements(                      \
                         (Type ## Array)item.mObj,                              \
                         (Type *)item.mPtr,                                     \
-                        0 /* mode */);                                         \
+                        JNI_ABORT);                                            \
                                                                                \
                 env->DeleteGlobalRef(item.mObj);                               \
                 break;                                                         \
@@ -16,9 +16,14 @@
 
 #include "androidfw/ApkAssets.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #include "android-base/errors.h"
 #include "android-base/logging.h"
 #include "android-base/utf8.h"
+#include "androidfw/ResourceTimer.h"
 
 namespace android {
 
@@ -27,6 +32,8 @@ using base::unique_fd;
 
 constexpr const char* kResourcesArsc = "resources.arsc";
 
+static std::atomic<uint64_t> next_unique_id{1};
+
 ApkAssets::ApkAssets(PrivateConstructorUtil, std::unique_ptr<Asset> resources_asset,
                      std::unique_ptr<LoadedArsc> loaded_arsc,
                      std::unique_ptr<AssetsProvider> assets, package_property_t property_flags,
@@ -36,15 +43,18 @@ ApkAssets::ApkAssets(PrivateConstructorUtil, std::unique_ptr<Asset> resources_as
       assets_provider_(std::move(assets)),
       property_flags_(property_flags),
       idmap_asset_(std::move(idmap_asset)),
-      loaded_idmap_(std::move(loaded_idmap)) {
+      loaded_idmap_(std::move(loaded_idmap)),
+      unique_id_(next_unique_id.fetch_add(1, std::memory_order_relaxed)) {
 }
 
 ApkAssetsPtr ApkAssets::Load(const std::string& path, package_property_t flags) {
+  ResourceTimer _timer(ResourceTimer::Counter::ApkAssetsLoad);
   return Load(ZipAssetsProvider::Create(path, flags), flags);
 }
 
 ApkAssetsPtr ApkAssets::LoadFromFd(base::unique_fd fd, const std::string& debug_name,
                                    package_property_t flags, off64_t offset, off64_t len) {
+  ResourceTimer _timer(ResourceTimer::Counter::ApkAssetsLoad);
   return Load(ZipAssetsProvider::Create(std::move(fd), debug_name, offset, len), flags);
 }
 
@@ -64,6 +74,7 @@ ApkAssetsPtr ApkAssets::LoadTable(std::unique_ptr<Asset> resources_asset,
 
 ApkAssetsPtr ApkAssets::LoadOverlay(const std::string& idmap_path, package_property_t flags) {
   CHECK((flags & PROPERTY_LOADER) == 0U) << "Cannot load RROs through loaders";
+  ResourceTimer _timer(ResourceTimer::Counter::ApkAssetsLoad);
   auto idmap_asset = AssetsProvider::CreateAssetFromFile(idmap_path);
   if (idmap_asset == nullptr) {
     LOG(ERROR) << "failed to read IDMAP " << idmap_path;
@@ -97,6 +108,56 @@ ApkAssetsPtr ApkAssets::LoadOverlay(const std::string& idmap_path, package_prope
                   std::move(loaded_idmap));
 }
 
+std::vector<sp<const ApkAssets>> ApkAssets::LoadAll(std::span<const LoadRequest> requests,
+                                                    std::vector<std::string>* out_errors,
+                                                    size_t max_threads) {
+  // Loading is mostly bound by page faults in the zip central directory and the resource table,
+  // so a few threads are enough to overlap them.
+  constexpr size_t kDefaultMaxThreads = 4;
+  if (max_threads == 0U) {
+    max_threads = std::clamp<size_t>(std::thread::hardware_concurrency(), 1U, kDefaultMaxThreads);
+  }
+
+  std::vector<sp<const ApkAssets>> results(requests.size());
+  std::atomic<size_t> next_request = 0;
+  auto worker = [&]() {
+    for (size_t i; (i = next_request.fetch_add(1, std::memory_order_relaxed)) < requests.size();) {
+      const LoadRequest& request = requests[i];
+      results[i] = request.is_overlay ? LoadOverlay(request.path, request.flags)
+                                      : Load(request.path, request.flags);
+    }
+  };
+
+  const size_t thread_count = std::min(max_threads, requests.size());
+  std::vector<std::thread> threads;
+  if (thread_count > 1) {
+    // The calling thread is one of the workers.
+    threads.reserve(thread_count - 1);
+    for (size_t i = 1; i < thread_count; i++) {
+      threads.emplace_back(worker);
+    }
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  if (out_errors != nullptr) {
+    out_errors->clear();
+    out_errors->reserve(requests.size());
+    for (size_t i = 0; i < requests.size(); i++) {
+      if (results[i] != nullptr) {
+        out_errors->emplace_back();
+      } else {
+        out_errors->push_back(std::string("Failed to load ") +
+                              (requests[i].is_overlay ? "overlay idmap '" : "APK '") +
+                              requests[i].path + "'");
+      }
+    }
+  }
+  return results;
+}
+
 ApkAssetsPtr ApkAssets::LoadImpl(std::unique_ptr<AssetsProvider> assets,
                                  package_property_t property_flags,
                                  std::unique_ptr<Asset> idmap_asset,
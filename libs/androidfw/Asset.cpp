@@ -19,6 +19,7 @@
 //
 
 #define LOG_TAG "asset"
+#define ATRACE_TAG ATRACE_TAG_RESOURCES
 //#define NDEBUG 0
 
 #include <androidfw/Asset.h>
@@ -29,6 +30,7 @@
 #include <cutils/atomic.h>
 #include <utils/FileMap.h>
 #include <utils/Log.h>
+#include <utils/Trace.h>
 #include <utils/threads.h>
 
 #include <assert.h>
@@ -40,6 +42,10 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#endif
+
 using namespace android;
 
 #ifndef O_BINARY
@@ -53,6 +59,95 @@ static int32_t gCount = 0;
 static Asset* gHead = NULL;
 static Asset* gTail = NULL;
 
+/*
+ * Assets smaller than this are not worth a system call to describe how they will be read.
+ */
+static const off64_t kAdviseMinSize = 64 * 1024;
+
+/*
+ * Tells the kernel how a mapped asset will be accessed, so that large sequential reads get
+ * read ahead instead of faulting in one page at a time, and random reads don't waste I/O on
+ * read-ahead.  The compressed data of an asset is always read from the start by the inflater.
+ */
+static void adviseMappedAsset(const incfs::IncFsFileMap& map, Asset::AccessMode mode,
+                              bool compressed)
+{
+#if !defined(_WIN32)
+    if (off64_t(map.length()) < kAdviseMinSize) {
+        return;
+    }
+
+    int advice;
+    switch (mode) {
+    case Asset::ACCESS_RANDOM:
+        advice = compressed ? MADV_SEQUENTIAL : MADV_RANDOM;
+        break;
+    case Asset::ACCESS_STREAMING:
+        advice = MADV_SEQUENTIAL;
+        break;
+    case Asset::ACCESS_BUFFER:
+        advice = MADV_WILLNEED;
+        break;
+    default:
+        return;
+    }
+
+    const uintptr_t pageSize = getpagesize();
+    const uintptr_t start = reinterpret_cast<uintptr_t>(map.unsafe_data());
+    const uintptr_t alignedStart = start & ~(pageSize - 1);
+    const size_t length = map.length() + (start - alignedStart);
+
+    ATRACE_NAME(advice == MADV_SEQUENTIAL ? "Asset madvise(SEQUENTIAL)"
+            : advice == MADV_RANDOM ? "Asset madvise(RANDOM)" : "Asset madvise(WILLNEED)");
+    if (madvise(reinterpret_cast<void*>(alignedStart), length, advice) != 0) {
+        ALOGV("madvise(%d) of asset map failed: %s", advice, strerror(errno));
+    }
+#else
+    (void) map;
+    (void) mode;
+    (void) compressed;
+#endif
+}
+
+/*
+ * The same, for an asset read from a file descriptor.
+ */
+static void adviseFileAsset(int fd, off64_t offset, off64_t length, Asset::AccessMode mode)
+{
+#if defined(__linux__)
+    if (length < kAdviseMinSize) {
+        return;
+    }
+
+    int advice;
+    switch (mode) {
+    case Asset::ACCESS_RANDOM:
+        advice = POSIX_FADV_RANDOM;
+        break;
+    case Asset::ACCESS_STREAMING:
+        advice = POSIX_FADV_SEQUENTIAL;
+        break;
+    case Asset::ACCESS_BUFFER:
+        advice = POSIX_FADV_WILLNEED;
+        break;
+    default:
+        return;
+    }
+
+    ATRACE_NAME("Asset posix_fadvise");
+    // posix_fadvise returns the error instead of setting errno.
+    const int err = posix_fadvise(fd, offset, length, advice);
+    if (err != 0) {
+        ALOGV("posix_fadvise(%d) of asset failed: %s", advice, strerror(err));
+    }
+#else
+    (void) fd;
+    (void) offset;
+    (void) length;
+    (void) mode;
+#endif
+}
+
 void Asset::registerAsset(Asset* asset)
 {
     AutoMutex _l(gAssetLock);
@@ -187,6 +282,7 @@ Asset::Asset(void)
     }
 
     pAsset->mAccessMode = mode;
+    adviseFileAsset(fd, 0, length, mode);
     return pAsset;
 }
 
@@ -304,6 +400,7 @@ Asset::Asset(void)
 {
     auto pAsset = util::make_unique<_FileAsset>();
 
+    adviseMappedAsset(dataMap, mode, false /* compressed */);
     status_t result = pAsset->openChunk(std::move(dataMap), std::move(fd));
     if (result != NO_ERROR) {
         return NULL;
@@ -322,6 +419,7 @@ Asset::Asset(void)
 {
   auto pAsset = util::make_unique<_CompressedAsset>();
 
+  adviseMappedAsset(dataMap, mode, true /* compressed */);
   status_t result = pAsset->openChunk(std::move(dataMap), uncompressedLen);
   if (result != NO_ERROR) {
       return NULL;
@@ -655,6 +753,7 @@ incfs::map_ptr<void> _FileAsset::getIncFsBuffer(bool aligned)
         ALOGV(" getBuffer: mapped\n");
 
         mMap = std::move(map);
+        adviseMappedAsset(*mMap, getAccessMode(), false /* compressed */);
         if (!aligned) {
             return mMap->data();
         }
@@ -857,7 +956,7 @@ ssize_t _CompressedAsset::read(void* buf, size_t count)
  *
  * If we're working in a streaming mode, this is going to be fairly
  * expensive, because it requires plowing through a bunch of compressed
- * data.
+ * data from the closest inflate checkpoint.
  */
 off64_t _CompressedAsset::seek(off64_t offset, int whence)
 {
@@ -23,13 +23,17 @@
 #include <map>
 #include <set>
 #include <span>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "android-base/logging.h"
 #include "android-base/stringprintf.h"
 #include "androidfw/CombinedIterator.h"
+#include "androidfw/ResourceTimer.h"
 #include "androidfw/ResourceTypes.h"
 #include "androidfw/ResourceUtils.h"
+#include "androidfw/SharedBagCache.h"
 #include "androidfw/Util.h"
 #include "utils/ByteOrder.h"
 #include "utils/Trace.h"
@@ -91,6 +95,11 @@ struct FindEntryResult {
   // The string pool reference to the entry's name. This uses a different string pool than
   // the global string pool, but this is hidden from the caller.
   StringPoolRef entry_string_ref;
+
+  // The location of the entry within its package group, as recorded by a ResolvedEntryIndex.
+  uint16_t package_index;
+  uint16_t type_entry_index;
+  uint32_t entry_offset;
 };
 
 struct Theme::Entry {
@@ -99,6 +108,22 @@ struct Theme::Entry {
   Res_value value;
 };
 
+// Each chunk holds the attributes whose resource IDs only differ in the bits outside of this mask.
+// Theme attributes of a package are allocated consecutively, so a style that overrides a few
+// attributes of a large theme only touches a few chunks.
+constexpr uint32_t kThemeChunkMask = ~0x3fu;
+
+struct Theme::Chunk {
+  // The resource ID of the first attribute that could be stored in this chunk.
+  uint32_t base;
+
+  // Two parallel arrays of attribute resource IDs and their values, sorted by resource ID.
+  std::vector<uint32_t> keys;
+  std::vector<Entry> entries;
+};
+
+constexpr auto ChunkBaseLess = [](const auto& chunk, uint32_t base) { return chunk->base < base; };
+
 AssetManager2::AssetManager2(ApkAssetsList apk_assets, const ResTable_config& configuration) {
   configurations_.push_back(configuration);
 
@@ -131,11 +156,18 @@ bool AssetManager2::SetApkAssets(std::initializer_list<ApkAssetsPtr> apk_assets,
 void AssetManager2::BuildDynamicRefTable(ApkAssetsList apk_assets) {
   auto op = StartOperation();
 
+  // The index refers to packages by their position in the package groups rebuilt below.
+  resolved_entry_index_.reset();
+
   apk_assets_.resize(apk_assets.size());
+  shared_bag_assets_key_.clear();
   for (size_t i = 0; i != apk_assets.size(); ++i) {
     apk_assets_[i].first = apk_assets[i];
     // Let's populate the locked assets right away as we're going to need them here later.
     apk_assets_[i].second = apk_assets[i];
+
+    const uint64_t id = apk_assets[i] ? apk_assets[i]->GetUniqueId() : 0U;
+    shared_bag_assets_key_.append(reinterpret_cast<const char*>(&id), sizeof(id));
   }
 
   package_groups_.clear();
@@ -270,6 +302,17 @@ void AssetManager2::BuildDynamicRefTable(ApkAssetsList apk_assets) {
     }
     package_groups_.back().dynamic_ref_table->setAliases(std::move(aliases));
   }
+
+  UpdateSharedBagContext();
+}
+
+void AssetManager2::UpdateSharedBagContext() {
+  std::string key = shared_bag_assets_key_;
+  for (const ResTable_config& config : configurations_) {
+    key.append(reinterpret_cast<const char*>(&config), sizeof(config));
+  }
+  key.append(reinterpret_cast<const char*>(&default_locale_), sizeof(default_locale_));
+  shared_bag_context_ = SharedBagCache::Get().GetContext(std::move(key));
 }
 
 void AssetManager2::DumpToLog() const {
@@ -457,11 +500,99 @@ void AssetManager2::SetConfigurations(std::span<const ResTable_config> configura
     configurations_.emplace_back(config);
   }
   if (diff) {
-    RebuildFilterList();
+    resolved_entry_index_.reset();
+    UpdateSharedBagContext();
+    RebuildFilterList(static_cast<uint32_t>(diff));
     InvalidateCaches(static_cast<uint32_t>(diff));
   }
 }
 
+uint64_t AssetManager2::GetResolvedEntryIndexKey() const {
+  // FNV-1a, which is stable across processes and builds unlike std::hash.
+  uint64_t key = 0xcbf29ce484222325ULL;
+  auto hash = [&key](const void* data, size_t size) {
+    for (auto p = static_cast<const uint8_t*>(data), end = p + size; p != end; ++p) {
+      key = (key ^ *p) * 0x100000001b3ULL;
+    }
+  };
+
+  auto op = StartOperation();
+  for (size_t i = 0, s = apk_assets_.size(); i != s; ++i) {
+    const auto& assets = GetApkAssets(i);
+    if (!assets) {
+      continue;
+    }
+    const std::string& name = assets->GetDebugName();
+    hash(name.data(), name.size());
+    const uint8_t kind = (assets->IsOverlay() ? 1U : 0U) | (assets->IsLoader() ? 2U : 0U);
+    hash(&kind, sizeof(kind));
+
+    // Catches most in-place updates of an APK that keep its path.
+    if (const ResStringPool* pool = assets->GetLoadedArsc()->GetStringPool()) {
+      const uint64_t pool_shape[] = {pool->size(), pool->bytes()};
+      hash(pool_shape, sizeof(pool_shape));
+    }
+  }
+
+  for (const ResTable_config& config : configurations_) {
+    hash(&config, sizeof(config));
+  }
+  return key;
+}
+
+std::unique_ptr<const ResolvedEntryIndex> AssetManager2::BuildResolvedEntryIndex() const {
+  ATRACE_NAME("AssetManager::BuildResolvedEntryIndex");
+  if (configurations_.size() != 1) {
+    // FindEntry merges the results of every configuration, which the index can't describe.
+    return {};
+  }
+
+  std::vector<ResolvedEntryIndex::Entry> entries;
+  for (const PackageGroup& package_group : package_groups_) {
+    const uint8_t package_id = package_group.dynamic_ref_table->mAssignedPackageId;
+
+    // Packages of the same group may define a different number of entries for a type.
+    std::map<uint8_t, uint32_t> entry_counts;
+    for (const ConfiguredPackage& package : package_group.packages_) {
+      package.loaded_package_->ForEachTypeSpec([&](const TypeSpec& type_spec, uint8_t type_id) {
+        auto& count = entry_counts[type_id - 1];
+        count = std::max(count, dtohl(type_spec.type_spec->entryCount));
+      });
+    }
+
+    for (const auto& [type_idx, entry_count] : entry_counts) {
+      for (uint32_t entry_idx = 0; entry_idx < entry_count; entry_idx++) {
+        auto result = FindEntryInternal(package_group, type_idx, entry_idx, configurations_[0],
+                                        false /* stop_at_first_match */,
+                                        false /* ignore_configuration */);
+        if (UNLIKELY(IsIOError(result))) {
+          return {};
+        }
+        if (!result.has_value()) {
+          continue;
+        }
+        entries.push_back(ResolvedEntryIndex::Entry{
+            .resid = make_resid(package_id, type_idx + 1, static_cast<uint16_t>(entry_idx)),
+            .type_flags = result->type_flags,
+            .entry_offset = result->entry_offset,
+            .package_index = result->package_index,
+            .type_entry_index = result->type_entry_index,
+        });
+      }
+    }
+  }
+  return ResolvedEntryIndex::Create(GetResolvedEntryIndexKey(), std::move(entries));
+}
+
+bool AssetManager2::SetResolvedEntryIndex(std::shared_ptr<const ResolvedEntryIndex> index) {
+  if (index != nullptr && index->GetKey() != GetResolvedEntryIndexKey()) {
+    resolved_entry_index_.reset();
+    return false;
+  }
+  resolved_entry_index_ = std::move(index);
+  return true;
+}
+
 std::set<AssetManager2::ApkAssetsPtr> AssetManager2::GetNonSystemOverlays() const {
   std::set<ApkAssetsPtr> non_system_overlays;
   for (const PackageGroup& package_group : package_groups_) {
@@ -570,7 +701,16 @@ std::unique_ptr<AssetDir> AssetManager2::OpenDir(const std::string& dirname) con
   auto op = StartOperation();
 
   std::string full_path = "assets/" + dirname;
-  auto files = util::make_unique<SortedVector<AssetDir::FileInfo>>();
+
+  // Collect the listings of all APKs into one flat vector and sort it once, instead of inserting
+  // every file into the middle of a SortedVector.
+  struct Entry {
+    std::string name;
+    FileType type;
+    size_t source;
+  };
+  std::vector<Entry> entries;
+  std::vector<String8> source_names;
 
   // Start from the back.
   for (size_t i = apk_assets_.size(); i > 0; --i) {
@@ -579,12 +719,10 @@ std::unique_ptr<AssetDir> AssetManager2::OpenDir(const std::string& dirname) con
       continue;
     }
 
+    const size_t source = source_names.size();
+    source_names.emplace_back(apk_assets->GetDebugName().c_str());
     auto func = [&](StringPiece name, FileType type) {
-      AssetDir::FileInfo info;
-      info.setFileName(String8(name.data(), name.size()));
-      info.setFileType(type);
-      info.setSourceName(String8(apk_assets->GetDebugName().c_str()));
-      files->add(info);
+      entries.push_back({std::string(name), type, source});
     };
 
     if (!apk_assets->GetAssetsProvider()->ForEachFile(full_path, func)) {
@@ -592,6 +730,26 @@ std::unique_ptr<AssetDir> AssetManager2::OpenDir(const std::string& dirname) con
     }
   }
 
+  // The stable sort keeps the visiting order among equal names, and the last one visited wins,
+  // the same as it would have when replacing the previous entry on insertion.
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const Entry& a, const Entry& b) { return a.name < b.name; });
+
+  auto files = util::make_unique<SortedVector<AssetDir::FileInfo>>();
+  files->setCapacity(entries.size());
+  for (auto iter = entries.begin(); iter != entries.end(); ++iter) {
+    auto next = std::next(iter);
+    if (next != entries.end() && next->name == iter->name) {
+      continue;
+    }
+    // Entries arrive in order, so every add appends to the end of the vector.
+    AssetDir::FileInfo info;
+    info.setFileName(String8(iter->name.data(), iter->name.size()));
+    info.setFileType(iter->type);
+    info.setSourceName(source_names[iter->source]);
+    files->add(info);
+  }
+
   std::unique_ptr<AssetDir> asset_dir = util::make_unique<AssetDir>();
   asset_dir->setFileList(files.release());
   return asset_dir;
@@ -829,10 +987,10 @@ base::expected<FindEntryResult, NullOrIOError> AssetManager2::FindEntryInternal(
     const ResTable_config& desired_config, bool stop_at_first_match,
     bool ignore_configuration) const {
   const bool logging_enabled = resource_resolution_logging_enabled_;
-  ApkAssetsCookie best_cookie = kInvalidCookie;
-  const LoadedPackage* best_package = nullptr;
-  incfs::verified_map_ptr<ResTable_type> best_type;
+  const TypeSpec::TypeEntry* best_type_entry = nullptr;
   const ResTable_config* best_config = nullptr;
+  size_t best_package_index = 0U;
+  size_t best_type_entry_index = 0U;
   uint32_t best_offset = 0U;
   uint32_t type_flags = 0U;
 
@@ -844,6 +1002,35 @@ base::expected<FindEntryResult, NullOrIOError> AssetManager2::FindEntryInternal(
       [&desired_config](auto& value) { return &desired_config == &value; })
       != configurations_.end();
   const size_t package_count = package_group.packages_.size();
+  const bool needs_match = !ignore_configuration && !(use_filtered && configurations_.size() == 1);
+  const PackedConfig packed_desired_config =
+      needs_match ? PackedConfig::FromSettings(desired_config) : PackedConfig{};
+
+  // A precomputed index already knows the winner of the scan below for the set configuration.
+  if (resolved_entry_index_ != nullptr && use_filtered && !stop_at_first_match &&
+      !logging_enabled) {
+    const uint32_t resid = make_resid(package_group.dynamic_ref_table->mAssignedPackageId,
+                                      type_idx + 1, entry_idx);
+    const ResolvedEntryIndex::Entry* indexed = resolved_entry_index_->Find(resid);
+    if (indexed != nullptr && indexed->package_index < package_count) {
+      const ConfiguredPackage& package = package_group.packages_[indexed->package_index];
+      const TypeSpec* type_spec = package.loaded_package_->GetTypeSpecByTypeIndex(type_idx);
+      if (type_spec != nullptr && indexed->type_entry_index < type_spec->type_entries.size()) {
+        const TypeSpec::TypeEntry& type_entry = type_spec->type_entries[indexed->type_entry_index];
+        auto result = MakeFindEntryResult(package_group, indexed->package_index, type_entry,
+                                          indexed->type_entry_index, indexed->entry_offset);
+        if (result.has_value()) {
+          result->type_flags = indexed->type_flags;
+          return result;
+        }
+        if (UNLIKELY(IsIOError(result))) {
+          return result;
+        }
+        // The index does not match the loaded table, so fall back to scanning.
+      }
+    }
+  }
+
   for (size_t pi = 0; pi < package_count; pi++) {
     const ConfiguredPackage& loaded_package_impl = package_group.packages_[pi];
     const LoadedPackage* loaded_package = loaded_package_impl.loaded_package_;
@@ -879,8 +1066,7 @@ base::expected<FindEntryResult, NullOrIOError> AssetManager2::FindEntryInternal(
       // because the filtered list will then have values from multiple locales and we will need to
       // call match() to make sure the current entry matches the config we are currently checking.
       const ResTable_config& this_config = type_entry->config;
-      if (!((use_filtered && (configurations_.size() == 1))
-          || ignore_configuration || this_config.match(desired_config))) {
+      if (needs_match && !type_entry->Matches(desired_config, packed_desired_config)) {
         continue;
       }
 
@@ -901,8 +1087,7 @@ base::expected<FindEntryResult, NullOrIOError> AssetManager2::FindEntryInternal(
 
       // The configuration matches and is better than the previous selection.
       // Find the entry value if it exists for this configuration.
-      const auto& type = type_entry->type;
-      const auto offset = LoadedPackage::GetEntryOffset(type, entry_idx);
+      const auto offset = LoadedPackage::GetEntryOffset(*type_entry, entry_idx);
       if (UNLIKELY(IsIOError(offset))) {
         return base::unexpected(offset.error());
       }
@@ -915,10 +1100,10 @@ base::expected<FindEntryResult, NullOrIOError> AssetManager2::FindEntryInternal(
         continue;
       }
 
-      best_cookie = cookie;
-      best_package = loaded_package;
-      best_type = type;
+      best_type_entry = type_entry;
       best_config = &this_config;
+      best_package_index = pi;
+      best_type_entry_index = type_entry - type_spec->type_entries.data();
       best_offset = offset.value();
 
       if (UNLIKELY(logging_enabled)) {
@@ -933,30 +1118,45 @@ base::expected<FindEntryResult, NullOrIOError> AssetManager2::FindEntryInternal(
     }
   }
 
-  if (UNLIKELY(best_cookie == kInvalidCookie)) {
+  if (UNLIKELY(best_type_entry == nullptr)) {
     return base::unexpected(std::nullopt);
   }
 
-  auto best_entry_verified = LoadedPackage::GetEntryFromOffset(best_type, best_offset);
-  if (!best_entry_verified.has_value()) {
-    return base::unexpected(best_entry_verified.error());
+  auto result = MakeFindEntryResult(package_group, best_package_index, *best_type_entry,
+                                    best_type_entry_index, best_offset);
+  if (result.has_value()) {
+    result->type_flags = type_flags;
+  }
+  return result;
+}
+
+base::expected<FindEntryResult, NullOrIOError> AssetManager2::MakeFindEntryResult(
+    const PackageGroup& package_group, size_t package_index,
+    const TypeSpec::TypeEntry& type_entry, size_t type_entry_index, uint32_t entry_offset) {
+  const LoadedPackage* package = package_group.packages_[package_index].loaded_package_;
+  const auto& type = type_entry.type;
+  auto entry_verified = LoadedPackage::GetEntryFromOffset(type, entry_offset);
+  if (!entry_verified.has_value()) {
+    return base::unexpected(entry_verified.error());
   }
 
-  const auto entry = GetEntryValue(*best_entry_verified);
+  const auto entry = GetEntryValue(*entry_verified);
   if (!entry.has_value()) {
     return base::unexpected(entry.error());
   }
 
   return FindEntryResult{
-    .cookie = best_cookie,
+    .cookie = package_group.cookies_[package_index],
     .entry = *entry,
-    .config = *best_config,
-    .type_flags = type_flags,
+    .config = type_entry.config,
+    .type_flags = 0U,
     .dynamic_ref_table = package_group.dynamic_ref_table.get(),
-    .package_name = &best_package->GetPackageName(),
-    .type_string_ref = StringPoolRef(best_package->GetTypeStringPool(), best_type->id - 1),
-    .entry_string_ref = StringPoolRef(best_package->GetKeyStringPool(),
-                                      (*best_entry_verified)->key()),
+    .package_name = &package->GetPackageName(),
+    .type_string_ref = StringPoolRef(package->GetTypeStringPool(), type->id - 1),
+    .entry_string_ref = StringPoolRef(package->GetKeyStringPool(), (*entry_verified)->key()),
+    .package_index = static_cast<uint16_t>(package_index),
+    .type_entry_index = static_cast<uint16_t>(type_entry_index),
+    .entry_offset = entry_offset,
   };
 }
 
@@ -1128,9 +1328,8 @@ base::expected<std::monostate, NullOrIOError> AssetManager2::ResolveReference(
   const uint32_t original_flags = value.flags;
   const uint32_t original_resid = value.data;
   if (cache_value) {
-    auto cached_value = cached_resolved_values_.find(value.data);
-    if (cached_value != cached_resolved_values_.end()) {
-      value = cached_value->second;
+    if (auto cached_value = cached_resolved_values_.find(value.data)) {
+      value = *cached_value;
       value.flags |= original_flags;
       return {};
     }
@@ -1199,6 +1398,7 @@ base::expected<const ResolvedBag*, NullOrIOError> AssetManager2::ResolveBag(
 }
 
 base::expected<const ResolvedBag*, NullOrIOError> AssetManager2::GetBag(uint32_t resid) const {
+  ResourceTimer _timer(ResourceTimer::Counter::GetBag);
   auto resid_stacks_it = cached_bag_resid_stacks_.find(resid);
   if (resid_stacks_it == cached_bag_resid_stacks_.end()) {
     resid_stacks_it = cached_bag_resid_stacks_.emplace(resid, std::vector<uint32_t>{}).first;
@@ -1213,8 +1413,19 @@ base::expected<const ResolvedBag*, NullOrIOError> AssetManager2::GetBag(uint32_t
 
 base::expected<const ResolvedBag*, NullOrIOError> AssetManager2::GetBag(
     uint32_t resid, std::vector<uint32_t>& child_resids) const {
-  if (auto cached_iter = cached_bags_.find(resid); cached_iter != cached_bags_.end()) {
-    return cached_iter->second.get();
+  if (auto cached_bag = cached_bags_.find(resid)) {
+    return *cached_bag;
+  }
+
+  const size_t stack_start = child_resids.size();
+  if (shared_bag_context_ != 0U) {
+    // Another AssetManager with the same inputs may have already resolved this bag.
+    if (auto shared = SharedBagCache::Get().Find(shared_bag_context_, resid)) {
+      child_resids.insert(child_resids.end(), shared->resid_stack.begin(),
+                          shared->resid_stack.end());
+      cached_bags_[resid] = shared->bag.get();
+      return shared->bag.get();
+    }
   }
 
   auto entry = FindEntry(resid, 0u /* density_override */, false /* stop_at_first_match */,
@@ -1289,9 +1500,7 @@ base::expected<const ResolvedBag*, NullOrIOError> AssetManager2::GetBag(
 
     new_bag->type_spec_flags = entry->type_flags;
     new_bag->entry_count = static_cast<uint32_t>(entry_count);
-    ResolvedBag* result = new_bag.get();
-    cached_bags_[resid] = std::move(new_bag);
-    return result;
+    return CacheBag(resid, std::move(new_bag), child_resids, stack_start);
   }
 
   // In case the parent is a dynamic reference, resolve it.
@@ -1419,8 +1628,23 @@ base::expected<const ResolvedBag*, NullOrIOError> AssetManager2::GetBag(
   // Combine flags from the parent and our own bag.
   new_bag->type_spec_flags = entry->type_flags | (*parent_bag)->type_spec_flags;
   new_bag->entry_count = static_cast<uint32_t>(actual_count);
-  ResolvedBag* result = new_bag.get();
-  cached_bags_[resid] = std::move(new_bag);
+  return CacheBag(resid, std::move(new_bag), child_resids, stack_start);
+}
+
+const ResolvedBag* AssetManager2::CacheBag(uint32_t resid, util::unique_cptr<ResolvedBag> bag,
+                                           const std::vector<uint32_t>& child_resids,
+                                           size_t stack_start) const {
+  if (shared_bag_context_ != 0U) {
+    const auto resid_stack = std::span(child_resids).subspan(stack_start);
+    if (auto shared = SharedBagCache::Get().Insert(shared_bag_context_, resid, bag, resid_stack)) {
+      cached_bags_[resid] = shared->bag.get();
+      return shared->bag.get();
+    }
+  }
+
+  const ResolvedBag* result = bag.get();
+  cached_bags_[resid] = result;
+  owned_bags_[resid] = std::move(bag);
   return result;
 }
 
@@ -1497,16 +1721,31 @@ base::expected<uint32_t, NullOrIOError> AssetManager2::GetResourceId(
   return base::unexpected(std::nullopt);
 }
 
-void AssetManager2::RebuildFilterList() {
+void AssetManager2::RebuildFilterList(uint32_t diff) {
+  ATRACE_NAME("AssetManager::RebuildFilterList");
+  std::vector<PackedConfig> packed_configurations;
+  packed_configurations.reserve(configurations_.size());
+  for (const auto& config : configurations_) {
+    packed_configurations.push_back(PackedConfig::FromSettings(config));
+  }
   for (PackageGroup& group : package_groups_) {
     for (ConfiguredPackage& package : group.packages_) {
-      package.filtered_configs_.forEachItem([](auto, auto& fcg) { fcg.type_entries.clear(); });
       // Create the filters here.
       package.loaded_package_->ForEachTypeSpec([&](const TypeSpec& type_spec, uint8_t type_id) {
+        if ((type_spec.config_axes & diff) == 0) {
+          // Every configuration of this type is the default along the changed axes, so the ones
+          // that matched the previous configuration still match, and only those.
+          return;
+        }
+
         FilteredConfigGroup* group = nullptr;
+        if (!package.filtered_configs_[type_id - 1].type_entries.empty()) {
+          group = &package.filtered_configs_.editItemAt(type_id - 1);
+          group->type_entries.clear();
+        }
         for (const auto& type_entry : type_spec.type_entries) {
-          for (auto & config : configurations_) {
-            if (type_entry.config.match(config)) {
+          for (size_t i = 0; i < configurations_.size(); i++) {
+            if (type_entry.Matches(configurations_[i], packed_configurations[i])) {
               if (!group) {
                 group = &package.filtered_configs_.editItemAt(type_id - 1);
               }
@@ -1528,6 +1767,7 @@ void AssetManager2::InvalidateCaches(uint32_t diff) {
   if (diff == 0xffffffffu) {
     // Everything must go.
     cached_bags_.clear();
+    owned_bags_.clear();
     cached_bag_resid_stacks_.clear();
     return;
   }
@@ -1536,11 +1776,8 @@ void AssetManager2::InvalidateCaches(uint32_t diff) {
   // variations with respect to what changed (diff) should we remove it.
   for (auto stack_it = cached_bag_resid_stacks_.begin();
        stack_it != cached_bag_resid_stacks_.end();) {
-    const auto it = cached_bags_.find(stack_it->first);
-    if (it == cached_bags_.end()) {
-      stack_it = cached_bag_resid_stacks_.erase(stack_it);
-    } else if ((diff & it->second->type_spec_flags) != 0) {
-      cached_bags_.erase(it);
+    const auto bag = cached_bags_.find(stack_it->first);
+    if (bag == nullptr || (diff & (*bag)->type_spec_flags) != 0) {
       stack_it = cached_bag_resid_stacks_.erase(stack_it);
     } else {
       ++stack_it;  // Keep the item in both caches.
@@ -1548,15 +1785,14 @@ void AssetManager2::InvalidateCaches(uint32_t diff) {
   }
 
   // Need to ensure that both bag caches are consistent, as we populate them in the same function.
-  // Iterate over the cached bags to erase the items without the corresponding resid_stack cache
-  // items.
-  for (auto it = cached_bags_.begin(); it != cached_bags_.end();) {
-    if ((diff & it->second->type_spec_flags) != 0) {
-      it = cached_bags_.erase(it);
-    } else {
-      ++it;
-    }
-  }
+  // Erase the cached bags that vary with `diff`, whether or not they had a resid stack.
+  cached_bags_.eraseIf([&](uint32_t resid, const ResolvedBag* bag) {
+    if ((diff & bag->type_spec_flags) == 0) {
+      return false;
+    }
+    owned_bags_.erase(resid);
+    return true;
+  });
 }
 
 uint8_t AssetManager2::GetAssignedPackageId(const LoadedPackage* package) const {
@@ -1571,11 +1807,7 @@ uint8_t AssetManager2::GetAssignedPackageId(const LoadedPackage* package) const
 }
 
 std::unique_ptr<Theme> AssetManager2::NewTheme() {
-  constexpr size_t kInitialReserveSize = 32;
-  auto theme = std::unique_ptr<Theme>(new Theme(this));
-  theme->keys_.reserve(kInitialReserveSize);
-  theme->entries_.reserve(kInitialReserveSize);
-  return theme;
+  return std::unique_ptr<Theme>(new Theme(this));
 }
 
 void AssetManager2::ForEachPackage(base::function_ref<bool(const std::string&, uint8_t)> func,
@@ -1634,6 +1866,7 @@ static bool IsUndefined(const Res_value& value) {
 
 base::expected<std::monostate, NullOrIOError> Theme::ApplyStyle(uint32_t resid, bool force) {
   ATRACE_NAME("Theme::ApplyStyle");
+  ResourceTimer _timer(ResourceTimer::Counter::ThemeApplyStyle);
 
   auto bag = asset_manager_->GetBag(resid);
   if (!bag.has_value()) {
@@ -1646,8 +1879,10 @@ base::expected<std::monostate, NullOrIOError> Theme::ApplyStyle(uint32_t resid,
   //
   // This function is the most expensive part of applying an frro to the existing app resources,
   // and needs to be as efficient as possible.
-  // The data structure we're working with is two parallel sorted arrays of keys (resource IDs)
-  // and entries (resource value + some attributes).
+  // The data structure we're working with is a sorted list of chunks, each holding two parallel
+  // sorted arrays of keys (resource IDs) and entries (resource value + some attributes). Chunks are
+  // shared with the themes copied from this one, so a chunk is only copied once it is going to be
+  // modified.
   // The styles get applied in sequence, starting with an empty set of attributes. Each style
   // contains its values for the theme attributes, and gets applied in either normal or forced way:
   //  - normal way never overrides the existing attribute, so only unique style attributes are added
@@ -1655,7 +1890,8 @@ base::expected<std::monostate, NullOrIOError> Theme::ApplyStyle(uint32_t resid,
   //    previous value completely
   //
   // Style attributes come in a Bag data type - a sorted array of attributes with their values. This
-  // means we don't need to re-sort the attributes ever, and instead:
+  // means we don't need to re-sort the attributes ever, and instead split the bag into runs that
+  // belong to the same chunk, and for each of them:
   //  - for an already existing attribute just skip it or apply the forced value
   //    - if the forced value is undefined, mark it undefined as well to get rid of it later
   //  - for a new attribute append it to the array, forming a new sorted section of new attributes
@@ -1666,63 +1902,167 @@ base::expected<std::monostate, NullOrIOError> Theme::ApplyStyle(uint32_t resid,
   // Using this algorithm performs better than a repeated binary search + insert in the middle,
   // as that keeps shifting the tail end of the arrays and wasting CPU cycles in memcpy().
   //
-  const auto starting_size = keys_.size();
-  if (starting_size == 0) {
-    keys_.reserve((*bag)->entry_count);
-    entries_.reserve((*bag)->entry_count);
-  }
-  bool wrote_undefined = false;
-  for (auto it = begin(*bag); it != end(*bag); ++it) {
-    const uint32_t attr_res_id = it->key;
+  const auto bag_begin = begin(*bag);
+  const auto bag_end = end(*bag);
+  for (auto it = bag_begin; it != bag_end; ++it) {
     // If the resource ID passed in is not a style, the key can be some other identifier that is not
     // a resource ID. We should fail fast instead of operating with strange resource IDs.
-    if (!is_valid_resid(attr_res_id)) {
+    if (!is_valid_resid(it->key)) {
       return base::unexpected(std::nullopt);
     }
+  }
+
+  for (auto run_begin = bag_begin; run_begin != bag_end;) {
+    const uint32_t chunk_base = run_begin->key & kThemeChunkMask;
+    const auto run_end = std::find_if(run_begin + 1, bag_end, [chunk_base](const auto& entry) {
+      return (entry.key & kThemeChunkMask) != chunk_base;
+    });
+    if (!ApplyStyleChunk(chunk_base, run_begin, run_end, (*bag)->type_spec_flags, force)) {
+      ALOGW("Bag %u was unsorted in the apk?", unsigned(resid));
+      return base::unexpected(std::nullopt);
+    }
+    run_begin = run_end;
+  }
+  return {};
+}
+
+bool Theme::ApplyStyleChunk(uint32_t chunk_base, const ResolvedBag::Entry* run_begin,
+                            const ResolvedBag::Entry* run_end, uint32_t type_spec_flags,
+                            bool force) {
+  // Keep reading a shared chunk until the first modification.
+  const Chunk* chunk = nullptr;
+  size_t index = 0U;
+  if (chunks_ != nullptr) {
+    const auto chunk_it =
+        std::lower_bound(chunks_->begin(), chunks_->end(), chunk_base, ChunkBaseLess);
+    index = chunk_it - chunks_->begin();
+    if (chunk_it != chunks_->end() && (*chunk_it)->base == chunk_base) {
+      chunk = chunk_it->get();
+    }
+  }
+
+  if (chunk == nullptr) {
+    // None of these attributes are defined yet, so there is nothing for undefined values to remove.
+    auto new_chunk = std::make_shared<Chunk>(Chunk{.base = chunk_base});
+    for (auto it = run_begin; it != run_end; ++it) {
+      if (!IsUndefined(it->value)) {
+        new_chunk->keys.emplace_back(it->key);
+        new_chunk->entries.emplace_back(it->cookie, type_spec_flags, it->value);
+      }
+    }
+    if (new_chunk->keys.empty()) {
+      return true;
+    }
+    const bool sorted = !android::base::kEnableDChecks ||
+                        std::is_sorted(new_chunk->keys.begin(), new_chunk->keys.end());
+    auto& chunks = MutableChunks();
+    chunks.insert(chunks.begin() + index, std::move(new_chunk));
+    return sorted;
+  }
+
+  Chunk* mutable_chunk = nullptr;
+  auto mutate = [&]() -> Chunk& {
+    if (mutable_chunk == nullptr) {
+      chunk = mutable_chunk = &MutableChunk(index);
+    }
+    return *mutable_chunk;
+  };
+
+  const auto starting_size = chunk->keys.size();
+  bool wrote_undefined = false;
+  for (auto it = run_begin; it != run_end; ++it) {
+    const uint32_t attr_res_id = it->key;
     const bool is_undefined = IsUndefined(it->value);
     if (!force && is_undefined) {
       continue;
     }
-    const auto key_it = std::lower_bound(keys_.begin(), keys_.begin() + starting_size, attr_res_id);
-    if (key_it != keys_.begin() + starting_size && *key_it == attr_res_id) {
-      const auto entry_it = entries_.begin() + (key_it - keys_.begin());
-      if (force || IsUndefined(entry_it->value)) {
-        *entry_it = Entry{it->cookie, (*bag)->type_spec_flags, it->value};
-        wrote_undefined |= is_undefined;
+    const auto keys_begin = chunk->keys.begin();
+    const auto key_it = std::lower_bound(keys_begin, keys_begin + starting_size, attr_res_id);
+    if (key_it != keys_begin + starting_size && *key_it == attr_res_id) {
+      const size_t pos = key_it - keys_begin;
+      const Entry& entry = chunk->entries[pos];
+      if (!force && !IsUndefined(entry.value)) {
+        continue;
+      }
+      if (entry.cookie == it->cookie && entry.type_spec_flags == type_spec_flags &&
+          entry.value.dataType == it->value.dataType && entry.value.data == it->value.data) {
+        // Nothing changes, so don't copy a shared chunk.
+        continue;
       }
+      mutate().entries[pos] = Entry{it->cookie, type_spec_flags, it->value};
+      wrote_undefined |= is_undefined;
     } else if (!is_undefined) {
-      keys_.emplace_back(attr_res_id);
-      entries_.emplace_back(it->cookie, (*bag)->type_spec_flags, it->value);
+      auto& dest = mutate();
+      dest.keys.emplace_back(attr_res_id);
+      dest.entries.emplace_back(it->cookie, type_spec_flags, it->value);
     }
   }
 
-  if (starting_size && keys_.size() != starting_size) {
+  if (mutable_chunk == nullptr) {
+    return true;
+  }
+  auto& keys = mutable_chunk->keys;
+  auto& entries = mutable_chunk->entries;
+  if (starting_size && keys.size() != starting_size) {
     std::inplace_merge(
-        CombinedIterator(keys_.begin(), entries_.begin()),
-        CombinedIterator(keys_.begin() + starting_size, entries_.begin() + starting_size),
-        CombinedIterator(keys_.end(), entries_.end()));
+        CombinedIterator(keys.begin(), entries.begin()),
+        CombinedIterator(keys.begin() + starting_size, entries.begin() + starting_size),
+        CombinedIterator(keys.end(), entries.end()));
   }
   if (wrote_undefined) {
-    auto new_end = std::remove_if(CombinedIterator(keys_.begin(), entries_.begin()),
-                                  CombinedIterator(keys_.end(), entries_.end()),
+    auto new_end = std::remove_if(CombinedIterator(keys.begin(), entries.begin()),
+                                  CombinedIterator(keys.end(), entries.end()),
                                   [](const auto& pair) { return IsUndefined(pair.second.value); });
-    keys_.erase(new_end.it1, keys_.end());
-    entries_.erase(new_end.it2, entries_.end());
+    keys.erase(new_end.it1, keys.end());
+    entries.erase(new_end.it2, entries.end());
   }
-  if (android::base::kEnableDChecks && !std::is_sorted(keys_.begin(), keys_.end())) {
-    ALOGW("Bag %u was unsorted in the apk?", unsigned(resid));
-    return base::unexpected(std::nullopt);
+  const bool sorted = !android::base::kEnableDChecks || std::is_sorted(keys.begin(), keys.end());
+  if (keys.empty()) {
+    auto& chunks = MutableChunks();
+    chunks.erase(chunks.begin() + index);
   }
-  return {};
+  return sorted;
+}
+
+Theme::ChunkList& Theme::MutableChunks() {
+  if (chunks_ == nullptr) {
+    chunks_ = std::make_shared<ChunkList>();
+  } else if (chunks_.use_count() != 1) {
+    chunks_ = std::make_shared<ChunkList>(*chunks_);
+  }
+  return *chunks_;
+}
+
+Theme::Chunk& Theme::MutableChunk(size_t index) {
+  auto& chunk = MutableChunks()[index];
+  if (chunk.use_count() != 1) {
+    chunk = std::make_shared<Chunk>(*chunk);
+  }
+  return *chunk;
+}
+
+const Theme::Entry* Theme::FindEntry(uint32_t resid) const {
+  if (chunks_ == nullptr) {
+    return nullptr;
+  }
+  const uint32_t chunk_base = resid & kThemeChunkMask;
+  const auto chunk_it =
+      std::lower_bound(chunks_->begin(), chunks_->end(), chunk_base, ChunkBaseLess);
+  if (chunk_it == chunks_->end() || (*chunk_it)->base != chunk_base) {
+    return nullptr;
+  }
+  const Chunk& chunk = **chunk_it;
+  const auto key_it = std::lower_bound(chunk.keys.begin(), chunk.keys.end(), resid);
+  if (key_it == chunk.keys.end() || *key_it != resid) {
+    return nullptr;
+  }
+  return &chunk.entries[key_it - chunk.keys.begin()];
 }
 
 void Theme::Rebase(AssetManager2* am, const uint32_t* style_ids, const uint8_t* force,
                    size_t style_count) {
   ATRACE_NAME("Theme::Rebase");
-  // Reset the entries without changing the vector capacity to prevent reallocations during
-  // ApplyStyle.
-  keys_.clear();
-  entries_.clear();
+  Clear();
   asset_manager_ = am;
   for (size_t i = 0; i < style_count; i++) {
     ApplyStyle(style_ids[i], force[i]);
@@ -1733,11 +2073,10 @@ std::optional<AssetManager2::SelectedValue> Theme::GetAttribute(uint32_t resid)
   constexpr const uint32_t kMaxIterations = 20;
   uint32_t type_spec_flags = 0u;
   for (uint32_t i = 0; i <= kMaxIterations; i++) {
-    const auto key_it = std::lower_bound(keys_.begin(), keys_.end(), resid);
-    if (key_it == keys_.end() || *key_it != resid) {
+    const Entry* entry_it = FindEntry(resid);
+    if (entry_it == nullptr) {
       return std::nullopt;
     }
-    const auto entry_it = entries_.begin() + (key_it - keys_.begin());
     if (IsUndefined(entry_it->value)) {
       return std::nullopt;
     }
@@ -1774,8 +2113,7 @@ base::expected<std::monostate, NullOrIOError> Theme::ResolveAttributeReference(
 }
 
 void Theme::Clear() {
-  keys_.clear();
-  entries_.clear();
+  chunks_.reset();
 }
 
 base::expected<std::monostate, IOError> Theme::SetTo(const Theme& source) {
@@ -1786,8 +2124,8 @@ base::expected<std::monostate, IOError> Theme::SetTo(const Theme& source) {
   type_spec_flags_ = source.type_spec_flags_;
 
   if (asset_manager_ == source.asset_manager_) {
-    keys_ = source.keys_;
-    entries_ = source.entries_;
+    // The chunks are copied when either theme modifies them.
+    chunks_ = source.chunks_;
   } else {
     std::unordered_map<ApkAssetsCookie, ApkAssetsCookie> src_to_dest_asset_cookies;
     using SourceToDestinationRuntimePackageMap = std::unordered_map<int, int>;
@@ -1826,12 +2164,22 @@ base::expected<std::monostate, IOError> Theme::SetTo(const Theme& source) {
       }
     }
 
+    std::vector<std::pair<uint32_t, const Entry*>> source_entries;
+    if (source.chunks_ != nullptr) {
+      for (const auto& chunk : *source.chunks_) {
+        for (size_t i = 0, size = chunk->keys.size(); i != size; ++i) {
+          source_entries.emplace_back(chunk->keys[i], &chunk->entries[i]);
+        }
+      }
+    }
+
     // Reset the data in the destination theme.
-    keys_.clear();
-    entries_.clear();
+    Clear();
+    std::vector<std::pair<uint32_t, Entry>> dest_entries;
+    dest_entries.reserve(source_entries.size());
 
-    for (size_t i = 0, size = source.entries_.size(); i != size; ++i) {
-      const auto& entry = source.entries_[i];
+    for (const auto& [source_res_id, source_entry] : source_entries) {
+      const auto& entry = *source_entry;
       bool is_reference = (entry.value.dataType == Res_value::TYPE_ATTRIBUTE
                            || entry.value.dataType == Res_value::TYPE_REFERENCE
                            || entry.value.dataType == Res_value::TYPE_DYNAMIC_ATTRIBUTE
@@ -1871,8 +2219,6 @@ base::expected<std::monostate, IOError> Theme::SetTo(const Theme& source) {
         }
       }
 
-      const auto source_res_id = source.keys_[i];
-
       // The package id of the attribute needs to be rewritten to the package id of the
       // attribute in the destination.
       int attribute_dest_package_id = get_package_id(source_res_id);
@@ -1905,26 +2251,46 @@ base::expected<std::monostate, IOError> Theme::SetTo(const Theme& source) {
 
       auto dest_attr_id = make_resid(attribute_dest_package_id, get_type_id(source_res_id),
                                      get_entry_id(source_res_id));
-      const auto key_it = std::lower_bound(keys_.begin(), keys_.end(), dest_attr_id);
-      const auto entry_it = entries_.begin() + (key_it - keys_.begin());
-      // Since the entries were cleared, the attribute resource id has yet been mapped to any value.
-      keys_.insert(key_it, dest_attr_id);
-      entries_.insert(entry_it, Entry{data_dest_cookie, entry.type_spec_flags,
+      dest_entries.emplace_back(dest_attr_id,
+                                Entry{data_dest_cookie, entry.type_spec_flags,
                                       Res_value{.dataType = entry.value.dataType,
                                                 .data = attribute_data}});
     }
+
+    // Rewriting package ids may change the order of the attributes. When two source attributes
+    // map to the same destination attribute, the one copied last wins.
+    std::stable_sort(dest_entries.begin(), dest_entries.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (size_t i = 0, size = dest_entries.size(); i != size; ++i) {
+      const auto& [dest_attr_id, entry] = dest_entries[i];
+      if (i + 1 != size && dest_entries[i + 1].first == dest_attr_id) {
+        continue;
+      }
+      auto& chunks = MutableChunks();
+      const uint32_t chunk_base = dest_attr_id & kThemeChunkMask;
+      if (chunks.empty() || chunks.back()->base != chunk_base) {
+        chunks.push_back(std::make_shared<Chunk>(Chunk{.base = chunk_base}));
+      }
+      chunks.back()->keys.push_back(dest_attr_id);
+      chunks.back()->entries.push_back(entry);
+    }
   }
   return {};
 }
 
 void Theme::Dump() const {
   LOG(INFO) << base::StringPrintf("Theme(this=%p, AssetManager2=%p)", this, asset_manager_);
-  for (size_t i = 0, size = keys_.size(); i != size; ++i) {
-    auto res_id = keys_[i];
-    const auto& entry = entries_[i];
-    LOG(INFO) << base::StringPrintf("  entry(0x%08x)=(0x%08x) type=(0x%02x), cookie(%d)",
-                                    res_id, entry.value.data, entry.value.dataType,
-                                    entry.cookie);
+  if (chunks_ == nullptr) {
+    return;
+  }
+  for (const auto& chunk : *chunks_) {
+    for (size_t i = 0, size = chunk->keys.size(); i != size; ++i) {
+      auto res_id = chunk->keys[i];
+      const auto& entry = chunk->entries[i];
+      LOG(INFO) << base::StringPrintf("  entry(0x%08x)=(0x%08x) type=(0x%02x), cookie(%d)",
+                                      res_id, entry.value.data, entry.value.dataType,
+                                      entry.cookie);
+    }
   }
 }
 
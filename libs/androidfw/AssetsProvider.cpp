@@ -18,6 +18,9 @@
 
 #include <sys/stat.h>
 
+#include <mutex>
+#include <unordered_map>
+
 #include <android-base/errors.h>
 #include <android-base/stringprintf.h>
 #include <android-base/utf8.h>
@@ -85,16 +88,49 @@ void ZipAssetsProvider::ZipCloser::operator()(ZipArchive* a) const {
   ::CloseArchive(a);
 }
 
-ZipAssetsProvider::ZipAssetsProvider(ZipArchiveHandle handle, PathOrDebugName&& path,
+ZipAssetsProvider::ZipAssetsProvider(std::shared_ptr<ZipArchive> handle, PathOrDebugName&& path,
                                      package_property_t flags, time_t last_mod_time)
-    : zip_handle_(handle),
+    : zip_handle_(std::move(handle)),
       name_(std::move(path)),
       flags_(flags),
       last_mod_time_(last_mod_time) {}
 
+std::shared_ptr<ZipArchive> ZipAssetsProvider::OpenSharedArchive(const std::string& path) {
+  // Files on a read-only filesystem never change, so an archive opened once can serve every later
+  // open of the same path. Lookups on a ZipArchive are read-only and safe to share.
+  static std::mutex mutex;
+  static std::unordered_map<std::string, std::weak_ptr<ZipArchive>> archives;
+
+  std::lock_guard lock(mutex);
+  auto& cached = archives[path];
+  if (auto archive = cached.lock()) {
+    return archive;
+  }
+
+  ZipArchiveHandle handle;
+  if (int32_t result = OpenArchive(path.c_str(), &handle)) {
+    LOG(ERROR) << "Failed to open APK '" << path << "': " << ::ErrorCodeString(result);
+    CloseArchive(handle);
+    archives.erase(path);
+    return {};
+  }
+  std::shared_ptr<ZipArchive> archive(handle, ZipCloser());
+  cached = archive;
+  return archive;
+}
+
 std::unique_ptr<ZipAssetsProvider> ZipAssetsProvider::Create(std::string path,
                                                              package_property_t flags,
                                                              base::unique_fd fd) {
+  if (!fd.ok() && isReadonlyFilesystem(path.c_str())) {
+    auto archive = OpenSharedArchive(path);
+    if (archive == nullptr) {
+      return {};
+    }
+    return std::unique_ptr<ZipAssetsProvider>(new ZipAssetsProvider(
+        std::move(archive), PathOrDebugName::Path(std::move(path)), flags, -1));
+  }
+
   const auto released_fd = fd.ok() ? fd.release() : -1;
   ZipArchiveHandle handle;
   if (int32_t result = released_fd < 0 ? OpenArchive(path.c_str(), &handle)
@@ -116,7 +152,8 @@ std::unique_ptr<ZipAssetsProvider> ZipAssetsProvider::Create(std::string path,
   }
 
   return std::unique_ptr<ZipAssetsProvider>(
-      new ZipAssetsProvider(handle, PathOrDebugName::Path(std::move(path)), flags, sb.st_mtime));
+      new ZipAssetsProvider(std::shared_ptr<ZipArchive>(handle, ZipCloser()),
+                            PathOrDebugName::Path(std::move(path)), flags, sb.st_mtime));
 }
 
 std::unique_ptr<ZipAssetsProvider> ZipAssetsProvider::Create(base::unique_fd fd,
@@ -149,8 +186,10 @@ std::unique_ptr<ZipAssetsProvider> ZipAssetsProvider::Create(base::unique_fd fd,
     }
   }
 
-  return std::unique_ptr<ZipAssetsProvider>(new ZipAssetsProvider(
-      handle, PathOrDebugName::DebugName(std::move(friendly_name)), flags, sb.st_mtime));
+  return std::unique_ptr<ZipAssetsProvider>(
+      new ZipAssetsProvider(std::shared_ptr<ZipArchive>(handle, ZipCloser()),
+                            PathOrDebugName::DebugName(std::move(friendly_name)), flags,
+                            sb.st_mtime));
 }
 
 std::unique_ptr<Asset> ZipAssetsProvider::OpenInternal(const std::string& path,
@@ -17,11 +17,14 @@
 #include "androidfw/AttributeResolution.h"
 
 #include <cstdint>
+#include <optional>
+#include <vector>
 
 #include <log/log.h>
 
 #include "androidfw/AssetManager2.h"
 #include "androidfw/AttributeFinder.h"
+#include "androidfw/ResourceTimer.h"
 
 constexpr bool kDebugStyles = false;
 #define DEBUG_LOG(...) do { if (kDebugStyles) { ALOGI(__VA_ARGS__); } } while(0)
@@ -116,6 +119,17 @@ base::expected<const ResolvedBag*, NullOrIOError> GetXmlStyleBag(Theme* theme,
   return base::unexpected(std::nullopt);
 }
 
+// The value of an attribute that is set neither by the XML nor by its style. It only depends on
+// the theme and the default style, so it is the same for every element in ApplyStyles().
+struct FallbackValue {
+  AssetManager2::SelectedValue value;
+  uint32_t source_resid = 0U;
+
+  // Whether the value comes from the default style. ApplyStyle() adds the theme flags of the XML
+  // style to such values.
+  bool from_def_style = false;
+};
+
 } // namespace
 
 base::expected<std::monostate, IOError> ResolveAttrs(Theme* theme, uint32_t def_style_attr,
@@ -125,6 +139,7 @@ base::expected<std::monostate, IOError> ResolveAttrs(Theme* theme, uint32_t def_
                                                      uint32_t* out_indices) {
   DEBUG_LOG("APPLY STYLE: theme=0x%p defStyleAttr=0x%x defStyleRes=0x%x", theme, def_style_attr,
             def_style_res);
+  ResourceTimer _timer(ResourceTimer::Counter::ResolveAttrs);
 
   int indices_idx = 0;
   const AssetManager2* assetmanager = theme->GetAssetManager();
@@ -224,6 +239,7 @@ base::expected<std::monostate, IOError> ApplyStyle(Theme* theme, ResXMLParser* x
                                                    uint32_t* out_values, uint32_t* out_indices) {
   DEBUG_LOG("APPLY STYLE: theme=0x%p defStyleAttr=0x%x defStyleRes=0x%x xml=0x%p", theme,
             def_style_attr, def_style_resid, xml_parser);
+  ResourceTimer _timer(ResourceTimer::Counter::ApplyStyle);
 
   int indices_idx = 0;
   const AssetManager2* assetmanager = theme->GetAssetManager();
@@ -349,6 +365,139 @@ base::expected<std::monostate, IOError> ApplyStyle(Theme* theme, ResXMLParser* x
   return {};
 }
 
+base::expected<std::monostate, IOError> ApplyStyles(Theme* theme,
+                                                    std::span<ResXMLParser* const> xml_parsers,
+                                                    uint32_t def_style_attr,
+                                                    uint32_t def_style_resid,
+                                                    const uint32_t* attrs, size_t attrs_length,
+                                                    uint32_t* out_values, uint32_t* out_indices) {
+  const AssetManager2* assetmanager = theme->GetAssetManager();
+
+  // Load default style from attribute, if specified...
+  uint32_t def_style_theme_flags = 0U;
+  const auto default_style_bag = GetStyleBag(theme, def_style_attr, def_style_resid,
+                                             &def_style_theme_flags);
+  if (IsIOError(default_style_bag)) {
+    return base::unexpected(GetIOError(default_style_bag.error()));
+  }
+  BagAttributeFinder def_style_attr_finder(default_style_bag.value_or(nullptr));
+
+  // The fallback values are resolved the first time an element needs them.
+  std::vector<std::optional<FallbackValue>> fallback_values(attrs_length);
+  auto get_fallback_value = [&](size_t ii) -> base::expected<const FallbackValue*, IOError> {
+    std::optional<FallbackValue>& fallback = fallback_values[ii];
+    if (fallback.has_value()) {
+      return &*fallback;
+    }
+
+    FallbackValue result;
+    const ResolvedBag::Entry* entry = def_style_attr_finder.Find(attrs[ii]);
+    if (entry != def_style_attr_finder.end()) {
+      result.value = AssetManager2::SelectedValue(*default_style_bag, *entry);
+      result.value.flags |= def_style_theme_flags;
+      result.source_resid = entry->style;
+      result.from_def_style = true;
+    }
+
+    if (result.value.type != Res_value::TYPE_NULL) {
+      auto resolved = theme->ResolveAttributeReference(result.value);
+      if (UNLIKELY(IsIOError(resolved))) {
+        return base::unexpected(GetIOError(resolved.error()));
+      }
+    } else if (result.value.data != Res_value::DATA_NULL_EMPTY) {
+      if (auto attr_value = theme->GetAttribute(attrs[ii])) {
+        result.value = *attr_value;
+        result.from_def_style = false;
+        auto resolved = assetmanager->ResolveReference(result.value, true /* cache_value */);
+        if (UNLIKELY(IsIOError(resolved))) {
+          return base::unexpected(GetIOError(resolved.error()));
+        }
+      }
+    }
+    return &fallback.emplace(result);
+  };
+
+  for (ResXMLParser* xml_parser : xml_parsers) {
+    // Retrieve the style resource ID associated with the current XML tag's style attribute.
+    uint32_t xml_style_theme_flags = 0U;
+    const auto xml_style_bag = GetXmlStyleBag(theme, xml_parser, &xml_style_theme_flags);
+    if (IsIOError(xml_style_bag)) {
+      return base::unexpected(GetIOError(xml_style_bag.error()));
+    }
+
+    BagAttributeFinder xml_style_attr_finder(xml_style_bag.value_or(nullptr));
+    XmlAttributeFinder xml_attr_finder(xml_parser);
+
+    int indices_idx = 0;
+    for (size_t ii = 0; ii < attrs_length; ii++) {
+      const uint32_t cur_ident = attrs[ii];
+      AssetManager2::SelectedValue value{};
+      uint32_t value_source_resid = 0;
+
+      // Walk through the xml attributes looking for the requested attribute.
+      const size_t xml_attr_idx = xml_attr_finder.Find(cur_ident);
+      if (xml_attr_idx != xml_attr_finder.end()) {
+        Res_value attribute_value{};
+        xml_parser->getAttributeValue(xml_attr_idx, &attribute_value);
+        value.type = attribute_value.dataType;
+        value.data = attribute_value.data;
+        value_source_resid = xml_parser->getSourceResourceId();
+      }
+
+      if (value.type == Res_value::TYPE_NULL && value.data != Res_value::DATA_NULL_EMPTY) {
+        // Walk through the style class values looking for the requested attribute.
+        const ResolvedBag::Entry* entry = xml_style_attr_finder.Find(cur_ident);
+        if (entry != xml_style_attr_finder.end()) {
+          value = AssetManager2::SelectedValue(*xml_style_bag, *entry);
+          value_source_resid = entry->style;
+        }
+      }
+
+      if (value.type != Res_value::TYPE_NULL) {
+        // Take care of resolving the found resource to its final value.
+        auto result = theme->ResolveAttributeReference(value);
+        if (UNLIKELY(IsIOError(result))) {
+          return base::unexpected(GetIOError(result.error()));
+        }
+      } else if (value.data != Res_value::DATA_NULL_EMPTY) {
+        // Fall back to the default style and then the theme, which are already resolved.
+        auto fallback = get_fallback_value(ii);
+        if (UNLIKELY(!fallback.has_value())) {
+          return base::unexpected(fallback.error());
+        }
+        value = (*fallback)->value;
+        value_source_resid = (*fallback)->source_resid;
+        if ((*fallback)->from_def_style) {
+          value.flags |= xml_style_theme_flags;
+        }
+      }
+
+      // Deal with the special @null value -- it turns back to TYPE_NULL.
+      if (value.type == Res_value::TYPE_REFERENCE && value.data == 0U) {
+        value.type = Res_value::TYPE_NULL;
+        value.data = Res_value::DATA_NULL_UNDEFINED;
+        value.cookie = kInvalidCookie;
+      }
+
+      out_values[STYLE_TYPE] = value.type;
+      out_values[STYLE_DATA] = value.data;
+      out_values[STYLE_ASSET_COOKIE] = ApkAssetsCookieToJavaCookie(value.cookie);
+      out_values[STYLE_RESOURCE_ID] = value.resid;
+      out_values[STYLE_CHANGING_CONFIGURATIONS] = value.flags;
+      out_values[STYLE_DENSITY] = value.config.density;
+      out_values[STYLE_SOURCE_RESOURCE_ID] = value_source_resid;
+
+      if (value.type != Res_value::TYPE_NULL || value.data == Res_value::DATA_NULL_EMPTY) {
+        out_indices[++indices_idx] = ii;
+      }
+      out_values += STYLE_NUM_ENTRIES;
+    }
+    out_indices[0] = indices_idx;
+    out_indices += attrs_length + 1;
+  }
+  return {};
+}
+
 base::expected<std::monostate, IOError> RetrieveAttributes(AssetManager2* assetmanager,
                                                            ResXMLParser* xml_parser,
                                                            uint32_t* attrs,
@@ -18,6 +18,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <androidfw/BackupHelpers.h>
@@ -167,6 +168,46 @@ BackupDataWriter::WriteEntityData(const void* data, size_t size)
     return NO_ERROR;
 }
 
+status_t
+BackupDataWriter::WriteEntityData(const struct iovec* iov, int iovcnt)
+{
+    if (m_status != NO_ERROR) {
+        if (kIsDebug) {
+            ALOGD("Not writing data - stream in error state %d (%s)", m_status, strerror(m_status));
+        }
+        return m_status;
+    }
+
+    // Copy the vector so that partial writes can advance it.
+    const int MAX_IOV = 8;
+    struct iovec pending[MAX_IOV];
+    if (iovcnt < 0 || iovcnt > MAX_IOV) {
+        return BAD_VALUE;
+    }
+    memcpy(pending, iov, iovcnt * sizeof(struct iovec));
+
+    struct iovec* next = pending;
+    while (iovcnt > 0) {
+        ssize_t amt = TEMP_FAILURE_RETRY(writev(m_fd, next, iovcnt));
+        if (amt <= 0) {
+            m_status = amt < 0 ? errno : EIO;
+            if (kIsDebug) ALOGD("writev returned error %d (%s)", m_status, strerror(m_status));
+            return m_status;
+        }
+        m_pos += amt;
+        while (iovcnt > 0 && (size_t)amt >= next->iov_len) {
+            amt -= next->iov_len;
+            next++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            next->iov_base = (char*)next->iov_base + amt;
+            next->iov_len -= amt;
+        }
+    }
+    return NO_ERROR;
+}
+
 void
 BackupDataWriter::SetKeyPrefix(const String8& keyPrefix)
 {
@@ -30,6 +30,11 @@
 #include <utime.h>
 #include <zlib.h>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include <androidfw/PathUtils.h>
 #include <log/log.h>
 #include <utils/ByteOrder.h>
@@ -333,6 +338,62 @@ compute_crc32(const char* file, FileRec* out) {
     return NO_ERROR;
 }
 
+enum {
+    SCAN_OK,
+    SCAN_NOT_FOUND,
+    SCAN_UNREADABLE,
+};
+
+// Fills in the snapshot record of each of the files, and its SCAN_* status.
+static void
+scan_files(char const* const* files, int fileCount, std::vector<FileRec>* recs,
+        std::vector<int>* status)
+{
+    recs->resize(fileCount);
+    status->resize(fileCount);
+
+    std::atomic<int> next = 0;
+    auto worker = [&]() {
+        for (int i; (i = next.fetch_add(1, std::memory_order_relaxed)) < fileCount;) {
+            FileRec& r = (*recs)[i];
+            char const* file = files[i];
+            r.file = file;
+            struct stat st;
+
+            if (stat(file, &st) != 0) {
+                // not found => treat as deleted
+                (*status)[i] = SCAN_NOT_FOUND;
+                continue;
+            }
+            r.deleted = false;
+            r.s.modTime_sec = st.st_mtime;
+            r.s.modTime_nsec = 0; // workaround sim breakage
+            //r.s.modTime_nsec = st.st_mtime_nsec;
+            r.s.mode = st.st_mode;
+            r.s.size = st.st_size;
+
+            // compute the CRC
+            (*status)[i] = compute_crc32(file, &r) == NO_ERROR ? SCAN_OK : SCAN_UNREADABLE;
+        }
+    };
+
+    // Apps with many small files are bound by the stat, open and read calls, so
+    // overlap them on a few threads. The output order is kept by writing each
+    // file's result at its own index.
+    const int MIN_FILES_PER_THREAD = 16;
+    const int MAX_THREADS = 4;
+    const int threadCount = std::min({MAX_THREADS, fileCount / MIN_FILES_PER_THREAD,
+            (int)std::thread::hardware_concurrency()});
+    std::vector<std::thread> threads;
+    for (int i = 1; i < threadCount; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
 int
 back_up_files(int oldSnapshotFD, BackupDataWriter* dataStream, int newSnapshotFD,
         char const* const* files, char const* const* keys, int fileCount)
@@ -349,37 +410,26 @@ back_up_files(int oldSnapshotFD, BackupDataWriter* dataStream, int newSnapshotFD
         }
     }
 
+    std::vector<FileRec> recs;
+    std::vector<int> status;
+    scan_files(files, fileCount, &recs, &status);
+
     for (int i=0; i<fileCount; i++) {
         String8 key(keys[i]);
-        FileRec r;
-        char const* file = files[i];
-        r.file = file;
-        struct stat st;
-
-        err = stat(file, &st);
-        if (err != 0) {
-            // not found => treat as deleted
+        if (status[i] == SCAN_NOT_FOUND) {
             continue;
-        } else {
-            r.deleted = false;
-            r.s.modTime_sec = st.st_mtime;
-            r.s.modTime_nsec = 0; // workaround sim breakage
-            //r.s.modTime_nsec = st.st_mtime_nsec;
-            r.s.mode = st.st_mode;
-            r.s.size = st.st_size;
+        }
 
-            if (newSnapshot.indexOfKey(key) >= 0) {
-                LOGP("back_up_files key already in use '%s'", key.c_str());
-                return -1;
-            }
+        if (newSnapshot.indexOfKey(key) >= 0) {
+            LOGP("back_up_files key already in use '%s'", key.c_str());
+            return -1;
+        }
 
-            // compute the CRC
-            if (compute_crc32(file, &r) != NO_ERROR) {
-                ALOGW("Unable to open file %s", file);
-                continue;
-            }
+        if (status[i] == SCAN_UNREADABLE) {
+            ALOGW("Unable to open file %s", files[i]);
+            continue;
         }
-        newSnapshot.add(key, r);
+        newSnapshot.add(key, recs[i]);
     }
 
     int n = 0;
@@ -478,8 +528,12 @@ static int write_pax_header_entry(char* buf, size_t buf_size,
 // a 4-byte count of its size.  A chunk size of zero (four zero bytes) indicates EOD.
 void send_tarfile_chunk(BackupDataWriter* writer, const char* buffer, size_t size) {
     uint32_t chunk_size_no = htonl(size);
-    writer->WriteEntityData(&chunk_size_no, 4);
-    if (size != 0) writer->WriteEntityData(buffer, size);
+    // Send the count and the chunk with a single write.
+    struct iovec iov[2] = {
+        { &chunk_size_no, 4 },
+        { const_cast<char*>(buffer), size },
+    };
+    writer->WriteEntityData(iov, size != 0 ? 2 : 1);
 }
 
 int write_tarfile(const String8& packageName, const String8& domain,
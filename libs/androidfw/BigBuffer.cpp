@@ -17,6 +17,7 @@
 #include <androidfw/BigBuffer.h>
 
 #include <algorithm>
+#include <cstring>
 #include <iterator>
 #include <memory>
 
@@ -24,6 +25,60 @@
 
 namespace android {
 
+BigBufferPool::BigBufferPool(size_t block_size, size_t max_blocks)
+    : block_size_(block_size), max_blocks_(max_blocks) {
+}
+
+std::unique_ptr<uint8_t[]> BigBufferPool::Acquire() {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (!free_blocks_.empty()) {
+      std::unique_ptr<uint8_t[]> buffer = std::move(free_blocks_.back());
+      free_blocks_.pop_back();
+      // Recycled blocks hold data from the previous buffer.
+      memset(buffer.get(), 0, block_size_);
+      return buffer;
+    }
+  }
+  return std::unique_ptr<uint8_t[]>(new uint8_t[block_size_]());
+}
+
+void BigBufferPool::Release(std::unique_ptr<uint8_t[]> buffer) {
+  std::lock_guard<std::mutex> lock(lock_);
+  if (free_blocks_.size() < max_blocks_) {
+    free_blocks_.push_back(std::move(buffer));
+  }
+}
+
+BigBuffer::~BigBuffer() {
+  if (pool_ == nullptr) {
+    return;
+  }
+  for (Block& block : blocks_) {
+    // Blocks larger than the pool's, and blocks appended from other buffers, may have a different
+    // allocation size.
+    if (block.block_size_ == pool_->block_size()) {
+      pool_->Release(std::move(block.buffer));
+    }
+  }
+}
+
+BigBuffer::Block& BigBuffer::AppendBlock(size_t size) {
+  Block block = {};
+
+  // Zero-allocate the block's buffer.
+  if (pool_ != nullptr && size == pool_->block_size()) {
+    block.buffer = pool_->Acquire();
+  } else {
+    block.buffer = std::unique_ptr<uint8_t[]>(new uint8_t[size]());
+  }
+  CHECK(block.buffer);
+  block.block_size_ = size;
+
+  blocks_.push_back(std::move(block));
+  return blocks_.back();
+}
+
 void* BigBuffer::NextBlockImpl(size_t size) {
   if (!blocks_.empty()) {
     Block& block = blocks_.back();
@@ -35,20 +90,10 @@ void* BigBuffer::NextBlockImpl(size_t size) {
     }
   }
 
-  const size_t actual_size = std::max(block_size_, size);
-
-  Block block = {};
-
-  // Zero-allocate the block's buffer.
-  block.buffer = std::unique_ptr<uint8_t[]>(new uint8_t[actual_size]());
-  CHECK(block.buffer);
-
+  Block& block = AppendBlock(std::max(block_size_, size));
   block.size = size;
-  block.block_size_ = actual_size;
-
-  blocks_.push_back(std::move(block));
   size_ += size;
-  return blocks_.back().buffer.get();
+  return block.buffer.get();
 }
 
 void* BigBuffer::NextBlock(size_t* out_size) {
@@ -64,16 +109,11 @@ void* BigBuffer::NextBlock(size_t* out_size) {
     }
   }
 
-  // Zero-allocate the block's buffer.
-  Block block = {};
-  block.buffer = std::unique_ptr<uint8_t[]>(new uint8_t[block_size_]());
-  CHECK(block.buffer);
+  Block& block = AppendBlock(block_size_);
   block.size = block_size_;
-  block.block_size_ = block_size_;
-  blocks_.push_back(std::move(block));
   size_ += block_size_;
   *out_size = block_size_;
-  return blocks_.back().buffer.get();
+  return block.buffer.get();
 }
 
 std::string BigBuffer::to_string() const {
@@ -20,6 +20,8 @@
 
 #include <sys/mman.h>
 
+#include <type_traits>
+
 #include "android-base/logging.h"
 #include "cutils/ashmem.h"
 
@@ -351,6 +353,69 @@ CursorWindow::FieldSlot* CursorWindow::getFieldSlot(uint32_t row, uint32_t colum
     }
 }
 
+template <typename T>
+status_t CursorWindow::getColumn(uint32_t column, uint32_t fromRow, uint32_t count,
+        T* outValues, uint32_t* outFailedRow) {
+    if (count == 0) {
+        return OK;
+    }
+    if (count > mNumRows || fromRow > mNumRows - count) {
+        LOG(ERROR) << "Failed to read " << count << " rows from row " << fromRow
+                << " from a window with " << mNumRows << " rows";
+        return BAD_VALUE;
+    }
+    FieldSlot* fieldSlot = getFieldSlot(fromRow, column);
+    if (!fieldSlot || !getFieldSlot(fromRow + count - 1, column)) {
+        return BAD_VALUE;
+    }
+
+    // The slots of a column are a row of slots apart, going down from mSlotsStart.
+    uint8_t* slot = reinterpret_cast<uint8_t*>(fieldSlot);
+    const size_t rowStride = size_t(mNumColumns) << kSlotShift;
+    for (uint32_t i = 0; i < count; i++, slot -= rowStride) {
+        fieldSlot = reinterpret_cast<FieldSlot*>(slot);
+        switch (fieldSlot->type) {
+            case FIELD_TYPE_INTEGER:
+                outValues[i] = static_cast<T>(fieldSlot->data.l);
+                break;
+            case FIELD_TYPE_FLOAT:
+                outValues[i] = static_cast<T>(fieldSlot->data.d);
+                break;
+            case FIELD_TYPE_NULL:
+                outValues[i] = 0;
+                break;
+            case FIELD_TYPE_STRING: {
+                size_t sizeIncludingNull;
+                const char* value = getFieldSlotValueString(fieldSlot, &sizeIncludingNull);
+                if (sizeIncludingNull <= 1) {
+                    outValues[i] = 0;
+                } else if constexpr (std::is_integral_v<T>) {
+                    outValues[i] = strtoll(value, nullptr, 0);
+                } else {
+                    outValues[i] = strtod(value, nullptr);
+                }
+                break;
+            }
+            default:
+                if (outFailedRow) {
+                    *outFailedRow = fromRow + i;
+                }
+                return BAD_TYPE;
+        }
+    }
+    return OK;
+}
+
+status_t CursorWindow::getLongs(uint32_t column, uint32_t fromRow, uint32_t count,
+        int64_t* outValues, uint32_t* outFailedRow) {
+    return getColumn(column, fromRow, count, outValues, outFailedRow);
+}
+
+status_t CursorWindow::getDoubles(uint32_t column, uint32_t fromRow, uint32_t count,
+        double* outValues, uint32_t* outFailedRow) {
+    return getColumn(column, fromRow, count, outValues, outFailedRow);
+}
+
 status_t CursorWindow::putBlob(uint32_t row, uint32_t column, const void* value, size_t size) {
     return putBlobOrString(row, column, value, size, FIELD_TYPE_BLOB);
 }
@@ -151,15 +151,45 @@ IdmapResMap::IdmapResMap(const Idmap_data_header* data_header,
                          const Idmap_target_entry_inline_value* inline_entry_values,
                          const ConfigDescription* configs,
                          uint8_t target_assigned_package_id,
-                         const OverlayDynamicRefTable* overlay_ref_table)
+                         const OverlayDynamicRefTable* overlay_ref_table,
+                         const IdmapTargetIndex* entry_index,
+                         const IdmapTargetIndex* inline_entry_index)
     : data_header_(data_header),
       entries_(entries),
+      entry_index_(entry_index),
       inline_entries_(inline_entries),
+      inline_entry_index_(inline_entry_index),
       inline_entry_values_(inline_entry_values),
       configurations_(configs),
       target_assigned_package_id_(target_assigned_package_id),
       overlay_ref_table_(overlay_ref_table) { }
 
+namespace {
+
+// Returns the entry for `target_res_id` with the index if its type is indexed, or with a binary
+// search of `entries` otherwise. Returns `end` if there is none.
+template <typename Entry>
+const Entry* FindTargetEntry(const Entry* entries, const Entry* end, const IdmapTargetIndex& index,
+                             uint32_t target_res_id) {
+  const uint32_t position = index.Find(target_res_id);
+  if (position == IdmapTargetIndex::kNotFound) {
+    return end;
+  }
+  if (position != IdmapTargetIndex::kUnindexed) {
+    return entries + position;
+  }
+  auto entry = std::lower_bound(entries, end, target_res_id,
+                                [](const Entry& e, const uint32_t target_id) {
+    return (0x00FFFFFFU & dtohl(e.target_id)) < target_id;
+  });
+  if (entry != end && (0x00FFFFFFU & dtohl(entry->target_id)) == target_res_id) {
+    return entry;
+  }
+  return end;
+}
+
+}  // namespace
+
 IdmapResMap::Result IdmapResMap::Lookup(uint32_t target_res_id) const {
   if ((target_res_id >> 24U) != target_assigned_package_id_) {
     // The resource id must have the same package id as the target package.
@@ -171,14 +201,9 @@ IdmapResMap::Result IdmapResMap::Lookup(uint32_t target_res_id) const {
   target_res_id &= 0x00FFFFFFU;
 
   // Check if the target resource is mapped to an overlay resource.
-  auto first_entry = entries_;
   auto end_entry = entries_ + dtohl(data_header_->target_entry_count);
-  auto entry = std::lower_bound(first_entry, end_entry, target_res_id,
-                                [](const Idmap_target_entry& e, const uint32_t target_id) {
-    return (0x00FFFFFFU & dtohl(e.target_id)) < target_id;
-  });
-
-  if (entry != end_entry && (0x00FFFFFFU & dtohl(entry->target_id)) == target_res_id) {
+  auto entry = FindTargetEntry(entries_, end_entry, *entry_index_, target_res_id);
+  if (entry != end_entry) {
     uint32_t overlay_resource_id = dtohl(entry->overlay_id);
     // Lookup the resource without rewriting the overlay resource id back to the target resource id
     // being looked up.
@@ -187,16 +212,10 @@ IdmapResMap::Result IdmapResMap::Lookup(uint32_t target_res_id) const {
   }
 
   // Check if the target resources is mapped to an inline table entry.
-  auto first_inline_entry = inline_entries_;
   auto end_inline_entry = inline_entries_ + dtohl(data_header_->target_inline_entry_count);
-  auto inline_entry = std::lower_bound(first_inline_entry, end_inline_entry, target_res_id,
-                                       [](const Idmap_target_entry_inline& e,
-                                          const uint32_t target_id) {
-    return (0x00FFFFFFU & dtohl(e.target_id)) < target_id;
-  });
-
-  if (inline_entry != end_inline_entry &&
-      (0x00FFFFFFU & dtohl(inline_entry->target_id)) == target_res_id) {
+  auto inline_entry = FindTargetEntry(inline_entries_, end_inline_entry, *inline_entry_index_,
+                                      target_res_id);
+  if (inline_entry != end_inline_entry) {
     std::map<ConfigDescription, Res_value> values_map;
     for (int i = 0; i < inline_entry->value_count; i++) {
       const auto& value = inline_entry_values_[inline_entry->start_value_index + i];
@@ -277,7 +296,11 @@ LoadedIdmap::LoadedIdmap(const std::string& idmap_path, const Idmap_header* head
       idmap_fd_(android::base::utf8::open(idmap_path.c_str(), O_RDONLY|O_CLOEXEC|O_BINARY|O_PATH)),
       overlay_apk_path_(overlay_apk_path),
       target_apk_path_(target_apk_path),
-      idmap_last_mod_time_(getFileModDate(idmap_fd_.get())) {}
+      idmap_last_mod_time_(getFileModDate(idmap_fd_.get())) {
+  target_index_.Build(target_entries_, dtohl(data_header_->target_entry_count));
+  target_inline_index_.Build(target_inline_entries_,
+                             dtohl(data_header_->target_inline_entry_count));
+}
 
 std::unique_ptr<LoadedIdmap> LoadedIdmap::Load(StringPiece idmap_path, StringPiece idmap_data) {
   ATRACE_CALL();
@@ -58,12 +58,19 @@ struct TypeSpecBuilder {
   void AddType(incfs::verified_map_ptr<ResTable_type> type) {
     TypeSpec::TypeEntry& entry = type_entries.emplace_back();
     entry.config.copyFromDtoH(type->config);
+    entry.packed_config = PackedConfigRange::FromConfig(entry.config);
+    entry.sparse_index = SparseEntryIndex::Create(type);
     entry.type = type;
   }
 
   TypeSpec Build() {
     type_entries.shrink_to_fit();
-    return {header_, std::move(type_entries)};
+    const ResTable_config default_config{};
+    uint32_t config_axes = 0U;
+    for (const auto& type_entry : type_entries) {
+      config_axes |= static_cast<uint32_t>(type_entry.config.diff(default_config));
+    }
+    return {header_, std::move(type_entries), config_axes};
   }
 
  private:
@@ -316,6 +323,25 @@ base::expected<uint32_t, NullOrIOError> LoadedPackage::GetEntryOffset(
   return result;
 }
 
+base::expected<uint32_t, NullOrIOError> LoadedPackage::GetEntryOffset(
+    const TypeSpec::TypeEntry& type_entry, uint16_t entry_index) {
+  if (type_entry.sparse_index == nullptr) {
+    return GetEntryOffset(type_entry.type, entry_index);
+  }
+
+  const std::optional<uint32_t> position = type_entry.sparse_index->Find(entry_index);
+  if (!position.has_value()) {
+    return base::unexpected(std::nullopt);
+  }
+  const auto& type_chunk = type_entry.type;
+  const auto entry = type_chunk.offset(dtohs(type_chunk->header.headerSize))
+                         .convert<ResTable_sparseTypeEntry>() + *position;
+  if (UNLIKELY(!entry)) {
+    return base::unexpected(IOError::PAGES_MISSING);
+  }
+  return uint32_t{dtohs(entry->offset)} * 4u;
+}
+
 base::expected<incfs::verified_map_ptr<ResTable_entry>, NullOrIOError>
 LoadedPackage::GetEntryFromOffset(incfs::verified_map_ptr<ResTable_type> type_chunk,
                                   uint32_t offset) {
@@ -794,6 +820,11 @@ std::unique_ptr<const LoadedPackage> LoadedPackage::Load(const Chunk& chunk,
   // Flatten and construct the TypeSpecs.
   for (auto& entry : type_builder_map) {
     TypeSpec type_spec = entry.second->Build();
+    for (const auto& type_entry : type_spec.type_entries) {
+      if (type_entry.sparse_index != nullptr) {
+        loaded_package->sparse_entry_index_bytes_ += type_entry.sparse_index->GetMemoryUsage();
+      }
+    }
     uint8_t type_id = static_cast<uint8_t>(entry.first);
     loaded_package->type_specs_[type_id] = std::move(type_spec);
   }
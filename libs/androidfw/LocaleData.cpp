@@ -94,21 +94,60 @@ size_t findAncestors(uint32_t* out, ssize_t* stop_list_index,
     return count;
 }
 
-size_t findDistance(uint32_t supported,
-                    const char* script,
-                    const uint32_t* request_ancestors,
-                    size_t request_ancestors_count) {
-    ssize_t request_ancestors_index;
-    const size_t supported_ancestor_count = findAncestors(
-            nullptr, &request_ancestors_index,
-            supported, script,
-            request_ancestors, request_ancestors_count);
-    // Since both locales share the same root, there will always be a shared
-    // ancestor, so the distance in the parent tree is the sum of the distance
-    // of 'supported' to the lowest common ancestor (number of ancestors
-    // written for 'supported' minus 1) plus the distance of 'request' to the
-    // lowest common ancestor (the index of the ancestor in request_ancestors).
-    return supported_ancestor_count + request_ancestors_index - 1;
+// The ancestors of a locale in a given script, starting with the locale itself.
+struct LocaleChain {
+    uint32_t ancestors[MAX_PARENT_DEPTH+1];
+    size_t count;
+
+    // Returns the rank of 'locale' in the chain, or -1 if it is not an ancestor.
+    inline ssize_t rankOf(uint32_t locale) const {
+        for (size_t i = 0; i < count; i++) {
+            if (ancestors[i] == locale) {
+                return (ssize_t) i;
+            }
+        }
+        return -1;
+    }
+};
+
+// Region comparisons of a configuration set spanning a few locales keep walking the parents of
+// the same handful of locales, so the chains are cached per thread. The cache is dropped when it
+// grows past MAX_CACHED_CHAINS to bound its size if many different locales are compared.
+const size_t MAX_CACHED_CHAINS = 64;
+
+LocaleChain findChain(uint32_t packed_locale, const char* script) {
+    thread_local std::unordered_map<uint64_t, LocaleChain> chains;
+    const uint64_t key = (((uint64_t) packed_locale) << 32u) |
+            (((uint64_t) (uint8_t) script[0]) << 24u) |
+            (((uint64_t) (uint8_t) script[1]) << 16u) |
+            (((uint64_t) (uint8_t) script[2]) <<  8u) |
+            ((uint64_t) (uint8_t) script[3]);
+    auto lookup_result = chains.find(key);
+    if (lookup_result != chains.end()) {
+        return lookup_result->second;
+    }
+    if (chains.size() >= MAX_CACHED_CHAINS) {
+        chains.clear();
+    }
+    LocaleChain& chain = chains[key];
+    ssize_t stop_list_index;
+    chain.count = findAncestors(chain.ancestors, &stop_list_index, packed_locale, script,
+                                nullptr, 0);
+    return chain;
+}
+
+// Since both locales share the same root, there will always be a shared
+// ancestor, so the distance in the parent tree is the sum of the distance
+// of 'supported' to the lowest common ancestor plus the distance of
+// 'request' to the lowest common ancestor.
+size_t findChainDistance(const LocaleChain& supported, const LocaleChain& request) {
+    for (size_t i = 0; i < supported.count; i++) {
+        const ssize_t request_index = request.rankOf(supported.ancestors[i]);
+        if (request_index >= 0) {
+            return i + request_index;
+        }
+    }
+    return supported.count - 2;
 }
 
 inline bool isRepresentative(uint32_t language_and_region, const char* script) {
@@ -156,29 +195,26 @@ int localeDataCompareRegions(
         right = LATIN_AMERICAN_SPANISH;
     }
 
-    uint32_t request_ancestors[MAX_PARENT_DEPTH+1];
-    ssize_t left_right_index;
-    // Find the parents of the request, but stop as soon as we saw left or right
-    const std::array<uint32_t, 2> left_and_right = {{left, right}};
-    const size_t ancestor_count = findAncestors(
-            request_ancestors, &left_right_index,
-            request, requested_script,
-            left_and_right.data(), left_and_right.size());
-    if (left_right_index == 0) { // We saw left earlier
+    // Compare the ranks of left and right in the parents of the request. The
+    // one that shows up first is the better match.
+    const LocaleChain request_chain = findChain(request, requested_script);
+    const ssize_t left_rank = request_chain.rankOf(left);
+    const ssize_t right_rank = request_chain.rankOf(right);
+    if (left_rank >= 0 && (right_rank < 0 || left_rank < right_rank)) { // We saw left earlier
         return 1;
     }
-    if (left_right_index == 1) { // We saw right earlier
+    if (right_rank >= 0) { // We saw right earlier
         return -1;
     }
 
     // If we are here, neither left nor right are an ancestor of the
-    // request. This means that all the ancestors have been computed and
-    // the last ancestor is just the language by itself. We will use the
-    // distance in the parent tree for determining the better match.
-    const size_t left_distance = findDistance(
-            left, requested_script, request_ancestors, ancestor_count);
-    const size_t right_distance = findDistance(
-            right, requested_script, request_ancestors, ancestor_count);
+    // request. The last ancestor of the request is just the language by
+    // itself. We will use the distance in the parent tree for determining
+    // the better match.
+    const size_t left_distance = findChainDistance(
+            findChain(left, requested_script), request_chain);
+    const size_t right_distance = findChainDistance(
+            findChain(right, requested_script), request_chain);
     if (left_distance != right_distance) {
         return (int) right_distance - (int) left_distance; // smaller distance is better
     }
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "androidfw/PackedConfig.h"
+
+namespace android {
+
+namespace {
+
+enum Lane : size_t {
+  kLaneMcc,
+  kLaneMnc,
+  kLaneLanguage,
+  kLaneGrammaticalInflection,
+  kLaneLayoutDir,
+  kLaneScreenLayoutSize,
+  kLaneScreenLong,
+  kLaneUiModeType,
+  kLaneUiModeNight,
+  kLaneSmallestScreenWidthDp,
+  kLaneScreenRound,
+  kLaneHdr,
+  kLaneWideColorGamut,
+  kLaneScreenWidthDp,
+  kLaneScreenHeightDp,
+  kLaneOrientation,
+  kLaneTouchscreen,
+  kLaneKeysHidden,
+  kLaneNavHidden,
+  kLaneKeyboard,
+  kLaneNavigation,
+  kLaneScreenWidth,
+  kLaneScreenHeight,
+  kLaneSdkVersion,
+  kLaneMinorVersion,
+  kLaneUsedCount,
+};
+
+static_assert(kLaneUsedCount <= PackedConfig::kLaneCount);
+
+constexpr uint16_t kAnyValue = 0xffff;
+
+// "fil" and "tl" are equivalent languages (see langsAreEquivalent() in ResourceTypes.cpp), so both
+// pack to the value of "tl".
+uint16_t PackLanguage(const char language[2]) {
+  const auto packed = static_cast<uint16_t>((static_cast<uint8_t>(language[0]) << 8) |
+                                            static_cast<uint8_t>(language[1]));
+  constexpr uint16_t kFilipino = 0xad05;
+  constexpr uint16_t kTagalog = ('t' << 8) | 'l';
+  return packed == kFilipino ? kTagalog : packed;
+}
+
+// KEYSHIDDEN_NO also matches a request for KEYSHIDDEN_SOFT, so the two are made adjacent.
+uint16_t PackKeysHidden(uint8_t input_flags) {
+  static constexpr uint16_t kOrder[] = {
+      0U,  // KEYSHIDDEN_ANY
+      1U,  // KEYSHIDDEN_NO
+      3U,  // KEYSHIDDEN_YES
+      2U,  // KEYSHIDDEN_SOFT
+  };
+  return kOrder[input_flags & ResTable_config::MASK_KEYSHIDDEN];
+}
+
+template <typename Fn>
+void ForEachLane(const ResTable_config& c, Fn&& fn) {
+  fn(kLaneMcc, c.mcc);
+  fn(kLaneMnc, c.mnc);
+  fn(kLaneGrammaticalInflection, c.grammaticalInflection);
+  fn(kLaneLayoutDir, c.screenLayout & ResTable_config::MASK_LAYOUTDIR);
+  fn(kLaneScreenLayoutSize, c.screenLayout & ResTable_config::MASK_SCREENSIZE);
+  fn(kLaneScreenLong, c.screenLayout & ResTable_config::MASK_SCREENLONG);
+  fn(kLaneUiModeType, c.uiMode & ResTable_config::MASK_UI_MODE_TYPE);
+  fn(kLaneUiModeNight, c.uiMode & ResTable_config::MASK_UI_MODE_NIGHT);
+  fn(kLaneSmallestScreenWidthDp, c.smallestScreenWidthDp);
+  fn(kLaneScreenRound, c.screenLayout2 & ResTable_config::MASK_SCREENROUND);
+  fn(kLaneHdr, c.colorMode & ResTable_config::MASK_HDR);
+  fn(kLaneWideColorGamut, c.colorMode & ResTable_config::MASK_WIDE_COLOR_GAMUT);
+  fn(kLaneScreenWidthDp, c.screenWidthDp);
+  fn(kLaneScreenHeightDp, c.screenHeightDp);
+  fn(kLaneOrientation, c.orientation);
+  fn(kLaneTouchscreen, c.touchscreen);
+  fn(kLaneKeysHidden, PackKeysHidden(c.inputFlags));
+  fn(kLaneNavHidden, c.inputFlags & ResTable_config::MASK_NAVHIDDEN);
+  fn(kLaneKeyboard, c.keyboard);
+  fn(kLaneNavigation, c.navigation);
+  fn(kLaneScreenWidth, c.screenWidth);
+  fn(kLaneScreenHeight, c.screenHeight);
+  fn(kLaneSdkVersion, c.sdkVersion);
+  fn(kLaneMinorVersion, c.minorVersion);
+}
+
+// Lanes where the resource value must not be larger than the requested one. All others must be
+// equal.
+bool IsUpperBoundLane(size_t lane) {
+  switch (lane) {
+    case kLaneScreenLayoutSize:
+    case kLaneSmallestScreenWidthDp:
+    case kLaneScreenWidthDp:
+    case kLaneScreenHeightDp:
+    case kLaneScreenWidth:
+    case kLaneScreenHeight:
+    case kLaneSdkVersion:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+PackedConfig PackedConfig::FromSettings(const ResTable_config& settings) {
+  PackedConfig packed;
+  ForEachLane(settings, [&](size_t lane, uint16_t value) { packed.lanes[lane] = value; });
+  packed.lanes[kLaneLanguage] = PackLanguage(settings.language);
+  return packed;
+}
+
+PackedConfigRange PackedConfigRange::FromConfig(const ResTable_config& config) {
+  PackedConfigRange range;
+  for (size_t i = 0; i < PackedConfig::kLaneCount; i++) {
+    range.max[i] = kAnyValue;
+  }
+
+  ForEachLane(config, [&](size_t lane, uint16_t value) {
+    if (value == 0) {
+      // Unset qualifiers match anything.
+      return;
+    }
+    range.min[lane] = value;
+    if (!IsUpperBoundLane(lane)) {
+      range.max[lane] = value;
+    }
+  });
+
+  if ((config.inputFlags & ResTable_config::MASK_KEYSHIDDEN) == ResTable_config::KEYSHIDDEN_NO) {
+    range.max[kLaneKeysHidden] = PackKeysHidden(ResTable_config::KEYSHIDDEN_SOFT);
+  }
+
+  if (config.locale != 0) {
+    // A locale without a language only matches requests without a language.
+    range.min[kLaneLanguage] = range.max[kLaneLanguage] = PackLanguage(config.language);
+    range.needs_full_match = true;
+  }
+  return range;
+}
+
+}  // namespace android
@@ -18,8 +18,14 @@
 #include <zlib.h>
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "android-base/errors.h"
 #include "android-base/logging.h"
@@ -471,6 +477,409 @@ static void WriteNinePatch(png_structp write_ptr, png_infop write_info_ptr,
   png_set_unknown_chunks(write_ptr, write_info_ptr, unknown_chunks, index);
 }
 
+// The most colors a PNG palette can hold.
+constexpr size_t kMaxPaletteSize = 256;
+
+// Images with more filtered image data than this are filtered and compressed here instead of by
+// libpng, in segments of about this size that are compressed independently.
+constexpr size_t kSegmentSize = 1024 * 1024;
+
+// The size of the deflate window, and of the dictionary each segment is primed with.
+constexpr size_t kDeflateWindowSize = 32 * 1024;
+
+// The size of the IDAT chunks, libpng's default.
+constexpr size_t kIdatChunkSize = 8192;
+
+struct RowStats {
+  int max_gray_deviation = 0;
+  bool has_alpha = false;
+  bool has_transparent_color = false;
+};
+
+// Scans a row of RGBA pixels, treating transparent pixels as 0x00000000. The loop has no early
+// exits or data dependent branches, so that the compiler can vectorize it.
+static RowStats AnalyzeRow(const uint8_t* row, int32_t width) {
+  uint8_t max_gray_deviation = 0;
+  uint8_t min_alpha = 0xff;
+  uint8_t transparent_color = 0;
+  for (int32_t x = 0; x < width; x++) {
+    const uint8_t* pixel = row + x * 4;
+    const uint8_t alpha = pixel[3];
+    const uint8_t mask = alpha == 0 ? 0x00 : 0xff;
+    const uint8_t red = pixel[0] & mask;
+    const uint8_t green = pixel[1] & mask;
+    const uint8_t blue = pixel[2] & mask;
+    transparent_color |= (pixel[0] | pixel[1] | pixel[2]) & ~mask;
+
+    // The largest difference between any two channels.
+    const uint8_t max_channel = std::max(red, std::max(green, blue));
+    const uint8_t min_channel = std::min(red, std::min(green, blue));
+    max_gray_deviation = std::max<uint8_t>(max_gray_deviation, max_channel - min_channel);
+    min_alpha = std::min(min_alpha, alpha);
+  }
+
+  RowStats stats;
+  stats.max_gray_deviation = max_gray_deviation;
+  stats.has_alpha = min_alpha != 0xff;
+  stats.has_transparent_color = transparent_color != 0;
+  return stats;
+}
+
+static inline uint32_t GetPixelColor(const uint8_t* pixel) {
+  if (pixel[3] == 0) {
+    // For purposes of palettes, treat all channels of transparent colors as 0x00.
+    return 0;
+  }
+  return pixel[0] << 24 | pixel[1] << 16 | pixel[2] << 8 | pixel[3];
+}
+
+// Adds the colors of a row to the color palette, and the non-opaque ones to the alpha palette.
+// Returns false as soon as there are more colors than fit in a palette, after which the palettes
+// are incomplete.
+static bool CollectPaletteColors(const uint8_t* row, int32_t width,
+                                 std::unordered_map<uint32_t, int>* color_palette,
+                                 std::unordered_set<uint32_t>* alpha_palette) {
+  // Neighbouring pixels often have the same color, skip the lookups for them.
+  bool has_last_color = false;
+  uint32_t last_color = 0;
+  for (int32_t x = 0; x < width; x++) {
+    const uint32_t color = GetPixelColor(row + x * 4);
+    if (has_last_color && color == last_color) {
+      continue;
+    }
+    has_last_color = true;
+    last_color = color;
+
+    if (color_palette->emplace(color, -1).second) {
+      if ((color & 0xff) != 0xff) {
+        alpha_palette->insert(color);
+      }
+      if (color_palette->size() > kMaxPaletteSize) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static size_t GetBytesPerPixel(int color_type) {
+  switch (color_type) {
+    case PNG_COLOR_TYPE_PALETTE:
+    case PNG_COLOR_TYPE_GRAY:
+      return 1;
+    case PNG_COLOR_TYPE_GRAY_ALPHA:
+      return 2;
+    case PNG_COLOR_TYPE_RGB:
+      return 3;
+    default:
+      return 4;
+  }
+}
+
+// Converts a row of RGBA pixels to the encoding of color_type, zeroing out the color channels of
+// transparent pixels.
+static void ConvertRow(const uint8_t* in_row, int32_t width, int color_type, bool grayscale,
+                       const std::unordered_map<uint32_t, int>& color_palette, png_bytep out_row) {
+  if (color_type == PNG_COLOR_TYPE_PALETTE) {
+    // 1 byte/pixel.
+    bool has_last_color = false;
+    uint32_t last_color = 0;
+    png_byte last_index = 0;
+    for (int32_t x = 0; x < width; x++) {
+      const uint32_t color = GetPixelColor(in_row + x * 4);
+      if (!has_last_color || color != last_color) {
+        auto iter = color_palette.find(color);
+        CHECK(iter != color_palette.end() && iter->second != -1);
+        has_last_color = true;
+        last_color = color;
+        last_index = static_cast<png_byte>(iter->second);
+      }
+      out_row[x] = last_index;
+    }
+  } else if (color_type == PNG_COLOR_TYPE_GRAY || color_type == PNG_COLOR_TYPE_GRAY_ALPHA) {
+    const size_t bpp = color_type == PNG_COLOR_TYPE_GRAY ? 1 : 2;
+    for (int32_t x = 0; x < width; x++) {
+      int rr = in_row[x * 4];
+      int gg = in_row[x * 4 + 1];
+      int bb = in_row[x * 4 + 2];
+      int aa = in_row[x * 4 + 3];
+      if (aa == 0) {
+        // Zero out the gray channel when transparent.
+        rr = gg = bb = 0;
+      }
+
+      if (grayscale) {
+        // The image was already grayscale, red == green == blue.
+        out_row[x * bpp] = rr;
+      } else {
+        // The image is convertible to grayscale, use linear-luminance of
+        // sRGB colorspace:
+        // https://en.wikipedia.org/wiki/Grayscale#Colorimetric_.28luminance-preserving.29_conversion_to_grayscale
+        out_row[x * bpp] = (png_byte)(rr * 0.2126f + gg * 0.7152f + bb * 0.0722f);
+      }
+
+      if (bpp == 2) {
+        // Write out alpha if we have it.
+        out_row[x * bpp + 1] = aa;
+      }
+    }
+  } else {
+    const size_t bpp = color_type == PNG_COLOR_TYPE_RGB ? 3 : 4;
+    for (int32_t x = 0; x < width; x++) {
+      const uint8_t* pixel = in_row + x * 4;
+      const uint8_t mask = pixel[3] == 0 ? 0x00 : 0xff;
+      out_row[x * bpp] = pixel[0] & mask;
+      out_row[x * bpp + 1] = pixel[1] & mask;
+      out_row[x * bpp + 2] = pixel[2] & mask;
+      if (bpp == 4) {
+        out_row[x * bpp + 3] = pixel[3];
+      }
+    }
+  }
+}
+
+// The cost libpng assigns to a filtered row: the sum of its bytes' absolute values when they are
+// read as signed.
+static size_t GetFilteredRowCost(const uint8_t* row, size_t row_bytes) {
+  size_t sum = 0;
+  for (size_t i = 0; i < row_bytes; i++) {
+    const uint8_t v = row[i];
+    sum += v < 128 ? v : 256 - v;
+  }
+  return sum;
+}
+
+// Filters a row of `bpp` bytes per pixel with the filter libpng's heuristic would pick, the one
+// with the lowest cost, preferring the earlier filters on ties. Writes the filter type followed
+// by the filtered bytes to out. prev_row holds the previous unfiltered row, zeros for the first
+// row. scratch must hold row_bytes bytes.
+//
+// Each filter is computed by its own loop over whole rows without data dependent branches, so
+// that the compiler can vectorize them.
+static void FilterRow(const uint8_t* row, const uint8_t* prev_row, size_t row_bytes, size_t bpp,
+                      uint8_t filters, uint8_t* scratch, uint8_t* out) {
+  out[0] = PNG_FILTER_VALUE_NONE;
+  memcpy(out + 1, row, row_bytes);
+  if (filters == PNG_FILTER_NONE) {
+    return;
+  }
+
+  size_t min_cost = (filters & PNG_FILTER_NONE) ? GetFilteredRowCost(row, row_bytes) : SIZE_MAX;
+  auto try_filter = [&](uint8_t filter, png_byte filter_value) {
+    if ((filters & filter) == 0) {
+      return;
+    }
+    const size_t cost = GetFilteredRowCost(scratch, row_bytes);
+    if (cost < min_cost) {
+      min_cost = cost;
+      out[0] = filter_value;
+      memcpy(out + 1, scratch, row_bytes);
+    }
+  };
+
+  const size_t lead = std::min(bpp, row_bytes);
+  if (filters & PNG_FILTER_SUB) {
+    for (size_t i = 0; i < lead; i++) {
+      scratch[i] = row[i];
+    }
+    for (size_t i = lead; i < row_bytes; i++) {
+      scratch[i] = row[i] - row[i - bpp];
+    }
+    try_filter(PNG_FILTER_SUB, PNG_FILTER_VALUE_SUB);
+  }
+
+  if (filters & PNG_FILTER_UP) {
+    for (size_t i = 0; i < row_bytes; i++) {
+      scratch[i] = row[i] - prev_row[i];
+    }
+    try_filter(PNG_FILTER_UP, PNG_FILTER_VALUE_UP);
+  }
+
+  if (filters & PNG_FILTER_AVG) {
+    for (size_t i = 0; i < lead; i++) {
+      scratch[i] = row[i] - (prev_row[i] >> 1);
+    }
+    for (size_t i = lead; i < row_bytes; i++) {
+      scratch[i] = row[i] - ((row[i - bpp] + prev_row[i]) >> 1);
+    }
+    try_filter(PNG_FILTER_AVG, PNG_FILTER_VALUE_AVG);
+  }
+
+  if (filters & PNG_FILTER_PAETH) {
+    for (size_t i = 0; i < lead; i++) {
+      // With no left or upper-left neighbour, the Paeth predictor is the upper neighbour.
+      scratch[i] = row[i] - prev_row[i];
+    }
+    for (size_t i = lead; i < row_bytes; i++) {
+      const int a = row[i - bpp];
+      const int b = prev_row[i];
+      const int c = prev_row[i - bpp];
+      const int pa = std::abs(b - c);
+      const int pb = std::abs(a - c);
+      const int pc = std::abs(a + b - 2 * c);
+      const int predictor = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+      scratch[i] = row[i] - predictor;
+    }
+    try_filter(PNG_FILTER_PAETH, PNG_FILTER_VALUE_PAETH);
+  }
+}
+
+// Runs fn(i) for every i in [0, count) on up to thread_count threads, the calling one included.
+static void ParallelFor(size_t count, size_t thread_count, const std::function<void(size_t)>& fn) {
+  thread_count = std::min(thread_count, count);
+  if (thread_count <= 1) {
+    for (size_t i = 0; i < count; i++) {
+      fn(i);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next_index = 0;
+  auto worker = [&]() {
+    for (size_t i = next_index++; i < count; i = next_index++) {
+      fn(i);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count; i++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+struct Segment {
+  size_t first_row;
+  size_t row_count;
+  uint32_t adler;
+  std::vector<uint8_t> deflated;
+};
+
+// Deflates a segment of the filtered image data, primed with the tail of the data before it.
+// Every segment but the last ends on a byte boundary without a final block, so that the segments
+// concatenate into a single deflate stream.
+static bool DeflateSegment(const uint8_t* data, size_t offset, size_t size, bool last,
+                           int strategy, Segment* segment) {
+  segment->adler = adler32(1, data + offset, size);
+
+  z_stream stream = {};
+  if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, strategy) != Z_OK) {
+    return false;
+  }
+  if (offset > 0) {
+    const size_t dictionary_size = std::min(kDeflateWindowSize, offset);
+    deflateSetDictionary(&stream, data + offset - dictionary_size, dictionary_size);
+  }
+
+  segment->deflated.resize(deflateBound(&stream, size) + 16);
+  stream.next_in = const_cast<uint8_t*>(data + offset);
+  stream.avail_in = size;
+  stream.next_out = segment->deflated.data();
+  stream.avail_out = segment->deflated.size();
+
+  int result;
+  while (true) {
+    result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+    if (result == Z_STREAM_ERROR || (last && result == Z_STREAM_END) ||
+        (!last && stream.avail_in == 0 && stream.avail_out != 0)) {
+      break;
+    }
+    const size_t used = segment->deflated.size() - stream.avail_out;
+    segment->deflated.resize(segment->deflated.size() * 2);
+    stream.next_out = segment->deflated.data() + used;
+    stream.avail_out = segment->deflated.size() - used;
+  }
+  segment->deflated.resize(segment->deflated.size() - stream.avail_out);
+  deflateEnd(&stream);
+  return result != Z_STREAM_ERROR;
+}
+
+// Filters and compresses the image data like libpng would, but in segments that are processed
+// in parallel, then writes the IDAT and IEND chunks. The output only depends on the image, not
+// on the number of threads.
+static bool WriteSegmentedImageData(png_structp write_ptr, const Image* image, int color_type,
+                                    bool grayscale,
+                                    const std::unordered_map<uint32_t, int>& color_palette,
+                                    size_t rows_per_segment, size_t thread_count) {
+  const size_t bpp = GetBytesPerPixel(color_type);
+  const size_t row_bytes = bpp * image->width;
+  const size_t filtered_row_bytes = row_bytes + 1;
+  const size_t height = image->height;
+
+  // Palette images are not filtered. The filters libpng skips for single pixel wide images would
+  // be the same as filtering with None or Up.
+  uint8_t filters = PNG_ALL_FILTERS;
+  if (color_type == PNG_COLOR_TYPE_PALETTE) {
+    filters = PNG_FILTER_NONE;
+  } else if (image->width == 1) {
+    filters &= ~(PNG_FILTER_SUB | PNG_FILTER_AVG | PNG_FILTER_PAETH);
+  }
+
+  std::vector<Segment> segments;
+  for (size_t row = 0; row < height; row += rows_per_segment) {
+    segments.push_back(Segment{row, std::min(rows_per_segment, height - row), 0, {}});
+  }
+
+  std::vector<uint8_t> filtered(filtered_row_bytes * height);
+  ParallelFor(segments.size(), thread_count, [&](size_t index) {
+    const Segment& segment = segments[index];
+    std::vector<uint8_t> prev_row(row_bytes, 0);
+    std::vector<uint8_t> row(row_bytes);
+    std::vector<uint8_t> scratch(row_bytes);
+    if (segment.first_row > 0) {
+      ConvertRow(image->rows[segment.first_row - 1], image->width, color_type, grayscale,
+                 color_palette, prev_row.data());
+    }
+    for (size_t y = segment.first_row; y < segment.first_row + segment.row_count; y++) {
+      ConvertRow(image->rows[y], image->width, color_type, grayscale, color_palette, row.data());
+      FilterRow(row.data(), prev_row.data(), row_bytes, bpp, filters, scratch.data(),
+                filtered.data() + y * filtered_row_bytes);
+      std::swap(row, prev_row);
+    }
+  });
+
+  // libpng uses the same settings.
+  const int strategy = filters == PNG_FILTER_NONE ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+  std::atomic<bool> deflated = true;
+  ParallelFor(segments.size(), thread_count, [&](size_t index) {
+    Segment* segment = &segments[index];
+    if (!DeflateSegment(filtered.data(), segment->first_row * filtered_row_bytes,
+                        segment->row_count * filtered_row_bytes, index + 1 == segments.size(),
+                        strategy, segment)) {
+      deflated = false;
+    }
+  });
+  if (!deflated) {
+    return false;
+  }
+
+  // Wrap the deflate stream in a zlib stream: a header for a 32K window at the best compression
+  // level, and the Adler-32 checksum of the uncompressed data.
+  std::vector<uint8_t> stream = {0x78, 0xda};
+  uint32_t adler = 1;
+  for (const Segment& segment : segments) {
+    stream.insert(stream.end(), segment.deflated.begin(), segment.deflated.end());
+    adler = adler32_combine(adler, segment.adler, segment.row_count * filtered_row_bytes);
+  }
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    stream.push_back(static_cast<uint8_t>(adler >> shift));
+  }
+
+  static const png_byte kIdat[5] = {'I', 'D', 'A', 'T', '\0'};
+  static const png_byte kIend[5] = {'I', 'E', 'N', 'D', '\0'};
+  for (size_t offset = 0; offset < stream.size(); offset += kIdatChunkSize) {
+    png_write_chunk(write_ptr, kIdat, stream.data() + offset,
+                    std::min(kIdatChunkSize, stream.size() - offset));
+  }
+
+  // png_write_end() refuses to run without the IDAT chunks it writes itself, and there is nothing
+  // else it would write after them.
+  png_write_chunk(write_ptr, kIend, nullptr, 0);
+  return true;
+}
+
 bool WritePng(const Image* image, const NinePatch* nine_patch, OutputStream* out,
               const PngOptions& options, IDiagnostics* diag, bool verbose) {
   // Create and initialize the write png_struct with the default error and
@@ -517,55 +926,37 @@ bool WritePng(const Image* image, const NinePatch* nine_patch, OutputStream* out
   std::unordered_map<uint32_t, int> color_palette;
   std::unordered_set<uint32_t> alpha_palette;
   bool needs_to_zero_rgb_channels_of_transparent_pixels = false;
-  bool grayscale = true;
+  bool has_alpha = false;
   int max_gray_deviation = 0;
 
+  // The palettes are only complete while they fit in a PNG palette. Once they no longer do, the
+  // remaining colors are not collected.
+  bool palette_overflowed = false;
+
   for (int32_t y = 0; y < image->height; y++) {
     const uint8_t* row = image->rows[y];
-    for (int32_t x = 0; x < image->width; x++) {
-      int red = *row++;
-      int green = *row++;
-      int blue = *row++;
-      int alpha = *row++;
-
-      if (alpha == 0) {
-        // The color is completely transparent.
-        // For purposes of palettes and grayscale optimization,
-        // treat all channels as 0x00.
-        needs_to_zero_rgb_channels_of_transparent_pixels =
-            needs_to_zero_rgb_channels_of_transparent_pixels ||
-            (red != 0 || green != 0 || blue != 0);
-        red = green = blue = 0;
-      }
-
-      // Insert the color into the color palette.
-      const uint32_t color = red << 24 | green << 16 | blue << 8 | alpha;
-      color_palette[color] = -1;
-
-      // If the pixel has non-opaque alpha, insert it into the
-      // alpha palette.
-      if (alpha != 0xff) {
-        alpha_palette.insert(color);
-      }
-
-      // Check if the image is indeed grayscale.
-      if (grayscale) {
-        if (red != green || red != blue) {
-          grayscale = false;
-        }
-      }
-
-      // Calculate the gray scale deviation so that it can be compared
-      // with the threshold.
-      max_gray_deviation = std::max(std::abs(red - green), max_gray_deviation);
-      max_gray_deviation = std::max(std::abs(green - blue), max_gray_deviation);
-      max_gray_deviation = std::max(std::abs(blue - red), max_gray_deviation);
+    const RowStats stats = AnalyzeRow(row, image->width);
+    max_gray_deviation = std::max(stats.max_gray_deviation, max_gray_deviation);
+    has_alpha = has_alpha || stats.has_alpha;
+    needs_to_zero_rgb_channels_of_transparent_pixels =
+        needs_to_zero_rgb_channels_of_transparent_pixels || stats.has_transparent_color;
+
+    if (!palette_overflowed) {
+      palette_overflowed = !CollectPaletteColors(row, image->width, &color_palette, &alpha_palette);
     }
   }
 
+  // Every pixel has R == G == B.
+  const bool grayscale = max_gray_deviation == 0;
+
+  // Past the palette limit, only whether the palettes are too large or empty matters.
+  const size_t color_palette_size = palette_overflowed ? kMaxPaletteSize + 1 : color_palette.size();
+  const size_t alpha_palette_size =
+      palette_overflowed ? (has_alpha ? kMaxPaletteSize + 1 : 0) : alpha_palette.size();
+
   if (verbose) {
     android::DiagMessage msg;
-    msg << " paletteSize=" << color_palette.size() << " alphaPaletteSize=" << alpha_palette.size()
+    msg << " paletteSize=" << color_palette_size << " alphaPaletteSize=" << alpha_palette_size
         << " maxGrayDeviation=" << max_gray_deviation
         << " grayScale=" << (grayscale ? "true" : "false");
     diag->Note(msg);
@@ -575,7 +966,7 @@ bool WritePng(const Image* image, const NinePatch* nine_patch, OutputStream* out
 
   const int new_color_type =
       PickColorType(image->width, image->height, grayscale, convertible_to_grayscale,
-                    nine_patch != nullptr, color_palette.size(), alpha_palette.size());
+                    nine_patch != nullptr, color_palette_size, alpha_palette_size);
 
   if (verbose) {
     android::DiagMessage msg;
@@ -625,102 +1016,32 @@ bool WritePng(const Image* image, const NinePatch* nine_patch, OutputStream* out
   // Flush our updates to the header.
   png_write_info(write_ptr, write_info_ptr);
 
-  // Write out each row of image data according to its encoding.
-  if (new_color_type == PNG_COLOR_TYPE_PALETTE) {
-    // 1 byte/pixel.
-    auto out_row = std::unique_ptr<png_byte[]>(new png_byte[image->width]);
-
-    for (int32_t y = 0; y < image->height; y++) {
-      png_const_bytep in_row = image->rows[y];
-      for (int32_t x = 0; x < image->width; x++) {
-        int rr = *in_row++;
-        int gg = *in_row++;
-        int bb = *in_row++;
-        int aa = *in_row++;
-        if (aa == 0) {
-          // Zero out color channels when transparent.
-          rr = gg = bb = 0;
-        }
+  // Large images are filtered and compressed in parallel segments.
+  const size_t filtered_row_bytes = GetBytesPerPixel(new_color_type) * image->width + 1;
+  const size_t rows_per_segment = std::max<size_t>(1, kSegmentSize / filtered_row_bytes);
+  if (static_cast<size_t>(image->height) > rows_per_segment) {
+    return WriteSegmentedImageData(write_ptr, image, new_color_type, grayscale, color_palette,
+                                   rows_per_segment, options.threads);
+  }
 
-        const uint32_t color = rr << 24 | gg << 16 | bb << 8 | aa;
-        const int idx = color_palette[color];
-        CHECK(idx != -1);
-        out_row[x] = static_cast<png_byte>(idx);
-      }
-      png_write_row(write_ptr, out_row.get());
+  // Write out each row of image data according to its encoding.
+  if ((new_color_type == PNG_COLOR_TYPE_RGB || new_color_type == PNG_COLOR_TYPE_RGBA) &&
+      !needs_to_zero_rgb_channels_of_transparent_pixels) {
+    // The source image can be used as-is, just tell libpng whether or not to
+    // ignore the alpha channel.
+    if (new_color_type == PNG_COLOR_TYPE_RGB) {
+      // Delete the extraneous alpha values that we appended to our buffer
+      // when reading the original values.
+      png_set_filler(write_ptr, 0, PNG_FILLER_AFTER);
     }
-  } else if (new_color_type == PNG_COLOR_TYPE_GRAY || new_color_type == PNG_COLOR_TYPE_GRAY_ALPHA) {
-    const size_t bpp = new_color_type == PNG_COLOR_TYPE_GRAY ? 1 : 2;
-    auto out_row = std::unique_ptr<png_byte[]>(new png_byte[image->width * bpp]);
-
+    png_write_image(write_ptr, image->rows.get());
+  } else {
+    auto out_row = std::unique_ptr<png_byte[]>(new png_byte[filtered_row_bytes - 1]);
     for (int32_t y = 0; y < image->height; y++) {
-      png_const_bytep in_row = image->rows[y];
-      for (int32_t x = 0; x < image->width; x++) {
-        int rr = in_row[x * 4];
-        int gg = in_row[x * 4 + 1];
-        int bb = in_row[x * 4 + 2];
-        int aa = in_row[x * 4 + 3];
-        if (aa == 0) {
-          // Zero out the gray channel when transparent.
-          rr = gg = bb = 0;
-        }
-
-        if (grayscale) {
-          // The image was already grayscale, red == green == blue.
-          out_row[x * bpp] = in_row[x * 4];
-        } else {
-          // The image is convertible to grayscale, use linear-luminance of
-          // sRGB colorspace:
-          // https://en.wikipedia.org/wiki/Grayscale#Colorimetric_.28luminance-preserving.29_conversion_to_grayscale
-          out_row[x * bpp] = (png_byte)(rr * 0.2126f + gg * 0.7152f + bb * 0.0722f);
-        }
-
-        if (bpp == 2) {
-          // Write out alpha if we have it.
-          out_row[x * bpp + 1] = aa;
-        }
-      }
+      ConvertRow(image->rows[y], image->width, new_color_type, grayscale, color_palette,
+                 out_row.get());
       png_write_row(write_ptr, out_row.get());
     }
-  } else if (new_color_type == PNG_COLOR_TYPE_RGB || new_color_type == PNG_COLOR_TYPE_RGBA) {
-    const size_t bpp = new_color_type == PNG_COLOR_TYPE_RGB ? 3 : 4;
-    if (needs_to_zero_rgb_channels_of_transparent_pixels) {
-      // The source RGBA data can't be used as-is, because we need to zero out
-      // the RGB values of transparent pixels.
-      auto out_row = std::unique_ptr<png_byte[]>(new png_byte[image->width * bpp]);
-
-      for (int32_t y = 0; y < image->height; y++) {
-        png_const_bytep in_row = image->rows[y];
-        for (int32_t x = 0; x < image->width; x++) {
-          int rr = *in_row++;
-          int gg = *in_row++;
-          int bb = *in_row++;
-          int aa = *in_row++;
-          if (aa == 0) {
-            // Zero out the RGB channels when transparent.
-            rr = gg = bb = 0;
-          }
-          out_row[x * bpp] = rr;
-          out_row[x * bpp + 1] = gg;
-          out_row[x * bpp + 2] = bb;
-          if (bpp == 4) {
-            out_row[x * bpp + 3] = aa;
-          }
-        }
-        png_write_row(write_ptr, out_row.get());
-      }
-    } else {
-      // The source image can be used as-is, just tell libpng whether or not to
-      // ignore the alpha channel.
-      if (new_color_type == PNG_COLOR_TYPE_RGB) {
-        // Delete the extraneous alpha values that we appended to our buffer
-        // when reading the original values.
-        png_set_filler(write_ptr, 0, PNG_FILLER_AFTER);
-      }
-      png_write_image(write_ptr, image->rows.get());
-    }
-  } else {
-    LOG(FATAL) << "unreachable";
   }
 
   png_write_end(write_ptr, write_info_ptr);
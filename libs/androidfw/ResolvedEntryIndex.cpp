@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "androidfw/ResolvedEntryIndex.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+
+#include "android-base/file.h"
+#include "android-base/logging.h"
+#include "android-base/utf8.h"
+
+namespace android {
+
+static_assert(sizeof(ResolvedEntryIndex::Header) == 24, "Header layout changed");
+static_assert(sizeof(ResolvedEntryIndex::Entry) == 16, "Entry layout changed");
+
+std::unique_ptr<const ResolvedEntryIndex> ResolvedEntryIndex::Create(uint64_t key,
+                                                                     std::vector<Entry> entries) {
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& lhs, const Entry& rhs) { return lhs.resid < rhs.resid; });
+
+  std::unique_ptr<ResolvedEntryIndex> index(new ResolvedEntryIndex());
+  index->key_ = key;
+  index->owned_entries_ = std::move(entries);
+  index->entries_ = index->owned_entries_;
+  return index;
+}
+
+std::unique_ptr<const ResolvedEntryIndex> ResolvedEntryIndex::Load(const std::string& path) {
+  base::unique_fd fd(base::utf8::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_BINARY));
+  if (!fd.ok()) {
+    return {};
+  }
+  return LoadFromFd(fd);
+}
+
+std::unique_ptr<const ResolvedEntryIndex> ResolvedEntryIndex::LoadFromFd(base::borrowed_fd fd) {
+  struct stat st;
+  if (fstat(fd.get(), &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Header))) {
+    return {};
+  }
+
+  const size_t length = static_cast<size_t>(st.st_size);
+  auto mapped_file = base::MappedFile::FromFd(fd, 0, length, PROT_READ);
+  if (mapped_file == nullptr) {
+    PLOG(ERROR) << "Failed to map resolved entry index";
+    return {};
+  }
+
+  const auto header = reinterpret_cast<const Header*>(mapped_file->data());
+  if (header->magic != kMagic || header->version != kVersion) {
+    LOG(WARNING) << "Resolved entry index has an unsupported format";
+    return {};
+  }
+
+  if ((length - sizeof(Header)) / sizeof(Entry) != header->entry_count ||
+      (length - sizeof(Header)) % sizeof(Entry) != 0) {
+    LOG(WARNING) << "Resolved entry index is truncated";
+    return {};
+  }
+
+  const auto entries = reinterpret_cast<const Entry*>(mapped_file->data() + sizeof(Header));
+  std::span<const Entry> entry_span(entries, header->entry_count);
+  if (!std::is_sorted(entry_span.begin(), entry_span.end(),
+                      [](const Entry& lhs, const Entry& rhs) { return lhs.resid < rhs.resid; })) {
+    LOG(WARNING) << "Resolved entry index is not sorted";
+    return {};
+  }
+
+  std::unique_ptr<ResolvedEntryIndex> index(new ResolvedEntryIndex());
+  index->key_ = header->key;
+  index->entries_ = entry_span;
+  index->mapped_file_ = std::move(mapped_file);
+  return index;
+}
+
+bool ResolvedEntryIndex::WriteToFd(base::borrowed_fd fd) const {
+  const Header header{
+      .magic = kMagic,
+      .version = kVersion,
+      .key = key_,
+      .entry_count = static_cast<uint32_t>(entries_.size()),
+      .reserved = 0U,
+  };
+  return base::WriteFully(fd, &header, sizeof(header)) &&
+         base::WriteFully(fd, entries_.data(), entries_.size_bytes());
+}
+
+const ResolvedEntryIndex::Entry* ResolvedEntryIndex::Find(uint32_t resid) const {
+  const auto iter = std::lower_bound(entries_.begin(), entries_.end(), resid,
+                                     [](const Entry& entry, uint32_t id) {
+                                       return entry.resid < id;
+                                     });
+  if (iter == entries_.end() || iter->resid != resid) {
+    return nullptr;
+  }
+  return &*iter;
+}
+
+}  // namespace android
@@ -17,8 +17,11 @@
 #include <unistd.h>
 #include <string.h>
 
+#include <algorithm>
 #include <map>
 #include <atomic>
+#include <memory>
+#include <vector>
 
 #include <utils/Log.h>
 #include <androidfw/ResourceTimer.h>
@@ -64,6 +67,49 @@ unsigned int diffInNs(timespec const &a, timespec const &b) {
 
 }
 
+struct ResourceTimer::ThreadTimers {
+  GuardedTimer timers[counterSize];
+
+  ThreadTimers();
+  ~ThreadTimers();
+
+  // The timers of all live threads.  These are never destroyed, so that threads exiting during
+  // process shutdown can still unregister.
+  static Mutex& registryLock() {
+    static Mutex* lock = new Mutex();
+    return *lock;
+  }
+  static std::vector<ThreadTimers*>& registry() {
+    static auto* threads = new std::vector<ThreadTimers*>();
+    return *threads;
+  }
+};
+
+ResourceTimer::ThreadTimers::ThreadTimers() {
+  AutoMutex _l(registryLock());
+  registry().push_back(this);
+}
+
+ResourceTimer::ThreadTimers::~ThreadTimers() {
+  AutoMutex _l(registryLock());
+  auto& threads = registry();
+  threads.erase(std::remove(threads.begin(), threads.end(), this), threads.end());
+  // Keep the events of the thread.
+  for (int i = 0; i < counterSize; i++) {
+    ScopedTimer retired(counter_[i]);
+    ScopedTimer t(timers[i]);
+    retired->merge(*t);
+  }
+}
+
+ResourceTimer::GuardedTimer& ResourceTimer::threadTimer(Counter api) {
+  thread_local std::unique_ptr<ThreadTimers> timers;
+  if (timers == nullptr) {
+    timers = std::make_unique<ThreadTimers>();
+  }
+  return timers->timers[toIndex(api)];
+}
+
 ResourceTimer::ResourceTimer(Counter api)
     : active_(enabled_.load()),
       api_(api) {
@@ -85,6 +131,11 @@ void ResourceTimer::cancel() {
   active_ = false;
 }
 
+void ResourceTimer::count(Counter api) {
+  if (!enabled_.load(std::memory_order_relaxed)) return;
+  events_[toIndex(api)].fetch_add(1, std::memory_order_relaxed);
+}
+
 void ResourceTimer::record() {
   if (!active_) return;
 
@@ -92,26 +143,45 @@ void ResourceTimer::record() {
   clock_gettime(CLOCK_MONOTONIC, &end);
   // Get the difference in microseconds.
   const unsigned int ticks = diffInNs(end, start_);
-  ScopedTimer t(counter_[toIndex(api_)]);
+  // This lock is only contended while the timers are being copied.
+  ScopedTimer t(threadTimer(api_));
   t->record(ticks);
   active_ = false;
 }
 
 bool ResourceTimer::copy(int counter, Timer &dst, bool reset) {
-  ScopedTimer t(counter_[counter]);
-  if (t->count == 0) {
+  Timer merged;
+  {
+    AutoMutex _l(ThreadTimers::registryLock());
+    ScopedTimer retired(counter_[counter]);
+    merged.merge(*retired);
+    if (reset) retired->reset();
+    for (ThreadTimers* thread : ThreadTimers::registry()) {
+      ScopedTimer t(thread->timers[counter]);
+      merged.merge(*t);
+      if (reset) t->reset();
+    }
+  }
+  const int events = reset ? events_[counter].exchange(0) : events_[counter].load();
+  if (merged.count == 0 && events == 0) {
     dst.reset();
-    if (reset) t->reset();
     return false;
   }
-  Timer::copy(dst, *t, reset);
+  Timer::copy(dst, merged, true);
+  dst.count += events;
   return true;
 }
 
 void ResourceTimer::reset() {
+  AutoMutex _l(ThreadTimers::registryLock());
   for (int i = 0; i < counterSize; i++) {
-    ScopedTimer t(counter_[i]);
-    t->reset();
+    ScopedTimer retired(counter_[i]);
+    retired->reset();
+    for (ThreadTimers* thread : ThreadTimers::registry()) {
+      ScopedTimer t(thread->timers[i]);
+      t->reset();
+    }
+    events_[i].store(0);
   }
 }
 
@@ -162,6 +232,33 @@ void ResourceTimer::Timer::copy(Timer &dst, Timer &src, bool reset) {
   }
 }
 
+void ResourceTimer::Timer::merge(const Timer &src) {
+  if (src.count == 0) return;
+
+  count += src.count;
+  total += src.total;
+  if (mintime == 0 || (src.mintime != 0 && src.mintime < mintime)) mintime = src.mintime;
+  if (src.maxtime > maxtime) maxtime = src.maxtime;
+
+  // Both lists of largest values are sorted with the biggest value first.
+  int merged[MaxLargest];
+  for (size_t i = 0, a = 0, b = 0; i < MaxLargest; i++) {
+    merged[i] = (largest[a] >= src.largest[b]) ? largest[a++] : src.largest[b++];
+  }
+  memcpy(largest, merged, sizeof(largest));
+
+  for (int d = 0; d < MaxDimension; d++) {
+    if (src.buckets[d] == nullptr) continue;
+    if (buckets[d] == nullptr) {
+      buckets[d] = new int[MaxBuckets];
+      memset(buckets[d], 0, sizeof(int) * MaxBuckets);
+    }
+    for (int j = 0; j < MaxBuckets; j++) {
+      buckets[d][j] += src.buckets[d][j];
+    }
+  }
+}
+
 void ResourceTimer::Timer::record(int ticks) {
   // Record that the event happened.
   count++;
@@ -257,12 +354,27 @@ char const *ResourceTimer::toString(ResourceTimer::Counter counter) {
       return "GetResourceValue";
     case Counter::RetrieveAttributes:
       return "RetrieveAttributes";
+    case Counter::GetBag:
+      return "GetBag";
+    case Counter::ApplyStyle:
+      return "ApplyStyle";
+    case Counter::ResolveAttrs:
+      return "ResolveAttrs";
+    case Counter::ThemeApplyStyle:
+      return "ThemeApplyStyle";
+    case Counter::ApkAssetsLoad:
+      return "ApkAssetsLoad";
+    case Counter::StringBlockCacheHit:
+      return "StringBlockCacheHit";
+    case Counter::StringBlockCacheMiss:
+      return "StringBlockCacheMiss";
   };
   return "Unknown";
 }
 
 std::atomic<bool> ResourceTimer::enabled_(false);
 std::atomic<ResourceTimer::GuardedTimer *> ResourceTimer::counter_(nullptr);
+std::atomic<int> ResourceTimer::events_[ResourceTimer::counterSize] = {};
 
 const int ResourceTimer::Timer::range[] = { 100 * US, 1000 * US, 10*1000 * US, 100*1000 * US };
 const int ResourceTimer::Timer::width[] = {   1 * US,   10 * US,     100 * US,     1000 * US };
@@ -713,6 +713,15 @@ status_t ResStringPool::setTo(incfs::map_ptr<void> data, size_t size, bool copyD
     return (mError=NO_ERROR);
 }
 
+ResStringPool::ClientCache* ResStringPool::setClientCache(
+        std::unique_ptr<ClientCache> cache) const {
+    ClientCache* expected = nullptr;
+    if (mClientCache.compare_exchange_strong(expected, cache.get(), std::memory_order_acq_rel)) {
+        return cache.release();
+    }
+    return expected;
+}
+
 status_t ResStringPool::getError() const
 {
     return mError;
@@ -721,6 +730,7 @@ status_t ResStringPool::getError() const
 void ResStringPool::uninit()
 {
     mError = NO_INIT;
+    delete mClientCache.exchange(nullptr);
     if (mHeader && mCache != NULL) {
         for (size_t x = 0; x < mHeader->stringCount; x++) {
             if (mCache[x] != NULL) {
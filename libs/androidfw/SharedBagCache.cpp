@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "androidfw/SharedBagCache.h"
+
+#include "androidfw/AssetManager2.h"
+
+namespace android {
+
+SharedBagCache& SharedBagCache::Get() {
+  // Never destroyed so that bags stay valid for AssetManagers torn down during process exit.
+  static SharedBagCache* const cache = new SharedBagCache();
+  return *cache;
+}
+
+uint32_t SharedBagCache::GetContext(std::string key) {
+  std::lock_guard<std::mutex> lock(contexts_lock_);
+  if (auto it = contexts_.find(key); it != contexts_.end()) {
+    return it->second;
+  }
+  if (contexts_.size() >= kMaxContexts) {
+    return 0U;
+  }
+  const auto context = static_cast<uint32_t>(contexts_.size() + 1);
+  contexts_.emplace(std::move(key), context);
+  return context;
+}
+
+size_t SharedBagCache::BucketIndex(uint32_t context, uint32_t resid) {
+  // Resource ids within a package are dense, so the low bits spread well on their own.
+  return ((resid * 0x9e3779b1U) ^ (context * 0x85ebca6bU)) % kBucketCount;
+}
+
+const SharedBagCache::Entry* SharedBagCache::Find(uint32_t context, uint32_t resid) const {
+  for (auto entry = buckets_[BucketIndex(context, resid)].load(std::memory_order_acquire);
+       entry != nullptr; entry = entry->next) {
+    if (entry->resid == resid && entry->context == context) {
+      return entry;
+    }
+  }
+  return nullptr;
+}
+
+const SharedBagCache::Entry* SharedBagCache::Insert(uint32_t context, uint32_t resid,
+                                                    util::unique_cptr<ResolvedBag>& bag,
+                                                    std::span<const uint32_t> resid_stack) {
+  const size_t entry_bytes = sizeof(Entry) + sizeof(ResolvedBag) +
+                             bag->entry_count * sizeof(ResolvedBag::Entry) +
+                             resid_stack.size_bytes();
+  if (bytes_used_.fetch_add(entry_bytes, std::memory_order_relaxed) + entry_bytes > kMaxBytes) {
+    bytes_used_.fetch_sub(entry_bytes, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  auto& bucket = buckets_[BucketIndex(context, resid)];
+  auto new_entry = new Entry{
+      .resid = resid,
+      .context = context,
+      .bag = nullptr,
+      .resid_stack = std::vector<uint32_t>(resid_stack.begin(), resid_stack.end()),
+      .next = bucket.load(std::memory_order_acquire),
+  };
+  for (;;) {
+    // Another thread may have published the same bag since the head was read.
+    for (auto entry = new_entry->next; entry != nullptr; entry = entry->next) {
+      if (entry->resid == resid && entry->context == context) {
+        delete new_entry;
+        bytes_used_.fetch_sub(entry_bytes, std::memory_order_relaxed);
+        return entry;
+      }
+    }
+    new_entry->bag = std::move(bag);
+    if (bucket.compare_exchange_weak(new_entry->next, new_entry, std::memory_order_release,
+                                     std::memory_order_acquire)) {
+      return new_entry;
+    }
+    bag = std::move(new_entry->bag);
+  }
+}
+
+}  // namespace android
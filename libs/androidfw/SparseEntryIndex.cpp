@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "androidfw/SparseEntryIndex.h"
+
+#include "utils/ByteOrder.h"
+
+namespace android {
+
+// A binary search over fewer entries than this stays within a couple of cache lines.
+constexpr size_t kMinEntryCount = 32U;
+
+std::unique_ptr<const SparseEntryIndex> SparseEntryIndex::Create(
+    incfs::verified_map_ptr<ResTable_type> type_chunk) {
+  if ((type_chunk->flags & ResTable_type::FLAG_SPARSE) == 0U) {
+    return nullptr;
+  }
+  const size_t entry_count = dtohl(type_chunk->entryCount);
+  if (entry_count < kMinEntryCount) {
+    return nullptr;
+  }
+
+  const auto entries = type_chunk.offset(dtohs(type_chunk->header.headerSize))
+                           .convert<ResTable_sparseTypeEntry>();
+  const auto last_entry = entries + (entry_count - 1U);
+  if (!last_entry) {
+    return nullptr;
+  }
+
+  // The entries are sorted by index, so the last one has the largest index.
+  std::unique_ptr<SparseEntryIndex> index(new SparseEntryIndex());
+  index->word_count_ = dtohs(last_entry->idx) / 64U + 1U;
+  if (index->word_count_ * (sizeof(uint64_t) + sizeof(uint32_t)) >
+      entry_count * sizeof(ResTable_sparseTypeEntry)) {
+    return nullptr;
+  }
+
+  index->bits_ = std::make_unique<uint64_t[]>(index->word_count_);
+  index->ranks_ = std::make_unique<uint32_t[]>(index->word_count_);
+  int previous_idx = -1;
+  for (size_t i = 0; i < entry_count; i++) {
+    const auto entry = entries + i;
+    if (!entry) {
+      return nullptr;
+    }
+    const uint16_t idx = dtohs(entry->idx);
+    if (static_cast<int>(idx) <= previous_idx) {
+      // The binary search would not find every entry either.
+      return nullptr;
+    }
+    previous_idx = idx;
+    index->bits_[idx / 64U] |= uint64_t{1} << (idx % 64U);
+  }
+
+  uint32_t rank = 0U;
+  for (size_t word = 0; word < index->word_count_; word++) {
+    index->ranks_[word] = rank;
+    rank += static_cast<uint32_t>(std::popcount(index->bits_[word]));
+  }
+  return index;
+}
+
+}  // namespace android
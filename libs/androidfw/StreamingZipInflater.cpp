@@ -26,6 +26,8 @@
 #include <unistd.h>
 #include <errno.h>
 
+#include <algorithm>
+
 /*
  * TEMP_FAILURE_RETRY is defined by some, but not all, versions of
  * <unistd.h>. (Alas, it is not as standard as we'd hoped!) So, if it's
@@ -64,6 +66,7 @@ StreamingZipInflater::StreamingZipInflater(int fd, off64_t compDataStart,
     mOutBufSize = StreamingZipInflater::OUTPUT_CHUNK_SIZE;
     mOutBuf = new uint8_t[mOutBufSize];
 
+    mUseCheckpoints = uncompSize >= CHECKPOINT_MIN_SIZE;
     initInflateState();
 }
 
@@ -82,6 +85,7 @@ StreamingZipInflater::StreamingZipInflater(const incfs::IncFsFileMap* dataMap, s
     mOutBufSize = StreamingZipInflater::OUTPUT_CHUNK_SIZE;
     mOutBuf = new uint8_t[mOutBufSize];
 
+    mUseCheckpoints = uncompSize >= CHECKPOINT_MIN_SIZE;
     initInflateState();
 }
 
@@ -181,7 +185,10 @@ ssize_t StreamingZipInflater::read(void* outBuf, size_t count) {
                 result = inflateInit2(&mInflateState, -MAX_WBITS);
                 mStreamNeedsInit = false;
             }
-            if (result == Z_OK) result = ::inflate(&mInflateState, Z_SYNC_FLUSH);
+            // With checkpoints, stop at every block boundary to see whether one is due.
+            if (result == Z_OK) {
+                result = ::inflate(&mInflateState, mUseCheckpoints ? Z_BLOCK : Z_SYNC_FLUSH);
+            }
             if (result < 0) {
                 // Whoops, inflation failed
                 ALOGE("Error inflating asset: %d", result);
@@ -198,6 +205,10 @@ ssize_t StreamingZipInflater::read(void* outBuf, size_t count) {
                 // Note how much data we got, and off we go
                 mOutDeliverable = 0;
                 mOutLastDecoded = mOutBufSize - mInflateState.avail_out;
+
+                if (mUseCheckpoints && result != Z_STREAM_END) {
+                    maybeAddCheckpoint();
+                }
             }
         }
     }
@@ -227,11 +238,112 @@ int StreamingZipInflater::readNextChunk() {
     return 0;
 }
 
-// seeking backwards requires uncompressing fom the beginning, so is very
-// expensive.  seeking forwards only requires uncompressing from the current
-// position to the destination.
+/*
+ * Records a checkpoint if the stream is at a block boundary at least CHECKPOINT_INTERVAL
+ * bytes after the last checkpoint.  A checkpoint is all the state that raw inflate needs to
+ * resume from a block boundary: the input position down to the bit, and the window of the
+ * last 32 KiB of output.
+ */
+void StreamingZipInflater::maybeAddCheckpoint() {
+    // Bit 7 of data_type is set at a block boundary, and bit 6 if the last block was the
+    // final one.
+    if ((mInflateState.data_type & 192) != 128) {
+        return;
+    }
+
+    // All of the output decoded so far is in mOutBuf, and none of it was delivered yet.
+    const off64_t outPosition = mOutCurPosition + mOutLastDecoded;
+    const off64_t lastPosition = mCheckpoints.empty() ? 0 : mCheckpoints.back().outPosition;
+    if (outPosition < lastPosition + off64_t(CHECKPOINT_INTERVAL)) {
+        return;
+    }
+
+    const int bits = mInflateState.data_type & 7;
+    const Bytef* nextIn = mInflateState.next_in;
+    if (bits > 0 && nextIn == mInBuf) {
+        // The partial byte is no longer in the input buffer.
+        return;
+    }
+
+    Checkpoint checkpoint;
+    checkpoint.outPosition = outPosition;
+    checkpoint.inPosition = (mDataMap == NULL) ? mInNextChunkOffset - mInflateState.avail_in
+                                                : size_t(nextIn - mInBuf);
+    checkpoint.bits = bits;
+    checkpoint.lastInByte = bits > 0 ? nextIn[-1] : 0;
+    checkpoint.window.reset(new uint8_t[1 << MAX_WBITS]);
+    uInt windowSize = 0;
+    if (inflateGetDictionary(&mInflateState, checkpoint.window.get(), &windowSize) != Z_OK) {
+        return;
+    }
+    checkpoint.windowSize = windowSize;
+
+    ALOGV("Added inflate checkpoint at %" PRId64 " (input %zu)", outPosition,
+            checkpoint.inPosition);
+    mCheckpoints.push_back(std::move(checkpoint));
+}
+
+/*
+ * Sets the inflater up to continue from a checkpoint.  On failure the inflater is back at the
+ * beginning of the data.
+ */
+bool StreamingZipInflater::restoreCheckpoint(const Checkpoint& checkpoint) {
+    if (!mStreamNeedsInit) {
+        ::inflateEnd(&mInflateState);
+    }
+    initInflateState();
+
+    if (inflateInit2(&mInflateState, -MAX_WBITS) != Z_OK) {
+        ALOGE("Unable to initialize zlib to resume inflating");
+        ::inflateEnd(&mInflateState);
+        initInflateState();
+        return false;
+    }
+    mStreamNeedsInit = false;
+
+    int result = Z_OK;
+    if (checkpoint.bits > 0) {
+        result = inflatePrime(&mInflateState, checkpoint.bits,
+                checkpoint.lastInByte >> (8 - checkpoint.bits));
+    }
+    if (result == Z_OK) {
+        result = inflateSetDictionary(&mInflateState, checkpoint.window.get(),
+                checkpoint.windowSize);
+    }
+    if (result != Z_OK) {
+        ALOGE("Unable to resume inflating from %" PRId64 ": %d", checkpoint.outPosition, result);
+        ::inflateEnd(&mInflateState);
+        initInflateState();
+        return false;
+    }
+
+    if (mDataMap == NULL) {
+        ::lseek(mFd, mInFileStart + checkpoint.inPosition, SEEK_SET);
+        mInNextChunkOffset = checkpoint.inPosition;
+        mInflateState.avail_in = 0; // set when a chunk is read in
+    } else {
+        mInflateState.next_in = (Bytef*) mInBuf + checkpoint.inPosition;
+        mInflateState.avail_in = mInTotalSize - checkpoint.inPosition;
+    }
+    mOutCurPosition = checkpoint.outPosition;
+    return true;
+}
+
+// seeking backwards requires uncompressing from the nearest checkpoint, or from the beginning.
+// seeking forwards only requires uncompressing from the current position, or from a checkpoint
+// if there is one well past it, to the destination.
 off64_t StreamingZipInflater::seekAbsolute(off64_t absoluteInputPosition) {
-    if (absoluteInputPosition < mOutCurPosition) {
+    // Find the last checkpoint at or before the destination.
+    auto it = std::upper_bound(mCheckpoints.begin(), mCheckpoints.end(), absoluteInputPosition,
+            [](off64_t position, const Checkpoint& c) { return position < c.outPosition; });
+    const Checkpoint* checkpoint = (it != mCheckpoints.begin()) ? &*(it - 1) : NULL;
+    const bool useCheckpoint = checkpoint != NULL &&
+            (absoluteInputPosition < mOutCurPosition ||
+             checkpoint->outPosition > mOutCurPosition + off64_t(OUTPUT_CHUNK_SIZE));
+
+    if (useCheckpoint && restoreCheckpoint(*checkpoint)) {
+        read(NULL, absoluteInputPosition - mOutCurPosition);
+    } else if (absoluteInputPosition < mOutCurPosition) {
         // rewind and reprocess the data from the beginning
         if (!mStreamNeedsInit) {
             ::inflateEnd(&mInflateState);
@@ -20,19 +20,38 @@
 
 namespace android {
 
-TypeVariant::TypeVariant(const ResTable_type* data) : data(data), mLength(dtohl(data->entryCount)) {
-    if (data->flags & ResTable_type::FLAG_SPARSE) {
-        const uint32_t entryCount = dtohl(data->entryCount);
-        const uintptr_t containerEnd = reinterpret_cast<uintptr_t>(data) + dtohl(data->header.size);
-        const uint32_t* const entryIndices = reinterpret_cast<const uint32_t*>(
-                reinterpret_cast<uintptr_t>(data) + dtohs(data->header.headerSize));
-        if (reinterpret_cast<uintptr_t>(entryIndices) + (sizeof(uint32_t) * entryCount)
-                > containerEnd) {
-            ALOGE("Type's entry indices extend beyond its boundaries");
+TypeVariant::TypeVariant(const ResTable_type* data)
+    : data(data), mLength(dtohl(data->entryCount)), mEntryCount(dtohl(data->entryCount)) {
+    mContainerEnd = reinterpret_cast<uintptr_t>(data) + dtohl(data->header.size);
+    const uint32_t* const entryIndices = reinterpret_cast<const uint32_t*>(
+            reinterpret_cast<uintptr_t>(data) + dtohs(data->header.headerSize));
+    const size_t indexSize = (data->flags & ResTable_type::FLAG_OFFSET16)
+                                     && !(data->flags & ResTable_type::FLAG_SPARSE)
+            ? sizeof(uint16_t) : sizeof(uint32_t);
+    if (reinterpret_cast<uintptr_t>(entryIndices) + (indexSize * mEntryCount) > mContainerEnd) {
+        ALOGE("Type's entry indices extend beyond its boundaries");
+        if (data->flags & ResTable_type::FLAG_SPARSE) {
             mLength = 0;
-        } else {
-          mLength = ResTable_sparseTypeEntry{entryIndices[entryCount - 1]}.idx + 1;
         }
+        return;
+    }
+    mEntryIndices = entryIndices;
+
+    if (data->flags & ResTable_type::FLAG_SPARSE) {
+        mLength = mEntryCount == 0
+                ? 0 : dtohs(ResTable_sparseTypeEntry{entryIndices[mEntryCount - 1]}.idx) + 1;
+    }
+}
+
+static bool keyCompare(uint32_t entry, uint16_t index) {
+  return dtohs(ResTable_sparseTypeEntry{entry}.idx) < index;
+}
+
+TypeVariant::iterator::iterator(const TypeVariant* tv, uint32_t index)
+    : mTypeVariant(tv), mIndex(index) {
+    if (tv->mEntryIndices != nullptr && (tv->data->flags & ResTable_type::FLAG_SPARSE)) {
+        const uint32_t* const begin = tv->mEntryIndices;
+        mSparsePos = std::lower_bound(begin, begin + tv->mEntryCount, mIndex, keyCompare) - begin;
     }
 }
 
@@ -41,40 +60,32 @@ TypeVariant::iterator& TypeVariant::iterator::operator++() {
     if (mIndex > mTypeVariant->mLength) {
         mIndex = mTypeVariant->mLength;
     }
+    if (mTypeVariant->mEntryIndices != nullptr
+            && (mTypeVariant->data->flags & ResTable_type::FLAG_SPARSE)) {
+        while (mSparsePos < mTypeVariant->mEntryCount
+                && keyCompare(mTypeVariant->mEntryIndices[mSparsePos], mIndex)) {
+            mSparsePos++;
+        }
+    }
     return *this;
 }
 
-static bool keyCompare(uint32_t entry, uint16_t index) {
-  return dtohs(ResTable_sparseTypeEntry{entry}.idx) < index;
-}
-
 const ResTable_entry* TypeVariant::iterator::operator*() const {
     const ResTable_type* type = mTypeVariant->data;
-    if (mIndex >= mTypeVariant->mLength) {
-        return NULL;
-    }
-
-    const uint32_t entryCount = dtohl(mTypeVariant->data->entryCount);
-    const uintptr_t containerEnd = reinterpret_cast<uintptr_t>(type)
-            + dtohl(type->header.size);
-    const uint32_t* const entryIndices = reinterpret_cast<const uint32_t*>(
-            reinterpret_cast<uintptr_t>(type) + dtohs(type->header.headerSize));
-    const size_t indexSize = type->flags & ResTable_type::FLAG_OFFSET16 ?
-                                    sizeof(uint16_t) : sizeof(uint32_t);
-    if (reinterpret_cast<uintptr_t>(entryIndices) + (indexSize * entryCount) > containerEnd) {
-        ALOGE("Type's entry indices extend beyond its boundaries");
+    const uint32_t* const entryIndices = mTypeVariant->mEntryIndices;
+    if (mIndex >= mTypeVariant->mLength || entryIndices == nullptr) {
         return NULL;
     }
 
     uint32_t entryOffset;
     if (type->flags & ResTable_type::FLAG_SPARSE) {
-      auto iter = std::lower_bound(entryIndices, entryIndices + entryCount, mIndex, keyCompare);
-      if (iter == entryIndices + entryCount
-              || dtohs(ResTable_sparseTypeEntry{*iter}.idx) != mIndex) {
+      if (mSparsePos == mTypeVariant->mEntryCount
+              || dtohs(ResTable_sparseTypeEntry{entryIndices[mSparsePos]}.idx) != mIndex) {
         return NULL;
       }
 
-      entryOffset = static_cast<uint32_t>(dtohs(ResTable_sparseTypeEntry{*iter}.offset)) * 4u;
+      entryOffset = static_cast<uint32_t>(
+              dtohs(ResTable_sparseTypeEntry{entryIndices[mSparsePos]}.offset)) * 4u;
     } else if (type->flags & ResTable_type::FLAG_OFFSET16) {
       auto entryIndices16 = reinterpret_cast<const uint16_t*>(entryIndices);
       entryOffset = offset_from16(entryIndices16[mIndex]);
@@ -91,6 +102,7 @@ const ResTable_entry* TypeVariant::iterator::operator*() const {
         return NULL;
     }
 
+    const uintptr_t containerEnd = mTypeVariant->mContainerEnd;
     const ResTable_entry* entry = reinterpret_cast<const ResTable_entry*>(
             reinterpret_cast<uintptr_t>(type) + dtohl(type->entriesStart) + entryOffset);
     if (reinterpret_cast<uintptr_t>(entry) > containerEnd - sizeof(*entry)) {
@@ -20,7 +20,9 @@
 #include <utils/RefBase.h>
 
 #include <memory>
+#include <span>
 #include <string>
+#include <vector>
 
 #include "android-base/macros.h"
 #include "android-base/unique_fd.h"
@@ -60,6 +62,24 @@ class ApkAssets : public RefBase {
   // data.
   static ApkAssetsPtr LoadOverlay(const std::string& idmap_path, package_property_t flags = 0U);
 
+  struct LoadRequest {
+    // The path of the APK, or the path of the IDMAP if `is_overlay` is true.
+    std::string path;
+    package_property_t flags = 0U;
+    bool is_overlay = false;
+  };
+
+  // Loads the ApkAssets described by `requests` concurrently on up to `max_threads` threads, or
+  // on a small default number of threads if `max_threads` is 0.
+  //
+  // The result holds one element per request, in the order of `requests`, so it can be passed
+  // directly to AssetManager2::SetApkAssets once the failed requests have been handled. Failed
+  // requests are left as nullptr. If `out_errors` is not null, it receives one message per
+  // request, which is empty if the request succeeded.
+  static std::vector<sp<const ApkAssets>> LoadAll(std::span<const LoadRequest> requests,
+                                                  std::vector<std::string>* out_errors = nullptr,
+                                                  size_t max_threads = 0U);
+
   // Path to the contents of the ApkAssets on disk. The path could represent an APk, a directory,
   // or some other file type.
   std::optional<std::string_view> GetPath() const;
@@ -94,6 +114,12 @@ class ApkAssets : public RefBase {
 
   bool IsUpToDate() const;
 
+  // Returns an id that is unique to this instance for the lifetime of the process. Unlike the
+  // address of the instance, the id is never reused after the instance is destroyed.
+  uint64_t GetUniqueId() const {
+    return unique_id_;
+  }
+
  private:
   static ApkAssetsPtr LoadImpl(std::unique_ptr<AssetsProvider> assets,
                                package_property_t property_flags,
@@ -126,6 +152,8 @@ class ApkAssets : public RefBase {
 
   std::unique_ptr<Asset> idmap_asset_;
   std::unique_ptr<LoadedIdmap> loaded_idmap_;
+
+  const uint64_t unique_id_;
 };
 
 } // namespace android
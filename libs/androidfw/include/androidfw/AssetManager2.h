@@ -21,6 +21,7 @@
 
 #include <array>
 #include <limits>
+#include <memory>
 #include <set>
 #include <span>
 #include <unordered_map>
@@ -30,6 +31,8 @@
 #include "androidfw/ApkAssets.h"
 #include "androidfw/Asset.h"
 #include "androidfw/AssetManager.h"
+#include "androidfw/ResIdMap.h"
+#include "androidfw/ResolvedEntryIndex.h"
 #include "androidfw/ResourceTypes.h"
 #include "androidfw/Util.h"
 #include "ftl/small_vector.h"
@@ -168,9 +171,28 @@ class AssetManager2 {
   }
 
   inline void SetDefaultLocale(uint32_t default_locale) {
-    default_locale_ = default_locale;
+    if (default_locale_ != default_locale) {
+      default_locale_ = default_locale;
+      UpdateSharedBagContext();
+    }
   }
 
+  // Returns a key that identifies the current set of ApkAssets and configuration. A
+  // ResolvedEntryIndex is only used by this AssetManager if it was built for the same key.
+  uint64_t GetResolvedEntryIndexKey() const;
+
+  // Computes the best matching entry of every resource for the current set of ApkAssets and
+  // configuration so that it can be persisted and reused by other AssetManagers.
+  //
+  // Returns nullptr if more than one configuration is set, or if reading resource data failed.
+  std::unique_ptr<const ResolvedEntryIndex> BuildResolvedEntryIndex() const;
+
+  // Uses `index` to skip the configuration scan when looking up resources. The index is dropped
+  // as soon as the ApkAssets or the configuration change.
+  //
+  // Returns false and does not use the index if it was built for a different key.
+  bool SetResolvedEntryIndex(std::shared_ptr<const ResolvedEntryIndex> index);
+
   // Returns all configurations for which there are resources defined, or an I/O error if reading
   // resource data failed.
   //
@@ -433,6 +455,12 @@ class AssetManager2 {
       const ResTable_config& desired_config, bool stop_at_first_match,
       bool ignore_configuration) const;
 
+  // Builds the result for the entry at `entry_offset` in the type `type_entry` of the package at
+  // `package_index` in `package_group`. The caller is responsible for setting `type_flags`.
+  static base::expected<FindEntryResult, NullOrIOError> MakeFindEntryResult(
+      const PackageGroup& package_group, size_t package_index,
+      const TypeSpec::TypeEntry& type_entry, size_t type_entry_index, uint32_t entry_offset);
+
   // Assigns package IDs to all shared library ApkAssets.
   // Should be called whenever the ApkAssets are changed.
   void BuildDynamicRefTable(ApkAssetsList assets);
@@ -443,7 +471,19 @@ class AssetManager2 {
 
   // Triggers the re-construction of lists of types that match the set configuration.
   // This should always be called when mutating the AssetManager's configuration or ApkAssets set.
-  void RebuildFilterList();
+  //
+  // `diff` is the bitmask of configuration axes that changed since the lists were last built. Only
+  // the lists of types with configurations that vary along one of these axes are rebuilt.
+  void RebuildFilterList(uint32_t diff = 0xffffffffu);
+
+  // Selects the context of the process-wide SharedBagCache that matches the current ApkAssets,
+  // configurations and default locale.
+  void UpdateSharedBagContext();
+
+  // Caches `bag` for `resid`, sharing it with other AssetManagers when possible. The styles
+  // traversed to resolve the bag are the elements of `child_resids` past `stack_start`.
+  const ResolvedBag* CacheBag(uint32_t resid, util::unique_cptr<ResolvedBag> bag,
+                              const std::vector<uint32_t>& child_resids, size_t stack_start) const;
 
   // Retrieves the APK paths of overlays that overlay non-system packages.
   std::set<ApkAssetsPtr> GetNonSystemOverlays() const;
@@ -480,16 +520,28 @@ class AssetManager2 {
   // may need to be purged.
   ftl::SmallVector<ResTable_config, 1> configurations_;
 
+  // An optional precomputed index of the best matching entries for the current configuration.
+  std::shared_ptr<const ResolvedEntryIndex> resolved_entry_index_;
+
+  // The unique ids of the ApkAssets in apk_assets_, which identify the bags they can produce.
+  std::string shared_bag_assets_key_;
+
+  // The SharedBagCache context of this AssetManager, or 0 if bags are not shared.
+  uint32_t shared_bag_context_ = 0U;
+
   // Cached set of bags. These are cached because they can inherit keys from parent bags,
-  // which involves some calculation.
-  mutable std::unordered_map<uint32_t, util::unique_cptr<ResolvedBag>> cached_bags_;
+  // which involves some calculation. The bags are owned by the SharedBagCache when they could be
+  // shared, and by owned_bags_ otherwise.
+  mutable ResIdMap<const ResolvedBag*> cached_bags_;
+  mutable ResIdMap<util::unique_cptr<ResolvedBag>> owned_bags_;
 
   // Cached set of bag resid stacks for each bag. These are cached because they might be requested
-  // a number of times for each view during View inspection.
+  // a number of times for each view during View inspection. This stays a node-based map because
+  // GetBagResIdStack() hands out pointers that must survive later insertions.
   mutable std::unordered_map<uint32_t, std::vector<uint32_t>> cached_bag_resid_stacks_;
 
   // Cached set of resolved resource values.
-  mutable std::unordered_map<uint32_t, SelectedValue> cached_resolved_values_;
+  mutable ResIdMap<SelectedValue> cached_resolved_values_;
 
   // Tracking the number of the started operations running with the current AssetManager.
   // Finishing the last one clears all promoted apk assets.
@@ -607,13 +659,30 @@ class Theme {
  private:
   DISALLOW_COPY_AND_ASSIGN(Theme);
 
+  // The attributes of a theme are stored in chunks of consecutive attribute resource IDs. Themes
+  // copied with SetTo() share the chunk list and the chunks themselves, and a theme only copies
+  // the list and the chunks that it is about to modify.
+  struct Chunk;
+  using ChunkList = std::vector<std::shared_ptr<Chunk>>;
+
   explicit Theme(AssetManager2* asset_manager);
 
+  // Applies the entries of a style that fall into the chunk starting at `chunk_base`. Returns false
+  // if the entries were not sorted.
+  bool ApplyStyleChunk(uint32_t chunk_base, const ResolvedBag::Entry* run_begin,
+                       const ResolvedBag::Entry* run_end, uint32_t type_spec_flags, bool force);
+
+  const Entry* FindEntry(uint32_t resid) const;
+
+  // Returns the chunk list or a chunk, copying it first if it is shared with another theme.
+  ChunkList& MutableChunks();
+  Chunk& MutableChunk(size_t index);
+
   AssetManager2* asset_manager_ = nullptr;
   uint32_t type_spec_flags_ = 0u;
 
-  std::vector<uint32_t> keys_;
-  std::vector<Entry> entries_;
+  // Sorted by the first attribute of each chunk. May be null.
+  std::shared_ptr<ChunkList> chunks_;
 };
 
 inline const ResolvedBag::Entry* begin(const ResolvedBag* bag) {
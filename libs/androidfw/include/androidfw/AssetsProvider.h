@@ -105,8 +105,12 @@ struct ZipAssetsProvider : public AssetsProvider {
 
  private:
   struct PathOrDebugName;
-  ZipAssetsProvider(ZipArchive* handle, PathOrDebugName&& path, package_property_t flags,
-                    time_t last_mod_time);
+  ZipAssetsProvider(std::shared_ptr<ZipArchive> handle, PathOrDebugName&& path,
+                    package_property_t flags, time_t last_mod_time);
+
+  // Returns an open archive for a path on a read-only filesystem, sharing the archive (and the
+  // central directory index built when opening it) with any other provider of the same path.
+  static std::shared_ptr<ZipArchive> OpenSharedArchive(const std::string& path);
 
   struct PathOrDebugName {
     static PathOrDebugName Path(std::string value) {
@@ -132,7 +136,7 @@ struct ZipAssetsProvider : public AssetsProvider {
   struct ZipCloser {
     void operator()(ZipArchive* a) const;
   };
-  std::unique_ptr<ZipArchive, ZipCloser> zip_handle_;
+  std::shared_ptr<ZipArchive> zip_handle_;
   PathOrDebugName name_;
   package_property_t flags_;
   time_t last_mod_time_;
@@ -17,6 +17,8 @@
 #ifndef ANDROIDFW_ATTRIBUTERESOLUTION_H
 #define ANDROIDFW_ATTRIBUTERESOLUTION_H
 
+#include <span>
+
 #include "androidfw/AssetManager2.h"
 #include "androidfw/ResourceTypes.h"
 
@@ -59,6 +61,20 @@ base::expected<std::monostate, IOError> ApplyStyle(Theme* theme, ResXMLParser* x
                                                    const uint32_t* attrs, size_t attrs_length,
                                                    uint32_t* out_values, uint32_t* out_indices);
 
+// Equivalent to calling ApplyStyle() once for each of `xml_parsers`, which may contain nullptr,
+// but resolves the default style and the theme values only once for all of them.
+// The results for each parser follow each other: `out_values` must hold
+// xml_parsers.size() * attrs_length * STYLE_NUM_ENTRIES elements and `out_indices` must hold
+// xml_parsers.size() * (attrs_length + 1) elements.
+// `out_values` must NOT be nullptr.
+// `out_indices` is NOT optional and must NOT be nullptr.
+base::expected<std::monostate, IOError> ApplyStyles(Theme* theme,
+                                                    std::span<ResXMLParser* const> xml_parsers,
+                                                    uint32_t def_style_attr,
+                                                    uint32_t def_style_resid,
+                                                    const uint32_t* attrs, size_t attrs_length,
+                                                    uint32_t* out_values, uint32_t* out_indices);
+
 // `out_values` must NOT be nullptr.
 // `out_indices` may be nullptr.
 base::expected<std::monostate, IOError> RetrieveAttributes(AssetManager2* assetmanager,
@@ -18,6 +18,7 @@
 #define _UTILS_BACKUP_HELPERS_H
 
 #include <sys/stat.h>
+#include <sys/uio.h>
 
 #include <utils/Errors.h>
 #include <utils/String8.h>
@@ -82,6 +83,11 @@ public:
      */
     status_t WriteEntityData(const void* data, size_t size);
 
+    /* Same as above, writing the iovcnt buffers of iov back to back with as
+     * few system calls as possible.
+     */
+    status_t WriteEntityData(const struct iovec* iov, int iovcnt);
+
     void SetKeyPrefix(const String8& keyPrefix);
 
 private:
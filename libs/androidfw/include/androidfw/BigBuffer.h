@@ -17,6 +17,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -27,6 +28,42 @@
 
 namespace android {
 
+/**
+ * Keeps the memory of destroyed BigBuffer blocks around so that the
+ * next BigBuffer created with this pool can reuse it instead of
+ * allocating. Useful when the same kind of payload is flattened over
+ * and over. The pool is thread-safe and must outlive its BigBuffers.
+ */
+class BigBufferPool {
+ public:
+  /**
+   * Create a pool of blocks of block_size bytes, holding on to at
+   * most max_blocks of them.
+   */
+  explicit BigBufferPool(size_t block_size, size_t max_blocks = 64);
+
+  size_t block_size() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(BigBufferPool);
+  friend class BigBuffer;
+
+  /**
+   * Returns a zero-initialized block of block_size() bytes.
+   */
+  std::unique_ptr<uint8_t[]> Acquire();
+
+  /**
+   * Gives back a block of block_size() bytes.
+   */
+  void Release(std::unique_ptr<uint8_t[]> buffer);
+
+  const size_t block_size_;
+  const size_t max_blocks_;
+  std::mutex lock_;
+  std::vector<std::unique_ptr<uint8_t[]>> free_blocks_;
+};
+
 /**
  * Inspired by protobuf's ZeroCopyOutputStream, offers blocks of memory
  * in which to write without knowing the full size of the entire payload.
@@ -67,8 +104,16 @@ class BigBuffer {
    */
   explicit BigBuffer(size_t block_size);
 
+  /**
+   * Create a BigBuffer that allocates its blocks from pool and
+   * returns them to it when destroyed.
+   */
+  explicit BigBuffer(BigBufferPool* pool);
+
   BigBuffer(BigBuffer&& rhs) noexcept;
 
+  ~BigBuffer();
+
   /**
    * Number of occupied bytes in all the allocated blocks.
    */
@@ -127,16 +172,35 @@ class BigBuffer {
    */
   void* NextBlockImpl(size_t size);
 
+  /**
+   * Appends a new zero-initialized block of size bytes.
+   */
+  Block& AppendBlock(size_t size);
+
   size_t block_size_;
   size_t size_;
   std::vector<Block> blocks_;
+  BigBufferPool* pool_ = nullptr;
 };
 
+inline size_t BigBufferPool::block_size() const {
+  return block_size_;
+}
+
 inline BigBuffer::BigBuffer(size_t block_size) : block_size_(block_size), size_(0) {
 }
 
+inline BigBuffer::BigBuffer(BigBufferPool* pool)
+    : block_size_(pool->block_size()), size_(0), pool_(pool) {
+}
+
 inline BigBuffer::BigBuffer(BigBuffer&& rhs) noexcept
-    : block_size_(rhs.block_size_), size_(rhs.size_), blocks_(std::move(rhs.blocks_)) {
+    : block_size_(rhs.block_size_),
+      size_(rhs.size_),
+      blocks_(std::move(rhs.blocks_)),
+      pool_(rhs.pool_) {
+  rhs.blocks_.clear();
+  rhs.size_ = 0;
 }
 
 inline size_t BigBuffer::size() const {
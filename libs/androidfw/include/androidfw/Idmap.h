@@ -21,6 +21,7 @@
 #include <string>
 #include <unordered_map>
 #include <variant>
+#include <vector>
 
 #include "android-base/macros.h"
 #include "android-base/unique_fd.h"
@@ -82,6 +83,105 @@ class OverlayDynamicRefTable : public DynamicRefTable {
   friend IdmapResMap;
 };
 
+// Maps the target resource ids of an idmap entry array to their position in the array with a
+// table per type, so that lookups in well-populated types don't need a binary search.
+class IdmapTargetIndex {
+ public:
+  // The type of the resource id is not indexed. Search the entry array instead.
+  static constexpr uint32_t kUnindexed = 0xffffffffU;
+  // The resource id is not in the entry array.
+  static constexpr uint32_t kNotFound = 0xfffffffeU;
+
+  // Builds the index for `count` entries with a `target_id` field, sorted by target id.
+  template <typename Entry>
+  void Build(const Entry* entries, uint32_t count);
+
+  // Returns the position of `target_res_id`, without its package id, in the entry array.
+  uint32_t Find(uint32_t target_res_id) const {
+    if (!built_) {
+      return kUnindexed;
+    }
+    const uint32_t type_index = (target_res_id >> 16U) & 0xffU;
+    if (type_index >= types_.size()) {
+      return kNotFound;
+    }
+    const TypeTable& type = types_[type_index];
+    if (!type.indexed) {
+      return kUnindexed;
+    }
+    const uint32_t entry_index = (target_res_id & 0xffffU) - type.first_entry;
+    return entry_index < type.entry_count ? positions_[type.offset + entry_index] : kNotFound;
+  }
+
+ private:
+  struct TypeTable {
+    bool indexed = true;
+    uint16_t first_entry = 0U;
+    uint32_t entry_count = 0U;
+    uint32_t offset = 0U;
+  };
+
+  bool built_ = false;
+  std::vector<TypeTable> types_;
+  std::vector<uint32_t> positions_;
+};
+
+template <typename Entry>
+inline void IdmapTargetIndex::Build(const Entry* entries, uint32_t count) {
+  // Types with fewer entries are quick to binary search.
+  constexpr uint32_t kMinEntryCount = 8U;
+  // The table of a type may have at most this many slots per entry, so it takes at most twice
+  // the memory of the 8-byte entries it indexes.
+  constexpr uint32_t kMaxSlotsPerEntry = 4U;
+
+  types_.clear();
+  positions_.clear();
+  for (uint32_t start = 0U; start < count;) {
+    const uint32_t first_id = 0x00FFFFFFU & dtohl(entries[start].target_id);
+    const uint32_t type_index = (first_id >> 16U) & 0xffU;
+    uint32_t end = start + 1U;
+    while (end < count && ((dtohl(entries[end].target_id) >> 16U) & 0xffU) == type_index) {
+      end++;
+    }
+    if (type_index < types_.size()) {
+      // The entries are not sorted by type, so the index would not be complete.
+      types_.clear();
+      positions_.clear();
+      return;
+    }
+    types_.resize(type_index + 1U);
+
+    const uint32_t first_entry = first_id & 0xffffU;
+    const uint32_t last_entry = dtohl(entries[end - 1U].target_id) & 0xffffU;
+    const uint32_t entry_count = end - start;
+    const uint32_t slot_count = last_entry >= first_entry ? last_entry - first_entry + 1U : 0U;
+    TypeTable& type = types_[type_index];
+    if (entry_count < kMinEntryCount || slot_count == 0U ||
+        slot_count > entry_count * kMaxSlotsPerEntry) {
+      type.indexed = false;
+    } else {
+      type.first_entry = first_entry;
+      type.entry_count = slot_count;
+      type.offset = positions_.size();
+      positions_.resize(positions_.size() + slot_count, kNotFound);
+      for (uint32_t i = start; i < end; i++) {
+        const uint32_t slot = (dtohl(entries[i].target_id) & 0xffffU) - first_entry;
+        if (slot >= slot_count) {
+          // The entries of this type are not sorted; let the binary search deal with it.
+          type.indexed = false;
+          positions_.resize(type.offset);
+          break;
+        }
+        if (positions_[type.offset + slot] == kNotFound) {
+          positions_[type.offset + slot] = i;
+        }
+      }
+    }
+    start = end;
+  }
+  built_ = true;
+}
+
 // A mapping of target resource ids to a values or resource ids that should overlay the target.
 class IdmapResMap {
  public:
@@ -137,11 +237,15 @@ class IdmapResMap {
                        const Idmap_target_entry_inline_value* inline_entry_values,
                        const ConfigDescription* configs,
                        uint8_t target_assigned_package_id,
-                       const OverlayDynamicRefTable* overlay_ref_table);
+                       const OverlayDynamicRefTable* overlay_ref_table,
+                       const IdmapTargetIndex* entry_index,
+                       const IdmapTargetIndex* inline_entry_index);
 
   const Idmap_data_header* data_header_;
   const Idmap_target_entry* entries_;
+  const IdmapTargetIndex* entry_index_;
   const Idmap_target_entry_inline* inline_entries_;
+  const IdmapTargetIndex* inline_entry_index_;
   const Idmap_target_entry_inline_value* inline_entry_values_;
   const ConfigDescription* configurations_;
   const uint8_t target_assigned_package_id_;
@@ -174,7 +278,8 @@ class LoadedIdmap {
   IdmapResMap GetTargetResourcesMap(uint8_t target_assigned_package_id,
                                     const OverlayDynamicRefTable* overlay_ref_table) const {
     return IdmapResMap(data_header_, target_entries_, target_inline_entries_, inline_entry_values_,
-                       configurations_, target_assigned_package_id, overlay_ref_table);
+                       configurations_, target_assigned_package_id, overlay_ref_table,
+                       &target_index_, &target_inline_index_);
   }
 
   // Returns a dynamic reference table for a loaded overlay package.
@@ -199,6 +304,10 @@ class LoadedIdmap {
   const Idmap_overlay_entry* overlay_entries_;
   const std::unique_ptr<ResStringPool> string_pool_;
 
+  // Built when the idmap is loaded, left empty by mocks.
+  IdmapTargetIndex target_index_;
+  IdmapTargetIndex target_inline_index_;
+
   android::base::unique_fd idmap_fd_;
   std::string_view overlay_apk_path_;
   std::string_view target_apk_path_;
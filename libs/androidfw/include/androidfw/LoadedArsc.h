@@ -30,7 +30,9 @@
 #include "androidfw/ByteBucketArray.h"
 #include "androidfw/Chunk.h"
 #include "androidfw/Idmap.h"
+#include "androidfw/PackedConfig.h"
 #include "androidfw/ResourceTypes.h"
+#include "androidfw/SparseEntryIndex.h"
 #include "androidfw/Util.h"
 
 namespace android {
@@ -54,6 +56,19 @@ struct TypeSpec {
     // Type configurations are accessed frequently when setting up an AssetManager and querying
     // resources. Access this cached configuration to minimize page faults.
     ResTable_config config;
+
+    // `config` packed for matching against many requested configurations at once.
+    PackedConfigRange packed_config;
+
+    // Speeds up entry lookups in `type` if it is sparse and large enough. May be null. Shared so
+    // that type entries stay copyable.
+    std::shared_ptr<const SparseEntryIndex> sparse_index;
+
+    // Equivalent to `config.match(settings)`, where `packed_settings` is the packed `settings`.
+    bool Matches(const ResTable_config& settings, const PackedConfig& packed_settings) const {
+      return packed_config.Contains(packed_settings) &&
+             (!packed_config.needs_full_match || config.match(settings));
+    }
   };
 
   // Pointer to the mmapped data where flags are kept. Flags denote whether the resource entry is
@@ -62,6 +77,11 @@ struct TypeSpec {
 
   std::vector<TypeEntry> type_entries;
 
+  // The configuration axes (ResTable_config::CONFIG_*) along which the configuration of at least
+  // one of `type_entries` is not the default. A configuration change that only touches other axes
+  // cannot change which of `type_entries` match.
+  uint32_t config_axes = 0U;
+
   base::expected<uint32_t, NullOrIOError> GetFlagsForEntryIndex(uint16_t entry_index) const {
     if (entry_index >= dtohl(type_spec->entryCount)) {
       return 0U;
@@ -178,6 +198,10 @@ class LoadedPackage {
   static base::expected<uint32_t, NullOrIOError> GetEntryOffset(
       incfs::verified_map_ptr<ResTable_type> type_chunk, uint16_t entry_index);
 
+  // Same as above, but uses the sparse entry index of `type_entry` when it has one.
+  static base::expected<uint32_t, NullOrIOError> GetEntryOffset(
+      const TypeSpec::TypeEntry& type_entry, uint16_t entry_index);
+
   static base::expected<incfs::verified_map_ptr<ResTable_entry>, NullOrIOError>
       GetEntryFromOffset(incfs::verified_map_ptr<ResTable_type> type_chunk, uint32_t offset);
 
@@ -285,6 +309,11 @@ class LoadedPackage {
     return alias_id_map_;
   }
 
+  // The number of bytes used by the sparse entry indices of the types of this package.
+  size_t GetSparseEntryIndexMemoryUsage() const {
+    return sparse_entry_index_bytes_;
+  }
+
  private:
   DISALLOW_COPY_AND_ASSIGN(LoadedPackage);
 
@@ -299,6 +328,7 @@ class LoadedPackage {
   int package_id_ = -1;
   int type_id_offset_ = 0;
   package_property_t property_flags_ = 0U;
+  size_t sparse_entry_index_bytes_ = 0U;
 
   std::unordered_map<uint8_t, TypeSpec> type_specs_;
   ByteBucketArray<uint32_t> resource_ids_;
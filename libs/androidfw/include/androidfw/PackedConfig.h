@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROIDFW_PACKEDCONFIG_H_
+#define ANDROIDFW_PACKEDCONFIG_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "androidfw/ResourceTypes.h"
+
+namespace android {
+
+// The qualifiers that ResTable_config::match() compares, one per 16-bit lane, so that a whole
+// configuration can be compared with a few vector instructions.
+struct PackedConfig {
+  static constexpr size_t kLaneCount = 32;
+
+  // Packs the configuration requested by an AssetManager.
+  static PackedConfig FromSettings(const ResTable_config& settings);
+
+  alignas(16) uint16_t lanes[kLaneCount] = {};
+};
+
+// The set of requested configurations that a resource configuration matches, expressed as an
+// inclusive range per lane of PackedConfig.
+//
+// A qualifier that the resource leaves unset accepts any value, a qualifier that must be equal
+// accepts exactly one value, and a qualifier that must not be larger than the requested one (like
+// the screen width or the sdk version) accepts a value and everything above it.
+struct PackedConfigRange {
+  // Packs the configuration of a resource.
+  static PackedConfigRange FromConfig(const ResTable_config& config);
+
+  // Returns false if the resource configuration cannot match `settings`. Returns true if it
+  // matches the qualifiers that are packed, which is a full match unless `needs_full_match` is
+  // set.
+  inline bool Contains(const PackedConfig& settings) const {
+    // A lane is in range when both saturating differences are zero.
+#if defined(__ARM_NEON)
+    uint16x8_t violation = vdupq_n_u16(0);
+    for (size_t i = 0; i < PackedConfig::kLaneCount; i += 8) {
+      const uint16x8_t value = vld1q_u16(settings.lanes + i);
+      violation = vorrq_u16(violation, vqsubq_u16(vld1q_u16(min + i), value));
+      violation = vorrq_u16(violation, vqsubq_u16(value, vld1q_u16(max + i)));
+    }
+    const uint64x2_t folded = vreinterpretq_u64_u16(violation);
+    return (vgetq_lane_u64(folded, 0) | vgetq_lane_u64(folded, 1)) == 0;
+#elif defined(__SSE2__)
+    __m128i violation = _mm_setzero_si128();
+    for (size_t i = 0; i < PackedConfig::kLaneCount; i += 8) {
+      const __m128i value = _mm_load_si128(reinterpret_cast<const __m128i*>(settings.lanes + i));
+      const __m128i lower = _mm_load_si128(reinterpret_cast<const __m128i*>(min + i));
+      const __m128i upper = _mm_load_si128(reinterpret_cast<const __m128i*>(max + i));
+      violation = _mm_or_si128(violation, _mm_subs_epu16(lower, value));
+      violation = _mm_or_si128(violation, _mm_subs_epu16(value, upper));
+    }
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(violation, _mm_setzero_si128())) == 0xffff;
+#else
+    uint16_t violation = 0;
+    for (size_t i = 0; i < PackedConfig::kLaneCount; i++) {
+      const uint16_t value = settings.lanes[i];
+      violation |= static_cast<uint16_t>((min[i] > value) | (value > max[i]));
+    }
+    return violation == 0;
+#endif
+  }
+
+  alignas(16) uint16_t min[PackedConfig::kLaneCount] = {};
+  alignas(16) uint16_t max[PackedConfig::kLaneCount] = {};
+
+  // The script and country of a locale are matched in ways that depend on the requested locale,
+  // so resource configurations with a locale must still be checked with ResTable_config::match()
+  // once Contains() passes. Only the language is packed.
+  bool needs_full_match = false;
+};
+
+}  // namespace android
+
+#endif  // ANDROIDFW_PACKEDCONFIG_H_
@@ -31,6 +31,10 @@ constexpr size_t kPngSignatureSize = 8u;
 
 struct PngOptions {
   int grayscale_tolerance = 0;
+
+  // The number of threads used to filter and compress large images. The output does not depend
+  // on it.
+  size_t threads = 1;
 };
 
 /**
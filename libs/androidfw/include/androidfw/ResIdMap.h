@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROIDFW_RESIDMAP_H_
+#define ANDROIDFW_RESIDMAP_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "android-base/logging.h"
+
+namespace android {
+
+/**
+ * A hash map from resource ids to values that stores its keys and values in flat arrays and
+ * resolves collisions with linear probing, so a lookup touches a couple of adjacent cache lines
+ * and an insertion only allocates when the table grows.
+ *
+ * Resource id 0 is never a valid resource and marks empty slots. Pointers to values are
+ * invalidated by any insertion or removal.
+ */
+template <typename T>
+class ResIdMap {
+ public:
+  ResIdMap() = default;
+  ResIdMap(ResIdMap&&) = default;
+  ResIdMap& operator=(ResIdMap&&) = default;
+
+  inline size_t size() const { return size_; }
+  inline bool empty() const { return size_ == 0; }
+
+  T* find(uint32_t resid) {
+    return const_cast<T*>(std::as_const(*this).find(resid));
+  }
+
+  const T* find(uint32_t resid) const {
+    if (size_ == 0) {
+      return nullptr;
+    }
+    for (size_t i = slotFor(resid);; i = (i + 1) & mask_) {
+      if (keys_[i] == resid) {
+        return &values_[i];
+      }
+      if (keys_[i] == 0) {
+        return nullptr;
+      }
+    }
+  }
+
+  // Returns the value for `resid`, inserting a default-constructed value if there is none.
+  T& operator[](uint32_t resid) {
+    DCHECK(resid != 0) << "ResIdMap does not support resource id 0";
+    if (T* value = find(resid)) {
+      return *value;
+    }
+    if ((size_ + 1) * 4 > capacity() * 3) {
+      grow();
+    }
+    size_t i = slotFor(resid);
+    while (keys_[i] != 0) {
+      i = (i + 1) & mask_;
+    }
+    keys_[i] = resid;
+    ++size_;
+    return values_[i];
+  }
+
+  bool erase(uint32_t resid) {
+    if (size_ == 0) {
+      return false;
+    }
+    size_t i = slotFor(resid);
+    while (keys_[i] != resid) {
+      if (keys_[i] == 0) {
+        return false;
+      }
+      i = (i + 1) & mask_;
+    }
+
+    // Shift the following entries of the probe sequence back so that no tombstone is needed.
+    for (size_t j = (i + 1) & mask_; keys_[j] != 0; j = (j + 1) & mask_) {
+      const size_t home = slotFor(keys_[j]);
+      const bool movable = (i <= j) ? (home <= i || home > j) : (home <= i && home > j);
+      if (movable) {
+        keys_[i] = keys_[j];
+        values_[i] = std::move(values_[j]);
+        i = j;
+      }
+    }
+    keys_[i] = 0;
+    values_[i] = T{};
+    --size_;
+    return true;
+  }
+
+  // Removes all the entries for which `pred(resid, value)` returns true.
+  template <class Pred>
+  void eraseIf(Pred pred) {
+    bool erased = false;
+    for (size_t i = 0; i < capacity(); i++) {
+      if (keys_[i] != 0 && pred(keys_[i], values_[i])) {
+        keys_[i] = 0;
+        values_[i] = T{};
+        --size_;
+        erased = true;
+      }
+    }
+    if (erased) {
+      // Reinsert the survivors so that their probe sequences have no holes.
+      rehash(capacity());
+    }
+  }
+
+  template <class Func>
+  void forEachItem(Func f) const {
+    for (size_t i = 0; i < capacity(); i++) {
+      if (keys_[i] != 0) {
+        f(keys_[i], values_[i]);
+      }
+    }
+  }
+
+  void clear() {
+    keys_.reset();
+    values_.reset();
+    mask_ = 0;
+    shift_ = 0;
+    size_ = 0;
+  }
+
+ private:
+  static constexpr size_t kInitialCapacity = 16;
+
+  inline size_t capacity() const { return keys_ ? mask_ + 1 : 0; }
+
+  inline size_t slotFor(uint32_t resid) const {
+    // Fibonacci hashing spreads the dense entry ids of a type across the whole table.
+    return static_cast<size_t>((resid * 0x9e3779b9U) >> shift_) & mask_;
+  }
+
+  void grow() {
+    rehash(capacity() == 0 ? kInitialCapacity : capacity() * 2);
+  }
+
+  void rehash(size_t new_capacity) {
+    const size_t old_capacity = capacity();
+    auto old_keys = std::move(keys_);
+    auto old_values = std::move(values_);
+
+    keys_ = std::make_unique<uint32_t[]>(new_capacity);
+    values_ = std::make_unique<T[]>(new_capacity);
+    mask_ = new_capacity - 1;
+    shift_ = 32;
+    for (size_t c = new_capacity; c > 1; c >>= 1) {
+      --shift_;
+    }
+
+    for (size_t i = 0; i < old_capacity; i++) {
+      if (old_keys[i] != 0) {
+        size_t j = slotFor(old_keys[i]);
+        while (keys_[j] != 0) {
+          j = (j + 1) & mask_;
+        }
+        keys_[j] = old_keys[i];
+        values_[j] = std::move(old_values[i]);
+      }
+    }
+  }
+
+  std::unique_ptr<uint32_t[]> keys_;
+  std::unique_ptr<T[]> values_;
+  size_t mask_ = 0;
+  uint32_t shift_ = 0;
+  size_t size_ = 0;
+};
+
+}  // namespace android
+
+#endif  // ANDROIDFW_RESIDMAP_H_
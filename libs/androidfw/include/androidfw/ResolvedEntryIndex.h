@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROIDFW_RESOLVEDENTRYINDEX_H_
+#define ANDROIDFW_RESOLVEDENTRYINDEX_H_
+
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "android-base/macros.h"
+#include "android-base/mapped_file.h"
+#include "android-base/unique_fd.h"
+
+namespace android {
+
+// A precomputed, read-only table that records which type entry won the configuration match for
+// every resource id of an AssetManager2 with a given set of ApkAssets and a given configuration.
+//
+// The index is a flat file that is mapped read-only, so processes that use the same ApkAssets
+// and configuration share its pages. The index is only an accelerator: every entry it returns is
+// bounds-checked against the loaded resource table before it is used, and lookups that miss fall
+// back to the regular configuration scan.
+class ResolvedEntryIndex {
+ public:
+  static constexpr uint32_t kMagic = 0x58444952;  // RIDX
+  static constexpr uint32_t kVersion = 1;
+
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+
+    // Identifies the ApkAssets set and configuration the index was built for.
+    // See AssetManager2::GetResolvedEntryIndexKey().
+    uint64_t key;
+
+    uint32_t entry_count;
+    uint32_t reserved;
+  };
+
+  // The winning entry for a single resource id. Entries are sorted by `resid`.
+  struct Entry {
+    // The runtime resource id.
+    uint32_t resid;
+
+    // The type spec flags OR'd over every package of the package group.
+    uint32_t type_flags;
+
+    // The offset of the ResTable_entry within the winning ResTable_type.
+    uint32_t entry_offset;
+
+    // The index of the winning package within its package group.
+    uint16_t package_index;
+
+    // The index of the winning ResTable_type within TypeSpec::type_entries.
+    uint16_t type_entry_index;
+  };
+
+  // Creates an in-memory index from `entries`, which do not need to be sorted.
+  static std::unique_ptr<const ResolvedEntryIndex> Create(uint64_t key,
+                                                          std::vector<Entry> entries);
+
+  // Maps the index stored at `path`. Returns nullptr if the file is missing or malformed.
+  static std::unique_ptr<const ResolvedEntryIndex> Load(const std::string& path);
+
+  // Maps the index stored in `fd`. Returns nullptr if the file is malformed.
+  static std::unique_ptr<const ResolvedEntryIndex> LoadFromFd(base::borrowed_fd fd);
+
+  // Writes the index in its on-disk format to `fd`.
+  bool WriteToFd(base::borrowed_fd fd) const;
+
+  uint64_t GetKey() const {
+    return key_;
+  }
+
+  size_t GetEntryCount() const {
+    return entries_.size();
+  }
+
+  // Returns the winning entry for `resid`, or nullptr if the index has no entry for it.
+  const Entry* Find(uint32_t resid) const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ResolvedEntryIndex);
+
+  ResolvedEntryIndex() = default;
+
+  uint64_t key_ = 0U;
+  std::span<const Entry> entries_;
+
+  // Backing storage for the entries. Exactly one of these is set.
+  std::unique_ptr<base::MappedFile> mapped_file_;
+  std::vector<Entry> owned_entries_;
+};
+
+}  // namespace android
+
+#endif  // ANDROIDFW_RESOLVEDENTRYINDEX_H_
@@ -28,7 +28,8 @@
 namespace android {
 
 // ResourceTimer captures the duration of short functions.  Durations are accumulated in registers
-// and statistics are pulled back to the Java layer as needed.
+// and statistics are pulled back to the Java layer as needed.  Each thread accumulates into its
+// own registers, so that threads recording the same API do not contend with each other.
 // To monitor an API, first add it to the Counter enumeration.  Then, inside the API, create an
 // instance of ResourceTimer with the appropriate enumeral.  The corresponding counter will be
 // updated when the ResourceTimer destructor is called, normally at the end of the enclosing block.
@@ -37,8 +38,18 @@ class ResourceTimer {
   enum class Counter {
     GetResourceValue,
     RetrieveAttributes,
-
-    LastCounter = RetrieveAttributes,
+    GetBag,
+    ApplyStyle,
+    ResolveAttrs,
+    ThemeApplyStyle,
+    ApkAssetsLoad,
+
+    // Lookups of cached Java strings in string blocks.  These are counted with count() and are
+    // not timed.
+    StringBlockCacheHit,
+    StringBlockCacheMiss,
+
+    LastCounter = StringBlockCacheMiss,
   };
   static const int counterSize = static_cast<int>(Counter::LastCounter) + 1;
   static char const *toString(Counter);
@@ -55,6 +66,11 @@ class ResourceTimer {
   // This cancels a timer.  Elapsed time will neither be computed nor recorded.
   void cancel();
 
+  // Count an event that is too short to be worth timing, such as a cache hit.  The events are
+  // reported as the count of the counter's Timer, without any durations.  This does not take a
+  // lock.
+  static void count(Counter);
+
   // A single timer contains the count of events and the cumulative time spent handling the
   // events.  It also includes the smallest value seen and 10 largest values seen.  Finally, it
   // includes a histogram of values that approximates a semi-log.
@@ -133,6 +149,9 @@ class ResourceTimer {
     // copy.  The reset flag is exploited to make the copy faster.  Any data in dst is lost.
     static void copy(Timer &dst, Timer &src, bool reset);
 
+    // Add the events of another timer to this one, as if they had been recorded here.
+    void merge(const Timer &src);
+
    private:
     // Free any buckets.
     void freeBuckets();
@@ -161,10 +180,10 @@ class ResourceTimer {
     int *buckets[MaxDimension];
   };
 
-  // Fetch one Timer.  The function has a short-circuit behavior: if the count is zero then
-  // destination count is set to zero and the function returns false.  Otherwise, the destination
-  // is a copy of the source and the function returns true.  This behavior lowers the cost of
-  // handling unused timers.
+  // Fetch one Timer, merged across all threads.  The function has a short-circuit behavior: if
+  // the count is zero then destination count is set to zero and the function returns false.
+  // Otherwise, the destination is a copy of the source and the function returns true.  This
+  // behavior lowers the cost of handling unused timers.
   static bool copy(int src, Timer &dst, bool reset);
 
   // Enable the timers.  Timers are initially disabled.  Enabling timers allocates memory for the
@@ -203,6 +222,11 @@ class ResourceTimer {
     }
   };
 
+  // The timers of one thread.  These are registered when the thread first records an event and
+  // merged into counter_ when the thread exits.
+  struct ThreadTimers;
+  static GuardedTimer& threadTimer(Counter);
+
   // An individual timer is active (or not), is tracking a specific API, and has a start time.
   // The api and the start time are undefined if the timer is not active.
   bool active_;
@@ -212,8 +236,13 @@ class ResourceTimer {
   // The global enable flag.  This is initially false and may be set true by the java runtime.
   static std::atomic<bool> enabled_;
 
-  // The global timers.  The memory for the timers is not allocated until the timers are enabled.
+  // The timers of the threads that have exited.  The memory for the timers is not allocated until
+  // the timers are enabled.
   static std::atomic<GuardedTimer *> counter_;
+
+  // The events counted by count() since the last reset, folded into the timers when they are
+  // copied.
+  static std::atomic<int> events_[counterSize];
 };
 
 }  // namespace android
@@ -38,6 +38,7 @@
 #include <sys/types.h>
 
 #include <array>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <optional>
@@ -554,6 +555,22 @@ public:
     bool isSorted() const;
     bool isUTF8() const;
 
+    // A cache that a client attaches to the pool to keep the strings of the pool in its own
+    // representation, such as the Java strings created by the framework.  The cache is destroyed
+    // with the pool, or when the pool is re-initialized.
+    class ClientCache {
+    public:
+        virtual ~ClientCache() = default;
+    };
+
+    // Returns the attached client cache, or null if there is none.  Does not take a lock.
+    ClientCache* clientCache() const {
+        return mClientCache.load(std::memory_order_acquire);
+    }
+
+    // Attaches `cache` unless another cache was attached first, and returns the attached cache.
+    ClientCache* setClientCache(std::unique_ptr<ClientCache> cache) const;
+
 private:
     status_t                                      mError;
     void*                                         mOwnedData;
@@ -572,6 +589,8 @@ private:
                                     std::unordered_map<std::u16string_view, int>>>
         mIndexLookupCache;
 
+    mutable std::atomic<ClientCache*>             mClientCache = nullptr;
+
     base::expected<StringPiece, NullOrIOError> stringDecodeAt(
         size_t idx, incfs::map_ptr<uint8_t> str, size_t encLen) const;
 };
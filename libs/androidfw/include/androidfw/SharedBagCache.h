@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROIDFW_SHAREDBAGCACHE_H_
+#define ANDROIDFW_SHAREDBAGCACHE_H_
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "android-base/macros.h"
+#include "android-base/thread_annotations.h"
+#include "androidfw/Util.h"
+
+namespace android {
+
+struct ResolvedBag;
+
+// A process-wide cache of resolved bags that is shared by every AssetManager2 with the same set
+// of ApkAssets and configuration.
+//
+// A resolved bag only depends on the ordered list of ApkAssets, the configuration and the
+// resource id, so AssetManagers with equal inputs are assigned the same context id and can reuse
+// each other's bags. Entries are immutable once inserted and are never removed, which lets
+// lookups run without taking a lock. The memory used by the cache is bounded; once the cache is
+// full, AssetManagers keep their bags to themselves.
+class SharedBagCache {
+ public:
+  struct Entry {
+    uint32_t resid;
+    uint32_t context;
+    util::unique_cptr<ResolvedBag> bag;
+
+    // The chain of styles that were traversed to resolve the bag, starting with `resid`.
+    std::vector<uint32_t> resid_stack;
+
+    const Entry* next;
+  };
+
+  static SharedBagCache& Get();
+
+  // Returns the context id for `key`, which serializes everything a bag depends on besides its
+  // resource id. Returns 0 if no more contexts can be created.
+  uint32_t GetContext(std::string key);
+
+  // Returns the entry for `resid` in `context`, or nullptr if there is none. Thread-safe and
+  // lock-free.
+  const Entry* Find(uint32_t context, uint32_t resid) const;
+
+  // Publishes `bag` for `resid` in `context` and returns the entry in the cache. If another
+  // thread published the same bag first, the existing entry is returned and `bag` is left
+  // untouched. Returns nullptr if the cache is full.
+  const Entry* Insert(uint32_t context, uint32_t resid, util::unique_cptr<ResolvedBag>& bag,
+                      std::span<const uint32_t> resid_stack);
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SharedBagCache);
+
+  static constexpr size_t kBucketCount = 4096;
+  static constexpr size_t kMaxBytes = 8 * 1024 * 1024;
+  static constexpr size_t kMaxContexts = 1024;
+
+  SharedBagCache() = default;
+
+  static size_t BucketIndex(uint32_t context, uint32_t resid);
+
+  std::array<std::atomic<const Entry*>, kBucketCount> buckets_ = {};
+  std::atomic<size_t> bytes_used_ = 0;
+
+  std::mutex contexts_lock_;
+  std::map<std::string, uint32_t> contexts_ GUARDED_BY(contexts_lock_);
+};
+
+}  // namespace android
+
+#endif  // ANDROIDFW_SHAREDBAGCACHE_H_
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROIDFW_SPARSEENTRYINDEX_H_
+#define ANDROIDFW_SPARSEENTRYINDEX_H_
+
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "androidfw/ResourceTypes.h"
+#include "androidfw/Util.h"
+
+namespace android {
+
+// A rank directory over the entries of a sparse ResTable_type, which finds the position of an
+// entry in the sorted ResTable_sparseTypeEntry array with a bit test and a popcount instead of a
+// binary search.
+//
+// Every entry index of the type has one bit that is set if the entry is present, and every 64 bits
+// have the number of entries present before them. This takes 12 bytes per 64 entry indices, and
+// Create() only builds an index that is no larger than the sparse entry array it covers.
+class SparseEntryIndex {
+ public:
+  // Returns nullptr if `type_chunk` is not sparse, has too few entries to benefit from an index,
+  // would need more memory than its entries, or cannot be read.
+  static std::unique_ptr<const SparseEntryIndex> Create(
+      incfs::verified_map_ptr<ResTable_type> type_chunk);
+
+  // Returns the position of `entry_index` in the sparse entries, or nullopt if the type has no
+  // such entry.
+  inline std::optional<uint32_t> Find(uint16_t entry_index) const {
+    const size_t word = entry_index / 64U;
+    if (word >= word_count_) {
+      return std::nullopt;
+    }
+    const uint64_t mask = uint64_t{1} << (entry_index % 64U);
+    const uint64_t bits = bits_[word];
+    if ((bits & mask) == 0U) {
+      return std::nullopt;
+    }
+    return ranks_[word] + static_cast<uint32_t>(std::popcount(bits & (mask - 1U)));
+  }
+
+  // The number of bytes used by this index.
+  size_t GetMemoryUsage() const {
+    return sizeof(*this) + word_count_ * (sizeof(uint64_t) + sizeof(uint32_t));
+  }
+
+ private:
+  SparseEntryIndex() = default;
+
+  size_t word_count_ = 0U;
+  std::unique_ptr<uint64_t[]> bits_;
+  std::unique_ptr<uint32_t[]> ranks_;
+};
+
+}  // namespace android
+
+#endif  // ANDROIDFW_SPARSEENTRYINDEX_H_
@@ -20,6 +20,9 @@
 #include <unistd.h>
 #include <inttypes.h>
 
+#include <memory>
+#include <vector>
+
 #include <util/map_ptr.h>
 #include <zlib.h>
 
@@ -32,6 +35,12 @@ public:
     static const size_t INPUT_CHUNK_SIZE = 64 * 1024;
     static const size_t OUTPUT_CHUNK_SIZE = 64 * 1024;
 
+    // Data larger than this gets inflate checkpoints.
+    static const size_t CHECKPOINT_MIN_SIZE = 1024 * 1024;
+    // The minimum amount of uncompressed data between two checkpoints. Each checkpoint keeps a
+    // copy of the 32 KiB inflate window, so this bounds their memory to 1/16 of the data.
+    static const size_t CHECKPOINT_INTERVAL = 512 * 1024;
+
     // Flavor that pages in the compressed data from a fd
     StreamingZipInflater(int fd, off64_t compDataStart, size_t uncompSize, size_t compSize);
 
@@ -44,14 +53,29 @@ public:
     // be NULL, in which case the data is consumed and discarded.
     ssize_t read(void* outBuf, size_t count);
 
-    // seeking backwards requires uncompressing fom the beginning, so is very
-    // expensive.  seeking forwards only requires uncompressing from the current
-    // position to the destination.
+    // seeking backwards requires uncompressing from the nearest checkpoint before the
+    // destination, or from the beginning if there is none.  seeking forwards only requires
+    // uncompressing from the current position, or from a checkpoint closer to the destination.
+    //
+    // Checkpoints are recorded while large data is inflated, so the data before a position
+    // has to have been read once for seeks to it to be cheap.
     off64_t seekAbsolute(off64_t absoluteInputPosition);
 
 private:
+    // The state of the inflater at a deflate block boundary, from which it can resume.
+    struct Checkpoint {
+        off64_t outPosition;    // offset of the next uncompressed byte
+        size_t inPosition;      // offset of the next compressed byte
+        int bits;               // unused bits of the compressed byte before inPosition
+        uint8_t lastInByte;     // the compressed byte before inPosition, if bits > 0
+        size_t windowSize;
+        std::unique_ptr<uint8_t[]> window;
+    };
+
     void initInflateState();
     int readNextChunk();
+    void maybeAddCheckpoint();
+    bool restoreCheckpoint(const Checkpoint& checkpoint);
 
     // where to find the uncompressed data
     int mFd;
@@ -79,6 +103,10 @@ private:
     // input state bookkeeping
     size_t mInNextChunkOffset;  // offset from start of blob at which the next input chunk lies
     // the z_stream contains state about input block consumption
+
+    // checkpoints, sorted by position; only recorded when mUseCheckpoints is set
+    bool mUseCheckpoints;
+    std::vector<Checkpoint> mCheckpoints;
 };
 
 }
@@ -30,6 +30,7 @@ struct TypeVariant {
         iterator& operator=(const iterator& rhs) {
             mTypeVariant = rhs.mTypeVariant;
             mIndex = rhs.mIndex;
+            mSparsePos = rhs.mSparsePos;
             return *this;
         }
 
@@ -42,9 +43,9 @@ struct TypeVariant {
         }
 
         iterator operator++(int) {
-            uint32_t prevIndex = mIndex;
+            iterator prev = *this;
             operator++();
-            return iterator(mTypeVariant, prevIndex);
+            return prev;
         }
 
         const ResTable_entry* operator->() const {
@@ -60,10 +61,12 @@ struct TypeVariant {
 
     private:
         friend struct TypeVariant;
-        iterator(const TypeVariant* tv, uint32_t index)
-            : mTypeVariant(tv), mIndex(index) {}
+        iterator(const TypeVariant* tv, uint32_t index);
         const TypeVariant* mTypeVariant;
         uint32_t mIndex;
+        // For sparse types, the position of the first entry index that is not below mIndex.
+        // Iterating moves it forward instead of searching the indices for every entry.
+        uint32_t mSparsePos = 0;
     };
 
     iterator beginEntries() const {
@@ -78,6 +81,12 @@ struct TypeVariant {
 
 private:
     size_t mLength;
+
+    // The entry index table is bounds checked once for the whole type. It is null if the table
+    // extends past the type, in which case every entry reads as missing.
+    const uint32_t* mEntryIndices = nullptr;
+    uint32_t mEntryCount = 0;
+    uintptr_t mContainerEnd = 0;
 };
 
 } // namespace android
@@ -76,6 +76,36 @@ TEST(ApkAssetsTest, LoadApkAsSharedLibrary) {
   EXPECT_TRUE(loaded_arsc->GetPackages()[0]->IsDynamic());
 }
 
+TEST(ApkAssetsTest, LoadAllKeepsRequestOrder) {
+  const std::string data_path = GetTestDataPath();
+  const ApkAssets::LoadRequest requests[] = {
+      {.path = data_path + "/basic/basic.apk"},
+      {.path = data_path + "/does/not/exist.apk"},
+      {.path = data_path + "/appaslib/appaslib.apk", .flags = PROPERTY_DYNAMIC},
+      {.path = data_path + "/styles/styles.apk"},
+  };
+
+  std::vector<std::string> errors;
+  auto loaded = ApkAssets::LoadAll(requests, &errors, 2U /* max_threads */);
+  ASSERT_THAT(loaded, SizeIs(4u));
+  ASSERT_THAT(errors, SizeIs(4u));
+
+  ASSERT_THAT(loaded[0], NotNull());
+  EXPECT_THAT(loaded[0]->GetDebugName(), StrEq(requests[0].path));
+  EXPECT_TRUE(errors[0].empty());
+
+  EXPECT_EQ(nullptr, loaded[1]);
+  EXPECT_NE(std::string::npos, errors[1].find(requests[1].path));
+
+  ASSERT_THAT(loaded[2], NotNull());
+  ASSERT_THAT(loaded[2]->GetLoadedArsc()->GetPackages(), SizeIs(1u));
+  EXPECT_TRUE(loaded[2]->GetLoadedArsc()->GetPackages()[0]->IsDynamic());
+
+  ASSERT_THAT(loaded[3], NotNull());
+  EXPECT_THAT(loaded[3]->GetDebugName(), StrEq(requests[3].path));
+  EXPECT_TRUE(errors[3].empty());
+}
+
 TEST(ApkAssetsTest, CreateAndDestroyAssetKeepsApkAssetsOpen) {
   auto loaded_apk = ApkAssets::Load(GetTestDataPath() + "/basic/basic.apk");
   ASSERT_THAT(loaded_apk, NotNull());
@@ -238,6 +238,52 @@ static void BM_AssetManagerSetConfigurationFramework(benchmark::State& state) {
 }
 BENCHMARK(BM_AssetManagerSetConfigurationFramework);
 
+// Measures the cost of a configuration change that only touches a single axis, such as a rotation
+// or a night mode toggle, with resources cached from a previous configuration.
+static void BM_AssetManagerChangeConfigurationFramework(benchmark::State& state,
+                                                        void (*change)(ResTable_config&)) {
+  auto apk = ApkAssets::Load(kFrameworkPath);
+  if (apk == nullptr) {
+    state.SkipWithError("Failed to load assets");
+    return;
+  }
+
+  AssetManager2 assets;
+  assets.SetApkAssets({apk});
+
+  ResTable_config config;
+  memset(&config, 0, sizeof(config));
+  config.orientation = ResTable_config::ORIENTATION_PORT;
+  config.uiMode = ResTable_config::UI_MODE_NIGHT_NO;
+  config.density = ResTable_config::DENSITY_XHIGH;
+  std::vector<ResTable_config> configs;
+  configs.push_back(config);
+  assets.SetConfigurations(configs);
+
+  for (auto&& _ : state) {
+    change(configs[0]);
+    assets.SetConfigurations(configs);
+    benchmark::DoNotOptimize(assets.GetResource(kStringOkId));
+  }
+}
+BENCHMARK_CAPTURE(BM_AssetManagerChangeConfigurationFramework, orientation,
+                  [](ResTable_config& config) {
+                    config.orientation = config.orientation == ResTable_config::ORIENTATION_PORT
+                                             ? ResTable_config::ORIENTATION_LAND
+                                             : ResTable_config::ORIENTATION_PORT;
+                  });
+BENCHMARK_CAPTURE(BM_AssetManagerChangeConfigurationFramework, night_mode,
+                  [](ResTable_config& config) {
+                    config.uiMode ^= ResTable_config::UI_MODE_NIGHT_NO ^
+                                     ResTable_config::UI_MODE_NIGHT_YES;
+                  });
+BENCHMARK_CAPTURE(BM_AssetManagerChangeConfigurationFramework, density,
+                  [](ResTable_config& config) {
+                    config.density = config.density == ResTable_config::DENSITY_XHIGH
+                                         ? ResTable_config::DENSITY_XXHIGH
+                                         : ResTable_config::DENSITY_XHIGH;
+                  });
+
 static void BM_AssetManagerSetConfigurationFrameworkOld(benchmark::State& state) {
   AssetManager assets;
   if (!assets.addAssetPath(String8(kFrameworkPath), nullptr /*cookie*/, false /*appAsLib*/,
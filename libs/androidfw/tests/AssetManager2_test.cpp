@@ -405,6 +405,74 @@ TEST_F(AssetManager2Test, MergeStylesCircularDependency) {
   ASSERT_EQ(3u, (*bag)->entry_count);
 }
 
+TEST_F(AssetManager2Test, SharesBagsBetweenAssetManagersWithSameInputs) {
+  AssetManager2 first;
+  first.SetApkAssets({basic_assets_});
+  AssetManager2 second;
+  second.SetApkAssets({basic_assets_});
+
+  auto first_bag = first.GetBag(basic::R::array::integerArray1);
+  ASSERT_TRUE(first_bag.has_value());
+  auto second_bag = second.GetBag(basic::R::array::integerArray1);
+  ASSERT_TRUE(second_bag.has_value());
+  EXPECT_EQ(*first_bag, *second_bag);
+
+  ResTable_config desired_config;
+  memset(&desired_config, 0, sizeof(desired_config));
+  desired_config.language[0] = 'd';
+  desired_config.language[1] = 'e';
+  second.SetConfigurations({{desired_config}});
+
+  auto third_bag = second.GetBag(basic::R::array::integerArray1);
+  ASSERT_TRUE(third_bag.has_value());
+  EXPECT_NE(*first_bag, *third_bag);
+  EXPECT_EQ(3u, (*third_bag)->entry_count);
+}
+
+TEST_F(AssetManager2Test, SharedBagsKeepResIdStack) {
+  AssetManager2 first;
+  first.SetApkAssets({style_assets_});
+  auto first_stack = first.GetBagResIdStack(app::R::style::StyleTwo);
+  ASSERT_TRUE(first_stack.has_value());
+
+  AssetManager2 second;
+  second.SetApkAssets({style_assets_});
+  auto second_stack = second.GetBagResIdStack(app::R::style::StyleTwo);
+  ASSERT_TRUE(second_stack.has_value());
+  EXPECT_EQ(**first_stack, **second_stack);
+}
+
+TEST_F(AssetManager2Test, KeepsFilteredTypesAcrossUnrelatedConfigurationChanges) {
+  ResTable_config desired_config;
+  memset(&desired_config, 0, sizeof(desired_config));
+  desired_config.language[0] = 'd';
+  desired_config.language[1] = 'e';
+
+  AssetManager2 assetmanager;
+  assetmanager.SetConfigurations({{desired_config}});
+  assetmanager.SetApkAssets({basic_assets_, basic_de_fr_assets_});
+
+  // None of the resources vary with the orientation, so their filtered types are kept.
+  desired_config.orientation = ResTable_config::ORIENTATION_LAND;
+  assetmanager.SetConfigurations({{desired_config}});
+
+  auto value = assetmanager.GetResource(basic::R::string::test1);
+  ASSERT_TRUE(value.has_value());
+  EXPECT_EQ(1, value->cookie);
+  EXPECT_EQ('d', value->config.language[0]);
+  EXPECT_EQ('e', value->config.language[1]);
+
+  desired_config.language[0] = 'f';
+  desired_config.language[1] = 'r';
+  assetmanager.SetConfigurations({{desired_config}});
+
+  value = assetmanager.GetResource(basic::R::string::test1);
+  ASSERT_TRUE(value.has_value());
+  EXPECT_EQ(1, value->cookie);
+  EXPECT_EQ('f', value->config.language[0]);
+  EXPECT_EQ('r', value->config.language[1]);
+}
+
 TEST_F(AssetManager2Test, ResolveReferenceToResource) {
   AssetManager2 assetmanager;
   assetmanager.SetApkAssets({basic_assets_});
@@ -712,6 +780,8 @@ TEST_F(AssetManager2Test, OpenDirFromManyApks) {
 
   EXPECT_THAT(asset_dir->getFileName(1), Eq(String8("file.txt")));
   EXPECT_THAT(asset_dir->getFileType(1), Eq(FileType::kFileTypeRegular));
+  // Names present in several APKs are attributed to the first one.
+  EXPECT_THAT(asset_dir->getSourceName(1), Eq(String8(system_assets_->GetDebugName().c_str())));
 
   EXPECT_THAT(asset_dir->getFileName(2), Eq(String8("subdir")));
   EXPECT_THAT(asset_dir->getFileType(2), Eq(FileType::kFileTypeDirectory));
@@ -834,6 +904,72 @@ TEST_F(AssetManager2Test, GetOverlayablesToString) {
             std::string::npos);
 }
 
+TEST_F(AssetManager2Test, ResolvedEntryIndexMatchesConfigurationScan) {
+  ResTable_config desired_config;
+  memset(&desired_config, 0, sizeof(desired_config));
+  desired_config.language[0] = 'd';
+  desired_config.language[1] = 'e';
+
+  AssetManager2 reference;
+  reference.SetConfigurations({{desired_config}});
+  reference.SetApkAssets({basic_assets_, basic_de_fr_assets_});
+
+  auto index = reference.BuildResolvedEntryIndex();
+  ASSERT_THAT(index, NotNull());
+  EXPECT_EQ(reference.GetResolvedEntryIndexKey(), index->GetKey());
+  EXPECT_NE(nullptr, index->Find(basic::R::string::test1));
+
+  TemporaryFile file;
+  ASSERT_TRUE(index->WriteToFd(file.fd));
+  std::shared_ptr<const ResolvedEntryIndex> loaded = ResolvedEntryIndex::Load(file.path);
+  ASSERT_THAT(loaded, NotNull());
+  EXPECT_EQ(index->GetEntryCount(), loaded->GetEntryCount());
+
+  AssetManager2 assetmanager;
+  assetmanager.SetConfigurations({{desired_config}});
+  assetmanager.SetApkAssets({basic_assets_, basic_de_fr_assets_});
+  ASSERT_TRUE(assetmanager.SetResolvedEntryIndex(loaded));
+
+  for (uint32_t resid : {(uint32_t)basic::R::string::test1, (uint32_t)basic::R::string::test2,
+                         (uint32_t)basic::R::integer::number1,
+                         (uint32_t)basic::R::integer::ref1}) {
+    auto expected = reference.GetResource(resid);
+    auto actual = assetmanager.GetResource(resid);
+    ASSERT_TRUE(expected.has_value());
+    ASSERT_TRUE(actual.has_value());
+    EXPECT_EQ(expected->cookie, actual->cookie);
+    EXPECT_EQ(expected->type, actual->type);
+    EXPECT_EQ(expected->data, actual->data);
+    EXPECT_EQ(expected->flags, actual->flags);
+    EXPECT_EQ(0, expected->config.compare(actual->config));
+  }
+
+  auto bag = assetmanager.GetBag(basic::R::array::integerArray1);
+  ASSERT_TRUE(bag.has_value());
+  EXPECT_EQ(3u, (*bag)->entry_count);
+}
+
+TEST_F(AssetManager2Test, ResolvedEntryIndexRejectsDifferentConfiguration) {
+  AssetManager2 reference;
+  reference.SetApkAssets({basic_assets_, basic_de_fr_assets_});
+  std::shared_ptr<const ResolvedEntryIndex> index = reference.BuildResolvedEntryIndex();
+  ASSERT_THAT(index, NotNull());
+
+  ResTable_config desired_config;
+  memset(&desired_config, 0, sizeof(desired_config));
+  desired_config.language[0] = 'f';
+  desired_config.language[1] = 'r';
+
+  AssetManager2 assetmanager;
+  assetmanager.SetConfigurations({{desired_config}});
+  assetmanager.SetApkAssets({basic_assets_, basic_de_fr_assets_});
+  EXPECT_FALSE(assetmanager.SetResolvedEntryIndex(index));
+
+  auto value = assetmanager.GetResource(basic::R::string::test1);
+  ASSERT_TRUE(value.has_value());
+  EXPECT_EQ(1, value->cookie);
+}
+
 TEST_F(AssetManager2Test, GetApkAssets) {
   AssetManager2 assetmanager;
   assetmanager.SetApkAssets({overlayable_assets_, overlay_assets_, lib_one_assets_});
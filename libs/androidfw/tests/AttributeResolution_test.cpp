@@ -16,6 +16,7 @@
 
 #include "androidfw/AttributeResolution.h"
 
+#include <algorithm>
 #include <array>
 
 #include "android-base/file.h"
@@ -272,5 +273,32 @@ TEST_F(AttributeResolutionXmlTest, ThemeAndXmlParser) {
   EXPECT_EQ(expected_indices, indices);
 }
 
+TEST_F(AttributeResolutionXmlTest, ApplyStylesMatchesApplyStyle) {
+  std::unique_ptr<Theme> theme = assetmanager_.NewTheme();
+  ASSERT_TRUE(theme->ApplyStyle(R::style::StyleTwo).has_value());
+
+  std::array<uint32_t, 6> attrs{{R::attr::attr_one, R::attr::attr_two, R::attr::attr_three,
+                                 R::attr::attr_four, R::attr::attr_five, R::attr::attr_empty}};
+  const std::array<ResXMLParser*, 3> parsers{{&xml_parser_, nullptr, &xml_parser_}};
+  std::array<uint32_t, parsers.size() * attrs.size() * STYLE_NUM_ENTRIES> batch_values;
+  std::array<uint32_t, parsers.size() * (attrs.size() + 1)> batch_indices{};
+  ASSERT_TRUE(ApplyStyles(theme.get(), parsers, 0u /*def_style_attr*/, R::style::StyleOne,
+                          attrs.data(), attrs.size(), batch_values.data(), batch_indices.data())
+                  .has_value());
+
+  for (size_t i = 0; i < parsers.size(); i++) {
+    std::array<uint32_t, attrs.size() * STYLE_NUM_ENTRIES> values;
+    std::array<uint32_t, attrs.size() + 1> indices{};
+    ASSERT_TRUE(ApplyStyle(theme.get(), parsers[i], 0u /*def_style_attr*/, R::style::StyleOne,
+                           attrs.data(), attrs.size(), values.data(), indices.data())
+                    .has_value());
+    EXPECT_TRUE(std::equal(values.begin(), values.end(), batch_values.begin() + i * values.size()))
+        << "parser " << i;
+    EXPECT_TRUE(
+        std::equal(indices.begin(), indices.end(), batch_indices.begin() + i * indices.size()))
+        << "parser " << i;
+  }
+}
+
 } // namespace android
 
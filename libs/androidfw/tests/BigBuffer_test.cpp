@@ -16,6 +16,8 @@
 
 #include "androidfw/BigBuffer.h"
 
+#include <algorithm>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -114,4 +116,27 @@ TEST(BigBufferTest, BackUpZeroed) {
   ASSERT_EQ(0, *new_block);
 }
 
+TEST(BigBufferTest, PoolRecyclesZeroedBlocks) {
+  BigBufferPool pool(16);
+
+  uint8_t* first_block;
+  {
+    BigBuffer buffer(&pool);
+    EXPECT_EQ(16u, buffer.block_size());
+    first_block = buffer.NextBlock<uint8_t>(4);
+    ASSERT_THAT(first_block, NotNull());
+    std::fill_n(first_block, 4, 0xff);
+
+    // Blocks larger than the pool's are not recycled.
+    ASSERT_THAT(buffer.NextBlock<uint8_t>(32), NotNull());
+  }
+
+  BigBuffer buffer(&pool);
+  uint8_t* block = buffer.NextBlock<uint8_t>(16);
+  ASSERT_EQ(first_block, block);
+  for (size_t i = 0; i < 16; i++) {
+    EXPECT_EQ(0u, block[i]);
+  }
+}
+
 }  // namespace android
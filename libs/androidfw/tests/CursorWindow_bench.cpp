@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <vector>
+
 #include "benchmark/benchmark.h"
 
 #include "androidfw/CursorWindow.h"
@@ -83,4 +85,34 @@ static void BM_CursorWindowRead16Kx4(benchmark::State& state) {
 }
 BENCHMARK(BM_CursorWindowRead16Kx4);
 
+static void BM_CursorWindowReadColumn(benchmark::State& state, size_t rows, size_t cols) {
+    CursorWindow* w;
+    CursorWindow::create(String8("test"), 1 << 21, &w);
+    w->setNumColumns(cols);
+    for (int row = 0; row < rows; row++) {
+        w->allocRow();
+        for (int col = 0; col < cols; col++) {
+            w->putLong(row, col, 0xcafe);
+        }
+    }
+
+    std::vector<int64_t> values(rows);
+    while (state.KeepRunning()) {
+        for (int col = 0; col < cols; col++) {
+            w->getLongs(col, 0, rows, values.data());
+            benchmark::DoNotOptimize(values.data());
+        }
+    }
+}
+
+static void BM_CursorWindowReadColumn1Kx4(benchmark::State& state) {
+    BM_CursorWindowReadColumn(state, 1024, 4);
+}
+BENCHMARK(BM_CursorWindowReadColumn1Kx4);
+
+static void BM_CursorWindowReadColumn16Kx4(benchmark::State& state) {
+    BM_CursorWindowReadColumn(state, 16384, 4);
+}
+BENCHMARK(BM_CursorWindowReadColumn16Kx4);
+
 }  // namespace android
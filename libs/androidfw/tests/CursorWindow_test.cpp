@@ -197,6 +197,51 @@ TEST(CursorWindowTest, StoreBounds) {
     ASSERT_ALIGNED(w);
 }
 
+TEST(CursorWindowTest, GetColumn) {
+    CREATE_WINDOW_1K_3X3;
+
+    ASSERT_EQ(w->putLong(0, 1, 0xf00d), OK);
+    ASSERT_EQ(w->putDouble(1, 1, 2.5), OK);
+    ASSERT_EQ(w->putString(2, 1, "42", 3), OK);
+    ASSERT_EQ(w->putLong(0, 2, 0xcafe), OK);
+
+    int64_t longs[3] = {-1, -1, -1};
+    ASSERT_EQ(w->getLongs(1, 0, 3, longs), OK);
+    ASSERT_EQ(longs[0], 0xf00d);
+    ASSERT_EQ(longs[1], 2);
+    ASSERT_EQ(longs[2], 42);
+
+    double doubles[2] = {-1, -1};
+    ASSERT_EQ(w->getDoubles(1, 1, 2, doubles), OK);
+    ASSERT_EQ(doubles[0], 2.5);
+    ASSERT_EQ(doubles[1], 42.0);
+
+    // Null fields read as zero.
+    ASSERT_EQ(w->getLongs(0, 0, 3, longs), OK);
+    ASSERT_EQ(longs[0], 0);
+    ASSERT_EQ(longs[1], 0);
+    ASSERT_EQ(longs[2], 0);
+    ASSERT_ALIGNED(w);
+}
+
+TEST(CursorWindowTest, GetColumnBounds) {
+    CREATE_WINDOW_1K_3X3;
+
+    int64_t longs[4];
+    ASSERT_EQ(w->getLongs(0, 0, 0, longs), OK);
+    ASSERT_EQ(w->getLongs(0, 0, 4, longs), BAD_VALUE);
+    ASSERT_EQ(w->getLongs(0, 3, 1, longs), BAD_VALUE);
+    ASSERT_EQ(w->getLongs(0, -1, 2, longs), BAD_VALUE);
+    ASSERT_EQ(w->getLongs(3, 0, 1, longs), BAD_VALUE);
+
+    // Blobs can't be converted.
+    ASSERT_EQ(w->putBlob(2, 0, "\x01", 1), OK);
+    uint32_t failedRow = 0;
+    ASSERT_EQ(w->getLongs(0, 0, 3, longs, &failedRow), BAD_TYPE);
+    ASSERT_EQ(failedRow, 2);
+    ASSERT_ALIGNED(w);
+}
+
 TEST(CursorWindowTest, Inflate) {
     CREATE_WINDOW_2M;
 
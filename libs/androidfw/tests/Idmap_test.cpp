@@ -226,4 +226,38 @@ TEST_F(IdmapTest, OverlayAssetsIsUpToDate) {
   ASSERT_FALSE(apk_assets->IsUpToDate());
 }
 
+TEST(IdmapTargetIndexTest, MatchesEntryPositions) {
+  struct TargetEntry {
+    uint32_t target_id;
+  };
+  std::vector<TargetEntry> entries;
+  // A dense type, a sparse type and a type with too few entries to be indexed.
+  for (uint32_t entry = 0x10; entry < 0x30; entry += 2) {
+    entries.push_back({htodl(0x7f010000U | entry)});
+  }
+  for (uint32_t entry = 0; entry < 0x9000; entry += 0x1000) {
+    entries.push_back({htodl(0x7f030000U | entry)});
+  }
+  entries.push_back({htodl(0x7f050001U)});
+
+  IdmapTargetIndex index;
+  ASSERT_EQ(IdmapTargetIndex::kUnindexed, index.Find(0x010010U));
+  index.Build(entries.data(), entries.size());
+
+  for (uint32_t i = 0; i < entries.size(); i++) {
+    const uint32_t position = index.Find(0x00ffffffU & dtohl(entries[i].target_id));
+    if (position != IdmapTargetIndex::kUnindexed) {
+      EXPECT_EQ(i, position);
+    }
+  }
+  EXPECT_EQ(0U, index.Find(0x010010U));
+  EXPECT_EQ(IdmapTargetIndex::kNotFound, index.Find(0x010011U));
+  EXPECT_EQ(IdmapTargetIndex::kNotFound, index.Find(0x01000fU));
+  EXPECT_EQ(IdmapTargetIndex::kNotFound, index.Find(0x010030U));
+  EXPECT_EQ(IdmapTargetIndex::kNotFound, index.Find(0x020000U));
+  EXPECT_EQ(IdmapTargetIndex::kUnindexed, index.Find(0x030000U));
+  EXPECT_EQ(IdmapTargetIndex::kUnindexed, index.Find(0x050001U));
+  EXPECT_EQ(IdmapTargetIndex::kNotFound, index.Find(0x060001U));
+}
+
 }  // namespace
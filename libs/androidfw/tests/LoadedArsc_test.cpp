@@ -420,6 +420,44 @@ TEST_P(LoadedArscParameterizedTest, FindSparseEntryApp) {
   ASSERT_EQ(id.value(), fix_package_id(sparse::R::string::only_land, 0));
 }
 
+TEST_P(LoadedArscParameterizedTest, SparseEntryIndexMatchesBinarySearch) {
+  std::string contents;
+  ASSERT_TRUE(ReadFileFromZipToString(GetParam(), "resources.arsc", &contents));
+
+  std::unique_ptr<const LoadedArsc> loaded_arsc = LoadedArsc::Load(contents.data(),
+                                                                   contents.length());
+  ASSERT_THAT(loaded_arsc, NotNull());
+
+  const LoadedPackage* package =
+      loaded_arsc->GetPackageById(get_package_id(sparse::R::string::only_land));
+  ASSERT_THAT(package, NotNull());
+
+  size_t indexed_types = 0;
+  size_t index_bytes = 0;
+  package->ForEachTypeSpec([&](const TypeSpec& type_spec, uint8_t) {
+    const uint32_t entry_count = dtohl(type_spec.type_spec->entryCount);
+    for (const auto& type_entry : type_spec.type_entries) {
+      if (type_entry.sparse_index == nullptr) {
+        continue;
+      }
+      indexed_types++;
+      index_bytes += type_entry.sparse_index->GetMemoryUsage();
+      for (uint32_t i = 0; i <= entry_count; i++) {
+        const auto expected = LoadedPackage::GetEntryOffset(type_entry.type, i);
+        const auto actual = LoadedPackage::GetEntryOffset(type_entry, i);
+        ASSERT_EQ(expected.has_value(), actual.has_value()) << i;
+        if (expected.has_value()) {
+          ASSERT_EQ(*expected, *actual) << i;
+        }
+      }
+    }
+  });
+
+  // values-land of the string type is sparse and has enough entries to be indexed.
+  EXPECT_THAT(indexed_types, Ge(1u));
+  EXPECT_EQ(index_bytes, package->GetSparseEntryIndexMemoryUsage());
+}
+
 INSTANTIATE_TEST_SUITE_P(
         FrameWorkResourcesLoadedArscTests,
         LoadedArscParameterizedTest,
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "androidfw/PackedConfig.h"
+
+#include <vector>
+
+#include "androidfw/ConfigDescription.h"
+
+#include "gtest/gtest.h"
+
+namespace android {
+
+static const char* const kQualifiers[] = {
+    "",
+    "mcc310",
+    "mcc310-mnc004",
+    "en",
+    "en-rUS",
+    "en-rGB",
+    "fr",
+    "tl",
+    "fil-rPH",
+    "b+sr+Latn",
+    "b+sr+Cyrl",
+    "feminine",
+    "ldrtl",
+    "sw360dp",
+    "sw600dp",
+    "w720dp",
+    "h500dp",
+    "large",
+    "long",
+    "round",
+    "widecg",
+    "highdr",
+    "land",
+    "port",
+    "car",
+    "night",
+    "notnight",
+    "finger",
+    "keysexposed",
+    "keyshidden",
+    "keyssoft",
+    "navhidden",
+    "12key",
+    "dpad",
+    "v21",
+    "v34",
+    "en-rUS-sw600dp-land-night-v21",
+    "fr-rCA-w411dp-h731dp-normal-notlong-port-notnight-finger-keyssoft-nokeys-navexposed-nonav-v34",
+};
+
+static std::vector<ConfigDescription> ParseAll() {
+  std::vector<ConfigDescription> configs;
+  for (const char* qualifiers : kQualifiers) {
+    ConfigDescription config;
+    EXPECT_TRUE(ConfigDescription::Parse(qualifiers, &config)) << qualifiers;
+    configs.push_back(config);
+  }
+  return configs;
+}
+
+TEST(PackedConfigTest, AgreesWithMatch) {
+  const auto configs = ParseAll();
+  for (const auto& settings : configs) {
+    const PackedConfig packed_settings = PackedConfig::FromSettings(settings);
+    for (const auto& config : configs) {
+      const PackedConfigRange range = PackedConfigRange::FromConfig(config);
+      const bool expected = config.match(settings);
+      const bool actual = range.Contains(packed_settings) &&
+                          (!range.needs_full_match || config.match(settings));
+      EXPECT_EQ(expected, actual) << "config '" << config.toString().c_str() << "' settings '"
+                                  << settings.toString().c_str() << "'";
+    }
+  }
+}
+
+TEST(PackedConfigTest, OnlyLocalesNeedFullMatch) {
+  for (const auto& config : ParseAll()) {
+    EXPECT_EQ(config.locale != 0, PackedConfigRange::FromConfig(config).needs_full_match)
+        << config.toString().c_str();
+  }
+}
+
+TEST(PackedConfigTest, RejectsOtherLanguagesWithoutFullMatch) {
+  ConfigDescription en, fr, tl, fil;
+  ASSERT_TRUE(ConfigDescription::Parse("en", &en));
+  ASSERT_TRUE(ConfigDescription::Parse("fr-rFR", &fr));
+  ASSERT_TRUE(ConfigDescription::Parse("tl", &tl));
+  ASSERT_TRUE(ConfigDescription::Parse("fil-rPH", &fil));
+
+  EXPECT_FALSE(PackedConfigRange::FromConfig(en).Contains(PackedConfig::FromSettings(fr)));
+  EXPECT_TRUE(PackedConfigRange::FromConfig(en).Contains(PackedConfig::FromSettings(en)));
+
+  // Tagalog and Filipino are the same language.
+  EXPECT_TRUE(PackedConfigRange::FromConfig(tl).Contains(PackedConfig::FromSettings(fil)));
+  EXPECT_TRUE(PackedConfigRange::FromConfig(fil).Contains(PackedConfig::FromSettings(tl)));
+}
+
+}  // namespace android
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "androidfw/ResIdMap.h"
+
+#include <map>
+
+#include "gtest/gtest.h"
+
+namespace android {
+
+TEST(ResIdMapTest, InsertAndFind) {
+  ResIdMap<int> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(nullptr, map.find(0x7f010000));
+
+  map[0x7f010000] = 1;
+  map[0x7f010001] = 2;
+  map[0x01020000] = 3;
+  EXPECT_EQ(3u, map.size());
+
+  ASSERT_NE(nullptr, map.find(0x7f010000));
+  EXPECT_EQ(1, *map.find(0x7f010000));
+  ASSERT_NE(nullptr, map.find(0x7f010001));
+  EXPECT_EQ(2, *map.find(0x7f010001));
+  ASSERT_NE(nullptr, map.find(0x01020000));
+  EXPECT_EQ(3, *map.find(0x01020000));
+  EXPECT_EQ(nullptr, map.find(0x7f010002));
+
+  map[0x7f010000] = 4;
+  EXPECT_EQ(3u, map.size());
+  EXPECT_EQ(4, *map.find(0x7f010000));
+}
+
+TEST(ResIdMapTest, GrowsAndKeepsEntries) {
+  ResIdMap<uint32_t> map;
+  for (uint32_t i = 0; i < 5000; i++) {
+    map[0x7f020000 + i] = i;
+  }
+  EXPECT_EQ(5000u, map.size());
+  for (uint32_t i = 0; i < 5000; i++) {
+    ASSERT_NE(nullptr, map.find(0x7f020000 + i));
+    EXPECT_EQ(i, *map.find(0x7f020000 + i));
+  }
+}
+
+TEST(ResIdMapTest, EraseKeepsProbeSequences) {
+  ResIdMap<uint32_t> map;
+  std::map<uint32_t, uint32_t> expected;
+  for (uint32_t i = 0; i < 1000; i++) {
+    map[0x7f030000 + i] = i;
+    expected[0x7f030000 + i] = i;
+  }
+  for (uint32_t i = 0; i < 1000; i += 3) {
+    EXPECT_TRUE(map.erase(0x7f030000 + i));
+    expected.erase(0x7f030000 + i);
+  }
+  EXPECT_FALSE(map.erase(0x7f030000));
+  EXPECT_EQ(expected.size(), map.size());
+
+  for (uint32_t i = 0; i < 1000; i++) {
+    auto it = expected.find(0x7f030000 + i);
+    if (it == expected.end()) {
+      EXPECT_EQ(nullptr, map.find(0x7f030000 + i));
+    } else {
+      ASSERT_NE(nullptr, map.find(0x7f030000 + i));
+      EXPECT_EQ(it->second, *map.find(0x7f030000 + i));
+    }
+  }
+}
+
+TEST(ResIdMapTest, EraseIf) {
+  ResIdMap<uint32_t> map;
+  for (uint32_t i = 0; i < 100; i++) {
+    map[0x7f040000 + i] = i;
+  }
+  map.eraseIf([](uint32_t, uint32_t value) { return value % 2 == 0; });
+  EXPECT_EQ(50u, map.size());
+
+  size_t count = 0;
+  map.forEachItem([&count](uint32_t resid, uint32_t value) {
+    ++count;
+    EXPECT_EQ(1u, value % 2);
+    EXPECT_EQ(0x7f040000 + value, resid);
+  });
+  EXPECT_EQ(50u, count);
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(nullptr, map.find(0x7f040001));
+}
+
+}  // namespace android
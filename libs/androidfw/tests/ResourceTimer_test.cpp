@@ -15,6 +15,8 @@
  */
 
 
+#include <thread>
+
 #include <android-base/file.h>
 #include <android-base/test_utils.h>
 #include <androidfw/Util.h>
@@ -241,5 +243,66 @@ TEST(ResourceTimerTest, TimerOversize) {
   ASSERT_THAT(timer.pvalues.p99.nominal, 0);
 }
 
+TEST(ResourceTimerTest, TimerMerge) {
+  ResourceTimer::Timer low;
+  ResourceTimer::Timer high;
+  for (int i = 1; i <= 50; i++) {
+    low.record(US(i));
+  }
+  for (int i = 51; i <= 100; i++) {
+    high.record(US(i));
+  }
+
+  low.merge(high);
+  ASSERT_THAT(low.count, 100);
+  ASSERT_THAT(low.total, US((101 * 100)/2));
+  ASSERT_THAT(low.mintime, US(1));
+  ASSERT_THAT(low.maxtime, US(100));
+  ASSERT_THAT(low.largest[0], US(100));
+  ASSERT_THAT(low.largest[4], US(96));
+  low.compute();
+  ASSERT_THAT(low.pvalues.p50.nominal, US(50));
+  ASSERT_THAT(low.pvalues.p99.nominal, US(99));
+}
+
+TEST(ResourceTimerTest, CopyMergesThreads) {
+  ResourceTimer::enable();
+  const int counter = static_cast<int>(ResourceTimer::Counter::GetBag);
+  ResourceTimer::Timer timer;
+  ResourceTimer::copy(counter, timer, true);
+
+  auto record = [] {
+    for (int i = 0; i < 10; i++) {
+      ResourceTimer t(ResourceTimer::Counter::GetBag);
+    }
+  };
+  std::thread other(record);
+  record();
+  other.join();
+
+  ASSERT_TRUE(ResourceTimer::copy(counter, timer, true));
+  ASSERT_THAT(timer.count, 20);
+}
+
+TEST(ResourceTimerTest, CountEvents) {
+  ResourceTimer::enable();
+  const int hit = static_cast<int>(ResourceTimer::Counter::StringBlockCacheHit);
+  ResourceTimer::Timer timer;
+  ResourceTimer::copy(hit, timer, true);
+
+  for (int i = 0; i < 3; i++) {
+    ResourceTimer::count(ResourceTimer::Counter::StringBlockCacheHit);
+  }
+  ASSERT_TRUE(ResourceTimer::copy(hit, timer, false));
+  ASSERT_THAT(timer.count, 3);
+  ASSERT_THAT(timer.total, 0);
+  ASSERT_TRUE(ResourceTimer::copy(hit, timer, true));
+  ASSERT_THAT(timer.count, 3);
+
+  // The events were reset by the last copy.
+  ASSERT_FALSE(ResourceTimer::copy(hit, timer, true));
+  ASSERT_THAT(timer.count, 0);
+}
+
 
 }  // namespace android
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <malloc.h>
+#include <sys/resource.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "android-base/strings.h"
+#include "androidfw/ApkAssets.h"
+#include "androidfw/AssetManager2.h"
+#include "androidfw/ResourceTypes.h"
+#include "benchmark/benchmark.h"
+
+namespace android {
+
+// Replays an app cold start against a set of APKs: load the APKs, set the configuration, create
+// a theme and then run a trace of the resource accesses made while the first activity inflates.
+//
+// By default this uses framework-res and a short built-in trace. To replay a real startup, set
+// ANDROIDFW_REPLAY_APKS to a ':'-separated list of APK paths (framework first, then the app and
+// its overlays) and ANDROIDFW_REPLAY_TRACE to a file with one access per line:
+//
+//   style <resid>   applies the style to the theme
+//   attr <resid>    looks up the attribute in the theme and resolves it
+//   res <resid>     looks up the resource and resolves it
+//   bag <resid>     looks up the bag of the resource
+//
+// Resource IDs are decimal or 0x-prefixed hex. Empty lines and lines starting with '#' are
+// skipped. Every iteration is a full cold start, and the page faults (and, on device, the heap
+// growth) of each one are reported next to the time.
+
+constexpr const static char* kFrameworkPath = "/system/framework/framework-res.apk";
+
+enum class ReplayOp { kStyle, kAttr, kRes, kBag };
+
+struct ReplayStep {
+  ReplayOp op;
+  uint32_t resid;
+};
+
+// android:style/Theme.Material.Light, then a few attributes a typical layout reads from it.
+const static std::vector<ReplayStep> kDefaultTrace = {
+    {ReplayOp::kStyle, 0x01030237u},  // android:style/Theme.Material.Light
+    {ReplayOp::kAttr, 0x01010030u},   // android:attr/colorForeground
+    {ReplayOp::kAttr, 0x01010031u},   // android:attr/colorBackground
+    {ReplayOp::kAttr, 0x01010036u},   // android:attr/textColorPrimary
+    {ReplayOp::kAttr, 0x01010095u},   // android:attr/textSize
+    {ReplayOp::kBag, 0x0103028eu},    // android:style/Widget.Material.Light
+    {ReplayOp::kBag, 0x0103024du},    // android:style/Widget.Material
+};
+
+static bool LoadTrace(const char* path, std::vector<ReplayStep>* out_trace) {
+  std::ifstream file(path);
+  if (!file) {
+    return false;
+  }
+  std::string line;
+  while (std::getline(file, line)) {
+    line = base::Trim(line);
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::vector<std::string> parts = base::Tokenize(line, " \t");
+    if (parts.size() != 2) {
+      return false;
+    }
+    ReplayStep step;
+    if (parts[0] == "style") {
+      step.op = ReplayOp::kStyle;
+    } else if (parts[0] == "attr") {
+      step.op = ReplayOp::kAttr;
+    } else if (parts[0] == "res") {
+      step.op = ReplayOp::kRes;
+    } else if (parts[0] == "bag") {
+      step.op = ReplayOp::kBag;
+    } else {
+      return false;
+    }
+    char* end;
+    step.resid = static_cast<uint32_t>(strtoul(parts[1].c_str(), &end, 0));
+    if (*end != '\0') {
+      return false;
+    }
+    out_trace->push_back(step);
+  }
+  return true;
+}
+
+static long PageFaults() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_minflt + usage.ru_majflt;
+}
+
+static long HeapInUse() {
+#ifdef __BIONIC__
+  return mallinfo().uordblks;
+#else
+  return 0;
+#endif
+}
+
+static void BM_StartupReplay(benchmark::State& state) {
+  std::vector<std::string> apk_paths = {kFrameworkPath};
+  if (const char* apks = getenv("ANDROIDFW_REPLAY_APKS")) {
+    apk_paths = base::Split(apks, ":");
+  }
+
+  std::vector<ReplayStep> trace = kDefaultTrace;
+  if (const char* trace_path = getenv("ANDROIDFW_REPLAY_TRACE")) {
+    trace.clear();
+    if (!LoadTrace(trace_path, &trace)) {
+      state.SkipWithError("Failed to read the replay trace");
+      return;
+    }
+  }
+
+  ResTable_config config{};
+  config.density = ResTable_config::DENSITY_XXHIGH;
+  config.sdkVersion = 10000;
+
+  long page_faults = 0;
+  long heap_growth = 0;
+  while (state.KeepRunning()) {
+    const long page_faults_before = PageFaults();
+    const long heap_before = HeapInUse();
+
+    std::vector<AssetManager2::ApkAssetsPtr> apk_assets;
+    for (size_t i = 0; i < apk_paths.size(); i++) {
+      auto apk = ApkAssets::Load(apk_paths[i], i == 0 ? PROPERTY_SYSTEM : 0);
+      if (apk == nullptr) {
+        state.SkipWithError("Failed to load assets");
+        return;
+      }
+      apk_assets.push_back(std::move(apk));
+    }
+
+    AssetManager2 assets;
+    assets.SetApkAssets(apk_assets);
+    assets.SetConfigurations({&config, 1});
+    auto theme = assets.NewTheme();
+
+    for (const ReplayStep& step : trace) {
+      switch (step.op) {
+        case ReplayOp::kStyle:
+          theme->ApplyStyle(step.resid, false /* force */);
+          break;
+        case ReplayOp::kAttr:
+          if (auto value = theme->GetAttribute(step.resid)) {
+            benchmark::DoNotOptimize(theme->ResolveAttributeReference(*value));
+          }
+          break;
+        case ReplayOp::kRes:
+          if (auto value = assets.GetResource(step.resid); value.has_value()) {
+            benchmark::DoNotOptimize(assets.ResolveReference(*value));
+          }
+          break;
+        case ReplayOp::kBag:
+          benchmark::DoNotOptimize(assets.GetBag(step.resid));
+          break;
+      }
+    }
+
+    heap_growth += HeapInUse() - heap_before;
+    page_faults += PageFaults() - page_faults_before;
+  }
+
+  state.counters["page_faults"] =
+      benchmark::Counter(page_faults, benchmark::Counter::kAvgIterations);
+  state.counters["heap_bytes"] =
+      benchmark::Counter(heap_growth, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_StartupReplay);
+
+}  // namespace android
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "androidfw/StreamingZipInflater.h"
+
+#include <string>
+#include <vector>
+
+#include "android-base/file.h"
+#include "gtest/gtest.h"
+
+namespace android {
+
+// Returns `data` compressed as a raw deflate stream, like zip entries are stored.
+static std::string Deflate(const std::string& data) {
+  z_stream stream = {};
+  EXPECT_EQ(Z_OK, deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+                               Z_DEFAULT_STRATEGY));
+  std::string compressed(deflateBound(&stream, data.size()), '\0');
+  stream.next_in = (Bytef*)data.data();
+  stream.avail_in = data.size();
+  stream.next_out = (Bytef*)compressed.data();
+  stream.avail_out = compressed.size();
+  EXPECT_EQ(Z_STREAM_END, deflate(&stream, Z_FINISH));
+  compressed.resize(compressed.size() - stream.avail_out);
+  deflateEnd(&stream);
+  return compressed;
+}
+
+TEST(StreamingZipInflaterTest, SeekUsesCheckpoints) {
+  // Large enough to get several checkpoints.
+  std::string data;
+  for (uint32_t i = 0; data.size() < 4 * StreamingZipInflater::CHECKPOINT_MIN_SIZE; i++) {
+    data += std::to_string(i * 2654435761u) + (i % 7 == 0 ? "\n" : " ");
+  }
+  const std::string compressed = Deflate(data);
+
+  TemporaryFile file;
+  ASSERT_TRUE(android::base::WriteStringToFd(compressed, file.fd));
+  StreamingZipInflater inflater(file.fd, 0, data.size(), compressed.size());
+
+  // Read everything once so that the checkpoints get recorded.
+  std::string out(data.size(), '\0');
+  ASSERT_EQ(ssize_t(data.size()), inflater.read(out.data(), out.size()));
+  ASSERT_EQ(data, out);
+
+  // Seek backwards and forwards, within and across checkpoint intervals.
+  const size_t kReadSize = 4096;
+  const size_t positions[] = {
+      data.size() / 2, 10, data.size() - kReadSize, StreamingZipInflater::CHECKPOINT_INTERVAL,
+      StreamingZipInflater::CHECKPOINT_INTERVAL - 1, data.size() / 3, 3 * data.size() / 4,
+  };
+  std::string buffer(kReadSize, '\0');
+  for (size_t position : positions) {
+    ASSERT_EQ(off64_t(position), inflater.seekAbsolute(position));
+    ASSERT_EQ(ssize_t(kReadSize), inflater.read(buffer.data(), kReadSize)) << position;
+    ASSERT_EQ(data.substr(position, kReadSize), buffer) << position;
+  }
+}
+
+}  // namespace android
@@ -91,6 +91,28 @@ static void BM_ThemeRebaseFramework(benchmark::State& state) {
 }
 BENCHMARK(BM_ThemeRebaseFramework);
 
+static void BM_ThemeSetToAndApplyStyleFramework(benchmark::State& state) {
+  auto apk = ApkAssets::Load(kFrameworkPath);
+  if (apk == nullptr) {
+    state.SkipWithError("Failed to load assets");
+    return;
+  }
+
+  AssetManager2 assets;
+  assets.SetApkAssets({apk});
+
+  const auto base_theme = assets.NewTheme();
+  base_theme->ApplyStyle(kStyleId, false /* force */);
+
+  // Like a ContextThemeWrapper: clone a large theme and apply a small overlay style on top.
+  while (state.KeepRunning()) {
+    auto theme = assets.NewTheme();
+    theme->SetTo(*base_theme);
+    theme->ApplyStyle(kStyle3Id, true /* force */);
+  }
+}
+BENCHMARK(BM_ThemeSetToAndApplyStyleFramework);
+
 static void BM_ThemeGetAttribute(benchmark::State& state) {
   auto apk = ApkAssets::Load(kFrameworkPath);
 
@@ -250,6 +250,44 @@ TEST_F(ThemeTest, CopyThemeSameAssetManager) {
   EXPECT_EQ(static_cast<uint32_t>(ResTable_typeSpec::SPEC_PUBLIC), value->flags);
 }
 
+TEST_F(ThemeTest, ApplyStyleToCopyLeavesSourceUnchanged) {
+  AssetManager2 assetmanager;
+  assetmanager.SetApkAssets({style_assets_});
+
+  std::unique_ptr<Theme> source = assetmanager.NewTheme();
+  ASSERT_TRUE(source->ApplyStyle(app::R::style::StyleTwo).has_value());
+
+  std::unique_ptr<Theme> copy = assetmanager.NewTheme();
+  ASSERT_TRUE(copy->SetTo(*source).has_value());
+  ASSERT_TRUE(copy->ApplyStyle(app::R::style::StyleThree, true /* force */).has_value());
+
+  // The copy has the forced attr_five and the new attr_six.
+  auto value = copy->GetAttribute(app::R::attr::attr_five);
+  ASSERT_TRUE(value);
+  EXPECT_EQ(Res_value::TYPE_INT_DEC, value->type);
+  EXPECT_EQ(5u, value->data);
+  ASSERT_TRUE(copy->GetAttribute(app::R::attr::attr_six).has_value());
+
+  // The source keeps its own values.
+  value = source->GetAttribute(app::R::attr::attr_five);
+  ASSERT_TRUE(value);
+  EXPECT_EQ(Res_value::TYPE_REFERENCE, value->type);
+  EXPECT_EQ(app::R::string::string_one, value->data);
+  ASSERT_FALSE(source->GetAttribute(app::R::attr::attr_six).has_value());
+
+  // Attributes that were not touched are still found in both.
+  value = source->GetAttribute(app::R::attr::attr_one);
+  ASSERT_TRUE(value);
+  EXPECT_EQ(1u, value->data);
+  value = copy->GetAttribute(app::R::attr::attr_one);
+  ASSERT_TRUE(value);
+  EXPECT_EQ(1u, value->data);
+
+  // Modifying the source afterwards does not change the copy.
+  source->Clear();
+  ASSERT_TRUE(copy->GetAttribute(app::R::attr::attr_one).has_value());
+}
+
 TEST_F(ThemeTest, ThemeRebase) {
   AssetManager2 am;
   am.SetApkAssets({style_assets_});
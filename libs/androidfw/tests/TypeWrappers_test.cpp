@@ -26,7 +26,8 @@ namespace android {
 // create a ResTable_type in memory with a vector of Res_value*
 static ResTable_type* createTypeTable(std::vector<Res_value*>& values,
                              bool compact_entry = false,
-                             bool short_offsets = false)
+                             bool short_offsets = false,
+                             bool sparse = false)
 {
     ResTable_type t{};
     t.header.type = RES_TABLE_TYPE_TYPE;
@@ -34,10 +35,15 @@ static ResTable_type* createTypeTable(std::vector<Res_value*>& values,
     t.header.size = sizeof(t);
     t.id = 1;
     t.flags = short_offsets ? ResTable_type::FLAG_OFFSET16 : 0;
+    t.flags |= sparse ? ResTable_type::FLAG_SPARSE : 0;
 
-    t.header.size += values.size() * (short_offsets ? sizeof(uint16_t) : sizeof(uint32_t));
+    // Sparse types only list the entries that are present.
+    const size_t index_count = sparse
+            ? std::count_if(values.begin(), values.end(), [](auto v) { return v != nullptr; })
+            : values.size();
+    t.header.size += index_count * (short_offsets ? sizeof(uint16_t) : sizeof(uint32_t));
     t.entriesStart = t.header.size;
-    t.entryCount = values.size();
+    t.entryCount = index_count;
 
     size_t entry_size = compact_entry ? sizeof(ResTable_entry)
                                       : sizeof(ResTable_entry) + sizeof(Res_value);
@@ -55,7 +61,14 @@ static ResTable_type* createTypeTable(std::vector<Res_value*>& values,
     size_t i = 0, entry_offset = 0;
     uint32_t k = 0;
     for (auto const& v : values) {
-        if (short_offsets) {
+        if (sparse) {
+            if (v) {
+                ResTable_sparseTypeEntry* p = reinterpret_cast<ResTable_sparseTypeEntry*>(p_offsets)
+                        + k++;
+                p->idx = i;
+                p->offset = entry_offset / 4;
+            }
+        } else if (short_offsets) {
             uint16_t *p = reinterpret_cast<uint16_t *>(p_offsets) + i;
             *p = v ? (entry_offset >> 2) & 0xffffu : 0xffffu;
         } else {
@@ -142,4 +155,54 @@ TEST(TypeVariantIteratorTest, shouldIterateOverTypeWithoutErrors) {
     }
 }
 
+TEST(TypeVariantIteratorTest, shouldIterateOverSparseTypeWithoutErrors) {
+    std::vector<Res_value *> values;
+    values.push_back(nullptr);
+
+    Res_value *v1 = new Res_value{ sizeof(Res_value), 0, Res_value::TYPE_INT_DEC, 1};
+    values.push_back(v1);
+
+    values.push_back(nullptr);
+    values.push_back(nullptr);
+
+    Res_value *v2 = new Res_value{ sizeof(Res_value), 0, Res_value::TYPE_INT_DEC, 2};
+    values.push_back(v2);
+
+    for (size_t i = 0; i < 2; i++) {
+        bool compact_entry = i & 0x1;
+        ResTable_type* data = createTypeTable(values, compact_entry, false, true);
+        TypeVariant v(data);
+
+        std::vector<uint32_t> present;
+        for (auto iter = v.beginEntries(); iter != v.endEntries(); ++iter) {
+            if (*iter != NULL) {
+                present.push_back(iter.index());
+                ASSERT_EQ(iter.index(), iter->key());
+            }
+        }
+        ASSERT_EQ((std::vector<uint32_t>{1, 4}), present);
+
+        // A copied iterator keeps its position in the sparse index table.
+        TypeVariant::iterator iter = v.beginEntries();
+        iter++;
+        TypeVariant::iterator copy = v.endEntries();
+        copy = iter;
+        ASSERT_EQ(uint32_t(1), copy.index());
+        ASSERT_EQ(uint32_t(1), copy->value().data);
+        copy++;
+        ASSERT_TRUE(NULL == *copy);
+
+        free(data);
+    }
+}
+
+TEST(TypeVariantIteratorTest, shouldHandleEmptySparseType) {
+    std::vector<Res_value *> values;
+    ResTable_type* data = createTypeTable(values, false, false, true);
+    TypeVariant v(data);
+    ASSERT_EQ(v.beginEntries(), v.endEntries());
+    ASSERT_TRUE(NULL == *v.beginEntries());
+    free(data);
+}
+
 } // namespace android
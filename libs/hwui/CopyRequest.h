@@ -16,6 +16,9 @@
 
 #pragma once
 
+#include <android-base/unique_fd.h>
+#include <android/hardware_buffer.h>
+
 #include "Rect.h"
 #include "hwui/Bitmap.h"
 
@@ -39,4 +42,21 @@ struct CopyRequest {
     virtual void onCopyFinished(CopyResult result) = 0;
 };
 
+// A copy that renders straight into a hardware buffer owned by the caller. The copy finishes as
+// soon as the GPU work is submitted, with a fence that signals once the buffer holds the result.
+// A fence of -1 means the buffer is ready already.
+struct HardwareBufferCopyRequest {
+    Rect srcRect;
+    HardwareBufferCopyRequest(Rect srcRect, AHardwareBuffer* destination)
+            : srcRect(srcRect), mDestination(destination) {
+        AHardwareBuffer_acquire(mDestination);
+    }
+    virtual ~HardwareBufferCopyRequest() { AHardwareBuffer_release(mDestination); }
+    AHardwareBuffer* getDestinationBuffer() const { return mDestination; }
+    virtual void onCopyFinished(CopyResult result, base::unique_fd fence) = 0;
+
+private:
+    AHardwareBuffer* mDestination;
+};
+
 }  // namespace android::uirenderer
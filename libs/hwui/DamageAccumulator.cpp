@@ -37,9 +37,9 @@ struct DirtyStack {
         const RenderNode* renderNode;
         const Matrix4* matrix4;
     };
-    // When this frame is pop'd, this rect is mapped through the above transform
+    // When this frame is pop'd, this region is mapped through the above transform
     // and applied to the previous (aka parent) frame
-    SkRect pendingDirty;
+    DamageRegion pendingDirty;
     DirtyStack* prev;
     DirtyStack* next;
 };
@@ -133,10 +133,6 @@ static inline void mapRect(const Matrix4* matrix, const SkRect& in, SkRect* out)
     out->join({RECT_ARGS(temp)});
 }
 
-void DamageAccumulator::applyMatrix4Transform(DirtyStack* frame) {
-    mapRect(frame->matrix4, frame->pendingDirty, &mHead->pendingDirty);
-}
-
 static inline void applyMatrix(const SkMatrix* transform, SkRect* rect) {
     if (transform && !transform->isIdentity()) {
         if (CC_LIKELY(!transform->hasPerspective())) {
@@ -173,6 +169,20 @@ static inline void mapRect(const RenderProperties& props, const SkRect& in, SkRe
     out->join(temp);
 }
 
+// Maps every rect of the region separately, so that disjoint damage stays disjoint
+template <typename T>
+static inline void mapRegion(const T& transform, const DamageRegion& in, DamageRegion* out) {
+    for (const SkRect& rect : in) {
+        SkRect mapped = SkRect::MakeEmpty();
+        mapRect(transform, rect, &mapped);
+        out->join(mapped);
+    }
+}
+
+void DamageAccumulator::applyMatrix4Transform(DirtyStack* frame) {
+    mapRegion(frame->matrix4, frame->pendingDirty, &mHead->pendingDirty);
+}
+
 static DirtyStack* findParentRenderNode(DirtyStack* frame) {
     while (frame->prev != frame) {
         frame = frame->prev;
@@ -196,12 +206,13 @@ static DirtyStack* findProjectionReceiver(DirtyStack* frame) {
 }
 
 static void applyTransforms(DirtyStack* frame, DirtyStack* end) {
-    SkRect* rect = &frame->pendingDirty;
+    DamageRegion* region = &frame->pendingDirty;
     while (frame != end) {
+        const DamageRegion source = *region;
         if (frame->type == TransformRenderNode) {
-            mapRect(frame->renderNode->properties(), *rect, rect);
+            mapRegion(frame->renderNode->properties(), source, region);
         } else {
-            mapRect(frame->matrix4, *rect, rect);
+            mapRegion(frame->matrix4, source, region);
         }
         frame = frame->prev;
     }
@@ -219,13 +230,11 @@ void DamageAccumulator::applyRenderNodeTransform(DirtyStack* frame) {
 
     // Perform clipping
     if (props.getClipDamageToBounds()) {
-        if (!frame->pendingDirty.intersect(SkRect::MakeIWH(props.getWidth(), props.getHeight()))) {
-            frame->pendingDirty.setEmpty();
-        }
+        frame->pendingDirty.intersect(SkRect::MakeIWH(props.getWidth(), props.getHeight()));
     }
 
     // apply all transforms
-    mapRect(props, frame->pendingDirty, &mHead->pendingDirty);
+    mapRegion(props, frame->pendingDirty, &mHead->pendingDirty);
 
     // project backwards if necessary
     if (props.getProjectBackwards() && !frame->pendingDirty.isEmpty()) {
@@ -284,19 +293,25 @@ SkRect DamageAccumulator::computeClipAndTransform(const SkRect& bounds, Matrix4*
 }
 
 void DamageAccumulator::dirty(float left, float top, float right, float bottom) {
-    mHead->pendingDirty.join({left, top, right, bottom});
+    mHead->pendingDirty.join(SkRect::MakeLTRB(left, top, right, bottom));
 }
 
 void DamageAccumulator::peekAtDirty(SkRect* dest) const {
-    *dest = mHead->pendingDirty;
+    *dest = mHead->pendingDirty.bounds();
 }
 
 void DamageAccumulator::finish(SkRect* totalDirty) {
+    DamageRegion region;
+    finish(&region);
+    *totalDirty = region.bounds();
+}
+
+void DamageAccumulator::finish(DamageRegion* totalDirty) {
     LOG_ALWAYS_FATAL_IF(mHead->prev != mHead, "Cannot finish, mismatched push/pop calls! %p vs. %p",
                         mHead->prev, mHead);
-    // Root node never has a transform, so this is the fully mapped dirty rect
+    // Root node never has a transform, so this is the fully mapped dirty region
     *totalDirty = mHead->pendingDirty;
-    totalDirty->roundOut(totalDirty);
+    totalDirty->roundOut();
     mHead->pendingDirty.setEmpty();
 }
 
@@ -23,6 +23,7 @@
 #include <SkRect.h>
 #include <effects/StretchEffect.h>
 
+#include "DamageRegion.h"
 #include "utils/Macros.h"
 
 // Smaller than INT_MIN/INT_MAX because we offset these values
@@ -64,6 +65,8 @@ public:
     SkRect computeClipAndTransform(const SkRect& bounds, Matrix4* outMatrix) const;
 
     void finish(SkRect* totalDirty);
+    // Same as above, but keeps disjoint damage as separate rectangles
+    void finish(DamageRegion* totalDirty);
 
     struct StretchResult {
         /**
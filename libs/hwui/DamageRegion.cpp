@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DamageRegion.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "Properties.h"
+
+namespace android {
+namespace uirenderer {
+
+static inline float area(const SkRect& rect) {
+    return rect.width() * rect.height();
+}
+
+SkRect DamageRegion::bounds() const {
+    SkRect result = SkRect::MakeEmpty();
+    for (const SkRect& rect : *this) {
+        result.join(rect);
+    }
+    return result;
+}
+
+void DamageRegion::absorbIntersecting(SkRect* rect) {
+    int i = 0;
+    while (i < mCount) {
+        if (SkRect::Intersects(mRects[i], *rect)) {
+            rect->join(mRects[i]);
+            removeAt(i);
+            // The grown rect may now intersect rects that were already checked
+            i = 0;
+        } else {
+            i++;
+        }
+    }
+}
+
+void DamageRegion::join(const SkRect& rect) {
+    if (rect.isEmpty()) return;
+    const int maxRects = std::clamp(Properties::maxDamageRects, 1, kMaxRects);
+    SkRect pending = rect;
+    while (true) {
+        absorbIntersecting(&pending);
+        if (mCount < maxRects) break;
+        // Out of space, merge with the rect whose bounds grow the least
+        int best = 0;
+        float bestGrowth = std::numeric_limits<float>::max();
+        for (int i = 0; i < mCount; i++) {
+            SkRect merged = mRects[i];
+            merged.join(pending);
+            float growth = area(merged) - area(mRects[i]) - area(pending);
+            if (growth < bestGrowth) {
+                bestGrowth = growth;
+                best = i;
+            }
+        }
+        pending.join(mRects[best]);
+        removeAt(best);
+    }
+    mRects[mCount++] = pending;
+}
+
+void DamageRegion::join(const DamageRegion& other) {
+    for (const SkRect& rect : other) {
+        join(rect);
+    }
+}
+
+bool DamageRegion::intersect(const SkRect& clip) {
+    int i = 0;
+    while (i < mCount) {
+        if (mRects[i].intersect(clip)) {
+            i++;
+        } else {
+            removeAt(i);
+        }
+    }
+    return mCount > 0;
+}
+
+void DamageRegion::roundOut() {
+    // Rounding may make neighbouring rects overlap, so rebuild the region from scratch
+    DamageRegion unrounded = *this;
+    setEmpty();
+    for (const SkRect& rect : unrounded) {
+        SkRect rounded;
+        rect.roundOut(&rounded);
+        join(rounded);
+    }
+}
+
+} /* namespace uirenderer */
+} /* namespace android */
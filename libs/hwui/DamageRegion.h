@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <SkRect.h>
+
+namespace android {
+namespace uirenderer {
+
+/**
+ * A small set of disjoint rectangles describing the damaged area of a frame.
+ *
+ * Damage is kept as up to Properties::maxDamageRects rectangles (at most kMaxRects), so that
+ * updates in distant parts of the window, such as a clock in one corner and a progress bar in
+ * the other, don't repaint the whole area between them. Rectangles that overlap are merged,
+ * and when the region is full a new rectangle is merged into the one whose bounds grow the
+ * least.
+ *
+ * The storage is inline and trivially destructible, so regions can live in
+ * LinearAllocator-owned structures and be copied freely.
+ */
+class DamageRegion {
+public:
+    static constexpr int kMaxRects = 4;
+
+    DamageRegion() = default;
+    DamageRegion(const SkRect& rect) { join(rect); }
+
+    bool isEmpty() const { return mCount == 0; }
+    int count() const { return mCount; }
+    const SkRect& operator[](int index) const { return mRects[index]; }
+    const SkRect* begin() const { return mRects; }
+    const SkRect* end() const { return mRects + mCount; }
+
+    void setEmpty() { mCount = 0; }
+    void set(const SkRect& rect) {
+        setEmpty();
+        join(rect);
+    }
+
+    // Returns the smallest rectangle containing the whole region
+    SkRect bounds() const;
+
+    void join(const SkRect& rect);
+    void join(const DamageRegion& other);
+
+    // Clips every rectangle against clip, returning false if nothing is left
+    bool intersect(const SkRect& clip);
+
+    // Rounds every rectangle out to integer coordinates
+    void roundOut();
+
+private:
+    // Grows rect to cover every rectangle it intersects and removes those rectangles
+    void absorbIntersecting(SkRect* rect);
+    void removeAt(int index) { mRects[index] = mRects[--mCount]; }
+
+    SkRect mRects[kMaxRects];
+    int mCount = 0;
+};
+
+} /* namespace uirenderer */
+} /* namespace android */
@@ -175,6 +175,7 @@ void DeferredLayerUpdater::apply() {
                 // (invoked by createIfNeeded) will add a ref to the AHardwareBuffer.
                 AHardwareBuffer_release(hardwareBuffer);
                 if (layerImage.get()) {
+                    mImageSlots[slot].attributeTo(mMemoryAttribution, *layerImage);
                     // force filtration if buffer size != layer size
                     bool forceFilter =
                             mWidth != layerImage->width() || mHeight != layerImage->height();
@@ -262,6 +263,7 @@ void DeferredLayerUpdater::ImageSlot::clear(GrDirectContext* context) {
     }
 
     mBuffer = nullptr;
+    mMemoryTag.reset();
 }
 
 void DeferredLayerUpdater::ImageSlot::releaseQueueOwnership(GrDirectContext* context) {
@@ -31,6 +31,7 @@
 #include <memory>
 
 #include "Layer.h"
+#include "MemoryAttribution.h"
 #include "Rect.h"
 #include "renderstate/RenderState.h"
 
@@ -96,6 +97,11 @@ public:
 
     void destroyLayer();
 
+    // The buffers wrapped for this layer are charged to the given attribution
+    void setMemoryAttribution(const sp<MemoryAttribution>& attribution) {
+        mMemoryAttribution = attribution;
+    }
+
 protected:
     void onContextDestroyed() override;
 
@@ -116,7 +122,15 @@ private:
 
         void clear(GrDirectContext* context);
 
+        void attributeTo(const sp<MemoryAttribution>& attribution, const SkImage& image) {
+            if (mMemoryTag.bytes() == 0) {
+                mMemoryTag.set(attribution, AttributedMemoryType::TextureLayer,
+                               image.imageInfo().computeMinByteSize());
+            }
+        }
+
     private:
+        MemoryTag mMemoryTag;
 
         // the dataspace associated with the current image
         android_dataspace mDataspace = HAL_DATASPACE_UNKNOWN;
@@ -154,6 +168,7 @@ private:
     bool mGLContextAttached;
     bool mUpdateTexImage;
     int mCurrentSlot = -1;
+    sp<MemoryAttribution> mMemoryAttribution;
 
     Layer* mLayer;
 };
@@ -94,6 +94,10 @@ public:
         return mImpl && mImpl->hasVectorDrawables();
     }
 
+    [[nodiscard]] bool hasSameContent(const SkiaDisplayListWrapper& other) const {
+        return mImpl && other.mImpl && mImpl->hasSameContent(*other.mImpl);
+    }
+
     void clear(RenderNode* owningNode = nullptr) {
         if (mImpl && owningNode && mImpl->reuseDisplayList(owningNode)) {
             // TODO: This is a bit sketchy to have a unique_ptr temporarily owned twice
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FrameInfoRing.h"
+
+#include "FrameInfoTracing.h"
+
+namespace android {
+namespace uirenderer {
+
+static constexpr int kFrameInfoSize = static_cast<int>(FrameInfoIndex::NumIndexes);
+
+FrameInfoRing& FrameInfoRing::instance() {
+    static FrameInfoRing sInstance;
+    return sInstance;
+}
+
+uint32_t FrameInfoRing::nextSourceId() {
+    static std::atomic<uint32_t> sNextSourceId{1};
+    return sNextSourceId.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FrameInfoRing::push(const FrameInfo& frame, int64_t frameNumber, int32_t surfaceId,
+                         uint32_t sourceId) {
+    const uint64_t index = mNextIndex.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = mSlots[index % kCapacity];
+
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    const int64_t* data = frame.data();
+    for (int i = 0; i < kFrameInfoSize; i++) {
+        slot.values[i].store(data[i], std::memory_order_relaxed);
+    }
+    slot.values[kFrameInfoSize].store(frameNumber, std::memory_order_relaxed);
+    slot.values[kFrameInfoSize + 1].store(
+            static_cast<int64_t>(static_cast<uint64_t>(sourceId) << 32 |
+                                 static_cast<uint32_t>(surfaceId)),
+            std::memory_order_relaxed);
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+
+    FrameInfoTracing::onFrameRecorded(*this);
+}
+
+FrameInfoRing::SlotState FrameInfoRing::readSlot(uint64_t index, Record* outRecord) const {
+    const Slot& slot = mSlots[index % kCapacity];
+    const uint64_t complete = 2 * index + 2;
+    const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+    if (before < complete) {
+        return SlotState::Pending;
+    }
+    if (before > complete) {
+        return SlotState::Overwritten;
+    }
+    for (int i = 0; i < kFrameInfoSize; i++) {
+        outRecord->frameInfo[i] = slot.values[i].load(std::memory_order_relaxed);
+    }
+    outRecord->frameNumber = slot.values[kFrameInfoSize].load(std::memory_order_relaxed);
+    const uint64_t ids = slot.values[kFrameInfoSize + 1].load(std::memory_order_relaxed);
+    outRecord->surfaceId = static_cast<int32_t>(ids & 0xFFFFFFFF);
+    outRecord->sourceId = static_cast<uint32_t>(ids >> 32);
+    // A writer that lapped us while copying has bumped the sequence
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != before) {
+        return SlotState::Overwritten;
+    }
+    return SlotState::Ready;
+}
+
+uint64_t FrameInfoRing::read(uint64_t* cursor,
+                             const std::function<void(const Record&)>& visitor) const {
+    const uint64_t last = end();
+    uint64_t skipped = 0;
+    if (last - *cursor > kCapacity) {
+        skipped = last - kCapacity - *cursor;
+        *cursor = last - kCapacity;
+    }
+    Record record;
+    while (*cursor < last) {
+        const SlotState state = readSlot(*cursor, &record);
+        if (state == SlotState::Pending) {
+            break;
+        }
+        if (state == SlotState::Ready) {
+            visitor(record);
+        } else {
+            skipped++;
+        }
+        (*cursor)++;
+    }
+    return skipped;
+}
+
+} /* namespace uirenderer */
+} /* namespace android */
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "FrameInfo.h"
+#include "utils/Macros.h"
+
+namespace android {
+namespace uirenderer {
+
+/**
+ * A fixed size ring holding the most recent finished frames of every CanvasContext in the
+ * process, so that consumers such as the Perfetto exporter can read frame timestamps at full
+ * rate without per-frame observer callbacks.
+ *
+ * Writers never block and never allocate. Each slot is guarded by a sequence number, so a
+ * reader that falls more than kCapacity records behind skips the overwritten ones instead of
+ * holding up the writers.
+ */
+class FrameInfoRing {
+    PREVENT_COPY_AND_ASSIGN(FrameInfoRing);
+
+public:
+    // About four seconds of frames at 120Hz
+    static constexpr size_t kCapacity = 512;
+
+    struct Record {
+        int64_t frameInfo[static_cast<int>(FrameInfoIndex::NumIndexes)];
+        int64_t frameNumber;
+        int32_t surfaceId;
+        // Identifies the JankTracker, and so the window, that produced the frame
+        uint32_t sourceId;
+    };
+
+    static FrameInfoRing& instance();
+
+    // Returns a new id for FrameInfoRing::Record::sourceId
+    static uint32_t nextSourceId();
+
+    void push(const FrameInfo& frame, int64_t frameNumber, int32_t surfaceId, uint32_t sourceId);
+
+    // Index that the next pushed record will get. Records are numbered from 0.
+    uint64_t end() const { return mNextIndex.load(std::memory_order_acquire); }
+
+    // Hands every record from *cursor on to visitor, oldest first, and moves the cursor past
+    // them. Stops early at a record that is still being written. Returns how many records were
+    // overwritten before they could be read.
+    uint64_t read(uint64_t* cursor, const std::function<void(const Record&)>& visitor) const;
+
+private:
+    FrameInfoRing() = default;
+
+    static constexpr size_t kValueCount = static_cast<int>(FrameInfoIndex::NumIndexes) + 2;
+
+    enum class SlotState { Ready, Pending, Overwritten };
+
+    struct Slot {
+        // 2 * (index + 1) once record index is complete, odd while it is being written
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<int64_t> values[kValueCount];
+    };
+
+    SlotState readSlot(uint64_t index, Record* outRecord) const;
+
+    std::atomic<uint64_t> mNextIndex{0};
+    Slot mSlots[kCapacity];
+};
+
+} /* namespace uirenderer */
+} /* namespace android */
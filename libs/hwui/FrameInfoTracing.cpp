@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FrameInfoTracing.h"
+
+#include <perfetto/public/producer.h>
+#include <perfetto/public/te_category_macros.h>
+#include <perfetto/public/te_macros.h>
+#include <perfetto/public/track_event.h>
+
+#include <mutex>
+
+#include "FrameInfoRing.h"
+
+#define HWUI_FRAME_INFO_CATEGORIES(C) \
+    C(hwui_frame_info, "hwui.frame_info", "HWUI per-frame stage timestamps")
+
+PERFETTO_TE_CATEGORIES_DEFINE(HWUI_FRAME_INFO_CATEGORIES)
+
+namespace android {
+namespace uirenderer {
+namespace FrameInfoTracing {
+
+static std::once_flag sInitFlag;
+static std::mutex sExportLock;
+// Index of the next ring record to export
+static uint64_t sCursor = 0;
+
+static void initialize() {
+    struct PerfettoProducerInitArgs args = PERFETTO_PRODUCER_INIT_ARGS_INIT();
+    args.backends = PERFETTO_BACKEND_SYSTEM;
+    PerfettoProducerInit(args);
+    PerfettoTeInit();
+    PERFETTO_TE_REGISTER_CATEGORIES(HWUI_FRAME_INFO_CATEGORIES);
+}
+
+#define FRAME_INFO_ARG(index) \
+    PERFETTO_TE_ARG_INT64(#index, record.frameInfo[static_cast<int>(FrameInfoIndex::index)])
+
+static void exportRecord(const FrameInfoRing::Record& record) {
+    struct PerfettoTeTimestamp timestamp;
+    timestamp.clock_id = PERFETTO_TE_TIMESTAMP_TYPE_MONOTONIC;
+    timestamp.value = record.frameInfo[static_cast<int>(FrameInfoIndex::IntendedVsync)];
+    // One track per window, as the frames of different windows interleave
+    PERFETTO_TE(hwui_frame_info, PERFETTO_TE_INSTANT("Frame"), PERFETTO_TE_TIMESTAMP(timestamp),
+                PERFETTO_TE_NAMED_TRACK("HWUI frames", record.sourceId,
+                                        PerfettoTeProcessTrackUuid()),
+                PERFETTO_TE_ARG_INT64("FrameNumber", record.frameNumber),
+                PERFETTO_TE_ARG_INT64("SurfaceId", record.surfaceId),
+                FRAME_INFO_ARG(Flags),
+                FRAME_INFO_ARG(FrameTimelineVsyncId),
+                FRAME_INFO_ARG(IntendedVsync),
+                FRAME_INFO_ARG(Vsync),
+                FRAME_INFO_ARG(InputEventId),
+                FRAME_INFO_ARG(HandleInputStart),
+                FRAME_INFO_ARG(AnimationStart),
+                FRAME_INFO_ARG(PerformTraversalsStart),
+                FRAME_INFO_ARG(DrawStart),
+                FRAME_INFO_ARG(FrameDeadline),
+                FRAME_INFO_ARG(FrameStartTime),
+                FRAME_INFO_ARG(FrameInterval),
+                FRAME_INFO_ARG(SyncQueued),
+                FRAME_INFO_ARG(SyncStart),
+                FRAME_INFO_ARG(IssueDrawCommandsStart),
+                FRAME_INFO_ARG(SwapBuffers),
+                FRAME_INFO_ARG(FrameCompleted),
+                FRAME_INFO_ARG(DequeueBufferDuration),
+                FRAME_INFO_ARG(QueueBufferDuration),
+                FRAME_INFO_ARG(GpuCompleted),
+                FRAME_INFO_ARG(SwapBuffersCompleted),
+                FRAME_INFO_ARG(DisplayPresentTime),
+                FRAME_INFO_ARG(CommandSubmissionCompleted));
+}
+
+#undef FRAME_INFO_ARG
+
+static_assert(static_cast<int>(FrameInfoIndex::NumIndexes) == 23,
+              "Export the new FrameInfoIndex in exportRecord");
+
+void onFrameRecorded(const FrameInfoRing& ring) {
+    std::call_once(sInitFlag, initialize);
+    if (!PERFETTO_ATOMIC_LOAD_EXPLICIT(hwui_frame_info.enabled, PERFETTO_MEMORY_ORDER_RELAXED)) {
+        return;
+    }
+    // Frames finish on both the RenderThread and the surface stats thread. Whoever holds the
+    // lock exports for both, and anything it misses goes out with the next frame.
+    std::unique_lock lock{sExportLock, std::try_to_lock};
+    if (!lock.owns_lock()) return;
+    const uint64_t dropped = ring.read(&sCursor, exportRecord);
+    if (dropped > 0) {
+        PERFETTO_TE(hwui_frame_info, PERFETTO_TE_INSTANT("FramesDropped"),
+                    PERFETTO_TE_ARG_UINT64("Count", dropped));
+    }
+}
+
+}  // namespace FrameInfoTracing
+} /* namespace uirenderer */
+} /* namespace android */
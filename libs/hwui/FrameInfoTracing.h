@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+namespace android {
+namespace uirenderer {
+
+class FrameInfoRing;
+
+namespace FrameInfoTracing {
+
+// Called after every FrameInfoRing::push. While a tracing session enables the "hwui.frame_info"
+// category, this writes one Track Event per new record, carrying all of its timestamps. The
+// first call of a session also exports the frames already in the ring.
+#ifdef __ANDROID__
+void onFrameRecorded(const FrameInfoRing& ring);
+#else
+inline void onFrameRecorded(const FrameInfoRing&) {}
+#endif
+
+}  // namespace FrameInfoTracing
+
+} /* namespace uirenderer */
+} /* namespace android */
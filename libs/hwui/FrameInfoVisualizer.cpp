@@ -88,12 +88,12 @@ void FrameInfoVisualizer::setDensity(float density) {
     }
 }
 
-void FrameInfoVisualizer::unionDirty(SkRect* dirty) {
+void FrameInfoVisualizer::unionDirty(DamageRegion* dirty) {
     RETURN_IF_DISABLED();
     // Not worth worrying about minimizing the dirty region for debugging, so just
     // dirty the entire viewport.
     if (dirty) {
-        mDirtyRegion = *dirty;
+        mDirtyRegion = dirty->bounds();
         dirty->setEmpty();
     }
 }
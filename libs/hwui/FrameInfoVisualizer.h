@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "DamageRegion.h"
 #include "FrameInfo.h"
 #include "Properties.h"
 #include "Rect.h"
@@ -45,7 +46,7 @@ public:
     bool consumeProperties();
     void setDensity(float density);
 
-    void unionDirty(SkRect* dirty);
+    void unionDirty(DamageRegion* dirty);
     void draw(IProfileRenderer& renderer);
 
     void dumpData(int fd);
@@ -59,6 +59,13 @@ struct FormatInfo {
     bool valid = true;
 };
 
+struct UploadRequest {
+    const SkBitmap* bitmap;
+    const FormatInfo* format;
+    AHardwareBuffer* ahb;
+    bool succeeded = false;
+};
+
 class AHBUploader : public RefBase {
 public:
     virtual ~AHBUploader() {}
@@ -77,8 +84,16 @@ public:
     bool uploadHardwareBitmap(const SkBitmap& bitmap, const FormatInfo& format,
                               AHardwareBuffer* ahb) {
         ATRACE_CALL();
+        std::vector<UploadRequest> requests{{&bitmap, &format, ahb}};
+        return uploadHardwareBitmaps(requests, nullptr) && requests[0].succeeded;
+    }
+
+    // Uploads every request in one submission. Returns false if nothing could be submitted,
+    // otherwise the outcome of each upload is stored in its request.
+    bool uploadHardwareBitmaps(std::vector<UploadRequest>& requests, base::unique_fd* outFence) {
+        ATRACE_FORMAT("uploadHardwareBitmaps (%zu bitmaps)", requests.size());
         beginUpload();
-        bool result = onUploadHardwareBitmap(bitmap, format, ahb);
+        bool result = onUploadHardwareBitmaps(requests, outFence);
         endUpload();
         return result;
     }
@@ -95,8 +110,8 @@ private:
     virtual void onIdle() = 0;
     virtual void onDestroy() = 0;
 
-    virtual bool onUploadHardwareBitmap(const SkBitmap& bitmap, const FormatInfo& format,
-                                        AHardwareBuffer* ahb) = 0;
+    virtual bool onUploadHardwareBitmaps(std::vector<UploadRequest>& requests,
+                                         base::unique_fd* outFence) = 0;
     virtual void onBeginUpload() = 0;
 
     bool shouldTimeOutLocked() {
@@ -166,31 +181,40 @@ private:
         return mEglManager.eglDisplay();
     }
 
-    bool onUploadHardwareBitmap(const SkBitmap& bitmap, const FormatInfo& format,
-                                AHardwareBuffer* ahb) override {
+    bool onUploadHardwareBitmaps(std::vector<UploadRequest>& requests,
+                                 base::unique_fd* outFence) override {
         ATRACE_CALL();
 
         EGLDisplay display = getUploadEglDisplay();
 
         LOG_ALWAYS_FATAL_IF(display == EGL_NO_DISPLAY, "Failed to get EGL_DEFAULT_DISPLAY! err=%s",
                             uirenderer::renderthread::EglManager::eglErrorString());
-        // We use an EGLImage to access the content of the buffer
+        // We use an EGLImage to access the content of each buffer
         // The EGL image is later bound to a 2D texture
-        const EGLClientBuffer clientBuffer = eglGetNativeClientBufferANDROID(ahb);
-        AutoEglImage autoImage(display, clientBuffer);
-        if (autoImage.image == EGL_NO_IMAGE_KHR) {
-            ALOGW("Could not create EGL image, err =%s",
-                  uirenderer::renderthread::EglManager::eglErrorString());
-            return false;
+        std::vector<std::unique_ptr<AutoEglImage>> images;
+        images.reserve(requests.size());
+        for (const auto& request : requests) {
+            const EGLClientBuffer clientBuffer = eglGetNativeClientBufferANDROID(request.ahb);
+            images.push_back(std::make_unique<AutoEglImage>(display, clientBuffer));
+            if (images.back()->image == EGL_NO_IMAGE_KHR) {
+                ALOGW("Could not create EGL image, err =%s",
+                      uirenderer::renderthread::EglManager::eglErrorString());
+            }
         }
 
-        {
-            ATRACE_FORMAT("CPU -> gralloc transfer (%dx%d)", bitmap.width(), bitmap.height());
-            EGLSyncKHR fence = mUploadThread->queue().runSync([&]() -> EGLSyncKHR {
+        ATRACE_FORMAT("CPU -> gralloc transfer (%zu bitmaps)", requests.size());
+        bool isNativeFence = false;
+        EGLSyncKHR fence = mUploadThread->queue().runSync([&]() -> EGLSyncKHR {
+            bool anySucceeded = false;
+            for (size_t i = 0; i < requests.size(); i++) {
+                if (images[i]->image == EGL_NO_IMAGE_KHR) {
+                    continue;
+                }
+                const SkBitmap& bitmap = *requests[i].bitmap;
                 AutoSkiaGlTexture glTexture;
-                glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, autoImage.image);
+                glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, images[i]->image);
                 if (GLUtils::dumpGLErrors()) {
-                    return EGL_NO_SYNC_KHR;
+                    continue;
                 }
 
                 // glTexSubImage2D is synchronous in sense that it memcpy() from pointer that we
@@ -198,30 +222,56 @@ private:
                 // But asynchronous in sense that driver may upload texture onto hardware buffer
                 // when we first use it in drawing
                 glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, bitmap.width(), bitmap.height(),
-                                format.format, format.type, bitmap.getPixels());
+                                requests[i].format->format, requests[i].format->type,
+                                bitmap.getPixels());
                 if (GLUtils::dumpGLErrors()) {
-                    return EGL_NO_SYNC_KHR;
+                    continue;
                 }
+                requests[i].succeeded = true;
+                anySucceeded = true;
+            }
+            if (!anySucceeded) {
+                return EGL_NO_SYNC_KHR;
+            }
 
-                EGLSyncKHR uploadFence =
-                        eglCreateSyncKHR(eglGetCurrentDisplay(), EGL_SYNC_FENCE_KHR, NULL);
-                if (uploadFence == EGL_NO_SYNC_KHR) {
-                    ALOGW("Could not create sync fence %#x", eglGetError());
-                };
-                glFlush();
-                GLUtils::dumpGLErrors();
-                return uploadFence;
-            });
-
-            if (fence == EGL_NO_SYNC_KHR) {
-                return false;
+            EGLSyncKHR uploadFence = EGL_NO_SYNC_KHR;
+            if (outFence) {
+                // A native fence lets the caller wait for completion in another process or API.
+                uploadFence = eglCreateSyncKHR(eglGetCurrentDisplay(),
+                                               EGL_SYNC_NATIVE_FENCE_ANDROID, nullptr);
+                isNativeFence = uploadFence != EGL_NO_SYNC_KHR;
+            }
+            if (uploadFence == EGL_NO_SYNC_KHR) {
+                uploadFence = eglCreateSyncKHR(eglGetCurrentDisplay(), EGL_SYNC_FENCE_KHR, NULL);
             }
-            EGLint waitStatus = eglClientWaitSyncKHR(display, fence, 0, FENCE_TIMEOUT);
-            ALOGE_IF(waitStatus != EGL_CONDITION_SATISFIED_KHR,
-                    "Failed to wait for the fence %#x", eglGetError());
+            if (uploadFence == EGL_NO_SYNC_KHR) {
+                ALOGW("Could not create sync fence %#x", eglGetError());
+            };
+            glFlush();
+            GLUtils::dumpGLErrors();
+            return uploadFence;
+        });
 
+        if (fence == EGL_NO_SYNC_KHR) {
+            return false;
+        }
+        if (isNativeFence) {
+            // The native fence FD is only available once the commands were flushed.
+            base::unique_fd fenceFd(eglDupNativeFenceFDANDROID(display, fence));
             eglDestroySyncKHR(display, fence);
+            if (fenceFd.ok()) {
+                *outFence = std::move(fenceFd);
+            } else {
+                ALOGW("Could not dup native fence %#x, waiting for uploads", eglGetError());
+                mUploadThread->queue().runSync([]() { glFinish(); });
+            }
+            return true;
         }
+        EGLint waitStatus = eglClientWaitSyncKHR(display, fence, 0, FENCE_TIMEOUT);
+        ALOGE_IF(waitStatus != EGL_CONDITION_SATISFIED_KHR,
+                "Failed to wait for the fence %#x", eglGetError());
+
+        eglDestroySyncKHR(display, fence);
         return true;
     }
 
@@ -241,10 +291,10 @@ private:
 
     void onBeginUpload() override {}
 
-    bool onUploadHardwareBitmap(const SkBitmap& bitmap, const FormatInfo& format,
-                                AHardwareBuffer* ahb) override {
+    bool onUploadHardwareBitmaps(std::vector<UploadRequest>& requests,
+                                 base::unique_fd* /*outFence*/) override {
         bool uploadSucceeded = false;
-        mUploadThread->queue().runSync([this, &uploadSucceeded, bitmap, ahb]() {
+        mUploadThread->queue().runSync([this, &uploadSucceeded, &requests]() {
           ATRACE_CALL();
           std::lock_guard _lock{mVkLock};
 
@@ -263,12 +313,18 @@ private:
               this->postIdleTimeoutCheck();
           }
 
-          sk_sp<SkImage> image =
-              SkImages::TextureFromAHardwareBufferWithData(mGrContext.get(), bitmap.pixmap(),
-                                                           ahb);
+          // Keep the images alive until the single submit below has completed.
+          std::vector<sk_sp<SkImage>> images;
+          images.reserve(requests.size());
+          for (auto& request : requests) {
+              images.push_back(SkImages::TextureFromAHardwareBufferWithData(
+                      mGrContext.get(), request.bitmap->pixmap(), request.ahb));
+              request.succeeded = images.back() != nullptr;
+              uploadSucceeded |= request.succeeded;
+          }
+          // The upload GrContext has no way to hand out a fence for its work, so the batch
+          // completes before returning and outFence stays invalid.
           mGrContext->submit(GrSyncCpu::kYes);
-
-          uploadSucceeded = (image.get() != nullptr);
         });
         return uploadSucceeded;
     }
@@ -474,6 +530,78 @@ sk_sp<Bitmap> HardwareBitmapUploader::allocateHardwareBitmap(const SkBitmap& sou
                               bitmap.alphaType(), Bitmap::computePalette(bitmap));
 }
 
+std::vector<sk_sp<Bitmap>> HardwareBitmapUploader::allocateHardwareBitmaps(
+        const std::vector<SkBitmap>& sourceBitmaps, base::unique_fd* outFence) {
+    ATRACE_CALL();
+
+    std::vector<sk_sp<Bitmap>> results(sourceBitmaps.size());
+    if (outFence) {
+        outFence->reset();
+    }
+    bool usingGL = uirenderer::Properties::getRenderPipelineType() ==
+            uirenderer::RenderPipelineType::SkiaGL;
+
+    // The converted bitmaps and the buffers must stay alive until the upload returns.
+    std::vector<SkBitmap> bitmaps;
+    std::vector<FormatInfo> formats;
+    std::vector<UniqueAHardwareBuffer> buffers;
+    std::vector<size_t> sourceIndices;
+    bitmaps.reserve(sourceBitmaps.size());
+    formats.reserve(sourceBitmaps.size());
+    buffers.reserve(sourceBitmaps.size());
+    sourceIndices.reserve(sourceBitmaps.size());
+    for (size_t i = 0; i < sourceBitmaps.size(); i++) {
+        FormatInfo format = determineFormat(sourceBitmaps[i], usingGL);
+        if (!format.valid) {
+            continue;
+        }
+        SkBitmap bitmap = makeHwCompatible(format, sourceBitmaps[i]);
+        AHardwareBuffer_Desc desc = {
+                .width = static_cast<uint32_t>(bitmap.width()),
+                .height = static_cast<uint32_t>(bitmap.height()),
+                .layers = 1,
+                .format = format.bufferFormat,
+                .usage = AHARDWAREBUFFER_USAGE_CPU_READ_NEVER |
+                         AHARDWAREBUFFER_USAGE_CPU_WRITE_NEVER |
+                         AHARDWAREBUFFER_USAGE_GPU_SAMPLED_IMAGE,
+        };
+        UniqueAHardwareBuffer ahb = allocateAHardwareBuffer(desc);
+        if (!ahb) {
+            ALOGW("allocateHardwareBitmaps() failed in AHardwareBuffer_allocate()");
+            continue;
+        }
+        bitmaps.push_back(std::move(bitmap));
+        formats.push_back(format);
+        buffers.push_back(std::move(ahb));
+        sourceIndices.push_back(i);
+    }
+    if (buffers.empty()) {
+        return results;
+    }
+
+    std::vector<UploadRequest> requests;
+    requests.reserve(buffers.size());
+    for (size_t i = 0; i < buffers.size(); i++) {
+        requests.push_back({&bitmaps[i], &formats[i], buffers[i].get()});
+    }
+
+    createUploader(usingGL);
+
+    if (!sUploader->uploadHardwareBitmaps(requests, outFence)) {
+        return results;
+    }
+    for (size_t i = 0; i < requests.size(); i++) {
+        if (!requests[i].succeeded) {
+            continue;
+        }
+        const SkBitmap& bitmap = bitmaps[i];
+        results[sourceIndices[i]] =
+                Bitmap::createFrom(buffers[i].get(), bitmap.colorType(), bitmap.refColorSpace(),
+                                   bitmap.alphaType(), Bitmap::computePalette(bitmap));
+    }
+    return results;
+}
+
 void HardwareBitmapUploader::initialize() {
     bool usingGL = uirenderer::Properties::getRenderPipelineType() ==
             uirenderer::RenderPipelineType::SkiaGL;
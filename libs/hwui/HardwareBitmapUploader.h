@@ -16,9 +16,12 @@
 
 #pragma once
 
+#include <android-base/unique_fd.h>
 #include <hwui/Bitmap.h>
 #include <SkRefCnt.h>
 
+#include <vector>
+
 class SkBitmap;
 
 namespace android::uirenderer {
@@ -30,6 +33,18 @@ public:
 
     static sk_sp<Bitmap> allocateHardwareBitmap(const SkBitmap& sourceBitmap);
 
+    /**
+     * Uploads all of the given bitmaps with a single GPU submission. Entries of the result are
+     * null for bitmaps that could not be uploaded.
+     *
+     * If outFence is null the uploads have completed when this returns. Otherwise this returns as
+     * soon as the work is submitted, and outFence is set to a sync fence that signals once every
+     * upload has completed; the bitmaps must not be drawn before then. outFence is left invalid
+     * if the uploads had to complete synchronously.
+     */
+    static std::vector<sk_sp<Bitmap>> allocateHardwareBitmaps(
+            const std::vector<SkBitmap>& sourceBitmaps, base::unique_fd* outFence = nullptr);
+
 #ifdef __ANDROID__
     static bool hasFP16Support();
     static bool has1010102Support();
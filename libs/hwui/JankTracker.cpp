@@ -29,6 +29,7 @@
 #include <sstream>
 
 #include "DeviceInfo.h"
+#include "FrameInfoRing.h"
 #include "Properties.h"
 #include "utils/TimeUtils.h"
 #include "utils/Trace.h"
@@ -80,6 +81,7 @@ static FrameInfoIndex sFrameStart = FrameInfoIndex::IntendedVsync;
 
 JankTracker::JankTracker(ProfileDataContainer* globalData)
         : mData(globalData->getDataMutex())
+        , mRingSourceId(FrameInfoRing::nextSourceId())
         , mDataMutex(globalData->getDataMutex()) {
     mGlobalData = globalData;
     nsecs_t frameIntervalNanos = DeviceInfo::getVsyncPeriod();
@@ -169,6 +171,10 @@ void JankTracker::calculateLegacyJank(FrameInfo& frame) REQUIRES(mDataMutex) {
 
 void JankTracker::finishFrame(FrameInfo& frame, std::unique_ptr<FrameMetricsReporter>& reporter,
                               int64_t frameNumber, int32_t surfaceControlId) {
+    if (CC_UNLIKELY(Properties::frameInfoTracing)) {
+        FrameInfoRing::instance().push(frame, frameNumber, surfaceControlId, mRingSourceId);
+    }
+
     std::lock_guard lock(mDataMutex);
 
     calculateLegacyJank(frame);
@@ -99,6 +99,9 @@ private:
     // Ring buffer large enough for 2 seconds worth of frames
     RingBuffer<FrameInfo, 120> mFrames;
 
+    // Tags this window's frames in FrameInfoRing
+    const uint32_t mRingSourceId;
+
     // Mutex to protect acccess to mData and mGlobalData obtained from mGlobalData->getDataMutex
     std::mutex& mDataMutex;
 };
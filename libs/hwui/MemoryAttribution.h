@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <utils/LightRefBase.h>
+#include <utils/StrongPointer.h>
+
+#include <array>
+#include <atomic>
+#include <string>
+
+namespace android {
+namespace uirenderer {
+
+enum class AttributedMemoryType {
+    // Offscreen surfaces of RenderNodes with LAYER_TYPE_HARDWARE
+    RenderNodeLayer = 0,
+    // Buffers wrapped for TextureView and other DeferredLayerUpdater consumers
+    TextureLayer,
+    // AHardwareBuffers backing Bitmap.Config.HARDWARE bitmaps
+    HardwareBitmap,
+};
+constexpr size_t kAttributedMemoryTypeCount = 3;
+
+/**
+ * The GPU memory hwui holds on behalf of one owner, usually a CanvasContext, by type.
+ *
+ * Skia only reports its resources by category, so allocations hwui makes for a window are
+ * tagged with that window's MemoryAttribution when they are created. The counters are atomic
+ * because tagged resources may be released off the RenderThread.
+ */
+class MemoryAttribution : public VirtualLightRefBase {
+public:
+    explicit MemoryAttribution(std::string name) : mName(std::move(name)) {}
+
+    // Hardware bitmaps are shared by every window in the process, so they are attributed here
+    static const sp<MemoryAttribution>& sharedHardwareBitmaps() {
+        static const sp<MemoryAttribution> sShared = new MemoryAttribution("Hardware bitmaps");
+        return sShared;
+    }
+
+    const std::string& name() const { return mName; }
+    void setName(std::string name) { mName = std::move(name); }
+
+    size_t bytes(AttributedMemoryType type) const {
+        return mCounters[static_cast<size_t>(type)].bytes.load(std::memory_order_relaxed);
+    }
+    size_t count(AttributedMemoryType type) const {
+        return mCounters[static_cast<size_t>(type)].count.load(std::memory_order_relaxed);
+    }
+    size_t totalBytes() const {
+        size_t total = 0;
+        for (const Counter& counter : mCounters) {
+            total += counter.bytes.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+private:
+    friend class MemoryTag;
+
+    struct Counter {
+        std::atomic<size_t> bytes{0};
+        std::atomic<size_t> count{0};
+    };
+
+    void add(AttributedMemoryType type, size_t bytes) {
+        Counter& counter = mCounters[static_cast<size_t>(type)];
+        counter.bytes.fetch_add(bytes, std::memory_order_relaxed);
+        counter.count.fetch_add(1, std::memory_order_relaxed);
+    }
+    void remove(AttributedMemoryType type, size_t bytes) {
+        Counter& counter = mCounters[static_cast<size_t>(type)];
+        counter.bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        counter.count.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Only read and written on the RenderThread
+    std::string mName;
+    std::array<Counter, kAttributedMemoryTypeCount> mCounters;
+};
+
+/**
+ * Charges one allocation to a MemoryAttribution for as long as the tag lives, so that a tag
+ * stored next to the resource it describes releases the charge with it.
+ */
+class MemoryTag {
+public:
+    MemoryTag() = default;
+    ~MemoryTag() { reset(); }
+
+    MemoryTag(const MemoryTag&) = delete;
+    MemoryTag& operator=(const MemoryTag&) = delete;
+
+    void set(const sp<MemoryAttribution>& attribution, AttributedMemoryType type, size_t bytes) {
+        reset();
+        if (attribution) {
+            attribution->add(type, bytes);
+            mAttribution = attribution;
+            mType = type;
+            mBytes = bytes;
+        }
+    }
+
+    void reset() {
+        if (mAttribution) {
+            mAttribution->remove(mType, mBytes);
+            mAttribution.clear();
+            mBytes = 0;
+        }
+    }
+
+    size_t bytes() const { return mBytes; }
+
+private:
+    sp<MemoryAttribution> mAttribution;
+    AttributedMemoryType mType = AttributedMemoryType::RenderNodeLayer;
+    size_t mBytes = 0;
+};
+
+} /* namespace uirenderer */
+} /* namespace android */
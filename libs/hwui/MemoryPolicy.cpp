@@ -34,6 +34,9 @@ constexpr static MemoryPolicy sPersistentOrSystemPolicy{
         .purgeScratchOnly = false,
 };
 constexpr static MemoryPolicy sLowRamPolicy{
+        .maxAdaptiveResourceScale = 1.0f,
+        .animatedImageFramesAhead = 1,
+        .contextLayerBudgetMultiplier = 4 * 4.0f,
         .useAlternativeUiHidden = true,
         .purgeScratchOnly = false,
 };
@@ -41,6 +44,9 @@ constexpr static MemoryPolicy sExtremeLowRam{
         .initialMaxSurfaceAreaScale = 0.2f,
         .surfaceSizeMultiplier = 5 * 4.0f,
         .backgroundRetentionPercent = 0.2f,
+        .maxAdaptiveResourceScale = 1.0f,
+        .animatedImageFramesAhead = 1,
+        .contextLayerBudgetMultiplier = 2 * 4.0f,
         .contextTimeout = 5_s,
         .minimumResourceRetention = 1_s,
         .useAlternativeUiHidden = true,
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <cstddef>
+
 #include "utils/TimeUtils.h"
 
 namespace android::uirenderer {
@@ -47,6 +49,19 @@ struct MemoryPolicy {
     float surfaceSizeMultiplier = 12.0f * 4.0f;
     // How much of the foreground cache size should be preserved when going into the background
     float backgroundRetentionPercent = 0.5f;
+    // The largest factor by which the foreground cache size may grow when frames miss their
+    // deadline while the resource cache is full. The growth is undone on memory pressure.
+    // A value of 1 disables adaptive growth
+    float maxAdaptiveResourceScale = 2.0f;
+    // How many frames each AnimatedImageDrawable may decode ahead of the one on screen
+    int animatedImageFramesAhead = 3;
+    // The most memory the frames decoded ahead by a single AnimatedImageDrawable may use. Large
+    // images decode fewer frames ahead, but always at least one
+    size_t animatedImageDecodeAheadBytes = 8 * 1024 * 1024;
+    // The most GPU memory the layers of a single CanvasContext may hold, as a multiple of the
+    // display's surface area. RenderNodes that would exceed it draw without a layer. A value of
+    // 0 disables the budget
+    float contextLayerBudgetMultiplier = 0.0f;
     // How long after the last renderer goes away before the GPU context is released. A value
     // of 0 means only drop the context on background TRIM signals
     nsecs_t contextTimeout = 10_s;
@@ -17,6 +17,7 @@
 #include "Mesh.h"
 
 #include <GLES/gl.h>
+#include <SkCanvas.h>
 #include <SkMesh.h>
 
 #include "SafeMath.h"
@@ -109,4 +110,24 @@ std::tuple<bool, SkString> Mesh::validate() {
     return {true, {}};
 }
 
+void Mesh::drawInstances(SkCanvas* canvas, const SkMesh& mesh, const sk_sp<SkBlender>& blender,
+                         const SkPaint& paint, const SkMatrix transforms[], const SkColor colors[],
+                         int count) {
+    if (colors == nullptr) {
+        for (int i = 0; i < count; i++) {
+            SkAutoCanvasRestore acr(canvas, true);
+            canvas->concat(transforms[i]);
+            canvas->drawMesh(mesh, blender, paint);
+        }
+        return;
+    }
+    SkPaint instancePaint(paint);
+    for (int i = 0; i < count; i++) {
+        SkAutoCanvasRestore acr(canvas, true);
+        canvas->concat(transforms[i]);
+        instancePaint.setColor(colors[i]);
+        canvas->drawMesh(mesh, blender, instancePaint);
+    }
+}
+
 }  // namespace android
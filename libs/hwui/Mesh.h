@@ -17,14 +17,20 @@
 #ifndef MESH_H_
 #define MESH_H_
 
+#include <SkColor.h>
+#include <SkMatrix.h>
 #include <SkMesh.h>
 #include <include/gpu/ganesh/GrDirectContext.h>
 #include <include/gpu/ganesh/SkMeshGanesh.h>
 #include <jni.h>
 #include <log/log.h>
 
+#include <algorithm>
+#include <mutex>
 #include <utility>
 
+class SkCanvas;
+
 namespace android {
 
 class MeshUniformBuilder {
@@ -118,12 +124,20 @@ public:
             , mIndexData(std::move(indexData)) {}
 
     void updateBuffers(GrDirectContext* context) const {
+        std::lock_guard lock(mLock);
         GrDirectContext::DirectContextID currentId = context == nullptr
                                                              ? GrDirectContext::DirectContextID()
                                                              : context->directContextID();
         if (currentId == mSkiaBuffers.fGenerationId && mSkiaBuffers.fVertexBuffer != nullptr) {
-            // Nothing to update since the Android API does not support partial updates yet.
-            return;
+            // The buffers already live on this context, so only the ranges written since the
+            // last call need to be copied. Fall back to a full upload if Skia rejects the update.
+            if (flushDirtyRange(context, mSkiaBuffers.fVertexBuffer.get(), mVertexData,
+                                &mVertexDirty) &&
+                (mSkiaBuffers.fIndexBuffer == nullptr ||
+                 flushDirtyRange(context, mSkiaBuffers.fIndexBuffer.get(), mIndexData,
+                                 &mIndexDirty))) {
+                return;
+            }
         }
 
         mSkiaBuffers.fVertexBuffer =
@@ -141,6 +155,22 @@ public:
 #endif
         }
         mSkiaBuffers.fGenerationId = currentId;
+        mVertexDirty = {};
+        mIndexDirty = {};
+    }
+
+    // Overwrites size bytes of the vertex data starting at offset. The GPU copy is patched in
+    // place on the next updateBuffers call rather than being re-uploaded. Returns false if the
+    // range does not fit inside the existing vertex data.
+    bool updateVertexData(size_t offset, const void* data, size_t size) {
+        std::lock_guard lock(mLock);
+        return writeRange(&mVertexData, &mVertexDirty, offset, data, size);
+    }
+
+    // Same as updateVertexData, for the index data of an indexed mesh.
+    bool updateIndexData(size_t offset, const void* data, size_t size) {
+        std::lock_guard lock(mLock);
+        return writeRange(&mIndexData, &mIndexDirty, offset, data, size);
     }
 
     SkMesh::VertexBuffer* vertexBuffer() const { return mSkiaBuffers.fVertexBuffer.get(); }
@@ -163,7 +193,52 @@ private:
         GrDirectContext::DirectContextID fGenerationId = GrDirectContext::DirectContextID();
     };
 
+    // Byte range [fBegin, fEnd) of the CPU data not yet copied to the Skia buffers.
+    struct DirtyRange {
+        size_t fBegin = 0;
+        size_t fEnd = 0;
+
+        bool isEmpty() const { return fBegin >= fEnd; }
+    };
+
+    static bool writeRange(std::vector<uint8_t>* dst, DirtyRange* dirty, size_t offset,
+                           const void* data, size_t size) {
+        if (offset > dst->size() || size > dst->size() - offset) {
+            return false;
+        }
+        if (size == 0) {
+            return true;
+        }
+        memcpy(dst->data() + offset, data, size);
+        if (dirty->isEmpty()) {
+            *dirty = {offset, offset + size};
+        } else {
+            dirty->fBegin = std::min(dirty->fBegin, offset);
+            dirty->fEnd = std::max(dirty->fEnd, offset + size);
+        }
+        return true;
+    }
+
+    template <typename Buffer>
+    static bool flushDirtyRange(GrDirectContext* context, Buffer* buffer,
+                                const std::vector<uint8_t>& data, DirtyRange* dirty) {
+        if (dirty->isEmpty()) {
+            return true;
+        }
+        // Skia requires updates to be 4 byte aligned in both offset and size.
+        size_t begin = dirty->fBegin & ~size_t(3);
+        size_t end = std::min((dirty->fEnd + 3) & ~size_t(3), data.size());
+        if (!buffer->update(context, data.data() + begin, begin, end - begin)) {
+            return false;
+        }
+        *dirty = {};
+        return true;
+    }
+
+    mutable std::mutex mLock;
     mutable CachedSkiaBuffers mSkiaBuffers;
+    mutable DirtyRange mVertexDirty;
+    mutable DirtyRange mIndexDirty;
     int32_t mVertexCount = 0;
     int32_t mVertexOffset = 0;
     int32_t mIndexCount = 0;
@@ -261,6 +336,22 @@ public:
 
     MeshUniformBuilder* uniformBuilder() { return &mUniformBuilder; }
 
+    // Partially rewrites the vertex or index data. Display lists that already reference this mesh
+    // observe the new contents, in the same way they observe writes to a mutable Bitmap.
+    bool updateVertexData(size_t offset, const void* data, size_t size) {
+        return mBufferData->updateVertexData(offset, data, size);
+    }
+    bool updateIndexData(size_t offset, const void* data, size_t size) {
+        return mBufferData->updateIndexData(offset, data, size);
+    }
+
+    // Draws count copies of mesh, each concatenated with transforms[i] and, if colors is not
+    // null, using colors[i] as the paint color. All copies share the same vertex and index
+    // buffers so the geometry is only uploaded once.
+    static void drawInstances(SkCanvas* canvas, const SkMesh& mesh, const sk_sp<SkBlender>& blender,
+                              const SkPaint& paint, const SkMatrix transforms[],
+                              const SkColor colors[], int count);
+
 private:
     sk_sp<SkMeshSpecification> mMeshSpec;
     SkMesh::Mode mMode;
@@ -19,8 +19,15 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <utils/Log.h>
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace android {
@@ -97,10 +104,95 @@ static void extract(int* outEndPosition, bool* outEndWithNegOrDot, const char* s
     *outEndPosition = currentIndex;
 }
 
+static constexpr float kPowersOfTen[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f,
+                                         1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+// Floats represent every integer up to 2^24 exactly, so up to 7 significant digits
+static constexpr int kMaxFastDigits = 7;
+static constexpr int kMaxFastExponent = 10;
+
+static inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+/**
+ * Parses the plain decimal float at the start of s the way strtof would, for the common case of
+ * a few significant digits and a small exponent. Both the digits and the power of ten are then
+ * exact floats, so a single multiplication or division is correctly rounded.
+ *
+ * Returns false for anything else, such as leading whitespace, hexadecimal, inf or nan, which
+ * is left to strtof.
+ */
+static bool parseSimpleFloat(const char* s, float* outValue) {
+    const char* p = s;
+    const bool negative = *p == '-';
+    if (*p == '-' || *p == '+') p++;
+
+    // The significant digits without trailing zeros, which are folded into the exponent
+    uint32_t mantissa = 0;
+    int significantDigits = 0;
+    int trailingZeros = 0;
+    int exponent = 0;
+    bool sawDigit = false;
+    auto addDigit = [&](int digit) {
+        sawDigit = true;
+        if (digit == 0) {
+            if (mantissa != 0) trailingZeros++;
+            return true;
+        }
+        significantDigits += trailingZeros + 1;
+        if (significantDigits > kMaxFastDigits) return false;
+        for (; trailingZeros > 0; trailingZeros--) {
+            mantissa *= 10;
+        }
+        mantissa = mantissa * 10 + digit;
+        return true;
+    };
+    for (; isDigit(*p); p++) {
+        if (!addDigit(*p - '0')) return false;
+    }
+    if (*p == '.') {
+        for (p++; isDigit(*p); p++) {
+            exponent--;
+            if (!addDigit(*p - '0')) return false;
+        }
+    }
+    exponent += trailingZeros;
+    if (!sawDigit) return false;
+    // strtof treats "0x" as the start of a hexadecimal float
+    if ((*p == 'x' || *p == 'X') && p - s <= 2 && p[-1] == '0') return false;
+    if (*p == 'e' || *p == 'E') {
+        // The exponent only counts if it has digits, otherwise the number ends before the 'e'
+        const char* e = p + 1;
+        const bool negativeExponent = *e == '-';
+        if (*e == '-' || *e == '+') e++;
+        if (isDigit(*e)) {
+            int exponentValue = 0;
+            for (; isDigit(*e); e++) {
+                exponentValue = exponentValue * 10 + (*e - '0');
+                if (exponentValue > 2 * kMaxFastExponent) return false;
+            }
+            exponent += negativeExponent ? -exponentValue : exponentValue;
+        }
+    }
+    if (mantissa == 0) {
+        *outValue = negative ? -0.0f : 0.0f;
+        return true;
+    }
+    if (exponent < -kMaxFastExponent || exponent > kMaxFastExponent) return false;
+    float value = static_cast<float>(mantissa);
+    value = exponent < 0 ? value / kPowersOfTen[-exponent] : value * kPowersOfTen[exponent];
+    *outValue = negative ? -value : value;
+    return true;
+}
+
 static float parseFloat(PathParser::ParseResult* result, const char* startPtr,
                         size_t expectedLength) {
+    float currentValue;
+    if (parseSimpleFloat(startPtr, &currentValue)) {
+        return currentValue;
+    }
     char* endPtr = NULL;
-    float currentValue = strtof(startPtr, &endPtr);
+    currentValue = strtof(startPtr, &endPtr);
     if ((currentValue == HUGE_VALF || currentValue == -HUGE_VALF) && errno == ERANGE) {
         result->failureOccurred = true;
         result->failureMessage = "Float out of range:  ";
@@ -212,14 +304,92 @@ void PathParser::validateVerbAndPoints(char verb, size_t points, PathParser::Par
                               std::to_string(points) + " float(s) are found. ";
 }
 
-void PathParser::getPathDataFromAsciiString(PathData* data, ParseResult* result,
-                                            const char* pathStr, size_t strLen) {
-    if (pathStr == NULL) {
-        result->failureOccurred = true;
-        result->failureMessage = "Path string cannot be NULL.";
-        return;
+namespace {
+
+struct CachedPath {
+    PathData data;
+    // Built on first use by parseAsciiStringForSkPath
+    std::optional<SkPath> path;
+};
+
+/**
+ * Process-wide cache of successfully parsed path strings. The same icons get inflated over and
+ * over, so most lookups hit. Entries are immutable once inserted, and the oldest ones are
+ * dropped when the cache grows past kMaxBytes.
+ */
+class ParsedPathCache {
+public:
+    static ParsedPathCache& get() {
+        static ParsedPathCache* sInstance = new ParsedPathCache();
+        return *sInstance;
+    }
+
+    std::shared_ptr<const CachedPath> find(std::string_view key) {
+        std::lock_guard lock(mLock);
+        auto it = mEntries.find(key);
+        return it != mEntries.end() ? it->second.path : nullptr;
     }
 
+    void insert(std::string_view key, std::shared_ptr<const CachedPath> path) {
+        const size_t bytes = sizeOf(key, *path);
+        if (bytes > kMaxBytes / 8) return;
+        std::lock_guard lock(mLock);
+        auto [it, inserted] = mEntries.try_emplace(std::string(key));
+        if (inserted) {
+            mInsertionOrder.push_back(&it->first);
+        } else {
+            mBytes -= it->second.bytes;
+        }
+        it->second = {std::move(path), bytes};
+        mBytes += bytes;
+        while (mBytes > kMaxBytes) {
+            auto oldest = mEntries.find(*mInsertionOrder.front());
+            mBytes -= oldest->second.bytes;
+            mEntries.erase(oldest);
+            mInsertionOrder.pop_front();
+        }
+    }
+
+    void clear() {
+        std::lock_guard lock(mLock);
+        mEntries.clear();
+        mInsertionOrder.clear();
+        mBytes = 0;
+    }
+
+private:
+    static constexpr size_t kMaxBytes = 256 * 1024;
+
+    struct Entry {
+        std::shared_ptr<const CachedPath> path;
+        size_t bytes = 0;
+    };
+
+    static size_t sizeOf(std::string_view key, const CachedPath& path) {
+        return key.size() + path.data.verbs.size() * sizeof(char) +
+               path.data.verbSizes.size() * sizeof(size_t) +
+               path.data.points.size() * sizeof(float) + sizeof(CachedPath) + sizeof(Entry);
+    }
+
+    std::mutex mLock;
+    // Allows looking keys up without copying them into a std::string
+    struct KeyHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view key) const {
+            return std::hash<std::string_view>()(key);
+        }
+    };
+
+    std::unordered_map<std::string, Entry, KeyHash, std::equal_to<>> mEntries;
+    // Keys of mEntries, oldest first. Map nodes are stable so the pointers stay valid.
+    std::deque<const std::string*> mInsertionOrder;
+    size_t mBytes = 0;
+};
+
+}  // namespace
+
+static void parsePathData(PathData* data, PathParser::ParseResult* result, const char* pathStr,
+                          size_t strLen) {
     size_t start = 0;
     // Skip leading spaces.
     while (isspace(pathStr[start]) && start < strLen) {
@@ -234,24 +404,26 @@ void PathParser::getPathDataFromAsciiString(PathData* data, ParseResult* result,
 
     while (end < strLen) {
         end = nextStart(pathStr, strLen, end);
-        std::vector<float> points;
-        getFloats(&points, result, pathStr, start, end);
-        validateVerbAndPoints(pathStr[start], points.size(), result);
+        // Parse straight into the output, dropping the points again if they turn out invalid
+        const size_t pointsStart = data->points.size();
+        getFloats(&data->points, result, pathStr, start, end);
+        const size_t pointCount = data->points.size() - pointsStart;
+        PathParser::validateVerbAndPoints(pathStr[start], pointCount, result);
         if (result->failureOccurred) {
+            data->points.resize(pointsStart);
             // If either verb or points is not valid, return immediately.
             result->failureMessage += "Failure occurred at position " + std::to_string(start) +
                                       " of path: " + pathStr;
             return;
         }
         data->verbs.push_back(pathStr[start]);
-        data->verbSizes.push_back(points.size());
-        data->points.insert(data->points.end(), points.begin(), points.end());
+        data->verbSizes.push_back(pointCount);
         start = end;
         end++;
     }
 
     if ((end - start) == 1 && start < strLen) {
-        validateVerbAndPoints(pathStr[start], 0, result);
+        PathParser::validateVerbAndPoints(pathStr[start], 0, result);
         if (result->failureOccurred) {
             // If either verb or points is not valid, return immediately.
             result->failureMessage += "Failure occurred at position " + std::to_string(start) +
@@ -263,6 +435,49 @@ void PathParser::getPathDataFromAsciiString(PathData* data, ParseResult* result,
     }
 }
 
+// Returns the parsed path for pathStr, or nullptr with the failure described in result
+static std::shared_ptr<const CachedPath> findOrParse(PathParser::ParseResult* result,
+                                                     const char* pathStr, size_t strLen,
+                                                     PathData* outPartialData) {
+    const std::string_view key(pathStr, strLen);
+    ParsedPathCache& cache = ParsedPathCache::get();
+    if (auto cached = cache.find(key)) {
+        return cached;
+    }
+    auto parsed = std::make_shared<CachedPath>();
+    parsePathData(&parsed->data, result, pathStr, strLen);
+    if (result->failureOccurred) {
+        if (outPartialData) *outPartialData = std::move(parsed->data);
+        return nullptr;
+    }
+    cache.insert(key, parsed);
+    return parsed;
+}
+
+static void appendPathData(PathData* data, const PathData& other) {
+    data->verbs.insert(data->verbs.end(), other.verbs.begin(), other.verbs.end());
+    data->verbSizes.insert(data->verbSizes.end(), other.verbSizes.begin(), other.verbSizes.end());
+    data->points.insert(data->points.end(), other.points.begin(), other.points.end());
+}
+
+void PathParser::getPathDataFromAsciiString(PathData* data, ParseResult* result,
+                                            const char* pathStr, size_t strLen) {
+    if (pathStr == NULL) {
+        result->failureOccurred = true;
+        result->failureMessage = "Path string cannot be NULL.";
+        return;
+    }
+
+    PathData partialData;
+    auto parsed = findOrParse(result, pathStr, strLen, &partialData);
+    // On failure, still hand out the verbs that parsed before the bad one
+    appendPathData(data, parsed ? parsed->data : partialData);
+}
+
+void PathParser::clearCache() {
+    ParsedPathCache::get().clear();
+}
+
 void PathParser::dump(const PathData& data) {
     // Print out the path data.
     size_t start = 0;
@@ -286,20 +501,30 @@ void PathParser::dump(const PathData& data) {
 
 void PathParser::parseAsciiStringForSkPath(SkPath* skPath, ParseResult* result, const char* pathStr,
                                            size_t strLen) {
-    PathData pathData;
-    getPathDataFromAsciiString(&pathData, result, pathStr, strLen);
-    if (result->failureOccurred) {
+    if (pathStr == NULL) {
+        result->failureOccurred = true;
+        result->failureMessage = "Path string cannot be NULL.";
+        return;
+    }
+    auto parsed = findOrParse(result, pathStr, strLen, nullptr);
+    if (!parsed) {
         return;
     }
     // Check if there is valid data coming out of parsing the string.
-    if (pathData.verbs.size() == 0) {
+    if (parsed->data.verbs.size() == 0) {
         result->failureOccurred = true;
         result->failureMessage = "No verbs found in the string for pathData: ";
         result->failureMessage += pathStr;
         return;
     }
-    VectorDrawableUtils::verbsToPath(skPath, pathData);
-    return;
+    if (parsed->path) {
+        // SkPath copies share their points, so this is cheap
+        *skPath = *parsed->path;
+        return;
+    }
+    VectorDrawableUtils::verbsToPath(skPath, parsed->data);
+    ParsedPathCache::get().insert(std::string_view(pathStr, strLen),
+                                  std::make_shared<CachedPath>(CachedPath{parsed->data, *skPath}));
 }
 
 }  // namespace uirenderer
@@ -36,12 +36,17 @@ public:
     };
     /**
      * Parse the string literal and create a Skia Path. Return true on success.
+     *
+     * Successfully parsed strings are cached for the whole process, so parsing the same path
+     * again only costs a lookup.
      */
     static void parseAsciiStringForSkPath(SkPath* outPath, ParseResult* result,
                                           const char* pathStr, size_t strLength);
     static void getPathDataFromAsciiString(PathData* outData, ParseResult* result,
                                            const char* pathStr, size_t strLength);
     static void dump(const PathData& data);
+    // Drops every cached path, so that the next parses start cold
+    static void clearCache();
     static void validateVerbAndPoints(char verb, size_t points, ParseResult* result);
 };
 
@@ -61,8 +61,11 @@ bool Properties::debugOverdraw = false;
 bool Properties::debugTraceGpuResourceCategories = false;
 bool Properties::showDirtyRegions = false;
 bool Properties::skipEmptyFrames = true;
+bool Properties::skipUnchangedDisplayLists = false;
 bool Properties::useBufferAge = true;
 bool Properties::enablePartialUpdates = true;
+int Properties::maxDamageRects = 4;
+bool Properties::frameInfoTracing = false;
 // Default true unless otherwise specified in RenderThread Configuration
 bool Properties::enableRenderEffectCache = true;
 
@@ -97,8 +100,14 @@ float Properties::defaultSdrWhitePoint = 200.f;
 
 bool Properties::useHintManager = false;
 int Properties::targetCpuTimePercentage = 70;
+bool Properties::usePredictiveHints = true;
+int Properties::commonPoolThreadCount = 0;
 
 bool Properties::enableWebViewOverlays = true;
+bool Properties::enableVectorDrawableAtlas = true;
+int Properties::regionDecoderCacheKb = 0;
+bool Properties::enableTonemapLut = true;
+bool Properties::dequeueAhead = false;
 
 bool Properties::isHighEndGfx = true;
 bool Properties::isLowRam = false;
@@ -152,8 +161,12 @@ bool Properties::load() {
     debugLevel = (DebugLevel)base::GetIntProperty(PROPERTY_DEBUG, (int)kDebugDisabled);
 
     skipEmptyFrames = base::GetBoolProperty(PROPERTY_SKIP_EMPTY_DAMAGE, true);
+    skipUnchangedDisplayLists =
+            base::GetBoolProperty(PROPERTY_SKIP_UNCHANGED_DISPLAY_LISTS, false);
     useBufferAge = base::GetBoolProperty(PROPERTY_USE_BUFFER_AGE, true);
     enablePartialUpdates = base::GetBoolProperty(PROPERTY_ENABLE_PARTIAL_UPDATES, true);
+    maxDamageRects = base::GetIntProperty(PROPERTY_MAX_DAMAGE_RECTS, 4);
+    frameInfoTracing = base::GetBoolProperty(PROPERTY_FRAME_INFO_TRACING, false);
 
     filterOutTestOverhead = base::GetBoolProperty(PROPERTY_FILTER_TEST_OVERHEAD, false);
 
@@ -171,8 +184,14 @@ bool Properties::load() {
     useHintManager = base::GetBoolProperty(PROPERTY_USE_HINT_MANAGER, false);
     targetCpuTimePercentage = base::GetIntProperty(PROPERTY_TARGET_CPU_TIME_PERCENTAGE, 70);
     if (targetCpuTimePercentage <= 0 || targetCpuTimePercentage > 100) targetCpuTimePercentage = 70;
+    usePredictiveHints = base::GetBoolProperty(PROPERTY_PREDICTIVE_HINTS, true);
+    commonPoolThreadCount = base::GetIntProperty(PROPERTY_COMMON_POOL_THREADS, 0);
 
     enableWebViewOverlays = base::GetBoolProperty(PROPERTY_WEBVIEW_OVERLAYS_ENABLED, true);
+    enableVectorDrawableAtlas = base::GetBoolProperty(PROPERTY_VECTOR_DRAWABLE_ATLAS, true);
+    regionDecoderCacheKb = base::GetIntProperty(PROPERTY_REGION_DECODER_CACHE_KB, 0);
+    enableTonemapLut = base::GetBoolProperty(PROPERTY_TONEMAP_LUT, true);
+    dequeueAhead = base::GetBoolProperty(PROPERTY_DEQUEUE_AHEAD, false);
 
     auto hdrHeadroom = (float)atof(base::GetProperty(PROPERTY_8BIT_HDR_HEADROOM, "").c_str());
     if (hdrHeadroom >= 1.f) {
@@ -282,5 +301,9 @@ bool Properties::initializeGlAlways() {
     return base::GetBoolProperty(PROPERTY_INITIALIZE_GL_ALWAYS, hwui_flags::initialize_gl_always());
 }
 
+bool Properties::prewarmGpuContext() {
+    return base::GetBoolProperty(PROPERTY_PREWARM_GPU_CONTEXT, false);
+}
+
 }  // namespace uirenderer
 }  // namespace android
@@ -108,6 +108,14 @@ enum DebugLevel {
  */
 #define PROPERTY_SKIP_EMPTY_DAMAGE "debug.hwui.skip_empty_damage"
 
+/**
+ * Setting this property will keep a RenderNode's current display list, and skip
+ * its damage, when a newly recorded display list has identical content. Only
+ * display lists without children or objects that change on their own are
+ * compared. Default is "false".
+ */
+#define PROPERTY_SKIP_UNCHANGED_DISPLAY_LISTS "debug.hwui.skip_unchanged_display_lists"
+
 /**
  * Controls whether or not HWUI will use the EGL_EXT_buffer_age extension
  * to do partial invalidates. Setting this to "false" will fall back to
@@ -123,6 +131,14 @@ enum DebugLevel {
  */
 #define PROPERTY_ENABLE_PARTIAL_UPDATES "debug.hwui.use_partial_updates"
 
+/**
+ * The maximum number of disjoint rectangles used to describe the damage of a frame
+ * when doing partial updates. Damage that does not fit is merged into the bounding
+ * rectangles. Setting this to 1 always uses a single bounding rectangle.
+ * Default is "4"
+ */
+#define PROPERTY_MAX_DAMAGE_RECTS "debug.hwui.max_damage_rects"
+
 #define PROPERTY_FILTER_TEST_OVERHEAD "debug.hwui.filter_test_overhead"
 
 /**
@@ -179,6 +195,14 @@ enum DebugLevel {
  */
 #define PROPERTY_SKIA_USE_PERFETTO_TRACK_EVENTS "debug.hwui.skia_use_perfetto_track_events"
 
+/**
+ * Streams the timestamps of every finished frame to Perfetto as "hwui.frame_info" Track Events,
+ * read from the process-wide FrameInfoRing without any observer dispatch. Events are only
+ * recorded while a tracing session enables that category.
+ * Default is "false"
+ */
+#define PROPERTY_FRAME_INFO_TRACING "debug.hwui.frame_info_tracing"
+
 /**
  * Defines how many frames in a sequence to capture.
  */
@@ -203,6 +227,20 @@ enum DebugLevel {
  */
 #define PROPERTY_TARGET_CPU_TIME_PERCENTAGE "debug.hwui.target_cpu_time_percent"
 
+/**
+ * Controls whether HWUI predicts each frame's work duration from recent frames and sends a
+ * load up hint to HintManager before a frame that is expected to miss its target, such as the
+ * first frame on a new surface. Only used with use_hint_manager.
+ * Accepted values are "true" and "false". Default is "true"
+ */
+#define PROPERTY_PREDICTIVE_HINTS "debug.hwui.predictive_hints"
+
+/**
+ * Number of hwuiTask worker threads. By default, or if it is 0, the count is
+ * derived from the CPU topology.
+ */
+#define PROPERTY_COMMON_POOL_THREADS "debug.hwui.common_pool_threads"
+
 /**
  * Property for whether this is running in the emulator.
  */
@@ -219,6 +257,34 @@ enum DebugLevel {
  */
 #define PROPERTY_WEBVIEW_OVERLAYS_ENABLED "debug.hwui.webview_overlays_enabled"
 
+/**
+ * Controls whether the GPU pipelines rasterize the caches of small VectorDrawables into a
+ * shared atlas texture instead of one bitmap each.
+ * Accepted values are "true" and "false". Default is "true"
+ */
+#define PROPERTY_VECTOR_DRAWABLE_ATLAS "debug.hwui.vector_drawable_atlas"
+
+/**
+ * The size in KB of the cache each BitmapRegionDecoder keeps of recently decoded regions.
+ * Repeated requests for the same region are then served by copying the cached pixels.
+ * Default is "0", which disables the cache
+ */
+#define PROPERTY_REGION_DECODER_CACHE_KB "debug.hwui.region_decoder_cache_kb"
+
+/**
+ * Controls whether HDR tonemapping color filters are baked into a 3D lookup table that is
+ * shared by every draw with the same source, destination and display headroom.
+ * Accepted values are "true" and "false". Default is "true"
+ */
+#define PROPERTY_TONEMAP_LUT "debug.hwui.tonemap_lut"
+
+/**
+ * Controls whether the next buffer is dequeued as soon as a frame has been queued, instead of
+ * when the next frame starts drawing, so that a blocking dequeue does not eat into that frame.
+ * Accepted values are "true" and "false". Default is "false"
+ */
+#define PROPERTY_DEQUEUE_AHEAD "debug.hwui.dequeue_ahead"
+
 /**
  * Property for globally GL drawing state. Can be overridden per process with
  * setDrawingEnabled.
@@ -234,6 +300,12 @@ enum DebugLevel {
  */
 #define PROPERTY_INITIALIZE_GL_ALWAYS "debug.hwui.initialize_gl_always"
 
+/**
+ * Whether preloading the RenderThread also creates the GL context and loads the shader cache,
+ * instead of leaving that to the first frame. Vulkan always does this.
+ */
+#define PROPERTY_PREWARM_GPU_CONTEXT "debug.hwui.prewarm_gpu_context"
+
 #define PROPERTY_SKIP_EGLMANAGER_TELEMETRY "debug.hwui.skip_eglmanager_telemetry"
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -274,8 +346,11 @@ public:
     static bool showDirtyRegions;
     // TODO: Remove after stabilization period
     static bool skipEmptyFrames;
+    static bool skipUnchangedDisplayLists;
     static bool useBufferAge;
     static bool enablePartialUpdates;
+    static int maxDamageRects;
+    static bool frameInfoTracing;
     static bool enableRenderEffectCache;
 
     // TODO: Move somewhere else?
@@ -333,8 +408,14 @@ public:
 
     static bool useHintManager;
     static int targetCpuTimePercentage;
+    static bool usePredictiveHints;
+    static int commonPoolThreadCount;
 
     static bool enableWebViewOverlays;
+    static bool enableVectorDrawableAtlas;
+    static int regionDecoderCacheKb;
+    static bool enableTonemapLut;
+    static bool dequeueAhead;
 
     static bool isHighEndGfx;
     static bool isLowRam;
@@ -380,6 +461,7 @@ public:
     static void setDrawingEnabled(bool enable);
 
     static bool initializeGlAlways();
+    static bool prewarmGpuContext();
 
 private:
     static StretchEffectBehavior stretchEffectBehavior;
@@ -55,8 +55,53 @@ namespace uirenderer {
 
 #define ARECT_ARGS(r) float((r).left), float((r).top), float((r).right), float((r).bottom)
 
+static sk_sp<SkSurface> wrapHardwareBuffer(GrDirectContext* context, AHardwareBuffer* buffer) {
+    sk_sp<SkColorSpace> colorSpace = DataSpaceToColorSpace(
+            static_cast<android_dataspace>(AHardwareBuffer_getDataSpace(buffer)));
+    if (!colorSpace) {
+        colorSpace = SkColorSpace::MakeSRGB();
+    }
+    sk_sp<SkSurface> surface = SkSurfaces::WrapAndroidHardwareBuffer(
+            context, buffer, kTopLeft_GrSurfaceOrigin, colorSpace, nullptr);
+    if (!surface) {
+        ALOGW("Unable to render into the provided hardware buffer");
+    }
+    return surface;
+}
+
 void Readback::copySurfaceInto(ANativeWindow* window, const std::shared_ptr<CopyRequest>& request) {
     ATRACE_CALL();
+    SkBitmap bitmap;
+    SkSurface* tmpSurface = nullptr;
+    CopyResult result = drawLastQueuedBuffer(window, request->srcRect, [&](int width, int height) {
+        bitmap = request->getDestinationBitmap(width, height);
+        tmpSurface = acquireIntermediateSurface(bitmap.info());
+        return tmpSurface;
+    });
+    if (result == CopyResult::Success && !readIntermediate(tmpSurface, &bitmap)) {
+        result = CopyResult::UnknownError;
+    }
+    return request->onCopyFinished(result);
+}
+
+void Readback::copySurfaceInto(ANativeWindow* window,
+                               const std::shared_ptr<HardwareBufferCopyRequest>& request) {
+    ATRACE_CALL();
+    sk_sp<SkSurface> dstSurface;
+    CopyResult result = drawLastQueuedBuffer(window, request->srcRect, [&](int, int) {
+        dstSurface = wrapHardwareBuffer(mRenderThread.getGrContext(),
+                                        request->getDestinationBuffer());
+        return dstSurface.get();
+    });
+    if (result != CopyResult::Success) {
+        return request->onCopyFinished(result, base::unique_fd());
+    }
+    return request->onCopyFinished(result, flushWithFence(dstSurface.get()));
+}
+
+CopyResult Readback::drawLastQueuedBuffer(
+        ANativeWindow* window, const Rect& requestSrcRect,
+        const std::function<SkSurface*(int, int)>& getDestination) {
     // Setup the source
     AHardwareBuffer* rawSourceBuffer;
     int rawSourceFence;
@@ -68,25 +113,25 @@ void Readback::copySurfaceInto(ANativeWindow* window, const std::shared_ptr<Copy
     // Really this shouldn't ever happen, but better safe than sorry.
     if (err == UNKNOWN_TRANSACTION) {
         ALOGW("Readback failed to ANativeWindow_getLastQueuedBuffer2 - who are we talking to?");
-        return request->onCopyFinished(CopyResult::SourceInvalid);
+        return CopyResult::SourceInvalid;
     }
     ALOGV("Using new path, cropRect=" RECT_STRING ", transform=%x", ARECT_ARGS(cropRect),
           windowTransform);
 
     if (err != NO_ERROR) {
         ALOGW("Failed to get last queued buffer, error = %d", err);
-        return request->onCopyFinished(CopyResult::SourceInvalid);
+        return CopyResult::SourceInvalid;
     }
     if (rawSourceBuffer == nullptr) {
         ALOGW("Surface doesn't have any previously queued frames, nothing to readback from");
-        return request->onCopyFinished(CopyResult::SourceEmpty);
+        return CopyResult::SourceEmpty;
     }
     UniqueAHardwareBuffer sourceBuffer{rawSourceBuffer};
     AHardwareBuffer_Desc description;
     AHardwareBuffer_describe(sourceBuffer.get(), &description);
     if (description.usage & AHARDWAREBUFFER_USAGE_PROTECTED_CONTENT) {
         ALOGW("Surface is protected, unable to copy from it");
-        return request->onCopyFinished(CopyResult::SourceInvalid);
+        return CopyResult::SourceInvalid;
     }
 
     {
@@ -95,7 +140,7 @@ void Readback::copySurfaceInto(ANativeWindow* window, const std::shared_ptr<Copy
         if (sourceFence != -1 && sync_wait(sourceFence.get(), syncWaitTimeoutMs) != NO_ERROR) {
             ALOGE("Timeout (%dms) exceeded waiting for buffer fence, abandoning readback attempt",
                   syncWaitTimeoutMs);
-            return request->onCopyFinished(CopyResult::Timeout);
+            return CopyResult::Timeout;
         }
     }
 
@@ -115,12 +160,12 @@ void Readback::copySurfaceInto(ANativeWindow* window, const std::shared_ptr<Copy
                                                                  kPremul_SkAlphaType, colorSpace);
 
     if (!image.get()) {
-        return request->onCopyFinished(CopyResult::UnknownError);
+        return CopyResult::UnknownError;
     }
 
     sk_sp<GrDirectContext> grContext = mRenderThread.requireGrContext();
 
-    SkRect srcRect = request->srcRect.toSkRect();
+    SkRect srcRect = requestSrcRect.toSkRect();
 
     SkRect imageSrcRect = SkRect::MakeIWH(description.width, description.height);
     SkISize imageWH = SkISize::Make(description.width, description.height);
@@ -168,28 +213,15 @@ void Readback::copySurfaceInto(ANativeWindow* window, const std::shared_ptr<Copy
         ALOGV("intersecting " RECT_STRING " with " RECT_STRING, SK_RECT_ARGS(srcRect),
               SK_RECT_ARGS(textureRect));
         if (!srcRect.intersect(textureRect)) {
-            return request->onCopyFinished(CopyResult::UnknownError);
+            return CopyResult::UnknownError;
         }
     }
 
-    SkBitmap skBitmap = request->getDestinationBitmap(srcRect.width(), srcRect.height());
-    SkBitmap* bitmap = &skBitmap;
-    sk_sp<SkSurface> tmpSurface =
-            SkSurfaces::RenderTarget(mRenderThread.getGrContext(), skgpu::Budgeted::kYes,
-                                     bitmap->info(), 0, kTopLeft_GrSurfaceOrigin, nullptr);
-
-    // if we can't generate a GPU surface that matches the destination bitmap (e.g. 565) then we
-    // attempt to do the intermediate rendering step in 8888
-    if (!tmpSurface.get()) {
-        SkImageInfo tmpInfo = bitmap->info().makeColorType(SkColorType::kN32_SkColorType);
-        tmpSurface = SkSurfaces::RenderTarget(mRenderThread.getGrContext(),
-                                              skgpu::Budgeted::kYes,
-                                              tmpInfo, 0, kTopLeft_GrSurfaceOrigin, nullptr);
-        if (!tmpSurface.get()) {
-            ALOGW("Unable to generate GPU buffer in a format compatible with the provided bitmap");
-            return request->onCopyFinished(CopyResult::UnknownError);
-        }
+    SkSurface* dstSurface = getDestination(srcRect.width(), srcRect.height());
+    if (!dstSurface) {
+        return CopyResult::UnknownError;
     }
+    const SkRect dstRect = SkRect::MakeIWH(dstSurface->width(), dstSurface->height());
 
     /*
      * The grand ordering of events.
@@ -203,7 +235,7 @@ void Readback::copySurfaceInto(ANativeWindow* window, const std::shared_ptr<Copy
      * as per GLConsumer::computeTransformMatrix
      *
      * Third we apply the user's supplied cropping & scale to the output by doing a RectToRect
-     * matrix transform from srcRect to {0,0, bitmapWidth, bitmapHeight}
+     * matrix transform from srcRect to {0,0, dstWidth, dstHeight}
      *
      * Finally we're done messing with this bloody thing for hopefully the last time.
      *
@@ -229,15 +261,13 @@ void Readback::copySurfaceInto(ANativeWindow* window, const std::shared_ptr<Copy
 
     SkSamplingOptions sampling(SkFilterMode::kNearest);
     ALOGV("Mapping from " RECT_STRING " to " RECT_STRING, SK_RECT_ARGS(srcRect),
-          SK_RECT_ARGS(SkRect::MakeWH(bitmap->width(), bitmap->height())));
-    m.postConcat(SkMatrix::MakeRectToRect(srcRect,
-                                          SkRect::MakeWH(bitmap->width(), bitmap->height()),
-                                          SkMatrix::kFill_ScaleToFit));
-    if (srcRect.width() != bitmap->width() || srcRect.height() != bitmap->height()) {
+          SK_RECT_ARGS(dstRect));
+    m.postConcat(SkMatrix::MakeRectToRect(srcRect, dstRect, SkMatrix::kFill_ScaleToFit));
+    if (srcRect.width() != dstRect.width() || srcRect.height() != dstRect.height()) {
         sampling = SkSamplingOptions(SkFilterMode::kLinear);
     }
 
-    SkCanvas* canvas = tmpSurface->getCanvas();
+    SkCanvas* canvas = dstSurface->getCanvas();
     canvas->save();
     canvas->concat(m);
     SkPaint paint;
@@ -253,22 +283,7 @@ void Readback::copySurfaceInto(ANativeWindow* window, const std::shared_ptr<Copy
     canvas->drawImageRect(image, imageSrcRect, imageDstRect, sampling, &paint, constraint);
     canvas->restore();
 
-    if (!tmpSurface->readPixels(*bitmap, 0, 0)) {
-        // if we fail to readback from the GPU directly (e.g. 565) then we attempt to read into
-        // 8888 and then convert that into the destination format before giving up.
-        SkBitmap tmpBitmap;
-        SkImageInfo tmpInfo = bitmap->info().makeColorType(SkColorType::kN32_SkColorType);
-        if (bitmap->info().colorType() == SkColorType::kN32_SkColorType ||
-            !tmpBitmap.tryAllocPixels(tmpInfo) || !tmpSurface->readPixels(tmpBitmap, 0, 0) ||
-            !tmpBitmap.readPixels(bitmap->info(), bitmap->getPixels(), bitmap->rowBytes(), 0, 0)) {
-            ALOGW("Unable to convert content into the provided bitmap");
-            return request->onCopyFinished(CopyResult::UnknownError);
-        }
-    }
-
-    bitmap->notifyPixelsChanged();
-
-    return request->onCopyFinished(CopyResult::Success);
+    return CopyResult::Success;
 }
 
 CopyResult Readback::copyHWBitmapInto(Bitmap* hwBitmap, SkBitmap* bitmap) {
@@ -278,6 +293,35 @@ CopyResult Readback::copyHWBitmapInto(Bitmap* hwBitmap, SkBitmap* bitmap) {
     return copyImageInto(hwBitmap->makeImage(), srcRect, bitmap);
 }
 
+CopyResult Readback::copyHWBitmapInto(Bitmap* hwBitmap, AHardwareBuffer* buffer,
+                                      base::unique_fd* outFence) {
+    ATRACE_CALL();
+    LOG_ALWAYS_FATAL_IF(!hwBitmap->isHardware());
+
+    sk_sp<SkImage> image = hwBitmap->makeImage();
+    if (!image.get()) {
+        return CopyResult::UnknownError;
+    }
+    sk_sp<GrDirectContext> grContext = mRenderThread.requireGrContext();
+    sk_sp<SkSurface> dstSurface = wrapHardwareBuffer(grContext.get(), buffer);
+    if (!dstSurface.get()) {
+        return CopyResult::DestinationInvalid;
+    }
+
+    Layer layer(mRenderThread.renderState(), nullptr, 255, SkBlendMode::kSrc);
+    layer.setSize(image->width(), image->height());
+    layer.setImage(image);
+    const SkRect srcRect = SkRect::MakeIWH(image->width(), image->height());
+    const SkRect dstRect = SkRect::MakeIWH(dstSurface->width(), dstSurface->height());
+    if (!skiapipeline::LayerDrawable::DrawLayer(grContext.get(), dstSurface->getCanvas(), &layer,
+                                                &srcRect, &dstRect, false)) {
+        ALOGW("Unable to draw content from GPU into the provided hardware buffer");
+        return CopyResult::UnknownError;
+    }
+    *outFence = flushWithFence(dstSurface.get());
+    return CopyResult::Success;
+}
+
 CopyResult Readback::copyLayerInto(DeferredLayerUpdater* deferredLayer, SkBitmap* bitmap) {
     ATRACE_CALL();
     if (!mRenderThread.getGrContext()) {
@@ -350,23 +394,9 @@ bool Readback::copyLayerInto(Layer* layer, const SkRect* srcRect, const SkRect*
      * a scaling issue (b/62262733) that was encountered when sampling from an EGLImage into a
      * software buffer.
      */
-    sk_sp<SkSurface> tmpSurface = SkSurfaces::RenderTarget(mRenderThread.getGrContext(),
-                                                           skgpu::Budgeted::kYes,
-                                                           bitmap->info(),
-                                                           0,
-                                                           kTopLeft_GrSurfaceOrigin, nullptr);
-
-    // if we can't generate a GPU surface that matches the destination bitmap (e.g. 565) then we
-    // attempt to do the intermediate rendering step in 8888
-    if (!tmpSurface.get()) {
-        SkImageInfo tmpInfo = bitmap->info().makeColorType(SkColorType::kN32_SkColorType);
-        tmpSurface = SkSurfaces::RenderTarget(mRenderThread.getGrContext(),
-                                              skgpu::Budgeted::kYes,
-                                              tmpInfo, 0, kTopLeft_GrSurfaceOrigin, nullptr);
-        if (!tmpSurface.get()) {
-            ALOGW("Unable to generate GPU buffer in a format compatible with the provided bitmap");
-            return false;
-        }
+    SkSurface* tmpSurface = acquireIntermediateSurface(bitmap->info());
+    if (!tmpSurface) {
+        return false;
     }
 
     if (!skiapipeline::LayerDrawable::DrawLayer(mRenderThread.getGrContext(),
@@ -376,16 +406,42 @@ bool Readback::copyLayerInto(Layer* layer, const SkRect* srcRect, const SkRect*
         return false;
     }
 
-    if (!tmpSurface->readPixels(*bitmap, 0, 0)) {
+    return readIntermediate(tmpSurface, bitmap);
+}
+
+SkSurface* Readback::acquireIntermediateSurface(const SkImageInfo& info) {
+    GrDirectContext* grContext = mRenderThread.getGrContext();
+    if (mIntermediateSurface && mIntermediateSurface->recordingContext() == grContext &&
+        mIntermediateInfo == info) {
+        return mIntermediateSurface.get();
+    }
+    mIntermediateSurface = SkSurfaces::RenderTarget(grContext, skgpu::Budgeted::kYes, info, 0,
+                                                    kTopLeft_GrSurfaceOrigin, nullptr);
+
+    // if we can't generate a GPU surface that matches the destination bitmap (e.g. 565) then we
+    // attempt to do the intermediate rendering step in 8888
+    if (!mIntermediateSurface.get()) {
+        SkImageInfo tmpInfo = info.makeColorType(SkColorType::kN32_SkColorType);
+        mIntermediateSurface = SkSurfaces::RenderTarget(grContext, skgpu::Budgeted::kYes, tmpInfo,
+                                                        0, kTopLeft_GrSurfaceOrigin, nullptr);
+        if (!mIntermediateSurface.get()) {
+            ALOGW("Unable to generate GPU buffer in a format compatible with the provided bitmap");
+            return nullptr;
+        }
+    }
+    mIntermediateInfo = info;
+    return mIntermediateSurface.get();
+}
+
+bool Readback::readIntermediate(SkSurface* surface, SkBitmap* bitmap) {
+    if (!surface->readPixels(*bitmap, 0, 0)) {
         // if we fail to readback from the GPU directly (e.g. 565) then we attempt to read into
         // 8888 and then convert that into the destination format before giving up.
         SkBitmap tmpBitmap;
         SkImageInfo tmpInfo = bitmap->info().makeColorType(SkColorType::kN32_SkColorType);
         if (bitmap->info().colorType() == SkColorType::kN32_SkColorType ||
-                !tmpBitmap.tryAllocPixels(tmpInfo) ||
-                !tmpSurface->readPixels(tmpBitmap, 0, 0) ||
-                !tmpBitmap.readPixels(bitmap->info(), bitmap->getPixels(),
-                                      bitmap->rowBytes(), 0, 0)) {
+            !tmpBitmap.tryAllocPixels(tmpInfo) || !surface->readPixels(tmpBitmap, 0, 0) ||
+            !tmpBitmap.readPixels(bitmap->info(), bitmap->getPixels(), bitmap->rowBytes(), 0, 0)) {
             ALOGW("Unable to convert content into the provided bitmap");
             return false;
         }
@@ -395,5 +451,23 @@ bool Readback::copyLayerInto(Layer* layer, const SkRect* srcRect, const SkRect*
     return true;
 }
 
+base::unique_fd Readback::flushWithFence(SkSurface* surface) {
+    ATRACE_CALL();
+    GrDirectContext* grContext = mRenderThread.getGrContext();
+    skgpu::ganesh::FlushAndSubmit(surface);
+    int fence = -1;
+    if (Properties::getRenderPipelineType() == RenderPipelineType::SkiaGL) {
+        EGLSyncKHR sync = EGL_NO_SYNC_KHR;
+        mRenderThread.eglManager().createReleaseFence(false, &sync, &fence);
+    } else {
+        mRenderThread.vulkanManager().createReleaseFence(&fence, grContext);
+    }
+    if (fence == -1) {
+        // Without native fences the caller can't wait on the GPU, so finish the copy here
+        grContext->flushAndSubmit(GrSyncCpu::kYes);
+    }
+    return base::unique_fd(fence);
+}
+
 } /* namespace uirenderer */
 } /* namespace android */
@@ -16,7 +16,12 @@
 
 #pragma once
 
+#include <SkImageInfo.h>
 #include <SkRefCnt.h>
+#include <SkSurface.h>
+#include <android-base/unique_fd.h>
+
+#include <functional>
 
 #include "CopyRequest.h"
 #include "Matrix.h"
@@ -43,19 +48,51 @@ public:
      * Copies the surface's most recently queued buffer into the provided bitmap.
      */
     void copySurfaceInto(ANativeWindow* window, const std::shared_ptr<CopyRequest>& request);
+    /**
+     * Renders the surface's most recently queued buffer straight into the request's hardware
+     * buffer, without waiting for the GPU to finish.
+     */
+    void copySurfaceInto(ANativeWindow* window,
+                         const std::shared_ptr<HardwareBufferCopyRequest>& request);
 
     CopyResult copyHWBitmapInto(Bitmap* hwBitmap, SkBitmap* bitmap);
+    /**
+     * Renders the hardware bitmap into buffer. On success outFence is set to a fence that
+     * signals once the copy is done, or -1 if it is done already.
+     */
+    CopyResult copyHWBitmapInto(Bitmap* hwBitmap, AHardwareBuffer* buffer,
+                                base::unique_fd* outFence);
     CopyResult copyImageInto(const sk_sp<SkImage>& image, SkBitmap* bitmap);
 
     CopyResult copyLayerInto(DeferredLayerUpdater* layer, SkBitmap* bitmap);
 
+    // Drops the intermediate surface kept around for repeated copies to bitmaps
+    void releaseIntermediates() { mIntermediateSurface.reset(); }
+
 private:
+    // Draws the surface's most recently queued buffer, cropped to srcRect, into the surface
+    // returned by getDestination for the size of the cropped source
+    CopyResult drawLastQueuedBuffer(ANativeWindow* window, const Rect& srcRect,
+                                    const std::function<SkSurface*(int, int)>& getDestination);
+
+    // Returns a GPU surface for rendering copies to bitmaps with the given info. Copies of the
+    // same size and format reuse the last surface.
+    SkSurface* acquireIntermediateSurface(const SkImageInfo& info);
+
+    // Submits the work for surface and returns a fence that signals once it is done
+    base::unique_fd flushWithFence(SkSurface* surface);
+
+    static bool readIntermediate(SkSurface* surface, SkBitmap* bitmap);
+
     CopyResult copyImageInto(const sk_sp<SkImage>& image, const Rect& srcRect, SkBitmap* bitmap);
 
     bool copyLayerInto(Layer* layer, const SkRect* srcRect, const SkRect* dstRect,
                        SkBitmap* bitmap);
 
     renderthread::RenderThread& mRenderThread;
+
+    sk_sp<SkSurface> mIntermediateSurface;
+    SkImageInfo mIntermediateInfo;
 };
 
 }  // namespace uirenderer
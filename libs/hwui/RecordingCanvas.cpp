@@ -28,6 +28,7 @@
 #include <utility>
 
 #include "Mesh.h"
+#include "Properties.h"
 #include "SkAndroidFrameworkUtils.h"
 #include "SkBlendMode.h"
 #include "SkCanvas.h"
@@ -581,6 +582,28 @@ struct DrawMesh final : Op {
 
     void draw(SkCanvas* c, const SkMatrix&) const { c->drawMesh(mesh.getSkMesh(), blender, paint); }
 };
+struct DrawMeshInstanced final : Op {
+    static const auto kType = Type::DrawMeshInstanced;
+    DrawMeshInstanced(const Mesh& mesh, sk_sp<SkBlender> blender, const SkPaint& paint, int count,
+                      bool has_colors)
+            : mesh(mesh.takeSnapshot())
+            , blender(std::move(blender))
+            , paint(paint)
+            , count(count)
+            , has_colors(has_colors) {}
+
+    Mesh::Snapshot mesh;
+    sk_sp<SkBlender> blender;
+    SkPaint paint;
+    int count;
+    bool has_colors;
+
+    void draw(SkCanvas* c, const SkMatrix&) const {
+        auto transforms = pod<SkMatrix>(this, 0);
+        auto colors = has_colors ? pod<SkColor>(this, count * sizeof(SkMatrix)) : nullptr;
+        Mesh::drawInstances(c, mesh.getSkMesh(), blender, paint, transforms, colors, count);
+    }
+};
 struct DrawAtlas final : Op {
     static const auto kType = Type::DrawAtlas;
     DrawAtlas(const SkImage* atlas, int count, SkBlendMode mode, const SkSamplingOptions& sampling,
@@ -761,6 +784,10 @@ void* DisplayListData::push(size_t pod, Args&&... args) {
     LOG_FATAL_IF((fUsed + skip) > fReserved);
     auto op = (T*)(fBytes.get() + fUsed);
     fUsed += skip;
+    if (CC_UNLIKELY(Properties::skipUnchangedDisplayLists)) {
+        // Zero the padding so that identical recordings compare equal in contentEquals().
+        memset(op, 0, skip);
+    }
     new (op) T{std::forward<Args>(args)...};
     op->type = (uint32_t)T::kType;
     op->skip = skip;
@@ -930,6 +957,17 @@ void DisplayListData::drawMesh(const Mesh& mesh, const sk_sp<SkBlender>& blender
                                const SkPaint& paint) {
     this->push<DrawMesh>(0, mesh, blender, paint);
 }
+void DisplayListData::drawMeshInstanced(const Mesh& mesh, const sk_sp<SkBlender>& blender,
+                                        const SkPaint& paint, const SkMatrix transforms[],
+                                        const SkColor colors[], int count) {
+    size_t bytes = count * sizeof(SkMatrix);
+    if (colors) {
+        bytes += count * sizeof(SkColor);
+    }
+    void* pod = this->push<DrawMeshInstanced>(bytes, mesh, blender, paint, count,
+                                              colors != nullptr);
+    copy_v(pod, transforms, count, colors, colors ? count : 0);
+}
 void DisplayListData::drawAtlas(const SkImage* atlas, const SkRSXform xforms[], const SkRect texs[],
                                 const SkColor colors[], int count, SkBlendMode xfermode,
                                 const SkSamplingOptions& sampling, const SkRect* cull,
@@ -985,6 +1023,11 @@ DisplayListData::~DisplayListData() {
     this->reset();
 }
 
+bool DisplayListData::contentEquals(const DisplayListData& other) const {
+    return fUsed == other.fUsed && mHasText == other.mHasText && mHasFill == other.mHasFill &&
+           memcmp(fBytes.get(), other.fBytes.get(), fUsed) == 0;
+}
+
 void DisplayListData::reset() {
     this->map(dtor_fns);
 
@@ -992,6 +1035,17 @@ void DisplayListData::reset() {
     fUsed = 0;
 }
 
+size_t DisplayListData::shrinkToFit() {
+    if (fUsed >= fReserved) {
+        return 0;
+    }
+    // Ops are relocated with realloc() when the list grows as well, so they may move here too.
+    const size_t reclaimed = fReserved - fUsed;
+    fReserved = fUsed;
+    fBytes.realloc(fReserved);
+    return reclaimed;
+}
+
 template <class T>
 using has_paint_helper = decltype(std::declval<T>().paint);
 
@@ -1050,6 +1104,21 @@ constexpr color_transform_fn colorTransformForOp<DrawTextBlob>() {
     };
 }
 
+template <>
+constexpr color_transform_fn colorTransformForOp<DrawMeshInstanced>() {
+    return [](const void* opRaw, ColorTransform transform) {
+        const DrawMeshInstanced* op = reinterpret_cast<const DrawMeshInstanced*>(opRaw);
+        transformPaint(transform, const_cast<SkPaint*>(&op->paint));
+        if (op->has_colors) {
+            SkColor* colors =
+                    const_cast<SkColor*>(pod<SkColor>(op, op->count * sizeof(SkMatrix)));
+            for (int i = 0; i < op->count; i++) {
+                colors[i] = transformColor(transform, colors[i]);
+            }
+        }
+    };
+}
+
 template <>
 constexpr color_transform_fn colorTransformForOp<DrawRippleDrawable>() {
     return [](const void* opRaw, ColorTransform transform) {
@@ -1278,6 +1347,11 @@ void RecordingCanvas::onDrawMesh(const SkMesh& mesh, sk_sp<SkBlender> blender,
 void RecordingCanvas::drawMesh(const Mesh& mesh, sk_sp<SkBlender> blender, const SkPaint& paint) {
     fDL->drawMesh(mesh, blender, paint);
 }
+void RecordingCanvas::drawMeshInstanced(const Mesh& mesh, sk_sp<SkBlender> blender,
+                                        const SkPaint& paint, const SkMatrix transforms[],
+                                        const SkColor colors[], int count) {
+    fDL->drawMeshInstanced(mesh, blender, paint, transforms, colors, count);
+}
 void RecordingCanvas::onDrawAtlas2(const SkImage* atlas, const SkRSXform xforms[],
                                    const SkRect texs[], const SkColor colors[], int count,
                                    SkBlendMode bmode, const SkSamplingOptions& sampling,
@@ -114,6 +114,13 @@ public:
     size_t usedSize() const { return fUsed; }
     size_t allocatedSize() const { return fReserved; }
 
+    // Shrinks the op storage to the size in use, and returns the number of bytes freed.
+    size_t shrinkToFit();
+
+    // Returns true if both lists recorded the same op stream. Ops are compared byte for byte,
+    // so referenced objects only match if they are the same instance.
+    bool contentEquals(const DisplayListData& other) const;
+
 private:
     friend class RecordingCanvas;
 
@@ -147,6 +154,8 @@ private:
 
     void drawMesh(const SkMesh&, const sk_sp<SkBlender>&, const SkPaint&);
     void drawMesh(const Mesh&, const sk_sp<SkBlender>&, const SkPaint&);
+    void drawMeshInstanced(const Mesh&, const sk_sp<SkBlender>&, const SkPaint&,
+                           const SkMatrix[], const SkColor[], int);
 
     void drawAnnotation(const SkRect&, const char*, SkData*);
     void drawDrawable(SkDrawable*, const SkMatrix*);
@@ -252,6 +261,8 @@ public:
     void onDrawShadowRec(const SkPath&, const SkDrawShadowRec&) override;
 
     void drawMesh(const Mesh& mesh, sk_sp<SkBlender> blender, const SkPaint& paint);
+    void drawMeshInstanced(const Mesh& mesh, sk_sp<SkBlender> blender, const SkPaint& paint,
+                           const SkMatrix transforms[], const SkColor colors[], int count);
     void drawVectorDrawable(VectorDrawableRoot* tree);
     void drawWebView(skiapipeline::FunctorDrawable*);
 
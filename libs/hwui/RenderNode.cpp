@@ -55,6 +55,9 @@ private:
     TreeInfo* mTreeInfo;
 };
 
+// Display lists that have not been re-recorded for this many frames are compacted.
+static constexpr uint32_t kCompactDisplayListAfterFrames = 120;
+
 static int64_t generateId() {
     static std::atomic<int64_t> sNextId{1};
     return sNextId++;
@@ -287,6 +290,9 @@ void RenderNode::prepareTreeImpl(TreeObserver& observer, TreeInfo& info, bool fu
     prepareLayer(info, animatorDirtyMask);
     if (info.mode == TreeInfo::MODE_FULL) {
         pushStagingDisplayListChanges(observer, info);
+        if (++mFramesSinceDisplayListSync == kCompactDisplayListAfterFrames) {
+            compactDisplayLists(info);
+        }
     }
 
     // always damageSelf when filtering backdrop content, or else the BackdropFilterDrawable will
@@ -424,7 +430,23 @@ std::optional<RenderNode::SnapshotResult> RenderNode::updateSnapshotIfRequired(
     return mSnapshotResult;
 }
 
+void RenderNode::compactDisplayLists(TreeInfo& info) {
+    // The UI thread is blocked during a full sync, so the available list can be touched here.
+    size_t reclaimed = 0;
+    if (auto* skiaDl = mDisplayList.asSkiaDl()) {
+        reclaimed += skiaDl->compact();
+    }
+    if (mAvailableDisplayList) {
+        reclaimed += mAvailableDisplayList->compact();
+    }
+    if (reclaimed > 0) {
+        ATRACE_FORMAT("Compacted display list of %s (%zu bytes)", getName(), reclaimed);
+        info.canvasContext.onDisplayListCompacted(reclaimed);
+    }
+}
+
 void RenderNode::syncDisplayList(TreeObserver& observer, TreeInfo* info) {
+    mFramesSinceDisplayListSync = 0;
     // Make sure we inc first so that we don't fluctuate between 0 and 1,
     // which would thrash the layer cache
     if (mStagingDisplayList) {
@@ -506,11 +528,19 @@ void RenderNode::handleForceDark(android::uirenderer::TreeInfo *info) {
 void RenderNode::pushStagingDisplayListChanges(TreeObserver& observer, TreeInfo& info) {
     if (mNeedsDisplayListSync) {
         mNeedsDisplayListSync = false;
+        if (CC_UNLIKELY(Properties::skipUnchangedDisplayLists) &&
+            mStagingDisplayList.hasSameContent(mDisplayList)) {
+            // Keep the current list, along with anything it has uploaded, and add no damage.
+            ATRACE_NAME("skipUnchangedDisplayList");
+            mStagingDisplayList.clear(this);
+            return;
+        }
         // Damage with the old display list first then the new one to catch any
         // changes in isRenderable or, in the future, bounds
         damageSelf(info);
         syncDisplayList(observer, &info);
         damageSelf(info);
+        info.out.syncedDisplayLists++;
     }
 }
 
@@ -241,6 +241,7 @@ private:
     void prepareTreeImpl(TreeObserver& observer, TreeInfo& info, bool functorsNeedLayer);
     void pushStagingPropertiesChanges(TreeInfo& info);
     void pushStagingDisplayListChanges(TreeObserver& observer, TreeInfo& info);
+    void compactDisplayLists(TreeInfo& info);
     void prepareLayer(TreeInfo& info, uint32_t dirtyMask);
     void pushLayerUpdate(TreeInfo& info);
     void pinShaderImages(TreeInfo& info);
@@ -265,6 +266,8 @@ private:
     // WARNING: Do not delete this directly, you must go through deleteDisplayList()!
     DisplayList mDisplayList;
     DisplayList mStagingDisplayList;
+    // Full tree traversals since mDisplayList was last synced, used to compact idle display lists
+    uint32_t mFramesSinceDisplayListSync = 0;
 
     int64_t mDamageGenerationId = 0;
 
@@ -331,6 +334,7 @@ public:
             if (!mSkiaLayer.get()) {
                 mSkiaLayer = std::make_unique<skiapipeline::SkiaLayer>();
             }
+            mSkiaLayer->recycleSurface();
             mSkiaLayer->layerSurface = std::move(layer);
             mSkiaLayer->inverseTransformInWindow.loadIdentity();
         } else {
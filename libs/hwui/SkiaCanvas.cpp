@@ -600,6 +600,20 @@ void SkiaCanvas::drawMesh(const Mesh& mesh, sk_sp<SkBlender> blender, const Pain
     mCanvas->drawMesh(mesh.takeSnapshot().getSkMesh(), blender, paint);
 }
 
+void SkiaCanvas::drawMeshInstanced(const Mesh& mesh, sk_sp<SkBlender> blender, const Paint& paint,
+                                   const SkMatrix transforms[], const SkColor colors[],
+                                   int count) {
+    if (count <= 0) return;
+    GrDirectContext* context = nullptr;
+    auto recordingContext = mCanvas->recordingContext();
+    if (recordingContext) {
+        context = recordingContext->asDirectContext();
+    }
+    mesh.refBufferData()->updateBuffers(context);
+    Mesh::drawInstances(mCanvas, mesh.takeSnapshot().getSkMesh(), blender, paint, transforms,
+                        colors, count);
+}
+
 // ----------------------------------------------------------------------------
 // Canvas draw operations: Bitmaps
 // ----------------------------------------------------------------------------
@@ -132,6 +132,9 @@ public:
     virtual void drawPath(const SkPath& path, const Paint& paint) override;
     virtual void drawVertices(const SkVertices*, SkBlendMode, const Paint& paint) override;
     virtual void drawMesh(const Mesh& mesh, sk_sp<SkBlender> blender, const Paint& paint) override;
+    virtual void drawMeshInstanced(const Mesh& mesh, sk_sp<SkBlender> blender, const Paint& paint,
+                                   const SkMatrix transforms[], const SkColor colors[],
+                                   int count) override;
 
     virtual void drawBitmap(Bitmap& bitmap, float left, float top, const Paint* paint) override;
     virtual void drawBitmap(Bitmap& bitmap, const SkMatrix& matrix, const Paint* paint) override;
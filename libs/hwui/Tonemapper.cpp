@@ -16,14 +16,21 @@
 
 #include "Tonemapper.h"
 
+#include <SkBitmap.h>
+#include <SkCanvas.h>
 #include <SkRuntimeEffect.h>
 #include <log/log.h>
+
+#include <mutex>
+#include <utility>
+#include <vector>
 // libshaders only exists on Android devices
 #ifdef __ANDROID__
 #include <renderthread/CanvasContext.h>
 #include <shaders/shaders.h>
 #endif
 
+#include "Properties.h"
 #include "utils/Color.h"
 
 namespace android::uirenderer {
@@ -38,14 +45,14 @@ public:
             : SkRuntimeEffectBuilder(std::move(effect)) {}
 
     sk_sp<SkColorFilter> makeColorFilter() {
-        return this->effect()->makeColorFilter(this->uniforms());
+        return this->effect()->makeColorFilter(this->uniforms(), this->children());
     }
 };
 
 static sk_sp<SkColorFilter> createLinearEffectColorFilter(const shaders::LinearEffect& linearEffect,
                                                           float maxDisplayLuminance,
                                                           float currentDisplayLuminanceNits,
-                                                          float maxLuminance) {
+                                                          float maxLuminance, float ratio) {
     auto shaderString = SkString(shaders::buildLinearEffectSkSL(linearEffect));
     auto [runtimeEffect, error] = SkRuntimeEffect::MakeForColorFilter(std::move(shaderString));
     if (!runtimeEffect) {
@@ -55,12 +62,8 @@ static sk_sp<SkColorFilter> createLinearEffectColorFilter(const shaders::LinearE
     ColorFilterRuntimeEffectBuilder effectBuilder(std::move(runtimeEffect));
 
     auto colorTransform = android::mat4();
-    const auto* context = renderthread::CanvasContext::getActiveContext();
-    if (context) {
-        const auto ratio = context->targetSdrHdrRatio();
-        if (ratio > 1.0f) {
-            colorTransform = android::mat4::scale(vec4(ratio, ratio, ratio, 1.f));
-        }
+    if (ratio > 1.0f) {
+        colorTransform = android::mat4::scale(vec4(ratio, ratio, ratio, 1.f));
     }
 
     const auto uniforms =
@@ -74,6 +77,154 @@ static sk_sp<SkColorFilter> createLinearEffectColorFilter(const shaders::LinearE
     return effectBuilder.makeColorFilter();
 }
 
+// Number of grid points along each axis of the baked tonemapping LUT.
+constexpr int kLutSize = 33;
+// Largest channel value the LUT covers. Inputs are shaped with x / (1 + x) before the lookup so
+// that SDR values keep half of the grid while extended range content still fits.
+constexpr float kLutMaxInput = 100.f;
+constexpr float kLutMaxShaped = kLutMaxInput / (1.f + kLutMaxInput);
+
+// The LUT is stored as kLutSize blue slices laid out side by side, each kLutSize x kLutSize with
+// red along x and green along y. Lookups interpolate bilinearly within the two nearest slices.
+static constexpr char gTonemapLutSKSL[] = R"SKSL(
+    uniform shader lut;
+    uniform float size;
+    uniform float inputScale;
+
+    half4 main(half4 color) {
+        float a = color.a;
+        if (a <= 0.0) {
+            return half4(0.0);
+        }
+        float3 x = max(float3(color.rgb) / a, float3(0.0));
+        float3 u = saturate(x / (1.0 + x) * inputScale) * (size - 1.0);
+        float b0 = floor(u.b);
+        float b1 = min(b0 + 1.0, size - 1.0);
+        float2 rg = u.rg + 0.5;
+        half3 c0 = lut.eval(float2(rg.x + b0 * size, rg.y)).rgb;
+        half3 c1 = lut.eval(float2(rg.x + b1 * size, rg.y)).rgb;
+        return half4(mix(c0, c1, half(u.b - b0)) * half(a), half(a));
+    }
+)SKSL";
+
+static sk_sp<SkRuntimeEffect> tonemapLutEffect() {
+    static const SkRuntimeEffect* effect = []() -> SkRuntimeEffect* {
+        auto [runtimeEffect, error] = SkRuntimeEffect::MakeForColorFilter(SkString(gTonemapLutSKSL));
+        if (!runtimeEffect) {
+            LOG_ALWAYS_FATAL("Tonemap LUT construction error: %s", error.c_str());
+        }
+        return runtimeEffect.release();
+    }();
+    return sk_ref_sp(effect);
+}
+
+// Evaluates colorFilter over the LUT grid on the CPU and returns a color filter that replaces
+// its per-pixel math with two texture samples. Returns nullptr if the grid could not be drawn.
+static sk_sp<SkColorFilter> bakeTonemapLut(const sk_sp<SkColorFilter>& colorFilter) {
+    const int width = kLutSize * kLutSize;
+    const int height = kLutSize;
+
+    // Neither bitmap is tagged with a color space, so the filter sees the grid values unchanged.
+    SkBitmap grid;
+    if (!grid.tryAllocPixels(
+                SkImageInfo::Make(width, height, kRGBA_F32_SkColorType, kPremul_SkAlphaType))) {
+        return nullptr;
+    }
+    float values[kLutSize];
+    for (int i = 0; i < kLutSize; i++) {
+        const float shaped = i * kLutMaxShaped / (kLutSize - 1);
+        values[i] = shaped / (1.f - shaped);
+    }
+    for (int g = 0; g < kLutSize; g++) {
+        float* row = static_cast<float*>(grid.getAddr(0, g));
+        for (int b = 0; b < kLutSize; b++) {
+            for (int r = 0; r < kLutSize; r++) {
+                float* pixel = row + 4 * (b * kLutSize + r);
+                pixel[0] = values[r];
+                pixel[1] = values[g];
+                pixel[2] = values[b];
+                pixel[3] = 1.f;
+            }
+        }
+    }
+    grid.setImmutable();
+
+    SkBitmap lut;
+    if (!lut.tryAllocPixels(
+                SkImageInfo::Make(width, height, kRGBA_F16_SkColorType, kPremul_SkAlphaType))) {
+        return nullptr;
+    }
+    {
+        SkCanvas canvas(lut);
+        SkPaint paint;
+        paint.setBlendMode(SkBlendMode::kSrc);
+        paint.setColorFilter(colorFilter);
+        canvas.drawImage(grid.asImage(), 0, 0, SkSamplingOptions(), &paint);
+    }
+    lut.setImmutable();
+
+    ColorFilterRuntimeEffectBuilder builder(tonemapLutEffect());
+    builder.child("lut") = lut.asImage()->makeRawShader(SkTileMode::kClamp, SkTileMode::kClamp,
+                                                        SkSamplingOptions(SkFilterMode::kLinear));
+    builder.uniform("size") = static_cast<float>(kLutSize);
+    builder.uniform("inputScale") = 1.f / kLutMaxShaped;
+    return builder.makeColorFilter();
+}
+
+struct TonemapKey {
+    ui::Dataspace source;
+    ui::Dataspace destination;
+    bool undoPremultipliedAlpha;
+    float maxLuminance;
+    float ratio;
+
+    bool operator==(const TonemapKey& other) const {
+        return source == other.source && destination == other.destination &&
+               undoPremultipliedAlpha == other.undoPremultipliedAlpha &&
+               maxLuminance == other.maxLuminance && ratio == other.ratio;
+    }
+};
+
+// Remembers the tonemapping filters of the last few source, destination and headroom
+// combinations so that image draws no longer rebuild the SkSL and uniforms every frame. A
+// change in display headroom simply produces a new key and the oldest entry is dropped.
+class TonemapFilterCache {
+public:
+    static TonemapFilterCache& get() {
+        static TonemapFilterCache* sInstance = new TonemapFilterCache();
+        return *sInstance;
+    }
+
+    template <typename Factory>
+    sk_sp<SkColorFilter> findOrCreate(const TonemapKey& key, Factory&& factory) {
+        {
+            std::lock_guard lock(mLock);
+            for (auto it = mEntries.begin(); it != mEntries.end(); ++it) {
+                if (it->first == key) {
+                    auto entry = std::move(*it);
+                    mEntries.erase(it);
+                    mEntries.push_back(std::move(entry));
+                    return mEntries.back().second;
+                }
+            }
+        }
+        // Build outside the lock, a racing thread at worst builds the same filter twice.
+        sk_sp<SkColorFilter> filter = factory();
+        std::lock_guard lock(mLock);
+        if (mEntries.size() >= kMaxEntries) {
+            mEntries.erase(mEntries.begin());
+        }
+        mEntries.emplace_back(key, filter);
+        return filter;
+    }
+
+private:
+    static constexpr size_t kMaxEntries = 8;
+
+    std::mutex mLock;
+    std::vector<std::pair<TonemapKey, sk_sp<SkColorFilter>>> mEntries;
+};
+
 static ui::Dataspace extractTransfer(ui::Dataspace dataspace) {
     return static_cast<ui::Dataspace>(dataspace & HAL_DATASPACE_TRANSFER_MASK);
 }
@@ -110,8 +261,24 @@ void tonemapPaint(const SkImageInfo& source, const SkImageInfo& destination, flo
                 .type = shaders::LinearEffect::SkSLType::ColorFilter};
         constexpr float kMaxDisplayBrightnessNits = 1000.f;
         constexpr float kCurrentDisplayBrightnessNits = 500.f;
-        sk_sp<SkColorFilter> colorFilter = createLinearEffectColorFilter(
-                effect, kMaxDisplayBrightnessNits, kCurrentDisplayBrightnessNits, maxLuminanceNits);
+        float ratio = 1.f;
+        if (const auto* context = renderthread::CanvasContext::getActiveContext()) {
+            ratio = context->targetSdrHdrRatio();
+        }
+        const TonemapKey key{sourceDataspace, destinationDataspace, effect.undoPremultipliedAlpha,
+                             maxLuminanceNits, ratio};
+        sk_sp<SkColorFilter> colorFilter =
+                TonemapFilterCache::get().findOrCreate(key, [&]() -> sk_sp<SkColorFilter> {
+                    auto filter = createLinearEffectColorFilter(
+                            effect, kMaxDisplayBrightnessNits, kCurrentDisplayBrightnessNits,
+                            maxLuminanceNits, ratio);
+                    if (Properties::enableTonemapLut) {
+                        if (auto lutFilter = bakeTonemapLut(filter)) {
+                            return lutFilter;
+                        }
+                    }
+                    return filter;
+                });
 
         if (paint.getColorFilter()) {
             paint.setColorFilter(SkColorFilters::Compose(paint.refColorFilter(), colorFilter));
@@ -106,6 +106,9 @@ public:
 
     bool forceDrawFrame = false;
 
+    // The intended vsync time of the frame being prepared, 0 if unknown
+    nsecs_t frameVsyncTime = 0;
+
     struct Out {
         bool hasFunctors = false;
         // This is only updated if evaluateAnimations is true
@@ -131,6 +134,8 @@ public:
         // This info is passed to SurfaceFlinger to determine whether it should use vsyncIds
         // for refresh rate selection.
         bool solelyTextureViewUpdates = true;
+        // The number of RenderNodes that received a new display list during this prepare
+        int syncedDisplayLists = 0;
     } out;
 
     // This flag helps to disable projection for receiver nodes that do not have any backward
@@ -492,6 +492,49 @@ Bitmap& Tree::getBitmapUpdateIfDirty() {
     return *mCache.bitmap;
 }
 
+#ifdef __ANDROID__ // Layoutlib does not support hardware acceleration
+Tree::~Tree() {
+    if (mCache.atlas) {
+        mCache.atlas->releaseEntry(mCache.atlasKey);
+    }
+}
+
+void Tree::updateCache(const sp<skiapipeline::VectorDrawableAtlas>& atlas) {
+    if (mCache.atlas != atlas) {
+        if (mCache.atlas) {
+            mCache.atlas->releaseEntry(mCache.atlasKey);
+        }
+        mCache.atlas = atlas;
+        mCache.atlasKey = skiapipeline::VectorDrawableAtlas::kInvalidKey;
+    }
+    int scaledWidth = SkScalarCeilToInt(mProperties.getScaledWidth());
+    int scaledHeight = SkScalarCeilToInt(mProperties.getScaledHeight());
+    skiapipeline::VectorDrawableAtlas::Entry entry;
+    if (!atlas->acquireEntry(&mCache.atlasKey, scaledWidth, scaledHeight, &entry)) {
+        // Too large for the atlas or no room left, draw will use the bitmap cache instead
+        return;
+    }
+    if (!entry.needsRedraw && !mCache.dirty) {
+        return;
+    }
+
+    ATRACE_FORMAT("VectorDrawable atlas repaint %dx%d", scaledWidth, scaledHeight);
+    SkCanvas* canvas = atlas->getCanvas();
+    SkAutoCanvasRestore acr(canvas, true);
+    canvas->clipIRect(entry.rect.makeOutset(skiapipeline::VectorDrawableAtlas::kPadding,
+                                            skiapipeline::VectorDrawableAtlas::kPadding));
+    canvas->clear(SK_ColorTRANSPARENT);
+    canvas->clipIRect(entry.rect);
+    canvas->translate(entry.rect.x(), entry.rect.y());
+    canvas->scale(scaledWidth / mProperties.getViewportWidth(),
+                  scaledHeight / mProperties.getViewportHeight());
+    mRootNode->draw(canvas, false);
+    mCache.dirty = false;
+    // The bitmap cache no longer matches the VD, let it be redrawn if it is ever needed again
+    mCache.bitmap = nullptr;
+}
+#endif
+
 void Tree::draw(SkCanvas* canvas, const SkRect& bounds, const SkPaint& inPaint) {
     if (canvas->quickReject(bounds)) {
         // The RenderNode is on screen, but the AVD is not.
@@ -502,14 +545,27 @@ void Tree::draw(SkCanvas* canvas, const SkRect& bounds, const SkPaint& inPaint)
     SkPaint paint = inPaint;
     paint.setAlpha(mProperties.getRootAlpha() * 255);
 
-    sk_sp<SkImage> cachedBitmap = getBitmapUpdateIfDirty().makeImage();
-
-    // HWUI always draws VD with bilinear filtering.
-    auto sampling = SkSamplingOptions(SkFilterMode::kLinear);
     int scaledWidth = SkScalarCeilToInt(mProperties.getScaledWidth());
     int scaledHeight = SkScalarCeilToInt(mProperties.getScaledHeight());
-    canvas->drawImageRect(cachedBitmap, SkRect::MakeWH(scaledWidth, scaledHeight), bounds,
-                          sampling, &paint, SkCanvas::kFast_SrcRectConstraint);
+    sk_sp<SkImage> cachedImage;
+    SkRect src = SkRect::MakeWH(scaledWidth, scaledHeight);
+#ifdef __ANDROID__ // Layoutlib does not support hardware acceleration
+    SkIRect atlasRect;
+    if (canvas->recordingContext() && mCache.atlas && !mCache.dirty &&
+        mCache.atlas->getEntry(mCache.atlasKey, scaledWidth, scaledHeight, &atlasRect)) {
+        cachedImage = mCache.atlas->getImage();
+        src = SkRect::Make(atlasRect);
+    }
+#endif
+    if (!cachedImage) {
+        cachedImage = getBitmapUpdateIfDirty().makeImage();
+    }
+
+    // HWUI always draws VD with bilinear filtering. The padding around atlas entries keeps the
+    // fast constraint from sampling neighbouring caches.
+    auto sampling = SkSamplingOptions(SkFilterMode::kLinear);
+    canvas->drawImageRect(cachedImage, src, bounds, sampling, &paint,
+                          SkCanvas::kFast_SrcRectConstraint);
 }
 
 void Tree::updateBitmapCache(Bitmap& bitmap, bool useStagingData) {
@@ -21,6 +21,9 @@
 #include "hwui/Bitmap.h"
 #include "hwui/Canvas.h"
 #include "renderthread/CacheManager.h"
+#ifdef __ANDROID__ // Layoutlib does not support hardware acceleration
+#include "pipeline/skia/VectorDrawableAtlas.h"
+#endif
 
 #include <SkBitmap.h>
 #include <SkCanvas.h>
@@ -517,6 +520,12 @@ public:
     void drawStaging(Canvas* canvas);
 
     Bitmap& getBitmapUpdateIfDirty();
+#ifdef __ANDROID__ // Layoutlib does not support hardware acceleration
+    ~Tree();
+    // Rasterizes the cache into the atlas when it fits there and is out of date. This should
+    // always be called from RT, before the frame that draws the VD.
+    void updateCache(const sp<skiapipeline::VectorDrawableAtlas>& atlas);
+#endif
     void setAllowCaching(bool allowCaching) { mAllowCaching = allowCaching; }
     void syncProperties() {
         if (mStagingProperties.mNonAnimatablePropertiesDirty) {
@@ -658,6 +667,11 @@ private:
     class Cache {
     public:
         sk_sp<Bitmap> bitmap;  // used by HWUI pipeline and software
+#ifdef __ANDROID__ // Layoutlib does not support hardware acceleration
+        // used by the Skia GPU pipelines for small caches
+        sp<skiapipeline::VectorDrawableAtlas> atlas;
+        uint64_t atlasKey = skiapipeline::VectorDrawableAtlas::kInvalidKey;
+#endif
         bool dirty = true;
     };
 
@@ -220,7 +220,7 @@ public:
             internalSave(saveEntryForLayer());
         }
         if constexpr (T == CanvasOpType::ClipRect) {
-            internalClipRect(op.rect, op.op);
+            internalClipRect(op.rect, op.clipOp);
         }
         if constexpr (T == CanvasOpType::ClipPath) {
             internalClipPath(op.path, op.op);
@@ -17,6 +17,12 @@
 #include "CanvasOpBuffer.h"
 
 #include "CanvasOps.h"
+#include "DamageAccumulator.h"
+#include "Matrix.h"
+
+#include <concepts>
+#include <iterator>
+#include <string>
 
 namespace android::uirenderer {
 
@@ -31,27 +37,171 @@ void CanvasOpBuffer::updateChildren(std::function<void(RenderNode*)> updateFn) {
     }
 }
 
+static constexpr const char* kOpNames[] = {
+        "save",
+        "saveLayer",
+        "saveBehind",
+        "restore",
+        "beginZ",
+        "endZ",
+        "clipRect",
+        "clipPath",
+        "drawColor",
+        "drawRect",
+        "drawRects",
+        "drawRegion",
+        "drawRoundRect",
+        "drawRoundRects",
+        "drawRoundRectProperty",
+        "drawDoubleRoundRect",
+        "drawCircleProperty",
+        "drawRippleDrawable",
+        "drawCircle",
+        "drawOval",
+        "drawArc",
+        "drawPaint",
+        "drawPoint",
+        "drawPoints",
+        "drawPath",
+        "drawLine",
+        "drawLines",
+        "drawVertices",
+        "drawImage",
+        "drawImageRect",
+        "drawImageLattice",
+        "drawPicture",
+        "drawLayer",
+        "drawRenderNode",
+};
+static_assert(std::size(kOpNames) == static_cast<size_t>(CanvasOpType::COUNT),
+              "Missing name for a CanvasOpType");
+
+// Only plain solid fills can share a batch, anything that looks at the geometry of a single
+// draw (shaders, filters, strokes) keeps its own op
+static bool isBatchable(const SkPaint& paint) {
+    return paint.getStyle() == SkPaint::kFill_Style && paint.asBlendMode().has_value() &&
+           !paint.getShader() && !paint.getColorFilter() && !paint.getMaskFilter() &&
+           !paint.getPathEffect() && !paint.getImageFilter();
+}
+
+static bool hasSameBatchState(const SkPaint& a, const SkPaint& b) {
+    return a.isAntiAlias() == b.isAntiAlias() && a.isDither() == b.isDither() &&
+           a.asBlendMode() == b.asBlendMode();
+}
+
+template <CanvasOpType Batch, CanvasOpType Single, typename BufferT, typename MakeEntry>
+static bool fuseInto(BufferT& buffer, CanvasOpContainer<Single>& op, MakeEntry&& makeEntry) {
+    if (!isBatchable(op->paint)) return false;
+    if (auto batch = buffer.template last_as<Batch>()) {
+        if (batch->transform() != op.transform() || !hasSameBatchState((*batch)->paint, op->paint)) {
+            return false;
+        }
+        (*batch)->rects.push_back(makeEntry(op.op()));
+        return true;
+    }
+    auto previous = buffer.template last_as<Single>();
+    if (!previous || previous->transform() != op.transform() || !isBatchable((*previous)->paint) ||
+        !hasSameBatchState((*previous)->paint, op->paint)) {
+        return false;
+    }
+    CanvasOp<Batch> fused{.paint = (*previous)->paint};
+    fused.rects.reserve(4);
+    fused.rects.push_back(makeEntry(previous->op()));
+    fused.rects.push_back(makeEntry(op.op()));
+    buffer.template replace_last<Batch>(std::move(fused), op.transform());
+    return true;
+}
+
+bool CanvasOpBuffer::tryFuse(CanvasOpContainer<CanvasOpType::DrawRect>& op) {
+    return fuseInto<CanvasOpType::DrawRects>(
+            static_cast<SUPER&>(*this), op, [](const CanvasOp<CanvasOpType::DrawRect>& rect) {
+                return CanvasOp<CanvasOpType::DrawRects>::Entry{
+                        .rect = rect.rect,
+                        .color = rect.paint.getColor4f(),
+                };
+            });
+}
+
+bool CanvasOpBuffer::tryFuse(CanvasOpContainer<CanvasOpType::DrawRoundRect>& op) {
+    return fuseInto<CanvasOpType::DrawRoundRects>(
+            static_cast<SUPER&>(*this), op,
+            [](const CanvasOp<CanvasOpType::DrawRoundRect>& roundRect) {
+                return CanvasOp<CanvasOpType::DrawRoundRects>::Entry{
+                        .rect = roundRect.rect,
+                        .rx = roundRect.rx,
+                        .ry = roundRect.ry,
+                        .color = roundRect.paint.getColor4f(),
+                };
+            });
+}
+
 void CanvasOpBuffer::output(std::ostream& output, uint32_t level) const {
-    LOG_ALWAYS_FATAL("TODO");
+    const std::string indent((level + 1) * 2, ' ');
+    for_each([&]<CanvasOpType T>(const CanvasOpContainer<T>* op) {
+        output << indent << kOpNames[static_cast<int>(T)];
+        if constexpr (T == CanvasOpType::DrawRects || T == CanvasOpType::DrawRoundRects) {
+            output << " x" << (*op)->rects.size();
+        }
+        if constexpr (T == CanvasOpType::DrawRenderNode) {
+            (*op)->renderNode->output(output, level + 1);
+        } else {
+            output << std::endl;
+        }
+    });
 }
 
 bool CanvasOpBuffer::prepareListAndChildren(
             TreeObserver& observer, TreeInfo& info, bool functorsNeedLayer,
             std::function<void(RenderNode*, TreeObserver&, TreeInfo&, bool)> childFn) {
-    LOG_ALWAYS_FATAL("TODO");
+    bool hasBackwardProjectedNodesHere = false;
+    bool hasBackwardProjectedNodesSubtree = false;
+
+    if (mHas.children) {
+        for (auto& child : filter<CanvasOpType::DrawRenderNode>()) {
+            RenderNode* childNode = child->renderNode.get();
+            Matrix4 mat4(child.transform());
+            info.damageAccumulator->pushTransform(&mat4);
+            info.hasBackwardProjectedNodes = false;
+            childFn(childNode, observer, info, functorsNeedLayer);
+            hasBackwardProjectedNodesHere |= childNode->properties().getProjectBackwards();
+            hasBackwardProjectedNodesSubtree |= info.hasBackwardProjectedNodes;
+            info.damageAccumulator->popTransform();
+        }
+    }
+
+    // Projection is resolved by the SkiaDisplayList that receives it, this buffer only reports
+    // what its subtree contains
+    info.hasBackwardProjectedNodes =
+            hasBackwardProjectedNodesSubtree || hasBackwardProjectedNodesHere;
+    // No animated images or vector drawables are recorded here, so nothing can self-damage
     return false;
 }
 
 void CanvasOpBuffer::syncContents(const WebViewSyncData& data) {
-    LOG_ALWAYS_FATAL("TODO");
+    // There is no functor op, so there are no WebViews to sync
 }
 
 void CanvasOpBuffer::onRemovedFromTree() {
-    LOG_ALWAYS_FATAL("TODO");
+    // There is no functor op, so there are no WebViews to detach
 }
 
 void CanvasOpBuffer::applyColorTransform(ColorTransform transform) {
-    LOG_ALWAYS_FATAL("TODO");
+    if (transform == ColorTransform::None) return;
+    for_each_mutable([&]<CanvasOpType T>(CanvasOpContainer<T>* op) {
+        if constexpr (requires { { op->op().paint } -> std::same_as<SkPaint&>; }) {
+            transformPaint(transform, &op->op().paint);
+        }
+        if constexpr (T == CanvasOpType::DrawRects || T == CanvasOpType::DrawRoundRects) {
+            // Invert is applied as a color filter on the shared paint above, every other
+            // transform rewrites the color itself, which a batch keeps per entry
+            if (transform != ColorTransform::Invert) {
+                for (auto& entry : op->op().rects) {
+                    entry.color = SkColor4f::FromColor(
+                            transformColor(transform, entry.color.toSkColor()));
+                }
+            }
+        }
+    });
 }
 
 }  // namespace android::uirenderer
@@ -68,6 +68,7 @@ public:
     // Expose select superclass methods publicly
     using SUPER::for_each;
     using SUPER::size;
+    using SUPER::for_each_mutable;
     using SUPER::resize;
 
     template <CanvasOpType T>
@@ -77,6 +78,11 @@ public:
 
     template <CanvasOpType T>
     void push_container(CanvasOpContainer<T>&& op) {
+        if constexpr (T == CanvasOpType::DrawRect || T == CanvasOpType::DrawRoundRect) {
+            // Runs of simple fills are the bulk of most lists, so fold them into a single
+            // batch op that is cheaper to store and to rasterize
+            if (tryFuse(op)) return;
+        }
         if constexpr (IsDrawOp(T)) {
             mHas.content = true;
         }
@@ -120,6 +126,11 @@ public:
     void output(std::ostream& output, uint32_t level) const;
 
 private:
+    // Appends op to a compatible batch at the end of the buffer, returning false if it has to
+    // be pushed on its own
+    bool tryFuse(CanvasOpContainer<CanvasOpType::DrawRect>& op);
+    bool tryFuse(CanvasOpContainer<CanvasOpType::DrawRoundRect>& op);
+
     struct Contains {
         bool content : 1 = false;
         bool children : 1 = false;
@@ -31,14 +31,24 @@ void rasterizeCanvasBuffer(const CanvasOpBuffer& source, SkCanvas* destination)
     // Push on beginning a RenderNode draw, pop on ending one
     std::vector<SkMatrix> globalMatrixStack;
     SkMatrix& currentGlobalTransform = globalMatrixStack.emplace_back(SkMatrix::I());
+    // Consecutive ops usually share a transform, and setMatrix isn't free, so only update the
+    // canvas when the recorded transform actually changes
+    const SkMatrix* lastTransform = nullptr;
 
     source.for_each([&]<CanvasOpType T>(const CanvasOpContainer<T> * op) {
         if constexpr (CanvasOpTraits::can_draw<CanvasOp<T>>) {
             // Generic OP
             // First apply the current transformation
-            destination->setMatrix(SkMatrix::Concat(currentGlobalTransform, op->transform()));
+            if (!lastTransform || *lastTransform != op->transform()) {
+                destination->setMatrix(SkMatrix::Concat(currentGlobalTransform, op->transform()));
+                lastTransform = &op->transform();
+            }
             // Now draw it
             (*op)->draw(destination);
+            if constexpr (T == CanvasOpType::Restore) {
+                // Restoring brings back the matrix of the matching save
+                lastTransform = nullptr;
+            }
             return;
         }
         LOG_ALWAYS_FATAL("TODO, unable to rasterize %d", static_cast<int>(T));
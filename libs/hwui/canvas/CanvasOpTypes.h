@@ -38,8 +38,12 @@ enum class CanvasOpType : int8_t {
     DRAW_OP_BEGIN,
     DrawColor = DRAW_OP_BEGIN,
     DrawRect,
+    // Run of DrawRect ops that only differ in rect and color, see CanvasOpBuffer
+    DrawRects,
     DrawRegion,
     DrawRoundRect,
+    // Run of DrawRoundRect ops that only differ in geometry and color
+    DrawRoundRects,
     DrawRoundRectProperty,
     DrawDoubleRoundRect,
     DrawCircleProperty,
@@ -42,6 +42,7 @@
 
 #include <experimental/type_traits>
 #include <utility>
+#include <vector>
 
 namespace android::uirenderer {
 
@@ -209,6 +210,25 @@ struct CanvasOp<CanvasOpType::DrawRect> {
     ASSERT_DRAWABLE()
 };
 
+template <>
+struct CanvasOp<CanvasOpType::DrawRects> {
+    struct Entry {
+        SkRect rect;
+        SkColor4f color;
+    };
+    std::vector<Entry> rects;
+    // Shared by every entry, except for the color
+    SkPaint paint;
+    void draw(SkCanvas* canvas) const {
+        SkPaint entryPaint = paint;
+        for (const auto& entry : rects) {
+            entryPaint.setColor(entry.color);
+            canvas->drawRect(entry.rect, entryPaint);
+        }
+    }
+    ASSERT_DRAWABLE()
+};
+
 template <>
 struct CanvasOp<CanvasOpType::DrawRegion> {
     SkRegion region;
@@ -229,6 +249,27 @@ struct CanvasOp<CanvasOpType::DrawRoundRect> {
     ASSERT_DRAWABLE()
 };
 
+template<>
+struct CanvasOp<CanvasOpType::DrawRoundRects> {
+    struct Entry {
+        SkRect rect;
+        SkScalar rx;
+        SkScalar ry;
+        SkColor4f color;
+    };
+    std::vector<Entry> rects;
+    // Shared by every entry, except for the color
+    SkPaint paint;
+    void draw(SkCanvas* canvas) const {
+        SkPaint entryPaint = paint;
+        for (const auto& entry : rects) {
+            entryPaint.setColor(entry.color);
+            canvas->drawRoundRect(entry.rect, entry.rx, entry.ry, entryPaint);
+        }
+    }
+    ASSERT_DRAWABLE()
+};
+
 template<>
 struct CanvasOp<CanvasOpType::DrawDoubleRoundRect> {
     SkRRect outer;
@@ -24,6 +24,8 @@
 #include <type_traits>
 #include <utility>
 
+#include <log/log.h>
+
 namespace android::uirenderer {
 
 template <typename T>
@@ -91,9 +93,15 @@ public:
 
     constexpr size_t remaining() const { return capacity() - size(); }
 
-    // TODO: Add less-copy'ing variants of this. emplace_back? deferred initialization?
     template <ItemTypes T>
     void push_container(ItemContainer<T>&& op) {
+        emplace_back<T>(std::move(op));
+    }
+
+    // Constructs a new item at the end of the buffer directly from args, avoiding the
+    // intermediate container that push_container needs
+    template <ItemTypes T, typename... Args>
+    ItemContainer<T>& emplace_back(Args&&... args) {
         static_assert(alignof(ItemContainer<T>) <= Alignment);
         static_assert(offsetof(ItemContainer<T>, header) == 0);
 
@@ -105,8 +113,30 @@ public:
         mBuffer->used += padded_size;
 
         void* allocateAt = reinterpret_cast<uint8_t*>(mBuffer) + mBuffer->endOffset;
-        auto temp = new (allocateAt) ItemContainer<T>{std::move(op)};
+        auto temp = new (allocateAt) ItemContainer<T>{std::forward<Args>(args)...};
         temp->header = {.type = T, .size = padded_size};
+        return *temp;
+    }
+
+    // Destroys the last item and constructs a new one of type T in its place. Only the last item
+    // can be replaced, as the offset of the item before it is not tracked. args must not refer to
+    // the item being replaced.
+    template <ItemTypes T, typename... Args>
+    ItemContainer<T>& replace_last(Args&&... args) {
+        ItemHeader* header = last();
+        LOG_ALWAYS_FATAL_IF(header == nullptr, "No item to replace");
+        destroy_item(header);
+        mBuffer->used = mBuffer->endOffset;
+        // emplace_back recomputes endOffset from used, which is the same offset again
+        return emplace_back<T>(std::forward<Args>(args)...);
+    }
+
+    // Returns the last item if it has type T, or nullptr otherwise
+    template <ItemTypes T>
+    ItemContainer<T>* last_as() {
+        ItemHeader* header = last();
+        if (header == nullptr || header->type != T) return nullptr;
+        return reinterpret_cast<ItemContainer<T>*>(header);
     }
 
     void resize(size_t newsize) {
@@ -135,7 +165,13 @@ public:
 
     template <typename F>
     void for_each(F&& f) const {
-        do_for_each(std::forward<F>(f), ItemTypesSequence{});
+        do_for_each<true>(std::forward<F>(f), ItemTypesSequence{});
+    }
+
+    // Like for_each, but hands out mutable items for in-place edits such as color transforms
+    template <typename F>
+    void for_each_mutable(F&& f) {
+        do_for_each<false>(std::forward<F>(f), ItemTypesSequence{});
     }
 
     void clear();
@@ -224,7 +260,7 @@ private:
         return reinterpret_cast<uint8_t*>(mBuffer) + mBuffer->used;
     }
 
-    template <typename F, std::size_t... I>
+    template <bool Const, typename F, std::size_t... I>
     void do_for_each(F&& f, std::index_sequence<I...>) const {
         // Validate we're not empty
         if (isEmpty()) return;
@@ -234,7 +270,8 @@ private:
         using F_PTR = decltype(&f);
         using THUNK = void (*)(F_PTR, void*);
         static constexpr auto jump = std::array<THUNK, sizeof...(I)>{[](F_PTR fp, void* t) {
-            (*fp)(reinterpret_cast<const ItemContainer<static_cast<ItemTypes>(I)>*>(t));
+            using Item = ItemContainer<static_cast<ItemTypes>(I)>;
+            (*fp)(reinterpret_cast<std::conditional_t<Const, const Item, Item>*>(t));
         }...};
 
         // Do the actual iteration of each item
@@ -250,6 +287,20 @@ private:
         }
     }
 
+    void destroy_item(ItemHeader* header) {
+        static constexpr auto destructors = destructor_table(ItemTypesSequence{});
+        destructors[static_cast<int>(header->type)](header);
+    }
+
+    template <std::size_t... I>
+    static constexpr auto destructor_table(std::index_sequence<I...>) {
+        using DTOR = void (*)(void*);
+        return std::array<DTOR, sizeof...(I)>{[](void* t) {
+            using Item = ItemContainer<static_cast<ItemTypes>(I)>;
+            reinterpret_cast<Item*>(t)->~Item();
+        }...};
+    }
+
     void destroy() {
         clear();
         resize(0);
@@ -175,6 +175,10 @@ private:
     SkRuntimeShaderBuilder mBuilder{mShader};
     SkGainmapInfo mGainmapInfo;
     std::mutex mUniformGuard;
+    // The uniforms of the last build() call. Every draw of the same gainmap at the same display
+    // headroom shares them instead of rewriting the builder.
+    float mLastTargetHdrSdrRatio = 0.f;
+    sk_sp<const SkData> mLastUniforms;
 
     void setupChildren(const sk_sp<const SkImage>& baseImage,
                        const sk_sp<const SkImage>& gainmapImage, SkTileMode tileModeX,
@@ -254,6 +258,9 @@ private:
             // This can happen if a BitmapShader is used on multiple canvas', such as a
             // software + hardware canvas, which is otherwise valid as SkShader is "immutable"
             std::lock_guard _lock(mUniformGuard);
+            if (mLastUniforms && targetHdrSdrRatio == mLastTargetHdrSdrRatio) {
+                return mLastUniforms;
+            }
             // Compute the weight parameter that will be used to blend between the images.
             float W = 0.f;
             if (targetHdrSdrRatio > mGainmapInfo.fDisplayRatioSdr) {
@@ -268,6 +275,8 @@ private:
             }
             mBuilder.uniform("W") = W;
             uniforms = mBuilder.uniforms();
+            mLastTargetHdrSdrRatio = targetHdrSdrRatio;
+            mLastUniforms = uniforms;
         }
         return uniforms;
     }
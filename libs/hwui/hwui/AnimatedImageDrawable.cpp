@@ -20,16 +20,34 @@
 #include <SkRefCnt.h>
 #include <gui/TraceUtils.h>
 
+#include <algorithm>
 #include <optional>
 
 #include "AnimatedImageThread.h"
+#include "MemoryPolicy.h"
 #include "pipeline/skia/SkiaUtils.h"
 
 namespace android {
 
+static int computeFramesAhead(size_t frameBytes) {
+    const auto& policy = uirenderer::loadMemoryPolicy();
+    int frames = std::clamp(policy.animatedImageFramesAhead, 1,
+                            AnimatedImageDrawable::kMaxFramesAhead);
+    if (frameBytes > 0) {
+        const size_t affordable = std::max<size_t>(1, policy.animatedImageDecodeAheadBytes /
+                                                              frameBytes);
+        frames = static_cast<int>(std::min<size_t>(frames, affordable));
+    }
+    return frames;
+}
+
 AnimatedImageDrawable::AnimatedImageDrawable(sk_sp<SkAnimatedImage> animatedImage, size_t bytesUsed,
-                                             SkEncodedImageFormat format)
-        : mSkAnimatedImage(std::move(animatedImage)), mBytesUsed(bytesUsed), mFormat(format) {
+                                             size_t frameBytes, SkEncodedImageFormat format)
+        : mSkAnimatedImage(std::move(animatedImage))
+        , mBytesUsed(bytesUsed)
+        , mFrameBytes(frameBytes)
+        , mFormat(format)
+        , mFramesAhead(computeFramesAhead(frameBytes)) {
     mTimeToShowNextSnapshot = ms2ns(currentFrameDuration());
     setStagingBounds(mSkAnimatedImage->getBounds());
 }
@@ -59,16 +77,33 @@ bool AnimatedImageDrawable::isRunning() {
     return mRunning;
 }
 
-bool AnimatedImageDrawable::nextSnapshotReady() const {
-    return mNextSnapshot.valid() &&
-           mNextSnapshot.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+void AnimatedImageDrawable::scheduleDecodeLocked() {
+    if (mDecodeScheduled) return;
+    if (!mResetPending &&
+        (mDecodedFinalFrame || mDecodedFrames.size() >= mFramesAhead)) {
+        return;
+    }
+    mDecodeScheduled = true;
+    uirenderer::AnimatedImageThread::getInstance().decodeAhead(sk_ref_sp(this));
+}
+
+void AnimatedImageDrawable::clearDecodedFramesLocked() {
+    while (mDecodedFrames.hasWork()) {
+        mDecodedFrames.pop();
+    }
+    mDecodedFinalFrame = false;
+    mDecodeGeneration++;
 }
 
 // Only called on the RenderThread while UI thread is locked.
-bool AnimatedImageDrawable::isDirty(nsecs_t* outDelay) {
+bool AnimatedImageDrawable::isDirty(nsecs_t* outDelay, nsecs_t frameTime) {
     *outDelay = 0;
-    const nsecs_t currentTime = systemTime(SYSTEM_TIME_MONOTONIC);
     const nsecs_t lastWallTime = mLastWallTime;
+    // Keep time with the frame's vsync when it is known, so that frame switches line up with
+    // the display rather than with whenever this frame got prepared. Never go backwards, as
+    // drawStaging keeps time with the wall clock.
+    const nsecs_t currentTime = frameTime > 0 ? std::max(frameTime, lastWallTime)
+                                              : systemTime(SYSTEM_TIME_MONOTONIC);
 
     mLastWallTime = currentTime;
     if (!mRunning) {
@@ -78,7 +113,7 @@ bool AnimatedImageDrawable::isDirty(nsecs_t* outDelay) {
     std::unique_lock lock{mSwapLock};
     mCurrentTime += currentTime - lastWallTime;
 
-    if (!mNextSnapshot.valid()) {
+    if (!mDecodedFrames.hasWork() && !mDecodeScheduled) {
         // Need to trigger onDraw in order to start decoding the next frame.
         *outDelay = mTimeToShowNextSnapshot - mCurrentTime;
         return true;
@@ -86,12 +121,11 @@ bool AnimatedImageDrawable::isDirty(nsecs_t* outDelay) {
 
     if (mTimeToShowNextSnapshot > mCurrentTime) {
         *outDelay = mTimeToShowNextSnapshot - mCurrentTime;
-    } else if (nextSnapshotReady()) {
-        // We have not yet updated mTimeToShowNextSnapshot. Read frame duration
-        // directly from mSkAnimatedImage.
-        lock.unlock();
-        std::unique_lock imageLock{mImageLock};
-        *outDelay = ms2ns(currentFrameDuration());
+    } else if (mDecodedFrames.hasWork()) {
+        // We have not yet updated mTimeToShowNextSnapshot. The next frame's
+        // duration is the time until the one after it.
+        const int durationMS = mDecodedFrames.front().mDurationMS;
+        *outDelay = durationMS == SkAnimatedImage::kFinished ? 0 : ms2ns(durationMS);
         return true;
     } else {
         // The next snapshot has not yet been decoded, but we've already passed
@@ -103,7 +137,30 @@ bool AnimatedImageDrawable::isDirty(nsecs_t* outDelay) {
     return false;
 }
 
-// Only called on the AnimatedImageThread.
+// Only called on a CommonPool worker, through AnimatedImageThread.
+void AnimatedImageDrawable::decodeAhead() {
+    ATRACE_FORMAT("AnimatedImageDrawable::decodeAhead %dx%d",
+                  (int) mSkAnimatedImage->getBounds().width(),
+                  (int) mSkAnimatedImage->getBounds().height());
+    std::unique_lock lock{mSwapLock};
+    while (mResetPending || (!mDecodedFinalFrame && mDecodedFrames.size() < mFramesAhead)) {
+        const uint32_t generation = mDecodeGeneration;
+        const bool rewind = mResetPending;
+        mResetPending = false;
+        lock.unlock();
+        Snapshot snap = rewind ? reset() : decodeNextFrame();
+        lock.lock();
+        if (generation != mDecodeGeneration) {
+            // The animation restarted while decoding, so this frame belongs to the
+            // previous run. The restart also set mResetPending.
+            continue;
+        }
+        mDecodedFinalFrame = snap.mDurationMS == SkAnimatedImage::kFinished;
+        mDecodedFrames.push(std::move(snap));
+    }
+    mDecodeScheduled = false;
+}
+
 AnimatedImageDrawable::Snapshot AnimatedImageDrawable::decodeNextFrame() {
     Snapshot snap;
     {
@@ -115,7 +172,6 @@ AnimatedImageDrawable::Snapshot AnimatedImageDrawable::decodeNextFrame() {
     return snap;
 }
 
-// Only called on the AnimatedImageThread.
 AnimatedImageDrawable::Snapshot AnimatedImageDrawable::reset() {
     Snapshot snap;
     {
@@ -181,17 +237,19 @@ void AnimatedImageDrawable::onDraw(SkCanvas* canvas) {
             return;
         }
     } else if (starting) {
-        // The image has animated, and now is being reset. Queue up the first
-        // frame, but keep showing the current frame until the first is ready.
-        auto& thread = uirenderer::AnimatedImageThread::getInstance();
-        mNextSnapshot = thread.reset(sk_ref_sp(this));
+        // The image has animated, and now is being reset. Drop the frames decoded
+        // for the previous run and queue up the first frame, but keep showing the
+        // current frame until the first is ready.
+        std::unique_lock lock{mSwapLock};
+        clearDecodedFramesLocked();
+        mResetPending = true;
     }
 
     bool finalFrame = false;
-    if (mRunning && nextSnapshotReady()) {
-        std::unique_lock lock{mSwapLock};
+    std::unique_lock swapLock{mSwapLock};
+    if (mRunning && mDecodedFrames.hasWork()) {
         if (mCurrentTime >= mTimeToShowNextSnapshot) {
-            mSnapshot = mNextSnapshot.get();
+            mSnapshot = mDecodedFrames.pop();
             const nsecs_t timeToShowCurrentSnap = mTimeToShowNextSnapshot;
             if (mSnapshot.mDurationMS == SkAnimatedImage::kFinished) {
                 finalFrame = true;
@@ -209,10 +267,11 @@ void AnimatedImageDrawable::onDraw(SkCanvas* canvas) {
         }
     }
 
-    if (mRunning && !mNextSnapshot.valid()) {
-        auto& thread = uirenderer::AnimatedImageThread::getInstance();
-        mNextSnapshot = thread.decodeNextFrame(sk_ref_sp(this));
+    if (mRunning) {
+        // Top up the decoded frames, including the slot freed above
+        scheduleDecodeLocked();
     }
+    swapLock.unlock();
 
     if (!drawDirectly) {
         // No other thread will modify mCurrentSnap so this should be safe to
@@ -27,9 +27,10 @@
 #include <utils/RefBase.h>
 #include <utils/Timers.h>
 
-#include <future>
 #include <mutex>
 
+#include "thread/CommonPool.h"
+
 namespace android {
 
 class OnAnimationEndListener {
@@ -47,9 +48,10 @@ public:
 class AnimatedImageDrawable : public SkDrawable {
 public:
     // bytesUsed includes the approximate sizes of the SkAnimatedImage and the SkPictures in the
-    // Snapshots.
+    // current and next Snapshots. frameBytes is the size of a single decoded frame, used to
+    // bound how many frames are decoded ahead.
     AnimatedImageDrawable(sk_sp<SkAnimatedImage> animatedImage, size_t bytesUsed,
-                          SkEncodedImageFormat format);
+                          size_t frameBytes, SkEncodedImageFormat format);
 
     /**
      * This updates the internal time and returns true if the image needs
@@ -59,8 +61,10 @@ public:
      *
      * @param outDelay Nanoseconds in the future when the following frame
      *      will need to be drawn. 0 if not running.
+     * @param frameTime The vsync time of the frame being prepared, so that
+     *      frames switch in step with the display. 0 to use the current time.
      */
-    bool isDirty(nsecs_t* outDelay);
+    bool isDirty(nsecs_t* outDelay, nsecs_t frameTime = 0);
 
     int getStagingAlpha() const { return mStagingProperties.mAlpha; }
     void setStagingAlpha(int alpha) { mStagingProperties.mAlpha = alpha; }
@@ -104,11 +108,16 @@ public:
         PREVENT_COPY_AND_ASSIGN(Snapshot);
     };
 
-    // These are only called on AnimatedImageThread.
-    Snapshot decodeNextFrame();
-    Snapshot reset();
+    // Only called by AnimatedImageThread. Decodes frames until mDecodedFrames is full or the
+    // animation has finished.
+    void decodeAhead();
+
+    size_t byteSize() const {
+        // bytesUsed already covers one frame decoded ahead
+        return sizeof(*this) + mBytesUsed + (mFramesAhead - 1) * mFrameBytes;
+    }
 
-    size_t byteSize() const { return sizeof(*this) + mBytesUsed; }
+    static constexpr int kMaxFramesAhead = 8;
 
 protected:
     void onDraw(SkCanvas* canvas) override;
@@ -116,7 +125,10 @@ protected:
 private:
     sk_sp<SkAnimatedImage> mSkAnimatedImage;
     const size_t mBytesUsed;
+    const size_t mFrameBytes;
     const SkEncodedImageFormat mFormat;
+    // How many frames may be decoded ahead, from MemoryPolicy and the frame size
+    const int mFramesAhead;
 
     bool mRunning = false;
     bool mStarting = false;
@@ -124,11 +136,27 @@ private:
     // A snapshot of the current frame to draw.
     Snapshot mSnapshot;
 
-    std::future<Snapshot> mNextSnapshot;
-
-    bool nextSnapshotReady() const;
+    // Frames decoded ahead of mSnapshot, oldest first. Guarded by mSwapLock, as are the decode
+    // flags below.
+    uirenderer::ArrayQueue<Snapshot, kMaxFramesAhead + 1> mDecodedFrames;
+    // True while decodeAhead is queued or running
+    bool mDecodeScheduled = false;
+    // Set when the animation restarts, so the decoder rewinds before the next frame
+    bool mResetPending = false;
+    // True once the decoder produced the kFinished frame of the current run
+    bool mDecodedFinalFrame = false;
+    // Bumped on every restart, so that frames from the previous run are dropped
+    uint32_t mDecodeGeneration = 0;
+
+    // Queues decodeAhead if there is room for more frames. mSwapLock must be held.
+    void scheduleDecodeLocked();
+    void clearDecodedFramesLocked();
+
+    // Only called from decodeAhead.
+    Snapshot decodeNextFrame();
+    Snapshot reset();
 
-    // When to switch from mSnapshot to mNextSnapshot.
+    // When to switch from mSnapshot to the first of mDecodedFrames.
     nsecs_t mTimeToShowNextSnapshot = 0;
 
     // The current time for the drawable itself.
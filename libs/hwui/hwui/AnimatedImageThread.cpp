@@ -16,36 +16,46 @@
 
 #include "AnimatedImageThread.h"
 
-#ifdef __ANDROID__
-#include <sys/resource.h>
-#endif
+#include <utils/Trace.h>
+
+#include <algorithm>
+
+#include "thread/CommonPool.h"
 
 namespace android {
 namespace uirenderer {
 
 AnimatedImageThread& AnimatedImageThread::getInstance() {
-    static sp<AnimatedImageThread> sInstance = []() {
-        sp<AnimatedImageThread> thread = sp<AnimatedImageThread>::make();
-        thread->start("AnimatedImageThread");
-        return thread;
-    }();
+    // Never destroyed, as queued pool tasks may still refer to it at exit
+    static AnimatedImageThread* sInstance = new AnimatedImageThread();
     return *sInstance;
 }
 
-AnimatedImageThread::AnimatedImageThread() {
-#ifdef __ANDROID__
-    setpriority(PRIO_PROCESS, 0, PRIORITY_NORMAL + PRIORITY_MORE_FAVORABLE);
-#endif
-}
+AnimatedImageThread::AnimatedImageThread()
+        : mMaxActiveWorkers(std::max(1, CommonPool::getThreadCount() - 1)) {}
 
-std::future<AnimatedImageDrawable::Snapshot> AnimatedImageThread::decodeNextFrame(
-        const sk_sp<AnimatedImageDrawable>& drawable) {
-    return queue().async([drawable]() { return drawable->decodeNextFrame(); });
+void AnimatedImageThread::decodeAhead(const sk_sp<AnimatedImageDrawable>& drawable) {
+    std::unique_lock lock{mLock};
+    mPending.push_back(drawable);
+    if (mActiveWorkers < mMaxActiveWorkers) {
+        mActiveWorkers++;
+        CommonPool::post([this] { runDecodes(); });
+    }
 }
 
-std::future<AnimatedImageDrawable::Snapshot> AnimatedImageThread::reset(
-        const sk_sp<AnimatedImageDrawable>& drawable) {
-    return queue().async([drawable]() { return drawable->reset(); });
+void AnimatedImageThread::runDecodes() {
+    ATRACE_NAME("AnimatedImageDecode");
+    std::unique_lock lock{mLock};
+    while (!mPending.empty()) {
+        sk_sp<AnimatedImageDrawable> drawable = std::move(mPending.front());
+        mPending.pop_front();
+        lock.unlock();
+        drawable->decodeAhead();
+        // Drop the reference before retaking the lock, it may be the last one
+        drawable.reset();
+        lock.lock();
+    }
+    mActiveWorkers--;
 }
 
 }  // namespace uirenderer
@@ -18,27 +18,41 @@
 #define ANIMATEDIMAGETHREAD_H_
 
 #include "AnimatedImageDrawable.h"
-#include "thread/ThreadBase.h"
+#include "utils/Macros.h"
 
 #include <SkRefCnt.h>
 
+#include <deque>
+#include <mutex>
+
 namespace android {
 
 namespace uirenderer {
 
-class AnimatedImageThread : private ThreadBase {
+/**
+ * Runs AnimatedImageDrawable decodes on CommonPool. Each drawable decodes on one worker at a
+ * time, since SkAnimatedImage can only advance frame by frame, but separate drawables decode in
+ * parallel. One worker is always left to frame-critical work.
+ */
+class AnimatedImageThread {
     PREVENT_COPY_AND_ASSIGN(AnimatedImageThread);
 
 public:
     static AnimatedImageThread& getInstance();
 
-    std::future<AnimatedImageDrawable::Snapshot> decodeNextFrame(
-            const sk_sp<AnimatedImageDrawable>&);
-    std::future<AnimatedImageDrawable::Snapshot> reset(const sk_sp<AnimatedImageDrawable>&);
+    // Queues a call to drawable->decodeAhead(). The drawable must not already be queued.
+    void decodeAhead(const sk_sp<AnimatedImageDrawable>& drawable);
 
 private:
-    friend sp<AnimatedImageThread>;
     AnimatedImageThread();
+
+    // Runs on a CommonPool worker until no drawable is waiting
+    void runDecodes();
+
+    std::mutex mLock;
+    std::deque<sk_sp<AnimatedImageDrawable>> mPending;
+    int mActiveWorkers = 0;
+    const int mMaxActiveWorkers;
 };
 
 }  // namespace uirenderer
@@ -15,6 +15,7 @@
  */
 #include "Bitmap.h"
 
+#include "BitmapPool.h"
 #include "HardwareBitmapUploader.h"
 #include "Properties.h"
 #ifdef __ANDROID__  // Layoutlib does not support render thread
@@ -175,6 +176,21 @@ sk_sp<Bitmap> Bitmap::allocateHeapBitmap(size_t size, const SkImageInfo& info, s
     return sk_sp<Bitmap>(new Bitmap(addr, size, info, rowBytes));
 }
 
+sk_sp<Bitmap> Bitmap::allocatePooledHeapBitmap(SkBitmap* bitmap) {
+    return allocateBitmap(bitmap, &Bitmap::allocatePooledHeapBitmap);
+}
+
+sk_sp<Bitmap> Bitmap::allocatePooledHeapBitmap(size_t size, const SkImageInfo& info,
+                                               size_t rowBytes) {
+    void* addr = BitmapPool::get().acquire(size);
+    if (!addr) {
+        return nullptr;
+    }
+    sk_sp<Bitmap> bitmap(new Bitmap(addr, size, info, rowBytes));
+    bitmap->mPixelStorage.heap.pooled = true;
+    return bitmap;
+}
+
 sk_sp<Bitmap> Bitmap::createFrom(const SkImageInfo& info, SkPixelRef& pixelRef) {
     return sk_sp<Bitmap>(new Bitmap(pixelRef, info));
 }
@@ -264,6 +280,7 @@ Bitmap::Bitmap(void* address, size_t size, const SkImageInfo& info, size_t rowBy
         , mPixelStorageType(PixelStorageType::Heap) {
     mPixelStorage.heap.address = address;
     mPixelStorage.heap.size = size;
+    mPixelStorage.heap.pooled = false;
     traceBitmapCreate();
 }
 
@@ -297,6 +314,8 @@ Bitmap::Bitmap(AHardwareBuffer* buffer, const SkImageInfo& info, size_t rowBytes
     mPixelStorage.hardware.buffer = buffer;
     mPixelStorage.hardware.size = AHardwareBuffer_getAllocationSize(buffer);
     AHardwareBuffer_acquire(buffer);
+    mMemoryTag.set(uirenderer::MemoryAttribution::sharedHardwareBitmaps(),
+                   uirenderer::AttributedMemoryType::HardwareBitmap, mPixelStorage.hardware.size);
     setImmutable();  // HW bitmaps are always immutable
     mImage = SkImages::DeferredFromAHardwareBuffer(buffer, mInfo.alphaType(),
                                                    mInfo.refColorSpace());
@@ -317,6 +336,10 @@ Bitmap::~Bitmap() {
             close(mPixelStorage.ashmem.fd);
             break;
         case PixelStorageType::Heap:
+            if (mPixelStorage.heap.pooled) {
+                BitmapPool::get().release(mPixelStorage.heap.address, mPixelStorage.heap.size);
+                break;
+            }
             free(mPixelStorage.heap.address);
 #ifdef __ANDROID__
             mallopt(M_PURGE, 0);
@@ -30,6 +30,8 @@
 
 #ifdef __ANDROID__ // Layoutlib does not support hardware acceleration
 #include <android/hardware_buffer.h>
+
+#include "MemoryAttribution.h"
 #endif
 
 class SkWStream;
@@ -78,6 +80,9 @@ public:
     static sk_sp<Bitmap> allocateHeapBitmap(SkBitmap* bitmap);
     static sk_sp<Bitmap> allocateHeapBitmap(const SkImageInfo& info);
     static sk_sp<Bitmap> allocateHeapBitmap(size_t size, const SkImageInfo& i, size_t rowBytes);
+    // Like allocateHeapBitmap, but the pixel memory is borrowed from BitmapPool and goes back
+    // to it when the Bitmap is destroyed
+    static sk_sp<Bitmap> allocatePooledHeapBitmap(SkBitmap* bitmap);
 
     /* The createFrom factories construct a new Bitmap object by wrapping the already allocated
      * memory that is provided as an input param.
@@ -178,6 +183,8 @@ public:
                        int32_t quality, SkWStream* stream);
 private:
     static sk_sp<Bitmap> allocateAshmemBitmap(size_t size, const SkImageInfo& i, size_t rowBytes);
+    static sk_sp<Bitmap> allocatePooledHeapBitmap(size_t size, const SkImageInfo& i,
+                                                  size_t rowBytes);
 
     Bitmap(void* address, size_t allocSize, const SkImageInfo& info, size_t rowBytes);
     Bitmap(SkPixelRef& pixelRef, const SkImageInfo& info);
@@ -218,6 +225,7 @@ private:
         struct {
             void* address;
             size_t size;
+            bool pooled;
         } heap;
 #ifdef __ANDROID__ // Layoutlib does not support hardware acceleration
         struct {
@@ -228,6 +236,10 @@ private:
     } mPixelStorage;
 
     sk_sp<SkImage> mImage;  // Cache is used only for HW Bitmaps with Skia pipeline.
+#ifdef __ANDROID__ // Layoutlib does not support hardware acceleration
+    // Charges the buffer of a HW Bitmap to MemoryAttribution::sharedHardwareBitmaps()
+    uirenderer::MemoryTag mMemoryTag;
+#endif
 
     // for tracing total number and memory usage of bitmaps
     static std::mutex mLock;
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BitmapPool.h"
+
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+
+#include "Properties.h"
+
+namespace android {
+
+BitmapPool& BitmapPool::get() {
+    static BitmapPool sInstance;
+    return sInstance;
+}
+
+void* BitmapPool::acquire(size_t size) {
+    void* address = nullptr;
+    {
+        std::lock_guard lock(mLock);
+        for (auto it = mBuffers.rbegin(); it != mBuffers.rend(); it++) {
+            if (it->size == size) {
+                address = it->address;
+                mPooledBytes -= size;
+                mBuffers.erase(std::next(it).base());
+                break;
+            }
+        }
+        if (address) {
+            mHits++;
+        } else {
+            mMisses++;
+        }
+    }
+    if (!address) {
+        return calloc(size, 1);
+    }
+    // Decoders rely on the zero initialization a fresh allocation would have
+    memset(address, 0, size);
+    return address;
+}
+
+void BitmapPool::release(void* address, size_t size) {
+    const size_t maxBytes =
+            uirenderer::Properties::isLowRam ? kMaxPooledBytesLowRam : kMaxPooledBytes;
+    if (size > maxBytes) {
+        free(address);
+        return;
+    }
+    std::vector<void*> evicted;
+    {
+        std::lock_guard lock(mLock);
+        mBuffers.push_back({address, size});
+        mPooledBytes += size;
+        size_t evictCount = 0;
+        while (mPooledBytes > maxBytes || mBuffers.size() - evictCount > kMaxPooledBuffers) {
+            mPooledBytes -= mBuffers[evictCount].size;
+            evicted.push_back(mBuffers[evictCount].address);
+            evictCount++;
+        }
+        mBuffers.erase(mBuffers.begin(), mBuffers.begin() + evictCount);
+        mEvictions += evictCount;
+    }
+    for (void* buffer : evicted) {
+        free(buffer);
+    }
+}
+
+void BitmapPool::trim() {
+    std::vector<Buffer> buffers;
+    {
+        std::lock_guard lock(mLock);
+        buffers.swap(mBuffers);
+        mPooledBytes = 0;
+    }
+    for (const Buffer& buffer : buffers) {
+        free(buffer.address);
+    }
+}
+
+size_t BitmapPool::pooledBytes() {
+    std::lock_guard lock(mLock);
+    return mPooledBytes;
+}
+
+void BitmapPool::dump(String8& log) {
+    std::lock_guard lock(mLock);
+    log.appendFormat("Bitmap pool: %zu buffers, %.2f KB (reused %" PRIu64 ", allocated %" PRIu64
+                     ", evicted %" PRIu64 ")\n",
+                     mBuffers.size(), mPooledBytes / 1024.0f, mHits, mMisses, mEvictions);
+}
+
+}  // namespace android
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <utils/String8.h>
+
+#include <mutex>
+#include <vector>
+
+#include "utils/Macros.h"
+
+namespace android {
+
+/**
+ * A process-wide pool of the pixel memory of destroyed heap Bitmaps.
+ *
+ * Decoding a feed of similarly sized images allocates and frees a large buffer per image, which
+ * shows up as page faults and madvise() calls while scrolling. Bitmaps allocated through
+ * Bitmap::allocatePooledHeapBitmap hand their memory back here when they are destroyed, and the
+ * next pooled allocation of the same size reuses it. Buffers are matched by byte size only, as
+ * the layout of raw pixel memory does not depend on the color type or color space.
+ */
+class BitmapPool {
+    PREVENT_COPY_AND_ASSIGN(BitmapPool);
+
+public:
+    // The most memory the pool keeps while no bitmap uses it
+    static constexpr size_t kMaxPooledBytes = 32 * 1024 * 1024;
+    static constexpr size_t kMaxPooledBytesLowRam = 8 * 1024 * 1024;
+    static constexpr size_t kMaxPooledBuffers = 16;
+
+    static BitmapPool& get();
+
+    // Returns zeroed memory of the given size, or nullptr if out of memory
+    void* acquire(size_t size);
+    // Takes back memory returned by acquire, freeing it if the pool is full
+    void release(void* address, size_t size);
+    // Frees every pooled buffer
+    void trim();
+
+    void dump(String8& log);
+
+    size_t pooledBytes();
+
+private:
+    BitmapPool() = default;
+
+    struct Buffer {
+        void* address;
+        size_t size;
+    };
+
+    std::mutex mLock;
+    // Ordered from least to most recently released
+    std::vector<Buffer> mBuffers;
+    size_t mPooledBytes = 0;
+    uint64_t mHits = 0;
+    uint64_t mMisses = 0;
+    uint64_t mEvictions = 0;
+};
+
+}  // namespace android
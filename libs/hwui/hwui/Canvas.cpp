@@ -97,8 +97,10 @@ void Canvas::drawText(const uint16_t* text, int textSize, int start, int count,
         paint.getSkFont().setHinting(SkFontHinting::kNone);
     }
 
-    minikin::Layout layout = MinikinUtils::doLayout(&paint, bidiFlags, typeface, text, textSize,
-                                                    start, count, contextStart, contextCount, mt);
+    std::shared_ptr<const minikin::Layout> sharedLayout =
+            MinikinUtils::doCachedLayout(&paint, bidiFlags, typeface, text, textSize, start, count,
+                                         contextStart, contextCount, mt);
+    const minikin::Layout& layout = *sharedLayout;
 
     x += MinikinUtils::xOffsetForTextAlign(&paint, layout);
 
@@ -204,11 +206,12 @@ void Canvas::drawTextOnPath(const uint16_t* text, int count, minikin::Bidi bidiF
         paint.getSkFont().setHinting(SkFontHinting::kNone);
     }
 
-    minikin::Layout layout =
-            MinikinUtils::doLayout(&paint, bidiFlags, typeface, text, count,  // text buffer
-                                   0, count,                                  // draw range
-                                   0, count,                                  // context range
-                                   nullptr);
+    std::shared_ptr<const minikin::Layout> sharedLayout =
+            MinikinUtils::doCachedLayout(&paint, bidiFlags, typeface, text, count,  // text buffer
+                                         0, count,                                  // draw range
+                                         0, count,                                  // context range
+                                         nullptr);
+    const minikin::Layout& layout = *sharedLayout;
     hOffset += MinikinUtils::hOffsetForTextAlign(&paint, layout, path);
 
     // Set align to left for drawing, as we don't want individual
@@ -228,6 +228,10 @@ public:
     virtual void drawPath(const SkPath& path, const Paint& paint) = 0;
     virtual void drawVertices(const SkVertices*, SkBlendMode, const Paint& paint) = 0;
     virtual void drawMesh(const Mesh& mesh, sk_sp<SkBlender>, const Paint& paint) = 0;
+    // Draws count copies of mesh in a single operation, see Mesh::drawInstances.
+    virtual void drawMeshInstanced(const Mesh& mesh, sk_sp<SkBlender>, const Paint& paint,
+                                   const SkMatrix transforms[], const SkColor colors[],
+                                   int count) = 0;
 
     // Bitmap-based
     virtual void drawBitmap(Bitmap& bitmap, float left, float top, const Paint* paint) = 0;
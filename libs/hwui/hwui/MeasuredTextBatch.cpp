@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MeasuredTextBatch.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+#include "thread/CommonPool.h"
+
+namespace android {
+
+using uirenderer::CommonPool;
+
+struct MeasuredTextBatch::State {
+    std::vector<Paragraph> paragraphs;
+
+    std::mutex lock;
+    std::condition_variable measured;
+    // Index of the next paragraph to start measuring
+    size_t nextToMeasure = 0;
+    // Paragraphs being measured right now
+    size_t inFlight = 0;
+    bool cancelled = false;
+    std::vector<std::unique_ptr<minikin::MeasuredText>> results;
+    std::vector<bool> done;
+    // Measured paragraphs not yet returned by next(), oldest first
+    std::deque<size_t> finished;
+    size_t returned = 0;
+
+    // Measures the next pending paragraph. Returns false if none is left.
+    bool measureOne() {
+        size_t index;
+        {
+            std::lock_guard _lock(lock);
+            if (cancelled || nextToMeasure == paragraphs.size()) return false;
+            index = nextToMeasure++;
+            inFlight++;
+        }
+        Paragraph& paragraph = paragraphs[index];
+        std::unique_ptr<minikin::MeasuredText> result = paragraph.builder->build(
+                minikin::U16StringPiece(paragraph.text.data(), paragraph.text.size()),
+                paragraph.computeHyphenation, paragraph.computeLayout, paragraph.computeBounds,
+                paragraph.fastHyphenationMode, paragraph.hint);
+        paragraph.builder.reset();
+        {
+            std::lock_guard _lock(lock);
+            results[index] = std::move(result);
+            done[index] = true;
+            finished.push_back(index);
+            inFlight--;
+        }
+        measured.notify_all();
+        return true;
+    }
+
+    // Blocks until ready() holds, measuring pending paragraphs meanwhile. ready() is called
+    // with the lock held.
+    template <typename F>
+    void waitFor(std::unique_lock<std::mutex>& ulock, F&& ready) {
+        while (!ready()) {
+            ulock.unlock();
+            const bool measuredOne = measureOne();
+            ulock.lock();
+            if (!measuredOne) {
+                // Everything left is in flight on other threads.
+                measured.wait(ulock, ready);
+            }
+        }
+    }
+};
+
+MeasuredTextBatch::MeasuredTextBatch(std::vector<Paragraph>&& paragraphs)
+        : mState(std::make_shared<State>()) {
+    mState->paragraphs = std::move(paragraphs);
+    const size_t count = mState->paragraphs.size();
+    mState->results.resize(count);
+    mState->done.resize(count, false);
+    if (CommonPool::isPoolThread()) {
+        // Waiting on the other workers from here may deadlock, so the caller measures
+        // everything from next() or take().
+        return;
+    }
+    const size_t workers = std::min(count, static_cast<size_t>(CommonPool::getThreadCount()));
+    for (size_t i = 0; i < workers; i++) {
+        // Measurement is not tied to a frame, so it queues behind frame-critical work.
+        CommonPool::post([state = mState] {
+            while (state->measureOne()) {
+            }
+        });
+    }
+}
+
+MeasuredTextBatch::~MeasuredTextBatch() {
+    std::unique_lock ulock(mState->lock);
+    mState->cancelled = true;
+    mState->measured.wait(ulock, [state = mState.get()] { return state->inFlight == 0; });
+}
+
+size_t MeasuredTextBatch::size() const {
+    return mState->paragraphs.size();
+}
+
+ssize_t MeasuredTextBatch::next() {
+    State& state = *mState;
+    std::unique_lock ulock(state.lock);
+    if (state.returned == state.paragraphs.size()) return -1;
+    state.waitFor(ulock, [&state] { return !state.finished.empty(); });
+    const size_t index = state.finished.front();
+    state.finished.pop_front();
+    state.returned++;
+    return index;
+}
+
+std::unique_ptr<minikin::MeasuredText> MeasuredTextBatch::take(size_t index) {
+    State& state = *mState;
+    std::unique_lock ulock(state.lock);
+    state.waitFor(ulock, [&state, index] { return state.done[index]; });
+    return std::move(state.results[index]);
+}
+
+}  // namespace android
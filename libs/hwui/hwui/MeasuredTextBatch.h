@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <minikin/MeasuredText.h>
+#include <sys/types.h>
+
+#include <memory>
+#include <vector>
+
+#include "utils/Macros.h"
+
+namespace android {
+
+/**
+ * Measures a batch of paragraphs on the CommonPool threads.
+ *
+ * PrecomputedText and StaticLayout measure a long document one paragraph at a time on the
+ * calling thread. A batch starts measuring every paragraph as soon as it is created, and hands
+ * each MeasuredText back as it completes, so line breaking can start on the first paragraphs
+ * while later ones are still being measured. Paragraphs are picked up roughly in order. A
+ * thread waiting on the batch measures pending paragraphs itself instead of idling.
+ */
+class MeasuredTextBatch {
+    PREVENT_COPY_AND_ASSIGN(MeasuredTextBatch);
+
+public:
+    struct Paragraph {
+        // Holds the style runs of the paragraph
+        std::unique_ptr<minikin::MeasuredTextBuilder> builder;
+        std::vector<uint16_t> text;
+        bool computeHyphenation = false;
+        bool computeLayout = false;
+        bool computeBounds = false;
+        bool fastHyphenationMode = false;
+        // A previous measurement of the same text to reuse, which must outlive the batch
+        minikin::MeasuredText* hint = nullptr;
+    };
+
+    explicit MeasuredTextBatch(std::vector<Paragraph>&& paragraphs);
+    // Skips the paragraphs not yet started, and waits for the ones being measured.
+    ~MeasuredTextBatch();
+
+    size_t size() const;
+
+    // Returns the index of a measured paragraph that next() has not returned before, in
+    // completion order, or -1 once every paragraph has been returned.
+    ssize_t next();
+
+    // Blocks until the paragraph is measured and hands over its result. Each paragraph can be
+    // taken once.
+    std::unique_ptr<minikin::MeasuredText> take(size_t index);
+
+private:
+    struct State;
+    std::shared_ptr<State> mState;
+};
+
+}  // namespace android
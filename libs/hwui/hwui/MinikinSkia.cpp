@@ -16,6 +16,7 @@
 
 #include "MinikinSkia.h"
 
+#include <SkData.h>
 #include <SkFont.h>
 #include <SkFontDescriptor.h>
 #include <SkFontMetrics.h>
@@ -43,8 +44,39 @@ MinikinFontSkia::MinikinFontSkia(sk_sp<SkTypeface> typeface, int sourceId, const
         , mFontSize(fontSize)
         , mTtcIndex(ttcIndex)
         , mAxes(axes)
+        , mFilePath(filePath) {
+    std::call_once(mTypefaceCreated, [] {});
+}
+
+MinikinFontSkia::MinikinFontSkia(sk_sp<SkData> data, int sourceId, const void* fontData,
+                                 size_t fontSize, std::string_view filePath, int ttcIndex,
+                                 const std::vector<minikin::FontVariation>& axes)
+        : mData(std::move(data))
+        , mSourceId(sourceId)
+        , mFontData(fontData)
+        , mFontSize(fontSize)
+        , mTtcIndex(ttcIndex)
+        , mAxes(axes)
         , mFilePath(filePath) {}
 
+static sk_sp<SkTypeface> makeSkTypeface(sk_sp<SkData> data, int ttcIndex,
+                                        const std::vector<minikin::FontVariation>& axes) {
+    std::vector<SkFontArguments::VariationPosition::Coordinate> skVariation;
+    skVariation.reserve(axes.size());
+    for (const auto& axis : axes) {
+        skVariation.push_back({axis.axisTag, axis.value});
+    }
+
+    std::unique_ptr<SkStreamAsset> fontData(new SkMemoryStream(std::move(data)));
+
+    SkFontArguments args;
+    args.setCollectionIndex(ttcIndex);
+    args.setVariationDesignPosition({skVariation.data(), static_cast<int>(skVariation.size())});
+
+    sk_sp<SkFontMgr> fm = android::FreeTypeFontMgr();
+    return fm->makeFromStream(std::move(fontData), args);
+}
+
 static void MinikinFontSkia_SetSkiaFont(const minikin::MinikinFont* font, SkFont* skFont,
                                         const minikin::MinikinPaint& paint,
                                         const minikin::FontFakery& fakery) {
@@ -64,7 +96,7 @@ float MinikinFontSkia::GetHorizontalAdvance(uint32_t glyph_id, const minikin::Mi
     MinikinFontSkia_SetSkiaFont(this, &skFont, paint, fakery);
     skFont.getWidths(&glyph16, 1, &skWidth);
 #ifdef VERBOSE
-    ALOGD("width for typeface %d glyph %d = %f", mTypeface->uniqueID(), glyph_id, skWidth);
+    ALOGD("width for typeface %d glyph %d = %f", GetSkTypeface()->uniqueID(), glyph_id, skWidth);
 #endif
     return skWidth;
 }
@@ -103,11 +135,24 @@ void MinikinFontSkia::GetFontExtent(minikin::MinikinExtent* extent,
     extent->descent = metrics.fDescent;
 }
 
+void MinikinFontSkia::createTypefaceOnce() const {
+    std::call_once(mTypefaceCreated, [this] {
+        mTypeface = makeSkTypeface(mData, mTtcIndex, mAxes);
+        // The font file was checked when the font was built, so this should not happen. Text
+        // falls back to the default typeface if it does.
+        if (mTypeface == nullptr) {
+            ALOGE("Failed to create SkTypeface from %s", mFilePath.c_str());
+        }
+    });
+}
+
 SkTypeface* MinikinFontSkia::GetSkTypeface() const {
+    createTypefaceOnce();
     return mTypeface.get();
 }
 
 sk_sp<SkTypeface> MinikinFontSkia::RefSkTypeface() const {
+    createTypefaceOnce();
     return mTypeface;
 }
 
@@ -129,6 +174,12 @@ const std::vector<minikin::FontVariation>& MinikinFontSkia::GetAxes() const {
 
 std::shared_ptr<minikin::MinikinFont> MinikinFontSkia::createFontWithVariation(
         const std::vector<minikin::FontVariation>& variations) const {
+    if (mData != nullptr) {
+        // Stay lazy, as most variations made while resolving fonts are never drawn.
+        return std::make_shared<MinikinFontSkia>(mData, mSourceId, mFontData, mFontSize,
+                                                 mFilePath, mTtcIndex, variations);
+    }
+
     SkFontArguments args;
 
     std::vector<SkFontArguments::VariationPosition::Coordinate> skVariation;
@@ -20,9 +20,11 @@
 #include <SkRefCnt.h>
 #include <cutils/compiler.h>
 #include <minikin/MinikinFont.h>
+#include <mutex>
 #include <string>
 #include <string_view>
 
+class SkData;
 class SkFont;
 class SkTypeface;
 
@@ -34,6 +36,12 @@ public:
                     std::string_view filePath, int ttcIndex,
                     const std::vector<minikin::FontVariation>& axes);
 
+    // Defers parsing the font file into an SkTypeface until the font is first drawn or
+    // measured. Most fonts of the system font map are never used by a given process.
+    MinikinFontSkia(sk_sp<SkData> data, int sourceId, const void* fontData, size_t fontSize,
+                    std::string_view filePath, int ttcIndex,
+                    const std::vector<minikin::FontVariation>& axes);
+
     float GetHorizontalAdvance(uint32_t glyph_id, const minikin::MinikinPaint& paint,
                                const minikin::FontFakery& fakery) const override;
 
@@ -72,7 +80,12 @@ public:
                                minikin::FontFakery fakery);
 
 private:
-    sk_sp<SkTypeface> mTypeface;
+    void createTypefaceOnce() const;
+
+    // The font file of a lazily created typeface
+    sk_sp<SkData> mData;
+    mutable std::once_flag mTypefaceCreated;
+    mutable sk_sp<SkTypeface> mTypeface;
 
     int mSourceId;
     // A raw pointer to the font data - it should be owned by some other object with
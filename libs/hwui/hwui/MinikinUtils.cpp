@@ -18,11 +18,16 @@
 
 #include <log/log.h>
 #include <minikin/FamilyVariant.h>
+#include <minikin/FontCollection.h>
 #include <minikin/MeasuredText.h>
 #include <minikin/Measurement.h>
 
+#include <deque>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 #include "FeatureFlags.h"
 #include "Paint.h"
@@ -31,6 +36,154 @@
 
 namespace android {
 
+namespace {
+
+/**
+ * Process-wide cache of shaped runs. A TextView measures a run while laying out and shapes the
+ * same run again to draw it, so most draw-time lookups hit. The key holds every input that
+ * affects shaping, including the font collection, which the entry keeps alive so its address
+ * cannot be reused by another collection. Entries are immutable once inserted, and the oldest
+ * ones are dropped when the cache grows past kMaxBytes.
+ */
+class ShapedRunCache {
+public:
+    static ShapedRunCache& get() {
+        static ShapedRunCache* sInstance = new ShapedRunCache();
+        return *sInstance;
+    }
+
+    // Longer runs are rarely repeated verbatim and would churn the cache.
+    static constexpr size_t kMaxRunLength = 256;
+
+    static std::string makeKey(const minikin::MinikinPaint& paint, minikin::Bidi bidiFlags,
+                               minikin::StartHyphenEdit startHyphen,
+                               minikin::EndHyphenEdit endHyphen, minikin::RunFlag runFlag,
+                               const minikin::U16StringPiece& context,
+                               const minikin::Range& range) {
+        std::string key;
+        auto append = [&key](const auto& value) {
+            key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+        append(paint.font.get());
+        append(paint.size);
+        append(paint.scaleX);
+        append(paint.skewX);
+        append(paint.letterSpacing);
+        append(paint.wordSpacing);
+        append(paint.fontFlags);
+        append(paint.localeListId);
+        append(paint.fontStyle.weight());
+        append(paint.fontStyle.slant());
+        append(paint.familyVariant);
+        append(paint.fontFeatureSettings.size());
+        for (const minikin::FontFeature& feature : paint.fontFeatureSettings) {
+            append(feature.tag);
+            append(feature.value);
+        }
+        append(bidiFlags);
+        append(startHyphen);
+        append(endHyphen);
+        append(runFlag);
+        append(range.getStart());
+        append(range.getEnd());
+        key.append(reinterpret_cast<const char*>(context.data()),
+                   context.size() * sizeof(uint16_t));
+        return key;
+    }
+
+    std::shared_ptr<const minikin::Layout> find(std::string_view key) {
+        std::lock_guard lock(mLock);
+        auto it = mEntries.find(key);
+        return it != mEntries.end() ? it->second.layout : nullptr;
+    }
+
+    void insert(std::string key, std::shared_ptr<minikin::FontCollection> fontCollection,
+                std::shared_ptr<const minikin::Layout> layout) {
+        const size_t bytes = sizeOf(key, *layout);
+        std::lock_guard lock(mLock);
+        auto [it, inserted] = mEntries.try_emplace(std::move(key));
+        if (inserted) {
+            mInsertionOrder.push_back(&it->first);
+        } else {
+            mBytes -= it->second.bytes;
+        }
+        it->second = {std::move(fontCollection), std::move(layout), bytes};
+        mBytes += bytes;
+        while (mBytes > kMaxBytes) {
+            auto oldest = mEntries.find(*mInsertionOrder.front());
+            mBytes -= oldest->second.bytes;
+            mEntries.erase(oldest);
+            mInsertionOrder.pop_front();
+        }
+    }
+
+    void clear() {
+        std::lock_guard lock(mLock);
+        mEntries.clear();
+        mInsertionOrder.clear();
+        mBytes = 0;
+    }
+
+private:
+    static constexpr size_t kMaxBytes = 512 * 1024;
+    // Glyph id, font and position of each glyph.
+    static constexpr size_t kBytesPerGlyph = 24;
+
+    struct Entry {
+        std::shared_ptr<minikin::FontCollection> fontCollection;
+        std::shared_ptr<const minikin::Layout> layout;
+        size_t bytes = 0;
+    };
+
+    static size_t sizeOf(std::string_view key, const minikin::Layout& layout) {
+        return key.size() + layout.nGlyphs() * kBytesPerGlyph + sizeof(minikin::Layout) +
+               sizeof(Entry);
+    }
+
+    std::mutex mLock;
+    // Allows looking keys up without copying them into a std::string
+    struct KeyHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view key) const {
+            return std::hash<std::string_view>()(key);
+        }
+    };
+
+    std::unordered_map<std::string, Entry, KeyHash, std::equal_to<>> mEntries;
+    // Keys of mEntries, oldest first. Map nodes are stable so the pointers stay valid.
+    std::deque<const std::string*> mInsertionOrder;
+    size_t mBytes = 0;
+};
+
+// Shapes the range of textBuf within contextRange, reusing a previous identical run if one is
+// cached.
+std::shared_ptr<const minikin::Layout> findOrShape(
+        const minikin::MinikinPaint& minikinPaint, minikin::Bidi bidiFlags,
+        minikin::StartHyphenEdit startHyphen, minikin::EndHyphenEdit endHyphen,
+        minikin::RunFlag runFlag, const minikin::U16StringPiece& textBuf,
+        const minikin::Range& range, const minikin::Range& contextRange) {
+    const minikin::U16StringPiece context = textBuf.substr(contextRange);
+    const minikin::Range contextLocalRange = range - contextRange.getStart();
+    if (contextRange.getLength() > ShapedRunCache::kMaxRunLength) {
+        return std::make_shared<const minikin::Layout>(context, contextLocalRange, bidiFlags,
+                                                       minikinPaint, startHyphen, endHyphen,
+                                                       runFlag);
+    }
+
+    ShapedRunCache& cache = ShapedRunCache::get();
+    std::string key = ShapedRunCache::makeKey(minikinPaint, bidiFlags, startHyphen, endHyphen,
+                                              runFlag, context, contextLocalRange);
+    if (auto layout = cache.find(key)) {
+        return layout;
+    }
+    auto layout = std::make_shared<const minikin::Layout>(
+            context, contextLocalRange, bidiFlags, minikinPaint, startHyphen, endHyphen, runFlag);
+    cache.insert(std::move(key), minikinPaint.font, layout);
+    return layout;
+}
+
+}  // namespace
+
 minikin::MinikinPaint MinikinUtils::prepareMinikinPaint(const Paint* paint,
                                                         const Typeface* typeface) {
     const Typeface* resolvedFace = Typeface::resolveDefault(typeface);
@@ -82,6 +235,30 @@ minikin::Layout MinikinUtils::doLayout(const Paint* paint, minikin::Bidi bidiFla
     }
 }
 
+std::shared_ptr<const minikin::Layout> MinikinUtils::doCachedLayout(
+        const Paint* paint, minikin::Bidi bidiFlags, const Typeface* typeface,
+        const uint16_t* buf, size_t bufSize, size_t start, size_t count, size_t contextStart,
+        size_t contextCount, minikin::MeasuredText* mt) {
+    if (mt != nullptr) {
+        // The measured text already holds the shaped pieces for this paragraph.
+        return std::make_shared<const minikin::Layout>(doLayout(paint, bidiFlags, typeface, buf,
+                                                                bufSize, start, count,
+                                                                contextStart, contextCount, mt));
+    }
+    const minikin::RunFlag minikinRunFlag = text_feature::letter_spacing_justification()
+                                                    ? paint->getRunFlag()
+                                                    : minikin::RunFlag::NONE;
+    return findOrShape(prepareMinikinPaint(paint, typeface), bidiFlags,
+                       paint->getStartHyphenEdit(), paint->getEndHyphenEdit(), minikinRunFlag,
+                       minikin::U16StringPiece(buf, bufSize),
+                       minikin::Range(start, start + count),
+                       minikin::Range(contextStart, contextStart + contextCount));
+}
+
+void MinikinUtils::purgeCaches() {
+    ShapedRunCache::get().clear();
+}
+
 void MinikinUtils::getBounds(const Paint* paint, minikin::Bidi bidiFlags, const Typeface* typeface,
                              const uint16_t* buf, size_t bufSize, minikin::MinikinRect* out) {
     minikin::MinikinPaint minikinPaint = prepareMinikinPaint(paint, typeface);
@@ -107,6 +284,19 @@ float MinikinUtils::measureText(const Paint* paint, minikin::Bidi bidiFlags,
                                                     ? paint->getRunFlag()
                                                     : minikin::RunFlag::NONE;
 
+    // A run measured during layout is usually drawn next, so shape it once for both. The
+    // cached layout carries no bounds or cluster count, so those requests measure directly.
+    if (bounds == nullptr && clusterCount == nullptr && bufSize <= ShapedRunCache::kMaxRunLength) {
+        std::shared_ptr<const minikin::Layout> layout =
+                findOrShape(minikinPaint, bidiFlags, startHyphen, endHyphen, minikinRunFlag,
+                            textBuf, range, minikin::Range(0, bufSize));
+        if (advances != nullptr) {
+            for (size_t i = 0; i < count; i++) {
+                advances[i] = layout->getCharAdvance(i);
+            }
+        }
+        return layout->getAdvance();
+    }
     return minikin::Layout::measureText(textBuf, range, bidiFlags, minikinPaint, startHyphen,
                                         endHyphen, advances, bounds, clusterCount, minikinRunFlag);
 }
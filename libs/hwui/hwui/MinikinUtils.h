@@ -28,6 +28,8 @@
 #include <log/log.h>
 #include <minikin/Layout.h>
 
+#include <memory>
+
 #include "FeatureFlags.h"
 #include "MinikinSkia.h"
 #include "Paint.h"
@@ -50,6 +52,16 @@ public:
                                                 size_t contextStart, size_t contextCount,
                                                 minikin::MeasuredText* mt);
 
+    // Like doLayout, but a run without measured text may be shared with earlier identical
+    // layouts and measurements instead of being shaped again.
+    static std::shared_ptr<const minikin::Layout> doCachedLayout(
+            const Paint* paint, minikin::Bidi bidiFlags, const Typeface* typeface,
+            const uint16_t* buf, size_t bufSize, size_t start, size_t count, size_t contextStart,
+            size_t contextCount, minikin::MeasuredText* mt);
+
+    // Drops the shaped runs kept by doCachedLayout and measureText.
+    static void purgeCaches();
+
     static void getBounds(const Paint* paint, minikin::Bidi bidiFlags, const Typeface* typeface,
                           const uint16_t* buf, size_t bufSize, minikin::MinikinRect* out);
 
@@ -81,7 +81,8 @@ static jlong AnimatedImageDrawable_nCreate(JNIEnv* env, jobject /*clazz*/,
         info = info.makeColorType(kRGBA_F16_SkColorType);
     }
 
-    size_t bytesUsed = info.computeMinByteSize();
+    const size_t frameBytes = info.computeMinByteSize();
+    size_t bytesUsed = frameBytes;
     // SkAnimatedImage has one SkBitmap for decoding, plus an extra one if there is a
     // kRestorePrevious frame. AnimatedImageDrawable has two SkPictures storing the current
     // frame and the next frame. (The former assumes that the image is animated, and the
@@ -114,7 +115,7 @@ static jlong AnimatedImageDrawable_nCreate(JNIEnv* env, jobject /*clazz*/,
     bytesUsed += sizeof(animatedImg.get());
 
     sk_sp<AnimatedImageDrawable> drawable(
-            new AnimatedImageDrawable(std::move(animatedImg), bytesUsed, format));
+            new AnimatedImageDrawable(std::move(animatedImg), bytesUsed, frameBytes, format));
     return reinterpret_cast<jlong>(drawable.release());
 }
 
@@ -20,12 +20,17 @@
 #include <androidfw/Asset.h>
 #include <sys/stat.h>
 
+#include <condition_variable>
+#include <list>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include "BitmapFactory.h"
 #include "CreateJavaOutputStreamAdaptor.h"
 #include "Gainmap.h"
 #include "GraphicsJNI.h"
+#include "Properties.h"
 #include "SkBitmap.h"
 #include "SkCodec.h"
 #include "SkColorSpace.h"
@@ -38,37 +43,95 @@
 using namespace android;
 
 namespace android {
+
+// Returns a heap copy of bitmap, including a copy of its gainmap, or nullptr if out of memory
+static sk_sp<Bitmap> copyHeapBitmap(Bitmap& bitmap) {
+    SkBitmap source = bitmap.getSkBitmap();
+    sk_sp<Bitmap> copy = Bitmap::allocateHeapBitmap(source.info());
+    if (!copy) {
+        return nullptr;
+    }
+    SkBitmap destination = copy->getSkBitmap();
+    if (!source.readPixels(destination.pixmap())) {
+        return nullptr;
+    }
+    if (bitmap.hasGainmap()) {
+        sp<uirenderer::Gainmap> gainmap = bitmap.gainmap();
+        auto gainmapCopy = sp<uirenderer::Gainmap>::make();
+        gainmapCopy->info = gainmap->info;
+        gainmapCopy->bitmap = copyHeapBitmap(*gainmap->bitmap);
+        if (!gainmapCopy->bitmap) {
+            return nullptr;
+        }
+        copy->setGainmap(std::move(gainmapCopy));
+    }
+    return copy;
+}
+
 class BitmapRegionDecoderWrapper {
 public:
+    /**
+     * skia::BitmapRegionDecoder is not thread safe, so every decode borrows a set of decoders
+     * of its own. Decoders share the encoded data and more are created on demand, up to
+     * kMaxDecoders, so regions requested from several threads decode concurrently.
+     */
+    struct Decoders {
+        std::unique_ptr<skia::BitmapRegionDecoder> mainImage;
+        std::unique_ptr<skia::BitmapRegionDecoder> gainmap;
+    };
+    static constexpr size_t kMaxDecoders = 4;
+
+    class ScopedDecoders {
+    public:
+        explicit ScopedDecoders(BitmapRegionDecoderWrapper* owner)
+                : mOwner(owner), mDecoders(owner->acquireDecoders()) {}
+        ~ScopedDecoders() { mOwner->releaseDecoders(std::move(mDecoders)); }
+
+        Decoders* operator->() const { return mDecoders.get(); }
+        explicit operator bool() const { return mDecoders != nullptr; }
+
+    private:
+        BitmapRegionDecoderWrapper* const mOwner;
+        std::unique_ptr<Decoders> mDecoders;
+    };
+
     static std::unique_ptr<BitmapRegionDecoderWrapper> Make(sk_sp<SkData> data) {
         std::unique_ptr<skia::BitmapRegionDecoder> mainImageBRD =
-                skia::BitmapRegionDecoder::Make(std::move(data));
+                skia::BitmapRegionDecoder::Make(data);
         if (!mainImageBRD) {
             return nullptr;
         }
 
         SkGainmapInfo gainmapInfo;
         std::unique_ptr<SkStream> gainmapStream;
+        sk_sp<SkData> gainmapData = nullptr;
         std::unique_ptr<skia::BitmapRegionDecoder> gainmapBRD = nullptr;
         if (mainImageBRD->getAndroidGainmap(&gainmapInfo, &gainmapStream)) {
-            sk_sp<SkData> data = nullptr;
             if (gainmapStream->getMemoryBase()) {
                 // It is safe to make without copy because we'll hold onto the stream.
-                data = SkData::MakeWithoutCopy(gainmapStream->getMemoryBase(),
-                                               gainmapStream->getLength());
+                gainmapData = SkData::MakeWithoutCopy(gainmapStream->getMemoryBase(),
+                                                      gainmapStream->getLength());
             } else {
-                data = SkCopyStreamToData(gainmapStream.get());
+                gainmapData = SkCopyStreamToData(gainmapStream.get());
                 // We don't need to hold the stream anymore
                 gainmapStream = nullptr;
             }
-            gainmapBRD = skia::BitmapRegionDecoder::Make(std::move(data));
+            gainmapBRD = skia::BitmapRegionDecoder::Make(gainmapData);
+            if (!gainmapBRD) {
+                gainmapData = nullptr;
+            }
         }
 
-        return std::unique_ptr<BitmapRegionDecoderWrapper>(
-                new BitmapRegionDecoderWrapper(std::move(mainImageBRD), std::move(gainmapBRD),
-                                               gainmapInfo, std::move(gainmapStream)));
+        auto decoders = std::make_unique<Decoders>();
+        decoders->mainImage = std::move(mainImageBRD);
+        decoders->gainmap = std::move(gainmapBRD);
+        return std::unique_ptr<BitmapRegionDecoderWrapper>(new BitmapRegionDecoderWrapper(
+                std::move(data), std::move(gainmapData), std::move(decoders), gainmapInfo,
+                std::move(gainmapStream)));
     }
 
+    // The queries below only read the encoded info, which the decoders never modify, so
+    // they use the first decoder even while it is borrowed.
     SkEncodedImageFormat getEncodedFormat() { return mMainImageBRD->getEncodedFormat(); }
 
     SkColorType computeOutputColorType(SkColorType requestedColorType) {
@@ -80,11 +143,12 @@ public:
         return mMainImageBRD->computeOutputColorSpace(outputColorType, prefColorSpace);
     }
 
-    bool decodeRegion(SkBitmap* bitmap, skia::BRDAllocator* allocator, const SkIRect& desiredSubset,
-                      int sampleSize, SkColorType colorType, bool requireUnpremul,
+    bool decodeRegion(const ScopedDecoders& decoders, SkBitmap* bitmap,
+                      skia::BRDAllocator* allocator, const SkIRect& desiredSubset, int sampleSize,
+                      SkColorType colorType, bool requireUnpremul,
                       sk_sp<SkColorSpace> prefColorSpace) {
-        return mMainImageBRD->decodeRegion(bitmap, allocator, desiredSubset, sampleSize, colorType,
-                                           requireUnpremul, prefColorSpace);
+        return decoders->mainImage->decodeRegion(bitmap, allocator, desiredSubset, sampleSize,
+                                                 colorType, requireUnpremul, prefColorSpace);
     }
 
     // Decodes the gainmap region. If decoding succeeded, returns true and
@@ -96,11 +160,13 @@ public:
     // of this region. desiredSubset is also _not_ guaranteed to be
     // pixel-aligned, so it's not possible to simply resize the resulting
     // bitmap to accomplish this.
-    bool decodeGainmapRegion(sp<uirenderer::Gainmap>* outGainmap, SkISize bitmapDimensions,
-                             const SkRect& desiredSubset, int sampleSize, bool requireUnpremul) {
-        SkColorType decodeColorType = mGainmapBRD->computeOutputColorType(kN32_SkColorType);
+    bool decodeGainmapRegion(const ScopedDecoders& decoders, sp<uirenderer::Gainmap>* outGainmap,
+                             SkISize bitmapDimensions, const SkRect& desiredSubset,
+                             int sampleSize, bool requireUnpremul) {
+        skia::BitmapRegionDecoder* gainmapBRD = decoders->gainmap.get();
+        SkColorType decodeColorType = gainmapBRD->computeOutputColorType(kN32_SkColorType);
         sk_sp<SkColorSpace> decodeColorSpace =
-                mGainmapBRD->computeOutputColorSpace(decodeColorType, nullptr);
+                gainmapBRD->computeOutputColorSpace(decodeColorType, nullptr);
         SkBitmap bm;
         // Because we must match the dimensions of the base bitmap, we always use a
         // recycling allocator even though we are allocating a new bitmap. This is to ensure
@@ -139,8 +205,8 @@ public:
         logicalSubset.fBottom /= sampleSize;
 
         RecyclingClippingPixelAllocator allocator(nativeBitmap.get(), false, logicalSubset);
-        if (!mGainmapBRD->decodeRegion(&bm, &allocator, roundedSubset, sampleSize, decodeColorType,
-                                       requireUnpremul, decodeColorSpace)) {
+        if (!gainmapBRD->decodeRegion(&bm, &allocator, roundedSubset, sampleSize, decodeColorType,
+                                      requireUnpremul, decodeColorSpace)) {
             ALOGE("Error decoding Gainmap region");
             return false;
         }
@@ -188,19 +254,132 @@ public:
     int width() const { return mMainImageBRD->width(); }
     int height() const { return mMainImageBRD->height(); }
 
+    // Returns the cached decode of a region, or nullptr if it is not in the cache
+    sk_sp<Bitmap> findCachedRegion(const SkIRect& subset, int sampleSize, SkColorType colorType,
+                                   bool requireUnpremul, const SkColorSpace* colorSpace) {
+        if (mCacheBudget == 0) {
+            return nullptr;
+        }
+        std::lock_guard lock(mCacheLock);
+        for (auto it = mCache.begin(); it != mCache.end(); it++) {
+            if (it->subset == subset && it->sampleSize == sampleSize &&
+                it->colorType == colorType && it->requireUnpremul == requireUnpremul &&
+                SkColorSpace::Equals(it->colorSpace.get(), colorSpace)) {
+                // Move to the front so that the least recently used region is evicted first
+                mCache.splice(mCache.begin(), mCache, it);
+                return mCache.front().bitmap;
+            }
+        }
+        return nullptr;
+    }
+
+    // Keeps a decoded region, which must not be modified afterwards
+    void cacheRegion(const SkIRect& subset, int sampleSize, SkColorType colorType,
+                     bool requireUnpremul, sk_sp<SkColorSpace> colorSpace,
+                     sk_sp<Bitmap> bitmap) {
+        if (!bitmap) {
+            return;
+        }
+        size_t bytes = bitmap->getAllocationByteCount();
+        if (bitmap->hasGainmap()) {
+            bytes += bitmap->gainmap()->bitmap->getAllocationByteCount();
+        }
+        if (bytes > mCacheBudget) {
+            return;
+        }
+        std::lock_guard lock(mCacheLock);
+        mCache.push_front({subset, sampleSize, colorType, requireUnpremul, std::move(colorSpace),
+                           std::move(bitmap), bytes});
+        mCacheBytes += bytes;
+        while (mCacheBytes > mCacheBudget) {
+            mCacheBytes -= mCache.back().bytes;
+            mCache.pop_back();
+        }
+    }
+
+    bool isCacheEnabled() const { return mCacheBudget > 0; }
+
 private:
-    BitmapRegionDecoderWrapper(std::unique_ptr<skia::BitmapRegionDecoder> mainImageBRD,
-                               std::unique_ptr<skia::BitmapRegionDecoder> gainmapBRD,
-                               SkGainmapInfo info, std::unique_ptr<SkStream> stream)
-            : mMainImageBRD(std::move(mainImageBRD))
-            , mGainmapBRD(std::move(gainmapBRD))
+    struct CachedRegion {
+        SkIRect subset;
+        int sampleSize;
+        SkColorType colorType;
+        bool requireUnpremul;
+        sk_sp<SkColorSpace> colorSpace;
+        sk_sp<Bitmap> bitmap;
+        size_t bytes;
+    };
+
+    BitmapRegionDecoderWrapper(sk_sp<SkData> data, sk_sp<SkData> gainmapData,
+                               std::unique_ptr<Decoders> decoders, SkGainmapInfo info,
+                               std::unique_ptr<SkStream> stream)
+            : mData(std::move(data))
+            , mGainmapData(std::move(gainmapData))
+            , mMainImageBRD(decoders->mainImage.get())
+            , mGainmapBRD(decoders->gainmap.get())
             , mGainmapInfo(info)
-            , mGainmapStream(std::move(stream)) {}
+            , mGainmapStream(std::move(stream))
+            , mCacheBudget(std::max(uirenderer::Properties::regionDecoderCacheKb, 0) * 1024) {
+        mFreeDecoders.push_back(std::move(decoders));
+        mDecoderCount = 1;
+    }
+
+    std::unique_ptr<Decoders> acquireDecoders() {
+        std::unique_lock lock(mDecoderLock);
+        mDecoderAvailable.wait(lock, [this] {
+            return !mFreeDecoders.empty() || mDecoderCount < kMaxDecoders;
+        });
+        if (!mFreeDecoders.empty()) {
+            std::unique_ptr<Decoders> decoders = std::move(mFreeDecoders.back());
+            mFreeDecoders.pop_back();
+            return decoders;
+        }
+        mDecoderCount++;
+        lock.unlock();
+
+        // Creating a decoder parses the headers, so do it without holding the lock
+        auto decoders = std::make_unique<Decoders>();
+        decoders->mainImage = skia::BitmapRegionDecoder::Make(mData);
+        if (mGainmapData) {
+            decoders->gainmap = skia::BitmapRegionDecoder::Make(mGainmapData);
+        }
+        if (!decoders->mainImage || (mGainmapData && !decoders->gainmap)) {
+            ALOGE("Failed to create an additional BitmapRegionDecoder");
+            releaseDecoders(nullptr);
+            return nullptr;
+        }
+        return decoders;
+    }
+
+    void releaseDecoders(std::unique_ptr<Decoders> decoders) {
+        {
+            std::lock_guard lock(mDecoderLock);
+            if (decoders) {
+                mFreeDecoders.push_back(std::move(decoders));
+            } else {
+                mDecoderCount--;
+            }
+        }
+        mDecoderAvailable.notify_one();
+    }
 
-    std::unique_ptr<skia::BitmapRegionDecoder> mMainImageBRD;
-    std::unique_ptr<skia::BitmapRegionDecoder> mGainmapBRD;
+    const sk_sp<SkData> mData;
+    const sk_sp<SkData> mGainmapData;
+    // Owned by the first set of decoders, which live as long as the wrapper
+    skia::BitmapRegionDecoder* const mMainImageBRD;
+    skia::BitmapRegionDecoder* const mGainmapBRD;
     SkGainmapInfo mGainmapInfo;
     std::unique_ptr<SkStream> mGainmapStream;
+
+    std::mutex mDecoderLock;
+    std::condition_variable mDecoderAvailable;
+    std::vector<std::unique_ptr<Decoders>> mFreeDecoders;
+    size_t mDecoderCount = 0;
+
+    const size_t mCacheBudget;
+    std::mutex mCacheLock;
+    std::list<CachedRegion> mCache;
+    size_t mCacheBytes = 0;
 };
 }  // namespace android
 
@@ -330,12 +509,50 @@ static jobject nativeDecodeRegion(JNIEnv* env, jobject, jlong brdHandle, jint in
     sk_sp<SkColorSpace> decodeColorSpace = brd->computeOutputColorSpace(
             decodeColorType, colorSpace);
 
-    // Decode the region.
+    // Decode the region. Decodes into a recycled bitmap depend on its dimensions, so only
+    // new bitmaps use the cache.
     const SkIRect subset = SkIRect::MakeXYWH(inputX, inputY, inputWidth, inputHeight);
     SkBitmap bitmap;
-    if (!brd->decodeRegion(&bitmap, allocator, subset, sampleSize,
-            decodeColorType, requireUnpremul, decodeColorSpace)) {
-        return nullObjectReturn("Failed to decode region.");
+    sp<uirenderer::Gainmap> gainmap;
+    bool hasGainmap = brd->hasGainmap();
+    sk_sp<Bitmap> cachedRegion =
+            javaBitmap ? nullptr
+                       : brd->findCachedRegion(subset, sampleSize, decodeColorType,
+                                               requireUnpremul, decodeColorSpace.get());
+    if (cachedRegion) {
+        cachedRegion->getSkBitmap(&bitmap);
+        hasGainmap = cachedRegion->hasGainmap();
+    } else {
+        BitmapRegionDecoderWrapper::ScopedDecoders decoders(brd);
+        if (!decoders) {
+            return nullObjectReturn("Failed to create region decoder.");
+        }
+        if (!brd->decodeRegion(decoders, &bitmap, allocator, subset, sampleSize, decodeColorType,
+                               requireUnpremul, decodeColorSpace)) {
+            return nullObjectReturn("Failed to decode region.");
+        }
+
+        if (javaBitmap) {
+            recycleAlloc.copyIfNecessary();
+        }
+
+        if (hasGainmap) {
+            SkISize gainmapDims = SkISize::Make(bitmap.width(), bitmap.height());
+            if (javaBitmap) {
+                // If we are recycling we must match the inBitmap's relative dimensions
+                gainmapDims.fWidth = recycledBitmap->width();
+                gainmapDims.fHeight = recycledBitmap->height();
+            }
+            BitmapRegionDecoderWrapper::Projection gainmapProjection =
+                    brd->calculateGainmapRegion(subset, gainmapDims);
+            if (!brd->decodeGainmapRegion(decoders, &gainmap, gainmapProjection.destSize,
+                                          gainmapProjection.srcRect, sampleSize,
+                                          requireUnpremul)) {
+                // If there is an error decoding Gainmap - we don't fail. We just don't provide
+                // Gainmap
+                hasGainmap = false;
+            }
+        }
     }
 
     // If the client provided options, indicate that the decode was successful.
@@ -361,28 +578,6 @@ static jobject nativeDecodeRegion(JNIEnv* env, jobject, jlong brdHandle, jint in
                 GraphicsJNI::getColorSpace(env, decodeColorSpace.get(), decodeColorType));
     }
 
-    if (javaBitmap) {
-        recycleAlloc.copyIfNecessary();
-    }
-
-    sp<uirenderer::Gainmap> gainmap;
-    bool hasGainmap = brd->hasGainmap();
-    if (hasGainmap) {
-        SkISize gainmapDims = SkISize::Make(bitmap.width(), bitmap.height());
-        if (javaBitmap) {
-            // If we are recycling we must match the inBitmap's relative dimensions
-            gainmapDims.fWidth = recycledBitmap->width();
-            gainmapDims.fHeight = recycledBitmap->height();
-        }
-        BitmapRegionDecoderWrapper::Projection gainmapProjection =
-                brd->calculateGainmapRegion(subset, gainmapDims);
-        if (!brd->decodeGainmapRegion(&gainmap, gainmapProjection.destSize,
-                                      gainmapProjection.srcRect, sampleSize, requireUnpremul)) {
-            // If there is an error decoding Gainmap - we don't fail. We just don't provide Gainmap
-            hasGainmap = false;
-        }
-    }
-
     // If we may have reused a bitmap, we need to indicate that the pixels have changed.
     if (javaBitmap) {
         if (hasGainmap) {
@@ -400,16 +595,39 @@ static jobject nativeDecodeRegion(JNIEnv* env, jobject, jlong brdHandle, jint in
     if (isHardware) {
         sk_sp<Bitmap> hardwareBitmap = Bitmap::allocateHardwareBitmap(bitmap);
         if (hasGainmap) {
-            auto gm = uirenderer::Gainmap::allocateHardwareGainmap(gainmap);
+            auto gm = uirenderer::Gainmap::allocateHardwareGainmap(
+                    cachedRegion ? cachedRegion->gainmap() : gainmap);
             if (gm) {
                 hardwareBitmap->setGainmap(std::move(gm));
             }
         }
+        if (!cachedRegion && brd->isCacheEnabled()) {
+            // The heap decode is only an intermediate here, so the cache takes it as is
+            sk_sp<Bitmap> heapBitmap(heapAlloc.getStorageObjAndReset());
+            if (hasGainmap && heapBitmap) {
+                heapBitmap->setGainmap(std::move(gainmap));
+            }
+            brd->cacheRegion(subset, sampleSize, decodeColorType, requireUnpremul,
+                             decodeColorSpace, std::move(heapBitmap));
+        }
         return bitmap::createBitmap(env, hardwareBitmap.release(), bitmapCreateFlags);
     }
-    Bitmap* heapBitmap = heapAlloc.getStorageObjAndReset();
-    if (hasGainmap && heapBitmap != nullptr) {
-        heapBitmap->setGainmap(std::move(gainmap));
+    Bitmap* heapBitmap = nullptr;
+    if (cachedRegion) {
+        // The caller owns the returned bitmap and may modify it, so it gets a copy
+        heapBitmap = copyHeapBitmap(*cachedRegion).release();
+        if (!heapBitmap) {
+            return nullObjectReturn("OOM copying cached region.");
+        }
+    } else {
+        heapBitmap = heapAlloc.getStorageObjAndReset();
+        if (hasGainmap && heapBitmap != nullptr) {
+            heapBitmap->setGainmap(std::move(gainmap));
+        }
+        if (heapBitmap != nullptr && brd->isCacheEnabled()) {
+            brd->cacheRegion(subset, sampleSize, decodeColorType, requireUnpremul,
+                             decodeColorSpace, copyHeapBitmap(*heapBitmap));
+        }
     }
     return android::bitmap::createBitmap(env, heapBitmap, bitmapCreateFlags);
 }
@@ -68,6 +68,8 @@ enum Allocator {
     kSoftware_Allocator     = 1,
     kSharedMemory_Allocator = 2,
     kHardware_Allocator     = 3,
+    // A mutable heap bitmap whose pixel memory is borrowed from BitmapPool
+    kPooled_Allocator       = 4,
 };
 
 // These need to stay in sync with ImageDecoder.java's Error constants.
@@ -342,6 +344,8 @@ static jobject ImageDecoder_nDecodeBitmap(JNIEnv* env, jobject /*clazz*/, jlong
     sk_sp<Bitmap> nativeBitmap;
     if (allocator == kSharedMemory_Allocator) {
         nativeBitmap = Bitmap::allocateAshmemBitmap(&bm);
+    } else if (allocator == kPooled_Allocator) {
+        nativeBitmap = Bitmap::allocatePooledHeapBitmap(&bm);
     } else {
         nativeBitmap = Bitmap::allocateHeapBitmap(&bm);
     }
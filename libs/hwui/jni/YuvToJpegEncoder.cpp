@@ -7,7 +7,16 @@
 
 #include "graphics_jni_helpers.h"
 
+#include <algorithm>
 #include <csetjmp>
+#include <cstring>
+#include <future>
+#include <vector>
+
+#include "SkData.h"
+#include "thread/CommonPool.h"
+
+using android::uirenderer::CommonPool;
 
 extern "C" {
     // We need to include stdio.h before jpeg because jpeg does not include it, but uses FILE
@@ -97,8 +106,8 @@ skstream_destination_mgr::skstream_destination_mgr(SkWStream* stream)
     this->term_destination = sk_term_destination;
 }
 
-bool YuvToJpegEncoder::encode(SkWStream* stream, void* inYuv, int width,
-        int height, int* offsets, int jpegQuality) {
+bool YuvToJpegEncoder::encodeRows(SkWStream* stream, uint8_t* yuv, int width,
+        int height, int* offsets, int quality, bool restartEveryMcuRow) {
     jpeg_compress_struct      cinfo;
     ErrorMgr                  err;
     skstream_destination_mgr  sk_wstream(stream);
@@ -114,11 +123,17 @@ bool YuvToJpegEncoder::encode(SkWStream* stream, void* inYuv, int width,
 
     cinfo.dest = &sk_wstream;
 
-    setJpegCompressStruct(&cinfo, width, height, jpegQuality);
+    setJpegCompressStruct(&cinfo, width, height, quality);
+    if (restartEveryMcuRow) {
+        // Strips are joined by their entropy-coded data, so they must share the default
+        // Huffman tables.
+        cinfo.optimize_coding = FALSE;
+        cinfo.restart_in_rows = 1;
+    }
 
     jpeg_start_compress(&cinfo, TRUE);
 
-    compress(&cinfo, (uint8_t*) inYuv, offsets);
+    compress(&cinfo, yuv, offsets);
 
     jpeg_finish_compress(&cinfo);
 
@@ -127,6 +142,113 @@ bool YuvToJpegEncoder::encode(SkWStream* stream, void* inYuv, int width,
     return true;
 }
 
+// Both supported formats use 16-row MCUs. A strip of kStripRowAlignment rows holds eight
+// MCU rows, so the restart markers inside each strip are numbered the same as they would be
+// in the joined image, and only the RST7 marker between strips has to be added.
+static constexpr int kMcuRows = 16;
+static constexpr int kStripRowAlignment = 8 * kMcuRows;
+// Below this many pixels, handing strips to other threads costs more than it saves.
+static constexpr int64_t kMinParallelPixels = 1 << 20;
+
+// Finds the start of the frame header and of the entropy-coded data in a JPEG produced by
+// encodeRows().
+static bool findJpegSegments(const uint8_t* data, size_t size, size_t* sofOffset,
+        size_t* scanOffset) {
+    if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+        return false;
+    }
+    *sofOffset = 0;
+    size_t pos = 2;
+    while (pos + 4 <= size && data[pos] == 0xFF) {
+        const uint8_t marker = data[pos + 1];
+        const size_t length = (data[pos + 2] << 8) | data[pos + 3];
+        if (marker >= 0xC0 && marker <= 0xC2) {
+            *sofOffset = pos;
+        } else if (marker == 0xDA) {
+            *scanOffset = pos + 2 + length;
+            return *sofOffset != 0 && *scanOffset + 2 <= size;
+        }
+        pos += 2 + length;
+    }
+    return false;
+}
+
+bool YuvToJpegEncoder::encode(SkWStream* stream, void* inYuv, int width,
+        int height, int* offsets, int jpegQuality) {
+    uint8_t* yuv = (uint8_t*) inYuv;
+    const int alignedStrips = (height + kStripRowAlignment - 1) / kStripRowAlignment;
+    int stripCount = 1;
+    if (fParallelEncode && (int64_t) width * height >= kMinParallelPixels &&
+            !CommonPool::isPoolThread()) {
+        stripCount = std::min(CommonPool::getThreadCount() + 1, alignedStrips);
+    }
+    if (stripCount <= 1) {
+        return encodeRows(stream, yuv, width, height, offsets, jpegQuality, false);
+    }
+
+    const int stripRows = (alignedStrips + stripCount - 1) / stripCount * kStripRowAlignment;
+    stripCount = (height + stripRows - 1) / stripRows;
+    std::vector<sk_sp<SkData>> strips(stripCount);
+    auto encodeStrip = [&](int strip) {
+        const int row = strip * stripRows;
+        int stripOffsets[kMaxPlanes];
+        std::copy(offsets, offsets + fNumPlanes, stripOffsets);
+        advanceRows(stripOffsets, row);
+        SkDynamicMemoryWStream out;
+        if (encodeRows(&out, yuv, width, std::min(stripRows, height - row), stripOffsets,
+                jpegQuality, true)) {
+            strips[strip] = out.detachAsData();
+        }
+    };
+
+    std::vector<std::future<void>> pending;
+    for (int strip = 1; strip < stripCount; strip++) {
+        // Encoding is not tied to a frame, so the strips queue behind frame-critical work.
+        pending.push_back(CommonPool::async([&encodeStrip, strip] { encodeStrip(strip); }));
+    }
+    encodeStrip(0);
+    for (auto& result : pending) {
+        result.get();
+    }
+
+    // The first strip supplies the headers, with its frame height patched to the full image.
+    // Each later strip contributes only its entropy-coded data, after a restart marker.
+    static const uint8_t kRst7[] = {0xFF, 0xD7};
+    static const uint8_t kEoi[] = {0xFF, 0xD9};
+    for (int strip = 0; strip < stripCount; strip++) {
+        if (!strips[strip]) {
+            return false;
+        }
+        const uint8_t* data = strips[strip]->bytes();
+        const size_t size = strips[strip]->size();
+        size_t sofOffset, scanOffset;
+        if (!findJpegSegments(data, size, &sofOffset, &scanOffset)) {
+            ALOGW("Malformed JPEG strip %d", strip);
+            return false;
+        }
+        bool written;
+        if (strip == 0) {
+            // The frame height follows the marker, length and sample precision.
+            const size_t heightOffset = sofOffset + 5;
+            const uint8_t frameHeight[] = {(uint8_t) (height >> 8), (uint8_t) height};
+            written = stream->write(data, heightOffset) &&
+                    stream->write(frameHeight, sizeof(frameHeight)) &&
+                    stream->write(data + heightOffset + 2, size - heightOffset - 4);
+        } else {
+            written = stream->write(kRst7, sizeof(kRst7)) &&
+                    stream->write(data + scanOffset, size - scanOffset - 2);
+        }
+        if (!written) {
+            return false;
+        }
+    }
+    if (!stream->write(kEoi, sizeof(kEoi))) {
+        return false;
+    }
+    stream->flush();
+    return true;
+}
+
 void YuvToJpegEncoder::setJpegCompressStruct(jpeg_compress_struct* cinfo,
         int width, int height, int quality) {
     cinfo->image_width = width;
@@ -192,22 +314,45 @@ void Yuv420SpToJpegEncoder::compress(jpeg_compress_struct* cinfo,
 
 }
 
+// Vector types for deinterleaving chroma. The compiler lowers the shuffles to NEON or SSE.
+typedef uint8_t Bytes8 __attribute__((vector_size(8)));
+typedef uint8_t Bytes16 __attribute__((vector_size(16)));
+typedef uint8_t Bytes32 __attribute__((vector_size(32)));
+
 void Yuv420SpToJpegEncoder::deinterleave(uint8_t* vuPlanar, uint8_t* uRows,
         uint8_t* vRows, int rowIndex, int width, int height) {
     int numRows = (height - rowIndex) / 2;
     if (numRows > 8) numRows = 8;
+    const int chromaWidth = width >> 1;
     for (int row = 0; row < numRows; ++row) {
         int offset = ((rowIndex >> 1) + row) * fStrides[1];
-        uint8_t* vu = vuPlanar + offset;
-        for (int i = 0; i < (width >> 1); ++i) {
-            int index = row * (width >> 1) + i;
-            uRows[index] = vu[1];
-            vRows[index] = vu[0];
-            vu += 2;
+        const uint8_t* vu = vuPlanar + offset;
+        uint8_t* u = uRows + row * chromaWidth;
+        uint8_t* v = vRows + row * chromaWidth;
+        int i = 0;
+        for (; i + 16 <= chromaWidth; i += 16) {
+            Bytes32 pairs;
+            memcpy(&pairs, vu + 2 * i, sizeof(pairs));
+            Bytes16 us = __builtin_shufflevector(pairs, pairs,
+                    1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+            Bytes16 vs = __builtin_shufflevector(pairs, pairs,
+                    0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+            memcpy(u + i, &us, sizeof(us));
+            memcpy(v + i, &vs, sizeof(vs));
+        }
+        for (; i < chromaWidth; ++i) {
+            u[i] = vu[2 * i + 1];
+            v[i] = vu[2 * i];
         }
     }
 }
 
+void Yuv420SpToJpegEncoder::advanceRows(int* offsets, int rows) {
+    // Callers only split at even rows, where the chroma rows line up.
+    offsets[0] += rows * fStrides[0];
+    offsets[1] += (rows >> 1) * fStrides[1];
+}
+
 void Yuv420SpToJpegEncoder::configSamplingFactors(jpeg_compress_struct* cinfo) {
     // cb and cr are horizontally downsampled and vertically downsampled as well.
     cinfo->comp_info[0].h_samp_factor = 2;
@@ -271,20 +416,39 @@ void Yuv422IToJpegEncoder::deinterleave(uint8_t* yuv, uint8_t* yRows, uint8_t* u
         uint8_t* vRows, int rowIndex, int width, int height) {
     int numRows = height - rowIndex;
     if (numRows > 16) numRows = 16;
+    const int chromaWidth = width >> 1;
     for (int row = 0; row < numRows; ++row) {
-        uint8_t* yuvSeg = yuv + (rowIndex + row) * fStrides[0];
-        for (int i = 0; i < (width >> 1); ++i) {
-            int indexY = row * width + (i << 1);
-            int indexU = row * (width >> 1) + i;
-            yRows[indexY] = yuvSeg[0];
-            yRows[indexY + 1] = yuvSeg[2];
-            uRows[indexU] = yuvSeg[1];
-            vRows[indexU] = yuvSeg[3];
-            yuvSeg += 4;
+        const uint8_t* yuvSeg = yuv + (rowIndex + row) * fStrides[0];
+        uint8_t* y = yRows + row * width;
+        uint8_t* u = uRows + row * chromaWidth;
+        uint8_t* v = vRows + row * chromaWidth;
+        int i = 0;
+        // Each 32 bytes hold 16 pixels as Y0 U Y1 V.
+        for (; i + 8 <= chromaWidth; i += 8) {
+            Bytes32 pixels;
+            memcpy(&pixels, yuvSeg + 4 * i, sizeof(pixels));
+            Bytes16 ys = __builtin_shufflevector(pixels, pixels,
+                    0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+            Bytes8 us = __builtin_shufflevector(pixels, pixels, 1, 5, 9, 13, 17, 21, 25, 29);
+            Bytes8 vs = __builtin_shufflevector(pixels, pixels, 3, 7, 11, 15, 19, 23, 27, 31);
+            memcpy(y + 2 * i, &ys, sizeof(ys));
+            memcpy(u + i, &us, sizeof(us));
+            memcpy(v + i, &vs, sizeof(vs));
+        }
+        for (; i < chromaWidth; ++i) {
+            const uint8_t* pixel = yuvSeg + 4 * i;
+            y[2 * i] = pixel[0];
+            y[2 * i + 1] = pixel[2];
+            u[i] = pixel[1];
+            v[i] = pixel[3];
         }
     }
 }
 
+void Yuv422IToJpegEncoder::advanceRows(int* offsets, int rows) {
+    offsets[0] += rows * fStrides[0];
+}
+
 void Yuv422IToJpegEncoder::configSamplingFactors(jpeg_compress_struct* cinfo) {
     // cb and cr are horizontally downsampled and vertically downsampled as well.
     cinfo->comp_info[0].h_samp_factor = 2;
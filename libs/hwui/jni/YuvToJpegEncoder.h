@@ -37,16 +37,29 @@ public:
     bool encode(SkWStream* stream,  void* inYuv, int width,
            int height, int* offsets, int jpegQuality);
 
+    /** Allow large images to be encoded as horizontal strips on the CommonPool
+     *  threads. The strips are joined with restart markers into a single JPEG.
+     *  Enabled by default.
+     */
+    void setParallelEncodeEnabled(bool enabled) { fParallelEncode = enabled; }
+
     virtual ~YuvToJpegEncoder() {}
 
 protected:
+    static constexpr int kMaxPlanes = 2;
+
     int fNumPlanes;
     int* fStrides;
+    bool fParallelEncode = true;
+    bool encodeRows(SkWStream* stream, uint8_t* yuv, int width, int height,
+            int* offsets, int quality, bool restartEveryMcuRow);
     void setJpegCompressStruct(jpeg_compress_struct* cinfo, int width,
             int height, int quality);
     virtual void configSamplingFactors(jpeg_compress_struct* cinfo) = 0;
     virtual void compress(jpeg_compress_struct* cinfo,
             uint8_t* yuv, int* offsets) = 0;
+    // Moves each plane offset down by the given number of image rows.
+    virtual void advanceRows(int* offsets, int rows) = 0;
 };
 
 class Yuv420SpToJpegEncoder : public YuvToJpegEncoder {
@@ -61,6 +74,7 @@ private:
     void deinterleave(uint8_t* vuPlanar, uint8_t* uRows, uint8_t* vRows,
             int rowIndex, int width, int height);
     void compress(jpeg_compress_struct* cinfo, uint8_t* yuv, int* offsets);
+    void advanceRows(int* offsets, int rows);
 };
 
 class Yuv422IToJpegEncoder : public YuvToJpegEncoder {
@@ -73,6 +87,7 @@ private:
     void compress(jpeg_compress_struct* cinfo, uint8_t* yuv, int* offsets);
     void deinterleave(uint8_t* yuv, uint8_t* yRows, uint8_t* uRows,
             uint8_t* vRows, int rowIndex, int width, int height);
+    void advanceRows(int* offsets, int rows);
 };
 
 class P010Yuv420ToJpegREncoder {
@@ -23,6 +23,7 @@
 #endif
 #include <androidfw/ResourceTypes.h>
 #include <hwui/Canvas.h>
+#include <hwui/MinikinUtils.h>
 #include <hwui/Paint.h>
 #include <hwui/PaintFilter.h>
 #include <hwui/Typeface.h>
@@ -768,6 +769,7 @@ static void freeCaches(JNIEnv* env, jobject) {
 
 static void freeTextLayoutCaches(JNIEnv* env, jobject) {
     minikin::Layout::purgeCaches();
+    MinikinUtils::purgeCaches();
 }
 
 static void setCompatibilityVersion(JNIEnv* env, jobject, jint apiLevel) {
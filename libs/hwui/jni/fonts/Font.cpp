@@ -449,24 +449,14 @@ namespace fonts {
 std::shared_ptr<minikin::MinikinFont> createMinikinFontSkia(
         sk_sp<SkData>&& data, std::string_view fontPath, const void *fontPtr, size_t fontSize,
         int ttcIndex, const std::vector<minikin::FontVariation>& axes) {
-    FatVector<SkFontArguments::VariationPosition::Coordinate, 2> skVariation;
-    for (const auto& axis : axes) {
-        skVariation.push_back({axis.axisTag, axis.value});
-    }
-
-    std::unique_ptr<SkStreamAsset> fontData(new SkMemoryStream(std::move(data)));
-
-    SkFontArguments args;
-    args.setCollectionIndex(ttcIndex);
-    args.setVariationDesignPosition({skVariation.data(), static_cast<int>(skVariation.size())});
-
-    sk_sp<SkFontMgr> fm = android::FreeTypeFontMgr();
-    sk_sp<SkTypeface> face(fm->makeFromStream(std::move(fontData), args));
-    if (face == nullptr) {
+    // Only check that the file is a font here. Parsing it into an SkTypeface is left to the
+    // first draw or measurement, as preloading builds every system font and most are never used.
+    minikin::FontFileParser parser(fontPtr, fontSize, ttcIndex);
+    if (!parser.getFontRevision().has_value()) {
         return nullptr;
     }
-    return std::make_shared<MinikinFontSkia>(std::move(face), getNewSourceId(), fontPtr, fontSize,
-                                             fontPath, ttcIndex, axes);
+    return std::make_shared<MinikinFontSkia>(std::move(data), getNewSourceId(), fontPtr,
+                                             fontSize, fontPath, ttcIndex, axes);
 }
 
 int getNewSourceId() {
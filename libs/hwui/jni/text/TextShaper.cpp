@@ -32,9 +32,10 @@
 namespace android {
 
 struct LayoutWrapper {
-    LayoutWrapper(minikin::Layout&& layout, float ascent, float descent)
+    LayoutWrapper(std::shared_ptr<const minikin::Layout>&& layout, float ascent, float descent)
         : layout(std::move(layout)), ascent(ascent), descent(descent)  {}
-    minikin::Layout layout;
+    // Shared with other shapes and draws of the same run.
+    std::shared_ptr<const minikin::Layout> layout;
     float ascent;
     float descent;
 };
@@ -49,8 +50,9 @@ static jlong shapeTextRun(const uint16_t* text, int textSize, int start, int cou
 
     minikin::MinikinPaint minikinPaint = MinikinUtils::prepareMinikinPaint(&paint, typeface);
 
-    minikin::Layout layout = MinikinUtils::doLayout(&paint, bidiFlags, typeface,
-        text, textSize, start, count, contextStart, contextCount, nullptr);
+    std::shared_ptr<const minikin::Layout> sharedLayout = MinikinUtils::doCachedLayout(&paint,
+        bidiFlags, typeface, text, textSize, start, count, contextStart, contextCount, nullptr);
+    const minikin::Layout& layout = *sharedLayout;
 
     std::set<const minikin::Font*> seenFonts;
     float overallAscent = 0;
@@ -65,7 +67,7 @@ static jlong shapeTextRun(const uint16_t* text, int textSize, int start, int cou
     }
 
     std::unique_ptr<LayoutWrapper> ptr = std::make_unique<LayoutWrapper>(
-        std::move(layout), overallAscent, overallDescent
+        std::move(sharedLayout), overallAscent, overallDescent
     );
 
     return reinterpret_cast<jlong>(ptr.release());
@@ -105,13 +107,13 @@ static jlong TextShaper_shapeTextRunString(JNIEnv *env, jobject, jstring string,
 // CriticalNative
 static jint TextShaper_Result_getGlyphCount(CRITICAL_JNI_PARAMS_COMMA jlong ptr) {
     const LayoutWrapper* layout = reinterpret_cast<LayoutWrapper*>(ptr);
-    return layout->layout.nGlyphs();
+    return layout->layout->nGlyphs();
 }
 
 // CriticalNative
 static jfloat TextShaper_Result_getTotalAdvance(CRITICAL_JNI_PARAMS_COMMA jlong ptr) {
     const LayoutWrapper* layout = reinterpret_cast<LayoutWrapper*>(ptr);
-    return layout->layout.getAdvance();
+    return layout->layout->getAdvance();
 }
 
 // CriticalNative
@@ -129,49 +131,49 @@ static jfloat TextShaper_Result_getDescent(CRITICAL_JNI_PARAMS_COMMA jlong ptr)
 // CriticalNative
 static jint TextShaper_Result_getGlyphId(CRITICAL_JNI_PARAMS_COMMA jlong ptr, jint i) {
     const LayoutWrapper* layout = reinterpret_cast<LayoutWrapper*>(ptr);
-    return layout->layout.getGlyphId(i);
+    return layout->layout->getGlyphId(i);
 }
 
 // CriticalNative
 static jfloat TextShaper_Result_getX(CRITICAL_JNI_PARAMS_COMMA jlong ptr, jint i) {
     const LayoutWrapper* layout = reinterpret_cast<LayoutWrapper*>(ptr);
-    return layout->layout.getX(i);
+    return layout->layout->getX(i);
 }
 
 // CriticalNative
 static jfloat TextShaper_Result_getY(CRITICAL_JNI_PARAMS_COMMA jlong ptr, jint i) {
     const LayoutWrapper* layout = reinterpret_cast<LayoutWrapper*>(ptr);
-    return layout->layout.getY(i);
+    return layout->layout->getY(i);
 }
 
 // CriticalNative
 static jboolean TextShaper_Result_getFakeBold(CRITICAL_JNI_PARAMS_COMMA jlong ptr, jint i) {
     const LayoutWrapper* layout = reinterpret_cast<LayoutWrapper*>(ptr);
-    return layout->layout.getFakery(i).isFakeBold();
+    return layout->layout->getFakery(i).isFakeBold();
 }
 
 // CriticalNative
 static jboolean TextShaper_Result_getFakeItalic(CRITICAL_JNI_PARAMS_COMMA jlong ptr, jint i) {
     const LayoutWrapper* layout = reinterpret_cast<LayoutWrapper*>(ptr);
-    return layout->layout.getFakery(i).isFakeItalic();
+    return layout->layout->getFakery(i).isFakeItalic();
 }
 
 // CriticalNative
 static jfloat TextShaper_Result_getWeightOverride(CRITICAL_JNI_PARAMS_COMMA jlong ptr, jint i) {
     const LayoutWrapper* layout = reinterpret_cast<LayoutWrapper*>(ptr);
-    return layout->layout.getFakery(i).wghtAdjustment();
+    return layout->layout->getFakery(i).wghtAdjustment();
 }
 
 // CriticalNative
 static jfloat TextShaper_Result_getItalicOverride(CRITICAL_JNI_PARAMS_COMMA jlong ptr, jint i) {
     const LayoutWrapper* layout = reinterpret_cast<LayoutWrapper*>(ptr);
-    return layout->layout.getFakery(i).italAdjustment();
+    return layout->layout->getFakery(i).italAdjustment();
 }
 
 // CriticalNative
 static jlong TextShaper_Result_getFont(CRITICAL_JNI_PARAMS_COMMA jlong ptr, jint i) {
     const LayoutWrapper* layout = reinterpret_cast<LayoutWrapper*>(ptr);
-    std::shared_ptr<minikin::Font> fontRef = layout->layout.getFontRef(i);
+    std::shared_ptr<minikin::Font> fontRef = layout->layout->getFontRef(i);
     return reinterpret_cast<jlong>(new FontWrapper(std::move(fontRef)));
 }
 
@@ -68,13 +68,18 @@ void BackdropFilterDrawable::onDraw(SkCanvas* canvas) {
         return;
     }
 
-    auto backdropImage = surface->makeImageSnapshot();
     // sync necessary properties from target RenderNode.
-    if (!prepareToDraw(canvas, properties, backdropImage->width(), backdropImage->height())) {
+    if (!prepareToDraw(canvas, properties, surface->width(), surface->height())) {
         return;
     }
 
-    auto imageSubset = mImageSubset.roundOut();
+    // Only snapshot the region behind the target. A full snapshot would force a copy of the
+    // whole surface as soon as drawing continues into it.
+    auto backdropImage = surface->makeImageSnapshot(mImageSubset.roundOut());
+    if (!backdropImage) {
+        return;
+    }
+    auto imageSubset = SkIRect::MakeWH(backdropImage->width(), backdropImage->height());
 #ifdef __ANDROID__
     if (canvas->recordingContext()) {
         backdropImage =
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LayerSurfacePool.h"
+
+#include <SkCanvas.h>
+
+namespace android {
+namespace uirenderer {
+namespace skiapipeline {
+
+void LayerSurfacePool::setContext(GrRecordingContext* context) {
+    if (context != mContext) {
+        clear();
+        mContext = context;
+    }
+}
+
+sk_sp<SkSurface> LayerSurfacePool::acquire(GrRecordingContext* context, const SkImageInfo& info) {
+    if (context != mContext) {
+        mMisses++;
+        return nullptr;
+    }
+    // Prefer the most recently recycled match, its memory is the most likely to still be hot.
+    for (auto it = mEntries.rbegin(); it != mEntries.rend(); ++it) {
+        if (it->surface->imageInfo() == info) {
+            sk_sp<SkSurface> result = std::move(it->surface);
+            mBytes -= it->bytes;
+            mEntries.erase(std::next(it).base());
+            mHits++;
+            return result;
+        }
+    }
+    mMisses++;
+    return nullptr;
+}
+
+void LayerSurfacePool::recycle(sk_sp<SkSurface> surface) {
+    if (!surface || !surface->unique() || surface->recordingContext() != mContext ||
+        mMaxBytes == 0) {
+        return;
+    }
+    const size_t bytes = surface->imageInfo().computeMinByteSize();
+    if (bytes > mMaxBytes) {
+        return;
+    }
+    // The next owner starts from a clean canvas, whatever clip the last one left behind.
+    surface->getCanvas()->restoreToCount(1);
+    evictToFit(mMaxBytes - bytes);
+    mEntries.push_back({std::move(surface), bytes, systemTime(SYSTEM_TIME_MONOTONIC)});
+    mBytes += bytes;
+}
+
+void LayerSurfacePool::trim(nsecs_t maxIdle) {
+    const nsecs_t cutoff = systemTime(SYSTEM_TIME_MONOTONIC) - maxIdle;
+    size_t stale = 0;
+    while (stale < mEntries.size() && mEntries[stale].recycleTime < cutoff) {
+        mBytes -= mEntries[stale].bytes;
+        stale++;
+    }
+    mEntries.erase(mEntries.begin(), mEntries.begin() + stale);
+}
+
+void LayerSurfacePool::setMaxBytes(size_t maxBytes) {
+    mMaxBytes = maxBytes;
+    evictToFit(maxBytes);
+}
+
+void LayerSurfacePool::clear() {
+    mEntries.clear();
+    mBytes = 0;
+}
+
+void LayerSurfacePool::evictToFit(size_t maxBytes) {
+    size_t evicted = 0;
+    while (evicted < mEntries.size() && mBytes > maxBytes) {
+        mBytes -= mEntries[evicted].bytes;
+        evicted++;
+    }
+    mEntries.erase(mEntries.begin(), mEntries.begin() + evicted);
+}
+
+} /* namespace skiapipeline */
+} /* namespace uirenderer */
+} /* namespace android */
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <SkImageInfo.h>
+#include <SkRefCnt.h>
+#include <SkSurface.h>
+#include <utils/RefBase.h>
+#include <utils/Timers.h>
+
+#include <vector>
+
+class GrRecordingContext;
+
+namespace android {
+namespace uirenderer {
+namespace skiapipeline {
+
+/**
+ * Keeps the surfaces of recently resized or destroyed RenderNode layers so that the next layer
+ * of the same size takes one over instead of allocating a new render target. Layer sizes are
+ * already rounded up to LAYER_SIZE, so animations that resize a layer keep hitting the same few
+ * sizes.
+ *
+ * Surfaces are matched on their exact image info, and only surfaces of the current context are
+ * taken in. The pool holds at most maxBytes worth of surfaces and gives up the least recently
+ * recycled ones first.
+ *
+ * Must only be used on the RenderThread.
+ */
+class LayerSurfacePool : public VirtualLightRefBase {
+public:
+    explicit LayerSurfacePool(size_t maxBytes) : mMaxBytes(maxBytes) {}
+
+    // Sets the context new surfaces are created on. Surfaces of any previous context are dropped.
+    void setContext(GrRecordingContext* context);
+
+    // Returns a pooled surface created on context with the given info, or nullptr
+    sk_sp<SkSurface> acquire(GrRecordingContext* context, const SkImageInfo& info);
+
+    // Takes a layer surface that is no longer used. Surfaces that are still referenced elsewhere
+    // or that belong to another context are left alone.
+    void recycle(sk_sp<SkSurface> surface);
+
+    // Drops surfaces that have not been reused within maxIdle of being recycled
+    void trim(nsecs_t maxIdle);
+
+    void setMaxBytes(size_t maxBytes);
+
+    // Drops every pooled surface
+    void clear();
+
+    size_t getEntryCount() const { return mEntries.size(); }
+    size_t getBytes() const { return mBytes; }
+    uint32_t getHitCount() const { return mHits; }
+    uint32_t getMissCount() const { return mMisses; }
+
+private:
+    struct Entry {
+        sk_sp<SkSurface> surface;
+        size_t bytes;
+        nsecs_t recycleTime;
+    };
+
+    void evictToFit(size_t maxBytes);
+
+    GrRecordingContext* mContext = nullptr;
+    // Oldest first
+    std::vector<Entry> mEntries;
+    size_t mMaxBytes;
+    size_t mBytes = 0;
+    uint32_t mHits = 0;
+    uint32_t mMisses = 0;
+};
+
+} /* namespace skiapipeline */
+} /* namespace uirenderer */
+} /* namespace android */
@@ -21,9 +21,11 @@
 #include <include/gpu/ganesh/GrDirectContext.h>
 #include <log/log.h>
 #include <openssl/sha.h>
+#include <unistd.h>
 
 #include <algorithm>
 #include <array>
+#include <future>
 #include <mutex>
 #include <thread>
 
@@ -89,20 +91,87 @@ void ShaderCache::initShaderDiskCache(const void* identity, ssize_t size) {
     // or snapshot migration. Also, program binaries may not work well on some
     // desktop / laptop GPUs. Thus, disable the shader disk cache for emulator builds.
     if (!Properties::runningInEmulator && mFilename.length() > 0) {
-        mBlobCache.reset(new FileBlobCache(maxKeySize, maxValueSize, maxTotalSize, mFilename));
-        validateCache(identity, size);
-        mInitialized = true;
-        if (identity != nullptr && size > 0 && mIDHash.size()) {
-            set(&sIDKey, sizeof(sIDKey), mIDHash.data(), mIDHash.size());
+        if (mPendingLoad.valid()) {
+            // The previous load is superseded, the file is read again below.
+            mPendingLoad.wait();
+        }
+        mBlobCache.reset();
+        if (identity != nullptr && size > 0) {
+            const uint8_t* bytes = static_cast<const uint8_t*>(identity);
+            mPendingIdentity.assign(bytes, bytes + size);
+            mPendingIdentitySize = size;
+        } else {
+            mPendingIdentity.clear();
+            mPendingIdentitySize = identity == nullptr ? size : -1;
         }
+        mPendingLoad = std::async(std::launch::async, [filename = mFilename]() {
+            ATRACE_NAME("ShaderCache::readFromDisk");
+            return std::make_unique<FileBlobCache>(maxKeySize, maxValueSize, maxTotalSize,
+                                                   filename);
+        });
+        mInitialized = true;
     }
 }
 
+void ShaderCache::finishLoadLocked() {
+    if (!mPendingLoad.valid()) {
+        return;
+    }
+    ATRACE_NAME("ShaderCache::finishLoad");
+    mBlobCache = mPendingLoad.get();
+
+    const bool hasIdentity = !mPendingIdentity.empty();
+    const void* identity = hasIdentity ? mPendingIdentity.data() : nullptr;
+    if (!validateCache(identity, mPendingIdentitySize) && hasIdentity) {
+        prewarmLocked();
+    }
+    if (hasIdentity && mIDHash.size()) {
+        set(&sIDKey, sizeof(sIDKey), mIDHash.data(), mIDHash.size());
+    }
+    mPendingIdentity.clear();
+    mPendingIdentitySize = 0;
+}
+
 void ShaderCache::setFilename(const char* filename) {
     std::lock_guard lock(mMutex);
     mFilename = filename;
 }
 
+void ShaderCache::setPrewarmFilename(const char* filename) {
+    std::lock_guard lock(mMutex);
+    mPrewarmFilename = filename;
+}
+
+void ShaderCache::prewarmLocked() {
+    if (mPrewarmFilename.empty() || mIDHash.empty() ||
+        access(mPrewarmFilename.c_str(), R_OK) != 0) {
+        return;
+    }
+    ATRACE_NAME("ShaderCache::prewarm");
+
+    FileBlobCache prewarmCache(maxKeySize, maxValueSize, maxTotalSize, mPrewarmFilename);
+    std::array<uint8_t, SHA256_DIGEST_LENGTH> hash;
+    auto key = sIDKey;
+    auto loaded = prewarmCache.get(&key, sizeof(key), hash.data(), hash.size());
+    if (loaded != hash.size() || !std::equal(hash.begin(), hash.end(), mIDHash.begin())) {
+        if (CC_UNLIKELY(Properties::debugLevel & kDebugCaches)) {
+            ALOGW("ShaderCache::prewarm cache was built for a different identity");
+        }
+        return;
+    }
+
+    const size_t flattenedSize = prewarmCache.getFlattenedSize();
+    std::vector<uint8_t> buffer(flattenedSize);
+    if (prewarmCache.flatten(buffer.data(), flattenedSize) != 0 ||
+        mBlobCache->unflatten(buffer.data(), flattenedSize) != 0) {
+        ALOGW("ShaderCache::prewarm failed to copy %s", mPrewarmFilename.c_str());
+        mBlobCache->clear();
+        return;
+    }
+    // Write the seeded contents out with the next save, so the prewarm file is only read once.
+    mCacheDirty = true;
+}
+
 sk_sp<SkData> ShaderCache::load(const SkData& key) {
     ATRACE_NAME("ShaderCache::load");
     size_t keySize = key.size();
@@ -110,6 +179,7 @@ sk_sp<SkData> ShaderCache::load(const SkData& key) {
     if (!mInitialized) {
         return nullptr;
     }
+    finishLoadLocked();
 
     // mObservedBlobValueSize is reasonably big to avoid memory reallocation
     // Allocate a buffer with malloc. SkData takes ownership of that allocation and will call free.
@@ -177,6 +247,9 @@ void ShaderCache::set(const void* key, size_t keySize, const void* value, size_t
 
 void ShaderCache::saveToDiskLocked() {
     ATRACE_NAME("ShaderCache::saveToDiskLocked");
+    if (mInitialized) {
+        finishLoadLocked();
+    }
     if (mInitialized && mBlobCache) {
         // The most straightforward way to make ownership shared
         mMutex.unlock();
@@ -196,6 +269,7 @@ void ShaderCache::store(const SkData& key, const SkData& data, const SkString& /
     if (!mInitialized) {
         return;
     }
+    finishLoadLocked();
 
     size_t valueSize = data.size();
     size_t keySize = key.size();
@@ -23,6 +23,7 @@
 #include <include/gpu/ganesh/GrContextOptions.h>
 #include <utils/Mutex.h>
 
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
@@ -46,14 +47,18 @@ public:
     static ShaderCache& get();
 
     /**
-     * initShaderDiskCache" loads the serialized cache contents from disk,
-     * optionally checks that the on-disk cache matches a provided identity,
+     * initShaderDiskCache" starts loading the serialized cache contents from
+     * disk, optionally checks that the on-disk cache matches a provided identity,
      * and puts the ShaderCache into an initialized state, such that it is
      * able to insert and retrieve entries from the cache. If identity is
      * non-null and validation fails, the cache is initialized but contains
      * no data. If size is less than zero, the cache is initialized but
      * contains no data.
      *
+     * The file is read on a background thread, so that it overlaps with the
+     * creation of the GPU context. The first cache operation waits for the
+     * read to complete.
+     *
      * This should be called when HWUI pipeline is initialized. When not in
      * the initialized state the load and store methods will return without
      * performing any cache operations.
@@ -69,6 +74,14 @@ public:
      */
     virtual void setFilename(const char* filename);
 
+    /**
+     * "setPrewarmFilename" sets the name of a read-only cache file, such as one precompiled
+     * and shipped with the system image. When the cache file is missing or fails validation,
+     * "initShaderDiskCache" seeds the cache with the contents of the prewarm file if it was
+     * built for the same identity. It should be invoked before "initShaderCache".
+     */
+    virtual void setPrewarmFilename(const char* filename);
+
     /**
      * "load" attempts to retrieve the value blob associated with a given key
      * blob from cache.  This will be called by Skia, when it needs to compile a new SKSL shader.
@@ -102,6 +115,18 @@ private:
      */
     bool validateCache(const void* identity, ssize_t size) REQUIRES(mMutex);
 
+    /**
+     * "prewarmLocked" fills the empty cache with the contents of the prewarm file, if that
+     * file matches the current identity hash.
+     */
+    void prewarmLocked() REQUIRES(mMutex);
+
+    /**
+     * "finishLoadLocked" waits for the load started by "initShaderDiskCache", if any, and
+     * validates the loaded cache against the identity that was passed to it.
+     */
+    void finishLoadLocked() REQUIRES(mMutex);
+
     /**
      * Helper for BlobCache::set to trace the result and ensure the identity hash
      * does not get evicted.
@@ -132,6 +157,20 @@ private:
      */
     std::unique_ptr<FileBlobCache> mBlobCache GUARDED_BY(mMutex);
 
+    /**
+     * "mPendingLoad" holds the cache being read from disk by "initShaderDiskCache". It is
+     * moved into mBlobCache by "finishLoadLocked".
+     */
+    std::future<std::unique_ptr<FileBlobCache>> mPendingLoad GUARDED_BY(mMutex);
+
+    /**
+     * "mPendingIdentity" and "mPendingIdentitySize" hold the identity that the pending load is
+     * validated against. mPendingIdentitySize keeps the size passed to "initShaderDiskCache" when
+     * no identity bytes were copied, so that invalid identities are still detected.
+     */
+    std::vector<uint8_t> mPendingIdentity GUARDED_BY(mMutex);
+    ssize_t mPendingIdentitySize GUARDED_BY(mMutex) = 0;
+
     /**
      * "mFilename" is the name of the file for storing cache contents in between
      * program invocations.  It is initialized to an empty string at
@@ -141,6 +180,12 @@ private:
      */
     std::string mFilename GUARDED_BY(mMutex);
 
+    /**
+     * "mPrewarmFilename" is the name of the read-only file used to seed an empty cache. An
+     * empty string disables prewarming.
+     */
+    std::string mPrewarmFilename GUARDED_BY(mMutex) = "/system/etc/hwui/shader_cache";
+
     /**
      * "mIDHash" is the current identity hash for the cache validation. It is
      * initialized to an empty vector at construction time, and its content is
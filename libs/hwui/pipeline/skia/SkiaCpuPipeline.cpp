@@ -97,7 +97,7 @@ Frame SkiaCpuPipeline::getFrame() {
 }
 
 IRenderPipeline::DrawResult SkiaCpuPipeline::draw(
-        const Frame& frame, const SkRect& screenDirty, const SkRect& dirty,
+        const Frame& frame, const DamageRegion& screenDirty, const DamageRegion& dirty,
         const LightGeometry& lightGeometry, LayerUpdateQueue* layerUpdateQueue,
         const Rect& contentDrawBounds, bool opaque, const LightInfo& lightInfo,
         const std::vector<sp<RenderNode>>& renderNodes, FrameInfoVisualizer* profiler,
@@ -43,16 +43,21 @@ public:
     renderthread::MakeCurrentResult makeCurrent() override;
     renderthread::Frame getFrame() override;
     renderthread::IRenderPipeline::DrawResult draw(
-            const renderthread::Frame& frame, const SkRect& screenDirty, const SkRect& dirty,
-            const LightGeometry& lightGeometry, LayerUpdateQueue* layerUpdateQueue,
+            const renderthread::Frame& frame, const DamageRegion& screenDirty,
+            const DamageRegion& dirty, const LightGeometry& lightGeometry,
+            LayerUpdateQueue* layerUpdateQueue,
             const Rect& contentDrawBounds, bool opaque, const LightInfo& lightInfo,
             const std::vector<sp<RenderNode>>& renderNodes, FrameInfoVisualizer* profiler,
             const renderthread::HardwareBufferRenderParams& bufferParams,
             std::mutex& profilerLock) override;
     bool swapBuffers(const renderthread::Frame& frame, IRenderPipeline::DrawResult& drawResult,
-                     const SkRect& screenDirty, FrameInfo* currentFrameInfo,
+                     const DamageRegion& screenDirty, FrameInfo* currentFrameInfo,
                      bool* requireSwap) override {
-        return false;
+        // The surface wraps the buffer's pixels directly, so the frame is complete once drawn.
+        // Reporting it as swapped lets the jank tracker and frame metrics observers see it.
+        currentFrameInfo->markSwapBuffers();
+        *requireSwap = true;
+        return true;
     }
     DeferredLayerUpdater* createTextureLayer() override { return nullptr; }
     bool setSurface(ANativeWindow* surface, renderthread::SwapBehavior swapBehavior) override;
@@ -23,6 +23,7 @@
 #include "FunctorDrawable.h" // Must be included before DumpOpsCanvas.h
 #include "DumpOpsCanvas.h"
 // clang-format on
+#include "Properties.h"
 #include "SkiaPipeline.h"
 #include "TreeInfo.h"
 #include "VectorDrawable.h"
@@ -56,6 +57,18 @@ bool SkiaDisplayList::reuseDisplayList(RenderNode* node) {
     return true;
 }
 
+static bool isSelfContained(const SkiaDisplayList& displayList) {
+    return displayList.mChildNodes.empty() && displayList.mChildFunctors.empty() &&
+           displayList.mMutableImages.empty() && displayList.mMeshBufferData.empty() &&
+           displayList.mMutableBitmapShaderImages.empty() && !displayList.hasVectorDrawables() &&
+           displayList.mAnimatedImages.empty() && !displayList.containsProjectionReceiver();
+}
+
+bool SkiaDisplayList::hasSameContent(const SkiaDisplayList& other) const {
+    return isSelfContained(*this) && isSelfContained(other) && !mHasHolePunches &&
+           !other.mHasHolePunches && mDisplayList.contentEquals(other.mDisplayList);
+}
+
 void SkiaDisplayList::updateChildren(std::function<void(RenderNode*)> updateFn) {
     for (auto& child : mChildNodes) {
         updateFn(child.getRenderNode());
@@ -141,7 +154,7 @@ bool SkiaDisplayList::prepareListAndChildren(
     for (auto& animatedImage : mAnimatedImages) {
         nsecs_t timeTilNextFrame = TreeInfo::Out::kNoAnimatedImageDelay;
         // If any animated image in the display list needs updated, then damage the node.
-        if (animatedImage->isDirty(&timeTilNextFrame)) {
+        if (animatedImage->isDirty(&timeTilNextFrame, info.frameVsyncTime)) {
             isDirty = true;
         }
 
@@ -154,18 +167,24 @@ bool SkiaDisplayList::prepareListAndChildren(
         }
     }
 
+    const bool useAtlas = Properties::enableVectorDrawableAtlas;
     for (auto& [vectorDrawable, cachedMatrix] : mVectorDrawables) {
+        const bool vdDirty = vectorDrawable->isDirty();
+        if (!vdDirty && !useAtlas) continue;
+        Matrix4 totalMatrix;
+        info.damageAccumulator->computeCurrentTransform(&totalMatrix);
+        Matrix4 canvasMatrix(cachedMatrix);
+        totalMatrix.multiply(canvasMatrix);
+        const SkRect& bounds = vectorDrawable->properties().getBounds();
+        if (!intersects(info.screenSize, totalMatrix, bounds)) continue;
         // If any vector drawable in the display list needs update, damage the node.
-        if (vectorDrawable->isDirty()) {
-            Matrix4 totalMatrix;
-            info.damageAccumulator->computeCurrentTransform(&totalMatrix);
-            Matrix4 canvasMatrix(cachedMatrix);
-            totalMatrix.multiply(canvasMatrix);
-            const SkRect& bounds = vectorDrawable->properties().getBounds();
-            if (intersects(info.screenSize, totalMatrix, bounds)) {
-                isDirty = true;
-                vectorDrawable->setPropertyChangeWillBeConsumed(true);
-            }
+        if (vdDirty) {
+            isDirty = true;
+            vectorDrawable->setPropertyChangeWillBeConsumed(true);
+        }
+        // Caches in the atlas are rasterized before the frame is drawn
+        if (useAtlas) {
+            info.canvasContext.queueVectorDrawableUpdate(vectorDrawable);
         }
     }
     return isDirty;
@@ -69,6 +69,14 @@ public:
      */
     void reset();
 
+    /**
+     * Trims the op storage down to what the recorded ops use. Called for lists that have not been
+     * re-recorded for a while, since their storage otherwise stays at the peak recording size.
+     *
+     * @return the number of bytes freed
+     */
+    size_t compact() { return mDisplayList.shrinkToFit(); }
+
     /**
      * Use the linear allocator to create any SkDrawables needed by the display
      * list. This could be dangerous as these objects are ref-counted, so we
@@ -99,6 +107,13 @@ public:
 
     bool hasFill() const { return mDisplayList.hasFill(); }
 
+    /**
+     * Returns true if this list and other draw the same content, so that either one can be kept.
+     * Lists that reference children, functors, mutable images, meshes, vector drawables or
+     * animated images always compare unequal, because those can change without re-recording.
+     */
+    bool hasSameContent(const SkiaDisplayList& other) const;
+
     /**
      * Attempts to reset and reuse this DisplayList.
      *
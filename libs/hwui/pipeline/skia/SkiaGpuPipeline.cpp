@@ -83,10 +83,15 @@ bool SkiaGpuPipeline::createOrUpdateLayer(RenderNode* node,
                                  kPremul_SkAlphaType, getSurfaceColorSpace());
         SkSurfaceProps props(0, kUnknown_SkPixelGeometry);
         SkASSERT(mRenderThread.getGrContext() != nullptr);
-        node->setLayerSurface(SkSurfaces::RenderTarget(mRenderThread.getGrContext(),
-                                                       skgpu::Budgeted::kYes, info, 0,
-                                                       this->getSurfaceOrigin(), &props));
+        sp<LayerSurfacePool> pool = mRenderThread.cacheManager().layerSurfacePool();
+        sk_sp<SkSurface> surface = pool->acquire(mRenderThread.getGrContext(), info);
+        if (!surface) {
+            surface = SkSurfaces::RenderTarget(mRenderThread.getGrContext(), skgpu::Budgeted::kYes,
+                                               info, 0, this->getSurfaceOrigin(), &props);
+        }
+        node->setLayerSurface(std::move(surface));
         if (node->getLayerSurface()) {
+            node->getSkiaLayer()->surfacePool = std::move(pool);
             // update the transform in window of the layer to reset its origin wrt light source
             // position
             Matrix4 windowTransform;
@@ -17,7 +17,9 @@
 #pragma once
 
 #include <SkSurface.h>
+#include "LayerSurfacePool.h"
 #include "Matrix.h"
+#include "MemoryAttribution.h"
 
 namespace android {
 namespace uirenderer {
@@ -27,9 +29,23 @@ namespace skiapipeline {
  * An offscreen rendering target used to contain the contents a RenderNode.
  */
 struct SkiaLayer {
+    ~SkiaLayer() { recycleSurface(); }
+
+    // Hands layerSurface back to the pool it was created for, if any
+    void recycleSurface() {
+        if (surfacePool) {
+            surfacePool->recycle(std::move(layerSurface));
+        }
+        layerSurface.reset();
+    }
+
     sk_sp<SkSurface> layerSurface;
     Matrix4 inverseTransformInWindow;
     bool hasRenderedSinceRepaint = false;
+    // Charges layerSurface to the CanvasContext that created it
+    MemoryTag memoryTag;
+    // Where layerSurface goes once the layer is resized or destroyed
+    sp<LayerSurfacePool> surfacePool;
 };
 
 } /* namespace skiapipeline */
@@ -114,13 +114,15 @@ Frame SkiaOpenGLPipeline::getFrame() {
 }
 
 IRenderPipeline::DrawResult SkiaOpenGLPipeline::draw(
-        const Frame& frame, const SkRect& screenDirty, const SkRect& dirty,
+        const Frame& frame, const DamageRegion& screenDirty, const DamageRegion& dirty,
         const LightGeometry& lightGeometry, LayerUpdateQueue* layerUpdateQueue,
         const Rect& contentDrawBounds, bool opaque, const LightInfo& lightInfo,
         const std::vector<sp<RenderNode>>& renderNodes, FrameInfoVisualizer* profiler,
         const HardwareBufferRenderParams& bufferParams, std::mutex& profilerLock) {
     if (!isCapturingSkp() && !mHardwareBuffer) {
-        mEglManager.damageFrame(frame, dirty);
+        // The buffer damage stays a single rect, as display lists may reset the clip back to
+        // the bounds of the dirty region. Only the swap reports the individual rects.
+        mEglManager.damageFrame(frame, dirty.bounds());
     }
 
     SkColorType colorType = getSurfaceColorType();
@@ -192,7 +194,7 @@ IRenderPipeline::DrawResult SkiaOpenGLPipeline::draw(
 }
 
 bool SkiaOpenGLPipeline::swapBuffers(const Frame& frame, IRenderPipeline::DrawResult& drawResult,
-                                     const SkRect& screenDirty, FrameInfo* currentFrameInfo,
+                                     const DamageRegion& screenDirty, FrameInfo* currentFrameInfo,
                                      bool* requireSwap) {
     GL_CHECKPOINT(LOW);
 
@@ -30,6 +30,7 @@
 #include <SkPictureRecorder.h>
 #include <SkRect.h>
 #include <SkRefCnt.h>
+#include <SkRegion.h>
 #include <SkSerialProcs.h>
 #include <SkStream.h>
 #include <SkString.h>
@@ -105,6 +106,9 @@ bool SkiaPipeline::renderLayerImpl(RenderNode* layerNode, const Rect& layerDamag
     const RenderProperties& properties = layerNode->properties();
     const SkRect bounds = SkRect::MakeWH(properties.getWidth(), properties.getHeight());
     if (properties.getClipToBounds() && layerCanvas->quickReject(bounds)) {
+        // Leave the layer canvas and the light center as we found them.
+        layerCanvas->restoreToCount(saveCount);
+        LightingInfo::setLightCenterRaw(savedLightCenter);
         return false;
     }
 
@@ -346,7 +350,7 @@ void SkiaPipeline::endCapture(SkSurface* surface) {
     }
 }
 
-void SkiaPipeline::renderFrame(const LayerUpdateQueue& layers, const SkRect& clip,
+void SkiaPipeline::renderFrame(const LayerUpdateQueue& layers, const DamageRegion& clip,
                                const std::vector<sp<RenderNode>>& nodes, bool opaque,
                                const Rect& contentDrawBounds, sk_sp<SkSurface> surface,
                                const SkMatrix& preTransform) {
@@ -380,12 +384,12 @@ static Rect nodeBounds(RenderNode& node) {
 }
 }  // namespace
 
-void SkiaPipeline::renderFrameImpl(const SkRect& clip,
+void SkiaPipeline::renderFrameImpl(const DamageRegion& clip,
                                    const std::vector<sp<RenderNode>>& nodes, bool opaque,
                                    const Rect& contentDrawBounds, SkCanvas* canvas,
                                    const SkMatrix& preTransform) {
     SkAutoCanvasRestore saver(canvas, true);
-    auto clipRestriction = preTransform.mapRect(clip).roundOut();
+    auto clipRestriction = preTransform.mapRect(clip.bounds()).roundOut();
     if (CC_UNLIKELY(isCapturingSkp())) {
         canvas->drawAnnotation(SkRect::Make(clipRestriction), "AndroidDeviceClipRestriction",
             nullptr);
@@ -393,6 +397,14 @@ void SkiaPipeline::renderFrameImpl(const SkRect& clip,
         // clip drawing to dirty region only when not recording SKP files (which should contain all
         // draw ops on every frame)
         canvas->androidFramework_setDeviceClipRestriction(clipRestriction);
+        if (clip.count() > 1) {
+            // Skip the undamaged area between disjoint dirty rects
+            SkRegion clipRegion;
+            for (const SkRect& rect : clip) {
+                clipRegion.op(preTransform.mapRect(rect).roundOut(), SkRegion::kUnion_Op);
+            }
+            canvas->clipRegion(clipRegion);
+        }
     }
     canvas->concat(preTransform);
 
@@ -563,7 +575,7 @@ static const SkColor kOverdrawColors[2][6] = {
     },
 };
 
-void SkiaPipeline::renderOverdraw(const SkRect& clip,
+void SkiaPipeline::renderOverdraw(const DamageRegion& clip,
                                   const std::vector<sp<RenderNode>>& nodes,
                                   const Rect& contentDrawBounds, sk_sp<SkSurface> surface,
                                   const SkMatrix& preTransform) {
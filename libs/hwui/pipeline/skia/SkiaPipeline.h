@@ -20,6 +20,7 @@
 #include <SkDocument.h>
 #include <SkSurface.h>
 
+#include "DamageRegion.h"
 #include "Lighting.h"
 #include "hwui/AnimatedImageDrawable.h"
 #include "renderthread/CanvasContext.h"
@@ -48,7 +49,7 @@ public:
     SkColorType getSurfaceColorType() const override { return mSurfaceColorType; }
     sk_sp<SkColorSpace> getSurfaceColorSpace() override { return mSurfaceColorSpace; }
 
-    void renderFrame(const LayerUpdateQueue& layers, const SkRect& clip,
+    void renderFrame(const LayerUpdateQueue& layers, const DamageRegion& clip,
                      const std::vector<sp<RenderNode>>& nodes, bool opaque,
                      const Rect& contentDrawBounds, sk_sp<SkSurface> surface,
                      const SkMatrix& preTransform);
@@ -80,7 +81,7 @@ protected:
     bool isCapturingSkp() const { return mCaptureMode != CaptureMode::None; }
 
 private:
-    void renderFrameImpl(const SkRect& clip,
+    void renderFrameImpl(const DamageRegion& clip,
                          const std::vector<sp<RenderNode>>& nodes, bool opaque,
                          const Rect& contentDrawBounds, SkCanvas* canvas,
                          const SkMatrix& preTransform);
@@ -89,7 +90,7 @@ private:
      *  Debugging feature.  Draws a semi-transparent overlay on each pixel, indicating
      *  how many times it has been drawn.
      */
-    void renderOverdraw(const SkRect& clip,
+    void renderOverdraw(const DamageRegion& clip,
                         const std::vector<sp<RenderNode>>& nodes, const Rect& contentDrawBounds,
                         sk_sp<SkSurface> surface, const SkMatrix& preTransform);
 
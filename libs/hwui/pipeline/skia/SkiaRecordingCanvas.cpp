@@ -346,6 +346,14 @@ void SkiaRecordingCanvas::drawMesh(const Mesh& mesh, sk_sp<SkBlender> blender, c
     mRecorder.drawMesh(mesh, blender, paint);
 }
 
+void SkiaRecordingCanvas::drawMeshInstanced(const Mesh& mesh, sk_sp<SkBlender> blender,
+                                            const Paint& paint, const SkMatrix transforms[],
+                                            const SkColor colors[], int count) {
+    if (count <= 0) return;
+    mDisplayList->mMeshBufferData.push_back(mesh.refBufferData());
+    mRecorder.drawMeshInstanced(mesh, blender, paint, transforms, colors, count);
+}
+
 }  // namespace skiapipeline
 }  // namespace uirenderer
 }  // namespace android
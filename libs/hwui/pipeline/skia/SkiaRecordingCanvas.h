@@ -82,6 +82,9 @@ public:
 
     virtual void enableZ(bool enableZ) override;
     virtual void drawMesh(const Mesh& mesh, sk_sp<SkBlender> blender, const Paint& paint) override;
+    virtual void drawMeshInstanced(const Mesh& mesh, sk_sp<SkBlender> blender, const Paint& paint,
+                                   const SkMatrix transforms[], const SkColor colors[],
+                                   int count) override;
     virtual void drawLayer(uirenderer::DeferredLayerUpdater* layerHandle) override;
     virtual void drawRenderNode(uirenderer::RenderNode* renderNode) override;
 
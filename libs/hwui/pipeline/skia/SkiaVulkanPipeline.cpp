@@ -72,7 +72,7 @@ Frame SkiaVulkanPipeline::getFrame() {
 }
 
 IRenderPipeline::DrawResult SkiaVulkanPipeline::draw(
-        const Frame& frame, const SkRect& screenDirty, const SkRect& dirty,
+        const Frame& frame, const DamageRegion& screenDirty, const DamageRegion& dirty,
         const LightGeometry& lightGeometry, LayerUpdateQueue* layerUpdateQueue,
         const Rect& contentDrawBounds, bool opaque, const LightInfo& lightInfo,
         const std::vector<sp<RenderNode>>& renderNodes, FrameInfoVisualizer* profiler,
@@ -128,7 +128,7 @@ IRenderPipeline::DrawResult SkiaVulkanPipeline::draw(
 }
 
 bool SkiaVulkanPipeline::swapBuffers(const Frame& frame, IRenderPipeline::DrawResult& drawResult,
-                                     const SkRect& screenDirty, FrameInfo* currentFrameInfo,
+                                     const DamageRegion& screenDirty, FrameInfo* currentFrameInfo,
                                      bool* requireSwap) {
     // Even if we decided to cancel the frame, from the perspective of jank
     // metrics the frame was swapped at this point
@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "VectorDrawableAtlas.h"
+
+#include <SkCanvas.h>
+#include <SkImageInfo.h>
+#include <include/gpu/ganesh/SkSurfaceGanesh.h>
+
+#include <gui/TraceUtils.h>
+
+namespace android {
+namespace uirenderer {
+namespace skiapipeline {
+
+int VectorDrawableAtlas::cellSize(int size) {
+    const int padded = size + 2 * kPadding;
+    return (padded + kCellAlignment - 1) / kCellAlignment * kCellAlignment;
+}
+
+bool VectorDrawableAtlas::prepareForDraw(GrRecordingContext* context) {
+    applyPendingReleases();
+    mFrame++;
+    // Drop the last frame's snapshot, so drawing into the atlas doesn't have to copy it
+    mImage = nullptr;
+    if (mSurface && mSurface->recordingContext() != context) {
+        clear();
+    }
+    if (!mSurface) {
+        ATRACE_NAME("VectorDrawableAtlas create");
+        SkImageInfo info = SkImageInfo::MakeN32(kAtlasSize, kAtlasSize, kPremul_SkAlphaType);
+        mSurface = SkSurfaces::RenderTarget(context, skgpu::Budgeted::kYes, info);
+        if (!mSurface) {
+            return false;
+        }
+        mSurface->getCanvas()->clear(SK_ColorTRANSPARENT);
+    }
+    return true;
+}
+
+SkIRect VectorDrawableAtlas::entryRect(const Location& location) const {
+    const Shelf& shelf = mShelves[location.shelf];
+    return SkIRect::MakeXYWH(location.cell * shelf.cellWidth + kPadding, shelf.y + kPadding,
+                             shelf.cellWidth - 2 * kPadding, shelf.cellHeight - 2 * kPadding);
+}
+
+bool VectorDrawableAtlas::acquireEntry(uint64_t* key, int width, int height, Entry* outEntry) {
+    if (!mSurface) {
+        return false;
+    }
+    SkIRect rect;
+    if (getEntry(*key, width, height, &rect)) {
+        *outEntry = {rect, false};
+        return true;
+    }
+    // A cache that changed size moves to another cell
+    freeEntry(*key);
+    *key = kInvalidKey;
+    if (width > kMaxEntrySize || height > kMaxEntrySize) {
+        return false;
+    }
+
+    Location location;
+    if (!allocateCell(cellSize(width), cellSize(height), &location)) {
+        return false;
+    }
+    location.lastUsedFrame = mFrame;
+    *key = mNextKey++;
+    mShelves[location.shelf].cells[location.cell] = *key;
+    mEntries[*key] = location;
+    rect = entryRect(location);
+    *outEntry = {SkIRect::MakeXYWH(rect.x(), rect.y(), width, height), true};
+    return true;
+}
+
+bool VectorDrawableAtlas::getEntry(uint64_t key, int width, int height, SkIRect* outRect) {
+    auto it = mEntries.find(key);
+    if (it == mEntries.end()) {
+        return false;
+    }
+    const Shelf& shelf = mShelves[it->second.shelf];
+    if (shelf.cellWidth != cellSize(width) || shelf.cellHeight != cellSize(height)) {
+        return false;
+    }
+    it->second.lastUsedFrame = mFrame;
+    const SkIRect rect = entryRect(it->second);
+    *outRect = SkIRect::MakeXYWH(rect.x(), rect.y(), width, height);
+    return true;
+}
+
+bool VectorDrawableAtlas::allocateCell(int cellWidth, int cellHeight, Location* outLocation) {
+    // A free cell in a shelf of the same size
+    for (int i = 0; i < static_cast<int>(mShelves.size()); i++) {
+        const Shelf& shelf = mShelves[i];
+        if (shelf.cellWidth != cellWidth || shelf.cellHeight != cellHeight) continue;
+        for (int cell = 0; cell < static_cast<int>(shelf.cells.size()); cell++) {
+            if (shelf.cells[cell] == kInvalidKey) {
+                *outLocation = {i, cell, 0};
+                return true;
+            }
+        }
+    }
+
+    // A new shelf
+    if (mNextShelfY + cellHeight <= kAtlasSize) {
+        mShelves.push_back({mNextShelfY, cellHeight, cellWidth, cellHeight,
+                            std::vector<uint64_t>(kAtlasSize / cellWidth, kInvalidKey)});
+        mNextShelfY += cellHeight;
+        *outLocation = {static_cast<int>(mShelves.size()) - 1, 0, 0};
+        return true;
+    }
+
+    // The least recently used cell of the same size. Cells used this frame are still needed.
+    int64_t oldestFrame = mFrame;
+    for (int i = 0; i < static_cast<int>(mShelves.size()); i++) {
+        const Shelf& shelf = mShelves[i];
+        if (shelf.cellWidth != cellWidth || shelf.cellHeight != cellHeight) continue;
+        for (int cell = 0; cell < static_cast<int>(shelf.cells.size()); cell++) {
+            if (shelf.cells[cell] == kInvalidKey) continue;
+            const int64_t lastUsed = mEntries[shelf.cells[cell]].lastUsedFrame;
+            if (lastUsed < oldestFrame) {
+                oldestFrame = lastUsed;
+                *outLocation = {i, cell, 0};
+            }
+        }
+    }
+    if (oldestFrame < mFrame) {
+        freeEntry(mShelves[outLocation->shelf].cells[outLocation->cell]);
+        return true;
+    }
+
+    // The smallest shelf that is tall enough and no longer used this frame
+    int bestShelf = -1;
+    for (int i = 0; i < static_cast<int>(mShelves.size()); i++) {
+        const Shelf& shelf = mShelves[i];
+        if (shelf.height < cellHeight) continue;
+        if (bestShelf >= 0 && shelf.height >= mShelves[bestShelf].height) continue;
+        bool inUse = false;
+        for (uint64_t key : shelf.cells) {
+            if (key != kInvalidKey && mEntries[key].lastUsedFrame == mFrame) {
+                inUse = true;
+                break;
+            }
+        }
+        if (!inUse) bestShelf = i;
+    }
+    if (bestShelf < 0) {
+        return false;
+    }
+    Shelf& shelf = mShelves[bestShelf];
+    evictShelf(shelf);
+    shelf.cellWidth = cellWidth;
+    shelf.cellHeight = cellHeight;
+    shelf.cells.assign(kAtlasSize / cellWidth, kInvalidKey);
+    *outLocation = {bestShelf, 0, 0};
+    return true;
+}
+
+void VectorDrawableAtlas::evictShelf(Shelf& shelf) {
+    for (uint64_t& key : shelf.cells) {
+        if (key != kInvalidKey) {
+            mEntries.erase(key);
+            key = kInvalidKey;
+        }
+    }
+}
+
+void VectorDrawableAtlas::freeEntry(uint64_t key) {
+    auto it = mEntries.find(key);
+    if (it == mEntries.end()) {
+        return;
+    }
+    mShelves[it->second.shelf].cells[it->second.cell] = kInvalidKey;
+    mEntries.erase(it);
+}
+
+sk_sp<SkImage> VectorDrawableAtlas::getImage() {
+    if (!mImage && mSurface) {
+        mImage = mSurface->makeImageSnapshot();
+    }
+    return mImage;
+}
+
+void VectorDrawableAtlas::releaseEntry(uint64_t key) {
+    if (key == kInvalidKey) {
+        return;
+    }
+    std::lock_guard lock(mReleaseLock);
+    mPendingReleases.push_back(key);
+}
+
+void VectorDrawableAtlas::applyPendingReleases() {
+    std::vector<uint64_t> releases;
+    {
+        std::lock_guard lock(mReleaseLock);
+        releases.swap(mPendingReleases);
+    }
+    for (uint64_t key : releases) {
+        freeEntry(key);
+    }
+}
+
+void VectorDrawableAtlas::clear() {
+    mImage = nullptr;
+    mSurface = nullptr;
+    mShelves.clear();
+    mEntries.clear();
+    mNextShelfY = 0;
+    std::lock_guard lock(mReleaseLock);
+    mPendingReleases.clear();
+}
+
+} /* namespace skiapipeline */
+} /* namespace uirenderer */
+} /* namespace android */
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <SkImage.h>
+#include <SkRect.h>
+#include <SkRefCnt.h>
+#include <SkSurface.h>
+#include <include/gpu/ganesh/GrRecordingContext.h>
+#include <utils/RefBase.h>
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace android {
+namespace uirenderer {
+namespace skiapipeline {
+
+/**
+ * A GPU texture shared by the render caches of small VectorDrawables.
+ *
+ * Icon heavy screens would otherwise create and upload a tiny texture per drawable. In the atlas,
+ * caches are rasterized straight into the texture on the GPU, only redrawing the area of the
+ * caches that changed, and drawing many icons samples from a single texture so the draws can be
+ * batched.
+ *
+ * The atlas is cut into horizontal shelves of equally sized cells, so that drawables of the same
+ * size, which is the common case for icons, reuse each other's cells. When the atlas is full, the
+ * least recently used cells of the right size are evicted, as are whole shelves that are no
+ * longer used. Drawables that don't get a cell keep using their own bitmap.
+ *
+ * Everything but releaseEntry must be called on the RenderThread.
+ */
+class VectorDrawableAtlas : public VirtualLightRefBase {
+public:
+    static constexpr int kAtlasSize = 1024;
+    // Caches larger than this on either side keep their own bitmap
+    static constexpr int kMaxEntrySize = 256;
+    static constexpr uint64_t kInvalidKey = 0;
+    // Empty space around every cache, so that bilinear sampling never reads a neighbour
+    static constexpr int kPadding = 1;
+
+    struct Entry {
+        // Where the cache lives in the atlas
+        SkIRect rect;
+        // True if the area is new and must be rasterized before use
+        bool needsRedraw;
+    };
+
+    // Starts using the atlas for a frame. Returns false if no texture could be created.
+    bool prepareForDraw(GrRecordingContext* context);
+
+    // Finds the entry for *key, or allocates a width x height one and updates *key. Returns false
+    // if the atlas has no room for it.
+    bool acquireEntry(uint64_t* key, int width, int height, Entry* outEntry);
+
+    // Returns true with the entry's location if key still holds a width x height cache
+    bool getEntry(uint64_t key, int width, int height, SkIRect* outRect);
+
+    // Canvas to rasterize entries with, after prepareForDraw
+    SkCanvas* getCanvas() { return mSurface->getCanvas(); }
+
+    // Image to draw entries from. It is only valid until the next prepareForDraw.
+    sk_sp<SkImage> getImage();
+
+    // Gives the entry back. This may be called from any thread.
+    void releaseEntry(uint64_t key);
+
+    // Drops the texture and every entry
+    void clear();
+
+    int getEntryCount() const { return mEntries.size(); }
+    size_t getTextureBytes() const { return mSurface ? kAtlasSize * kAtlasSize * 4 : 0; }
+
+private:
+    // Cell sizes are rounded up to this, so that caches close in size can share shelves
+    static constexpr int kCellAlignment = 8;
+
+    struct Shelf {
+        int y;
+        int height;
+        int cellWidth;
+        int cellHeight;
+        // Key of the entry in each cell, or kInvalidKey
+        std::vector<uint64_t> cells;
+    };
+
+    struct Location {
+        int shelf;
+        int cell;
+        int64_t lastUsedFrame;
+    };
+
+    static int cellSize(int size);
+    SkIRect entryRect(const Location& location) const;
+    bool allocateCell(int cellWidth, int cellHeight, Location* outLocation);
+    void evictShelf(Shelf& shelf);
+    void freeEntry(uint64_t key);
+    void applyPendingReleases();
+
+    sk_sp<SkSurface> mSurface;
+    sk_sp<SkImage> mImage;
+    std::vector<Shelf> mShelves;
+    std::unordered_map<uint64_t, Location> mEntries;
+    int mNextShelfY = 0;
+    int64_t mFrame = 0;
+    uint64_t mNextKey = kInvalidKey + 1;
+
+    std::mutex mReleaseLock;
+    std::vector<uint64_t> mPendingReleases;
+};
+
+} /* namespace skiapipeline */
+} /* namespace uirenderer */
+} /* namespace android */
@@ -24,10 +24,19 @@ namespace uirenderer {
 void Readback::copySurfaceInto(ANativeWindow* window, const std::shared_ptr<CopyRequest>& request) {
 }
 
+void Readback::copySurfaceInto(ANativeWindow* window,
+                               const std::shared_ptr<HardwareBufferCopyRequest>& request) {
+}
+
 CopyResult Readback::copyHWBitmapInto(Bitmap* hwBitmap, SkBitmap* bitmap) {
     return CopyResult::UnknownError;
 }
 
+CopyResult Readback::copyHWBitmapInto(Bitmap* hwBitmap, AHardwareBuffer* buffer,
+                                      base::unique_fd* outFence) {
+    return CopyResult::UnknownError;
+}
+
 CopyResult Readback::copyLayerInto(DeferredLayerUpdater* deferredLayer, SkBitmap* bitmap) {
     return CopyResult::UnknownError;
 }
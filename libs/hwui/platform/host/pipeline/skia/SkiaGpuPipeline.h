@@ -47,8 +47,9 @@ public:
     }
     renderthread::Frame getFrame() override { return renderthread::Frame(0, 0, 0); }
     renderthread::IRenderPipeline::DrawResult draw(
-            const renderthread::Frame& frame, const SkRect& screenDirty, const SkRect& dirty,
-            const LightGeometry& lightGeometry, LayerUpdateQueue* layerUpdateQueue,
+            const renderthread::Frame& frame, const DamageRegion& screenDirty,
+            const DamageRegion& dirty, const LightGeometry& lightGeometry,
+            LayerUpdateQueue* layerUpdateQueue,
             const Rect& contentDrawBounds, bool opaque, const LightInfo& lightInfo,
             const std::vector<sp<RenderNode>>& renderNodes, FrameInfoVisualizer* profiler,
             const renderthread::HardwareBufferRenderParams& bufferParams,
@@ -56,7 +57,7 @@ public:
         return {false, IRenderPipeline::DrawResult::kUnknownTime, android::base::unique_fd(-1)};
     }
     bool swapBuffers(const renderthread::Frame& frame, IRenderPipeline::DrawResult& drawResult,
-                     const SkRect& screenDirty, FrameInfo* currentFrameInfo,
+                     const DamageRegion& screenDirty, FrameInfo* currentFrameInfo,
                      bool* requireSwap) override {
         return false;
     }
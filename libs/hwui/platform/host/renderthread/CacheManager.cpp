@@ -37,10 +37,14 @@ void CacheManager::getMemoryUsage(size_t* cpuUsage, size_t* gpuUsage) {}
 
 void CacheManager::dumpMemoryUsage(String8& log, const RenderState* renderState) {}
 
-void CacheManager::onFrameCompleted() {}
+void CacheManager::onFrameCompleted(bool missedDeadline) {}
 
 void CacheManager::onThreadIdle() {}
 
+bool CacheManager::canGrowLayers(const MemoryAttribution& attribution, size_t bytes) {
+    return true;
+}
+
 void CacheManager::scheduleDestroyContext() {}
 
 void CacheManager::cancelDestroyContext() {}
@@ -18,6 +18,7 @@
 
 #include <SkExecutor.h>
 #include <SkGraphics.h>
+#include <gui/TraceUtils.h>
 #include <include/gpu/ganesh/GrContextOptions.h>
 #include <include/gpu/ganesh/GrTypes.h>
 #include <math.h>
@@ -31,6 +32,7 @@
 #include "Properties.h"
 #include "RenderThread.h"
 #include "VulkanManager.h"
+#include "hwui/BitmapPool.h"
 #include "pipeline/skia/ATraceMemoryDump.h"
 #include "pipeline/skia/ShaderCache.h"
 #include "pipeline/skia/SkiaMemoryTracer.h"
@@ -42,7 +44,9 @@ namespace uirenderer {
 namespace renderthread {
 
 CacheManager::CacheManager(RenderThread& thread)
-        : mRenderThread(thread), mMemoryPolicy(loadMemoryPolicy()) {
+        : mRenderThread(thread)
+        , mMemoryPolicy(loadMemoryPolicy())
+        , mLayerSurfacePool(new skiapipeline::LayerSurfacePool(0)) {
     mMaxSurfaceArea = static_cast<size_t>((DeviceInfo::getWidth() * DeviceInfo::getHeight()) *
                                           mMemoryPolicy.initialMaxSurfaceAreaScale);
     setupCacheLimits();
@@ -58,8 +62,21 @@ static inline uint32_t nextPowerOfTwo(uint32_t n) {
     return n ? (1 << (32 - countLeadingZeros(n - 1))) : 1;
 }
 
+// A frame that misses its deadline while the resource cache is at least this full is assumed to
+// have spent its time recreating evicted resources.
+constexpr float kThrashingCacheUsage = 0.9f;
+// The number of such frames, each no more than kThrashingWindow apart, before the budget grows.
+constexpr int kThrashingFramesToGrow = 3;
+constexpr nsecs_t kThrashingWindow = 1_s;
+// The amount by which the budget scale changes at each step.
+constexpr float kAdaptiveScaleStep = 0.25f;
+
+// Pooled layer surfaces that no layer has taken over for this long are released.
+constexpr nsecs_t kLayerSurfaceMaxIdle = 2_s;
+
 void CacheManager::setupCacheLimits() {
-    mMaxResourceBytes = mMaxSurfaceArea * mMemoryPolicy.surfaceSizeMultiplier;
+    mMaxResourceBytes = mMaxSurfaceArea * mMemoryPolicy.surfaceSizeMultiplier *
+                        mAdaptiveResourceScale;
     mBackgroundResourceBytes = mMaxResourceBytes * mMemoryPolicy.backgroundRetentionPercent;
     // This sets the maximum size for a single texture atlas in the GPU font cache. If
     // necessary, the cache can allocate additional textures that are counted against the
@@ -74,6 +91,8 @@ void CacheManager::setupCacheLimits() {
     if (mGrContext) {
         mGrContext->setResourceCacheLimit(mMaxResourceBytes);
     }
+    // Enough to hold on to one full screen RGBA layer
+    mLayerSurfacePool->setMaxBytes(mMaxSurfaceArea * 4);
 }
 
 void CacheManager::reset(sk_sp<GrDirectContext> context) {
@@ -84,15 +103,27 @@ void CacheManager::reset(sk_sp<GrDirectContext> context) {
     if (context) {
         mGrContext = std::move(context);
         mGrContext->setResourceCacheLimit(mMaxResourceBytes);
+        mLayerSurfacePool->setContext(mGrContext.get());
         mLastDeferredCleanup = systemTime(CLOCK_MONOTONIC);
     }
 }
 
 void CacheManager::destroy() {
     // cleanup any caches here as the GrContext is about to go away...
+    if (mVectorDrawableAtlas) {
+        mVectorDrawableAtlas->clear();
+    }
+    mLayerSurfacePool->setContext(nullptr);
     mGrContext.reset(nullptr);
 }
 
+sp<skiapipeline::VectorDrawableAtlas> CacheManager::acquireVectorDrawableAtlas() {
+    if (!mVectorDrawableAtlas) {
+        mVectorDrawableAtlas = new skiapipeline::VectorDrawableAtlas();
+    }
+    return mVectorDrawableAtlas;
+}
+
 class CommonPoolExecutor : public SkExecutor {
 public:
     virtual void add(std::function<void(void)> func) override { CommonPool::post(std::move(func)); }
@@ -117,6 +148,9 @@ static GrPurgeResourceOptions toSkiaEnum(bool scratchOnly) {
 }
 
 void CacheManager::trimMemory(TrimLevel mode) {
+    shrinkAdaptiveBudget(mode);
+    BitmapPool::get().trim();
+    mLayerSurfacePool->clear();
     if (!mGrContext) {
         return;
     }
@@ -129,6 +163,10 @@ void CacheManager::trimMemory(TrimLevel mode) {
         SkGraphics::PurgeAllCaches();
         mRenderThread.destroyRenderingContext();
     } else if (mode == TrimLevel::UI_HIDDEN) {
+        if (mVectorDrawableAtlas) {
+            mVectorDrawableAtlas->clear();
+        }
+        mRenderThread.readback().releaseIntermediates();
         // Here we purge all the unlocked scratch resources and then toggle the resources cache
         // limits between the background and max amounts. This causes the unlocked resources
         // that have persistent data to be purged in LRU order.
@@ -150,6 +188,7 @@ void CacheManager::trimCaches(CacheTrimLevel mode) {
             break;
         case CacheTrimLevel::ALL_CACHES:
             SkGraphics::PurgeAllCaches();
+            mLayerSurfacePool->clear();
             if (mGrContext) {
                 mGrContext->purgeUnlockedResources(GrPurgeResourceOptions::kAllResources);
             }
@@ -194,10 +233,20 @@ void CacheManager::dumpMemoryUsage(String8& log, const RenderState* renderState)
                      mMemoryPolicy.surfaceSizeMultiplier,
                      mMemoryPolicy.backgroundRetentionPercent * 100.0f,
                      mMemoryPolicy.useAlternativeUiHidden ? "true" : "false");
+    log.appendFormat("  Adaptive resource scale: %.2f (max %.2f, grown %u, shrunk %u)\n",
+                     mAdaptiveResourceScale, mMemoryPolicy.maxAdaptiveResourceScale,
+                     mAdaptiveGrowCount, mAdaptiveShrinkCount);
     if (Properties::isSystemOrPersistent) {
         log.appendFormat("  IsSystemOrPersistent\n");
     }
+    if (mMemoryPolicy.contextLayerBudgetMultiplier > 0) {
+        log.appendFormat("  Layer budget per context: %.2fMB (x%.0f, rejected %u)\n",
+                         mMaxSurfaceArea * mMemoryPolicy.contextLayerBudgetMultiplier / 1000000.f,
+                         mMemoryPolicy.contextLayerBudgetMultiplier, mLayerBudgetRejections);
+    }
     log.appendFormat("  GPU Context timeout: %" PRIu64 "\n", ns2s(mMemoryPolicy.contextTimeout));
+    log.appendFormat("  Compacted display lists: %u (%.2f KB reclaimed)\n", mCompactedDisplayLists,
+                     mCompactedDisplayListBytes / 1024.0f);
     size_t stoppedContexts = 0;
     for (auto context : mCanvasContexts) {
         if (context->isStopped()) stoppedContexts++;
@@ -238,6 +287,17 @@ void CacheManager::dumpMemoryUsage(String8& log, const RenderState* renderState)
         gpuTracer.logOutput(log);
     }
 
+    if (mVectorDrawableAtlas && mVectorDrawableAtlas->getTextureBytes() > 0) {
+        log.appendFormat("VectorDrawable atlas: %d entries, %6.2f KB\n",
+                         mVectorDrawableAtlas->getEntryCount(),
+                         mVectorDrawableAtlas->getTextureBytes() / 1024.0f);
+    }
+    log.appendFormat("Layer surface pool: %zu surfaces, %6.2f KB (hits %u, misses %u)\n",
+                     mLayerSurfacePool->getEntryCount(), mLayerSurfacePool->getBytes() / 1024.0f,
+                     mLayerSurfacePool->getHitCount(), mLayerSurfacePool->getMissCount());
+
+    dumpAttributedMemory(log);
+
     if (renderState && renderState->mActiveLayers.size() > 0) {
         log.appendFormat("Layer Info:\n");
 
@@ -260,9 +320,62 @@ void CacheManager::dumpMemoryUsage(String8& log, const RenderState* renderState)
     gpuTracer.logTotals(log);
 }
 
-void CacheManager::onFrameCompleted() {
+static const char* contextName(const CanvasContext* context) {
+    const std::string& name = context->memoryAttribution()->name();
+    return name.empty() ? "(unnamed)" : name.c_str();
+}
+
+void CacheManager::dumpAttributedMemory(String8& log) {
+    log.appendFormat("Attributed GPU memory:\n");
+    for (const CanvasContext* context : mCanvasContexts) {
+        const MemoryAttribution& attribution = *context->memoryAttribution();
+        log.appendFormat("  %s (%p)\n", contextName(context), context);
+        log.appendFormat("    Layers            %8.2f KB (count = %zu)\n",
+                         attribution.bytes(AttributedMemoryType::RenderNodeLayer) / 1024.0f,
+                         attribution.count(AttributedMemoryType::RenderNodeLayer));
+        log.appendFormat("    Texture layers    %8.2f KB (count = %zu)\n",
+                         attribution.bytes(AttributedMemoryType::TextureLayer) / 1024.0f,
+                         attribution.count(AttributedMemoryType::TextureLayer));
+    }
+    const MemoryAttribution& bitmaps = *MemoryAttribution::sharedHardwareBitmaps();
+    log.appendFormat("  %s (shared)    %8.2f KB (count = %zu)\n", bitmaps.name().c_str(),
+                     bitmaps.bytes(AttributedMemoryType::HardwareBitmap) / 1024.0f,
+                     bitmaps.count(AttributedMemoryType::HardwareBitmap));
+}
+
+void CacheManager::traceAttributedMemory() {
+    std::string counterName;
+    for (const CanvasContext* context : mCanvasContexts) {
+        counterName = "HWUI Attributed Memory ";
+        counterName += contextName(context);
+        ATRACE_INT64(counterName.c_str(), context->memoryAttribution()->totalBytes());
+    }
+    ATRACE_INT64("HWUI Hardware Bitmap Memory",
+                 MemoryAttribution::sharedHardwareBitmaps()->totalBytes());
+}
+
+bool CacheManager::canGrowLayers(const MemoryAttribution& attribution, size_t bytes) {
+    if (mMemoryPolicy.contextLayerBudgetMultiplier <= 0) {
+        return true;
+    }
+    const size_t budget = mMaxSurfaceArea * mMemoryPolicy.contextLayerBudgetMultiplier;
+    const size_t used = attribution.bytes(AttributedMemoryType::RenderNodeLayer) +
+                        attribution.bytes(AttributedMemoryType::TextureLayer);
+    if (used + bytes <= budget) {
+        return true;
+    }
+    mLayerBudgetRejections++;
+    ATRACE_FORMAT("Layer over budget for %s", attribution.name().c_str());
+    return false;
+}
+
+void CacheManager::onFrameCompleted(bool missedDeadline) {
     cancelDestroyContext();
     mFrameCompletions.next() = systemTime(CLOCK_MONOTONIC);
+    if (missedDeadline) {
+        updateAdaptiveBudget();
+    }
+    mLayerSurfacePool->trim(kLayerSurfaceMaxIdle);
     if (ATRACE_ENABLED()) {
         ATRACE_NAME("dumpingMemoryStatistics");
         static skiapipeline::ATraceMemoryDump tracer;
@@ -272,7 +385,53 @@ void CacheManager::onFrameCompleted() {
             mGrContext->dumpMemoryStatistics(&tracer);
         }
         tracer.logTraces(Properties::debugTraceGpuResourceCategories, mGrContext.get());
+        traceAttributedMemory();
+    }
+}
+
+void CacheManager::updateAdaptiveBudget() {
+    if (!mGrContext || mAdaptiveResourceScale >= mMemoryPolicy.maxAdaptiveResourceScale) {
+        return;
+    }
+    size_t cacheUsage;
+    mGrContext->getResourceCacheUsage(nullptr, &cacheUsage);
+    if (cacheUsage < mMaxResourceBytes * kThrashingCacheUsage) {
+        // The cache has room, so the missed deadline was not caused by evictions.
+        return;
+    }
+
+    const nsecs_t now = mFrameCompletions.back();
+    if (now - mLastThrashingFrame > kThrashingWindow) {
+        mThrashingFrames = 0;
     }
+    mLastThrashingFrame = now;
+    if (++mThrashingFrames < kThrashingFramesToGrow) {
+        return;
+    }
+
+    mThrashingFrames = 0;
+    mAdaptiveResourceScale = std::min(mAdaptiveResourceScale + kAdaptiveScaleStep,
+                                      mMemoryPolicy.maxAdaptiveResourceScale);
+    mAdaptiveGrowCount++;
+    ATRACE_FORMAT("CacheManager grow resource budget to x%.2f", mAdaptiveResourceScale);
+    setupCacheLimits();
+}
+
+void CacheManager::shrinkAdaptiveBudget(TrimLevel mode) {
+    if (mAdaptiveResourceScale <= 1.0f) {
+        return;
+    }
+    // Moderate pressure gives back one step; anything worse drops the growth entirely so that
+    // the purge below works against the policy's base budget.
+    if (mode == TrimLevel::RUNNING_MODERATE) {
+        mAdaptiveResourceScale = std::max(mAdaptiveResourceScale - kAdaptiveScaleStep, 1.0f);
+    } else {
+        mAdaptiveResourceScale = 1.0f;
+    }
+    mThrashingFrames = 0;
+    mAdaptiveShrinkCount++;
+    ATRACE_FORMAT("CacheManager shrink resource budget to x%.2f", mAdaptiveResourceScale);
+    setupCacheLimits();
 }
 
 void CacheManager::onThreadIdle() {
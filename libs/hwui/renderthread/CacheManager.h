@@ -19,12 +19,16 @@
 
 #ifdef __ANDROID__ // Layoutlib does not support hardware acceleration
 #include <include/gpu/ganesh/GrDirectContext.h>
+
+#include "pipeline/skia/LayerSurfacePool.h"
+#include "pipeline/skia/VectorDrawableAtlas.h"
 #endif
 #include <SkSurface.h>
 #include <utils/String8.h>
 
 #include <vector>
 
+#include "MemoryAttribution.h"
 #include "MemoryPolicy.h"
 #include "utils/RingBuffer.h"
 #include "utils/TimeUtils.h"
@@ -46,6 +50,10 @@ class CacheManager {
 public:
 #ifdef __ANDROID__ // Layoutlib does not support hardware acceleration
     void configureContext(GrContextOptions* context, const void* identity, ssize_t size);
+    // The atlas shared by the caches of small VectorDrawables
+    sp<skiapipeline::VectorDrawableAtlas> acquireVectorDrawableAtlas();
+    // The surfaces of resized or destroyed RenderNode layers, for new layers to reuse
+    sp<skiapipeline::LayerSurfacePool> layerSurfacePool() { return mLayerSurfacePool; }
 #endif
     void trimMemory(TrimLevel mode);
     void trimCaches(CacheTrimLevel mode);
@@ -55,11 +63,20 @@ public:
 
     size_t getCacheSize() const { return mMaxResourceBytes; }
     size_t getBackgroundCacheSize() const { return mBackgroundResourceBytes; }
-    void onFrameCompleted();
+    void onFrameCompleted(bool missedDeadline = false);
     void notifyNextFrameSize(int width, int height);
 
     void onThreadIdle();
 
+    // Returns false if the layers attributed to a CanvasContext may not grow by the given
+    // number of bytes without exceeding MemoryPolicy::contextLayerBudgetMultiplier
+    bool canGrowLayers(const MemoryAttribution& attribution, size_t bytes);
+
+    void onDisplayListCompacted(size_t bytes) {
+        mCompactedDisplayLists++;
+        mCompactedDisplayListBytes += bytes;
+    }
+
     void registerCanvasContext(CanvasContext* context);
     void unregisterCanvasContext(CanvasContext* context);
     void onContextStopped(CanvasContext* context);
@@ -71,7 +88,11 @@ private:
 
     explicit CacheManager(RenderThread& thread);
     void setupCacheLimits();
+    void updateAdaptiveBudget();
+    void shrinkAdaptiveBudget(TrimLevel mode);
     void checkUiHidden();
+    void dumpAttributedMemory(String8& log);
+    void traceAttributedMemory();
     void scheduleDestroyContext();
     void cancelDestroyContext();
 
@@ -84,6 +105,8 @@ private:
     const MemoryPolicy& mMemoryPolicy;
 #ifdef __ANDROID__ // Layoutlib does not support hardware acceleration
     sk_sp<GrDirectContext> mGrContext;
+    sp<skiapipeline::VectorDrawableAtlas> mVectorDrawableAtlas;
+    sp<skiapipeline::LayerSurfacePool> mLayerSurfacePool;
 #endif
 
     size_t mMaxSurfaceArea = 0;
@@ -91,6 +114,22 @@ private:
     size_t mMaxResourceBytes = 0;
     size_t mBackgroundResourceBytes = 0;
 
+    // Scale applied to the foreground resource budget, between 1 and
+    // MemoryPolicy::maxAdaptiveResourceScale
+    float mAdaptiveResourceScale = 1.0f;
+    // Frames that missed their deadline with a full resource cache since the last growth
+    int mThrashingFrames = 0;
+    nsecs_t mLastThrashingFrame = 0;
+    uint32_t mAdaptiveGrowCount = 0;
+    uint32_t mAdaptiveShrinkCount = 0;
+
+    // Layers that were not created because their CanvasContext was over its layer budget
+    uint32_t mLayerBudgetRejections = 0;
+
+    // Display lists whose op storage was trimmed after they went idle, and the bytes it freed
+    uint32_t mCompactedDisplayLists = 0;
+    size_t mCompactedDisplayListBytes = 0;
+
     size_t mMaxGpuFontAtlasBytes = 0;
     size_t mMaxCpuFontCacheBytes = 0;
     size_t mBackgroundCpuFontCacheBytes = 0;
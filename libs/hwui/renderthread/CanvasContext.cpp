@@ -30,10 +30,12 @@
 
 #include "../Properties.h"
 #include "AnimationContext.h"
+#include "DeferredLayerUpdater.h"
 #include "Frame.h"
 #include "LayerUpdateQueue.h"
 #include "Properties.h"
 #include "RenderThread.h"
+#include "VectorDrawable.h"
 #include "hwui/Canvas.h"
 #include "pipeline/skia/SkiaCpuPipeline.h"
 #include "pipeline/skia/SkiaGpuPipeline.h"
@@ -149,6 +151,35 @@ CanvasContext::~CanvasContext() {
     mHintSessionWrapper->destroy();
 }
 
+bool CanvasContext::createOrUpdateLayer(RenderNode* node, const DamageAccumulator& dmgAccumulator,
+                                        ErrorHandler* errorHandler) {
+    skiapipeline::SkiaLayer* layer = node->getSkiaLayer();
+    const size_t currentBytes = layer ? layer->memoryTag.bytes() : 0;
+    const size_t neededBytes = static_cast<size_t>(node->getWidth()) * node->getHeight() *
+                               SkColorTypeBytesPerPixel(mRenderPipeline->getSurfaceColorType());
+    if (neededBytes > currentBytes &&
+        !mRenderThread.cacheManager().canGrowLayers(*mMemoryAttribution,
+                                                    neededBytes - currentBytes)) {
+        // Over budget; the node draws its content directly instead. Report a change when an
+        // existing layer goes away so that its area is redrawn without it.
+        if (layer) {
+            node->setLayerSurface(nullptr);
+            return true;
+        }
+        return false;
+    }
+
+    if (!mRenderPipeline->createOrUpdateLayer(node, dmgAccumulator, errorHandler)) {
+        return false;
+    }
+    if (SkSurface* surface = node->getLayerSurface()) {
+        node->getSkiaLayer()->memoryTag.set(mMemoryAttribution,
+                                            AttributedMemoryType::RenderNodeLayer,
+                                            surface->imageInfo().computeMinByteSize());
+    }
+    return true;
+}
+
 void CanvasContext::addRenderNode(RenderNode* node, bool placeFront) {
     int pos = placeFront ? 0 : static_cast<int>(mRenderNodes.size());
     node->makeRoot();
@@ -417,6 +448,7 @@ bool CanvasContext::isSwapChainStuffed() {
 void CanvasContext::prepareTree(TreeInfo& info, int64_t* uiFrameInfo, int64_t syncQueued,
                                 RenderNode* target) {
     mRenderThread.removeFrameCallback(this);
+    mPendingVectorDrawables.clear();
 
     // If the previous frame was dropped we don't need to hold onto it, so
     // just keep using the previous frame's structure instead
@@ -454,6 +486,7 @@ void CanvasContext::prepareTree(TreeInfo& info, int64_t* uiFrameInfo, int64_t sy
     info.damageAccumulator = &mDamageAccumulator;
     info.layerUpdateQueue = &mLayerUpdateQueue;
     info.damageGenerationId = mDamageId++;
+    info.frameVsyncTime = mCurrentFrameInfo->get(FrameInfoIndex::Vsync);
     info.out.skippedFrameReason = std::nullopt;
 
     mAnimationContext->startFrame(info.mode);
@@ -518,6 +551,21 @@ void CanvasContext::prepareTree(TreeInfo& info, int64_t* uiFrameInfo, int64_t sy
         mCurrentFrameInfo->setSkippedFrameReason(*info.out.skippedFrameReason);
     }
 
+    if (!info.out.skippedFrameReason) {
+        // What the draw costs is still ahead, so this is the last chance for a timely boost
+        const nsecs_t syncDuration = systemTime(SYSTEM_TIME_MONOTONIC) -
+                                     mCurrentFrameInfo->get(FrameInfoIndex::SyncStart);
+        const nsecs_t uiDuration = mCurrentFrameInfo->duration(FrameInfoIndex::FrameStartTime,
+                                                               FrameInfoIndex::SyncQueued);
+        const FrameCostHints hints{
+                .newSurface = mHaveNewSurface,
+                .visibilityChanged = (mCurrentFrameInfo->get(FrameInfoIndex::Flags) &
+                                      FrameInfoFlags::WindowVisibilityChanged) != 0,
+                .syncedDisplayLists = info.out.syncedDisplayLists,
+        };
+        mHintSessionWrapper->onFramePrepared(uiDuration + syncDuration, syncDuration, hints);
+    }
+
     bool postedFrameCallback = false;
     if (info.out.hasAnimations || info.out.skippedFrameReason) {
         if (CC_UNLIKELY(!Properties::enableRTAnimations)) {
@@ -569,6 +617,26 @@ Frame CanvasContext::getFrame() {
     }
 }
 
+void CanvasContext::queueVectorDrawableUpdate(VectorDrawableRoot* tree) {
+    mPendingVectorDrawables.emplace_back(tree);
+}
+
+void CanvasContext::updateVectorDrawableCaches() {
+#ifdef __ANDROID__ // Layoutlib does not support hardware acceleration
+    GrDirectContext* grContext = getGrContext();
+    if (grContext && !mPendingVectorDrawables.empty()) {
+        ATRACE_NAME("updateVectorDrawableCaches");
+        auto atlas = mRenderThread.cacheManager().acquireVectorDrawableAtlas();
+        if (atlas->prepareForDraw(grContext)) {
+            for (const sp<VectorDrawableRoot>& tree : mPendingVectorDrawables) {
+                tree->updateCache(atlas);
+            }
+        }
+    }
+#endif
+    mPendingVectorDrawables.clear();
+}
+
 void CanvasContext::draw(bool solelyTextureViewUpdates) {
 #ifdef __ANDROID__
     if (auto grContext = getGrContext()) {
@@ -582,7 +650,7 @@ void CanvasContext::draw(bool solelyTextureViewUpdates) {
         }
     }
 #endif
-    SkRect dirty;
+    DamageRegion dirty;
     mDamageAccumulator.finish(&dirty);
 
     // reset syncDelayDuration each time we draw
@@ -631,9 +699,12 @@ void CanvasContext::draw(bool solelyTextureViewUpdates) {
 
     Frame frame = getFrame();
 
-    SkRect windowDirty = computeDirtyRect(frame, &dirty);
+    DamageRegion windowDirty = computeDirtyRegion(frame, &dirty);
+
+    const SkRect dirtyBounds = dirty.bounds();
+    ATRACE_FORMAT("Drawing " RECT_STRING " (%d rects)", SK_RECT_ARGS(dirtyBounds), dirty.count());
 
-    ATRACE_FORMAT("Drawing " RECT_STRING, SK_RECT_ARGS(dirty));
+    updateVectorDrawableCaches();
 
     IRenderPipeline::DrawResult drawResult;
     {
@@ -706,7 +777,7 @@ void CanvasContext::draw(bool solelyTextureViewUpdates) {
             swap.damage = windowDirty;
         } else {
             float max = static_cast<float>(INT_MAX);
-            swap.damage = SkRect::MakeWH(max, max);
+            swap.damage.set(SkRect::MakeWH(max, max));
         }
         swap.swapCompletedTime = systemTime(SYSTEM_TIME_MONOTONIC);
         swap.vsyncTime = mRenderThread.timeLord().latestVsync();
@@ -760,6 +831,14 @@ void CanvasContext::draw(bool solelyTextureViewUpdates) {
         mFrameCommitCallbacks.clear();
     }
 
+    if (didDraw && Properties::dequeueAhead && mNativeSurface) {
+        // The frame's dequeue and queue durations were recorded above, so a blocking dequeue here
+        // is not charged to this frame, and the next frame's dequeue returns this buffer at once.
+        // A failure is reported again by reserveNext() when the next frame is prepared.
+        ATRACE_NAME("Dequeue next buffer ahead");
+        mNativeSurface->reserveNext();
+    }
+
     if (requireSwap) {
         if (mExpectSurfaceStats) {
             reportMetricsWithPresentTime();
@@ -793,13 +872,22 @@ void CanvasContext::draw(bool solelyTextureViewUpdates) {
                                  (std::min(syncDelayDuration, mLastDequeueBufferDuration)) -
                                  dequeueBufferDuration - idleDuration;
         mHintSessionWrapper->reportActualWorkDuration(actualDuration);
+        mHintSessionWrapper->reportFrameStages(
+                mCurrentFrameInfo->duration(FrameInfoIndex::SyncStart,
+                                            FrameInfoIndex::IssueDrawCommandsStart),
+                mCurrentFrameInfo->duration(FrameInfoIndex::IssueDrawCommandsStart,
+                                            FrameInfoIndex::SwapBuffers) -
+                        dequeueBufferDuration);
         mHintSessionWrapper->setActiveFunctorThreads(
                 WebViewFunctorManager::instance().getRenderingThreadsForActiveFunctors());
     }
 
     mLastDequeueBufferDuration = dequeueBufferDuration;
 
-    mRenderThread.cacheManager().onFrameCompleted();
+    // Same criterion as JankTracker's kMissedDeadline, evaluated when the RenderThread is done so
+    // that it is available even when the GPU completion time is reported later.
+    const bool missedDeadline = didDraw && systemTime(SYSTEM_TIME_MONOTONIC) > frameDeadline;
+    mRenderThread.cacheManager().onFrameCompleted(missedDeadline);
     return;
 }
 
@@ -988,12 +1076,14 @@ void CanvasContext::buildLayer(RenderNode* node) {
     info.damageAccumulator = &mDamageAccumulator;
     info.layerUpdateQueue = &mLayerUpdateQueue;
     info.runAnimations = false;
+    mPendingVectorDrawables.clear();
     node->prepareTree(info);
     SkRect ignore;
     mDamageAccumulator.finish(&ignore);
     // Tickle the GENERIC property on node to mark it as dirty for damaging
     // purposes when the frame is actually drawn
     node->setPropertyFieldsDirty(RenderNode::GENERIC);
+    updateVectorDrawableCaches();
 
     mRenderPipeline->renderLayers(mLightGeometry, &mLayerUpdateQueue, mOpaque, mLightInfo);
 
@@ -1025,7 +1115,11 @@ void CanvasContext::onContextDestroyed() {
 }
 
 DeferredLayerUpdater* CanvasContext::createTextureLayer() {
-    return mRenderPipeline->createTextureLayer();
+    DeferredLayerUpdater* layer = mRenderPipeline->createTextureLayer();
+    if (layer) {
+        layer->setMemoryAttribution(mMemoryAttribution);
+    }
+    return layer;
 }
 
 void CanvasContext::dumpFrames(int fd) {
@@ -1038,6 +1132,7 @@ void CanvasContext::resetFrameStats() {
 }
 
 void CanvasContext::setName(const std::string&& name) {
+    mMemoryAttribution->setName(name);
     mJankTracker.setDescription(JankTrackerType::Window, std::move(name));
 }
 
@@ -1052,7 +1147,8 @@ void CanvasContext::waitOnFences() {
 }
 
 void CanvasContext::enqueueFrameWork(std::function<void()>&& func) {
-    mFrameFences.push_back(CommonPool::async(std::move(func)));
+    mFrameFences.push_back(
+            CommonPool::async(std::move(func), CommonPool::Priority::FrameCritical));
 }
 
 uint64_t CanvasContext::getFrameNumber() {
@@ -1074,7 +1170,7 @@ bool CanvasContext::surfaceRequiresRedraw() {
     return width != mLastFrameWidth || height != mLastFrameHeight;
 }
 
-SkRect CanvasContext::computeDirtyRect(const Frame& frame, SkRect* dirty) {
+DamageRegion CanvasContext::computeDirtyRegion(const Frame& frame, DamageRegion* dirty) {
     if (frame.width() != mLastFrameWidth || frame.height() != mLastFrameHeight) {
         // can't rely on prior content of window if viewport size changes
         dirty->setEmpty();
@@ -1084,23 +1180,23 @@ SkRect CanvasContext::computeDirtyRect(const Frame& frame, SkRect* dirty) {
         // New surface needs a full draw
         dirty->setEmpty();
     } else {
+        const SkRect bounds = dirty->bounds();
         if (!dirty->isEmpty() && !dirty->intersect(SkRect::MakeIWH(frame.width(), frame.height()))) {
-            ALOGW("Dirty " RECT_STRING " doesn't intersect with 0 0 %d %d ?", SK_RECT_ARGS(*dirty),
+            ALOGW("Dirty " RECT_STRING " doesn't intersect with 0 0 %d %d ?", SK_RECT_ARGS(bounds),
                   frame.width(), frame.height());
-            dirty->setEmpty();
         }
         profiler().unionDirty(dirty);
     }
 
     if (dirty->isEmpty()) {
-        dirty->setIWH(frame.width(), frame.height());
+        dirty->set(SkRect::MakeIWH(frame.width(), frame.height()));
         return *dirty;
     }
 
     // At this point dirty is the area of the window to update. However,
     // the area of the frame we need to repaint is potentially different, so
     // stash the screen area for later
-    SkRect windowDirty(*dirty);
+    DamageRegion windowDirty(*dirty);
 
     // If the buffer age is 0 we do a full-screen repaint (handled above)
     // If the buffer age is 1 the buffer contents are the same as they were
@@ -1110,7 +1206,7 @@ SkRect CanvasContext::computeDirtyRect(const Frame& frame, SkRect* dirty) {
         if (frame.bufferAge() > (int)mSwapHistory.size()) {
             // We don't have enough history to handle this old of a buffer
             // Just do a full-draw
-            dirty->setIWH(frame.width(), frame.height());
+            dirty->set(SkRect::MakeIWH(frame.width(), frame.height()));
         } else {
             // At this point we haven't yet added the latest frame
             // to the damage history (happens below)
@@ -41,6 +41,7 @@
 #include "JankTracker.h"
 #include "LayerUpdateQueue.h"
 #include "Lighting.h"
+#include "MemoryAttribution.h"
 #include "ReliableSurface.h"
 #include "RenderNode.h"
 #include "renderstate/RenderState.h"
@@ -81,9 +82,7 @@ public:
      *  @return true if the layer has been created or updated
      */
     bool createOrUpdateLayer(RenderNode* node, const DamageAccumulator& dmgAccumulator,
-                             ErrorHandler* errorHandler) {
-        return mRenderPipeline->createOrUpdateLayer(node, dmgAccumulator, errorHandler);
-    }
+                             ErrorHandler* errorHandler);
 
     /**
      * Pin any mutable images to the GPU cache. A pinned images is guaranteed to
@@ -121,6 +120,10 @@ public:
      */
     GrDirectContext* getGrContext() const { return mRenderThread.getGrContext(); }
 
+    // Schedules the atlas cache of an on screen VectorDrawable to be updated before the frame is
+    // drawn
+    void queueVectorDrawableUpdate(VectorDrawableRoot* tree);
+
     ASurfaceControl* getSurfaceControl() const { return mSurfaceControl; }
     int32_t getSurfaceControlGenerationId() const { return mSurfaceControlGenerationId; }
 
@@ -171,6 +174,9 @@ public:
 
     void setName(const std::string&& name);
 
+    // The GPU memory hwui allocated for this window, see CacheManager::dumpMemoryUsage
+    const sp<MemoryAttribution>& memoryAttribution() const { return mMemoryAttribution; }
+
     void addRenderNode(RenderNode* node, bool placeFront);
     void removeRenderNode(RenderNode* node);
 
@@ -184,6 +190,11 @@ public:
 
     uint64_t getFrameNumber();
 
+    // Called when the op storage of an idle display list in this context's tree was compacted
+    void onDisplayListCompacted(size_t bytes) {
+        mRenderThread.cacheManager().onDisplayListCompacted(bytes);
+    }
+
     void waitOnFences();
 
     IRenderPipeline* getRenderPipeline() { return mRenderPipeline.get(); }
@@ -256,7 +267,7 @@ private:
     bool surfaceRequiresRedraw();
     void setupPipelineSurface();
 
-    SkRect computeDirtyRect(const Frame& frame, SkRect* dirty);
+    DamageRegion computeDirtyRegion(const Frame& frame, DamageRegion* dirty);
     void finishFrame(FrameInfo* frameInfo);
 
     /**
@@ -274,6 +285,7 @@ private:
     FrameInfo* getFrameInfoFromLastFew(uint64_t frameNumber, uint32_t surfaceControlId);
 
     Frame getFrame();
+    void updateVectorDrawableCaches();
 
     // The same type as Frame.mWidth and Frame.mHeight
     int32_t mLastFrameWidth = 0;
@@ -304,7 +316,7 @@ private:
     bool mIsDirty = false;
     SwapBehavior mSwapBehavior = SwapBehavior::kSwap_default;
     struct SwapHistory {
-        SkRect damage;
+        DamageRegion damage;
         nsecs_t vsyncTime;
         nsecs_t swapCompletedTime;
         nsecs_t dequeueDuration;
@@ -341,6 +353,7 @@ private:
     std::mutex mLastFrameMetricsInfosMutex;
 
     std::string mName;
+    sp<MemoryAttribution> mMemoryAttribution = sp<MemoryAttribution>::make("");
     JankTracker mJankTracker;
     FrameInfoVisualizer mProfiler;
     std::unique_ptr<FrameMetricsReporter> mFrameMetricsReporter GUARDED_BY(mFrameInfoMutex);
@@ -348,6 +361,9 @@ private:
 
     std::set<RenderNode*> mPrefetchedLayers;
 
+    // VectorDrawables found on screen while preparing the tree
+    std::vector<sp<VectorDrawableRoot>> mPendingVectorDrawables;
+
     // Stores the bounds of the main content.
     Rect mContentDrawBounds;
 
@@ -618,15 +618,18 @@ bool EglManager::damageRequiresSwap() {
     return EglExtensions.setDamage && mSwapBehavior == SwapBehavior::BufferAge;
 }
 
-bool EglManager::swapBuffers(const Frame& frame, const SkRect& screenDirty) {
+bool EglManager::swapBuffers(const Frame& frame, const DamageRegion& screenDirty) {
     if (CC_UNLIKELY(Properties::waitForGpuCompletion)) {
         ATRACE_NAME("Finishing GPU work");
         fence();
     }
 
-    EGLint rects[4];
-    frame.map(screenDirty, rects);
-    eglSwapBuffersWithDamageKHR(mEglDisplay, frame.mSurface, rects, screenDirty.isEmpty() ? 0 : 1);
+    EGLint rects[4 * DamageRegion::kMaxRects];
+    EGLint numRects = 0;
+    for (const SkRect& dirty : screenDirty) {
+        frame.map(dirty, rects + 4 * numRects++);
+    }
+    eglSwapBuffersWithDamageKHR(mEglDisplay, frame.mSurface, rects, numRects);
 
     EGLint err = eglGetError();
     if (CC_LIKELY(err == EGL_SUCCESS)) {
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FrameCostPredictor.h"
+
+#include <algorithm>
+
+namespace android {
+namespace uirenderer {
+namespace renderthread {
+
+static inline float blend(float average, float value, float weight) {
+    return average + (value - average) * weight;
+}
+
+FrameCostPredictor::Prediction FrameCostPredictor::predict(nsecs_t syncDuration,
+                                                           const FrameCostHints& hints) {
+    bool heavy = hints.newSurface || hints.visibilityChanged;
+    if (mHasHistory) {
+        heavy |= hints.syncedDisplayLists >= kMinHeavySyncedLists &&
+                 hints.syncedDisplayLists > kHeavyFactor * mAverageSyncedLists;
+        heavy |= syncDuration >= kMinHeavySyncDuration &&
+                 syncDuration > kHeavyFactor * mAverageSync;
+    }
+    mPendingHeavy = heavy;
+    mPendingSyncedLists = hints.syncedDisplayLists;
+
+    Prediction prediction;
+    prediction.heavy = heavy;
+    prediction.drawDuration =
+            static_cast<nsecs_t>(heavy ? mAverageDraw * mHeavyDrawScale : mAverageDraw);
+    return prediction;
+}
+
+void FrameCostPredictor::addFrame(nsecs_t syncDuration, nsecs_t drawDuration) {
+    if (mPendingHeavy) {
+        // Keep the averages describing steady frames, and learn how much heavier the spikes are
+        if (mHasHistory && mAverageDraw > 0) {
+            const float scale = std::clamp(drawDuration / mAverageDraw, 1.0f, kMaxHeavyDrawScale);
+            mHeavyDrawScale = blend(mHeavyDrawScale, scale, kAverageWeight * 2);
+        }
+        return;
+    }
+    if (!mHasHistory) {
+        mAverageSync = syncDuration;
+        mAverageDraw = drawDuration;
+        mAverageSyncedLists = mPendingSyncedLists;
+        mHasHistory = true;
+        return;
+    }
+    mAverageSync = blend(mAverageSync, syncDuration, kAverageWeight);
+    mAverageDraw = blend(mAverageDraw, drawDuration, kAverageWeight);
+    mAverageSyncedLists = blend(mAverageSyncedLists, mPendingSyncedLists, kAverageWeight);
+}
+
+} /* namespace renderthread */
+} /* namespace uirenderer */
+} /* namespace android */
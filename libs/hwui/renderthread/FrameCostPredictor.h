@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "utils/TimeUtils.h"
+
+namespace android {
+namespace uirenderer {
+namespace renderthread {
+
+// What is known about a frame once its tree has been synced, but before it is drawn
+struct FrameCostHints {
+    // First frame on a new or resized surface, which has nothing cached to reuse
+    bool newSurface = false;
+    // The UI thread flagged a window visibility change
+    bool visibilityChanged = false;
+    // RenderNodes that received a new display list during the sync
+    int syncedDisplayLists = 0;
+};
+
+/**
+ * Predicts the RenderThread cost of the frame being drawn from the recent history of its stages.
+ *
+ * Steady frames feed running averages of the sync and draw stages. A frame is expected to be
+ * heavy when the hints or its sync stage stand out from those averages, and its draw stage is
+ * then predicted by scaling the average with the ratio observed on previous heavy frames.
+ * Buffer dequeue is not modelled, as it is excluded from the reported work duration.
+ */
+class FrameCostPredictor {
+public:
+    struct Prediction {
+        // Expected duration of the draw stage
+        nsecs_t drawDuration = 0;
+        // Whether the frame is expected to be much more expensive than recent ones
+        bool heavy = false;
+    };
+
+    Prediction predict(nsecs_t syncDuration, const FrameCostHints& hints);
+
+    // Records the measured stages of the frame predict() was last called for
+    void addFrame(nsecs_t syncDuration, nsecs_t drawDuration);
+
+    bool hasHistory() const { return mHasHistory; }
+
+private:
+    static constexpr float kAverageWeight = 0.125f;
+    // How far above the averages a frame must be to be considered heavy
+    static constexpr float kHeavyFactor = 3.0f;
+    static constexpr int kMinHeavySyncedLists = 4;
+    static constexpr nsecs_t kMinHeavySyncDuration = 1_ms;
+    static constexpr float kDefaultHeavyDrawScale = 2.0f;
+    static constexpr float kMaxHeavyDrawScale = 8.0f;
+
+    bool mHasHistory = false;
+    float mAverageSync = 0;
+    float mAverageDraw = 0;
+    float mAverageSyncedLists = 0;
+    // Typical ratio of a heavy frame's draw stage to the average
+    float mHeavyDrawScale = kDefaultHeavyDrawScale;
+
+    bool mPendingHeavy = false;
+    int mPendingSyncedLists = 0;
+};
+
+} /* namespace renderthread */
+} /* namespace uirenderer */
+} /* namespace android */
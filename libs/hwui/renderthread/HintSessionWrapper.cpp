@@ -184,6 +184,29 @@ void HintSessionWrapper::sendLoadIncreaseHint() {
     mBinding->sendHint(mHintSession, static_cast<int32_t>(SessionHint::CPU_LOAD_UP));
 }
 
+void HintSessionWrapper::onFramePrepared(nsecs_t elapsedWork, nsecs_t syncDuration,
+                                         const FrameCostHints& hints) {
+    if (!Properties::usePredictiveHints) return;
+    const bool hadHistory = mPredictor.hasHistory();
+    const FrameCostPredictor::Prediction prediction = mPredictor.predict(syncDuration, hints);
+    if (!init()) return;
+    const int64_t target =
+            mLastTargetWorkDuration == 0 ? kDefaultTargetDuration : mLastTargetWorkDuration;
+    // Without any history, trust the hints alone
+    const bool expectMiss = hadHistory ? elapsedWork + prediction.drawDuration > target
+                                       : prediction.heavy;
+    if (expectMiss) {
+        mBinding->sendHint(mHintSession, static_cast<int32_t>(SessionHint::CPU_LOAD_UP));
+    }
+}
+
+void HintSessionWrapper::reportFrameStages(nsecs_t syncDuration, nsecs_t drawDuration) {
+    if (!Properties::usePredictiveHints) return;
+    if (syncDuration >= 0 && drawDuration >= 0) {
+        mPredictor.addFrame(syncDuration, drawDuration);
+    }
+}
+
 bool HintSessionWrapper::alive() {
     return mHintSession != nullptr;
 }
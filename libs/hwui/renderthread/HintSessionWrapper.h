@@ -24,6 +24,7 @@
 #include <optional>
 #include <vector>
 
+#include "FrameCostPredictor.h"
 #include "utils/TimeUtils.h"
 
 namespace android {
@@ -44,6 +45,12 @@ public:
     void reportActualWorkDuration(long actualDurationNanos);
     void sendLoadResetHint();
     void sendLoadIncreaseHint();
+    // Predicts the work duration of the frame about to be drawn, and sends a load up hint ahead
+    // of the draw if it is expected to exceed the target. elapsedWork is the work done on the
+    // frame so far, syncDuration the part of it spent syncing the tree.
+    void onFramePrepared(nsecs_t elapsedWork, nsecs_t syncDuration, const FrameCostHints& hints);
+    // Feeds the measured stages of the frame that was just drawn to the prediction
+    void reportFrameStages(nsecs_t syncDuration, nsecs_t drawDuration);
     bool init();
     void destroy();
     bool alive();
@@ -71,6 +78,8 @@ private:
 
     bool mSessionValid = true;
 
+    FrameCostPredictor mPredictor;
+
     static constexpr nsecs_t kResetHintTimeout = 100_ms;
     static constexpr int64_t kSanityCheckLowerBound = 100_us;
     static constexpr int64_t kSanityCheckUpperBound = 10_s;
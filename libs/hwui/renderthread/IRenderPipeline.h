@@ -23,6 +23,7 @@
 
 #include "ColorMode.h"
 #include "DamageAccumulator.h"
+#include "DamageRegion.h"
 #include "FrameInfoVisualizer.h"
 #include "HardwareBufferRenderParams.h"
 #include "LayerUpdateQueue.h"
@@ -61,15 +62,16 @@ public:
         nsecs_t commandSubmissionTime = kUnknownTime;
         android::base::unique_fd presentFence;
     };
-    virtual DrawResult draw(const Frame& frame, const SkRect& screenDirty, const SkRect& dirty,
-                            const LightGeometry& lightGeometry, LayerUpdateQueue* layerUpdateQueue,
-                            const Rect& contentDrawBounds, bool opaque, const LightInfo& lightInfo,
+    virtual DrawResult draw(const Frame& frame, const DamageRegion& screenDirty,
+                            const DamageRegion& dirty, const LightGeometry& lightGeometry,
+                            LayerUpdateQueue* layerUpdateQueue, const Rect& contentDrawBounds,
+                            bool opaque, const LightInfo& lightInfo,
                             const std::vector<sp<RenderNode>>& renderNodes,
                             FrameInfoVisualizer* profiler,
                             const HardwareBufferRenderParams& bufferParams,
                             std::mutex& profilerLock) = 0;
     virtual bool swapBuffers(const Frame& frame, IRenderPipeline::DrawResult&,
-                             const SkRect& screenDirty, FrameInfo* currentFrameInfo,
+                             const DamageRegion& screenDirty, FrameInfo* currentFrameInfo,
                              bool* requireSwap) = 0;
     virtual DeferredLayerUpdater* createTextureLayer() = 0;
     [[nodiscard]] virtual android::base::unique_fd flush() = 0;
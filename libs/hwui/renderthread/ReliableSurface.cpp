@@ -22,13 +22,9 @@
 #include <system/window.h>
 #include <vndk/window.h>
 
-namespace android::uirenderer::renderthread {
+#include "Properties.h"
 
-// TODO: Re-enable after addressing more of the TODO's
-// With this disabled we won't have a good up-front signal that the surface is no longer valid,
-// however we can at least handle that reactively post-draw. There's just not a good mechanism
-// to propagate this error back to the caller
-constexpr bool DISABLE_BUFFER_PREFETCH = true;
+namespace android::uirenderer::renderthread {
 
 ReliableSurface::ReliableSurface(ANativeWindow* window) : mWindow(window) {
     LOG_ALWAYS_FATAL_IF(!mWindow, "Error, unable to wrap a nullptr");
@@ -72,13 +68,17 @@ void ReliableSurface::init() {
 }
 
 int ReliableSurface::reserveNext() {
-    if constexpr (DISABLE_BUFFER_PREFETCH) {
+    // TODO: Enable by default after addressing more of the TODO's
+    // With this disabled we won't have a good up-front signal that the surface is no longer valid,
+    // however we can at least handle that reactively post-draw. There's just not a good mechanism
+    // to propagate this error back to the caller
+    if (!Properties::dequeueAhead) {
         return OK;
     }
     {
         std::lock_guard _lock{mMutex};
         if (mReservedBuffer) {
-            ALOGW("reserveNext called but there was already a buffer reserved?");
+            // Expected when the buffer was already dequeued ahead after the previous frame.
             return OK;
         }
         if (mBufferQueueState != OK) {
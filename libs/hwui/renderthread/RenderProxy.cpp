@@ -445,6 +445,16 @@ void RenderProxy::copySurfaceInto(ANativeWindow* window, std::shared_ptr<CopyReq
     });
 }
 
+void RenderProxy::copySurfaceInto(ANativeWindow* window,
+                                  std::shared_ptr<HardwareBufferCopyRequest>&& request) {
+    auto& thread = RenderThread::getInstance();
+    ANativeWindow_acquire(window);
+    thread.queue().post([&thread, window, request = std::move(request)] {
+        thread.readback().copySurfaceInto(window, request);
+        ANativeWindow_release(window);
+    });
+}
+
 void RenderProxy::prepareToDraw(Bitmap& bitmap) {
     // If we haven't spun up a hardware accelerated window yet, there's no
     // point in precaching these bitmaps as it can't impact jank.
@@ -484,6 +494,22 @@ int RenderProxy::copyHWBitmapInto(Bitmap* hwBitmap, SkBitmap* bitmap) {
     }
 }
 
+int RenderProxy::copyHWBitmapInto(Bitmap* hwBitmap, AHardwareBuffer* buffer, int* outFence) {
+    ATRACE_NAME("HardwareBitmap copy");
+    RenderThread& thread = RenderThread::getInstance();
+    auto copy = [&]() -> int {
+        base::unique_fd fence;
+        CopyResult result = thread.readback().copyHWBitmapInto(hwBitmap, buffer, &fence);
+        *outFence = fence.release();
+        return (int)result;
+    };
+    if (RenderThread::isCurrent()) {
+        return copy();
+    } else {
+        return thread.queue().runSync(copy);
+    }
+}
+
 int RenderProxy::copyImageInto(const sk_sp<SkImage>& image, SkBitmap* bitmap) {
     RenderThread& thread = RenderThread::getInstance();
     if (RenderThread::isCurrent()) {
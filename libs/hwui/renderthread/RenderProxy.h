@@ -146,9 +146,14 @@ public:
     void setForceDark(ForceDarkType type);
 
     static void copySurfaceInto(ANativeWindow* window, std::shared_ptr<CopyRequest>&& request);
+    static void copySurfaceInto(ANativeWindow* window,
+                                std::shared_ptr<HardwareBufferCopyRequest>&& request);
     static void prepareToDraw(Bitmap& bitmap);
 
     static int copyHWBitmapInto(Bitmap* hwBitmap, SkBitmap* bitmap);
+    // Copies into buffer and returns before the GPU is done. On success *outFence is set to a fence
+    // that signals once buffer holds the copy, or -1.
+    static int copyHWBitmapInto(Bitmap* hwBitmap, AHardwareBuffer* buffer, int* outFence);
     static int copyImageInto(const sk_sp<SkImage>& image, SkBitmap* bitmap);
 
     static void disableVsync();
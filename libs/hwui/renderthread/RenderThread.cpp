@@ -41,9 +41,11 @@
 #include "RenderProxy.h"
 #include "VulkanManager.h"
 #include "hwui/Bitmap.h"
+#include "hwui/BitmapPool.h"
 #include "pipeline/skia/SkiaOpenGLPipeline.h"
 #include "pipeline/skia/SkiaVulkanPipeline.h"
 #include "renderstate/RenderState.h"
+#include "thread/CommonPool.h"
 #include "utils/TimeUtils.h"
 
 namespace android {
@@ -304,8 +306,10 @@ void RenderThread::requireVkContext() {
     mVkManager->initialize();
     GrContextOptions options;
     initGrContextOptions(options);
-    auto vkDriverVersion = mVkManager->getDriverVersion();
-    cacheManager().configureContext(&options, &vkDriverVersion, sizeof(vkDriverVersion));
+    // The pipeline cache UUID changes whenever the driver's cache format does, even if the
+    // driver version does not.
+    const auto& cacheIdentity = mVkManager->getPipelineCacheIdentity();
+    cacheManager().configureContext(&options, &cacheIdentity, sizeof(cacheIdentity));
     sk_sp<GrDirectContext> grContext = mVkManager->createContext(options);
     LOG_ALWAYS_FATAL_IF(!grContext.get());
     setGrContext(grContext);
@@ -359,6 +363,8 @@ void RenderThread::dumpGraphicsMemory(int fd, bool includeProfileData) {
 
     String8 cachesOutput;
     mCacheManager->dumpMemoryUsage(cachesOutput, mRenderState);
+    CommonPool::dump(cachesOutput);
+    BitmapPool::get().dump(cachesOutput);
     dprintf(fd, "\nPipeline=%s\n%s", pipelineToString(), cachesOutput.c_str());
     for (auto&& context : mCacheManager->mCanvasContexts) {
         context->visitAllRenderNodes([&](const RenderNode& node) {
@@ -384,6 +390,9 @@ Readback& RenderThread::readback() {
 
 void RenderThread::setGrContext(sk_sp<GrDirectContext> context) {
     mCacheManager->reset(context);
+    if (mReadback) {
+        mReadback->releaseIntermediates();
+    }
     if (mGrContext) {
         mRenderState->onContextDestroyed();
         mGrContext->releaseResourcesAndAbandonContext();
@@ -518,8 +527,15 @@ bool RenderThread::isCurrent() {
 void RenderThread::preload() {
     // EGL driver is always preloaded only if HWUI renders with GL.
     if (Properties::getRenderPipelineType() == RenderPipelineType::SkiaGL) {
-        std::thread eglInitThread([]() { eglGetDisplay(EGL_DEFAULT_DISPLAY); });
-        eglInitThread.detach();
+        if (Properties::prewarmGpuContext()) {
+            // Bring up the context and the shader cache here, while the app is still starting,
+            // rather than on the first frame.
+            ATRACE_NAME("prewarmGlContext");
+            requireGlContext();
+        } else {
+            std::thread eglInitThread([]() { eglGetDisplay(EGL_DEFAULT_DISPLAY); });
+            eglInitThread.detach();
+        }
     } else {
         requireVkContext();
     }
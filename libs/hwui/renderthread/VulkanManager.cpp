@@ -222,6 +222,11 @@ void VulkanManager::setupDevice(skgpu::VulkanExtensions& grExtensions,
     mGetPhysicalDeviceProperties(mPhysicalDevice, &physDeviceProperties);
     LOG_ALWAYS_FATAL_IF(physDeviceProperties.apiVersion < VK_MAKE_VERSION(1, 1, 0));
     mDriverVersion = physDeviceProperties.driverVersion;
+    mPipelineCacheIdentity.vendorID = physDeviceProperties.vendorID;
+    mPipelineCacheIdentity.deviceID = physDeviceProperties.deviceID;
+    mPipelineCacheIdentity.driverVersion = physDeviceProperties.driverVersion;
+    memcpy(mPipelineCacheIdentity.pipelineCacheUUID, physDeviceProperties.pipelineCacheUUID,
+           VK_UUID_SIZE);
 
     // query to get the initial queue props size
     uint32_t queueCount = 0;
@@ -569,12 +574,9 @@ Frame VulkanManager::dequeueNextBuffer(VulkanSurface* surface) {
     LOG_ALWAYS_FATAL_IF(!bufferInfo->dequeued);
 
     if (bufferInfo->dequeue_fence != -1) {
-        struct sync_file_info* finfo = sync_file_info(bufferInfo->dequeue_fence);
-        bool isSignalPending = false;
-        if (finfo != NULL) {
-            isSignalPending = finfo->status != 1;
-            sync_file_info_free(finfo);
-        }
+        // A zero-timeout wait is a single poll(), whereas sync_file_info() needs two ioctls and
+        // an allocation just to learn whether the fence already signaled.
+        const bool isSignalPending = sync_wait(bufferInfo->dequeue_fence, 0) != 0;
         if (isSignalPending) {
             int fence_clone = dup(bufferInfo->dequeue_fence);
             if (fence_clone == -1) {
@@ -734,14 +736,14 @@ VulkanManager::VkDrawResult VulkanManager::finishFrame(SkSurface* surface) {
     return drawResult;
 }
 
-void VulkanManager::swapBuffers(VulkanSurface* surface, const SkRect& dirtyRect,
+void VulkanManager::swapBuffers(VulkanSurface* surface, const DamageRegion& dirtyRegion,
                                 android::base::unique_fd&& presentFence) {
     if (CC_UNLIKELY(Properties::waitForGpuCompletion)) {
         ATRACE_NAME("Finishing GPU work");
         mDeviceWaitIdle(mDevice);
     }
 
-    surface->presentCurrentBuffer(dirtyRect, presentFence.release());
+    surface->presentCurrentBuffer(dirtyRegion, presentFence.release());
 }
 
 void VulkanManager::destroySurface(VulkanSurface* surface) {
@@ -91,7 +91,7 @@ public:
 
     // Finishes the frame and submits work to the GPU
     VkDrawResult finishFrame(SkSurface* surface);
-    void swapBuffers(VulkanSurface* surface, const SkRect& dirtyRect,
+    void swapBuffers(VulkanSurface* surface, const DamageRegion& dirtyRegion,
                      android::base::unique_fd&& presentFence);
 
     // Inserts a wait on fence command into the Vulkan command buffer.
@@ -118,6 +118,19 @@ public:
 
     uint32_t getDriverVersion() const { return mDriverVersion; }
 
+    // Identifies the format of the driver's pipeline cache data. Persisted shader and pipeline
+    // caches are discarded when it changes.
+    struct PipelineCacheIdentity {
+        uint32_t vendorID = 0;
+        uint32_t deviceID = 0;
+        uint32_t driverVersion = 0;
+        uint8_t pipelineCacheUUID[VK_UUID_SIZE] = {};
+    };
+
+    const PipelineCacheIdentity& getPipelineCacheIdentity() const {
+        return mPipelineCacheIdentity;
+    }
+
 private:
     friend class VulkanSurface;
 
@@ -207,6 +220,7 @@ private:
     SwapBehavior mSwapBehavior = SwapBehavior::Discard;
     skgpu::VulkanExtensions mExtensions;
     uint32_t mDriverVersion = 0;
+    PipelineCacheIdentity mPipelineCacheIdentity;
 
     std::once_flag mInitFlag;
     std::atomic_bool mInitialized = false;
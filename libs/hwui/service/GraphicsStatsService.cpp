@@ -108,20 +108,15 @@ private:
     io::CopyingOutputStreamAdaptor mImpl;
 };
 
-bool GraphicsStatsService::parseFromFile(const std::string& path,
-                                         protos::GraphicsStatsProto* output) {
-    FileDescriptor fd{open(path.c_str(), O_RDONLY)};
-    if (!fd.valid()) {
-        int err = errno;
-        // The file not existing is normal for addToDump(), so only log if
-        // we get an unexpected error
-        if (err != ENOENT) {
-            ALOGW("Failed to open '%s', errno=%d (%s)", path.c_str(), err, strerror(err));
-        }
+// Parses the stats file already open at fd. An empty file is treated like a missing one, as
+// saveBuffer() creates the file before reading it.
+static bool parseFromFd(int fd, const std::string& path, protos::GraphicsStatsProto* output) {
+    struct stat sb;
+    const int statResult = fstat(fd, &sb);
+    if (statResult == 0 && sb.st_size == 0) {
         return false;
     }
-    struct stat sb;
-    if (fstat(fd, &sb) || sb.st_size < sHeaderSize) {
+    if (statResult || sb.st_size < sHeaderSize) {
         int err = errno;
         // The file not existing is normal for addToDump(), so only log if
         // we get an unexpected error
@@ -160,6 +155,21 @@ bool GraphicsStatsService::parseFromFile(const std::string& path,
     return success;
 }
 
+bool GraphicsStatsService::parseFromFile(const std::string& path,
+                                         protos::GraphicsStatsProto* output) {
+    FileDescriptor fd{open(path.c_str(), O_RDONLY)};
+    if (!fd.valid()) {
+        int err = errno;
+        // The file not existing is normal for addToDump(), so only log if
+        // we get an unexpected error
+        if (err != ENOENT) {
+            ALOGW("Failed to open '%s', errno=%d (%s)", path.c_str(), err, strerror(err));
+        }
+        return false;
+    }
+    return parseFromFd(fd, path, output);
+}
+
 bool mergeProfileDataIntoProto(protos::GraphicsStatsProto* proto, uid_t uid,
                                const std::string& package, int64_t versionCode, int64_t startTime,
                                int64_t endTime, const ProfileData* data) {
@@ -325,8 +335,15 @@ void dumpAsTextToFd(protos::GraphicsStatsProto* proto, int fd) {
 void GraphicsStatsService::saveBuffer(const std::string& path, uid_t uid,
                                       const std::string& package, int64_t versionCode,
                                       int64_t startTime, int64_t endTime, const ProfileData* data) {
+    // Read the existing stats and write the merged ones back through a single fd.
+    FileDescriptor fd{open(path.c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0660)};
+    if (!fd.valid()) {
+        int err = errno;
+        ALOGW("Failed to open '%s', error=%d (%s)", path.c_str(), err, strerror(err));
+        return;
+    }
     protos::GraphicsStatsProto statsProto;
-    if (!parseFromFile(path, &statsProto)) {
+    if (!parseFromFd(fd, path, &statsProto)) {
         statsProto.Clear();
     }
     if (!mergeProfileDataIntoProto(&statsProto, uid, package, versionCode, startTime, endTime,
@@ -344,32 +361,30 @@ void GraphicsStatsService::saveBuffer(const std::string& path, uid_t uid,
               statsProto.has_summary());
         return;
     }
-    int outFd = open(path.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0660);
-    if (outFd <= 0) {
-        int err = errno;
-        ALOGW("Failed to open '%s', error=%d (%s)", path.c_str(), err, strerror(err));
+    // Serialize the header and proto into one buffer so the file is rewritten with a single
+    // write rather than a header write plus chunked proto writes.
+    std::string buffer(sHeaderSize, '\0');
+    memcpy(buffer.data(), &sCurrentFileVersion, sHeaderSize);
+    if (!statsProto.AppendToString(&buffer)) {
+        ALOGW("Serialize failed on '%s' unknown error", path.c_str());
         return;
     }
-    int wrote = write(outFd, &sCurrentFileVersion, sHeaderSize);
-    if (wrote != sHeaderSize) {
-        int err = errno;
-        ALOGW("Failed to write header to '%s', returned=%d errno=%d (%s)", path.c_str(), wrote, err,
-              strerror(err));
-        close(outFd);
-        return;
-    }
-    {
-        FileOutputStreamLite output(outFd);
-        bool success = statsProto.SerializeToZeroCopyStream(&output) && output.Flush();
-        if (output.GetErrno() != 0) {
-            ALOGW("Error writing to fd=%d, path='%s' err=%d (%s)", outFd, path.c_str(),
-                  output.GetErrno(), strerror(output.GetErrno()));
-            success = false;
-        } else if (!success) {
-            ALOGW("Serialize failed on '%s' unknown error", path.c_str());
+    size_t written = 0;
+    while (written < buffer.size()) {
+        ssize_t ret = TEMP_FAILURE_RETRY(
+                pwrite(fd, buffer.data() + written, buffer.size() - written, written));
+        if (ret <= 0) {
+            int err = errno;
+            ALOGW("Error writing to fd=%d, path='%s' err=%d (%s)", static_cast<int>(fd),
+                  path.c_str(), err, strerror(err));
+            return;
         }
+        written += ret;
+    }
+    if (ftruncate(fd, buffer.size())) {
+        int err = errno;
+        ALOGW("Failed to truncate '%s', error=%d (%s)", path.c_str(), err, strerror(err));
     }
-    close(outFd);
 }
 
 class GraphicsStatsService::Dump {
@@ -16,13 +16,22 @@
 
 #include "tests/common/TestContext.h"
 
+#ifdef __ANDROID__
 #include <com_android_graphics_libgui_flags.h>
 #include <cutils/trace.h>
+#else
+#include <gui/BufferQueue.h>
+#endif
 
 namespace android {
 namespace uirenderer {
 namespace test {
 
+#ifdef __ANDROID__
+float getDisplayDensity() {
+    return getDisplayInfo().density;
+}
+
 const ui::StaticDisplayInfo& getDisplayInfo() {
     static ui::StaticDisplayInfo info = [] {
         ui::StaticDisplayInfo info;
@@ -72,6 +81,18 @@ TestContext::TestContext() {
     constexpr int EVENT_ID = 1;
     mLooper->addFd(mDisplayEventReceiver.getFd(), EVENT_ID, Looper::EVENT_INPUT, nullptr, nullptr);
 }
+#else
+float getDisplayDensity() {
+    return 2.f;
+}
+
+const ui::Size& getActiveDisplayResolution() {
+    static const ui::Size resolution(1080, 1920);
+    return resolution;
+}
+
+TestContext::TestContext() {}
+#endif
 
 TestContext::~TestContext() {}
 
@@ -90,6 +111,7 @@ void TestContext::createSurface() {
     }
 }
 
+#ifdef __ANDROID__
 void TestContext::createWindowSurface() {
     const ui::Size& resolution = getActiveDisplayResolution();
     mSurfaceControl =
@@ -121,12 +143,30 @@ void TestContext::createOffscreenSurface() {
     mSurface = new Surface(producer);
 #endif  // COM_ANDROID_GRAPHICS_LIBGUI_FLAGS(WB_CONSUMER_BASE_OWNS_BQ)
 }
+#else
+void TestContext::createWindowSurface() {
+    LOG_ALWAYS_FATAL("There is no window to render to on host, use an offscreen surface");
+}
+
+void TestContext::createOffscreenSurface() {
+    // Backed by HostBufferQueue, which hands out a single CPU buffer of the display size.
+    sp<IGraphicBufferProducer> producer;
+    sp<IGraphicBufferConsumer> consumer;
+    BufferQueue::createBufferQueue(&producer, &consumer);
+    mConsumer = new BufferItemConsumer(consumer, 0, 1, false);
+    const ui::Size& resolution = getActiveDisplayResolution();
+    mConsumer->setDefaultBufferSize(resolution.getWidth(), resolution.getHeight());
+    mSurface = new Surface(producer);
+}
+#endif
 
 void TestContext::waitForVsync() {
     // Hacky fix for not getting sysprop change callbacks
     // We just poll the sysprop in vsync since it's when the UI thread is
     // "idle" and shouldn't burn too much time
+#ifdef __ANDROID__
     atrace_update_tags();
+#endif
 
     if (mConsumer.get()) {
         BufferItem buffer;
@@ -138,7 +178,7 @@ void TestContext::waitForVsync() {
         // We running free, go go go!
         return;
     }
-#if !HWUI_NULL_GPU
+#if defined(__ANDROID__) && !HWUI_NULL_GPU
     // Request vsync
     mDisplayEventReceiver.requestNextVsync();
 
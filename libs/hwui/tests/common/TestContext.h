@@ -18,30 +18,41 @@
 #define TESTCONTEXT_H
 
 #include <gui/BufferItemConsumer.h>
+#include <gui/Surface.h>
+#ifdef __ANDROID__
 #include <gui/DisplayEventReceiver.h>
 #include <gui/ISurfaceComposer.h>
-#include <gui/Surface.h>
 #include <gui/SurfaceComposerClient.h>
 #include <gui/SurfaceControl.h>
 #include <ui/DisplayMode.h>
 #include <ui/StaticDisplayInfo.h>
 #include <utils/Looper.h>
+#else
+#include <ui/Size.h>
+#endif
 
 #include <atomic>
 #include <thread>
 
-#define dp(x) ((x) * android::uirenderer::test::getDisplayInfo().density)
+#define dp(x) ((x) * android::uirenderer::test::getDisplayDensity())
 
 namespace android {
 namespace uirenderer {
 namespace test {
 
+float getDisplayDensity();
+
+#ifdef __ANDROID__
 const ui::StaticDisplayInfo& getDisplayInfo();
 const ui::DisplayMode& getActiveDisplayMode();
 
 inline const ui::Size& getActiveDisplayResolution() {
     return getActiveDisplayMode().resolution;
 }
+#else
+// There is no display on host, scenes are laid out for a fixed 1080x1920 xhdpi screen.
+const ui::Size& getActiveDisplayResolution();
+#endif
 
 class TestContext {
 public:
@@ -63,13 +74,15 @@ private:
     void createWindowSurface();
     void createOffscreenSurface();
 
+#ifdef __ANDROID__
     sp<SurfaceComposerClient> mSurfaceComposerClient;
     sp<SurfaceControl> mSurfaceControl;
-    sp<BufferItemConsumer> mConsumer;
     DisplayEventReceiver mDisplayEventReceiver;
     sp<Looper> mLooper;
+#endif
+    sp<BufferItemConsumer> mConsumer;
     sp<Surface> mSurface;
-    bool mRenderOffscreen;
+    bool mRenderOffscreen = true;
 };
 
 }  // namespace test
@@ -22,10 +22,12 @@
 #include <hwui/MinikinSkia.h>
 #include <hwui/Typeface.h>
 #include <minikin/Layout.h>
+#ifdef __ANDROID__
 #include <pipeline/skia/SkiaOpenGLPipeline.h>
 #include <pipeline/skia/SkiaVulkanPipeline.h>
 #include <renderthread/EglManager.h>
 #include <renderthread/VulkanManager.h>
+#endif
 #include <utils/Unicode.h>
 
 #include "SkCanvas.h"
@@ -60,6 +62,7 @@ SkColor TestUtils::interpolateColor(float fraction, SkColor start, SkColor end)
            (int)((startB + (int)(fraction * (endB - startB))));
 }
 
+#ifdef __ANDROID__
 sp<DeferredLayerUpdater> TestUtils::createTextureLayerUpdater(
         renderthread::RenderThread& renderThread) {
     android::uirenderer::renderthread::IRenderPipeline* pipeline;
@@ -86,6 +89,7 @@ sp<DeferredLayerUpdater> TestUtils::createTextureLayerUpdater(
     layerUpdater->updateLayer(true, nullptr, 0, SkRect::MakeEmpty());
     return layerUpdater;
 }
+#endif
 
 void TestUtils::drawUtf8ToCanvas(Canvas* canvas, const char* text, const Paint& paint, float x,
                                  float y) {
@@ -105,6 +109,7 @@ void TestUtils::drawUtf8ToCanvas(Canvas* canvas, const char* text, const Paint&
                            nullptr);
 }
 
+#ifdef __ANDROID__
 void TestUtils::TestTask::run() {
     // RenderState only valid once RenderThread is running, so queried here
     renderthread::RenderThread& renderThread = renderthread::RenderThread::getInstance();
@@ -118,6 +123,7 @@ void TestUtils::TestTask::run() {
 
     renderThread.destroyRenderingContext();
 }
+#endif
 
 std::unique_ptr<uint16_t[]> TestUtils::asciiToUtf16(const char* str) {
     const int length = strlen(str);
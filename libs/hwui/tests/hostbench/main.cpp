@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Runs the macrobench TestScenes headless on the host, through SkiaCpuPipeline and the
+// libhostgraphics buffer queue, and reports where each frame spent its time.
+//
+// Every scene is registered as a google-benchmark, so the usual flags apply, e.g.
+//   hwuihostbench --benchmark_filter=listview --benchmark_format=json
+
+#include "AnimationContext.h"
+#include "FrameInfo.h"
+#include "FrameMetricsObserver.h"
+#include "Properties.h"
+#include "RenderNode.h"
+#include "hwui/Typeface.h"
+#include "renderthread/RenderProxy.h"
+#include "tests/common/TestContext.h"
+#include "tests/common/TestScene.h"
+#include "tests/common/TestUtils.h"
+
+#include <benchmark/benchmark.h>
+#include <gui/Surface.h>
+
+#include <mutex>
+
+using namespace android;
+using namespace android::uirenderer;
+using namespace android::uirenderer::renderthread;
+using namespace android::uirenderer::test;
+
+namespace {
+
+constexpr int kWarmupFrameCount = 5;
+
+class ContextFactory : public IContextFactory {
+public:
+    AnimationContext* createAnimationContext(renderthread::TimeLord& clock) override {
+        return new AnimationContext(clock);
+    }
+};
+
+// Accumulates the render thread stages of every reported frame. Notified on the render thread.
+class StageTimings : public FrameMetricsObserver {
+public:
+    StageTimings() : FrameMetricsObserver(false) {}
+
+    void notify(const int64_t* buffer) override {
+        std::lock_guard lock(mLock);
+        mFrames++;
+        mRecordNs += duration(buffer, FrameInfoIndex::DrawStart, FrameInfoIndex::SyncQueued);
+        mSyncNs += duration(buffer, FrameInfoIndex::SyncStart,
+                            FrameInfoIndex::IssueDrawCommandsStart);
+        mDrawNs += duration(buffer, FrameInfoIndex::IssueDrawCommandsStart,
+                            FrameInfoIndex::SwapBuffers);
+        mTotalNs += duration(buffer, FrameInfoIndex::DrawStart, FrameInfoIndex::FrameCompleted);
+    }
+
+    void reset() {
+        std::lock_guard lock(mLock);
+        mFrames = 0;
+        mRecordNs = mSyncNs = mDrawNs = mTotalNs = 0;
+    }
+
+    void report(benchmark::State& state) {
+        std::lock_guard lock(mLock);
+        using benchmark::Counter;
+        // Counters are per-iteration averages, and every iteration is exactly one frame.
+        state.counters["frames_reported"] = mFrames;
+        state.counters["record_ms"] = Counter(mRecordNs / 1e6, Counter::kAvgIterations);
+        state.counters["sync_ms"] = Counter(mSyncNs / 1e6, Counter::kAvgIterations);
+        state.counters["draw_ms"] = Counter(mDrawNs / 1e6, Counter::kAvgIterations);
+        state.counters["frame_ms"] = Counter(mTotalNs / 1e6, Counter::kAvgIterations);
+    }
+
+private:
+    static double duration(const int64_t* buffer, FrameInfoIndex start, FrameInfoIndex end) {
+        int64_t startTime = buffer[static_cast<int>(start)];
+        int64_t endTime = buffer[static_cast<int>(end)];
+        return (startTime > 0 && endTime > startTime) ? endTime - startTime : 0;
+    }
+
+    std::mutex mLock;
+    int64_t mFrames = 0;
+    double mRecordNs = 0;
+    double mSyncNs = 0;
+    double mDrawNs = 0;
+    double mTotalNs = 0;
+};
+
+void beginFrame(RenderProxy& proxy) {
+    nsecs_t vsync = systemTime(SYSTEM_TIME_MONOTONIC);
+    UiFrameInfoBuilder(proxy.frameInfo())
+            .setVsync(vsync, vsync, UiFrameInfoBuilder::INVALID_VSYNC_ID,
+                      UiFrameInfoBuilder::UNKNOWN_DEADLINE,
+                      UiFrameInfoBuilder::UNKNOWN_FRAME_INTERVAL);
+    proxy.frameInfo()[static_cast<int>(FrameInfoIndex::DrawStart)] =
+            systemTime(SYSTEM_TIME_MONOTONIC);
+}
+
+void runScene(benchmark::State& state, const TestScene::Info& info) {
+    TestScene::Options opts;
+    TestContext testContext;
+    testContext.setRenderOffscreen(true);
+
+    const ui::Size& resolution = getActiveDisplayResolution();
+    const int width = resolution.getWidth();
+    const int height = resolution.getHeight();
+    sp<Surface> surface = testContext.surface();
+
+    std::unique_ptr<TestScene> scene(info.createScene(opts));
+    scene->renderTarget = surface;
+
+    sp<RenderNode> rootNode = TestUtils::createNode(
+            0, 0, width, height, [&scene, width, height](RenderProperties& props, Canvas& canvas) {
+                props.setClipToBounds(false);
+                scene->createContent(width, height, canvas);
+            });
+
+    ContextFactory factory;
+    RenderProxy proxy(false, rootNode.get(), &factory);
+    proxy.loadSystemProperties();
+    proxy.setSurface(surface.get());
+    proxy.setLightAlpha(255 * 0.075, 255 * 0.15);
+    proxy.setLightGeometry((Vector3){width / 2.0f, dp(-200.0f), dp(800.0f)}, dp(800.0f));
+
+    sp<StageTimings> timings = sp<StageTimings>::make();
+    proxy.addFrameMetricsObserver(timings.get());
+
+    int frame = 0;
+    for (; frame < kWarmupFrameCount; frame++) {
+        beginFrame(proxy);
+        scene->doFrame(frame);
+        proxy.forceDrawNextFrame();
+        proxy.syncAndDrawFrame();
+    }
+    proxy.fence();
+    timings->reset();
+
+    for (auto _ : state) {
+        testContext.waitForVsync();
+        beginFrame(proxy);
+        scene->doFrame(frame++);
+        proxy.forceDrawNextFrame();
+        proxy.syncAndDrawFrame();
+        // Frames are serialized so that each iteration measures exactly one frame.
+        proxy.fence();
+    }
+
+    proxy.removeFrameMetricsObserver(timings.get());
+    timings->report(state);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    // Must happen before the render thread starts, it is the only pipeline available on host.
+    Properties::overrideRenderPipelineType(RenderPipelineType::SkiaCpu);
+    Typeface::setRobotoTypefaceForTest();
+
+    for (const auto& [name, info] : TestScene::testMap()) {
+        benchmark::RegisterBenchmark(name.c_str(), [info](benchmark::State& state) {
+            runScene(state, info);
+        })->Unit(benchmark::kMillisecond);
+    }
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "utils/Blur.h"
+
+#include <cstdlib>
+#include <vector>
+
+using namespace android;
+using namespace android::uirenderer;
+
+static constexpr int32_t kWidth = 512;
+static constexpr int32_t kHeight = 512;
+
+static std::vector<uint8_t> makeMask() {
+    std::vector<uint8_t> mask(kWidth * kHeight);
+    for (auto& pixel : mask) {
+        pixel = rand();
+    }
+    return mask;
+}
+
+static void runSeparable(benchmark::State& state, Blur::Kernel kernel) {
+    const int32_t radius = state.range(0);
+    std::vector<float> weights(2 * radius + 1);
+    Blur::generateGaussianWeights(weights.data(), radius);
+    std::vector<uint8_t> source = makeMask();
+    std::vector<uint8_t> scratch(source.size());
+    std::vector<uint8_t> dest(source.size());
+    while (state.KeepRunning()) {
+        Blur::horizontal(weights.data(), radius, source.data(), scratch.data(), kWidth, kHeight,
+                         kernel);
+        Blur::vertical(weights.data(), radius, scratch.data(), dest.data(), kWidth, kHeight,
+                       kernel);
+        benchmark::DoNotOptimize(dest.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kWidth * kHeight);
+}
+
+static void BM_Blur_separableScalar(benchmark::State& state) {
+    runSeparable(state, Blur::Kernel::Scalar);
+}
+BENCHMARK(BM_Blur_separableScalar)->Arg(2)->Arg(8)->Arg(16);
+
+static void BM_Blur_separable(benchmark::State& state) {
+    runSeparable(state, Blur::Kernel::Auto);
+}
+BENCHMARK(BM_Blur_separable)->Arg(2)->Arg(8)->Arg(16);
+
+static void BM_Blur_blur(benchmark::State& state) {
+    std::vector<uint8_t> source = makeMask();
+    std::vector<uint8_t> dest(source.size());
+    while (state.KeepRunning()) {
+        Blur::blur(state.range(0), source.data(), dest.data(), kWidth, kHeight);
+        benchmark::DoNotOptimize(dest.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kWidth * kHeight);
+}
+// Radii above Blur::kMaxGaussianRadius use the box blur approximation
+BENCHMARK(BM_Blur_blur)->Arg(8)->Arg(16)->Arg(32)->Arg(64);
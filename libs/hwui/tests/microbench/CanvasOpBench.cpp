@@ -20,6 +20,7 @@
 #include "hwui/Paint.h"
 #include "canvas/CanvasOpBuffer.h"
 #include "canvas/CanvasFrontend.h"
+#include "canvas/CanvasOpRasterizer.h"
 #include "tests/common/TestUtils.h"
 
 using namespace android;
@@ -95,3 +96,25 @@ void BM_CanvasOpBuffer_record_simpleBitmapView(benchmark::State& benchState) {
     }
 }
 BENCHMARK(BM_CanvasOpBuffer_record_simpleBitmapView);
+
+void BM_CanvasOpBuffer_rasterize_rectRun(benchmark::State& benchState) {
+    CanvasFrontend<CanvasOpBuffer> canvas(100, 100);
+    SkPaint rectPaint;
+    for (int i = 0; i < 100; i++) {
+        rectPaint.setColor(i % 2 ? SK_ColorRED : SK_ColorBLUE);
+        canvas.draw(CanvasOp<CanvasOpType::DrawRect> {
+                .rect = SkRect::MakeXYWH(i % 10 * 10, i / 10 * 10, 10, 10),
+                .paint = rectPaint,
+        });
+    }
+    const CanvasOpBuffer& buffer = canvas.receiver();
+
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(100, 100);
+    SkCanvas skCanvas(bitmap);
+    while (benchState.KeepRunning()) {
+        rasterizeCanvasBuffer(buffer, &skCanvas);
+        benchmark::DoNotOptimize(&skCanvas);
+    }
+}
+BENCHMARK(BM_CanvasOpBuffer_rasterize_rectRun);
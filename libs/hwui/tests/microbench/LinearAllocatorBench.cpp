@@ -46,3 +46,18 @@ static void BM_LinearStdAllocator_vector(benchmark::State& state) {
     }
 }
 BENCHMARK(BM_LinearStdAllocator_vector);
+
+static void BM_LinearAllocator_recycle(benchmark::State& state) {
+    size_t reusedPages = 0;
+    while (state.KeepRunning()) {
+        // Roughly the allocation pattern of recording a display list with a few hundred ops
+        LinearAllocator la;
+        for (int j = 0; j < 300; j++) {
+            benchmark::DoNotOptimize(la.alloc<char>(48));
+        }
+        reusedPages += la.reusedPageCount();
+    }
+    state.counters["reused_pages"] =
+            benchmark::Counter(reusedPages, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_LinearAllocator_recycle);
@@ -28,6 +28,8 @@ static const char* sPathString =
         "M 1 1 m 2 2, l 3 3 L 3 3 H 4 h4 V5 v5, Q6 6 6 6 q 6 6 6 6t 7 7 T 7 7 C 8 8 8 8 8 8 c 8 8 "
         "8 8 8 8 S 9 9 9 9 s 9 9 9 9 A 10 10 0 1 1 10 10 a 10 10 0 1 1 10 10";
 
+// Parsing a string seen before is served from PathParser's cache. The _cold variants clear the
+// cache first to measure the parser itself.
 void BM_PathParser_parseStringPathForSkPath(benchmark::State& state) {
     SkPath skPath;
     size_t length = strlen(sPathString);
@@ -51,3 +53,29 @@ void BM_PathParser_parseStringPathForPathData(benchmark::State& state) {
     }
 }
 BENCHMARK(BM_PathParser_parseStringPathForPathData);
+
+void BM_PathParser_parseStringPathForSkPath_cold(benchmark::State& state) {
+    SkPath skPath;
+    size_t length = strlen(sPathString);
+    PathParser::ParseResult result;
+    while (state.KeepRunning()) {
+        PathParser::clearCache();
+        PathParser::parseAsciiStringForSkPath(&skPath, &result, sPathString, length);
+        benchmark::DoNotOptimize(&result);
+        benchmark::DoNotOptimize(&skPath);
+    }
+}
+BENCHMARK(BM_PathParser_parseStringPathForSkPath_cold);
+
+void BM_PathParser_parseStringPathForPathData_cold(benchmark::State& state) {
+    size_t length = strlen(sPathString);
+    PathParser::ParseResult result;
+    while (state.KeepRunning()) {
+        PathData outData;
+        PathParser::clearCache();
+        PathParser::getPathDataFromAsciiString(&outData, &result, sPathString, length);
+        benchmark::DoNotOptimize(&result);
+        benchmark::DoNotOptimize(&outData);
+    }
+}
+BENCHMARK(BM_PathParser_parseStringPathForPathData_cold);
@@ -16,8 +16,14 @@
 
 #include <benchmark/benchmark.h>
 
-#include "hwui/Canvas.h"
+#include "AnimationContext.h"
+#include "DamageAccumulator.h"
+#include "IContextFactory.h"
 #include "RenderNode.h"
+#include "TreeInfo.h"
+#include "hwui/Canvas.h"
+#include "renderthread/CanvasContext.h"
+#include "tests/common/TestUtils.h"
 
 #include <SkBlendMode.h>
 
@@ -46,3 +52,47 @@ void BM_RenderNode_recordSimple(benchmark::State& state) {
     }
 }
 BENCHMARK(BM_RenderNode_recordSimple);
+
+class ContextFactory : public IContextFactory {
+public:
+    AnimationContext* createAnimationContext(renderthread::TimeLord& clock) override {
+        return new AnimationContext(clock);
+    }
+};
+
+static sp<RenderNode> createTree(int fanout, int depth) {
+    return TestUtils::createNode(0, 0, 100, 100, [fanout, depth](RenderProperties& props,
+                                                                 Canvas& canvas) {
+        canvas.drawColor(0xFFFFFFFF, SkBlendMode::kSrcOver);
+        for (int i = 0; depth > 0 && i < fanout; i++) {
+            canvas.drawRenderNode(createTree(fanout, depth - 1).get());
+        }
+    });
+}
+
+// Measures the RenderThread walk of a synced tree of fanout^depth nodes, to see how
+// prepareTree() scales with the width and the depth of the hierarchy.
+void BM_RenderNode_prepareTree(benchmark::State& state) {
+    sp<RenderNode> root = createTree(state.range(0), state.range(1));
+    TestUtils::syncHierarchyPropertiesAndDisplayList(root);
+
+    TestUtils::runOnRenderThreadUnmanaged([&](renderthread::RenderThread& thread) {
+        ContextFactory contextFactory;
+        std::unique_ptr<renderthread::CanvasContext> canvasContext(
+                renderthread::CanvasContext::create(thread, false, root.get(), &contextFactory, 0,
+                                                    0));
+        while (state.KeepRunning()) {
+            TreeInfo info(TreeInfo::MODE_RT_ONLY, *canvasContext.get());
+            DamageAccumulator damageAccumulator;
+            info.damageAccumulator = &damageAccumulator;
+            root->prepareTree(info);
+            benchmark::DoNotOptimize(damageAccumulator);
+        }
+        canvasContext->destroy();
+    });
+}
+BENCHMARK(BM_RenderNode_prepareTree)
+        ->Args({64, 1})
+        ->Args({8, 2})
+        ->Args({4, 4})
+        ->Args({2, 8});
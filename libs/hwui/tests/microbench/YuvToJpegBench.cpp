@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <SkStream.h>
+#include <benchmark/benchmark.h>
+#include <hardware/hardware.h>
+
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "jni/YuvToJpegEncoder.h"
+
+// A 12 MP camera frame.
+static constexpr int kWidth = 4000;
+static constexpr int kHeight = 3000;
+
+static void runEncode(benchmark::State& state, int format, bool parallel) {
+    const bool nv21 = format == HAL_PIXEL_FORMAT_YCrCb_420_SP;
+    int strides[2];
+    int offsets[2] = {0, kWidth * kHeight};
+    size_t size;
+    if (nv21) {
+        strides[0] = strides[1] = kWidth;
+        size = kWidth * kHeight * 3 / 2;
+    } else {
+        strides[0] = kWidth * 2;
+        size = kWidth * kHeight * 2;
+    }
+    std::vector<uint8_t> yuv(size);
+    for (auto& byte : yuv) {
+        byte = rand();
+    }
+    std::unique_ptr<YuvToJpegEncoder> encoder(YuvToJpegEncoder::create(format, strides));
+    encoder->setParallelEncodeEnabled(parallel);
+    while (state.KeepRunning()) {
+        SkNullWStream stream;
+        encoder->encode(&stream, yuv.data(), kWidth, kHeight, offsets, 90);
+        benchmark::DoNotOptimize(stream.bytesWritten());
+    }
+    state.SetItemsProcessed(state.iterations() * kWidth * kHeight);
+}
+
+static void BM_YuvToJpeg_nv21Serial(benchmark::State& state) {
+    runEncode(state, HAL_PIXEL_FORMAT_YCrCb_420_SP, false);
+}
+BENCHMARK(BM_YuvToJpeg_nv21Serial);
+
+static void BM_YuvToJpeg_nv21(benchmark::State& state) {
+    runEncode(state, HAL_PIXEL_FORMAT_YCrCb_420_SP, true);
+}
+BENCHMARK(BM_YuvToJpeg_nv21);
+
+static void BM_YuvToJpeg_yuy2Serial(benchmark::State& state) {
+    runEncode(state, HAL_PIXEL_FORMAT_YCbCr_422_I, false);
+}
+BENCHMARK(BM_YuvToJpeg_yuy2Serial);
+
+static void BM_YuvToJpeg_yuy2(benchmark::State& state) {
+    runEncode(state, HAL_PIXEL_FORMAT_YCbCr_422_I, true);
+}
+BENCHMARK(BM_YuvToJpeg_yuy2);
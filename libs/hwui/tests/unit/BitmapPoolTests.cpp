@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "hwui/Bitmap.h"
+#include "hwui/BitmapPool.h"
+
+using namespace android;
+
+TEST(BitmapPool, reusesReleasedMemory) {
+    BitmapPool& pool = BitmapPool::get();
+    pool.trim();
+
+    void* first = pool.acquire(4096);
+    ASSERT_NE(nullptr, first);
+    memset(first, 0xff, 4096);
+    pool.release(first, 4096);
+    EXPECT_EQ(4096u, pool.pooledBytes());
+
+    // Only an exact size match is reused
+    void* other = pool.acquire(2048);
+    EXPECT_NE(first, other);
+    free(other);
+
+    void* second = pool.acquire(4096);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(0u, pool.pooledBytes());
+    auto* bytes = static_cast<const uint8_t*>(second);
+    for (int i = 0; i < 4096; i++) {
+        ASSERT_EQ(0, bytes[i]) << "reused memory must be zeroed";
+    }
+    pool.release(second, 4096);
+    pool.trim();
+    EXPECT_EQ(0u, pool.pooledBytes());
+}
+
+TEST(BitmapPool, boundsPooledBuffers) {
+    BitmapPool& pool = BitmapPool::get();
+    pool.trim();
+
+    for (size_t i = 0; i < BitmapPool::kMaxPooledBuffers * 2; i++) {
+        pool.release(pool.acquire(1024), 1024);
+    }
+    std::vector<void*> buffers;
+    for (size_t i = 0; i < BitmapPool::kMaxPooledBuffers * 2; i++) {
+        buffers.push_back(pool.acquire(1024));
+    }
+    for (void* buffer : buffers) {
+        pool.release(buffer, 1024);
+    }
+    EXPECT_EQ(BitmapPool::kMaxPooledBuffers * 1024, pool.pooledBytes());
+
+    // A buffer larger than the whole pool is never kept
+    const size_t hugeSize = BitmapPool::kMaxPooledBytes + 1;
+    pool.release(malloc(hugeSize), hugeSize);
+    EXPECT_EQ(BitmapPool::kMaxPooledBuffers * 1024, pool.pooledBytes());
+    pool.trim();
+}
+
+TEST(BitmapPool, pooledBitmapReturnsPixels) {
+    BitmapPool& pool = BitmapPool::get();
+    pool.trim();
+
+    SkBitmap skBitmap;
+    skBitmap.setInfo(SkImageInfo::MakeN32Premul(16, 16));
+    void* pixels = nullptr;
+    {
+        sk_sp<Bitmap> bitmap = Bitmap::allocatePooledHeapBitmap(&skBitmap);
+        ASSERT_TRUE(bitmap);
+        pixels = bitmap->pixels();
+        skBitmap.reset();
+    }
+    EXPECT_EQ(16u * 16 * 4, pool.pooledBytes());
+
+    skBitmap.setInfo(SkImageInfo::MakeN32Premul(16, 16));
+    sk_sp<Bitmap> bitmap = Bitmap::allocatePooledHeapBitmap(&skBitmap);
+    EXPECT_EQ(pixels, bitmap->pixels());
+    skBitmap.reset();
+    bitmap.reset();
+    pool.trim();
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <vector>
+
+#include "utils/Blur.h"
+
+using namespace android::uirenderer;
+
+static std::vector<uint8_t> makeMask(int32_t width, int32_t height) {
+    std::vector<uint8_t> mask(width * height);
+    for (auto& pixel : mask) {
+        pixel = rand();
+    }
+    return mask;
+}
+
+static void expectNear(const std::vector<uint8_t>& expected, const std::vector<uint8_t>& actual,
+                       int tolerance) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        ASSERT_NEAR(expected[i], actual[i], tolerance) << "at pixel " << i;
+    }
+}
+
+// The vector kernels must match the scalar ones, including around the edges and for images
+// smaller than a vector or the kernel
+TEST(Blur, vectorMatchesScalar) {
+    const std::pair<int32_t, int32_t> sizes[] = {{1, 1}, {5, 3}, {37, 29}, {8, 40}, {300, 200}};
+    for (int32_t radius : {1, 3, 7, 16}) {
+        std::vector<float> weights(2 * radius + 1);
+        Blur::generateGaussianWeights(weights.data(), radius);
+        for (auto [width, height] : sizes) {
+            std::vector<uint8_t> source = makeMask(width, height);
+            std::vector<uint8_t> expected(source.size());
+            std::vector<uint8_t> actual(source.size());
+
+            Blur::horizontal(weights.data(), radius, source.data(), expected.data(), width,
+                             height, Blur::Kernel::Scalar);
+            Blur::horizontal(weights.data(), radius, source.data(), actual.data(), width, height);
+            expectNear(expected, actual, 1);
+
+            Blur::vertical(weights.data(), radius, source.data(), expected.data(), width, height,
+                           Blur::Kernel::Scalar);
+            Blur::vertical(weights.data(), radius, source.data(), actual.data(), width, height);
+            expectNear(expected, actual, 1);
+        }
+    }
+}
+
+TEST(Blur, boxApproximation) {
+    constexpr int32_t width = 300;
+    constexpr int32_t height = 200;
+    std::vector<uint8_t> source(width * height);
+    for (int32_t y = 50; y < 150; y++) {
+        for (int32_t x = 100; x < 200; x++) {
+            source[y * width + x] = 255;
+        }
+    }
+
+    constexpr int32_t radius = 40;
+    ASSERT_GT(radius, Blur::kMaxGaussianRadius);
+    std::vector<float> weights(2 * radius + 1);
+    Blur::generateGaussianWeights(weights.data(), radius);
+    std::vector<uint8_t> scratch(source.size());
+    std::vector<uint8_t> expected(source.size());
+    Blur::horizontal(weights.data(), radius, source.data(), scratch.data(), width, height,
+                     Blur::Kernel::Scalar);
+    Blur::vertical(weights.data(), radius, scratch.data(), expected.data(), width, height,
+                   Blur::Kernel::Scalar);
+
+    // Blurring in place is supported
+    std::vector<uint8_t> actual = source;
+    Blur::blur(radius, actual.data(), actual.data(), width, height);
+    expectNear(expected, actual, 6);
+}
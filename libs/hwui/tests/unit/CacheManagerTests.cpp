@@ -86,3 +86,55 @@ RENDERTHREAD_TEST(CacheManager, DISABLED_trimMemory) {
     renderThread.cacheManager().trimMemory(TrimLevel::COMPLETE);
     ASSERT_TRUE(0 == grContext->getResourceCachePurgeableBytes());
 }
+
+RENDERTHREAD_TEST(CacheManager, adaptiveBudget) {
+    const MemoryPolicy& policy = loadMemoryPolicy();
+    if (policy.maxAdaptiveResourceScale <= 1.0f) {
+        GTEST_SKIP() << "Adaptive budget disabled by the memory policy";
+    }
+    int32_t width = DeviceInfo::get()->getWidth();
+    int32_t height = DeviceInfo::get()->getHeight();
+    GrDirectContext* grContext = renderThread.getGrContext();
+    ASSERT_TRUE(grContext != nullptr);
+    CacheManager& cacheManager = renderThread.cacheManager();
+    const size_t baseCacheSize = cacheManager.getCacheSize();
+
+    // missed deadlines with room left in the cache do not grow the budget
+    for (int i = 0; i < 10; i++) {
+        cacheManager.onFrameCompleted(true);
+    }
+    ASSERT_EQ(baseCacheSize, cacheManager.getCacheSize());
+
+    // fill the cache with resources that cannot be purged
+    std::vector<sk_sp<SkSurface>> surfaces;
+    while (getCacheUsage(grContext) < baseCacheSize) {
+        SkImageInfo info = SkImageInfo::MakeA8(width, height);
+        sk_sp<SkSurface> surface = SkSurfaces::RenderTarget(grContext, skgpu::Budgeted::kYes,
+                                                            info);
+        ASSERT_TRUE(surface != nullptr);
+        surface->getCanvas()->drawColor(SK_AlphaTRANSPARENT);
+        grContext->flushAndSubmit();
+        surfaces.push_back(surface);
+    }
+
+    // frames that meet their deadline never grow the budget
+    for (int i = 0; i < 10; i++) {
+        cacheManager.onFrameCompleted(false);
+    }
+    ASSERT_EQ(baseCacheSize, cacheManager.getCacheSize());
+
+    for (int i = 0; i < 10; i++) {
+        cacheManager.onFrameCompleted(true);
+    }
+    const size_t grownCacheSize = cacheManager.getCacheSize();
+    ASSERT_LT(baseCacheSize, grownCacheSize);
+    ASSERT_GE(baseCacheSize * policy.maxAdaptiveResourceScale, grownCacheSize);
+
+    String8 log;
+    cacheManager.dumpMemoryUsage(log);
+    ASSERT_NE(std::string::npos, std::string(log.c_str()).find("Adaptive resource scale"));
+
+    // memory pressure drops the growth
+    cacheManager.trimMemory(TrimLevel::RUNNING_LOW);
+    ASSERT_EQ(baseCacheSize, cacheManager.getCacheSize());
+}
@@ -78,3 +78,30 @@ RENDERTHREAD_TEST(CanvasContext, buildLayerDoesntLeak) {
         }
     }
 }
+
+RENDERTHREAD_TEST(CanvasContext, layersAreAttributed) {
+    auto node = TestUtils::createNode(0, 0, 200, 400, [](RenderProperties& props, Canvas& canvas) {
+        canvas.drawColor(0xFFFF0000, SkBlendMode::kSrc);
+    });
+    node->mutateStagingProperties().mutateLayerProperties().setType(LayerType::RenderLayer);
+
+    ContextFactory contextFactory;
+    std::unique_ptr<CanvasContext> canvasContext(
+            CanvasContext::create(renderThread, false, node.get(), &contextFactory, 0, 0));
+    canvasContext->setName("AttributedWindow");
+    const MemoryAttribution& attribution = *canvasContext->memoryAttribution();
+    canvasContext->buildLayer(node.get());
+    ASSERT_TRUE(node->hasLayer());
+    EXPECT_EQ(1u, attribution.count(AttributedMemoryType::RenderNodeLayer));
+    EXPECT_EQ(node->getLayerSurface()->imageInfo().computeMinByteSize(),
+              attribution.bytes(AttributedMemoryType::RenderNodeLayer));
+
+    String8 log;
+    renderThread.cacheManager().dumpMemoryUsage(log);
+    EXPECT_NE(std::string::npos, std::string(log.c_str()).find("AttributedWindow"));
+
+    node->destroyLayers();
+    EXPECT_EQ(0u, attribution.count(AttributedMemoryType::RenderNodeLayer));
+    EXPECT_EQ(0u, attribution.totalBytes());
+    canvasContext->destroy();
+}
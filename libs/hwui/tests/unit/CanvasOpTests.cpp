@@ -237,6 +237,128 @@ TEST(CanvasOp, simpleDrawRect) {
     EXPECT_EQ(1, canvas.sumTotalDrawCalls());
 }
 
+TEST(CanvasOp, fuseDrawRects) {
+    CanvasOpBuffer buffer;
+    const SkColor4f colors[] = {SkColors::kRed, SkColors::kGreen, SkColors::kBlue};
+    for (int i = 0; i < 3; i++) {
+        buffer.push<Op::DrawRect>({
+                .rect = SkRect::MakeXYWH(i * 10, 0, 10, 10),
+                .paint = SkPaint{colors[i]},
+        });
+    }
+    EXPECT_EQ(1, countItems(buffer));
+
+    int batchSize = 0;
+    buffer.for_each([&](auto op) {
+        using T = std::remove_cv_t<std::remove_reference_t<decltype(*op)>>;
+        if constexpr (std::is_same_v<T, CanvasOpContainer<Op::DrawRects>>) {
+            batchSize = (*op)->rects.size();
+            EXPECT_EQ(SkColors::kBlue, (*op)->rects[2].color);
+        }
+    });
+    EXPECT_EQ(3, batchSize);
+
+    CallCountingCanvas canvas;
+    rasterizeCanvasBuffer(buffer, &canvas);
+    EXPECT_EQ(3, canvas.drawRectCount);
+    EXPECT_EQ(3, canvas.sumTotalDrawCalls());
+}
+
+TEST(CanvasOp, fuseDrawRectsBreaks) {
+    CanvasOpBuffer buffer;
+    SkPaint stroke;
+    stroke.setStyle(SkPaint::kStroke_Style);
+    SkPaint antiAlias;
+    antiAlias.setAntiAlias(true);
+
+    buffer.push<Op::DrawRect>({.rect = SkRect::MakeWH(10, 10), .paint = SkPaint{}});
+    // Different paint state
+    buffer.push<Op::DrawRect>({.rect = SkRect::MakeWH(10, 10), .paint = antiAlias});
+    // Different transform
+    buffer.push_container(CanvasOpContainer<Op::DrawRect>(
+            {.rect = SkRect::MakeWH(10, 10), .paint = antiAlias}, SkMatrix::Translate(5, 5)));
+    // Not plain fills
+    buffer.push<Op::DrawRect>({.rect = SkRect::MakeWH(10, 10), .paint = stroke});
+    buffer.push<Op::DrawRect>({.rect = SkRect::MakeWH(10, 10), .paint = stroke});
+    EXPECT_EQ(5, countItems(buffer));
+
+    CallCountingCanvas canvas;
+    rasterizeCanvasBuffer(buffer, &canvas);
+    EXPECT_EQ(5, canvas.drawRectCount);
+}
+
+TEST(CanvasOp, fusedRasterizationParity) {
+    SkPaint antiAlias;
+    antiAlias.setAntiAlias(true);
+    const SkColor4f colors[] = {SkColors::kRed, SkColors::kGreen, SkColors::kBlue,
+                                SkColors::kYellow};
+    const SkMatrix transform = SkMatrix::Translate(3.5f, 2.25f);
+
+    std::vector<CanvasOp<Op::DrawRect>> rects;
+    std::vector<CanvasOp<Op::DrawRoundRect>> roundRects;
+    for (int i = 0; i < 4; i++) {
+        antiAlias.setColor(colors[i]);
+        rects.push_back({.rect = SkRect::MakeXYWH(i * 12.5f, 0, 20, 20), .paint = antiAlias});
+        roundRects.push_back({.rect = SkRect::MakeXYWH(i * 12.5f, 40, 20, 20),
+                              .rx = 4.0f + i,
+                              .ry = 6.0f,
+                              .paint = antiAlias});
+    }
+
+    CanvasOpBuffer buffer;
+    for (auto op : rects) {
+        buffer.push_container(CanvasOpContainer<Op::DrawRect>(std::move(op), transform));
+    }
+    for (auto op : roundRects) {
+        buffer.push_container(CanvasOpContainer<Op::DrawRoundRect>(std::move(op), transform));
+    }
+    EXPECT_EQ(2, countItems(buffer));
+
+    SkBitmap fused;
+    fused.allocN32Pixels(100, 100);
+    fused.eraseColor(SK_ColorTRANSPARENT);
+    SkCanvas fusedCanvas(fused);
+    rasterizeCanvasBuffer(buffer, &fusedCanvas);
+
+    SkBitmap expected;
+    expected.allocN32Pixels(100, 100);
+    expected.eraseColor(SK_ColorTRANSPARENT);
+    SkCanvas expectedCanvas(expected);
+    expectedCanvas.setMatrix(transform);
+    for (const auto& op : rects) {
+        op.draw(&expectedCanvas);
+    }
+    for (const auto& op : roundRects) {
+        op.draw(&expectedCanvas);
+    }
+
+    for (int y = 0; y < 100; y++) {
+        for (int x = 0; x < 100; x++) {
+            ASSERT_EQ(expected.getColor(x, y), fused.getColor(x, y)) << x << "," << y;
+        }
+    }
+}
+
+TEST(CanvasOp, fusedColorTransform) {
+    CanvasOpBuffer buffer;
+    buffer.push<Op::DrawRect>({.rect = SkRect::MakeWH(10, 10), .paint = SkPaint{SkColors::kWhite}});
+    buffer.push<Op::DrawRect>({.rect = SkRect::MakeWH(10, 10), .paint = SkPaint{SkColors::kBlack}});
+    buffer.applyColorTransform(ColorTransform::Dark);
+
+    buffer.for_each([&](auto op) {
+        using T = std::remove_cv_t<std::remove_reference_t<decltype(*op)>>;
+        if constexpr (std::is_same_v<T, CanvasOpContainer<Op::DrawRects>>) {
+            ASSERT_EQ(2, (*op)->rects.size());
+            EXPECT_EQ(transformColor(ColorTransform::Dark, SK_ColorWHITE),
+                      (*op)->rects[0].color.toSkColor());
+            EXPECT_EQ(transformColor(ColorTransform::Dark, SK_ColorBLACK),
+                      (*op)->rects[1].color.toSkColor());
+        } else {
+            ADD_FAILURE() << "Expected a single fused op";
+        }
+    });
+}
+
 TEST(CanvasOp, simpleDrawRegionRect) {
     CanvasOpBuffer buffer;
     EXPECT_EQ(buffer.size(), 0);
@@ -20,6 +20,7 @@
 
 #include <array>
 #include <condition_variable>
+#include <cstring>
 #include <set>
 #include <thread>
 #include "unistd.h"
@@ -36,6 +37,24 @@ TEST(CommonPool, post) {
     EXPECT_TRUE(ran) << "Failed to flip atomic after 1 second";
 }
 
+TEST(CommonPool, threadCount) {
+    EXPECT_GE(CommonPool::getThreadCount(), 1);
+    EXPECT_LE(CommonPool::getThreadCount(), CommonPool::MAX_THREAD_COUNT);
+    // Thread ids are only tracked where the platform supports them.
+    auto tids = CommonPool::getThreadIds();
+    if (!tids.empty()) {
+        EXPECT_EQ(static_cast<size_t>(CommonPool::getThreadCount()), tids.size());
+    }
+}
+
+TEST(CommonPool, dumpStats) {
+    CommonPool::async([] {}, CommonPool::Priority::FrameCritical).get();
+    String8 log;
+    CommonPool::dump(log);
+    EXPECT_NE(nullptr, strstr(log.c_str(), "frame-critical"));
+    EXPECT_NE(nullptr, strstr(log.c_str(), "background"));
+}
+
 // test currently relies on timings, which
 // makes it flaky. Disable for now
 TEST(DISABLED_CommonPool, threadCount) {
@@ -50,7 +69,7 @@ TEST(DISABLED_CommonPool, threadCount) {
     for (auto& f : futures) {
         threads.insert(f.get());
     }
-    EXPECT_EQ(threads.size(), CommonPool::THREAD_COUNT);
+    EXPECT_EQ(threads.size(), static_cast<size_t>(CommonPool::getThreadCount()));
     EXPECT_EQ(0, threads.count(gettid()));
 }
 
@@ -103,7 +122,8 @@ TEST(DISABLED_CommonPool, fullQueue) {
     std::mutex lock;
     std::condition_variable fence;
     bool signaled = false;
-    static constexpr auto QUEUE_COUNT = CommonPool::THREAD_COUNT + CommonPool::QUEUE_SIZE + 10;
+    static constexpr auto QUEUE_COUNT =
+            CommonPool::MAX_THREAD_COUNT + CommonPool::QUEUE_SIZE + 10;
     std::atomic_int queuedCount{0};
     std::array<std::future<void>, QUEUE_COUNT> futures;
 
@@ -17,6 +17,7 @@
 #include <gtest/gtest.h>
 
 #include <DamageAccumulator.h>
+#include <DamageRegion.h>
 #include <Matrix.h>
 #include <RenderNode.h>
 #include <utils/LinearAllocator.h>
@@ -81,6 +82,57 @@ TEST(DamageAccumulator, union) {
     ASSERT_EQ(SkRect::MakeLTRB(50, 50, 200, 125), curDirty);
 }
 
+// Test that disjoint siblings are kept as separate rects in the damage region
+TEST(DamageAccumulator, disjointRegion) {
+    DamageAccumulator da;
+    Matrix4 translate;
+    translate.loadTranslate(10, 10, 0);
+    da.pushTransform(&translate);
+    {
+        da.pushTransform(&Matrix4::identity());
+        da.dirty(0, 0, 20, 20);
+        da.popTransform();
+        da.pushTransform(&Matrix4::identity());
+        da.dirty(500, 800, 600, 810.5f);
+        da.popTransform();
+    }
+    da.popTransform();
+    DamageRegion dirty;
+    da.finish(&dirty);
+    ASSERT_EQ(2, dirty.count());
+    EXPECT_EQ(SkRect::MakeLTRB(10, 10, 30, 30), dirty[0]);
+    EXPECT_EQ(SkRect::MakeLTRB(510, 810, 610, 821), dirty[1]);
+    EXPECT_EQ(SkRect::MakeLTRB(10, 10, 610, 821), dirty.bounds());
+}
+
+TEST(DamageRegion, merge) {
+    DamageRegion region;
+    region.join(SkRect::MakeLTRB(0, 0, 10, 10));
+    region.join(SkRect::MakeLTRB(100, 0, 110, 10));
+    EXPECT_EQ(2, region.count());
+
+    // Overlapping rects are merged, and the merged rect absorbs everything it now touches
+    region.join(SkRect::MakeLTRB(5, 5, 105, 6));
+    ASSERT_EQ(1, region.count());
+    EXPECT_EQ(SkRect::MakeLTRB(0, 0, 110, 10), region[0]);
+
+    // Once full, a new rect is merged into the one whose bounds grow the least
+    region.set(SkRect::MakeLTRB(0, 0, 10, 10));
+    for (int i = 1; i < DamageRegion::kMaxRects; i++) {
+        region.join(SkRect::MakeXYWH(i * 100, 0, 10, 10));
+    }
+    EXPECT_EQ(DamageRegion::kMaxRects, region.count());
+    region.join(SkRect::MakeLTRB(0, 20, 10, 30));
+    EXPECT_EQ(DamageRegion::kMaxRects, region.count());
+    EXPECT_EQ(SkRect::MakeLTRB(0, 0, 310, 30), region.bounds());
+
+    EXPECT_TRUE(region.intersect(SkRect::MakeLTRB(0, 0, 50, 50)));
+    ASSERT_EQ(1, region.count());
+    EXPECT_EQ(SkRect::MakeLTRB(0, 0, 10, 30), region[0]);
+    EXPECT_FALSE(region.intersect(SkRect::MakeLTRB(20, 20, 50, 50)));
+    EXPECT_TRUE(region.isEmpty());
+}
+
 TEST(DamageAccumulator, basicRenderNode) {
     DamageAccumulator da;
     RenderNode node1;
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "renderthread/FrameCostPredictor.h"
+
+using namespace android;
+using namespace android::uirenderer;
+using namespace android::uirenderer::renderthread;
+
+static void addSteadyFrames(FrameCostPredictor& predictor, int count) {
+    for (int i = 0; i < count; i++) {
+        predictor.predict(1_ms, {.syncedDisplayLists = 2});
+        predictor.addFrame(1_ms, 4_ms);
+    }
+}
+
+TEST(FrameCostPredictor, steadyFrames) {
+    FrameCostPredictor predictor;
+    EXPECT_FALSE(predictor.hasHistory());
+    addSteadyFrames(predictor, 10);
+    EXPECT_TRUE(predictor.hasHistory());
+
+    auto prediction = predictor.predict(1_ms, {.syncedDisplayLists = 2});
+    EXPECT_FALSE(prediction.heavy);
+    EXPECT_EQ(4_ms, prediction.drawDuration);
+}
+
+TEST(FrameCostPredictor, hintsPredictHeavyFrames) {
+    FrameCostPredictor predictor;
+    EXPECT_TRUE(predictor.predict(0, {.newSurface = true}).heavy);
+    addSteadyFrames(predictor, 10);
+
+    EXPECT_TRUE(predictor.predict(1_ms, {.visibilityChanged = true}).heavy);
+    EXPECT_TRUE(predictor.predict(1_ms, {.syncedDisplayLists = 40}).heavy);
+    // Slow syncs come with big tree changes, and predict a slow draw
+    auto prediction = predictor.predict(5_ms, {.syncedDisplayLists = 2});
+    EXPECT_TRUE(prediction.heavy);
+    EXPECT_GT(prediction.drawDuration, 4_ms);
+}
+
+TEST(FrameCostPredictor, learnsHeavyFrameCost) {
+    FrameCostPredictor predictor;
+    addSteadyFrames(predictor, 10);
+    const nsecs_t initial = predictor.predict(1_ms, {.newSurface = true}).drawDuration;
+    for (int i = 0; i < 20; i++) {
+        predictor.predict(1_ms, {.newSurface = true});
+        predictor.addFrame(1_ms, 24_ms);
+    }
+    const auto prediction = predictor.predict(1_ms, {.newSurface = true});
+    EXPECT_GT(prediction.drawDuration, initial);
+    EXPECT_LE(prediction.drawDuration, 24_ms);
+
+    // Heavy frames don't change what steady frames are expected to cost
+    EXPECT_EQ(4_ms, predictor.predict(1_ms, {.syncedDisplayLists = 2}).drawDuration);
+}
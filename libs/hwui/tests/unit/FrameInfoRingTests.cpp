@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "FrameInfoRing.h"
+
+using namespace android;
+using namespace android::uirenderer;
+
+static void pushFrame(FrameInfoRing& ring, int64_t frameNumber, uint32_t sourceId) {
+    FrameInfo frame{};
+    frame.set(FrameInfoIndex::IntendedVsync) = frameNumber * 1000;
+    frame.set(FrameInfoIndex::FrameCompleted) = frameNumber * 1000 + 500;
+    ring.push(frame, frameNumber, -1, sourceId);
+}
+
+TEST(FrameInfoRing, pushAndRead) {
+    FrameInfoRing& ring = FrameInfoRing::instance();
+    const uint32_t sourceId = FrameInfoRing::nextSourceId();
+    uint64_t cursor = ring.end();
+    for (int64_t i = 1; i <= 3; i++) {
+        pushFrame(ring, i, sourceId);
+    }
+
+    std::vector<FrameInfoRing::Record> records;
+    EXPECT_EQ(0u, ring.read(&cursor, [&](const auto& record) { records.push_back(record); }));
+    EXPECT_EQ(ring.end(), cursor);
+    ASSERT_EQ(3u, records.size());
+    for (int i = 0; i < 3; i++) {
+        const auto& record = records[i];
+        EXPECT_EQ(i + 1, record.frameNumber);
+        EXPECT_EQ(-1, record.surfaceId);
+        EXPECT_EQ(sourceId, record.sourceId);
+        EXPECT_EQ((i + 1) * 1000,
+                  record.frameInfo[static_cast<int>(FrameInfoIndex::IntendedVsync)]);
+        EXPECT_EQ((i + 1) * 1000 + 500,
+                  record.frameInfo[static_cast<int>(FrameInfoIndex::FrameCompleted)]);
+    }
+
+    // Nothing new to read
+    records.clear();
+    EXPECT_EQ(0u, ring.read(&cursor, [&](const auto& record) { records.push_back(record); }));
+    EXPECT_TRUE(records.empty());
+}
+
+TEST(FrameInfoRing, readerFallsBehind) {
+    FrameInfoRing& ring = FrameInfoRing::instance();
+    const uint32_t sourceId = FrameInfoRing::nextSourceId();
+    uint64_t cursor = ring.end();
+    const int64_t total = FrameInfoRing::kCapacity + 10;
+    for (int64_t i = 0; i < total; i++) {
+        pushFrame(ring, i, sourceId);
+    }
+
+    std::vector<int64_t> frameNumbers;
+    EXPECT_EQ(10u, ring.read(&cursor, [&](const auto& record) {
+        frameNumbers.push_back(record.frameNumber);
+    }));
+    ASSERT_EQ(FrameInfoRing::kCapacity, frameNumbers.size());
+    EXPECT_EQ(10, frameNumbers.front());
+    EXPECT_EQ(total - 1, frameNumbers.back());
+}
+
+TEST(FrameInfoRing, uniqueSourceIds) {
+    EXPECT_NE(FrameInfoRing::nextSourceId(), FrameInfoRing::nextSourceId());
+}
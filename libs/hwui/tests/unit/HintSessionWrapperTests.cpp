@@ -190,6 +190,22 @@ TEST_F(HintSessionWrapperTests, loadUpHintsSendCorrectly) {
     mWrapper->sendLoadIncreaseHint();
 }
 
+TEST_F(HintSessionWrapperTests, predictedHeavyFramesSendLoadUpHints) {
+    EXPECT_CALL(*sMockBinding,
+                fakeSendHint(sessionPtr, static_cast<int32_t>(SessionHint::CPU_LOAD_UP)))
+            .Times(1);
+    mWrapper->init();
+    waitForWrapperReady();
+    for (int i = 0; i < 10; i++) {
+        mWrapper->onFramePrepared(2_ms, 1_ms, {.syncedDisplayLists = 1});
+        mWrapper->reportFrameStages(1_ms, 4_ms);
+    }
+    // Only the frame whose tree changed this much is expected to be slow
+    mWrapper->onFramePrepared(10_ms, 2_ms, {.syncedDisplayLists = 64});
+    mWrapper->reportFrameStages(2_ms, 20_ms);
+    mWrapper->onFramePrepared(2_ms, 1_ms, {.syncedDisplayLists = 1});
+}
+
 TEST_F(HintSessionWrapperTests, loadResetHintsSendCorrectly) {
     EXPECT_CALL(*sMockBinding,
                 fakeSendHint(sessionPtr, static_cast<int32_t>(SessionHint::CPU_LOAD_RESET)))
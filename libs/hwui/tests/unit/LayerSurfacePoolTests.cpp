@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "pipeline/skia/LayerSurfacePool.h"
+#include "tests/common/TestUtils.h"
+#include "utils/TimeUtils.h"
+
+using namespace android;
+using namespace android::uirenderer;
+using namespace android::uirenderer::skiapipeline;
+
+static SkImageInfo layerInfo(int width, int height) {
+    return SkImageInfo::MakeN32Premul(width, height);
+}
+
+TEST(LayerSurfacePool, reusesSurfacesOfTheSameSize) {
+    sp<LayerSurfacePool> pool = new LayerSurfacePool(1024 * 1024);
+    sk_sp<SkSurface> surface = SkSurfaces::Raster(layerInfo(64, 128));
+    SkSurface* rawSurface = surface.get();
+    pool->recycle(std::move(surface));
+    EXPECT_EQ(1u, pool->getEntryCount());
+    EXPECT_EQ(64u * 128 * 4, pool->getBytes());
+
+    EXPECT_EQ(nullptr, pool->acquire(nullptr, layerInfo(128, 64)));
+    EXPECT_EQ(rawSurface, pool->acquire(nullptr, layerInfo(64, 128)).get());
+    EXPECT_EQ(0u, pool->getEntryCount());
+    EXPECT_EQ(0u, pool->getBytes());
+    EXPECT_EQ(1u, pool->getHitCount());
+    EXPECT_EQ(1u, pool->getMissCount());
+}
+
+TEST(LayerSurfacePool, ignoresSharedSurfaces) {
+    sp<LayerSurfacePool> pool = new LayerSurfacePool(1024 * 1024);
+    sk_sp<SkSurface> surface = SkSurfaces::Raster(layerInfo(64, 64));
+    pool->recycle(surface);
+    EXPECT_EQ(0u, pool->getEntryCount());
+}
+
+TEST(LayerSurfacePool, evictsOldestSurfacesOverBudget) {
+    sp<LayerSurfacePool> pool = new LayerSurfacePool(2 * 64 * 64 * 4);
+    sk_sp<SkSurface> first = SkSurfaces::Raster(layerInfo(64, 64));
+    SkSurface* rawFirst = first.get();
+    pool->recycle(std::move(first));
+    pool->recycle(SkSurfaces::Raster(layerInfo(64, 64)));
+    pool->recycle(SkSurfaces::Raster(layerInfo(64, 64)));
+    EXPECT_EQ(2u, pool->getEntryCount());
+    for (int i = 0; i < 2; i++) {
+        EXPECT_NE(rawFirst, pool->acquire(nullptr, layerInfo(64, 64)).get());
+    }
+
+    pool->recycle(SkSurfaces::Raster(layerInfo(64, 64)));
+    pool->setMaxBytes(0);
+    EXPECT_EQ(0u, pool->getEntryCount());
+}
+
+TEST(LayerSurfacePool, dropsIdleSurfaces) {
+    sp<LayerSurfacePool> pool = new LayerSurfacePool(1024 * 1024);
+    pool->recycle(SkSurfaces::Raster(layerInfo(64, 64)));
+    EXPECT_EQ(1u, pool->getEntryCount());
+    pool->trim(1_s);
+    EXPECT_EQ(1u, pool->getEntryCount());
+    pool->trim(0);
+    EXPECT_EQ(0u, pool->getEntryCount());
+}
@@ -130,3 +130,36 @@ TEST(LsaVector, dtorCheck) {
         EXPECT_EQ(size, destroyed);
     }
 }
+
+TEST(LinearAllocator, freeListReuse) {
+    LinearAllocator la;
+    void* first = la.alloc<char>(32);
+    la.alloc<char>(8);
+    // not the last allocation, so the buffer goes on the freelist instead of being rewound
+    la.rewindIfLastAlloc(first, 32);
+    EXPECT_EQ(first, la.alloc<char>(32));
+    EXPECT_EQ(1u, la.freeListHits());
+}
+
+TEST(LinearAllocator, pageReuse) {
+    LinearAllocator::trimPagePool();
+    size_t allocatedSize;
+    {
+        LinearAllocator la;
+        for (int i = 0; i < 1000; i++) {
+            la.alloc<char>(40);
+        }
+        allocatedSize = la.allocatedSize();
+        EXPECT_EQ(0u, la.reusedPageCount());
+    }
+    {
+        // a second allocator on the same thread takes over the pages of the first one
+        LinearAllocator la;
+        for (int i = 0; i < 1000; i++) {
+            la.alloc<char>(40);
+        }
+        EXPECT_EQ(allocatedSize, la.allocatedSize());
+        EXPECT_LT(0u, la.reusedPageCount());
+    }
+    LinearAllocator::trimPagePool();
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "hwui/MeasuredTextBatch.h"
+#include "hwui/MinikinUtils.h"
+#include "hwui/Paint.h"
+
+using namespace android;
+
+namespace {
+
+constexpr size_t kParagraphCount = 12;
+
+std::vector<uint16_t> makeText(size_t index) {
+    std::string text = "Paragraph " + std::to_string(index) + " of a long document.";
+    return std::vector<uint16_t>(text.begin(), text.end());
+}
+
+MeasuredTextBatch::Paragraph makeParagraph(const std::vector<uint16_t>& text) {
+    Paint paint;
+    paint.getSkFont().setSize(14);
+    MeasuredTextBatch::Paragraph paragraph;
+    paragraph.builder = std::make_unique<minikin::MeasuredTextBuilder>();
+    paragraph.builder->addStyleRun(0, text.size(),
+                                   MinikinUtils::prepareMinikinPaint(&paint, nullptr),
+                                   0 /* lbStyle */, 0 /* lbWordStyle */, false /* hyphenation */,
+                                   false /* isRtl */);
+    paragraph.text = text;
+    paragraph.computeLayout = true;
+    return paragraph;
+}
+
+std::vector<MeasuredTextBatch::Paragraph> makeParagraphs() {
+    std::vector<MeasuredTextBatch::Paragraph> paragraphs;
+    for (size_t i = 0; i < kParagraphCount; i++) {
+        paragraphs.push_back(makeParagraph(makeText(i)));
+    }
+    return paragraphs;
+}
+
+float totalWidth(const minikin::MeasuredText& measured) {
+    float width = 0;
+    for (float charWidth : measured.widths) {
+        width += charWidth;
+    }
+    return width;
+}
+
+}  // namespace
+
+TEST(MeasuredTextBatch, next_returnsEachParagraphOnce) {
+    MeasuredTextBatch batch(makeParagraphs());
+    ASSERT_EQ(kParagraphCount, batch.size());
+    std::vector<bool> seen(kParagraphCount, false);
+    ssize_t index;
+    while ((index = batch.next()) >= 0) {
+        ASSERT_LT(static_cast<size_t>(index), kParagraphCount);
+        EXPECT_FALSE(seen[index]);
+        seen[index] = true;
+
+        std::unique_ptr<minikin::MeasuredText> measured = batch.take(index);
+        ASSERT_NE(nullptr, measured);
+        EXPECT_EQ(makeText(index).size(), measured->widths.size());
+    }
+    for (bool paragraphSeen : seen) {
+        EXPECT_TRUE(paragraphSeen);
+    }
+}
+
+TEST(MeasuredTextBatch, take_matchesSerialMeasurement) {
+    MeasuredTextBatch batch(makeParagraphs());
+    for (size_t i = 0; i < kParagraphCount; i++) {
+        const std::vector<uint16_t> text = makeText(i);
+        MeasuredTextBatch::Paragraph serial = makeParagraph(text);
+        std::unique_ptr<minikin::MeasuredText> expected = serial.builder->build(
+                minikin::U16StringPiece(text.data(), text.size()), false, true, false, false,
+                nullptr);
+
+        std::unique_ptr<minikin::MeasuredText> measured = batch.take(i);
+        ASSERT_NE(nullptr, measured);
+        EXPECT_EQ(totalWidth(*expected), totalWidth(*measured));
+    }
+}
+
+TEST(MeasuredTextBatch, destroy_beforeTakingResults) {
+    // Must not crash or leak while workers are still measuring.
+    MeasuredTextBatch batch(makeParagraphs());
+    EXPECT_NE(nullptr, batch.take(0));
+}
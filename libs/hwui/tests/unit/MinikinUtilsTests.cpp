@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "hwui/MinikinUtils.h"
+#include "hwui/Paint.h"
+
+using namespace android;
+
+namespace {
+
+const std::vector<uint16_t> kText = {'H', 'e', 'l', 'l', 'o', ' ', 'w', 'o', 'r', 'l', 'd'};
+
+std::shared_ptr<const minikin::Layout> doCachedLayout(const Paint& paint,
+                                                      const std::vector<uint16_t>& text) {
+    return MinikinUtils::doCachedLayout(&paint, minikin::Bidi::LTR, nullptr, text.data(),
+                                        text.size(), 0, text.size(), 0, text.size(), nullptr);
+}
+
+}  // namespace
+
+TEST(MinikinUtils, doCachedLayout_reusesIdenticalRun) {
+    MinikinUtils::purgeCaches();
+    Paint paint;
+    paint.getSkFont().setSize(20);
+    auto first = doCachedLayout(paint, kText);
+    auto second = doCachedLayout(paint, kText);
+    EXPECT_EQ(first.get(), second.get());
+
+    // A copy of the paint shapes the same way.
+    Paint copy(paint);
+    EXPECT_EQ(first.get(), doCachedLayout(copy, kText).get());
+}
+
+TEST(MinikinUtils, doCachedLayout_keysOnTextAndPaint) {
+    MinikinUtils::purgeCaches();
+    Paint paint;
+    paint.getSkFont().setSize(20);
+    auto layout = doCachedLayout(paint, kText);
+
+    std::vector<uint16_t> otherText = kText;
+    otherText[0] = 'J';
+    EXPECT_NE(layout.get(), doCachedLayout(paint, otherText).get());
+
+    Paint larger(paint);
+    larger.getSkFont().setSize(40);
+    auto largerLayout = doCachedLayout(larger, kText);
+    EXPECT_NE(layout.get(), largerLayout.get());
+    EXPECT_GT(largerLayout->getAdvance(), layout->getAdvance());
+
+    Paint spaced(paint);
+    spaced.setLetterSpacing(0.5f);
+    EXPECT_NE(layout.get(), doCachedLayout(spaced, kText).get());
+}
+
+TEST(MinikinUtils, measureText_matchesCachedLayout) {
+    MinikinUtils::purgeCaches();
+    Paint paint;
+    paint.getSkFont().setSize(20);
+    std::vector<float> advances(kText.size());
+    const float advance = MinikinUtils::measureText(&paint, minikin::Bidi::LTR, nullptr,
+                                                    kText.data(), 0, kText.size(), kText.size(),
+                                                    advances.data(), nullptr, nullptr);
+    // Drawing after measuring reuses the measured run.
+    auto layout = doCachedLayout(paint, kText);
+    EXPECT_EQ(advance, layout->getAdvance());
+    for (size_t i = 0; i < kText.size(); i++) {
+        EXPECT_EQ(advances[i], layout->getCharAdvance(i));
+    }
+
+    minikin::Layout uncached =
+            MinikinUtils::doLayout(&paint, minikin::Bidi::LTR, nullptr, kText.data(),
+                                   kText.size(), 0, kText.size(), 0, kText.size(), nullptr);
+    EXPECT_EQ(uncached.getAdvance(), layout->getAdvance());
+    EXPECT_EQ(uncached.nGlyphs(), layout->nGlyphs());
+}
@@ -188,3 +188,37 @@ TEST(OpBuffer, filterView) {
     EXPECT_EQ(count, 7);
 }
 
+
+TEST(OpBuffer, replaceLast) {
+    LifecycleTracker tracker;
+    {
+        MockBuffer buffer;
+        buffer.push<Op::IntHolder>({1});
+        buffer.emplace_back<Op::Lifecycle>(MockOp<MockTypes::Lifecycle>{&tracker});
+        EXPECT_EQ(1, tracker.alive());
+        EXPECT_EQ(nullptr, buffer.last_as<Op::IntHolder>());
+        ASSERT_NE(nullptr, buffer.last_as<Op::Lifecycle>());
+
+        const size_t sizeBefore = buffer.size();
+        buffer.replace_last<Op::IntHolder>(MockOp<MockTypes::IntHolder>{2});
+        EXPECT_EQ(0, tracker.alive());
+        EXPECT_LE(buffer.size(), sizeBefore);
+        EXPECT_EQ(2, countItems(buffer));
+
+        auto* last = buffer.last_as<Op::IntHolder>();
+        ASSERT_NE(nullptr, last);
+        last->impl.value = 3;
+
+        int sum = 0;
+        buffer.for_each_mutable([&](auto op) {
+            static_assert(!std::is_const_v<std::remove_reference_t<decltype(*op)>>,
+                    "Expected container to be mutable");
+            if constexpr (std::is_same_v<std::remove_reference_t<decltype(*op)>,
+                                         MockOpContainer<Op::IntHolder>>) {
+                sum += op->impl.value;
+            }
+        });
+        EXPECT_EQ(4, sum);
+    }
+    EXPECT_EQ(0, tracker.alive());
+}
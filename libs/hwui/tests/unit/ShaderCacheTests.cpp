@@ -53,7 +53,14 @@ public:
         // By order of declaration
         cache.mInitialized = newCache.mInitialized;
         cache.mBlobCache.reset(nullptr);
+        if (cache.mPendingLoad.valid()) {
+            cache.mPendingLoad.wait();
+        }
+        cache.mPendingLoad = {};
+        cache.mPendingIdentity.clear();
+        cache.mPendingIdentitySize = newCache.mPendingIdentitySize;
         cache.mFilename = newCache.mFilename;
+        cache.mPrewarmFilename = newCache.mPrewarmFilename;
         cache.mIDHash.clear();
         cache.mSavePending = newCache.mSavePending;
         cache.mObservedBlobValueSize = newCache.mObservedBlobValueSize;
@@ -85,6 +92,10 @@ public:
         if (saveContent) {
             cache.saveToDiskLocked();
         }
+        if (cache.mPendingLoad.valid()) {
+            cache.mPendingLoad.wait();
+        }
+        cache.mPendingLoad = {};
         cache.mBlobCache = NULL;
     }
 
@@ -94,6 +105,7 @@ public:
     template <typename T>
     static bool validateCache(ShaderCache& cache, std::vector<T> hash) {
         std::lock_guard lock(cache.mMutex);
+        cache.finishLoadLocked();
         return cache.validateCache(hash.data(), hash.size() * sizeof(T));
     }
 
@@ -276,6 +288,67 @@ TEST(ShaderCacheTest, testWriteAndRead) {
     ASSERT_NO_FATAL_FAILURE(deleteFileAssertSuccess(cacheFile2));
 }
 
+TEST(ShaderCacheTest, testPrewarmFromMatchingIdentity) {
+    if (!folderExist(getExternalStorageFolder())) {
+        // don't run the test if external storage folder is not available
+        return;
+    }
+    std::string prewarmFile = getExternalStorageFolder() + "/shaderCacheTestPrewarm";
+    std::string cacheFile = getExternalStorageFolder() + "/shaderCacheTestPrewarmed";
+
+    // remove any test files from previous test run
+    ASSERT_NO_FATAL_FAILURE(deleteFileAssertSuccess(prewarmFile));
+    ASSERT_NO_FATAL_FAILURE(deleteFileAssertSuccess(cacheFile));
+    std::srand(0);
+
+    // build the prewarm file with a known identity
+    ShaderCache::get().setFilename(prewarmFile.c_str());
+    ShaderCache::get().setPrewarmFilename("");
+    ShaderCacheTestUtils::setSaveDelayMs(ShaderCache::get(), 0);  // disable deferred save
+    std::vector<uint8_t> identity(1024);
+    genRandomData(identity);
+    ShaderCache::get().initShaderDiskCache(
+            identity.data(), identity.size() * sizeof(decltype(identity)::value_type));
+
+    std::vector<uint8_t> keyBuffer(1024);
+    std::vector<uint8_t> dataBuffer(50 * 1024);
+    genRandomData(keyBuffer);
+    genRandomData(dataBuffer);
+    sk_sp<SkData> key, data;
+    setShader(key, keyBuffer);
+    setShader(data, dataBuffer);
+    ShaderCache::get().store(*key.get(), *data.get(), SkString());
+    ShaderCacheTestUtils::terminate(ShaderCache::get(), true);
+
+    // a fresh cache with a different identity must not be seeded
+    std::vector<uint8_t> otherIdentity(identity);
+    otherIdentity[0]++;
+    ShaderCache::get().setFilename(cacheFile.c_str());
+    ShaderCache::get().setPrewarmFilename(prewarmFile.c_str());
+    ShaderCache::get().initShaderDiskCache(
+            otherIdentity.data(),
+            otherIdentity.size() * sizeof(decltype(otherIdentity)::value_type));
+    ASSERT_EQ(ShaderCache::get().load(*key.get()), sk_sp<SkData>());
+    ShaderCacheTestUtils::terminate(ShaderCache::get(), false);
+
+    // a fresh cache with the same identity is seeded from the prewarm file
+    ShaderCache::get().initShaderDiskCache(
+            identity.data(), identity.size() * sizeof(decltype(identity)::value_type));
+    ASSERT_TRUE(checkShader(ShaderCache::get().load(*key.get()), data));
+    ShaderCacheTestUtils::terminate(ShaderCache::get(), true);
+
+    // the seeded contents were written to the cache file, so they survive without prewarming
+    ShaderCache::get().setPrewarmFilename("");
+    ShaderCache::get().initShaderDiskCache(
+            identity.data(), identity.size() * sizeof(decltype(identity)::value_type));
+    ASSERT_TRUE(ShaderCacheTestUtils::validateCache(ShaderCache::get(), identity));
+    ASSERT_TRUE(checkShader(ShaderCache::get().load(*key.get()), data));
+
+    ShaderCacheTestUtils::terminate(ShaderCache::get(), false);
+    ASSERT_NO_FATAL_FAILURE(deleteFileAssertSuccess(prewarmFile));
+    ASSERT_NO_FATAL_FAILURE(deleteFileAssertSuccess(cacheFile));
+}
+
 TEST(ShaderCacheTest, testCacheValidation) {
     if (!folderExist(getExternalStorageFolder())) {
         // don't run the test if external storage folder is not available
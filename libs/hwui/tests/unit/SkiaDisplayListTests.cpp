@@ -158,6 +158,64 @@ TEST(SkiaDisplayList, recordMutableBitmapInShader) {
     EXPECT_EQ(20, displayList->mMutableImages[0]->height());
 }
 
+TEST(SkiaDisplayList, hasSameContent) {
+    const bool savedSkipUnchanged = Properties::skipUnchangedDisplayLists;
+    Properties::skipUnchangedDisplayLists = true;
+    auto record = [](SkColor color) {
+        SkiaRecordingCanvas canvas{nullptr, 100, 100};
+        Paint paint;
+        paint.setColor(color);
+        canvas.drawRect(10, 10, 50, 50, paint);
+        return canvas.finishRecording();
+    };
+
+    auto first = record(SK_ColorRED);
+    auto same = record(SK_ColorRED);
+    auto different = record(SK_ColorBLUE);
+    EXPECT_TRUE(first->hasSameContent(*same));
+    EXPECT_FALSE(first->hasSameContent(*different));
+
+    // content that can change without re-recording never compares equal
+    auto bitmap = Bitmap::allocateHeapBitmap(SkImageInfo::Make(
+            10, 20, SkColorType::kN32_SkColorType, SkAlphaType::kPremul_SkAlphaType));
+    auto recordBitmap = [&bitmap]() {
+        SkiaRecordingCanvas canvas{nullptr, 100, 100};
+        canvas.drawBitmap(*bitmap, 0, 0, nullptr);
+        return canvas.finishRecording();
+    };
+    EXPECT_FALSE(recordBitmap()->hasSameContent(*recordBitmap()));
+
+    Properties::skipUnchangedDisplayLists = savedSkipUnchanged;
+}
+
+TEST(SkiaDisplayList, compact) {
+    SkiaRecordingCanvas canvas{nullptr, 100, 100};
+    for (int i = 0; i < 100; i++) {
+        canvas.drawColor(SK_ColorRED, SkBlendMode::kSrc);
+    }
+    auto skiaDL = canvas.finishRecording();
+
+    // Compacting trims the op storage to what is in use and keeps the ops drawable.
+    const size_t usedSize = skiaDL->getUsedSize();
+    const size_t allocatedSize = skiaDL->getAllocatedSize();
+    const size_t reclaimed = skiaDL->compact();
+    EXPECT_GT(reclaimed, 0u);
+    EXPECT_EQ(allocatedSize - reclaimed, skiaDL->getAllocatedSize());
+    EXPECT_EQ(usedSize, skiaDL->getUsedSize());
+    EXPECT_EQ(0u, skiaDL->compact());
+
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(1, 1);
+    SkCanvas drawCanvas(bitmap);
+    skiaDL->draw(&drawCanvas);
+    EXPECT_EQ(SK_ColorRED, bitmap.getColor(0, 0));
+
+    // A reset list frees all of its op storage.
+    skiaDL->reset();
+    EXPECT_GT(skiaDL->compact(), 0u);
+    EXPECT_EQ(0u, skiaDL->getUsedSize());
+}
+
 class ContextFactory : public IContextFactory {
 public:
     virtual AnimationContext* createAnimationContext(renderthread::TimeLord& clock) override {
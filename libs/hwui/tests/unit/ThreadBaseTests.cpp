@@ -19,6 +19,7 @@
 #include "thread/ThreadBase.h"
 #include "utils/TimeUtils.h"
 
+#include <array>
 #include <chrono>
 #include "unistd.h"
 
@@ -49,6 +50,37 @@ TEST(ThreadBase, post) {
     ASSERT_TRUE(ran) << "Failed to flip atomic after 1 second";
 }
 
+TEST(ThreadBase, postKeepsOrder) {
+    // Block the thread so that the posts below overflow the preallocated task slots
+    std::atomic_bool blocked(true);
+    queue().post([&blocked]() {
+        while (blocked) {
+            usleep(1);
+        }
+    });
+    std::vector<int> ranOrder;
+    for (int i = 0; i < 1000; i++) {
+        queue().post([&ranOrder, i]() { ranOrder.push_back(i); });
+    }
+    blocked = false;
+    queue().runSync([]() {});
+    ASSERT_EQ(1000u, ranOrder.size());
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(i, ranOrder[i]);
+    }
+}
+
+TEST(ThreadBase, postLargeCapture) {
+    std::array<int, 64> values;
+    values.fill(7);
+    int sum = queue().runSync([values]() -> int {
+        int sum = 0;
+        for (int value : values) sum += value;
+        return sum;
+    });
+    ASSERT_EQ(7 * 64, sum);
+}
+
 TEST(ThreadBase, postDelay) {
     using clock = WorkQueue::clock;
 
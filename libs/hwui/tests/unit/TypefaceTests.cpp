@@ -19,6 +19,7 @@
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include <utils/Log.h>
 
 #include "SkData.h"
@@ -72,6 +73,39 @@ std::vector<std::shared_ptr<minikin::FontFamily>> makeSingleFamlyVector(const ch
     return std::vector<std::shared_ptr<minikin::FontFamily>>({buildFamily(fileName)});
 }
 
+sk_sp<SkData> mapFile(const char* fileName) {
+    int fd = open(fileName, O_RDONLY);
+    LOG_ALWAYS_FATAL_IF(fd == -1, "Failed to open file %s", fileName);
+    struct stat st = {};
+    LOG_ALWAYS_FATAL_IF(fstat(fd, &st) == -1, "Failed to stat file %s", fileName);
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    return SkData::MakeWithProc(data, st.st_size, unmap, reinterpret_cast<void*>(st.st_size));
+}
+
+TEST(TypefaceTest, lazyMinikinFontSkia_createsTypefaceOnFirstUse) {
+    sk_sp<SkData> data = mapFile(kRobotoVariable);
+    const void* fontData = data->data();
+    const size_t fontSize = data->size();
+    MinikinFontSkia font(std::move(data), 0, fontData, fontSize, kRobotoVariable, 0,
+                         std::vector<minikin::FontVariation>());
+
+    SkTypeface* typeface = font.GetSkTypeface();
+    ASSERT_NE(nullptr, typeface);
+    // Later calls return the same typeface.
+    EXPECT_EQ(typeface, font.GetSkTypeface());
+    EXPECT_EQ(typeface, font.RefSkTypeface().get());
+
+    std::vector<minikin::FontVariation> variations = {
+            {SkSetFourByteTag('w', 'g', 'h', 't'), 700.0f}};
+    std::shared_ptr<minikin::MinikinFont> bold = font.createFontWithVariation(variations);
+    const MinikinFontSkia* boldSkia = static_cast<const MinikinFontSkia*>(bold.get());
+    EXPECT_EQ(fontData, boldSkia->GetFontData());
+    ASSERT_EQ(1u, boldSkia->GetAxes().size());
+    ASSERT_NE(nullptr, boldSkia->GetSkTypeface());
+    EXPECT_NE(typeface, boldSkia->GetSkTypeface());
+}
+
 TEST(TypefaceTest, resolveDefault_and_setDefaultTest) {
     std::unique_ptr<Typeface> regular(Typeface::createFromFamilies(
             makeSingleFamlyVector(kRobotoVariable), RESOLVE_BY_FONT_TABLE, RESOLVE_BY_FONT_TABLE,
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "pipeline/skia/VectorDrawableAtlas.h"
+#include "tests/common/TestUtils.h"
+
+using namespace android;
+using namespace android::uirenderer;
+using namespace android::uirenderer::skiapipeline;
+
+RENDERTHREAD_TEST(VectorDrawableAtlas, packsEntriesWithoutOverlap) {
+    sp<VectorDrawableAtlas> atlas = new VectorDrawableAtlas();
+    ASSERT_TRUE(atlas->prepareForDraw(renderThread.getGrContext()));
+
+    std::vector<SkIRect> rects;
+    for (int i = 0; i < 100; i++) {
+        uint64_t key = VectorDrawableAtlas::kInvalidKey;
+        VectorDrawableAtlas::Entry entry;
+        int size = 16 + (i % 5) * 20;
+        ASSERT_TRUE(atlas->acquireEntry(&key, size, size, &entry));
+        EXPECT_NE(VectorDrawableAtlas::kInvalidKey, key);
+        EXPECT_TRUE(entry.needsRedraw);
+        EXPECT_EQ(size, entry.rect.width());
+        EXPECT_EQ(size, entry.rect.height());
+        EXPECT_TRUE(SkIRect::MakeWH(VectorDrawableAtlas::kAtlasSize, VectorDrawableAtlas::kAtlasSize)
+                            .contains(entry.rect));
+        for (const SkIRect& other : rects) {
+            EXPECT_FALSE(SkIRect::Intersects(entry.rect.makeOutset(VectorDrawableAtlas::kPadding,
+                                                                   VectorDrawableAtlas::kPadding),
+                                             other));
+        }
+        rects.push_back(entry.rect);
+    }
+    EXPECT_EQ(100, atlas->getEntryCount());
+    EXPECT_NE(nullptr, atlas->getImage());
+}
+
+RENDERTHREAD_TEST(VectorDrawableAtlas, reusesEntries) {
+    sp<VectorDrawableAtlas> atlas = new VectorDrawableAtlas();
+    ASSERT_TRUE(atlas->prepareForDraw(renderThread.getGrContext()));
+
+    uint64_t key = VectorDrawableAtlas::kInvalidKey;
+    VectorDrawableAtlas::Entry first;
+    ASSERT_TRUE(atlas->acquireEntry(&key, 48, 48, &first));
+    const uint64_t firstKey = key;
+
+    ASSERT_TRUE(atlas->prepareForDraw(renderThread.getGrContext()));
+    VectorDrawableAtlas::Entry second;
+    ASSERT_TRUE(atlas->acquireEntry(&key, 48, 48, &second));
+    EXPECT_EQ(firstKey, key);
+    EXPECT_FALSE(second.needsRedraw);
+    EXPECT_EQ(first.rect, second.rect);
+
+    SkIRect rect;
+    EXPECT_TRUE(atlas->getEntry(key, 48, 48, &rect));
+    EXPECT_EQ(first.rect, rect);
+    // A different size needs a new entry
+    EXPECT_FALSE(atlas->getEntry(key, 96, 96, &rect));
+    ASSERT_TRUE(atlas->acquireEntry(&key, 96, 96, &second));
+    EXPECT_NE(firstKey, key);
+    EXPECT_TRUE(second.needsRedraw);
+    EXPECT_FALSE(atlas->getEntry(firstKey, 48, 48, &rect));
+    EXPECT_EQ(1, atlas->getEntryCount());
+}
+
+RENDERTHREAD_TEST(VectorDrawableAtlas, rejectsLargeEntries) {
+    sp<VectorDrawableAtlas> atlas = new VectorDrawableAtlas();
+    ASSERT_TRUE(atlas->prepareForDraw(renderThread.getGrContext()));
+
+    uint64_t key = VectorDrawableAtlas::kInvalidKey;
+    VectorDrawableAtlas::Entry entry;
+    EXPECT_FALSE(atlas->acquireEntry(&key, VectorDrawableAtlas::kMaxEntrySize + 1, 10, &entry));
+    EXPECT_EQ(VectorDrawableAtlas::kInvalidKey, key);
+    EXPECT_EQ(0, atlas->getEntryCount());
+}
+
+RENDERTHREAD_TEST(VectorDrawableAtlas, releasesEntriesOnNextFrame) {
+    sp<VectorDrawableAtlas> atlas = new VectorDrawableAtlas();
+    ASSERT_TRUE(atlas->prepareForDraw(renderThread.getGrContext()));
+
+    uint64_t key = VectorDrawableAtlas::kInvalidKey;
+    VectorDrawableAtlas::Entry entry;
+    ASSERT_TRUE(atlas->acquireEntry(&key, 32, 32, &entry));
+    atlas->releaseEntry(key);
+    EXPECT_EQ(1, atlas->getEntryCount());
+
+    ASSERT_TRUE(atlas->prepareForDraw(renderThread.getGrContext()));
+    EXPECT_EQ(0, atlas->getEntryCount());
+    SkIRect rect;
+    EXPECT_FALSE(atlas->getEntry(key, 32, 32, &rect));
+
+    // The freed cell is handed out again
+    uint64_t newKey = VectorDrawableAtlas::kInvalidKey;
+    VectorDrawableAtlas::Entry newEntry;
+    ASSERT_TRUE(atlas->acquireEntry(&newKey, 32, 32, &newEntry));
+    EXPECT_NE(key, newKey);
+    EXPECT_EQ(entry.rect, newEntry.rect);
+}
+
+RENDERTHREAD_TEST(VectorDrawableAtlas, evictsLeastRecentlyUsed) {
+    sp<VectorDrawableAtlas> atlas = new VectorDrawableAtlas();
+    ASSERT_TRUE(atlas->prepareForDraw(renderThread.getGrContext()));
+
+    // Fill the whole atlas with entries of one size
+    std::vector<uint64_t> keys;
+    std::vector<SkIRect> rects;
+    while (true) {
+        uint64_t key = VectorDrawableAtlas::kInvalidKey;
+        VectorDrawableAtlas::Entry entry;
+        if (!atlas->acquireEntry(&key, 24, 24, &entry)) break;
+        keys.push_back(key);
+        rects.push_back(entry.rect);
+    }
+    ASSERT_GT(keys.size(), 100u);
+
+    // Everything but the first entry is used in the next frame
+    ASSERT_TRUE(atlas->prepareForDraw(renderThread.getGrContext()));
+    SkIRect rect;
+    for (size_t i = 1; i < keys.size(); i++) {
+        ASSERT_TRUE(atlas->getEntry(keys[i], 24, 24, &rect));
+    }
+
+    uint64_t key = VectorDrawableAtlas::kInvalidKey;
+    VectorDrawableAtlas::Entry entry;
+    ASSERT_TRUE(atlas->acquireEntry(&key, 24, 24, &entry));
+    EXPECT_EQ(rects[0], entry.rect);
+    EXPECT_FALSE(atlas->getEntry(keys[0], 24, 24, &rect));
+
+    // Nothing else can be evicted this frame
+    uint64_t otherKey = VectorDrawableAtlas::kInvalidKey;
+    EXPECT_FALSE(atlas->acquireEntry(&otherKey, 24, 24, &entry));
+    EXPECT_EQ(VectorDrawableAtlas::kInvalidKey, otherKey);
+}
@@ -279,6 +279,65 @@ TEST(PathParser, parseStringForData) {
     }
 }
 
+TEST(PathParser, parseFloatsLikeStrtof) {
+    const char* numbers[] = {
+            "0",          "-0",          "1",         "+2",           "12.000000",
+            ".5",         "5.",          "-0.25",     "1e3",          "1E-3",
+            "2e",         "3e+",         "0.1",       "0.3",          "1234567",
+            "12345678",   "0.000000001", "9999999e9", "3.4028234e38", "1.17549435e-38",
+            "16777217",   "0.1000000001"};
+    for (const char* number : numbers) {
+        std::string pathString = std::string("M") + number + " 1";
+        PathParser::ParseResult result;
+        PathData pathData;
+        PathParser::getPathDataFromAsciiString(&pathData, &result, pathString.c_str(),
+                                               pathString.size());
+        ASSERT_FALSE(result.failureOccurred) << number;
+        ASSERT_EQ(2u, pathData.points.size()) << number;
+        const float expected = strtof(number, nullptr);
+        EXPECT_EQ(0, memcmp(&expected, &pathData.points[0], sizeof(float))) << number;
+    }
+}
+
+TEST(PathParser, cachedParsesMatch) {
+    for (const TestData& testData : sTestDataSet) {
+        const size_t length = strlen(testData.pathString);
+        PathParser::clearCache();
+        PathParser::ParseResult coldResult;
+        PathData coldData;
+        SkPath coldPath;
+        PathParser::getPathDataFromAsciiString(&coldData, &coldResult, testData.pathString,
+                                               length);
+        PathParser::parseAsciiStringForSkPath(&coldPath, &coldResult, testData.pathString,
+                                              length);
+
+        for (int i = 0; i < 2; i++) {
+            PathParser::ParseResult result;
+            PathData pathData;
+            SkPath skPath;
+            PathParser::getPathDataFromAsciiString(&pathData, &result, testData.pathString,
+                                                   length);
+            PathParser::parseAsciiStringForSkPath(&skPath, &result, testData.pathString, length);
+            EXPECT_EQ(coldResult.failureOccurred, result.failureOccurred);
+            EXPECT_EQ(coldData, pathData);
+            EXPECT_EQ(coldPath, skPath);
+        }
+    }
+
+    // Failures are not cached, and report the same error every time
+    for (StringPath stringPath : sStringPaths) {
+        if (stringPath.isValid) continue;
+        PathParser::ParseResult first;
+        PathParser::ParseResult second;
+        PathData pathData;
+        const size_t length = strlen(stringPath.stringPath);
+        PathParser::getPathDataFromAsciiString(&pathData, &first, stringPath.stringPath, length);
+        PathParser::getPathDataFromAsciiString(&pathData, &second, stringPath.stringPath, length);
+        EXPECT_TRUE(second.failureOccurred);
+        EXPECT_EQ(first.failureMessage, second.failureMessage);
+    }
+}
+
 TEST(VectorDrawableUtils, createSkPathFromPathData) {
     for (const TestData& testData : sTestDataSet) {
         SkPath expectedPath;
@@ -16,24 +16,64 @@
 
 #include "CommonPool.h"
 
+#include <unistd.h>
 #include <utils/Trace.h>
 
+#include <algorithm>
 #include <array>
+#include <cinttypes>
+#include <fstream>
+
+#include "Properties.h"
 
 namespace android {
 namespace uirenderer {
 
-CommonPool::CommonPool() : CommonPoolBase() {
+static thread_local bool sIsPoolThread = false;
+
+int CommonPool::computeThreadCount() {
+    if (Properties::commonPoolThreadCount > 0) {
+        return std::clamp(Properties::commonPoolThreadCount, 1, MAX_THREAD_COUNT);
+    }
+
+    // Size the pool to the cores outside of the slowest cluster, since a frame waiting on a
+    // task that landed on a little core gains little from running it there. Without cpufreq
+    // information (host builds, some emulators), fall back to the historical two workers.
+    const long cpuCount = sysconf(_SC_NPROCESSORS_CONF);
+    std::vector<long> maxFreqs;
+    for (long cpu = 0; cpu < cpuCount; cpu++) {
+        std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                           "/cpufreq/cpuinfo_max_freq");
+        long freq = 0;
+        if (!(file >> freq)) {
+            return MIN_THREAD_COUNT;
+        }
+        maxFreqs.push_back(freq);
+    }
+    if (maxFreqs.empty()) {
+        return MIN_THREAD_COUNT;
+    }
+    const long minFreq = *std::min_element(maxFreqs.begin(), maxFreqs.end());
+    int bigCores = std::count_if(maxFreqs.begin(), maxFreqs.end(),
+                                 [minFreq](long freq) { return freq > minFreq; });
+    if (bigCores == 0) {
+        // All cores are the same; leave half of them to the UI and render threads.
+        bigCores = maxFreqs.size() / 2;
+    }
+    return std::clamp(bigCores, MIN_THREAD_COUNT, MAX_THREAD_COUNT);
+}
+
+CommonPool::CommonPool() : CommonPoolBase(), mThreadCount(computeThreadCount()) {
     ATRACE_CALL();
 
     CommonPool* pool = this;
     std::mutex mLock;
-    std::vector<int> tids(THREAD_COUNT);
-    std::vector<std::condition_variable> tidConditionVars(THREAD_COUNT);
+    std::vector<int> tids(mThreadCount);
+    std::vector<std::condition_variable> tidConditionVars(mThreadCount);
 
-    // Create 2 workers
-    for (int i = 0; i < THREAD_COUNT; i++) {
+    for (int i = 0; i < mThreadCount; i++) {
         std::thread worker([pool, i, &mLock, &tids, &tidConditionVars] {
+            sIsPoolThread = true;
             pool->setupThread(i, mLock, tids, tidConditionVars);
             pool->workerLoop();
         });
@@ -41,7 +81,7 @@ CommonPool::CommonPool() : CommonPoolBase() {
     }
     {
         std::unique_lock lock(mLock);
-        for (int i = 0; i < THREAD_COUNT; i++) {
+        for (int i = 0; i < mThreadCount; i++) {
             while (!tids[i]) {
                 tidConditionVars[i].wait(lock);
             }
@@ -57,39 +97,78 @@ CommonPool& CommonPool::instance() {
     return pool;
 }
 
-void CommonPool::post(Task&& task) {
-    instance().enqueue(std::move(task));
+void CommonPool::post(Task&& task, Priority priority) {
+    instance().enqueue(std::move(task), priority);
+}
+
+int CommonPool::getThreadCount() {
+    return instance().mThreadCount;
 }
 
 std::vector<int> CommonPool::getThreadIds() {
     return instance().mWorkerThreadIds;
 }
 
-void CommonPool::enqueue(Task&& task) {
+bool CommonPool::isPoolThread() {
+    return sIsPoolThread;
+}
+
+void CommonPool::dump(String8& log) {
+    instance().doDump(log);
+}
+
+void CommonPool::enqueue(Task&& task, Priority priority) {
+    auto& queue = mWorkQueues[static_cast<int>(priority)];
     std::unique_lock lock(mLock);
-    while (!mWorkQueue.hasSpace()) {
+    while (!queue.hasSpace()) {
         lock.unlock();
         usleep(100);
         lock.lock();
     }
-    mWorkQueue.push(std::move(task));
-    if (mWaitingThreads == THREAD_COUNT || (mWaitingThreads > 0 && mWorkQueue.size() > 1)) {
+    queue.push({std::move(task), systemTime(SYSTEM_TIME_MONOTONIC)});
+    auto& stats = mQueueStats[static_cast<int>(priority)];
+    stats.maxDepth = std::max(stats.maxDepth, queue.size());
+    int queuedCount = 0;
+    for (const auto& workQueue : mWorkQueues) {
+        queuedCount += workQueue.size();
+    }
+    if (mWaitingThreads == mThreadCount || (mWaitingThreads > 0 && queuedCount > 1)) {
         mCondition.notify_one();
     }
 }
 
+bool CommonPool::hasWork() const {
+    return std::any_of(std::begin(mWorkQueues), std::end(mWorkQueues),
+                       [](const auto& queue) { return queue.hasWork(); });
+}
+
+CommonPool::Task CommonPool::takeWork() {
+    for (int i = 0; i < PRIORITY_COUNT; i++) {
+        if (mWorkQueues[i].hasWork()) {
+            QueuedTask queued = mWorkQueues[i].pop();
+            const nsecs_t wait = systemTime(SYSTEM_TIME_MONOTONIC) - queued.enqueueTime;
+            auto& stats = mQueueStats[i];
+            stats.taskCount++;
+            stats.totalWait += wait;
+            stats.maxWait = std::max(stats.maxWait, wait);
+            return std::move(queued.task);
+        }
+    }
+    LOG_ALWAYS_FATAL("empty");
+}
+
 void CommonPool::workerLoop() {
     std::unique_lock lock(mLock);
     while (!mIsStopping) {
-        if (!mWorkQueue.hasWork()) {
+        if (!hasWork()) {
             mWaitingThreads++;
             mCondition.wait(lock);
             mWaitingThreads--;
         }
         // Need to double-check that work is still available now that we have the lock
         // It may have already been grabbed by a different thread
-        while (mWorkQueue.hasWork()) {
-            auto work = mWorkQueue.pop();
+        while (hasWork()) {
+            auto work = takeWork();
             lock.unlock();
             work();
             lock.lock();
@@ -97,13 +176,28 @@ void CommonPool::workerLoop() {
     }
 }
 
+void CommonPool::doDump(String8& log) {
+    static constexpr std::array<const char*, PRIORITY_COUNT> kNames = {"frame-critical",
+                                                                     "background"};
+    std::unique_lock lock(mLock);
+    log.appendFormat("CommonPool: %d threads\n", mThreadCount);
+    for (int i = 0; i < PRIORITY_COUNT; i++) {
+        const auto& stats = mQueueStats[i];
+        const nsecs_t averageWait = stats.taskCount ? stats.totalWait / stats.taskCount : 0;
+        log.appendFormat("  %s: %" PRIu64 " tasks, queued %d (max %d), wait avg %.3fms max "
+                         "%.3fms\n",
+                         kNames[i], stats.taskCount, mWorkQueues[i].size(), stats.maxDepth,
+                         ns2us(averageWait) / 1000.0, ns2us(stats.maxWait) / 1000.0);
+    }
+}
+
 void CommonPool::waitForIdle() {
     instance().doWaitForIdle();
 }
 
 void CommonPool::doWaitForIdle() {
     std::unique_lock lock(mLock);
-    while (mWaitingThreads != THREAD_COUNT) {
+    while (mWaitingThreads != mThreadCount) {
         lock.unlock();
         usleep(100);
         lock.lock();
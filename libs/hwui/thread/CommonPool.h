@@ -18,6 +18,8 @@
 #define FRAMEWORKS_BASE_COMMONPOOL_H
 
 #include <log/log.h>
+#include <utils/String8.h>
+#include <utils/Timers.h>
 
 #include <condition_variable>
 #include <functional>
@@ -43,13 +45,7 @@ public:
     constexpr size_t capacity() const { return SIZE; }
     constexpr bool hasWork() const { return mHead != mTail; }
     constexpr bool hasSpace() const { return ((mHead + 1) % SIZE) != mTail; }
-    constexpr int size() const {
-        if (mHead > mTail) {
-            return mHead - mTail;
-        } else {
-            return mTail - mHead + SIZE;
-        }
-    }
+    constexpr int size() const { return (mHead - mTail + SIZE) % SIZE; }
 
     constexpr void push(T&& t) {
         int newHead = (mHead + 1) % SIZE;
@@ -59,12 +55,17 @@ public:
         mHead = newHead;
     }
 
+    constexpr const T& front() const {
+        LOG_ALWAYS_FATAL_IF(mTail == mHead, "empty");
+        return mBuffer[mTail];
+    }
+
     constexpr T pop() {
         LOG_ALWAYS_FATAL_IF(mTail == mHead, "empty");
         int index = mTail;
         mTail = (mTail + 1) % SIZE;
         T ret = std::move(mBuffer[index]);
-        mBuffer[index] = nullptr;
+        mBuffer[index] = T{};
         return ret;
     }
 
@@ -79,28 +80,43 @@ class CommonPool : private CommonPoolBase {
 
 public:
     using Task = std::function<void()>;
-    static constexpr auto THREAD_COUNT = 2;
+    // Bounds for the number of workers, which is sized to the device's CPUs on startup.
+    static constexpr auto MIN_THREAD_COUNT = 2;
+    static constexpr auto MAX_THREAD_COUNT = 4;
     static constexpr auto QUEUE_SIZE = 128;
 
-    static void post(Task&& func);
+    // Queued frame-critical tasks are always picked up before background ones.
+    enum class Priority { FrameCritical = 0, Background = 1 };
+
+    static void post(Task&& func, Priority priority = Priority::Background);
 
     template <class F>
-    static auto async(F&& func) -> std::future<decltype(func())> {
+    static auto async(F&& func, Priority priority = Priority::Background)
+            -> std::future<decltype(func())> {
         typedef std::packaged_task<decltype(func())()> task_t;
         auto task = std::make_shared<task_t>(std::forward<F>(func));
-        post([task]() { std::invoke(*task); });
+        post([task]() { std::invoke(*task); }, priority);
         return task->get_future();
     }
 
+    // The caller blocks on the result, so the task is frame-critical.
     template <class F>
     static auto runSync(F&& func) -> decltype(func()) {
         std::packaged_task<decltype(func())()> task{std::forward<F>(func)};
-        post([&task]() { std::invoke(task); });
+        post([&task]() { std::invoke(task); }, Priority::FrameCritical);
         return task.get_future().get();
     };
 
+    static int getThreadCount();
     static std::vector<int> getThreadIds();
 
+    // Returns true when called from one of the worker threads. Work that is split across the
+    // pool should run serially there, as waiting on the other workers may deadlock.
+    static bool isPoolThread();
+
+    // Appends the queue depth and wait time stats of each priority to log.
+    static void dump(String8& log);
+
     // For testing purposes only, blocks until all worker threads are parked.
     static void waitForIdle();
 
@@ -113,17 +129,38 @@ private:
         mCondition.notify_all();
     }
 
-    void enqueue(Task&&);
+    static constexpr auto PRIORITY_COUNT = 2;
+
+    struct QueuedTask {
+        Task task;
+        nsecs_t enqueueTime = 0;
+    };
+
+    struct QueueStats {
+        uint64_t taskCount = 0;
+        int maxDepth = 0;
+        nsecs_t totalWait = 0;
+        nsecs_t maxWait = 0;
+    };
+
+    static int computeThreadCount();
+
+    void enqueue(Task&&, Priority priority);
+    bool hasWork() const;
+    Task takeWork();
+    void doDump(String8& log);
     void doWaitForIdle();
 
     void workerLoop();
 
+    const int mThreadCount;
     std::vector<int> mWorkerThreadIds;
 
     std::mutex mLock;
     std::condition_variable mCondition;
     int mWaitingThreads = 0;
-    ArrayQueue<Task, QUEUE_SIZE> mWorkQueue;
+    ArrayQueue<QueuedTask, QUEUE_SIZE> mWorkQueues[PRIORITY_COUNT];
+    QueueStats mQueueStats[PRIORITY_COUNT];
     std::atomic_bool mIsStopping = false;
 };
 
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "utils/Macros.h"
+
+namespace android::uirenderer {
+
+/**
+ * A move-only void() callable that stores small functors inline instead of on the heap.
+ *
+ * Functors that don't fit in kInlineSize bytes, or that need a stricter alignment than a
+ * pointer, are moved to the heap, so any callable can be stored.
+ */
+template <size_t kInlineSize>
+class InlineTask {
+    PREVENT_COPY_AND_ASSIGN(InlineTask);
+
+public:
+    InlineTask() = default;
+
+    template <class F, class = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InlineTask>>>
+    InlineTask(F&& func) {
+        using T = std::decay_t<F>;
+        if constexpr (fitsInline<T>()) {
+            new (mStorage) T(std::forward<F>(func));
+            mOps = &kInlineOps<T>;
+        } else {
+            *reinterpret_cast<T**>(mStorage) = new T(std::forward<F>(func));
+            mOps = &kHeapOps<T>;
+        }
+    }
+
+    InlineTask(InlineTask&& other) { moveFrom(other); }
+
+    InlineTask& operator=(InlineTask&& other) {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    ~InlineTask() { reset(); }
+
+    explicit operator bool() const { return mOps != nullptr; }
+
+    void operator()() { mOps->invoke(mStorage); }
+
+    void reset() {
+        if (mOps) {
+            mOps->destroy(mStorage);
+            mOps = nullptr;
+        }
+    }
+
+    template <class T>
+    static constexpr bool fitsInline() {
+        return sizeof(T) <= kInlineSize && alignof(T) <= alignof(void*) &&
+               std::is_nothrow_move_constructible_v<T>;
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        // Move constructs the functor in dst from src and destroys src
+        void (*relocate)(void* dst, void* src);
+        void (*destroy)(void* storage);
+    };
+
+    template <class T>
+    static constexpr Ops kInlineOps = {
+            [](void* storage) { (*static_cast<T*>(storage))(); },
+            [](void* dst, void* src) {
+                new (dst) T(std::move(*static_cast<T*>(src)));
+                static_cast<T*>(src)->~T();
+            },
+            [](void* storage) { static_cast<T*>(storage)->~T(); },
+    };
+
+    template <class T>
+    static constexpr Ops kHeapOps = {
+            [](void* storage) { (**static_cast<T**>(storage))(); },
+            [](void* dst, void* src) { *static_cast<T**>(dst) = *static_cast<T**>(src); },
+            [](void* storage) { delete *static_cast<T**>(storage); },
+    };
+
+    void moveFrom(InlineTask& other) {
+        mOps = other.mOps;
+        if (mOps) {
+            mOps->relocate(mStorage, other.mStorage);
+            other.mOps = nullptr;
+        }
+    }
+
+    static_assert(kInlineSize >= sizeof(void*), "Storage must at least hold a pointer");
+    alignas(void*) unsigned char mStorage[kInlineSize];
+    const Ops* mOps = nullptr;
+};
+
+}  // namespace android::uirenderer
@@ -17,15 +17,18 @@
 #ifndef HWUI_WORKQUEUE_H
 #define HWUI_WORKQUEUE_H
 
+#include "thread/InlineTask.h"
 #include "utils/Macros.h"
 
 #include <log/log.h>
 #include <utils/Timers.h>
 
+#include <atomic>
 #include <condition_variable>
 #include <functional>
 #include <future>
 #include <mutex>
+#include <optional>
 #include <vector>
 
 namespace android::uirenderer {
@@ -41,6 +44,76 @@ public:
     using clock = MonotonicClock;
 
 private:
+    // Sized so that a task is one cache line, which fits the captures of nearly every RenderProxy
+    // call. Larger captures still go through the ring, just with a heap allocation.
+    using Task = InlineTask<56>;
+
+    /**
+     * A fixed capacity multi-producer, single-consumer ring of tasks. Producers claim a slot by
+     * bumping mTail and then publish it through the slot's sequence number, so posting takes no
+     * lock and does not allocate.
+     */
+    class TaskRing {
+    public:
+        static constexpr size_t kCapacity = 128;
+
+        TaskRing() {
+            for (size_t i = 0; i < kCapacity; i++) {
+                mSlots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        // Returns false, leaving task untouched, if the ring is full
+        bool tryPush(Task& task) {
+            size_t pos = mTail.load(std::memory_order_relaxed);
+            Slot* slot;
+            while (true) {
+                slot = &mSlots[pos % kCapacity];
+                size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+                if (diff == 0) {
+                    if (mTail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = mTail.load(std::memory_order_relaxed);
+                }
+            }
+            slot->task = std::move(task);
+            slot->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Must only be called by the consumer
+        bool tryPop(Task* outTask) {
+            Slot& slot = mSlots[mHead % kCapacity];
+            if (slot.sequence.load(std::memory_order_acquire) != mHead + 1) {
+                return false;
+            }
+            *outTask = std::move(slot.task);
+            slot.sequence.store(mHead + kCapacity, std::memory_order_release);
+            mHead++;
+            return true;
+        }
+
+        // Must only be called by the consumer
+        bool isEmpty() const {
+            return mSlots[mHead % kCapacity].sequence.load(std::memory_order_acquire) != mHead + 1;
+        }
+
+    private:
+        struct Slot {
+            std::atomic<size_t> sequence;
+            Task task;
+        };
+
+        Slot mSlots[kCapacity];
+        alignas(64) std::atomic<size_t> mTail{0};
+        alignas(64) size_t mHead = 0;
+    };
+
     struct WorkItem {
         WorkItem() = delete;
         WorkItem(const WorkItem& other) = delete;
@@ -60,6 +133,8 @@ public:
             : mWakeFunc(std::move(wakeFunc)), mLock(lock) {}
 
     void process() {
+        processImmediate();
+
         auto now = clock::now();
         std::vector<WorkItem> toProcess;
         {
@@ -89,9 +164,22 @@ public:
         enqueue(WorkItem{clock::now() + delay, std::function<void()>(std::forward<F>(func))});
     }
 
+    // Runs func as soon as possible, in the order of posting. This doesn't lock or allocate
+    // unless func is too large for inline storage or the queue is backed up.
     template <class F>
     void post(F&& func) {
-        postAt(0, std::forward<F>(func));
+        Task task{std::forward<F>(func)};
+        if (mOverflowing.load(std::memory_order_acquire) || !mRing.tryPush(task)) {
+            // Everything goes to the overflow while it holds tasks, to keep the order of posting
+            std::unique_lock _lock{mLock};
+            mOverflow.push_back(std::move(task));
+            mOverflowing.store(true, std::memory_order_release);
+        }
+        if (!mWakePending.exchange(true)) {
+            // Lets a consumer that is about to sleep see the task before it waits
+            { std::unique_lock _lock{mLock}; }
+            mWakeFunc();
+        }
     }
 
     template <class F>
@@ -102,15 +190,45 @@ public:
         return task->get_future();
     }
 
+    // Blocks until func has run on the queue's thread. The result and the completion signal live
+    // on the caller's stack, so nothing is allocated.
     template <class F>
     auto runSync(F&& func) -> decltype(func()) {
-        std::packaged_task<decltype(func())()> task{std::forward<F>(func)};
-        post([&task]() { std::invoke(task); });
-        return task.get_future().get();
+        using R = decltype(func());
+        using Result = std::conditional_t<std::is_reference_v<R>, std::remove_reference_t<R>*,
+                                          std::conditional_t<std::is_void_v<R>, bool, R>>;
+        std::optional<Result> result;
+        std::mutex doneLock;
+        std::condition_variable doneCondition;
+        bool done = false;
+        post([&]() {
+            if constexpr (std::is_void_v<R>) {
+                func();
+            } else if constexpr (std::is_reference_v<R>) {
+                result.emplace(&func());
+            } else {
+                result.emplace(func());
+            }
+            std::unique_lock _lock{doneLock};
+            done = true;
+            doneCondition.notify_one();
+        });
+        std::unique_lock _lock{doneLock};
+        doneCondition.wait(_lock, [&done]() { return done; });
+        if constexpr (std::is_reference_v<R>) {
+            return static_cast<R>(**result);
+        } else if constexpr (!std::is_void_v<R>) {
+            return std::move(*result);
+        }
     };
 
     nsecs_t nextWakeup(std::unique_lock<std::mutex>& lock) {
-        if (mWorkQueue.empty()) {
+        // Posts from here on must wake the thread again. Reading the flag also makes the tasks of
+        // every post that skipped the wakeup visible to the check below.
+        mWakePending.exchange(false);
+        if (!mRing.isEmpty() || !mOverflow.empty()) {
+            return 0;
+        } else if (mWorkQueue.empty()) {
             return std::numeric_limits<nsecs_t>::max();
         } else {
             return std::begin(mWorkQueue)->runAt;
@@ -118,6 +236,31 @@ public:
     }
 
 private:
+    void processImmediate() {
+        Task task;
+        while (mRing.tryPop(&task)) {
+            task();
+            task.reset();
+        }
+        if (!mOverflowing.load(std::memory_order_acquire)) return;
+
+        // Tasks that made it into the ring before the overflow started must run first. A thread
+        // that overflowed has published its earlier ring tasks by the time it released the lock.
+        std::vector<Task> toProcess;
+        {
+            std::unique_lock _lock{mLock};
+            while (mRing.tryPop(&task)) {
+                toProcess.push_back(std::move(task));
+            }
+            std::move(mOverflow.begin(), mOverflow.end(), std::back_inserter(toProcess));
+            mOverflow.clear();
+            mOverflowing.store(false, std::memory_order_release);
+        }
+        for (auto& item : toProcess) {
+            item();
+        }
+    }
+
     void enqueue(WorkItem&& item) {
         bool needsWakeup;
         {
@@ -137,6 +280,11 @@ private:
 
     std::mutex& mLock;
     std::vector<WorkItem> mWorkQueue;
+
+    TaskRing mRing;
+    std::atomic_bool mWakePending{false};
+    std::atomic_bool mOverflowing{false};
+    std::vector<Task> mOverflow;
 };
 
 }  // namespace android::uirenderer
@@ -15,9 +15,16 @@
  */
 
 #include <math.h>
+#include <string.h>
+
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <vector>
 
 #include "Blur.h"
 #include "MathUtils.h"
+#include "thread/CommonPool.h"
 
 namespace android {
 namespace uirenderer {
@@ -91,91 +98,330 @@ void Blur::generateGaussianWeights(float* weights, float radius) {
     }
 }
 
-void Blur::horizontal(float* weights, int32_t radius, const uint8_t* source, uint8_t* dest,
-                      int32_t width, int32_t height) {
+namespace {
+
+// Vector types for the separable kernels. The compiler lowers them to NEON or SSE2, and to
+// AVX2 inside the functions built for it.
+struct Lanes4 {
+    typedef float Float __attribute__((vector_size(16)));
+    typedef int32_t Int __attribute__((vector_size(16)));
+    typedef uint8_t Byte __attribute__((vector_size(4)));
+};
+
+struct Lanes8 {
+    typedef float Float __attribute__((vector_size(32)));
+    typedef int32_t Int __attribute__((vector_size(32)));
+    typedef uint8_t Byte __attribute__((vector_size(8)));
+};
+
+template <typename L>
+constexpr int32_t kLaneCount = sizeof(typename L::Float) / sizeof(float);
+
+template <typename L>
+__attribute__((always_inline)) inline typename L::Float loadPixels(const uint8_t* source) {
+    typename L::Byte pixels;
+    memcpy(&pixels, source, sizeof(pixels));
+    return __builtin_convertvector(pixels, typename L::Float);
+}
+
+template <typename L>
+__attribute__((always_inline)) inline void storePixels(typename L::Float value, uint8_t* dest) {
+    // Truncates like the scalar (uint8_t) cast
+    typename L::Byte pixels =
+            __builtin_convertvector(__builtin_convertvector(value, typename L::Int),
+                                    typename L::Byte);
+    memcpy(dest, &pixels, sizeof(pixels));
+}
+
+inline int32_t clampIndex(int32_t index, int32_t size) {
+    return std::clamp(index, 0, size - 1);
+}
+
+// The scalar kernels sum the taps in the same order as the vector ones, so that both produce
+// the same output.
+inline uint8_t horizontalPixel(const float* weights, int32_t radius, const uint8_t* input,
+                               int32_t x, int32_t width) {
     float blurredPixel = 0.0f;
-    float currentPixel = 0.0f;
+    for (int32_t r = -radius; r <= radius; r++) {
+        // Stepping left and right away from the pixel
+        blurredPixel += (float)input[clampIndex(x + r, width)] * weights[r + radius];
+    }
+    return (uint8_t)blurredPixel;
+}
+
+inline uint8_t verticalPixel(const float* weights, int32_t radius, const uint8_t* source,
+                             int32_t x, int32_t y, int32_t width, int32_t height) {
+    float blurredPixel = 0.0f;
+    for (int32_t r = -radius; r <= radius; r++) {
+        blurredPixel += (float)source[clampIndex(y + r, height) * width + x] * weights[r + radius];
+    }
+    return (uint8_t)blurredPixel;
+}
 
-    for (int32_t y = 0; y < height; y++) {
+void horizontalScalar(const float* weights, int32_t radius, const uint8_t* source, uint8_t* dest,
+                      int32_t width, int32_t yStart, int32_t yEnd) {
+    for (int32_t y = yStart; y < yEnd; y++) {
         const uint8_t* input = source + y * width;
         uint8_t* output = dest + y * width;
+        for (int32_t x = 0; x < width; x++) {
+            output[x] = horizontalPixel(weights, radius, input, x, width);
+        }
+    }
+}
 
+void verticalScalar(const float* weights, int32_t radius, const uint8_t* source, uint8_t* dest,
+                    int32_t width, int32_t height, int32_t yStart, int32_t yEnd) {
+    for (int32_t y = yStart; y < yEnd; y++) {
+        uint8_t* output = dest + y * width;
         for (int32_t x = 0; x < width; x++) {
-            blurredPixel = 0.0f;
-            const float* gPtr = weights;
-            // Optimization for non-border pixels
-            if (x > radius && x < (width - radius)) {
-                const uint8_t* i = input + (x - radius);
-                for (int r = -radius; r <= radius; r++) {
-                    currentPixel = (float)(*i);
-                    blurredPixel += currentPixel * gPtr[0];
-                    gPtr++;
-                    i++;
-                }
-            } else {
-                for (int32_t r = -radius; r <= radius; r++) {
-                    // Stepping left and right away from the pixel
-                    int validW = x + r;
-                    if (validW < 0) {
-                        validW = 0;
-                    }
-                    if (validW > width - 1) {
-                        validW = width - 1;
-                    }
-
-                    currentPixel = (float)input[validW];
-                    blurredPixel += currentPixel * gPtr[0];
-                    gPtr++;
-                }
+            output[x] = verticalPixel(weights, radius, source, x, y, width, height);
+        }
+    }
+}
+
+template <typename L>
+__attribute__((always_inline)) inline void horizontalRows(const float* weights, int32_t radius,
+                                                          const uint8_t* source, uint8_t* dest,
+                                                          int32_t width, int32_t yStart,
+                                                          int32_t yEnd) {
+    constexpr int32_t N = kLaneCount<L>;
+    for (int32_t y = yStart; y < yEnd; y++) {
+        const uint8_t* input = source + y * width;
+        uint8_t* output = dest + y * width;
+        int32_t x = 0;
+        // Pixels near the left edge need clamping
+        for (; x < std::min(radius, width); x++) {
+            output[x] = horizontalPixel(weights, radius, input, x, width);
+        }
+        for (; x + N + radius <= width; x += N) {
+            const uint8_t* i = input + x - radius;
+            typename L::Float blurredPixels = {};
+            for (int32_t r = 0; r <= 2 * radius; r++) {
+                blurredPixels += loadPixels<L>(i + r) * weights[r];
             }
-            *output = (uint8_t)blurredPixel;
-            output++;
+            storePixels<L>(blurredPixels, output + x);
+        }
+        for (; x < width; x++) {
+            output[x] = horizontalPixel(weights, radius, input, x, width);
         }
     }
 }
 
-void Blur::vertical(float* weights, int32_t radius, const uint8_t* source, uint8_t* dest,
-                    int32_t width, int32_t height) {
-    float blurredPixel = 0.0f;
-    float currentPixel = 0.0f;
+template <typename L>
+__attribute__((always_inline)) inline void verticalRows(const float* weights, int32_t radius,
+                                                        const uint8_t* source, uint8_t* dest,
+                                                        int32_t width, int32_t height,
+                                                        int32_t yStart, int32_t yEnd) {
+    constexpr int32_t N = kLaneCount<L>;
+    for (int32_t y = yStart; y < yEnd; y++) {
+        uint8_t* output = dest + y * width;
+        int32_t x = 0;
+        for (; x + N <= width; x += N) {
+            typename L::Float blurredPixels = {};
+            for (int32_t r = -radius; r <= radius; r++) {
+                const uint8_t* i = source + clampIndex(y + r, height) * width + x;
+                blurredPixels += loadPixels<L>(i) * weights[r + radius];
+            }
+            storePixels<L>(blurredPixels, output + x);
+        }
+        for (; x < width; x++) {
+            output[x] = verticalPixel(weights, radius, source, x, y, width, height);
+        }
+    }
+}
 
-    for (int32_t y = 0; y < height; y++) {
+void horizontalVector(const float* weights, int32_t radius, const uint8_t* source, uint8_t* dest,
+                      int32_t width, int32_t yStart, int32_t yEnd) {
+    horizontalRows<Lanes4>(weights, radius, source, dest, width, yStart, yEnd);
+}
+
+void verticalVector(const float* weights, int32_t radius, const uint8_t* source, uint8_t* dest,
+                    int32_t width, int32_t height, int32_t yStart, int32_t yEnd) {
+    verticalRows<Lanes4>(weights, radius, source, dest, width, height, yStart, yEnd);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BLUR_HAS_AVX2_KERNELS 1
+
+__attribute__((target("avx2"))) void horizontalAvx2(const float* weights, int32_t radius,
+                                                    const uint8_t* source, uint8_t* dest,
+                                                    int32_t width, int32_t yStart, int32_t yEnd) {
+    horizontalRows<Lanes8>(weights, radius, source, dest, width, yStart, yEnd);
+}
+
+__attribute__((target("avx2"))) void verticalAvx2(const float* weights, int32_t radius,
+                                                  const uint8_t* source, uint8_t* dest,
+                                                  int32_t width, int32_t height, int32_t yStart,
+                                                  int32_t yEnd) {
+    verticalRows<Lanes8>(weights, radius, source, dest, width, height, yStart, yEnd);
+}
+
+bool hasAvx2() {
+    static const bool sHasAvx2 = __builtin_cpu_supports("avx2");
+    return sHasAvx2;
+}
+#endif
+
+// Below this many multiply-adds per pass, handing bands to other threads costs more than it
+// saves
+constexpr int64_t kMinBandedWork = 1 << 20;
+constexpr int32_t kMinBandRows = 16;
+
+// Runs rows(yStart, yEnd) over [0, height), split into bands across CommonPool threads when
+// the pass is large enough. The calling thread processes the first band.
+template <typename RowsFn>
+void forEachBand(int64_t workPerRow, int32_t height, RowsFn&& rows) {
+    int32_t bandCount = 1;
+    if (workPerRow * height >= kMinBandedWork && !CommonPool::isPoolThread()) {
+        bandCount = std::min(CommonPool::getThreadCount() + 1, height / kMinBandRows);
+    }
+    if (bandCount <= 1) {
+        rows(0, height);
+        return;
+    }
+    const int32_t bandRows = (height + bandCount - 1) / bandCount;
+    std::vector<std::future<void>> bands;
+    for (int32_t y = bandRows; y < height; y += bandRows) {
+        const int32_t yEnd = std::min(height, y + bandRows);
+        // The caller blocks on the bands, so they are frame-critical.
+        bands.push_back(CommonPool::async([&rows, y, yEnd] { rows(y, yEnd); },
+                                          CommonPool::Priority::FrameCritical));
+    }
+    rows(0, bandRows);
+    for (auto& band : bands) {
+        band.get();
+    }
+}
+
+// Finds the sizes of three box blurs that approximate a gaussian with the given sigma.
+// See "Fast Almost-Gaussian Filtering", Kovesi 2010.
+void boxSizesForGaussian(float sigma, int32_t sizes[3]) {
+    constexpr int32_t n = 3;
+    const float variance = 12.0f * sigma * sigma;
+    int32_t lower = floorf(sqrtf(variance / n + 1.0f));
+    if (lower % 2 == 0) lower--;
+    const int32_t lowerCount = roundf((variance - n * lower * lower - 4 * n * lower - 3 * n) /
+                                      (-4.0f * lower - 4.0f));
+    for (int32_t i = 0; i < n; i++) {
+        sizes[i] = i < lowerCount ? lower : lower + 2;
+    }
+}
+
+void boxHorizontal(int32_t boxRadius, const uint8_t* source, uint8_t* dest, int32_t width,
+                   int32_t yStart, int32_t yEnd) {
+    const uint32_t size = 2 * boxRadius + 1;
+    for (int32_t y = yStart; y < yEnd; y++) {
+        const uint8_t* input = source + y * width;
         uint8_t* output = dest + y * width;
+        uint32_t sum = 0;
+        for (int32_t r = -boxRadius; r <= boxRadius; r++) {
+            sum += input[clampIndex(r, width)];
+        }
+        for (int32_t x = 0; x < width; x++) {
+            output[x] = (sum + size / 2) / size;
+            sum += input[clampIndex(x + boxRadius + 1, width)];
+            sum -= input[clampIndex(x - boxRadius, width)];
+        }
+    }
+}
 
+void boxVertical(int32_t boxRadius, const uint8_t* source, uint8_t* dest, int32_t width,
+                 int32_t height, int32_t yStart, int32_t yEnd) {
+    const uint32_t size = 2 * boxRadius + 1;
+    // Running column sums, so that the inner loops walk rows
+    std::vector<uint32_t> sums(width, 0);
+    for (int32_t r = yStart - boxRadius; r <= yStart + boxRadius; r++) {
+        const uint8_t* input = source + clampIndex(r, height) * width;
         for (int32_t x = 0; x < width; x++) {
-            blurredPixel = 0.0f;
-            const float* gPtr = weights;
-            const uint8_t* input = source + x;
-            // Optimization for non-border pixels
-            if (y > radius && y < (height - radius)) {
-                const uint8_t* i = input + ((y - radius) * width);
-                for (int32_t r = -radius; r <= radius; r++) {
-                    currentPixel = (float)(*i);
-                    blurredPixel += currentPixel * gPtr[0];
-                    gPtr++;
-                    i += width;
-                }
-            } else {
-                for (int32_t r = -radius; r <= radius; r++) {
-                    int validH = y + r;
-                    // Clamp to zero and width
-                    if (validH < 0) {
-                        validH = 0;
-                    }
-                    if (validH > height - 1) {
-                        validH = height - 1;
-                    }
-
-                    const uint8_t* i = input + validH * width;
-                    currentPixel = (float)(*i);
-                    blurredPixel += currentPixel * gPtr[0];
-                    gPtr++;
-                }
-            }
-            *output = (uint8_t)blurredPixel;
-            output++;
+            sums[x] += input[x];
         }
     }
+    for (int32_t y = yStart; y < yEnd; y++) {
+        uint8_t* output = dest + y * width;
+        const uint8_t* added = source + clampIndex(y + boxRadius + 1, height) * width;
+        const uint8_t* removed = source + clampIndex(y - boxRadius, height) * width;
+        for (int32_t x = 0; x < width; x++) {
+            output[x] = (sums[x] + size / 2) / size;
+            sums[x] += added[x];
+            sums[x] -= removed[x];
+        }
+    }
+}
+
+}  // namespace
+
+void Blur::horizontal(float* weights, int32_t radius, const uint8_t* source, uint8_t* dest,
+                      int32_t width, int32_t height, Kernel kernel) {
+    if (kernel == Kernel::Scalar) {
+        horizontalScalar(weights, radius, source, dest, width, 0, height);
+        return;
+    }
+    auto rows = horizontalVector;
+#ifdef BLUR_HAS_AVX2_KERNELS
+    if (hasAvx2()) {
+        rows = horizontalAvx2;
+    }
+#endif
+    forEachBand(int64_t(width) * (2 * radius + 1), height,
+                [&](int32_t yStart, int32_t yEnd) {
+                    rows(weights, radius, source, dest, width, yStart, yEnd);
+                });
+}
+
+void Blur::vertical(float* weights, int32_t radius, const uint8_t* source, uint8_t* dest,
+                    int32_t width, int32_t height, Kernel kernel) {
+    if (kernel == Kernel::Scalar) {
+        verticalScalar(weights, radius, source, dest, width, height, 0, height);
+        return;
+    }
+    auto rows = verticalVector;
+#ifdef BLUR_HAS_AVX2_KERNELS
+    if (hasAvx2()) {
+        rows = verticalAvx2;
+    }
+#endif
+    forEachBand(int64_t(width) * (2 * radius + 1), height,
+                [&](int32_t yStart, int32_t yEnd) {
+                    rows(weights, radius, source, dest, width, height, yStart, yEnd);
+                });
+}
+
+void Blur::blur(float radius, const uint8_t* source, uint8_t* dest, int32_t width,
+                int32_t height) {
+    const size_t pixelCount = size_t(width) * height;
+    if (pixelCount == 0) return;
+    std::unique_ptr<uint8_t[]> scratch(new uint8_t[pixelCount]);
+
+    if (radius <= kMaxGaussianRadius) {
+        const int32_t intRadius = convertRadiusToInt(radius);
+        std::vector<float> weights(2 * intRadius + 1);
+        generateGaussianWeights(weights.data(), radius);
+        horizontal(weights.data(), intRadius, source, scratch.get(), width, height);
+        vertical(weights.data(), intRadius, scratch.get(), dest, width, height);
+        return;
+    }
+
+    int32_t sizes[3];
+    boxSizesForGaussian(legacyConvertRadiusToSigma(radius), sizes);
+    // Ping-pong between the scratch buffer and dest so that the last pass lands in dest.
+    // source is only read by the first pass, so it may alias dest.
+    const uint8_t* input = source;
+    uint8_t* buffers[2] = {scratch.get(), dest};
+    int pass = 0;
+    for (int32_t size : sizes) {
+        uint8_t* output = buffers[pass++ % 2];
+        forEachBand(width, height, [&](int32_t yStart, int32_t yEnd) {
+            boxHorizontal(size / 2, input, output, width, yStart, yEnd);
+        });
+        input = output;
+    }
+    for (int32_t size : sizes) {
+        uint8_t* output = buffers[pass++ % 2];
+        forEachBand(width, height, [&](int32_t yStart, int32_t yEnd) {
+            boxVertical(size / 2, input, output, width, height, yStart, yEnd);
+        });
+        input = output;
+    }
 }
 
 }  // namespace uirenderer
@@ -34,11 +34,24 @@ public:
     // accounts for that error and snaps to the appropriate integer boundary.
     static uint32_t convertRadiusToInt(float radius);
 
+    // The kernels used by horizontal() and vertical(). Auto uses the widest vector unit of
+    // the CPU and splits large images across CommonPool threads. Scalar is the reference
+    // implementation, run on the calling thread only.
+    enum class Kernel { Auto, Scalar };
+
     static void generateGaussianWeights(float* weights, float radius);
     static void horizontal(float* weights, int32_t radius, const uint8_t* source, uint8_t* dest,
-                           int32_t width, int32_t height);
+                           int32_t width, int32_t height, Kernel kernel = Kernel::Auto);
     static void vertical(float* weights, int32_t radius, const uint8_t* source, uint8_t* dest,
-                         int32_t width, int32_t height);
+                         int32_t width, int32_t height, Kernel kernel = Kernel::Auto);
+
+    // Radii above this are blurred by blur() with three box blurs per direction, which
+    // approximate the gaussian in constant time per pixel.
+    static constexpr float kMaxGaussianRadius = 16.0f;
+
+    // Blurs source in both directions into dest, which may be the same buffer.
+    static void blur(float radius, const uint8_t* source, uint8_t* dest, int32_t width,
+                     int32_t height);
 };
 
 }  // namespace uirenderer
@@ -75,6 +75,12 @@ namespace uirenderer {
 static constexpr size_t kInitialPageSize = 512;  // 512b
 static constexpr size_t kMaxPageSize = 131072;   // 128kb
 
+// Pages of each size from kInitialPageSize to kMaxPageSize are pooled separately
+static constexpr size_t kPagePoolClassCount = 9;
+static_assert(kInitialPageSize << (kPagePoolClassCount - 1) == kMaxPageSize);
+// The most page memory a thread keeps around for the next LinearAllocator
+static constexpr size_t kMaxPooledBytes = 256 * 1024;
+
 class LinearAllocator::Page {
 public:
     Page* next() { return mNextPage; }
@@ -93,6 +99,71 @@ private:
     Page* mNextPage;
 };
 
+// Returns the pool class of a page of the given usable size, or -1 if it is not pooled.
+static int pagePoolClass(size_t pageSize) {
+    for (int i = 0; i < static_cast<int>(kPagePoolClassCount); i++) {
+        if (ALIGN(kInitialPageSize << i) == pageSize) return i;
+    }
+    return -1;
+}
+
+namespace {
+
+class PagePool {
+public:
+    ~PagePool() {
+        trim();
+        // LinearAllocators destroyed later during thread exit free their pages directly.
+        mDestroyed = true;
+    }
+
+    void* acquire(size_t pageSize) {
+        int sizeClass = pagePoolClass(pageSize);
+        if (sizeClass < 0 || !mPages[sizeClass]) return nullptr;
+        auto page = mPages[sizeClass];
+        mPages[sizeClass] = page->next;
+        mPooledBytes -= pageSize;
+        return page;
+    }
+
+    bool release(void* buf, size_t pageSize) {
+        int sizeClass = pagePoolClass(pageSize);
+        if (mDestroyed || sizeClass < 0 || mPooledBytes + pageSize > kMaxPooledBytes) {
+            return false;
+        }
+        auto page = static_cast<PooledPage*>(buf);
+        page->next = mPages[sizeClass];
+        mPages[sizeClass] = page;
+        mPooledBytes += pageSize;
+        return true;
+    }
+
+    void trim() {
+        for (auto& head : mPages) {
+            while (head) {
+                auto next = head->next;
+                free(head);
+                head = next;
+            }
+        }
+        mPooledBytes = 0;
+    }
+
+    size_t pooledBytes() const { return mPooledBytes; }
+
+private:
+    struct PooledPage {
+        PooledPage* next;
+    };
+    PooledPage* mPages[kPagePoolClassCount] = {};
+    size_t mPooledBytes = 0;
+    bool mDestroyed = false;
+};
+
+thread_local PagePool sPagePool;
+
+}  // namespace
+
 LinearAllocator::LinearAllocator()
         : mPageSize(kInitialPageSize)
         , mMaxAllocSize(kInitialPageSize * MAX_WASTE_RATIO)
@@ -110,7 +181,21 @@ LinearAllocator::~LinearAllocator(void) {
         mDtorList = node->next;
         node->dtor(node->addr);
     }
+    // Regular pages are chained in the order ensureNext() created them, so their sizes follow
+    // the same doubling sequence.
+    size_t pageSize = kInitialPageSize;
     Page* p = mPages;
+    while (p) {
+        Page* next = p->next();
+        p->~Page();
+        if (!sPagePool.release(p, ALIGN(pageSize))) {
+            free(p);
+        }
+        RM_ALLOCATION();
+        pageSize = min(kMaxPageSize, pageSize * 2);
+        p = next;
+    }
+    p = mDedicatedPages;
     while (p) {
         Page* next = p->next();
         p->~Page();
@@ -120,6 +205,10 @@ LinearAllocator::~LinearAllocator(void) {
     }
 }
 
+void LinearAllocator::trimPagePool() {
+    sPagePool.trim();
+}
+
 void* LinearAllocator::start(Page* p) {
     return ALIGN_PTR((size_t)p + sizeof(Page));
 }
@@ -152,16 +241,41 @@ void LinearAllocator::ensureNext(size_t size) {
     mNext = start(mCurrentPage);
 }
 
+void* LinearAllocator::allocFromFreeList(size_t size) {
+    if (size < kMinFreeListSize || size > kMaxFreeListSize || size % kFreeListStep) {
+        return nullptr;
+    }
+    FreeBlock*& head = mFreeLists[(size - kMinFreeListSize) / kFreeListStep];
+    FreeBlock* block = head;
+    if (block) {
+        head = block->next;
+        mFreeListHits++;
+    }
+    return block;
+}
+
+bool LinearAllocator::addToFreeList(void* ptr, size_t size) {
+    if (size < kMinFreeListSize || size > kMaxFreeListSize || size % kFreeListStep) {
+        return false;
+    }
+    FreeBlock*& head = mFreeLists[(size - kMinFreeListSize) / kFreeListStep];
+    head = new (ptr) FreeBlock{head};
+    return true;
+}
+
 void* LinearAllocator::allocImpl(size_t size) {
     size = ALIGN(size);
+    if (void* ptr = allocFromFreeList(size)) {
+        mWastedSpace -= size;
+        return ptr;
+    }
     if (size > mMaxAllocSize && !fitsInCurrentPage(size)) {
         ALOGV("Exceeded max size %zu > %zu", size, mMaxAllocSize);
         // Allocation is too large, create a dedicated page for the allocation
         Page* page = newPage(size);
         mDedicatedPageCount++;
-        page->setNext(mPages);
-        mPages = page;
-        if (!mCurrentPage) mCurrentPage = mPages;
+        page->setNext(mDedicatedPages);
+        mDedicatedPages = page;
         return start(page);
     }
     ensureNext(size);
@@ -213,15 +327,22 @@ void LinearAllocator::rewindIfLastAlloc(void* ptr, size_t allocSize) {
         ptr == ((char*)mNext - allocSize)) {
         mWastedSpace += allocSize;
         mNext = ptr;
+    } else if (addToFreeList(ptr, allocSize)) {
+        mWastedSpace += allocSize;
     }
 }
 
 LinearAllocator::Page* LinearAllocator::newPage(size_t pageSize) {
-    pageSize = ALIGN(pageSize + sizeof(LinearAllocator::Page));
+    const size_t allocSize = ALIGN(pageSize + sizeof(LinearAllocator::Page));
     ADD_ALLOCATION();
-    mTotalAllocated += pageSize;
+    mTotalAllocated += allocSize;
     mPageCount++;
-    void* buf = malloc(pageSize);
+    void* buf = sPagePool.acquire(pageSize);
+    if (buf) {
+        mReusedPageCount++;
+    } else {
+        buf = malloc(allocSize);
+    }
     return new (buf) Page();
 }
 
@@ -246,7 +367,11 @@ void LinearAllocator::dumpMemoryStats(const char* prefix) {
     prettySuffix = toSize(mWastedSpace, prettySize);
     ALOGD("%sWasted space: %.2f%s (%.1f%%)", prefix, prettySize, prettySuffix,
           (float)mWastedSpace / (float)mTotalAllocated * 100.0f);
-    ALOGD("%sPages %zu (dedicated %zu)", prefix, mPageCount, mDedicatedPageCount);
+    ALOGD("%sPages %zu (dedicated %zu, reused %zu)", prefix, mPageCount, mDedicatedPageCount,
+          mReusedPageCount);
+    ALOGD("%sFreelist hits %zu", prefix, mFreeListHits);
+    prettySuffix = toSize(sPagePool.pooledBytes(), prettySize);
+    ALOGD("%sThread page pool: %.2f%s", prefix, prettySize, prettySuffix);
 }
 
 }  // namespace uirenderer
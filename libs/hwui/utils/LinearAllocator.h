@@ -39,6 +39,11 @@ namespace uirenderer {
  * the overhead of malloc when many objects are allocated. It is most useful when creating many
  * small objects with a similar lifetime, and doesn't add significant overhead for large
  * allocations.
+ *
+ * Pages released by a LinearAllocator are kept in a small per-thread pool and handed to the next
+ * LinearAllocator created on that thread, so that re-recording a display list every frame does not
+ * go back to malloc. Small buffers released with rewindIfLastAlloc() that cannot be rewound are
+ * kept on per-size freelists and reused by later allocations of the same size.
  */
 class LinearAllocator {
 public:
@@ -93,7 +98,8 @@ public:
 
     /**
      * Attempt to deallocate the given buffer, with the LinearAllocator attempting to rewind its
-     * state if possible.
+     * state if possible. Small buffers that cannot be rewound are reused by later allocations of
+     * the same size.
      */
     void rewindIfLastAlloc(void* ptr, size_t allocSize);
 
@@ -117,6 +123,18 @@ public:
     size_t usedSize() const { return mTotalAllocated - mWastedSpace; }
     size_t allocatedSize() const { return mTotalAllocated; }
 
+    /**
+     * The number of pages that were taken from the thread's page pool rather than malloc'd, and
+     * the number of allocations served from the freelists.
+     */
+    size_t reusedPageCount() const { return mReusedPageCount; }
+    size_t freeListHits() const { return mFreeListHits; }
+
+    /**
+     * Frees the pages held in the calling thread's page pool.
+     */
+    static void trimPagePool();
+
 private:
     LinearAllocator(const LinearAllocator& other);
 
@@ -127,12 +145,25 @@ private:
         void* addr;
         DestructorNode* next = nullptr;
     };
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    // Buffers of kMinFreeListSize to kMaxFreeListSize bytes, in steps of kFreeListStep, are
+    // kept on freelists when they cannot be rewound.
+    static constexpr size_t kMinFreeListSize = 16;
+    static constexpr size_t kMaxFreeListSize = 128;
+    static constexpr size_t kFreeListStep = 8;
+    static constexpr size_t kFreeListCount =
+            (kMaxFreeListSize - kMinFreeListSize) / kFreeListStep + 1;
 
     void* allocImpl(size_t size);
 
     void addToDestructionList(Destructor, void* addr);
     void runDestructorFor(void* addr);
     Page* newPage(size_t pageSize);
+    void* allocFromFreeList(size_t size);
+    bool addToFreeList(void* ptr, size_t size);
     bool fitsInCurrentPage(size_t size);
     void ensureNext(size_t size);
     void* start(Page* p);
@@ -143,13 +174,17 @@ private:
     void* mNext;
     Page* mCurrentPage;
     Page* mPages;
+    Page* mDedicatedPages = nullptr;
     DestructorNode* mDtorList = nullptr;
+    FreeBlock* mFreeLists[kFreeListCount] = {};
 
     // Memory usage tracking
     size_t mTotalAllocated;
     size_t mWastedSpace;
     size_t mPageCount;
     size_t mDedicatedPageCount;
+    size_t mReusedPageCount = 0;
+    size_t mFreeListHits = 0;
 };
 
 template <class T>
@@ -98,10 +98,25 @@ void MouseCursorController::setPositionLocked(float x, float y) REQUIRES(mLock)
             static_cast<float>(mLocked.viewport.logicalRight - 1),
             static_cast<float>(mLocked.viewport.logicalBottom - 1),
     };
-    mLocked.pointerX = std::max(bounds.left, std::min(bounds.right, x));
-    mLocked.pointerY = std::max(bounds.top, std::min(bounds.bottom, y));
+    const float clampedX = std::max(bounds.left, std::min(bounds.right, x));
+    const float clampedY = std::max(bounds.top, std::min(bounds.bottom, y));
 
-    updatePointerLocked();
+    if (mLocked.updatePointerIcon) {
+        mLocked.pointerX = clampedX;
+        mLocked.pointerY = clampedY;
+        updatePointerLocked();
+        return;
+    }
+
+    // This runs for every motion event of a mouse, so only touch the sprite when the position
+    // actually changes. Every other sprite property is pushed by updatePointerLocked() when it
+    // changes, so the position is all that needs updating here.
+    if (clampedX == mLocked.pointerX && clampedY == mLocked.pointerY) {
+        return;
+    }
+    mLocked.pointerX = clampedX;
+    mLocked.pointerY = clampedY;
+    mLocked.pointerSprite->setPosition(clampedX, clampedY);
 }
 
 FloatPoint MouseCursorController::getPosition() const {
@@ -21,6 +21,7 @@
 
 #include <android-base/logging.h>
 #include <gui/Surface.h>
+#include <string.h>
 #include <utils/String8.h>
 
 namespace android {
@@ -398,12 +399,41 @@ SpriteController::SpriteImpl::~SpriteImpl() {
     }
 }
 
+// Returns true if src has the same size and pixels as dst, which is an RGBA_8888 copy made by
+// setIcon(). Hardware bitmaps can't be read directly, so they are never considered the same.
+static bool hasSamePixels(const graphics::Bitmap& src, const graphics::Bitmap& dst) {
+    const AndroidBitmapInfo srcInfo = src.getInfo();
+    const AndroidBitmapInfo dstInfo = dst.getInfo();
+    if (srcInfo.format != ANDROID_BITMAP_FORMAT_RGBA_8888 || srcInfo.width != dstInfo.width ||
+        srcInfo.height != dstInfo.height) {
+        return false;
+    }
+    const uint8_t* srcPixels = static_cast<const uint8_t*>(src.getPixels());
+    const uint8_t* dstPixels = static_cast<const uint8_t*>(dst.getPixels());
+    if (srcPixels == nullptr || dstPixels == nullptr) {
+        return false;
+    }
+    const size_t rowBytes = srcInfo.width * 4;
+    for (uint32_t y = 0; y < srcInfo.height; y++) {
+        if (memcmp(srcPixels + y * srcInfo.stride, dstPixels + y * dstInfo.stride, rowBytes) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void SpriteController::SpriteImpl::setIcon(const SpriteIcon& icon) {
     AutoMutex _l(mController.mLock);
 
     uint32_t dirty;
     if (icon.isValid()) {
-        mLocked.state.icon.bitmap = icon.bitmap.copy(ANDROID_BITMAP_FORMAT_RGBA_8888);
+        // Setting the icon that is already shown is common, for example when the pointer icon is
+        // re-resolved. Keep the current copy so the surface isn't redrawn for nothing.
+        const bool sameBitmap = mLocked.state.icon.isValid() &&
+                hasSamePixels(icon.bitmap, mLocked.state.icon.bitmap);
+        if (!sameBitmap) {
+            mLocked.state.icon.bitmap = icon.bitmap.copy(ANDROID_BITMAP_FORMAT_RGBA_8888);
+        }
         if (!mLocked.state.icon.isValid() || mLocked.state.icon.hotSpotX != icon.hotSpotX ||
             mLocked.state.icon.hotSpotY != icon.hotSpotY ||
             mLocked.state.icon.drawNativeDropShadow != icon.drawNativeDropShadow) {
@@ -412,13 +442,17 @@ void SpriteController::SpriteImpl::setIcon(const SpriteIcon& icon) {
             mLocked.state.icon.drawNativeDropShadow = icon.drawNativeDropShadow;
             dirty = DIRTY_BITMAP | DIRTY_HOTSPOT | DIRTY_DRAW_DROP_SHADOW;
         } else {
-            dirty = DIRTY_BITMAP;
+            dirty = sameBitmap ? 0 : DIRTY_BITMAP;
         }
 
         if (mLocked.state.icon.style != icon.style) {
             mLocked.state.icon.style = icon.style;
             dirty |= DIRTY_ICON_STYLE;
         }
+
+        if (dirty == 0) {
+            return; // setting to the icon that is already shown so nothing to do
+        }
     } else if (mLocked.state.icon.isValid()) {
         mLocked.state.icon.bitmap.reset();
         dirty = DIRTY_BITMAP | DIRTY_HOTSPOT | DIRTY_ICON_STYLE | DIRTY_DRAW_DROP_SHADOW;
@@ -359,6 +359,30 @@ TEST_F(PointerControllerTest, updatesSkipScreenshotFlagForTouchSpots) {
     testing::Mock::VerifyAndClearExpectations(testSpotSprite.get());
 }
 
+TEST_F(PointerControllerTest, moveOnlyUpdatesSpritePosition) {
+    ensureDisplayViewportIsSet();
+    mPointerController->unfade(PointerController::Transition::IMMEDIATE);
+    mPointerController->setPosition(100, 100);
+    testing::Mock::VerifyAndClearExpectations(mPointerSprite.get());
+
+    EXPECT_CALL(*mPointerSprite, setPosition(110, 110));
+    EXPECT_CALL(*mPointerSprite, setIcon).Times(0);
+    EXPECT_CALL(*mPointerSprite, setVisible).Times(0);
+    EXPECT_CALL(*mPointerSprite, setAlpha).Times(0);
+    EXPECT_CALL(*mPointerSprite, setLayer).Times(0);
+    EXPECT_CALL(*mPointerSprite, setDisplayId).Times(0);
+    EXPECT_CALL(*mPointerSprite, setSkipScreenshot).Times(0);
+    mPointerController->move(10, 10);
+    testing::Mock::VerifyAndClearExpectations(mPointerSprite.get());
+
+    // Pushing against the edge of the display doesn't move the pointer, so the sprite is left
+    // alone.
+    mPointerController->setPosition(0, 0);
+    EXPECT_CALL(*mPointerSprite, setPosition).Times(0);
+    mPointerController->move(-10, -10);
+    testing::Mock::VerifyAndClearExpectations(mPointerSprite.get());
+}
+
 class PointerControllerSkipScreenshotFlagTest
       : public PointerControllerTest,
         public testing::WithParamInterface<PointerControllerInterface::ControllerType> {};
@@ -380,17 +404,13 @@ TEST_P(PointerControllerSkipScreenshotFlagTest, updatesSkipScreenshotFlag) {
     testing::Mock::VerifyAndClearExpectations(testPointerSprite.get());
 
     // Marking the controller to skip screenshot should update pointer sprite
-    mPointerController->setSkipScreenshotFlagForDisplay(ui::LogicalDisplayId::DEFAULT);
     EXPECT_CALL(*testPointerSprite, setSkipScreenshot).With(testing::Args<0>(true));
-
-    // Update pointer to sync state with sprite
-    mPointerController->move(10, 10);
+    mPointerController->setSkipScreenshotFlagForDisplay(ui::LogicalDisplayId::DEFAULT);
     testing::Mock::VerifyAndClearExpectations(testPointerSprite.get());
 
     // Reset flag and verify again
-    mPointerController->clearSkipScreenshotFlags();
     EXPECT_CALL(*testPointerSprite, setSkipScreenshot).With(testing::Args<0>(false));
-    mPointerController->move(10, 10);
+    mPointerController->clearSkipScreenshotFlags();
     testing::Mock::VerifyAndClearExpectations(testPointerSprite.get());
 }
 
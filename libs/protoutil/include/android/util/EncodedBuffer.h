@@ -23,6 +23,7 @@
 #include <utils/RefBase.h>
 
 #include <stdint.h>
+#include <sys/uio.h>
 #include <vector>
 
 namespace android {
@@ -38,6 +39,9 @@ namespace util {
  *      *Pos:       Position in the whole data set (as if it were a single buffer).
  *      *Index:     Index of a buffer within the mBuffers list.
  *      *Offset:    Position within a buffer.
+ *
+ * Buffers of the default chunk size come from a process-wide pool, and go back to it
+ * when the EncodedBuffer is destroyed.
  */
 class EncodedBuffer : public virtual RefBase
 {
@@ -184,6 +188,12 @@ public:
      */
     sp<ProtoReader> read();
 
+    /**
+     * Appends the chunks holding the data written so far to iovecs, in order, so the
+     * whole buffer can be written with writev_fully().
+     */
+    void getIovecs(std::vector<struct iovec>* iovecs) const;
+
 private:
     class Reader;
     friend class Reader;
@@ -216,6 +226,13 @@ private:
     inline uint8_t* at(const Pointer& p) const; // helper function to get value
 };
 
+/**
+ * Writes all of iovecs to fd, with a single writev() call unless there are more than IOV_MAX
+ * of them or the writes come up short. iovecs is used up in the process.
+ * Returns false and sets errno if the write fails.
+ */
+bool writev_fully(int fd, std::vector<struct iovec>* iovecs);
+
 } // util
 } // android
 
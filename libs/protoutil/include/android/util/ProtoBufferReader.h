@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/uio.h>
+
+#include <utility>
+#include <vector>
+
+namespace android {
+namespace util {
+
+/**
+ * Reads protobuf data straight out of memory, for when the data is already there, e.g.
+ * the chunks of an EncodedBuffer (see EncodedBuffer::getIovecs()).
+ *
+ * Unlike ProtoReader, it is neither virtual nor reference counted, decodes varints a word
+ * at a time, and jumps over skipped bytes instead of reading them. It doesn't own the data,
+ * which must outlive it. Reading past the end stops at the end, and makes ok() false.
+ */
+class ProtoBufferReader
+{
+public:
+    ProtoBufferReader(const uint8_t* data, size_t size);
+    explicit ProtoBufferReader(const std::vector<struct iovec>& segments);
+
+    /**
+     * Returns the size of all the data.
+     */
+    size_t size() const { return mSize; }
+
+    /**
+     * Returns the size of total bytes read.
+     */
+    size_t bytesRead() const { return mSegmentStart + (mPos - mBegin); }
+
+    /**
+     * Returns true if next bytes is available for read.
+     */
+    bool hasNext() const { return mPos < mEnd; }
+
+    /**
+     * Returns false if anything was read past the end of the data.
+     */
+    bool ok() const { return mOk; }
+
+    /**
+     * Returns the current position of read pointer, if NULL is returned, it reaches
+     * end of buffer.
+     */
+    uint8_t const* readBuffer() const { return hasNext() ? mPos : NULL; }
+
+    /**
+     * Returns the readable size in the current read buffer.
+     */
+    size_t currentToRead() const { return mEnd - mPos; }
+
+    /**
+     * Reads the current byte and moves pointer 1 byte.
+     */
+    uint8_t next();
+
+    /**
+     * Read varint from the reader, the reader will point to next available byte.
+     */
+    uint64_t readRawVarint();
+
+    /**
+     * Advance the read pointer.
+     */
+    void move(size_t amt);
+
+    /**
+     * Move the read pointer to pos, e.g. to one of the fields of a ProtoFieldIndex.
+     */
+    void seek(size_t pos);
+
+    /**
+     * Moves past the payload of a field whose tag was just read. Returns false if the wire
+     * type is unknown or the field runs past the end of the data.
+     */
+    bool skipField(uint32_t fieldTag);
+
+private:
+    struct Segment {
+        const uint8_t* data;
+        size_t size;
+        size_t start;
+    };
+
+    std::vector<Segment> mSegments;
+    size_t mSegment;        // Index of the segment being read.
+    size_t mSegmentStart;   // Position of mBegin in all the data.
+    const uint8_t* mBegin;
+    const uint8_t* mPos;
+    const uint8_t* mEnd;
+    size_t mSize;
+    bool mOk;
+
+    void enterSegment(size_t index);
+    bool nextSegment();
+    uint64_t readRawVarintSlow();
+};
+
+/**
+ * The fields of a message, by field id, so a message that is looked at more than once
+ * doesn't have to be walked each time.
+ */
+class ProtoFieldIndex
+{
+public:
+    struct Field {
+        uint32_t id;
+        uint8_t wireType;
+        size_t start;   // Position of the field's tag.
+        size_t payload; // Position of the value, past the length of length delimited fields.
+        size_t size;    // Size of the value, not including the length.
+    };
+
+    /**
+     * Indexes the next size bytes read from reader, which must hold whole fields.
+     * Returns false if they don't, in which case the index is left empty.
+     */
+    bool build(ProtoBufferReader* reader, size_t size);
+
+    /**
+     * Returns the range of the fields with the given id, in the order they appear.
+     */
+    std::pair<const Field*, const Field*> find(uint32_t id) const;
+
+    size_t size() const { return mFields.size(); }
+
+private:
+    std::vector<Field> mFields; // Sorted by id, then by start.
+};
+
+// =========================================================================
+inline uint8_t
+ProtoBufferReader::next()
+{
+    if (!hasNext()) {
+        mOk = false;
+        return 0;
+    }
+    uint8_t byte = *mPos++;
+    if (mPos == mEnd) nextSegment();
+    return byte;
+}
+
+inline uint64_t
+ProtoBufferReader::readRawVarint()
+{
+    // Varints of up to 8 bytes are decoded from a single load. Android is little endian.
+    if (mEnd - mPos >= 8) {
+        uint64_t word;
+        memcpy(&word, mPos, sizeof(word));
+        uint64_t stops = ~word & UINT64_C(0x8080808080808080);
+        if (stops != 0) {
+            // Keep the bytes up to and including the first one without the continuation bit.
+            word &= stops ^ (stops - 1);
+            mPos += (__builtin_ctzll(stops) + 1) / 8;
+            if (mPos == mEnd) nextSegment();
+            return (word & UINT64_C(0x7f))
+                    | ((word & UINT64_C(0x7f00)) >> 1)
+                    | ((word & UINT64_C(0x7f0000)) >> 2)
+                    | ((word & UINT64_C(0x7f000000)) >> 3)
+                    | ((word & UINT64_C(0x7f00000000)) >> 4)
+                    | ((word & UINT64_C(0x7f0000000000)) >> 5)
+                    | ((word & UINT64_C(0x7f000000000000)) >> 6)
+                    | ((word & UINT64_C(0x7f00000000000000)) >> 7);
+        }
+    }
+    return readRawVarintSlow();
+}
+
+inline void
+ProtoBufferReader::move(size_t amt)
+{
+    if (amt < (size_t)(mEnd - mPos)) {
+        mPos += amt;
+        return;
+    }
+    amt -= mEnd - mPos;
+    mPos = mEnd;
+    while (nextSegment()) {
+        if (amt < mSegments[mSegment].size) {
+            mPos += amt;
+            return;
+        }
+        amt -= mSegments[mSegment].size;
+        mPos = mEnd;
+    }
+    if (amt > 0) mOk = false;
+}
+
+} // util
+} // android
@@ -113,6 +113,35 @@ public:
     uint64_t start(uint64_t fieldId);
     void end(uint64_t token);
 
+    /**
+     * Starts a sub-message whose encoded size is already known, see sizeOf().
+     * The size is written up front, so the message never needs compaction. Everything
+     * written until end(token) must add up to exactly size bytes, and sub-messages inside
+     * it must be started with their size as well.
+     *
+     * As long as every message is started with its size, the data is written in its final
+     * form and can be flushed out as it goes, see flushWritten().
+     */
+    uint64_t start(uint64_t fieldId, size_t size);
+
+    /**
+     * Returns the encoded size of writing val to the field, for working out the size passed
+     * to start(fieldId, size). Returns 0 if the field type doesn't take val.
+     */
+    static size_t sizeOf(uint64_t fieldId, double val);
+    static size_t sizeOf(uint64_t fieldId, float val);
+    static size_t sizeOf(uint64_t fieldId, int val);
+    static size_t sizeOf(uint64_t fieldId, long val);
+    static size_t sizeOf(uint64_t fieldId, long long val);
+    static size_t sizeOf(uint64_t fieldId, bool val);
+    static size_t sizeOf(uint64_t fieldId, std::string_view val);
+
+    /**
+     * Returns the encoded size of a sub-message whose fields add up to size bytes.
+     * Empty sub-messages are left out, so this is 0 if size is.
+     */
+    static size_t sizeOfMessage(uint64_t fieldId, size_t size);
+
     /**
      * Returns how many bytes are buffered in ProtoOutputStream.
      * Notice, this is not the actual(compact) size of the output data.
@@ -129,6 +158,14 @@ public:
     bool serializeToString(std::string* out); // Serializes the proto to a string.
     bool serializeToVector(std::vector<uint8_t>* out); // Serializes the proto to a vector<uint8_t>.
 
+    /**
+     * Writes the data buffered so far out to fd and drops it, so the buffer can be reused
+     * while more is written. Only possible while no message of unknown size has been started,
+     * see start(fieldId, size). The functions above only cover the data written after the
+     * last flushWritten() call.
+     */
+    bool flushWritten(int fd);
+
     /**
      * Clears the ProtoOutputStream so the buffer can be reused instead of deallocation/allocation again.
      */
@@ -140,8 +177,21 @@ public:
     void writeRawByte(uint8_t byte);
 
 private:
+    /**
+     * A sub-message started with its size.
+     */
+    struct SizedMessage {
+        uint64_t token;
+        uint64_t previousToken;
+        size_t end; // counts the bytes dropped by flushWritten().
+    };
+
     sp<EncodedBuffer> mBuffer;
     size_t mCopyBegin;
+    // Everything written before this position is in its final form.
+    size_t mCompactBegin;
+    size_t mFlushedBytes;
+    std::vector<SizedMessage> mSizedMessages;
     bool mCompact;
     uint32_t mDepth;
     uint32_t mObjectId;
@@ -164,6 +214,9 @@ private:
     inline void writeUtf8StringImpl(uint32_t id, const char* val, size_t size);
     inline void writeMessageBytesImpl(uint32_t id, const char* val, size_t size);
 
+    template<typename T>
+    static size_t internalSizeOf(uint64_t fieldId, T val);
+
     bool compact();
     size_t editEncodedSize(size_t rawSize);
     bool compactSize(size_t rawSize);
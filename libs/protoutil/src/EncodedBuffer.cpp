@@ -15,10 +15,15 @@
  */
 #define LOG_TAG "libprotoutil"
 
+#include <errno.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <sys/mman.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <mutex>
+
 #include <android/util/EncodedBuffer.h>
 #include <android/util/protobuf.h>
 #include <cutils/log.h>
@@ -28,6 +33,50 @@ namespace util {
 
 constexpr size_t BUFFER_SIZE = 8 * 1024; // 8 KB
 const size_t kPageSize = getpagesize();
+const size_t kDefaultChunkSize = (BUFFER_SIZE + (kPageSize - 1)) & ~(kPageSize - 1);
+
+// Up to 512 KB of freed chunks are kept for the next buffers, so a process that keeps
+// writing reports doesn't map and unmap the same memory over and over.
+constexpr size_t MAX_POOLED_CHUNKS = 64;
+
+struct ChunkPool {
+    std::mutex lock;
+    std::vector<uint8_t*> chunks;
+};
+
+// Never destroyed, buffers may still be freed during exit.
+static ChunkPool& chunk_pool() {
+    static ChunkPool* pool = new ChunkPool();
+    return *pool;
+}
+
+static uint8_t* acquire_chunk(size_t chunkSize) {
+    if (chunkSize == kDefaultChunkSize) {
+        ChunkPool& pool = chunk_pool();
+        std::lock_guard<std::mutex> lock(pool.lock);
+        if (!pool.chunks.empty()) {
+            uint8_t* chunk = pool.chunks.back();
+            pool.chunks.pop_back();
+            return chunk;
+        }
+    }
+    // Use mmap instead of malloc to ensure memory alignment i.e. no fragmentation so that
+    // the mem region can be immediately reused by the allocator after calling munmap()
+    void* chunk = mmap(NULL, chunkSize, PROT_READ | PROT_WRITE, MAP_ANONYMOUS|MAP_PRIVATE, -1, 0);
+    return chunk == MAP_FAILED ? NULL : (uint8_t*)chunk;
+}
+
+static void release_chunk(uint8_t* chunk, size_t chunkSize) {
+    if (chunkSize == kDefaultChunkSize) {
+        ChunkPool& pool = chunk_pool();
+        std::lock_guard<std::mutex> lock(pool.lock);
+        if (pool.chunks.size() < MAX_POOLED_CHUNKS) {
+            pool.chunks.push_back(chunk);
+            return;
+        }
+    }
+    munmap(chunk, chunkSize);
+}
 
 EncodedBuffer::Pointer::Pointer() : Pointer(BUFFER_SIZE)
 {
@@ -102,8 +151,7 @@ EncodedBuffer::EncodedBuffer(size_t chunkSize)
 EncodedBuffer::~EncodedBuffer()
 {
     for (size_t i=0; i<mBuffers.size(); i++) {
-        uint8_t* buf = mBuffers[i];
-        munmap(buf, mChunkSize);
+        release_chunk(mBuffers[i], mChunkSize);
     }
 }
 
@@ -140,10 +188,7 @@ EncodedBuffer::writeBuffer()
     if (mWp.index() > mBuffers.size()) return NULL;
     uint8_t* buf = NULL;
     if (mWp.index() == mBuffers.size()) {
-        // Use mmap instead of malloc to ensure memory alignment i.e. no fragmentation so that
-        // the mem region can be immediately reused by the allocator after calling munmap()
-        buf = (uint8_t*)mmap(NULL, mChunkSize, PROT_READ | PROT_WRITE,
-                MAP_ANONYMOUS|MAP_PRIVATE, -1, 0);
+        buf = acquire_chunk(mChunkSize);
 
         if (buf == NULL) return NULL; // This indicates NO_MEMORY
 
@@ -354,6 +399,46 @@ EncodedBuffer::read()
     return new EncodedBuffer::Reader(this);
 }
 
+void
+EncodedBuffer::getIovecs(std::vector<struct iovec>* iovecs) const
+{
+    for (size_t i = 0; i < mBuffers.size() && i <= mWp.index(); i++) {
+        size_t size = i < mWp.index() ? mChunkSize : mWp.offset();
+        if (size > 0) {
+            iovecs->push_back({mBuffers[i], size});
+        }
+    }
+}
+
+bool
+writev_fully(int fd, std::vector<struct iovec>* iovecs)
+{
+    struct iovec* iov = iovecs->data();
+    size_t count = iovecs->size();
+    while (count > 0) {
+        ssize_t written = writev(fd, iov, std::min(count, (size_t)IOV_MAX));
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (written == 0) {
+            errno = EIO;
+            return false;
+        }
+        // skip what was written, and trim the iovec that was written in part.
+        while (count > 0 && (size_t)written >= iov->iov_len) {
+            written -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (written > 0) {
+            iov->iov_base = (uint8_t*)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+    return true;
+}
+
 EncodedBuffer::Reader::Reader(const sp<EncodedBuffer>& buffer)
         :mData(buffer),
          mRp(buffer->mChunkSize)
@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <android/util/ProtoBufferReader.h>
+#include <android/util/protobuf.h>
+
+#include <algorithm>
+
+namespace android {
+namespace util {
+
+ProtoBufferReader::ProtoBufferReader(const uint8_t* data, size_t size)
+        :ProtoBufferReader(std::vector<struct iovec>{{const_cast<uint8_t*>(data), size}})
+{
+}
+
+ProtoBufferReader::ProtoBufferReader(const std::vector<struct iovec>& segments)
+        :mSegments(),
+         mSegment(0),
+         mSegmentStart(0),
+         mBegin(NULL),
+         mPos(NULL),
+         mEnd(NULL),
+         mSize(0),
+         mOk(true)
+{
+    for (const struct iovec& segment : segments) {
+        if (segment.iov_len > 0) {
+            mSegments.push_back({(const uint8_t*)segment.iov_base, segment.iov_len, mSize});
+            mSize += segment.iov_len;
+        }
+    }
+    if (!mSegments.empty()) {
+        enterSegment(0);
+    }
+}
+
+void
+ProtoBufferReader::enterSegment(size_t index)
+{
+    const Segment& segment = mSegments[index];
+    mSegment = index;
+    mSegmentStart = segment.start;
+    mBegin = mPos = segment.data;
+    mEnd = segment.data + segment.size;
+}
+
+bool
+ProtoBufferReader::nextSegment()
+{
+    if (mSegment + 1 >= mSegments.size()) {
+        return false;
+    }
+    enterSegment(mSegment + 1);
+    return true;
+}
+
+void
+ProtoBufferReader::seek(size_t pos)
+{
+    if (pos >= mSize) {
+        if (pos > mSize) mOk = false;
+        if (!mSegments.empty()) {
+            enterSegment(mSegments.size() - 1);
+            mPos = mEnd;
+        }
+        return;
+    }
+    // the last segment that starts at or before pos.
+    auto segment = std::upper_bound(mSegments.begin(), mSegments.end(), pos,
+            [](size_t p, const Segment& s) { return p < s.start; }) - 1;
+    enterSegment(segment - mSegments.begin());
+    mPos += pos - segment->start;
+}
+
+uint64_t
+ProtoBufferReader::readRawVarintSlow()
+{
+    uint64_t val = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (!hasNext()) {
+            mOk = false;
+            return val;
+        }
+        uint8_t byte = next();
+        val |= (UINT64_C(0x7F) & byte) << shift;
+        if ((byte & 0x80) == 0) {
+            return val;
+        }
+    }
+    // more than 10 bytes.
+    mOk = false;
+    return val;
+}
+
+bool
+ProtoBufferReader::skipField(uint32_t fieldTag)
+{
+    switch (read_wire_type(fieldTag)) {
+        case WIRE_TYPE_VARINT:
+            readRawVarint();
+            break;
+        case WIRE_TYPE_FIXED64:
+            move(8);
+            break;
+        case WIRE_TYPE_LENGTH_DELIMITED:
+            move(readRawVarint());
+            break;
+        case WIRE_TYPE_FIXED32:
+            move(4);
+            break;
+        default:
+            return false;
+    }
+    return mOk;
+}
+
+// =========================================================================
+namespace {
+
+struct IdCompare {
+    bool operator()(const ProtoFieldIndex::Field& field, uint32_t id) const {
+        return field.id < id;
+    }
+    bool operator()(uint32_t id, const ProtoFieldIndex::Field& field) const {
+        return id < field.id;
+    }
+};
+
+} // namespace
+
+bool
+ProtoFieldIndex::build(ProtoBufferReader* reader, size_t size)
+{
+    mFields.clear();
+    const size_t end = reader->bytesRead() + size;
+    while (reader->ok() && reader->bytesRead() < end) {
+        Field field;
+        field.start = reader->bytesRead();
+        uint32_t tag = (uint32_t)reader->readRawVarint();
+        field.id = read_field_id(tag);
+        field.wireType = read_wire_type(tag);
+        if (field.wireType == WIRE_TYPE_LENGTH_DELIMITED) {
+            field.size = reader->readRawVarint();
+            field.payload = reader->bytesRead();
+            reader->move(field.size);
+        } else {
+            field.payload = reader->bytesRead();
+            if (!reader->skipField(tag)) {
+                break;
+            }
+            field.size = reader->bytesRead() - field.payload;
+        }
+        mFields.push_back(field);
+    }
+    if (!reader->ok() || reader->bytesRead() != end) {
+        mFields.clear();
+        return false;
+    }
+    std::stable_sort(mFields.begin(), mFields.end(),
+            [](const Field& a, const Field& b) { return a.id < b.id; });
+    return true;
+}
+
+std::pair<const ProtoFieldIndex::Field*, const ProtoFieldIndex::Field*>
+ProtoFieldIndex::find(uint32_t id) const
+{
+    auto range = std::equal_range(mFields.begin(), mFields.end(), id, IdCompare());
+    return {mFields.data() + (range.first - mFields.begin()),
+            mFields.data() + (range.second - mFields.begin())};
+}
+
+} // util
+} // android
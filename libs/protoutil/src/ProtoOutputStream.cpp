@@ -18,7 +18,6 @@
 #include <cinttypes>
 #include <type_traits>
 
-#include <android-base/file.h>
 #include <android/util/protobuf.h>
 #include <android/util/ProtoOutputStream.h>
 #include <cutils/log.h>
@@ -26,6 +25,11 @@
 namespace android {
 namespace util {
 
+/**
+ * Value of mCompactBegin when nothing written needs compaction.
+ */
+static const size_t NOTHING_TO_COMPACT = SIZE_MAX;
+
 ProtoOutputStream::ProtoOutputStream(): ProtoOutputStream(new EncodedBuffer())
 {
 }
@@ -33,6 +37,10 @@ ProtoOutputStream::ProtoOutputStream(): ProtoOutputStream(new EncodedBuffer())
 ProtoOutputStream::ProtoOutputStream(sp<EncodedBuffer> buffer)
         :mBuffer(buffer),
          mCopyBegin(0),
+         // Whatever the buffer already holds is compacted along with the rest.
+         mCompactBegin(buffer->size() == 0 ? NOTHING_TO_COMPACT : 0),
+         mFlushedBytes(0),
+         mSizedMessages(),
          mCompact(false),
          mDepth(0),
          mObjectId(0),
@@ -50,6 +58,9 @@ ProtoOutputStream::clear()
 {
     mBuffer->clear();
     mCopyBegin = 0;
+    mCompactBegin = NOTHING_TO_COMPACT;
+    mFlushedBytes = 0;
+    mSizedMessages.clear();
     mCompact = false;
     mDepth = 0;
     mObjectId = 0;
@@ -206,6 +217,103 @@ ProtoOutputStream::write(uint64_t fieldId, const char* val, size_t size)
     }
 }
 
+template<typename T>
+size_t
+ProtoOutputStream::internalSizeOf(uint64_t fieldId, T val)
+{
+    const size_t tagSize = get_varint_size((uint64_t)(uint32_t)fieldId << FIELD_ID_SHIFT);
+    switch (fieldId & FIELD_TYPE_MASK) {
+        case FIELD_TYPE_DOUBLE:
+        case FIELD_TYPE_FIXED64:
+        case FIELD_TYPE_SFIXED64:
+            return tagSize + 8;
+        case FIELD_TYPE_FLOAT:
+        case FIELD_TYPE_FIXED32:
+        case FIELD_TYPE_SFIXED32:
+            return tagSize + 4;
+        case FIELD_TYPE_INT64:
+        case FIELD_TYPE_UINT64:
+            return tagSize + get_varint_size((uint64_t)(int64_t)val);
+        // 32 bits varints are written as uint32_t, so negative values take 5 bytes.
+        case FIELD_TYPE_INT32:
+            return tagSize + get_varint_size((uint32_t)(int32_t)val);
+        case FIELD_TYPE_UINT32:
+            return tagSize + get_varint_size((uint32_t)val);
+        case FIELD_TYPE_SINT32: {
+            int32_t v = (int32_t)val;
+            return tagSize + get_varint_size((uint32_t)((v << 1) ^ (v >> 31)));
+        }
+        case FIELD_TYPE_SINT64: {
+            int64_t v = (int64_t)val;
+            return tagSize + get_varint_size((uint64_t)((v << 1) ^ (v >> 63)));
+        }
+        case FIELD_TYPE_ENUM:
+            return std::is_integral<T>::value ? tagSize + get_varint_size((uint32_t)(int)val) : 0;
+        case FIELD_TYPE_BOOL:
+            return std::is_integral<T>::value ? tagSize + 1 : 0;
+        default:
+            return 0;
+    }
+}
+
+size_t
+ProtoOutputStream::sizeOf(uint64_t fieldId, double val)
+{
+    return internalSizeOf(fieldId, val);
+}
+
+size_t
+ProtoOutputStream::sizeOf(uint64_t fieldId, float val)
+{
+    return internalSizeOf(fieldId, val);
+}
+
+size_t
+ProtoOutputStream::sizeOf(uint64_t fieldId, int val)
+{
+    return internalSizeOf(fieldId, val);
+}
+
+size_t
+ProtoOutputStream::sizeOf(uint64_t fieldId, long val)
+{
+    return internalSizeOf(fieldId, val);
+}
+
+size_t
+ProtoOutputStream::sizeOf(uint64_t fieldId, long long val)
+{
+    return internalSizeOf(fieldId, val);
+}
+
+size_t
+ProtoOutputStream::sizeOf(uint64_t fieldId, bool val)
+{
+    return (fieldId & FIELD_TYPE_MASK) == FIELD_TYPE_BOOL ? internalSizeOf(fieldId, val) : 0;
+}
+
+size_t
+ProtoOutputStream::sizeOf(uint64_t fieldId, std::string_view val)
+{
+    switch (fieldId & FIELD_TYPE_MASK) {
+        case FIELD_TYPE_STRING:
+        case FIELD_TYPE_BYTES:
+        case FIELD_TYPE_MESSAGE:
+            return get_varint_size((uint64_t)(uint32_t)fieldId << FIELD_ID_SHIFT)
+                    + get_varint_size(val.size()) + val.size();
+        default:
+            return 0;
+    }
+}
+
+size_t
+ProtoOutputStream::sizeOfMessage(uint64_t fieldId, size_t size)
+{
+    if (size == 0) return 0;
+    return get_varint_size((uint64_t)(uint32_t)fieldId << FIELD_ID_SHIFT)
+            + get_varint_size(size) + size;
+}
+
 /**
  * Make a token.
  *  Bits 61-63 - tag size (So we can go backwards later if the object had not data)
@@ -257,8 +365,17 @@ ProtoOutputStream::start(uint64_t fieldId)
         return 0;
     }
 
+    if (!mSizedMessages.empty()) {
+        ALOGE("Can't start a message of unknown size inside one of known size: 0x%" PRIx64,
+                fieldId);
+        return 0;
+    }
+
     uint32_t id = (uint32_t)fieldId;
     size_t prevPos = mBuffer->wp()->pos();
+    if (mCompactBegin == NOTHING_TO_COMPACT) {
+        mCompactBegin = prevPos;
+    }
     mBuffer->writeHeader(id, WIRE_TYPE_LENGTH_DELIMITED);
     size_t sizePos = mBuffer->wp()->pos();
 
@@ -271,6 +388,30 @@ ProtoOutputStream::start(uint64_t fieldId)
     return mExpectedObjectToken;
 }
 
+uint64_t
+ProtoOutputStream::start(uint64_t fieldId, size_t size)
+{
+    if ((fieldId & FIELD_TYPE_MASK) != FIELD_TYPE_MESSAGE) {
+        ALOGE("Can't call start for non-message type field: 0x%" PRIx64, fieldId);
+        return 0;
+    }
+
+    // Like end() does for messages of unknown size, empty messages are left out.
+    size_t prevPos = mBuffer->wp()->pos();
+    if (size > 0) {
+        writeLengthDelimitedHeader((uint32_t)fieldId, size);
+    }
+    size_t sizePos = mBuffer->wp()->pos();
+
+    mDepth++;
+    mObjectId++;
+    uint64_t token = makeToken(sizePos - prevPos, (bool)(fieldId & FIELD_COUNT_REPEATED),
+            mDepth, mObjectId, sizePos);
+    mSizedMessages.push_back({token, mExpectedObjectToken, mFlushedBytes + sizePos + size});
+    mExpectedObjectToken = token;
+    return token;
+}
+
 void
 ProtoOutputStream::end(uint64_t token)
 {
@@ -288,6 +429,19 @@ ProtoOutputStream::end(uint64_t token)
     }
     mDepth--;
 
+    if (!mSizedMessages.empty() && mSizedMessages.back().token == token) {
+        const SizedMessage& message = mSizedMessages.back();
+        size_t end = mFlushedBytes + mBuffer->wp()->pos();
+        if (end != message.end) {
+            ALOGE("Message of known size ended %zd bytes off", (ssize_t)(end - message.end));
+            mDepth = UINT32_C(-1); // make depth invalid
+            return;
+        }
+        mExpectedObjectToken = message.previousToken;
+        mSizedMessages.pop_back();
+        return;
+    }
+
     uint32_t sizePos = getSizePosFromToken(token);
     // number of bytes written in this start-end session.
     int childRawSize = mBuffer->wp()->pos() - sizePos - 8;
@@ -303,6 +457,9 @@ ProtoOutputStream::end(uint64_t token)
     } else {
         // reset wp which erase the header tag of the message when its size is 0.
         mBuffer->wp()->rewind()->move(sizePos - getTagSizeFromToken(token));
+        if (mBuffer->wp()->pos() == mCompactBegin) {
+            mCompactBegin = NOTHING_TO_COMPACT;
+        }
     }
 }
 
@@ -322,18 +479,24 @@ ProtoOutputStream::compact() {
     // record the size of the original buffer.
     size_t rawBufferSize = mBuffer->size();
     if (rawBufferSize == 0) return true; // nothing to do if the buffer is empty;
+    if (mCompactBegin >= rawBufferSize) {
+        // all messages were started with their sizes, the data is already final.
+        mCompact = true;
+        return true;
+    }
 
     // reset edit pointer and recursively compute encoded size of messages.
-    mBuffer->ep()->rewind();
-    if (editEncodedSize(rawBufferSize) == 0) {
+    mBuffer->ep()->rewind()->move(mCompactBegin);
+    if (editEncodedSize(rawBufferSize - mCompactBegin) == 0) {
         ALOGE("Failed to editEncodedSize.");
         return false;
     }
 
     // reset both edit pointer and write pointer, and compact recursively.
-    mBuffer->ep()->rewind();
-    mBuffer->wp()->rewind();
-    if (!compactSize(rawBufferSize)) {
+    mBuffer->ep()->rewind()->move(mCompactBegin);
+    mBuffer->wp()->rewind()->move(mCompactBegin);
+    mCopyBegin = mCompactBegin;
+    if (!compactSize(rawBufferSize - mCompactBegin)) {
         ALOGE("Failed to compactSize.");
         return false;
     }
@@ -470,13 +633,30 @@ ProtoOutputStream::flush(int fd)
     if (fd < 0) return false;
     if (!compact()) return false;
 
-    sp<ProtoReader> reader = mBuffer->read();
-    while (reader->readBuffer() != NULL) {
-        if (!android::base::WriteFully(fd, reader->readBuffer(), reader->currentToRead())) {
-            return false;
-        }
-        reader->move(reader->currentToRead());
+    std::vector<struct iovec> iovecs;
+    mBuffer->getIovecs(&iovecs);
+    if (!writev_fully(fd, &iovecs)) {
+        return false;
+    }
+    return true;
+}
+
+bool
+ProtoOutputStream::flushWritten(int fd)
+{
+    if (fd < 0 || mCompact) return false;
+    if (mCompactBegin != NOTHING_TO_COMPACT) {
+        ALOGE("Can't flush before compaction, a message of unknown size was started.");
+        return false;
     }
+
+    std::vector<struct iovec> iovecs;
+    mBuffer->getIovecs(&iovecs);
+    if (!writev_fully(fd, &iovecs)) {
+        return false;
+    }
+    mFlushedBytes += mBuffer->size();
+    mBuffer->clear();
     return true;
 }
 
@@ -533,6 +713,11 @@ void
 ProtoOutputStream::writeLengthDelimitedHeader(uint32_t id, size_t size)
 {
     mBuffer->writeHeader(id, WIRE_TYPE_LENGTH_DELIMITED);
+    if (mCompactBegin == NOTHING_TO_COMPACT || !mSizedMessages.empty()) {
+        // compaction never looks at this, the size can be written in its final form.
+        mBuffer->writeRawVarint64(size);
+        return;
+    }
     // reserves 64 bits for length delimited fields, if first field is negative, compact it.
     mBuffer->writeRawFixed32(size);
     mBuffer->writeRawFixed32(size);
@@ -154,3 +154,28 @@ TEST(EncodedBufferTest, ReadVarint) {
     EXPECT_EQ(reader->size(), len);
     EXPECT_EQ(reader->readRawVarint(), val);
 }
+
+TEST(EncodedBufferTest, GetIovecs) {
+    sp<EncodedBuffer> buffer = new EncodedBuffer(TEST_CHUNK_SIZE);
+    std::vector<struct iovec> iovecs;
+    buffer->getIovecs(&iovecs);
+    EXPECT_TRUE(iovecs.empty());
+
+    for (size_t i = 0; i < TEST_CHUNK_SIZE + TEST_CHUNK_HALF_SIZE; i++) {
+        buffer->writeRawByte(static_cast<uint8_t>(i));
+    }
+    buffer->getIovecs(&iovecs);
+    ASSERT_EQ(iovecs.size(), 2UL);
+    EXPECT_EQ(iovecs[0].iov_len, TEST_CHUNK_SIZE);
+    EXPECT_EQ(iovecs[1].iov_len, TEST_CHUNK_HALF_SIZE);
+    EXPECT_EQ(static_cast<uint8_t*>(iovecs[1].iov_base)[0],
+            static_cast<uint8_t>(TEST_CHUNK_SIZE));
+
+    // a chunk that was written before clear() is not part of the data.
+    buffer->clear();
+    buffer->writeRawByte(7);
+    iovecs.clear();
+    buffer->getIovecs(&iovecs);
+    ASSERT_EQ(iovecs.size(), 1UL);
+    EXPECT_EQ(iovecs[0].iov_len, 1UL);
+}
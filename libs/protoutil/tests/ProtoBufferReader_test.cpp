@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <android/util/ProtoBufferReader.h>
+#include <android/util/protobuf.h>
+#include <gtest/gtest.h>
+
+using namespace android::util;
+
+static std::vector<uint8_t> encodeVarints(const std::vector<uint64_t>& values) {
+    std::vector<uint8_t> data;
+    for (uint64_t value : values) {
+        uint8_t buf[10];
+        uint8_t* end = write_raw_varint(buf, value);
+        data.insert(data.end(), buf, end);
+    }
+    return data;
+}
+
+static const std::vector<uint64_t> kVarints = {
+    0, 1, 127, 128, 300, UINT64_C(0xffffffff), UINT64_C(1) << 55, UINT64_C(1) << 56,
+    UINT64_C(-1), 5, 16384, 3,
+};
+
+TEST(ProtoBufferReaderTest, ReadVarints) {
+    std::vector<uint8_t> data = encodeVarints(kVarints);
+    ProtoBufferReader reader(data.data(), data.size());
+    for (uint64_t value : kVarints) {
+        EXPECT_EQ(reader.readRawVarint(), value);
+    }
+    EXPECT_FALSE(reader.hasNext());
+    EXPECT_EQ(reader.bytesRead(), data.size());
+    EXPECT_TRUE(reader.ok());
+
+    reader.readRawVarint();
+    EXPECT_FALSE(reader.ok());
+}
+
+TEST(ProtoBufferReaderTest, ReadVarintsAcrossSegments) {
+    std::vector<uint8_t> data = encodeVarints(kVarints);
+    // every split of the data in two, and single bytes.
+    for (size_t split = 0; split <= data.size(); split++) {
+        ProtoBufferReader reader({{data.data(), split},
+                                  {data.data() + split, data.size() - split}});
+        for (uint64_t value : kVarints) {
+            EXPECT_EQ(reader.readRawVarint(), value) << "split at " << split;
+        }
+        EXPECT_TRUE(reader.ok());
+    }
+    std::vector<struct iovec> bytes;
+    for (uint8_t& byte : data) {
+        bytes.push_back({&byte, 1});
+    }
+    ProtoBufferReader reader(bytes);
+    for (uint64_t value : kVarints) {
+        EXPECT_EQ(reader.readRawVarint(), value);
+    }
+    EXPECT_EQ(reader.bytesRead(), data.size());
+}
+
+TEST(ProtoBufferReaderTest, MoveAndSeek) {
+    uint8_t data[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    ProtoBufferReader reader({{data, 3}, {data + 3, 0}, {data + 3, 4}, {data + 7, 3}});
+    EXPECT_EQ(reader.size(), 10UL);
+    reader.move(5);
+    EXPECT_EQ(reader.bytesRead(), 5UL);
+    EXPECT_EQ(reader.next(), 5);
+    EXPECT_EQ(reader.currentToRead(), 1UL);
+    reader.seek(2);
+    EXPECT_EQ(*reader.readBuffer(), 2);
+    reader.seek(9);
+    EXPECT_EQ(reader.next(), 9);
+    EXPECT_FALSE(reader.hasNext());
+    EXPECT_EQ(reader.readBuffer(), nullptr);
+    EXPECT_TRUE(reader.ok());
+
+    reader.seek(0);
+    reader.move(11);
+    EXPECT_FALSE(reader.ok());
+    EXPECT_EQ(reader.bytesRead(), 10UL);
+}
+
+TEST(ProtoBufferReaderTest, FieldIndex) {
+    // 1: varint 150, 2: "ab", 1: varint 3, 5: fixed32, 1: fixed64
+    uint8_t data[] = {
+        0x08, 0x96, 0x01,
+        0x12, 0x02, 'a', 'b',
+        0x08, 0x03,
+        0x2d, 0x01, 0x02, 0x03, 0x04,
+        0x09, 1, 2, 3, 4, 5, 6, 7, 8,
+    };
+    ProtoBufferReader reader(data, sizeof(data));
+    ProtoFieldIndex index;
+    ASSERT_TRUE(index.build(&reader, sizeof(data)));
+    EXPECT_EQ(index.size(), 5UL);
+
+    auto ones = index.find(1);
+    ASSERT_EQ(ones.second - ones.first, 3);
+    EXPECT_EQ(ones.first[0].start, 0UL);
+    EXPECT_EQ(ones.first[1].start, 7UL);
+    EXPECT_EQ(ones.first[2].wireType, WIRE_TYPE_FIXED64);
+    EXPECT_EQ(ones.first[2].size, 8UL);
+    reader.seek(ones.first[1].payload);
+    EXPECT_EQ(reader.readRawVarint(), 3UL);
+
+    auto twos = index.find(2);
+    ASSERT_EQ(twos.second - twos.first, 1);
+    EXPECT_EQ(twos.first->payload, 5UL);
+    EXPECT_EQ(twos.first->size, 2UL);
+
+    auto threes = index.find(3);
+    EXPECT_EQ(threes.first, threes.second);
+
+    // the string runs past the end.
+    ProtoBufferReader truncated(data, 6);
+    EXPECT_FALSE(index.build(&truncated, 6));
+    EXPECT_EQ(index.size(), 0UL);
+}
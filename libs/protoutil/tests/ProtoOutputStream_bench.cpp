@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <android/util/ProtoOutputStream.h>
+#include <benchmark/benchmark.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "frameworks/base/libs/protoutil/tests/test.pb.h"
+
+using namespace android::util;
+
+static const uint64_t kLogs = FIELD_TYPE_MESSAGE | ComplexProto::kLogsFieldNumber;
+static const uint64_t kId = FIELD_TYPE_INT32 | ComplexProto::Log::kIdFieldNumber;
+static const uint64_t kName = FIELD_TYPE_STRING | ComplexProto::Log::kNameFieldNumber;
+static const std::string kLogName = "com.android.server.am.ActivityManagerService";
+
+// Nests the logs depth deep through the data field, which has the same encoding as a message.
+static const uint64_t kNested = FIELD_TYPE_MESSAGE | ComplexProto::Log::kDataFieldNumber;
+
+static size_t logSize(int depth) {
+    size_t size = ProtoOutputStream::sizeOf(kId, depth)
+            + ProtoOutputStream::sizeOf(kName, std::string_view(kLogName));
+    if (depth > 0) {
+        size += ProtoOutputStream::sizeOfMessage(kNested, logSize(depth - 1));
+    }
+    return size;
+}
+
+static void writeLog(ProtoOutputStream* proto, uint64_t fieldId, int depth,
+        const size_t* sizes) {
+    uint64_t token = sizes != nullptr ? proto->start(fieldId, sizes[depth])
+            : proto->start(fieldId);
+    proto->write(kId, depth);
+    proto->write(kName, std::string_view(kLogName));
+    if (depth > 0) {
+        writeLog(proto, kNested, depth - 1, sizes);
+    }
+    proto->end(token);
+}
+
+static void BM_WriteNestedLogs(benchmark::State& state, bool knownSizes) {
+    const int count = state.range(0);
+    const int depth = state.range(1);
+    std::vector<size_t> sizes;
+    for (int i = 0; i <= depth; i++) {
+        sizes.push_back(logSize(i));
+    }
+
+    ProtoOutputStream proto;
+    for (auto _ : state) {
+        proto.clear();
+        for (int i = 0; i < count; i++) {
+            writeLog(&proto, kLogs, depth, knownSizes ? sizes.data() : nullptr);
+        }
+        benchmark::DoNotOptimize(proto.size());
+    }
+    state.SetBytesProcessed(state.iterations() * proto.size());
+}
+BENCHMARK_CAPTURE(BM_WriteNestedLogs, Compact, false)->ArgsProduct({{100, 10000}, {1, 8}});
+BENCHMARK_CAPTURE(BM_WriteNestedLogs, KnownSizes, true)->ArgsProduct({{100, 10000}, {1, 8}});
+
+static void BM_FlushNestedLogs(benchmark::State& state, bool streamed) {
+    const int count = state.range(0);
+    const int depth = state.range(1);
+    std::vector<size_t> sizes;
+    for (int i = 0; i <= depth; i++) {
+        sizes.push_back(logSize(i));
+    }
+    int fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+
+    ProtoOutputStream proto;
+    for (auto _ : state) {
+        proto.clear();
+        for (int i = 0; i < count; i++) {
+            writeLog(&proto, kLogs, depth, streamed ? sizes.data() : nullptr);
+            if (streamed && i % 64 == 63) {
+                proto.flushWritten(fd);
+            }
+        }
+        proto.flush(fd);
+    }
+    close(fd);
+}
+BENCHMARK_CAPTURE(BM_FlushNestedLogs, Compact, false)->ArgsProduct({{100, 10000}, {1, 8}});
+BENCHMARK_CAPTURE(BM_FlushNestedLogs, Streamed, true)->ArgsProduct({{100, 10000}, {1, 8}});
+
+BENCHMARK_MAIN();
@@ -356,3 +356,113 @@ TEST(ProtoOutputStreamTest, NoStartCalled) {
     EXPECT_EQ(proto.size(), 0);
     EXPECT_FALSE(proto.flush(STDOUT_FILENO));
 }
+
+static size_t logSize(int id, const std::string& name) {
+    return ProtoOutputStream::sizeOf(FIELD_TYPE_INT32 | ComplexProto::Log::kIdFieldNumber, id)
+            + ProtoOutputStream::sizeOf(FIELD_TYPE_STRING | ComplexProto::Log::kNameFieldNumber,
+                    std::string_view(name));
+}
+
+TEST(ProtoOutputStreamTest, KnownSizes) {
+    std::string name1 = "cat";
+    std::string name2 = "dog";
+
+    ProtoOutputStream proto;
+    EXPECT_TRUE(proto.write(FIELD_TYPE_INT32 | ComplexProto::kIntsFieldNumber, -72));
+    uint64_t token1 = proto.start(FIELD_TYPE_MESSAGE | ComplexProto::kLogsFieldNumber,
+            logSize(-12, name1));
+    EXPECT_TRUE(proto.write(FIELD_TYPE_INT32 | ComplexProto::Log::kIdFieldNumber, -12));
+    EXPECT_TRUE(proto.write(FIELD_TYPE_STRING | ComplexProto::Log::kNameFieldNumber, name1));
+    proto.end(token1);
+    uint64_t token2 = proto.start(FIELD_TYPE_MESSAGE | ComplexProto::kLogsFieldNumber,
+            logSize(98, name2));
+    EXPECT_TRUE(proto.write(FIELD_TYPE_INT32 | ComplexProto::Log::kIdFieldNumber, 98));
+    EXPECT_TRUE(proto.write(FIELD_TYPE_STRING | ComplexProto::Log::kNameFieldNumber, name2));
+    proto.end(token2);
+    // Nothing is left to compact.
+    EXPECT_EQ(proto.bytesWritten(), proto.size());
+
+    ComplexProto complex;
+    ASSERT_TRUE(complex.ParseFromString(flushToString(&proto)));
+    EXPECT_EQ(complex.ints_size(), 1);
+    EXPECT_EQ(complex.ints(0), -72);
+    EXPECT_EQ(complex.logs_size(), 2);
+    EXPECT_EQ(complex.logs(0).id(), -12);
+    EXPECT_THAT(complex.logs(0).name(), StrEq(name1.c_str()));
+    EXPECT_EQ(complex.logs(1).id(), 98);
+    EXPECT_THAT(complex.logs(1).name(), StrEq(name2.c_str()));
+}
+
+TEST(ProtoOutputStreamTest, KnownSizesInsideUnknownSize) {
+    std::string name = "bird";
+
+    ProtoOutputStream proto;
+    uint64_t token1 = proto.start(FIELD_TYPE_MESSAGE | ComplexProto::kLogsFieldNumber);
+    EXPECT_TRUE(proto.write(FIELD_TYPE_INT32 | ComplexProto::Log::kIdFieldNumber, 7));
+    proto.end(token1);
+    uint64_t token2 = proto.start(FIELD_TYPE_MESSAGE | ComplexProto::kLogsFieldNumber,
+            logSize(3, name));
+    EXPECT_TRUE(proto.write(FIELD_TYPE_INT32 | ComplexProto::Log::kIdFieldNumber, 3));
+    EXPECT_TRUE(proto.write(FIELD_TYPE_STRING | ComplexProto::Log::kNameFieldNumber, name));
+    proto.end(token2);
+    // A message of unknown size can't be nested in one of known size.
+    uint64_t token3 = proto.start(FIELD_TYPE_MESSAGE | ComplexProto::kLogsFieldNumber, 2);
+    EXPECT_EQ(proto.start(FIELD_TYPE_MESSAGE | ComplexProto::kLogsFieldNumber), 0);
+    EXPECT_TRUE(proto.write(FIELD_TYPE_INT32 | ComplexProto::Log::kIdFieldNumber, 9));
+    proto.end(token3);
+
+    ComplexProto complex;
+    ASSERT_TRUE(complex.ParseFromString(iterateToString(&proto)));
+    EXPECT_EQ(complex.logs_size(), 3);
+    EXPECT_EQ(complex.logs(0).id(), 7);
+    EXPECT_EQ(complex.logs(1).id(), 3);
+    EXPECT_THAT(complex.logs(1).name(), StrEq(name.c_str()));
+    EXPECT_EQ(complex.logs(2).id(), 9);
+}
+
+TEST(ProtoOutputStreamTest, WrongKnownSize) {
+    ProtoOutputStream proto;
+    uint64_t token = proto.start(FIELD_TYPE_MESSAGE | ComplexProto::kLogsFieldNumber, 3);
+    proto.write(FIELD_TYPE_INT32 | ComplexProto::Log::kIdFieldNumber, 53);
+    proto.end(token);
+    EXPECT_EQ(proto.size(), 0);
+    EXPECT_FALSE(proto.flush(STDOUT_FILENO));
+}
+
+TEST(ProtoOutputStreamTest, FlushWritten) {
+    TemporaryFile tf;
+    ASSERT_NE(tf.fd, -1);
+
+    ProtoOutputStream proto;
+    uint64_t token = proto.start(FIELD_TYPE_MESSAGE | ComplexProto::kLogsFieldNumber,
+            logSize(1, "a") + ProtoOutputStream::sizeOf(
+                    FIELD_TYPE_STRING | ComplexProto::Log::kNameFieldNumber, std::string_view("b")));
+    EXPECT_TRUE(proto.write(FIELD_TYPE_INT32 | ComplexProto::Log::kIdFieldNumber, 1));
+    EXPECT_TRUE(proto.write(FIELD_TYPE_STRING | ComplexProto::Log::kNameFieldNumber,
+            std::string_view("a")));
+    EXPECT_TRUE(proto.flushWritten(tf.fd));
+    EXPECT_EQ(proto.bytesWritten(), 0);
+    EXPECT_TRUE(proto.write(FIELD_TYPE_STRING | ComplexProto::Log::kNameFieldNumber,
+            std::string_view("b")));
+    proto.end(token);
+    EXPECT_TRUE(proto.write(FIELD_TYPE_INT32 | ComplexProto::kIntsFieldNumber, 5));
+    EXPECT_TRUE(proto.flushWritten(tf.fd));
+
+    // Messages of unknown size have to be compacted before they can be written out.
+    token = proto.start(FIELD_TYPE_MESSAGE | ComplexProto::kLogsFieldNumber);
+    EXPECT_TRUE(proto.write(FIELD_TYPE_INT32 | ComplexProto::Log::kIdFieldNumber, 4));
+    EXPECT_FALSE(proto.flushWritten(tf.fd));
+    proto.end(token);
+    EXPECT_TRUE(proto.flush(tf.fd));
+
+    std::string content;
+    ASSERT_TRUE(ReadFileToString(tf.path, &content));
+    ComplexProto complex;
+    ASSERT_TRUE(complex.ParseFromString(content));
+    EXPECT_EQ(complex.ints_size(), 1);
+    EXPECT_EQ(complex.ints(0), 5);
+    EXPECT_EQ(complex.logs_size(), 2);
+    EXPECT_EQ(complex.logs(0).id(), 1);
+    EXPECT_THAT(complex.logs(0).name(), StrEq("b"));
+    EXPECT_EQ(complex.logs(1).id(), 4);
+}
@@ -851,6 +851,8 @@ static jobjectArray ImageReader_createImagePlanes(JNIEnv* env, jobject /*thiz*/,
         jobject imagePlane = env->NewObject(gImagePlaneClassInfo.clazz,
                     gImagePlaneClassInfo.ctor, rowStride, pixelStride, byteBuffer);
         env->SetObjectArrayElement(imagePlanes, i, imagePlane);
+        env->DeleteLocalRef(imagePlane);
+        env->DeleteLocalRef(byteBuffer);
     }
 
     return imagePlanes;
@@ -908,6 +910,8 @@ static jobjectArray Image_createSurfacePlanes(JNIEnv* env, jobject thiz,
         jobject surfacePlane = env->NewObject(gSurfacePlaneClassInfo.clazz,
                     gSurfacePlaneClassInfo.ctor, thiz, rowStride, pixelStride, byteBuffer);
         env->SetObjectArrayElement(surfacePlanes, i, surfacePlane);
+        env->DeleteLocalRef(surfacePlane);
+        env->DeleteLocalRef(byteBuffer);
     }
 
     return surfacePlanes;
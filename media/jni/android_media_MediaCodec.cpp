@@ -189,6 +189,17 @@ static struct {
     jmethodID setId;
 } gBufferInfo;
 
+static struct {
+    jclass clazz;
+    jmethodID byteBufferCtorId;
+    jmethodID hardwareBufferCtorId;
+} gMediaImageInfo;
+
+static struct {
+    jclass clazz;
+    jmethodID ctorId;
+} gRectInfo;
+
 struct fields_t {
     jmethodID postEventFromNativeID;
     jmethodID lockAndGetContextID;
@@ -730,25 +741,11 @@ status_t JMediaCodec::getImage(
     jobject cropRect = NULL;
     int32_t left, top, right, bottom;
     if (buffer->meta()->findRect("crop-rect", &left, &top, &right, &bottom)) {
-        ScopedLocalRef<jclass> rectClazz(
-                env, env->FindClass("android/graphics/Rect"));
-        CHECK(rectClazz.get() != NULL);
-
-        jmethodID rectConstructID = env->GetMethodID(
-                rectClazz.get(), "<init>", "(IIII)V");
-
         cropRect = env->NewObject(
-                rectClazz.get(), rectConstructID, left, top, right + 1, bottom + 1);
+                gRectInfo.clazz, gRectInfo.ctorId, left, top, right + 1, bottom + 1);
     }
 
-    ScopedLocalRef<jclass> imageClazz(
-            env, env->FindClass("android/media/MediaCodec$MediaImage"));
-    CHECK(imageClazz.get() != NULL);
-
-    jmethodID imageConstructID = env->GetMethodID(imageClazz.get(), "<init>",
-            "(Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;ZJIILandroid/graphics/Rect;)V");
-
-    *buf = env->NewObject(imageClazz.get(), imageConstructID,
+    *buf = env->NewObject(gMediaImageInfo.clazz, gMediaImageInfo.byteBufferCtorId,
             byteBuffer, infoBuffer,
             (jboolean)!input /* readOnly */,
             (jlong)timestamp,
@@ -2688,14 +2685,7 @@ static jobject android_media_MediaCodec_mapHardwareBuffer(JNIEnv *env, jclass, j
     env->ReleaseIntArrayElements(pixelStridesArray.get(), pixelStrides, 0);
     rowStrides = pixelStrides = nullptr;
 
-    ScopedLocalRef<jclass> imageClazz(
-            env, env->FindClass("android/media/MediaCodec$MediaImage"));
-    CHECK(imageClazz.get() != NULL);
-
-    jmethodID imageConstructID = env->GetMethodID(imageClazz.get(), "<init>",
-            "([Ljava/nio/ByteBuffer;[I[IIIIZJIILandroid/graphics/Rect;J)V");
-
-    jobject img = env->NewObject(imageClazz.get(), imageConstructID,
+    jobject img = env->NewObject(gMediaImageInfo.clazz, gMediaImageInfo.hardwareBufferCtorId,
             buffersArray.get(),
             rowStridesArray.get(),
             pixelStridesArray.get(),
@@ -3890,6 +3880,26 @@ static void android_media_MediaCodec_native_init(JNIEnv *env, jclass) {
     gFields.bufferInfoOffset = env->GetFieldID(clazz.get(), "offset", "I");
     gFields.bufferInfoPresentationTimeUs =
             env->GetFieldID(clazz.get(), "presentationTimeUs", "J");
+
+    // Images are created for every frame, so look up their classes only once.
+    clazz.reset(env->FindClass("android/media/MediaCodec$MediaImage"));
+    CHECK(clazz.get() != NULL);
+    gMediaImageInfo.clazz = (jclass)env->NewGlobalRef(clazz.get());
+
+    gMediaImageInfo.byteBufferCtorId = env->GetMethodID(clazz.get(), "<init>",
+            "(Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;ZJIILandroid/graphics/Rect;)V");
+    CHECK(gMediaImageInfo.byteBufferCtorId != NULL);
+
+    gMediaImageInfo.hardwareBufferCtorId = env->GetMethodID(clazz.get(), "<init>",
+            "([Ljava/nio/ByteBuffer;[I[IIIIZJIILandroid/graphics/Rect;J)V");
+    CHECK(gMediaImageInfo.hardwareBufferCtorId != NULL);
+
+    clazz.reset(env->FindClass("android/graphics/Rect"));
+    CHECK(clazz.get() != NULL);
+    gRectInfo.clazz = (jclass)env->NewGlobalRef(clazz.get());
+
+    gRectInfo.ctorId = env->GetMethodID(clazz.get(), "<init>", "(IIII)V");
+    CHECK(gRectInfo.ctorId != NULL);
 }
 
 static void android_media_MediaCodec_native_setup(
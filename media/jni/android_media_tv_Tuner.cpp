@@ -4453,15 +4453,19 @@ static jint android_media_tv_Tuner_read_filter_fmq(
         return -1;
     }
 
-    jboolean isCopy;
-    jbyte *dst = env->GetByteArrayElements(buffer, &isCopy);
-    ALOGV("copyData, isCopy=%d", isCopy);
-    if (dst == nullptr) {
-        jniThrowRuntimeException(env, "Failed to GetByteArrayElements");
+    if (offset < 0 || offset > env->GetArrayLength(buffer)) {
+        jniThrowRuntimeException(env, "Failed to read filter FMQ: invalid offset");
         return -1;
     }
-    int realReadSize = filterClient->read(reinterpret_cast<int8_t *>(dst) + offset, size);
-    env->ReleaseByteArrayElements(buffer, dst, 0);
+    size = std::min<jlong>(size, env->GetArrayLength(buffer) - offset);
+    // Copy from the FMQ straight into the array rather than through its elements, which for a
+    // movable array would be copied in and back out whole.
+    int realReadSize = filterClient->read(
+            [&](int64_t regionOffset, const int8_t *data, int64_t length) {
+                env->SetByteArrayRegion(buffer, offset + regionOffset, length,
+                                        reinterpret_cast<const jbyte *>(data));
+            },
+            size);
     return (jint)realReadSize;
 }
 
@@ -4937,15 +4941,17 @@ static jlong android_media_tv_Tuner_read_dvr_from_array(
         return -1;
     }
 
-    jboolean isCopy;
-    jbyte *src = env->GetByteArrayElements(buffer, &isCopy);
-    if (src == nullptr) {
-        ALOGD("Failed to GetByteArrayElements");
+    if (offset < 0 || offset > env->GetArrayLength(buffer)) {
+        ALOGD("Failed to read dvr: invalid offset");
         return -1;
     }
-    int64_t realSize =
-            dvrClient->readFromBuffer(reinterpret_cast<signed char *>(src) + offset, size);
-    env->ReleaseByteArrayElements(buffer, src, 0);
+    size = std::min<jlong>(size, env->GetArrayLength(buffer) - offset);
+    int64_t realSize = dvrClient->readFromBuffer(
+            [&](int64_t regionOffset, int8_t *data, int64_t length) {
+                env->GetByteArrayRegion(buffer, offset + regionOffset, length,
+                                        reinterpret_cast<jbyte *>(data));
+            },
+            size);
     return (jlong)realSize;
 }
 
@@ -4968,17 +4974,17 @@ static jlong android_media_tv_Tuner_write_dvr_to_array(
         return -1;
     }
 
-    jboolean isCopy;
-    jbyte *dst = env->GetByteArrayElements(buffer, &isCopy);
-    ALOGV("copyData, isCopy=%d", isCopy);
-    if (dst == nullptr) {
-        jniThrowRuntimeException(env, "Failed to GetByteArrayElements");
+    if (offset < 0 || offset > env->GetArrayLength(buffer)) {
+        jniThrowRuntimeException(env, "Failed to write dvr: invalid offset");
         return -1;
     }
-
-    int64_t realSize =
-            dvrClient->writeToBuffer(reinterpret_cast<signed char *>(dst) + offset, size);
-    env->ReleaseByteArrayElements(buffer, dst, 0);
+    size = std::min<jlong>(size, env->GetArrayLength(buffer) - offset);
+    int64_t realSize = dvrClient->writeToBuffer(
+            [&](int64_t regionOffset, const int8_t *data, int64_t length) {
+                env->SetByteArrayRegion(buffer, offset + regionOffset, length,
+                                        reinterpret_cast<const jbyte *>(data));
+            },
+            size);
     return (jlong)realSize;
 }
 
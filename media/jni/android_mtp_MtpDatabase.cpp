@@ -816,10 +816,14 @@ MtpResponseCode MtpDatabase::getObjectPropertyList(MtpObjectHandle handle,
             }
         }
 
-        env->ReleaseIntArrayElements(objectHandlesArray, objectHandles, 0);
-        env->ReleaseIntArrayElements(propertyCodesArray, propertyCodes, 0);
-        env->ReleaseIntArrayElements(dataTypesArray, dataTypes, 0);
-        env->ReleaseLongArrayElements(longValuesArray, longValues, 0);
+        // The arrays are only read, so don't copy them back to the Java heap. A whole-folder
+        // listing can carry tens of thousands of entries here.
+        env->ReleaseIntArrayElements(objectHandlesArray, objectHandles, JNI_ABORT);
+        env->ReleaseIntArrayElements(propertyCodesArray, propertyCodes, JNI_ABORT);
+        env->ReleaseIntArrayElements(dataTypesArray, dataTypes, JNI_ABORT);
+        if (longValues) {
+            env->ReleaseLongArrayElements(longValuesArray, longValues, JNI_ABORT);
+        }
 
         env->DeleteLocalRef(objectHandlesArray);
         env->DeleteLocalRef(propertyCodesArray);
@@ -851,16 +855,18 @@ MtpResponseCode MtpDatabase::getObjectInfo(MtpObjectHandle handle,
         return MTP_RESPONSE_INVALID_OBJECT_HANDLE;
     }
 
-    jint* intValues = env->GetIntArrayElements(mIntBuffer, 0);
+    // Only copy out the leading values that getObjectInfo() fills in, rather than pinning and
+    // writing back the whole buffers for every object a client enumerates.
+    jint intValues[3];
+    env->GetIntArrayRegion(mIntBuffer, 0, 3, intValues);
     info.mStorageID = intValues[0];
     info.mFormat = intValues[1];
     info.mParent = intValues[2];
-    env->ReleaseIntArrayElements(mIntBuffer, intValues, 0);
 
-    jlong* longValues = env->GetLongArrayElements(mLongBuffer, 0);
+    jlong longValues[2];
+    env->GetLongArrayRegion(mLongBuffer, 0, 2, longValues);
     info.mDateCreated = longValues[0];
     info.mDateModified = longValues[1];
-    env->ReleaseLongArrayElements(mLongBuffer, longValues, 0);
 
     if ((false)) {
         info.mAssociationType = (format == MTP_FORMAT_ASSOCIATION ?
@@ -872,7 +878,7 @@ MtpResponseCode MtpDatabase::getObjectInfo(MtpObjectHandle handle,
     jchar* str = env->GetCharArrayElements(mStringBuffer, 0);
     MtpStringBuffer temp(str);
     info.mName = strdup(temp);
-    env->ReleaseCharArrayElements(mStringBuffer, str, 0);
+    env->ReleaseCharArrayElements(mStringBuffer, str, JNI_ABORT);
 
     // read EXIF data for thumbnail information
     switch (info.mFormat) {
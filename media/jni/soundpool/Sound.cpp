@@ -23,12 +23,59 @@
 #include <media/NdkMediaCodec.h>
 #include <media/NdkMediaExtractor.h>
 #include <media/NdkMediaFormat.h>
+#include <sys/stat.h>
+
+#include <map>
+#include <mutex>
+#include <tuple>
 
 namespace android::soundpool {
 
 constexpr uint32_t kMaxSampleRate = 192000;
 constexpr size_t   kDefaultHeapSize = 1024 * 1024; // 1MB (compatible with low mem devices)
 
+namespace {
+
+// Decoded sounds are shared by all the SoundPools of the process, so that loading an asset that
+// is already loaded somewhere (by another pool, or again after a configuration change) neither
+// decodes it again nor keeps a second copy of the PCM data. An entry lives only as long as some
+// Sound still holds its heap.
+struct DecodedKey {
+    dev_t dev;
+    ino_t ino;
+    int64_t mtimeNs;
+    int64_t offset;
+    int64_t length;
+
+    bool operator<(const DecodedKey& other) const {
+        return std::tie(dev, ino, mtimeNs, offset, length) <
+               std::tie(other.dev, other.ino, other.mtimeNs, other.offset, other.length);
+    }
+};
+
+struct DecodedSound {
+    wp<MemoryHeapBase> heap;
+    size_t sizeInBytes;
+    uint32_t sampleRate;
+    int32_t channelCount;
+    audio_format_t format;
+    audio_channel_mask_t channelMask;
+};
+
+std::mutex gDecodedLock;
+std::map<DecodedKey, DecodedSound> gDecoded;  // GUARDED_BY(gDecodedLock)
+
+// Only regular files can be recognized again; anything else (a pipe, say) is never cached.
+bool getDecodedKey(int fd, int64_t offset, int64_t length, DecodedKey* key) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) return false;
+    *key = {st.st_dev, st.st_ino,
+            st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec, offset, length};
+    return true;
+}
+
+} // namespace
+
 Sound::Sound(int32_t soundID, int fd, int64_t offset, int64_t length)
     : mSoundID(soundID)
     , mFd(fcntl(fd, F_DUPFD_CLOEXEC, (int)0 /* arg */)) // dup(fd) + close on exec to prevent leaks.
@@ -200,6 +247,29 @@ status_t Sound::doLoad()
     ALOGV("%s()", __func__);
     status_t status = NO_INIT;
     if (mFd.get() != -1) {
+        DecodedKey key;
+        const bool cacheable = getDecodedKey(mFd.get(), mOffset, mLength, &key);
+        if (cacheable) {
+            std::lock_guard lock(gDecodedLock);
+            auto it = gDecoded.find(key);
+            if (it != gDecoded.end()) {
+                if (sp<MemoryHeapBase> heap = it->second.heap.promote(); heap != nullptr) {
+                    ALOGV("%s: reusing decoded data of an identical sound", __func__);
+                    mFd.reset();
+                    mHeap = std::move(heap);
+                    mSizeInBytes = it->second.sizeInBytes;
+                    mData = new MemoryBase(mHeap, 0, mSizeInBytes);
+                    mSampleRate = it->second.sampleRate;
+                    mChannelCount = it->second.channelCount;
+                    mFormat = it->second.format;
+                    mChannelMask = it->second.channelMask;
+                    mState = READY;  // this should be last, as it is an atomic sync point
+                    return NO_ERROR;
+                }
+                gDecoded.erase(it);
+            }
+        }
+
         mHeap = new MemoryHeapBase(kDefaultHeapSize);
 
         ALOGV("%s: start decode", __func__);
@@ -229,6 +299,15 @@ status_t Sound::doLoad()
             mChannelCount = channelCount;
             mFormat = format;
             mChannelMask = channelMask;
+            if (cacheable) {
+                std::lock_guard lock(gDecodedLock);
+                // Drop the entries of sounds that have since been unloaded everywhere.
+                std::erase_if(gDecoded, [](const auto& entry) {
+                    return entry.second.heap.promote() == nullptr;
+                });
+                gDecoded[key] = {mHeap, mSizeInBytes, mSampleRate, mChannelCount, mFormat,
+                                 mChannelMask};
+            }
             mState = READY;  // this should be last, as it is an atomic sync point
             return NO_ERROR;
         }
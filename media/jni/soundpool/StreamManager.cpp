@@ -37,6 +37,9 @@ static constexpr bool kStealActiveStream_OldestFirst = true;
 
 // Changing to false means calls to play() are almost instantaneous instead of taking around
 // ~10ms to launch the AudioTrack. It is perhaps 100x faster.
+// Independently of kPlayOnCallingThread, a stream whose AudioTrack was last used for the same
+// sound is played on the calling thread: reusing the track does not block on AudioTrack creation,
+// so the worker thread handoff would only add latency.
 static constexpr bool kPlayOnCallingThread = false;
 
 // Amount of time for a StreamManager thread to wait before closing.
@@ -246,7 +249,8 @@ int32_t StreamManager::queueForPlay(const std::shared_ptr<Sound> &sound,
                 __func__, newStream, pairStream, streamID);
         pairStream->setPlay(
                 streamID, sound, soundID, leftVolume, rightVolume, priority, loop, rate);
-        if (fromAvailableQueue && kPlayOnCallingThread) {
+        if (fromAvailableQueue
+                && (kPlayOnCallingThread || newStream->getSoundID() == soundID)) {
             removeFromQueues_l(newStream);
             mProcessingStreams.emplace(newStream);
             lock.unlock();
@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <atomic>
 #include <future>
 #include <mutex>
@@ -180,11 +181,14 @@ void testStreams(SoundPool *soundPool, const std::vector<const char *> &filename
 
     // check and play (overlap with above).
     std::vector<int32_t> streamIDs;
+    int64_t maxPlayLatencyNs = 0;
     for (int32_t soundID : soundIDs) {
         for (int i = 0; i <= repeat; ++i) {
             printf("\nplaying soundID=%d", soundID);
+            const int64_t playStartNs = systemTime();
             const int32_t streamID =
                     soundPool->play(soundID, maxVol, maxVol, priority, loop, rate);
+            maxPlayLatencyNs = std::max(maxPlayLatencyNs, systemTime() - playStartNs);
             if (streamID == 0) {
                 printf(" failed!  ERROR");
                 ++gErrors;
@@ -196,6 +200,7 @@ void testStreams(SoundPool *soundPool, const std::vector<const char *> &filename
     }
     const int64_t playTimeNs = systemTime();
     printf("\nplayTimeMs: %d\n", (int)((playTimeNs - loadTimeNs) / NANOS_PER_MILLISECOND));
+    printf("maxPlayLatencyUs: %d\n", (int)(maxPlayLatencyNs / NANOS_PER_MICROSECOND));
 
     for (int i = 0; i < playSec; ++i) {
         sleep(1);
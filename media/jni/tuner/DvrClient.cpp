@@ -127,6 +127,23 @@ int64_t DvrClient::readFromBuffer(int8_t* buffer, int64_t size) {
     return size;
 }
 
+int64_t DvrClient::readFromBuffer(const MqRegionWriter& writer, int64_t size) {
+    if (mDvrMQ == nullptr || mDvrMQEventFlag == nullptr) {
+        ALOGE("Failed to readFromBuffer. DVR mq is not configured");
+        return -1;
+    }
+
+    int64_t written = writeToMq(mDvrMQ, size, writer);
+    if (written < 0) {
+        ALOGD("Failed to write FMQ");
+        return -1;
+    }
+    if (written > 0) {
+        mDvrMQEventFlag->wake(static_cast<uint32_t>(DemuxQueueNotifyBits::DATA_READY));
+    }
+    return written;
+}
+
 int64_t DvrClient::writeToFile(int64_t size) {
     if (mDvrMQ == nullptr || mDvrMQEventFlag == nullptr) {
         ALOGE("Failed to writeToFile. DVR mq is not configured");
@@ -202,6 +219,23 @@ int64_t DvrClient::writeToBuffer(int8_t* buffer, int64_t size) {
     return size;
 }
 
+int64_t DvrClient::writeToBuffer(const MqRegionReader& reader, int64_t size) {
+    if (mDvrMQ == nullptr || mDvrMQEventFlag == nullptr) {
+        ALOGE("Failed to writetoBuffer. DVR mq is not configured");
+        return -1;
+    }
+
+    int64_t readSize = readFromMq(mDvrMQ, size, reader);
+    if (readSize < 0) {
+        ALOGD("Failed to read FMQ");
+        return -1;
+    }
+    if (readSize > 0) {
+        mDvrMQEventFlag->wake(static_cast<uint32_t>(DemuxQueueNotifyBits::DATA_CONSUMED));
+    }
+    return readSize;
+}
+
 int64_t DvrClient::seekFile(int64_t pos) {
     if (mFd < 0) {
         ALOGE("Failed to seekFile. File is not configured");
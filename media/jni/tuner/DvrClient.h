@@ -76,6 +76,12 @@ public:
      */
     int64_t readFromBuffer(int8_t* buffer, int64_t size);
 
+    /**
+     * Read data with given size from writer, which fills the DVR FMQ directly. Return the actual
+     * read size.
+     */
+    int64_t readFromBuffer(const MqRegionWriter& writer, int64_t size);
+
     /**
      * Write data to file with given size. Return the actual write size.
      */
@@ -91,6 +97,12 @@ public:
      */
     int64_t writeToBuffer(int8_t* buffer, int64_t size);
 
+    /**
+     * Write data with given size to reader, straight from the DVR FMQ. Return the actual write
+     * size.
+     */
+    int64_t writeToBuffer(const MqRegionReader& reader, int64_t size);
+
     /**
      * Configure the DVR.
      */
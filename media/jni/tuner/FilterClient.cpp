@@ -61,6 +61,18 @@ int64_t FilterClient::read(int8_t* buffer, int64_t size) {
     return copyData(buffer, size);
 }
 
+int64_t FilterClient::read(const MqRegionReader& reader, int64_t size) {
+    Result res = getFilterMq();
+    if (res != Result::SUCCESS || mFilterMQ == nullptr || mFilterMQEventFlag == nullptr) {
+        return -1;
+    }
+    int64_t readSize = readFromMq(mFilterMQ, size, reader);
+    if (readSize > 0) {
+        mFilterMQEventFlag->wake(static_cast<uint32_t>(DemuxQueueNotifyBits::DATA_CONSUMED));
+    }
+    return readSize;
+}
+
 SharedHandleInfo FilterClient::getAvSharedHandleInfo() {
     handleAvShareMemory();
     SharedHandleInfo info{
@@ -289,6 +301,46 @@ int64_t FilterClient::copyData(int8_t* buffer, int64_t size) {
     return size;
 }
 
+int64_t readFromMq(AidlMQ* mq, int64_t size, const MqRegionReader& reader) {
+    size = min(size, static_cast<int64_t>(mq->availableToRead()));
+    if (size <= 0) {
+        return 0;
+    }
+
+    AidlMQ::MemTransaction tx;
+    if (!mq->beginRead(size, &tx)) {
+        return -1;
+    }
+    auto first = tx.getFirstRegion();
+    int64_t firstLength = min(static_cast<int64_t>(first.getLength()), size);
+    reader(0, first.getAddress(), firstLength);
+    if (firstLength < size) {
+        auto second = tx.getSecondRegion();
+        reader(firstLength, second.getAddress(), size - firstLength);
+    }
+    return mq->commitRead(size) ? size : -1;
+}
+
+int64_t writeToMq(AidlMQ* mq, int64_t size, const MqRegionWriter& writer) {
+    size = min(size, static_cast<int64_t>(mq->availableToWrite()));
+    if (size <= 0) {
+        return 0;
+    }
+
+    AidlMQ::MemTransaction tx;
+    if (!mq->beginWrite(size, &tx)) {
+        return -1;
+    }
+    auto first = tx.getFirstRegion();
+    int64_t firstLength = min(static_cast<int64_t>(first.getLength()), size);
+    writer(0, first.getAddress(), firstLength);
+    if (firstLength < size) {
+        auto second = tx.getSecondRegion();
+        writer(firstLength, second.getAddress(), size - firstLength);
+    }
+    return mq->commitWrite(size) ? size : -1;
+}
+
 void FilterClient::checkIsMediaFilter(DemuxFilterType type) {
     if (type.mainType == DemuxFilterMainType::MMTP) {
         if (type.subType.get<DemuxFilterSubType::Tag::mmtpFilterType>() ==
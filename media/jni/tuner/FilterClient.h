@@ -23,6 +23,8 @@
 #include <fmq/AidlMessageQueue.h>
 #include <utils/Mutex.h>
 
+#include <functional>
+
 #include "ClientHelper.h"
 #include "FilterClientCallback.h"
 
@@ -47,6 +49,27 @@ namespace android {
 using AidlMQ = AidlMessageQueue<int8_t, SynchronizedReadWrite>;
 using AidlMQDesc = MQDescriptor<int8_t, SynchronizedReadWrite>;
 
+/**
+ * Accesses the data of an FMQ transaction in place, one contiguous region at a time. offset is
+ * the position of the region within the whole transaction.
+ */
+using MqRegionReader = function<void(int64_t offset, const int8_t* data, int64_t length)>;
+using MqRegionWriter = function<void(int64_t offset, int8_t* data, int64_t length)>;
+
+/**
+ * Read up to size bytes from mq, passing them to reader straight from the queue memory.
+ *
+ * @return the actual reading size. -1 if failed to read.
+ */
+int64_t readFromMq(AidlMQ* mq, int64_t size, const MqRegionReader& reader);
+
+/**
+ * Write up to size bytes to mq, letting writer fill the queue memory directly.
+ *
+ * @return the actual writing size. -1 if failed to write.
+ */
+int64_t writeToMq(AidlMQ* mq, int64_t size, const MqRegionWriter& writer);
+
 struct SharedHandleInfo {
     native_handle_t* sharedHandle;
     uint64_t size;
@@ -75,6 +98,13 @@ public:
      */
     int64_t read(int8_t* buffer, int64_t size);
 
+    /**
+     * Read size of data from filter FMQ, handing it to reader without an intermediate copy.
+     *
+     * @return the actual reading size. -1 if failed to read.
+     */
+    int64_t read(const MqRegionReader& reader, int64_t size);
+
     /**
      * Get the a/v shared memory handle information
      */
@@ -446,12 +446,23 @@ bool GLFrame::DetachTextureFromFbo() {
 }
 
 bool GLFrame::UploadTexturePixels(const uint8_t* pixels) {
+  // If we already allocated the storage ourselves, it has our dimensions and format, so only
+  // replace its contents instead of re-specifying (and reallocating) the texture for every
+  // uploaded frame. This must be checked before binding, which would re-create a deleted name.
+  const bool reuse_storage =
+      owns_texture_ && texture_state_ == kStateComplete && !TextureWasDeleted();
+
   // Bind the texture object
   FocusTexture();
 
   // Load mipmap level 0
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width_, height_,
-               0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+  if (reuse_storage) {
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_,
+                    GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+  } else {
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width_, height_,
+                 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+  }
 
   // Set the user specified texture parameters
   UpdateTexParameters();
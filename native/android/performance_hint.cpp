@@ -175,6 +175,11 @@ private:
     // Cached samples
     std::vector<hal::WorkDuration> mActualWorkDurations GUARDED_BY(sHintMutex);
     std::string mSessionName;
+    // Counter names for the per-report traces, built once so reporting doesn't allocate
+    std::string mActualDurationTraceName;
+    std::string mBatchSizeTraceName;
+    std::string mTargetDurationTraceName;
+    std::string mPowerEfficientTraceName;
     static int64_t sIDCounter GUARDED_BY(sHintMutex);
     // The most recent set of thread IDs
     std::vector<int32_t> mLastThreadIDs GUARDED_BY(sHintMutex);
@@ -309,6 +314,10 @@ APerformanceHintSession::APerformanceHintSession(std::shared_ptr<IHintManager> h
     }
     int64_t traceId = sessionConfig.has_value() ? sessionConfig->id : ++sIDCounter;
     mSessionName = android::base::StringPrintf("ADPF Session %" PRId64, traceId);
+    mActualDurationTraceName = mSessionName + " actual duration";
+    mBatchSizeTraceName = mSessionName + " batch size";
+    mTargetDurationTraceName = mSessionName + " target duration";
+    mPowerEfficientTraceName = mSessionName + " power efficiency mode";
 }
 
 APerformanceHintSession::~APerformanceHintSession() {
@@ -672,20 +681,19 @@ void APerformanceHintSession::traceThreads(std::vector<int32_t>& tids) {
 }
 
 void APerformanceHintSession::tracePowerEfficient(bool powerEfficient) {
-    ATrace_setCounter((mSessionName + " power efficiency mode").c_str(), powerEfficient);
+    ATrace_setCounter(mPowerEfficientTraceName.c_str(), powerEfficient);
 }
 
 void APerformanceHintSession::traceActualDuration(int64_t actualDuration) {
-    ATrace_setCounter((mSessionName + " actual duration").c_str(), actualDuration);
+    ATrace_setCounter(mActualDurationTraceName.c_str(), actualDuration);
 }
 
 void APerformanceHintSession::traceBatchSize(size_t batchSize) {
-    std::string traceName = StringPrintf("%s batch size", mSessionName.c_str());
-    ATrace_setCounter((mSessionName + " batch size").c_str(), batchSize);
+    ATrace_setCounter(mBatchSizeTraceName.c_str(), batchSize);
 }
 
 void APerformanceHintSession::traceTargetDuration(int64_t targetDuration) {
-    ATrace_setCounter((mSessionName + " target duration").c_str(), targetDuration);
+    ATrace_setCounter(mTargetDurationTraceName.c_str(), targetDuration);
 }
 
 // ===================================== C API
@@ -335,12 +335,14 @@ void ASurfaceTransaction_setOnComplete(ASurfaceTransaction* aSurfaceTransaction,
         aSurfaceTransactionStats.transactionCompleted = true;
 
         auto& aSurfaceControlStats = aSurfaceTransactionStats.aSurfaceControlStats;
+        aSurfaceControlStats.reserve(surfaceControlStats.size());
 
         for (const auto& [surfaceControl, latchTime, acquireTimeOrFence, presentFence,
                   previousReleaseFence, transformHint, frameEvents, ignore] : surfaceControlStats) {
             ASurfaceControl* aSurfaceControl = reinterpret_cast<ASurfaceControl*>(surfaceControl.get());
-            aSurfaceControlStats[aSurfaceControl].acquireTimeOrFence = acquireTimeOrFence;
-            aSurfaceControlStats[aSurfaceControl].previousReleaseFence = previousReleaseFence;
+            ASurfaceControlStats& stats = aSurfaceControlStats[aSurfaceControl];
+            stats.acquireTimeOrFence = acquireTimeOrFence;
+            stats.previousReleaseFence = previousReleaseFence;
         }
 
         (*func)(callback_context, &aSurfaceTransactionStats);
@@ -546,9 +548,14 @@ void ASurfaceTransaction_setDamageRegion(ASurfaceTransaction* aSurfaceTransactio
     sp<SurfaceControl> surfaceControl = ASurfaceControl_to_SurfaceControl(aSurfaceControl);
     Transaction* transaction = ASurfaceTransaction_to_Transaction(aSurfaceTransaction);
 
+    // A single rect, the common case, becomes the region directly without a boolean operation.
     Region region;
-    for (uint32_t i = 0; i < count; ++i) {
-        region.orSelf(static_cast<const Rect&>(rects[i]));
+    if (count == 1) {
+        region.set(static_cast<const Rect&>(rects[0]));
+    } else {
+        for (uint32_t i = 0; i < count; ++i) {
+            region.orSelf(static_cast<const Rect&>(rects[i]));
+        }
     }
 
     // Hardware composer interprets a DamageRegion with a single Rect of {0,0,0,0} to be an
@@ -768,6 +775,7 @@ void ASurfaceTransaction_setOnCommit(ASurfaceTransaction* aSurfaceTransaction, v
                 aSurfaceTransactionStats.transactionCompleted = false;
 
                 auto& aSurfaceControlStats = aSurfaceTransactionStats.aSurfaceControlStats;
+                aSurfaceControlStats.reserve(surfaceControlStats.size());
                 for (const auto& [surfaceControl, latchTime, acquireTimeOrFence, presentFence,
                               previousReleaseFence, transformHint, frameEvents, ignore] :
                      surfaceControlStats) {
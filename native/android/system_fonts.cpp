@@ -33,6 +33,7 @@
 #include <unistd.h>
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -85,7 +86,8 @@ struct FontHasher {
 };
 
 struct ASystemFontIterator {
-    std::vector<AFont> fonts;
+    // Shared with the process-wide cache; empty when falling back to the XML files.
+    std::shared_ptr<const std::vector<AFont>> fonts;
     uint32_t index;
 
     XmlDocUniquePtr mXmlDoc;
@@ -234,40 +236,75 @@ bool findFirstFontNode(const XmlDocUniquePtr& doc, ParserState* state) {
     return font != nullptr;
 }
 
+// The deduplicated font list built from the last minikin font set that was seen. The font set is
+// replaced rather than mutated when fonts are updated, so comparing the font pointers is enough
+// to tell whether the cached list is still current.
+struct SystemFontListCache {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<minikin::Font>> fontSet;
+    std::shared_ptr<const std::vector<AFont>> fonts;
+};
+
+SystemFontListCache& getSystemFontListCache() {
+    static SystemFontListCache* cache = new SystemFontListCache();
+    return *cache;
+}
+
 }  // namespace
 
 ASystemFontIterator* ASystemFontIterator_open() {
     std::unique_ptr<ASystemFontIterator> ite(new ASystemFontIterator());
 
-    std::unordered_set<AFont, FontHasher> fonts;
-    minikin::SystemFonts::getFontSet(
-            [&fonts](const std::vector<std::shared_ptr<minikin::Font>>& fontSet) {
-                for (const auto& font : fontSet) {
-                    std::optional<std::string> locale;
-                    uint32_t localeId = font->getLocaleListId();
-                    if (localeId != minikin::kEmptyLocaleListId) {
-                        locale.emplace(minikin::getLocaleString(localeId));
+    SystemFontListCache& cache = getSystemFontListCache();
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        std::unordered_set<AFont, FontHasher> fonts;
+        bool cacheHit = false;
+        minikin::SystemFonts::getFontSet(
+                [&fonts, &cache, &cacheHit](
+                        const std::vector<std::shared_ptr<minikin::Font>>& fontSet) {
+                    if (!fontSet.empty() && fontSet == cache.fontSet) {
+                        cacheHit = true;
+                        return;
                     }
-                    std::vector<std::pair<uint32_t, float>> axes;
-                    for (const auto& [tag, value] : font->baseTypeface()->GetAxes()) {
-                        axes.push_back(std::make_pair(tag, value));
+                    cache.fontSet = fontSet;
+                    for (const auto& font : fontSet) {
+                        std::optional<std::string> locale;
+                        uint32_t localeId = font->getLocaleListId();
+                        if (localeId != minikin::kEmptyLocaleListId) {
+                            locale.emplace(minikin::getLocaleString(localeId));
+                        }
+                        std::vector<std::pair<uint32_t, float>> axes;
+                        for (const auto& [tag, value] : font->baseTypeface()->GetAxes()) {
+                            axes.push_back(std::make_pair(tag, value));
+                        }
+
+                        fonts.insert({font->baseTypeface()->GetFontPath(), std::move(locale),
+                                      font->style().weight(),
+                                      font->style().slant() == minikin::FontStyle::Slant::ITALIC,
+                                      static_cast<uint32_t>(font->baseTypeface()->GetFontIndex()),
+                                      axes});
                     }
+                });
+
+        if (!cacheHit) {
+            if (fonts.empty()) {
+                cache.fontSet.clear();
+                cache.fonts.reset();
+            } else {
+                cache.fonts =
+                        std::make_shared<const std::vector<AFont>>(fonts.begin(), fonts.end());
+            }
+        }
+        ite->fonts = cache.fonts;
+    }
 
-                    fonts.insert({font->baseTypeface()->GetFontPath(), std::move(locale),
-                                  font->style().weight(),
-                                  font->style().slant() == minikin::FontStyle::Slant::ITALIC,
-                                  static_cast<uint32_t>(font->baseTypeface()->GetFontIndex()),
-                                  axes});
-                }
-            });
-
-    if (fonts.empty()) {
+    if (ite->fonts) {
+        ite->index = 0;
+    } else {
         ite->mXmlDoc.reset(xmlReadFile("/system/etc/fonts.xml", nullptr, 0));
         ite->mCustomizationXmlDoc.reset(
                 xmlReadFile("/product/etc/fonts_customization.xml", nullptr, 0));
-    } else {
-        ite->index = 0;
-        ite->fonts.assign(fonts.begin(), fonts.end());
     }
     return ite.release();
 }
@@ -363,11 +400,11 @@ bool findNextFontNode(const XmlDocUniquePtr& xmlDoc, ParserState* state) {
 
 AFont* ASystemFontIterator_next(ASystemFontIterator* ite) {
     LOG_ALWAYS_FATAL_IF(ite == nullptr, "nullptr has passed as iterator argument");
-    if (!ite->fonts.empty()) {
-        if (ite->index >= ite->fonts.size()) {
+    if (ite->fonts) {
+        if (ite->index >= ite->fonts->size()) {
             return nullptr;
         }
-        return new AFont(ite->fonts[ite->index++]);
+        return new AFont((*ite->fonts)[ite->index++]);
     }
 
     if (ite->mXmlDoc) {
@@ -67,13 +67,10 @@ static void startStatsHidlService() {
     ALOGW_IF(err != android::OK, "Cannot register HIDL %s: %d", IStats::descriptor, err);
 }
 
-static void startSensorManagerAidlService(JNIEnv* env) {
+static void startSensorManagerAidlService(JavaVM* vm) {
     using ::aidl::android::frameworks::sensorservice::ISensorManager;
     using ::android::frameworks::sensorservice::implementation::SensorManagerAidl;
 
-    JavaVM* vm;
-    LOG_ALWAYS_FATAL_IF(env->GetJavaVM(&vm) != JNI_OK, "Cannot get Java VM");
-
     std::shared_ptr<SensorManagerAidl> sensorService =
             ndk::SharedRefBase::make<SensorManagerAidl>(vm);
     const std::string instance = std::string() + ISensorManager::descriptor + "/default";
@@ -82,15 +79,12 @@ static void startSensorManagerAidlService(JNIEnv* env) {
     LOG_ALWAYS_FATAL_IF(err != EX_NONE, "Cannot register AIDL %s: %d", instance.c_str(), err);
 }
 
-static void startSensorManagerHidlService(JNIEnv* env) {
+static void startSensorManagerHidlService(JavaVM* vm) {
     using ::android::frameworks::sensorservice::V1_0::ISensorManager;
     using ::android::frameworks::sensorservice::V1_0::implementation::SensorManager;
     using ::android::hardware::configureRpcThreadpool;
     using ::android::hidl::manager::V1_0::IServiceManager;
 
-    JavaVM* vm;
-    LOG_ALWAYS_FATAL_IF(env->GetJavaVM(&vm) != JNI_OK, "Cannot get Java VM");
-
     android::sp<ISensorManager> sensorService = new SensorManager(vm);
     if (IServiceManager::Transport::HWBINDER ==
         android::hardware::defaultServiceManager1_2()->getTransport(ISensorManager::descriptor,
@@ -103,19 +97,31 @@ static void startSensorManagerHidlService(JNIEnv* env) {
     }
 }
 
+// The HIDL and AIDL registrations of a service go to different service managers and do not depend
+// on each other, but each can block on service manager lookups during boot. Run the HIDL one on a
+// helper thread alongside the AIDL one, and return only once both are registered.
+template <typename Hidl, typename Aidl>
+static void startHidlAndAidlConcurrently(Hidl startHidl, Aidl startAidl) {
+    std::thread hidlThread(startHidl);
+    startAidl();
+    hidlThread.join();
+}
+
 } // namespace
 
 namespace android {
 
 static void android_server_SystemServer_startIStatsService(JNIEnv* /* env */, jobject /* clazz */) {
-    startStatsHidlService();
-    startStatsAidlService();
+    startHidlAndAidlConcurrently(startStatsHidlService, startStatsAidlService);
 }
 
 static void android_server_SystemServer_startISensorManagerService(JNIEnv* env,
                                                                    jobject /* clazz */) {
-    startSensorManagerHidlService(env);
-    startSensorManagerAidlService(env);
+    JavaVM* vm;
+    LOG_ALWAYS_FATAL_IF(env->GetJavaVM(&vm) != JNI_OK, "Cannot get Java VM");
+
+    startHidlAndAidlConcurrently([vm] { startSensorManagerHidlService(vm); },
+                                 [vm] { startSensorManagerAidlService(vm); });
 }
 
 static void android_server_SystemServer_startMemtrackProxyService(JNIEnv* env,
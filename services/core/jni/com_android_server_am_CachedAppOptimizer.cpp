@@ -26,6 +26,7 @@
 #include <android_runtime/AndroidRuntime.h>
 #include <cutils/compiler.h>
 #include <dirent.h>
+#include <inttypes.h>
 #include <jni.h>
 #include <linux/errno.h>
 #include <linux/time.h>
@@ -46,6 +47,9 @@
 #include <utils/Trace.h>
 
 #include <algorithm>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 using android::base::StringPrintf;
 using android::base::WriteStringToFile;
@@ -74,6 +78,10 @@ using android::base::unique_fd;
 // limit, it has to be a page aligned value.
 #define MAX_BYTES_PER_BATCH MAX_RW_COUNT
 
+// Number of threads compactSystem spreads its processes over. They inherit the
+// cpuset and priority of the compaction thread that starts them.
+#define SYSTEM_COMPACTION_THREADS 2
+
 // Selected a high enough number to avoid clashing with linux errno codes
 #define ERROR_COMPACTION_CANCELLED -1000
 
@@ -85,6 +93,25 @@ static std::atomic<bool> cancelRunningCompaction;
 
 static bool inSystemCompaction = false;
 
+// What a process looked like when it was last compacted. A process that has
+// taken no page faults since then has neither allocated nor swapped in
+// anything, which is the common case for frozen cached apps, so compacting it
+// again with the same flags would only walk page tables that have nothing left
+// to reclaim.
+struct CompactionRecord {
+    uint64_t startTime;
+    uint64_t faults;
+    int compactionFlags;
+    bool systemCompaction;
+};
+
+// Bounds the history, most entries beyond this belong to processes that have
+// since died.
+#define MAX_COMPACTION_RECORDS 512
+
+static std::mutex compactionHistoryLock;
+static std::unordered_map<int, CompactionRecord> compactionHistory;
+
 // A VmaBatch represents a set of VMAs that can be processed
 // as VMAs are processed by client code it is expected that the
 // VMAs get consumed which means they are discarded as they are
@@ -360,14 +387,14 @@ static int getAnyPageAdvice(const Vma& vma) {
 // returns process_madvise errno code or if compaction was cancelled
 // it returns ERROR_COMPACTION_CANCELLED.
 //
-// Not thread safe. We reuse vectors so we assume this is called only
-// on one thread at most.
+// The vectors are reused between calls, one set per thread, so that
+// compactSystem can compact several processes at once.
 static int64_t compactProcess(int pid, VmaToAdviseFunc vmaToAdviseFunc) {
     cancelRunningCompaction.store(false);
-    static std::string mapsBuffer;
+    thread_local std::string mapsBuffer;
     ATRACE_BEGIN("CollectVmas");
     ProcMemInfo meminfo(pid);
-    static std::vector<Vma> pageoutVmas(2000), coldVmas(2000);
+    thread_local std::vector<Vma> pageoutVmas(2000), coldVmas(2000);
     int coldVmaIndex = 0;
     int pageoutVmaIndex = 0;
     auto vmaCollectorCb = [&vmaToAdviseFunc, &pageoutVmaIndex, &coldVmaIndex](const Vma& vma) {
@@ -419,6 +446,29 @@ static int64_t compactProcess(int pid, VmaToAdviseFunc vmaToAdviseFunc) {
     return pageoutBytes + coldBytes;
 }
 
+// Reads the start time and the minor plus major fault count of pid from
+// /proc/pid/stat. The start time tells a reused pid apart.
+static bool readFaultCount(int pid, uint64_t* outStartTime, uint64_t* outFaults) {
+    std::string stat;
+    if (!android::base::ReadFileToString(StringPrintf("/proc/%d/stat", pid), &stat)) {
+        return false;
+    }
+    // The command name may contain spaces, so parse from the last ')'.
+    size_t commEnd = stat.rfind(')');
+    if (commEnd == std::string::npos) {
+        return false;
+    }
+    uint64_t minFaults, majFaults;
+    if (sscanf(stat.c_str() + commEnd + 1,
+               " %*c %*d %*d %*d %*d %*d %*u %" SCNu64 " %*u %" SCNu64
+               " %*u %*u %*u %*d %*d %*d %*d %*d %*d %" SCNu64,
+               &minFaults, &majFaults, outStartTime) != 3) {
+        return false;
+    }
+    *outFaults = minFaults + majFaults;
+    return true;
+}
+
 // Compact process using process_madvise syscall or fallback to procfs in
 // case syscall does not exist.
 static void compactProcessOrFallback(int pid, int compactionFlags) {
@@ -429,7 +479,7 @@ static void compactProcessOrFallback(int pid, int compactionFlags) {
 
     // Set when the system does not support process_madvise syscall to avoid
     // gathering VMAs in subsequent calls prior to falling back to procfs
-    static bool shouldForceProcFs = false;
+    static std::atomic<bool> shouldForceProcFs = false;
     std::string compactionType;
     VmaToAdviseFunc vmaToAdviseFunc;
 
@@ -446,9 +496,57 @@ static void compactProcessOrFallback(int pid, int compactionFlags) {
         vmaToAdviseFunc = getFilePageAdvice;
     }
 
-    if (shouldForceProcFs || compactProcess(pid, vmaToAdviseFunc) == -ENOSYS) {
+    if (shouldForceProcFs) {
+        compactProcessProcfs(pid, compactionType);
+        return;
+    }
+
+    uint64_t startTime = 0;
+    uint64_t faults = 0;
+    bool haveFaults = readFaultCount(pid, &startTime, &faults);
+    if (haveFaults) {
+        std::lock_guard<std::mutex> lock(compactionHistoryLock);
+        auto it = compactionHistory.find(pid);
+        if (it != compactionHistory.end() && it->second.startTime == startTime &&
+            it->second.faults == faults && it->second.compactionFlags == compactionFlags &&
+            it->second.systemCompaction == inSystemCompaction) {
+            ATRACE_INSTANT_FOR_TRACK(ATRACE_COMPACTION_TRACK,
+                                     StringPrintf("Skipped unchanged %d", pid).c_str());
+            return;
+        }
+    }
+
+    int64_t startCpuTime = systemTime(CLOCK_THREAD_CPUTIME_ID);
+    int64_t compactedBytes = compactProcess(pid, vmaToAdviseFunc);
+    if (compactedBytes == -ENOSYS) {
         shouldForceProcFs = true;
         compactProcessProcfs(pid, compactionType);
+        return;
+    }
+    if (compactedBytes < 0) {
+        return;
+    }
+
+    if (ATRACE_ENABLED()) {
+        int64_t cpuTimeUs = (systemTime(CLOCK_THREAD_CPUTIME_ID) - startCpuTime) / 1000;
+        ATRACE_INSTANT_FOR_TRACK(ATRACE_COMPACTION_TRACK,
+                                 StringPrintf("Compacted %d: %" PRId64 " KB in %" PRId64
+                                              " us cpu (%" PRId64 " KB/cpu ms)",
+                                              pid, compactedBytes / 1024, cpuTimeUs,
+                                              compactedBytes * 1000 / 1024 /
+                                                      std::max<int64_t>(cpuTimeUs, 1))
+                                         .c_str());
+    }
+
+    // The counts from before compacting are kept, so that anything the process
+    // faulted back in while it was being compacted is picked up next time.
+    if (haveFaults) {
+        std::lock_guard<std::mutex> lock(compactionHistoryLock);
+        if (compactionHistory.size() >= MAX_COMPACTION_RECORDS &&
+            compactionHistory.count(pid) == 0) {
+            compactionHistory.clear();
+        }
+        compactionHistory[pid] = {startTime, faults, compactionFlags, inSystemCompaction};
     }
 }
 
@@ -458,10 +556,15 @@ static void compactProcessOrFallback(int pid, int compactionFlags) {
 // or potentially some mainline modules. The only process that should definitely
 // not be compacted is system_server, since compacting system_server around the
 // time of BOOT_COMPLETE could result in perceptible issues.
+//
+// Processes are compacted largest private RSS first, over SYSTEM_COMPACTION_THREADS
+// threads, so that most of the memory has been reclaimed by the time a cancelled
+// or slow run would have got to it serially.
 static void com_android_server_am_CachedAppOptimizer_compactSystem(JNIEnv *, jobject) {
     std::unique_ptr<DIR, decltype(&closedir)> proc(opendir("/proc"), closedir);
     struct dirent* current;
-    inSystemCompaction = true;
+    // Pairs of private resident pages and pid.
+    std::vector<std::pair<uint64_t, int>> candidates;
     while ((current = readdir(proc.get()))) {
         if (current->d_type != DT_DIR) {
             continue;
@@ -488,7 +591,35 @@ static void com_android_server_am_CachedAppOptimizer_compactSystem(JNIEnv *, job
 
         int pid = atoi(current->d_name);
 
-        compactProcessOrFallback(pid, COMPACT_ACTION_ANON_FLAG | COMPACT_ACTION_FILE_FLAG);
+        std::string statm;
+        uint64_t resident, shared;
+        if (!android::base::ReadFileToString(StringPrintf("/proc/%d/statm", pid), &statm) ||
+            sscanf(statm.c_str(), "%*u %" SCNu64 " %" SCNu64, &resident, &shared) != 2) {
+            continue;
+        }
+        if (resident == 0) {
+            // Kernel threads have no memory of their own to compact.
+            continue;
+        }
+        candidates.emplace_back(resident > shared ? resident - shared : 0, pid);
+    }
+    std::sort(candidates.begin(), candidates.end(), std::greater<>());
+
+    inSystemCompaction = true;
+    std::atomic<size_t> nextCandidate = 0;
+    auto compactCandidates = [&candidates, &nextCandidate]() {
+        for (size_t i; (i = nextCandidate++) < candidates.size();) {
+            compactProcessOrFallback(candidates[i].second,
+                                     COMPACT_ACTION_ANON_FLAG | COMPACT_ACTION_FILE_FLAG);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < SYSTEM_COMPACTION_THREADS; i++) {
+        workers.emplace_back(compactCandidates);
+    }
+    compactCandidates();
+    for (auto& worker : workers) {
+        worker.join();
     }
     inSystemCompaction = false;
 }
@@ -16,6 +16,7 @@
 
 #define LOG_TAG "LowMemDetector"
 
+#include <android-base/properties.h>
 #include <errno.h>
 #include <psi/psi.h>
 #include <string.h>
@@ -25,6 +26,8 @@
 #include <nativehelper/JNIHelp.h>
 #include <utils/Log.h>
 
+#include <algorithm>
+
 namespace android {
 
 enum pressure_levels {
@@ -35,49 +38,69 @@ enum pressure_levels {
     PRESSURE_LEVEL_COUNT = PRESSURE_HIGH
 };
 
-// amount of stall in us for each level
+// default amount of stall in us for each level, overridden by the
+// ro.lowmemdetector.psi_{low,medium,high}_stall_us properties
 static constexpr int PSI_LOW_STALL_US = 15000;
 static constexpr int PSI_MEDIUM_STALL_US = 30000;
 static constexpr int PSI_HIGH_STALL_US = 50000;
 
-// stall tracking window size in us
+// default stall tracking window size in us, overridden by the
+// ro.lowmemdetector.psi_window_us property. The kernel accepts 0.5s to 10s.
 static constexpr int PSI_WINDOW_SIZE_US = 1000000;
+static constexpr int PSI_MIN_WINDOW_SIZE_US = 500000;
+static constexpr int PSI_MAX_WINDOW_SIZE_US = 10000000;
 
 static int psi_epollfd = -1;
+static int psi_window_ms = PSI_WINDOW_SIZE_US / 1000;
+
+static int get_stall_property(const char* name, int default_us, int window_us) {
+    // A threshold that does not fit in the window would be rejected by the kernel.
+    return android::base::GetIntProperty(name, std::min(default_us, window_us), 1, window_us);
+}
 
 static jint android_server_am_LowMemDetector_init(JNIEnv*, jobject) {
     int epollfd;
     int low_psi_fd;
     int medium_psi_fd;
     int high_psi_fd;
-
-    epollfd = epoll_create(PRESSURE_LEVEL_COUNT);
+    int window_us = android::base::GetIntProperty("ro.lowmemdetector.psi_window_us",
+                                                  PSI_WINDOW_SIZE_US, PSI_MIN_WINDOW_SIZE_US,
+                                                  PSI_MAX_WINDOW_SIZE_US);
+    int low_stall_us = get_stall_property("ro.lowmemdetector.psi_low_stall_us",
+                                          PSI_LOW_STALL_US, window_us);
+    int medium_stall_us = get_stall_property("ro.lowmemdetector.psi_medium_stall_us",
+                                             PSI_MEDIUM_STALL_US, window_us);
+    int high_stall_us = get_stall_property("ro.lowmemdetector.psi_high_stall_us",
+                                           PSI_HIGH_STALL_US, window_us);
+
+    epollfd = epoll_create1(EPOLL_CLOEXEC);
     if (epollfd == -1) {
         ALOGE("epoll_create failed: %s", strerror(errno));
         return -1;
     }
 
-    low_psi_fd = init_psi_monitor(PSI_SOME, PSI_LOW_STALL_US, PSI_WINDOW_SIZE_US);
+    low_psi_fd = init_psi_monitor(PSI_SOME, low_stall_us, window_us);
     if (low_psi_fd < 0 ||
         register_psi_monitor(epollfd, low_psi_fd, (void*)PRESSURE_LOW) != 0) {
         goto low_fail;
     }
 
     medium_psi_fd =
-        init_psi_monitor(PSI_FULL, PSI_MEDIUM_STALL_US, PSI_WINDOW_SIZE_US);
+        init_psi_monitor(PSI_FULL, medium_stall_us, window_us);
     if (medium_psi_fd < 0 || register_psi_monitor(epollfd, medium_psi_fd,
                                                   (void*)PRESSURE_MEDIUM) != 0) {
         goto medium_fail;
     }
 
     high_psi_fd =
-        init_psi_monitor(PSI_FULL, PSI_HIGH_STALL_US, PSI_WINDOW_SIZE_US);
+        init_psi_monitor(PSI_FULL, high_stall_us, window_us);
     if (high_psi_fd < 0 ||
         register_psi_monitor(epollfd, high_psi_fd, (void*)PRESSURE_HIGH) != 0) {
         goto high_fail;
     }
 
     psi_epollfd = epollfd;
+    psi_window_ms = window_us / 1000;
     return 0;
 
 high_fail:
@@ -106,11 +129,12 @@ static jint android_server_am_LowMemDetector_waitForPressure(JNIEnv*, jobject) {
             nevents = epoll_wait(psi_epollfd, events, PRESSURE_LEVEL_COUNT, -1);
         } else {
             // This is simpler than lmkd. Assume that the memory pressure
-            // state will stay high for at least 1s. Within that 1s window,
-            // the memory pressure state can go up due to a different FD
-            // becoming available or it can go down when that window expires.
-            // Accordingly, there's no polling: just epoll_wait with a 1s timeout.
-            nevents = epoll_wait(psi_epollfd, events, PRESSURE_LEVEL_COUNT, 1000);
+            // state will stay high for at least one tracking window. Within
+            // that window, the memory pressure state can go up due to a
+            // different FD becoming available or it can go down when that
+            // window expires. Accordingly, there's no polling: just epoll_wait
+            // with the window as the timeout.
+            nevents = epoll_wait(psi_epollfd, events, PRESSURE_LEVEL_COUNT, psi_window_ms);
             if (nevents == 0) {
                 pressure_level = PRESSURE_NONE;
                 return pressure_level;
@@ -30,7 +30,9 @@
 #include <powermanager/PowerHintSessionWrapper.h>
 #include <utils/Log.h>
 
+#include <algorithm>
 #include <unordered_map>
+#include <vector>
 
 #include "jni.h"
 
@@ -218,13 +220,22 @@ static void nativeUpdateTargetWorkDuration(JNIEnv* /* env */, jclass /* clazz */
 
 static void nativeReportActualWorkDuration(JNIEnv* env, jclass /* clazz */, jlong session_ptr,
                                            jlongArray actualDurations, jlongArray timeStamps) {
-    ScopedLongArrayRO arrayActualDurations(env, actualDurations);
-    ScopedLongArrayRO arrayTimeStamps(env, timeStamps);
-
-    std::vector<hal::WorkDuration> actualList(arrayActualDurations.size());
-    for (size_t i = 0; i < arrayActualDurations.size(); i++) {
-        actualList[i].timeStampNanos = arrayTimeStamps[i];
-        actualList[i].durationNanos = arrayActualDurations[i];
+    // Reports arrive every frame, so the samples are copied into buffers reused across calls
+    // rather than pinning both arrays.
+    const jsize count =
+            std::min(env->GetArrayLength(actualDurations), env->GetArrayLength(timeStamps));
+    thread_local std::vector<jlong> durationsBuffer;
+    thread_local std::vector<jlong> timeStampsBuffer;
+    thread_local std::vector<hal::WorkDuration> actualList;
+    durationsBuffer.resize(count);
+    timeStampsBuffer.resize(count);
+    env->GetLongArrayRegion(actualDurations, 0, count, durationsBuffer.data());
+    env->GetLongArrayRegion(timeStamps, 0, count, timeStampsBuffer.data());
+
+    actualList.resize(count);
+    for (jsize i = 0; i < count; i++) {
+        actualList[i].timeStampNanos = timeStampsBuffer[i];
+        actualList[i].durationNanos = durationsBuffer[i];
     }
     reportActualWorkDuration(session_ptr, actualList);
 }
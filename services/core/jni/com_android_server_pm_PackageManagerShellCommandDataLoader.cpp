@@ -31,6 +31,7 @@
 
 #include <charconv>
 #include <chrono>
+#include <future>
 #include <span>
 #include <string>
 #include <thread>
@@ -415,6 +416,8 @@ private:
 
         std::vector<char> buffer;
         buffer.reserve(BUFFER_SIZE);
+        std::vector<char> spare;
+        spare.reserve(BUFFER_SIZE);
 
         std::vector<IncFsDataBlock> blocks;
         blocks.reserve(BLOCKS_COUNT);
@@ -445,7 +448,7 @@ private:
                     streamingMode = input.mode;
                 }
                 if (!copyToIncFs(incfsFd, input.size, input.kind, input.fd, input.waitOnEof,
-                                 &buffer, &blocks)) {
+                                 &buffer, &spare, &blocks)) {
                     ALOGE("Failed to copy data to IncFS file for metadata: %.*s, final file name "
                           "is: %s. "
                           "Error %d",
@@ -464,18 +467,26 @@ private:
         return true;
     }
 
+    // Reads into one buffer while the blocks of the other one are being written, so that the
+    // input pipe and IncFS (which verifies every block it gets) are kept busy at the same time.
     bool copyToIncFs(borrowed_fd incfsFd, IncFsSize size, IncFsBlockKind kind,
                      borrowed_fd incomingFd, bool waitOnEof, std::vector<char>* buffer,
-                     std::vector<IncFsDataBlock>* blocks) {
+                     std::vector<char>* spare, std::vector<IncFsDataBlock>* blocks) {
         IncFsSize remaining = size;
         IncFsBlockIndex blockIdx = 0;
+        std::future<bool> pendingWrite;
+        const auto finishPendingWrite = [&pendingWrite]() {
+            return !pendingWrite.valid() || pendingWrite.get();
+        };
         while (remaining > 0) {
             constexpr auto capacity = BUFFER_SIZE;
             auto size = buffer->size();
             if (capacity - size < INCFS_DATA_FILE_BLOCK_SIZE) {
-                if (!flashToIncFs(incfsFd, kind, false, &blockIdx, buffer, blocks)) {
+                if (!finishPendingWrite()) {
                     return false;
                 }
+                pendingWrite = flashToIncFsAsync(incfsFd, kind, false, &blockIdx, buffer, spare,
+                                                 blocks);
                 continue;
             }
 
@@ -483,11 +494,13 @@ private:
             buffer->resize(size + toRead);
             auto read = ::read(incomingFd.get(), buffer->data() + size, toRead);
             if (read == 0) {
+                buffer->resize(size);
                 if (waitOnEof) {
                     // eof of stdin, waiting...
                     if (doWaitOnEof()) {
                         continue;
                     } else {
+                        finishPendingWrite();
                         return false;
                     }
                 }
@@ -496,20 +509,32 @@ private:
             resetWaitOnEof();
 
             if (read < 0) {
+                finishPendingWrite();
                 return false;
             }
 
             buffer->resize(size + read);
             remaining -= read;
         }
-        if (!buffer->empty() && !flashToIncFs(incfsFd, kind, true, &blockIdx, buffer, blocks)) {
+        if (!finishPendingWrite()) {
             return false;
         }
+        if (!buffer->empty()) {
+            pendingWrite =
+                    flashToIncFsAsync(incfsFd, kind, true, &blockIdx, buffer, spare, blocks);
+            return finishPendingWrite();
+        }
         return true;
     }
 
-    bool flashToIncFs(borrowed_fd incfsFd, IncFsBlockKind kind, bool eof, IncFsBlockIndex* blockIdx,
-                      std::vector<char>* buffer, std::vector<IncFsDataBlock>* blocks) {
+    // Starts writing the complete blocks of *buffer (and the incomplete last one on eof), moving
+    // whatever is left over into *spare, and then swaps the two. The caller must not touch *spare
+    // or *blocks again until the returned future is ready.
+    std::future<bool> flashToIncFsAsync(borrowed_fd incfsFd, IncFsBlockKind kind, bool eof,
+                                        IncFsBlockIndex* blockIdx, std::vector<char>* buffer,
+                                        std::vector<char>* spare,
+                                        std::vector<IncFsDataBlock>* blocks) {
+        blocks->clear();
         int consumed = 0;
         const auto fullBlocks = buffer->size() / INCFS_DATA_FILE_BLOCK_SIZE;
         for (int i = 0; i < fullBlocks; ++i) {
@@ -538,16 +563,17 @@ private:
             consumed += remain;
         }
 
-        auto res = mIfs->writeBlocks({blocks->data(), blocks->size()});
-
-        blocks->clear();
-        buffer->erase(buffer->begin(), buffer->begin() + consumed);
+        spare->assign(buffer->begin() + consumed, buffer->end());
+        std::swap(*buffer, *spare);
 
-        if (res < 0) {
-            ALOGE("Failed to write block to IncFS: %d", int(res));
-            return false;
-        }
-        return true;
+        return std::async(std::launch::async, [this, blocks]() {
+            auto res = mIfs->writeBlocks({blocks->data(), blocks->size()});
+            if (res < 0) {
+                ALOGE("Failed to write block to IncFS: %d", int(res));
+                return false;
+            }
+            return true;
+        });
     }
 
     enum class WaitResult {
@@ -39,7 +39,7 @@ static int flatten(JNIEnv *env, const std::vector<std::vector<uint64_t>> &times,
 
 static int combineByBracket(JNIEnv *env, const std::vector<std::vector<uint64_t>> &times,
                             ScopedIntArrayRO &scopedScalingStepToPowerBracketMap,
-                            jlongArray outBrackets);
+                            std::vector<uint64_t> &brackets);
 
 static bool initialized = false;
 static jclass class_KernelCpuStatsCallback;
@@ -99,11 +99,16 @@ static jlong nativeReadCpuStats(JNIEnv *env, [[maybe_unused]] jobject zis, jobje
     auto data = android::bpf::getUidsUpdatedCpuFreqTimes(&newLastUpdate);
     if (!data.has_value()) return lastUpdateTimestampNanos;
 
+    // The brackets are accumulated natively and written to tempForUidStats with a single copy
+    // per UID, instead of pinning and copying the array back and forth for each one.
+    std::vector<uint64_t> brackets(env->GetArrayLength(tempForUidStats));
     for (auto &[uid, times] : *data) {
-        if (combineByBracket(env, times, scopedScalingStepToPowerBracketMap, tempForUidStats) ==
+        if (combineByBracket(env, times, scopedScalingStepToPowerBracketMap, brackets) ==
             EXCEPTION) {
             return 0L;
         }
+        env->SetLongArrayRegion(tempForUidStats, 0, brackets.size(),
+                                reinterpret_cast<const jlong *>(brackets.data()));
         env->CallVoidMethod(callback, method_KernelCpuStatsCallback_processUidStats, (jint)uid,
                             tempForUidStats);
     }
@@ -133,11 +138,9 @@ static int flatten(JNIEnv *env, const std::vector<std::vector<uint64_t>> &times,
 
 static int combineByBracket(JNIEnv *env, const std::vector<std::vector<uint64_t>> &times,
                             ScopedIntArrayRO &scopedScalingStepToPowerBracketMap,
-                            jlongArray outBrackets) {
-    ScopedLongArrayRW scopedOutBrackets(env, outBrackets);
-    uint64_t *brackets = reinterpret_cast<uint64_t *>(scopedOutBrackets.get());
-    const uint8_t statsSize = scopedOutBrackets.size();
-    memset(brackets, 0, statsSize * sizeof(uint64_t));
+                            std::vector<uint64_t> &brackets) {
+    const uint8_t statsSize = brackets.size();
+    std::fill(brackets.begin(), brackets.end(), 0);
     const uint8_t scalingStepCount = scopedScalingStepToPowerBracketMap.size();
 
     uint32_t scalingStep = 0;
@@ -991,10 +991,11 @@ class AnrTimerService::Ticker {
     // expires, the service will be notified with the id.
     void insert(nsecs_t scheduled, timer_id_t id, AnrTimerService *service) {
         Entry e(scheduled, id, service);
-        AutoMutex _l(lock_);
-        timer_id_t front = headTimerId();
+        CountedLock _l(this);
         running_.insert(e);
-        if (front != headTimerId()) restartLocked();
+        // The timerfd only needs to move if it would otherwise fire too late.  If it is armed
+        // for an earlier time, the monitor re-arms it for this entry once it gets there.
+        if (armed_ == 0 || scheduled < armed_) restartLocked();
         maxRunning_ = std::max(maxRunning_, running_.size());
     }
 
@@ -1003,7 +1004,7 @@ class AnrTimerService::Ticker {
     // efficient.
     void remove(nsecs_t scheduled, timer_id_t id) {
         Entry key(scheduled, id, 0);
-        AutoMutex _l(lock_);
+        CountedLock _l(this);
         timer_id_t front = headTimerId();
         auto found = running_.find(key);
         if (found != running_.end()) running_.erase(found);
@@ -1040,8 +1041,37 @@ class AnrTimerService::Ticker {
         return maxRunning_;
     }
 
+    // Return the number of times the timerfd was re-armed.
+    size_t restarted() const {
+        AutoMutex _l(lock_);
+        return restarted_;
+    }
+
+    // Return the number of times a timer insert, removal, or expiration had to wait for the
+    // lock.
+    size_t contended() const {
+        return contended_;
+    }
+
   private:
 
+    // An AutoMutex for lock_ that counts the acquisitions that had to wait for another thread.
+    // It is used on the paths that every timer takes.
+    class CountedLock {
+      public:
+        explicit CountedLock(const Ticker* ticker) : lock_(ticker->lock_) {
+            if (lock_.tryLock() != NO_ERROR) {
+                ticker->contended_++;
+                lock_.lock();
+            }
+        }
+        ~CountedLock() {
+            lock_.unlock();
+        }
+      private:
+        Mutex& lock_;
+    };
+
     // Return the head of the running list.  The lock must be held by the caller.
     timer_id_t headTimerId() {
         return running_.empty() ? NOTIMER : running_.cbegin()->id;
@@ -1065,7 +1095,9 @@ class AnrTimerService::Ticker {
             nsecs_t current = now();
             std::vector<Entry> ready;
             {
-                AutoMutex _l(lock_);
+                CountedLock _l(this);
+                // The timerfd is one-shot, so it is no longer armed.
+                armed_ = 0;
                 while (!running_.empty()) {
                     Entry timer = *(running_.begin());
                     if (timer.scheduled <= current) {
@@ -1104,6 +1136,7 @@ class AnrTimerService::Ticker {
                 .it_value = { sec, ns },
             };
             timer_settime(timerFd_, 0, &setting, nullptr);
+            armed_ = x.scheduled;
             restarted_++;
             ALOGI_IF(DEBUG_TICKER, "restarted timerfd for %ld.%09ld", sec, ns);
         } else {
@@ -1112,6 +1145,7 @@ class AnrTimerService::Ticker {
                 .it_value = { 0, 0 },
             };
             timer_settime(timerFd_, 0, &setting, nullptr);
+            armed_ = 0;
             drained_++;
             ALOGI_IF(DEBUG_TICKER, "drained timer list");
         }
@@ -1137,6 +1171,13 @@ class AnrTimerService::Ticker {
     // The number of times the timer list was exhausted.
     size_t drained_ = 0;
 
+    // The time the timerfd is armed for, or zero if it is not armed.  A timerfd armed for an
+    // entry that has since been removed is left alone; it fires early and is re-armed then.
+    nsecs_t armed_ = 0;
+
+    // The number of times the lock was contended.  This is updated before the lock is held.
+    mutable std::atomic<size_t> contended_ = 0;
+
     // The highwater mark of timers that are running.
     size_t maxRunning_ = 0;
 
@@ -1360,10 +1401,12 @@ std::vector<std::string> AnrTimerService::getDump() const {
     r.push_back(StringPrintf("released:%zu releasing:%zu",
                              counters_.released,
                              expired_.size()));
-    r.push_back(StringPrintf("ticker:%zu ticking:%zu maxTicking:%zu",
+    r.push_back(StringPrintf("ticker:%zu ticking:%zu maxTicking:%zu restarted:%zu contended:%zu",
                              ticker_->id(),
                              ticker_->running(),
-                             ticker_->maxRunning()));
+                             ticker_->maxRunning(),
+                             ticker_->restarted(),
+                             ticker_->contended()));
     return r;
 }
 
@@ -349,9 +349,12 @@ static jlong vibratorPerformComposedEffect(JNIEnv* env, jclass /* clazz */, jlon
     }
     size_t size = env->GetArrayLength(composition);
     std::vector<Aidl::CompositeEffect> effects;
+    effects.reserve(size);
     for (size_t i = 0; i < size; i++) {
         jobject element = env->GetObjectArrayElement(composition, i);
         effects.push_back(effectFromJavaPrimitive(env, element));
+        // Long compositions would otherwise hold a local reference per segment until return.
+        env->DeleteLocalRef(element);
     }
     auto callback = wrapper->createCallback(vibrationId);
     auto performComposedEffectFn = [&effects, &callback](vibrator::HalWrapper* hal) {
@@ -372,10 +375,13 @@ static jlong vibratorPerformPwleEffect(JNIEnv* env, jclass /* clazz */, jlong pt
     Aidl::Braking braking = static_cast<Aidl::Braking>(brakingId);
     size_t size = env->GetArrayLength(waveform);
     std::vector<Aidl::PrimitivePwle> primitives;
+    // Braking can add at most one extra primitive, at the end.
+    primitives.reserve(size + 1);
     std::chrono::milliseconds totalDuration(0);
     for (size_t i = 0; i < size; i++) {
         jobject element = env->GetObjectArrayElement(waveform, i);
         Aidl::ActivePwle activePwle = activePwleFromJavaPrimitive(env, element);
+        env->DeleteLocalRef(element);
         if ((i > 0) && shouldBeReplacedWithBraking(activePwle, braking)) {
             primitives.push_back(brakingPwle(braking, activePwle.duration));
         } else {
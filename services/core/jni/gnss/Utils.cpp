@@ -22,6 +22,14 @@
 #include <android/hardware/gnss/2.0/IGnss.h>
 #include <android_location_flags.h>
 #include <utils/SystemClock.h>
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+
 /*
  * Save a pointer to JavaVm to attach/detach threads executing
  * callback methods that need to make JNI calls.
@@ -86,6 +94,32 @@ const char* const JavaMethodHelper<jstring>::signature_ = "(Ljava/lang/String;)V
 template <>
 const char* const JavaMethodHelper<jdoubleArray>::signature_ = "([D)V";
 
+// The setters are called by name for every field of every measurement, clock and navigation
+// message, which adds up to thousands of GetMethodID() calls a second with a multi-band receiver.
+jmethodID getCachedMethodID(JNIEnv* env, jclass clazz, const char* method_name,
+                            const char* signature) {
+    using Key = std::tuple<jclass, std::string_view, std::string_view>;
+    static std::mutex lock;
+    static std::map<Key, jmethodID> methods;
+    // Backing storage for the names in the keys; deque elements do not move.
+    static std::deque<std::string> names;
+
+    std::lock_guard<std::mutex> guard(lock);
+    auto found = methods.find(Key(clazz, method_name, signature));
+    if (found != methods.end()) {
+        return found->second;
+    }
+    jmethodID method = env->GetMethodID(clazz, method_name, signature);
+    if (method == nullptr) {
+        // Leave the pending NoSuchMethodError to the caller, as before.
+        return nullptr;
+    }
+    const std::string& name = names.emplace_back(method_name);
+    const std::string& sig = names.emplace_back(signature);
+    methods.emplace(Key(clazz, name, sig), method);
+    return method;
+}
+
 jboolean checkAidlStatus(const android::binder::Status& status, const char* errorMessage) {
     if (!status.isOk()) {
         ALOGE("%s AIDL transport error: %s", errorMessage, status.toString8().c_str());
@@ -142,7 +176,7 @@ template <>
 void JavaObject::callSetter(const char* method_name, uint8_t* value, size_t size) {
     jbyteArray array = env_->NewByteArray(size);
     env_->SetByteArrayRegion(array, 0, size, reinterpret_cast<jbyte*>(value));
-    jmethodID method = env_->GetMethodID(clazz_, method_name, "([B)V");
+    jmethodID method = getCachedMethodID(env_, clazz_, method_name, "([B)V");
     env_->CallVoidMethod(object_, method, array);
     env_->DeleteLocalRef(array);
 }
@@ -76,9 +76,10 @@ AStatsManager_PullAtomCallbackReturn SurfaceFlingerPuller::parseGlobalInfoPull(
         return AStatsManager_PULL_SKIP;
     }
 
+    // The strings must outlive the BytesFields, which only have a pointer to the data. They are
+    // reused across atoms, since addAStatsEvent() copies the bytes into the event.
+    std::string frameDurationStr, renderEngineTimeStr, deadlineMissesStr, predictionErrorsStr;
     for (const auto& atom : atomList.atom()) {
-        // The strings must outlive the BytesFields, which only have a pointer to the data.
-        std::string frameDurationStr, renderEngineTimeStr, deadlineMissesStr, predictionErrorsStr;
         optional<BytesField> frameDuration = getBytes(atom.frame_duration(), frameDurationStr);
         optional<BytesField> renderEngineTime =
                 getBytes(atom.render_engine_timing(), renderEngineTimeStr);
@@ -119,11 +120,12 @@ AStatsManager_PullAtomCallbackReturn SurfaceFlingerPuller::parseLayerInfoPull(
         return AStatsManager_PULL_SKIP;
     }
 
+    // The strings must outlive the BytesFields, which only have a pointer to the data. They are
+    // reused across layers, since addAStatsEvent() copies the bytes into the event.
+    std::string present2PresentStr, post2presentStr, acquire2PresentStr, latch2PresentStr,
+            desired2PresentStr, post2AcquireStr, frameRateVoteStr, appDeadlineMissesStr,
+            present2PresentDeltaStr;
     for (const auto& atom : atomList.atom()) {
-        // The strings must outlive the BytesFields, which only have a pointer to the data.
-        std::string present2PresentStr, post2presentStr, acquire2PresentStr, latch2PresentStr,
-                desired2PresentStr, post2AcquireStr, frameRateVoteStr, appDeadlineMissesStr,
-                present2PresentDeltaStr;
         optional<BytesField> present2Present =
                 getBytes(atom.present_to_present(), present2PresentStr);
         optional<BytesField> present2PresentDelta =
@@ -16,9 +16,12 @@
 #ifndef AAPT_DIAGNOSTICS_H_
 #define AAPT_DIAGNOSTICS_H_
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "android-base/macros.h"
 #include "androidfw/IDiagnostics.h"
@@ -29,7 +32,10 @@
 namespace aapt {
 class StdErrDiagnostics : public android::IDiagnostics {
  public:
-  StdErrDiagnostics() = default;
+  // Messages go to `out` instead of std::cerr when given, e.g. to keep the output of requests that
+  // run concurrently apart.
+  explicit StdErrDiagnostics(std::ostream* out = &std::cerr) : out_(out) {
+  }
 
   void Log(Level level, android::DiagMessageActual& actual_msg) override {
     const char* tag;
@@ -53,17 +59,52 @@ class StdErrDiagnostics : public android::IDiagnostics {
     }
 
     if (!actual_msg.source.path.empty()) {
-      std::cerr << actual_msg.source << ": ";
+      *out_ << actual_msg.source << ": ";
     }
-    std::cerr << tag << ": " << actual_msg.message << "." << std::endl;
+    *out_ << tag << ": " << actual_msg.message << "." << std::endl;
   }
 
  private:
+  std::ostream* out_;
   size_t num_errors_ = 0;
 
   DISALLOW_COPY_AND_ASSIGN(StdErrDiagnostics);
 };
 
+// Records diagnostics so they can be replayed later in a deterministic order, e.g. the input order
+// of work that was spread across threads.
+class BufferedDiagnostics : public android::IDiagnostics {
+ public:
+  explicit BufferedDiagnostics(android::IDiagnostics* target) : target_(target) {
+  }
+
+  void Log(Level level, android::DiagMessageActual& actual_msg) override {
+    messages_.emplace_back(level, actual_msg);
+  }
+
+  bool IsVerbose() override {
+    return target_->IsVerbose();
+  }
+
+  bool HadWarningsOrErrors() const {
+    return std::any_of(messages_.begin(), messages_.end(),
+                       [](const auto& message) { return message.first != Level::Note; });
+  }
+
+  void Replay() {
+    for (auto& [level, message] : messages_) {
+      target_->Log(level, message);
+    }
+    messages_.clear();
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(BufferedDiagnostics);
+
+  android::IDiagnostics* target_;
+  std::vector<std::pair<Level, android::DiagMessageActual>> messages_;
+};
+
 }  // namespace aapt
 
 #endif /* AAPT_DIAGNOSTICS_H_ */
@@ -72,8 +72,27 @@ static ApkFormat DetermineApkFormat(io::IFileCollection* apk) {
   }
 }
 
+static std::unique_ptr<ResourceTable> ParseBinaryTable(const android::Source& source,
+                                                       io::IFile* table_file,
+                                                       io::IFileCollection* collection,
+                                                       android::IDiagnostics* diag) {
+  // Stored entries are memory mapped rather than copied out of the APK.
+  std::unique_ptr<io::IData> data = table_file->OpenAsData();
+  if (data == nullptr) {
+    diag->Error(android::DiagMessage(source) << "failed to open " << kApkResourceTablePath);
+    return {};
+  }
+  auto table = util::make_unique<ResourceTable>(ResourceTable::Validation::kDisabled);
+  BinaryResourceParser parser(diag, table.get(), source, data->data(), data->size(), collection);
+  if (!parser.Parse()) {
+    return {};
+  }
+  return table;
+}
+
 std::unique_ptr<LoadedApk> LoadedApk::LoadApkFromPath(StringPiece path,
-                                                      android::IDiagnostics* diag) {
+                                                      android::IDiagnostics* diag,
+                                                      TableLoading table_loading) {
   android::Source source(path);
   std::string error;
   std::unique_ptr<io::ZipFileCollection> apk = io::ZipFileCollection::Create(path, &error);
@@ -85,7 +104,7 @@ std::unique_ptr<LoadedApk> LoadedApk::LoadApkFromPath(StringPiece path,
   ApkFormat apkFormat = DetermineApkFormat(apk.get());
   switch (apkFormat) {
     case ApkFormat::kBinary:
-      return LoadBinaryApkFromFileCollection(source, std::move(apk), diag);
+      return LoadBinaryApkFromFileCollection(source, std::move(apk), diag, table_loading);
     case ApkFormat::kProto:
       return LoadProtoApkFromFileCollection(source, std::move(apk), diag);
     default:
@@ -155,20 +174,13 @@ std::unique_ptr<LoadedApk> LoadedApk::LoadProtoApkFromFileCollection(
 
 std::unique_ptr<LoadedApk> LoadedApk::LoadBinaryApkFromFileCollection(
     const android::Source& source, unique_ptr<io::IFileCollection> collection,
-    android::IDiagnostics* diag) {
+    android::IDiagnostics* diag, TableLoading table_loading) {
   std::unique_ptr<ResourceTable> table;
 
   io::IFile* table_file = collection->FindFile(kApkResourceTablePath);
-  if (table_file != nullptr) {
-    table = util::make_unique<ResourceTable>(ResourceTable::Validation::kDisabled);
-    std::unique_ptr<io::IData> data = table_file->OpenAsData();
-    if (data == nullptr) {
-      diag->Error(android::DiagMessage(source) << "failed to open " << kApkResourceTablePath);
-      return {};
-    }
-    BinaryResourceParser parser(diag, table.get(), source, data->data(), data->size(),
-                                collection.get());
-    if (!parser.Parse()) {
+  if (table_file != nullptr && table_loading == TableLoading::kEager) {
+    table = ParseBinaryTable(source, table_file, collection.get(), diag);
+    if (table == nullptr) {
       return {};
     }
   }
@@ -193,14 +205,29 @@ std::unique_ptr<LoadedApk> LoadedApk::LoadBinaryApkFromFileCollection(
                 << "failed to parse binary " << kAndroidManifestPath << ": " << error);
     return {};
   }
-  return util::make_unique<LoadedApk>(source, std::move(collection), std::move(table),
-                                      std::move(manifest), ApkFormat::kBinary);
+  auto apk = util::make_unique<LoadedApk>(source, std::move(collection), std::move(table),
+                                          std::move(manifest), ApkFormat::kBinary);
+  if (table_loading == TableLoading::kLazy) {
+    apk->lazy_table_file_ = table_file;
+    apk->lazy_table_diag_ = diag;
+  }
+  return apk;
+}
+
+void LoadedApk::LoadLazyTable() const {
+  if (lazy_table_file_ == nullptr) {
+    return;
+  }
+  io::IFile* table_file = lazy_table_file_;
+  lazy_table_file_ = nullptr;
+  table_ = ParseBinaryTable(source_, table_file, apk_.get(), lazy_table_diag_);
+  lazy_table_failed_ = table_ == nullptr;
 }
 
 bool LoadedApk::WriteToArchive(IAaptContext* context, const TableFlattenerOptions& options,
                                IArchiveWriter* writer) {
   FilterChain empty;
-  return WriteToArchive(context, table_.get(), options, &empty, writer);
+  return WriteToArchive(context, GetResourceTable(), options, &empty, writer);
 }
 
 bool LoadedApk::WriteToArchive(IAaptContext* context, ResourceTable* split_table,
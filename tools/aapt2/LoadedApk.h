@@ -39,12 +39,23 @@ enum ApkFormat {
   kProto,
 };
 
+// When the resources.arsc of a binary APK is parsed.
+enum class TableLoading {
+  // While the APK is loaded. A malformed table fails the load.
+  kEager,
+  // On the first call to GetResourceTable(). Commands that only read the manifest or the raw files
+  // never parse the table. Parse errors are reported to the diagnostics given at load time, and
+  // GetResourceTable() then returns nullptr.
+  kLazy,
+};
+
 // Info about an APK loaded in memory.
 class LoadedApk final {
  public:
   // Loads both binary and proto APKs from disk.
-  static std::unique_ptr<LoadedApk> LoadApkFromPath(android::StringPiece path,
-                                                    android::IDiagnostics* diag);
+  static std::unique_ptr<LoadedApk> LoadApkFromPath(
+      android::StringPiece path, android::IDiagnostics* diag,
+      TableLoading table_loading = TableLoading::kEager);
 
   // Loads a proto APK from the given file collection.
   static std::unique_ptr<LoadedApk> LoadProtoApkFromFileCollection(
@@ -54,7 +65,7 @@ class LoadedApk final {
   // Loads a binary APK from the given file collection.
   static std::unique_ptr<LoadedApk> LoadBinaryApkFromFileCollection(
       const android::Source& source, std::unique_ptr<io::IFileCollection> collection,
-      android::IDiagnostics* diag);
+      android::IDiagnostics* diag, TableLoading table_loading = TableLoading::kEager);
 
   LoadedApk(const android::Source& source, std::unique_ptr<io::IFileCollection> apk,
             std::unique_ptr<ResourceTable> table, std::unique_ptr<xml::XmlResource> manifest,
@@ -75,13 +86,20 @@ class LoadedApk final {
   }
 
   const ResourceTable* GetResourceTable() const {
+    LoadLazyTable();
     return table_.get();
   }
 
   ResourceTable* GetResourceTable() {
+    LoadLazyTable();
     return table_.get();
   }
 
+  // Whether a lazily loaded resource table failed to parse.
+  bool FailedToLoadResourceTable() const {
+    return lazy_table_failed_;
+  }
+
   const android::Source& GetSource() {
     return source_;
   }
@@ -117,11 +135,19 @@ class LoadedApk final {
  private:
   DISALLOW_COPY_AND_ASSIGN(LoadedApk);
 
+  // Parses the table deferred by TableLoading::kLazy, if it has not been parsed yet.
+  void LoadLazyTable() const;
+
   android::Source source_;
   std::unique_ptr<io::IFileCollection> apk_;
-  std::unique_ptr<ResourceTable> table_;
+  mutable std::unique_ptr<ResourceTable> table_;
   std::unique_ptr<xml::XmlResource> manifest_;
   ApkFormat format_;
+
+  // The resources.arsc still to be parsed, and where to report errors when it is.
+  mutable io::IFile* lazy_table_file_ = nullptr;
+  android::IDiagnostics* lazy_table_diag_ = nullptr;
+  mutable bool lazy_table_failed_ = false;
 };
 
 }  // namespace aapt
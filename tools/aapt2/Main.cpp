@@ -21,10 +21,17 @@
 // clang-format on
 #endif
 
+#include <condition_variable>
+#include <deque>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
 #include <vector>
 
 #include "Diagnostics.h"
+#include "android-base/parseint.h"
 #include "android-base/stringprintf.h"
 #include "android-base/utf8.h"
 #include "androidfw/FileStream.h"
@@ -38,8 +45,12 @@
 #include "cmd/Dump.h"
 #include "cmd/Link.h"
 #include "cmd/Optimize.h"
+#include "io/StringStream.h"
+#include "io/Util.h"
+#include "process/ApkAssetsCache.h"
 #include "trace/TraceBuffer.h"
 #include "util/Files.h"
+#include "util/ThreadPool.h"
 #include "util/Util.h"
 
 using ::android::StringPiece;
@@ -91,11 +102,112 @@ class MainCommand : public Command {
   android::IDiagnostics* diagnostics_;
 };
 
+/*
+ * Runs daemon requests on a thread pool. Every request prints into its own buffers, which are
+ * copied to stdout and stderr in the order the requests were received, so that responses can be
+ * matched to requests exactly as in the serial daemon.
+ */
+class ConcurrentRequestRunner {
+ public:
+  ConcurrentRequestRunner(size_t jobs, android::FileOutputStream* out)
+      : out_(out), pool_(jobs), writer_([this]() { WriteResponses(); }) {
+  }
+
+  // Finishes every posted request and writes the remaining responses.
+  ~ConcurrentRequestRunner() {
+    pool_.Wait();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      finished_ = true;
+    }
+    response_ready_.notify_one();
+    writer_.join();
+  }
+
+  void Post(std::vector<std::string> raw_args) {
+    auto response = std::make_shared<Response>();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      responses_.push_back(response);
+    }
+    pool_.Post([this, response, raw_args = std::move(raw_args)]() {
+      std::vector<StringPiece> args(raw_args.begin(), raw_args.end());
+      std::string out;
+      std::ostringstream err;
+      int result;
+      {
+        io::StringOutputStream out_stream(&out);
+        text::Printer printer(&out_stream);
+        StdErrDiagnostics diagnostics(&err);
+        result = MainCommand(&printer, &diagnostics).Execute(args, &err);
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        response->out = std::move(out);
+        response->err = err.str();
+        response->failed = result != 0;
+        response->done = true;
+      }
+      response_ready_.notify_one();
+    });
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ConcurrentRequestRunner);
+
+  struct Response {
+    std::string out;
+    std::string err;
+    bool failed = false;
+    bool done = false;
+  };
+
+  void WriteResponses() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      response_ready_.wait(lock, [this]() {
+        return (!responses_.empty() && responses_.front()->done) || finished_;
+      });
+      if (responses_.empty()) {
+        return;
+      }
+      std::shared_ptr<Response> response = std::move(responses_.front());
+      responses_.pop_front();
+      lock.unlock();
+
+      io::Copy(out_, response->out);
+      out_->Flush();
+      std::cerr << response->err;
+      if (response->failed) {
+        std::cerr << "Error" << std::endl;
+      }
+      std::cerr << "Done" << std::endl;
+
+      lock.lock();
+    }
+  }
+
+  android::FileOutputStream* out_;
+  ThreadPool pool_;
+
+  std::mutex mutex_;
+  std::condition_variable response_ready_;
+  std::deque<std::shared_ptr<Response>> responses_;
+  bool finished_ = false;
+
+  // Started last, once everything it reads is constructed.
+  std::thread writer_;
+};
+
 /*
  * Run in daemon mode. The first line of input is the command. This can be 'quit' which ends
  * the daemon mode. Each subsequent line is a single parameter to the command. The end of a
  * invocation is signaled by providing an empty line. At any point, an EOF signal or the
  * command 'quit' will end the daemon mode.
+ *
+ * Include APKs loaded by a link stay cached for the links that follow. With -j, requests run
+ * concurrently and their responses are written in the order the requests were received.
  */
 class DaemonCommand : public Command {
  public:
@@ -105,11 +217,33 @@ class DaemonCommand : public Command {
         "command. The end of an invocation is signaled by providing an empty line.");
     AddOptionalFlag("--trace_folder", "Generate systrace json trace fragment to specified folder.",
                     &trace_folder_);
+    AddOptionalFlag("-j",
+                    "Number of requests to run at the same time. Defaults to 1, 0 uses one\n"
+                    "thread per CPU core. Responses keep the order of the requests, so a\n"
+                    "client may send several requests before reading the first response.",
+                    &jobs_);
   }
 
   int Action(const std::vector<std::string>& arguments) override {
     TRACE_FLUSH_ARGS(trace_folder_ ? trace_folder_.value() : "", "daemon", arguments);
+    size_t jobs = 1;
+    if (jobs_ && !android::base::ParseUint(jobs_.value(), &jobs)) {
+      diagnostics_->Error(android::DiagMessage() << "invalid value for -j: '" << jobs_.value()
+                                                 << "'");
+      return 1;
+    }
+    if (jobs == 0) {
+      jobs = ThreadPool::GetDefaultThreadCount();
+    }
+
+    // Keep android.jar and the other includes parsed across links.
+    ApkAssetsCache::GetInstance()->SetEnabled(true);
+
     text::Printer printer(out_);
+    std::unique_ptr<ConcurrentRequestRunner> runner;
+    if (jobs > 1) {
+      runner = util::make_unique<ConcurrentRequestRunner>(jobs, out_);
+    }
     std::cout << "Ready" << std::endl;
 
     while (true) {
@@ -132,6 +266,11 @@ class DaemonCommand : public Command {
         break;
       }
 
+      if (runner) {
+        runner->Post(std::move(raw_args));
+        continue;
+      }
+
       std::vector<StringPiece> args;
       args.insert(args.end(), raw_args.begin(), raw_args.end());
       int result = MainCommand(&printer, diagnostics_).Execute(args, &std::cerr);
@@ -141,6 +280,7 @@ class DaemonCommand : public Command {
       }
       std::cerr << "Done" << std::endl;
     }
+    runner.reset();
     std::cout << "Exiting daemon" << std::endl;
 
     return 0;
@@ -150,6 +290,7 @@ class DaemonCommand : public Command {
   android::FileOutputStream* out_;
   android::IDiagnostics* diagnostics_;
   std::optional<std::string> trace_folder_;
+  std::optional<std::string> jobs_;
 };
 
 }  // namespace aapt
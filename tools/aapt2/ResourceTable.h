@@ -34,6 +34,7 @@
 #include "androidfw/StringPiece.h"
 #include "androidfw/StringPool.h"
 #include "io/File.h"
+#include "util/SlabAllocator.h"
 
 using PolicyFlags = android::ResTable_overlayable_policy_header::PolicyFlags;
 
@@ -93,7 +94,7 @@ struct OverlayableItem {
   android::Source source;
 };
 
-class ResourceConfigValue {
+class ResourceConfigValue : public SlabAllocated {
  public:
   // The configuration for which this value is defined.
   const android::ConfigDescription config;
@@ -113,7 +114,7 @@ class ResourceConfigValue {
 };
 
 // Represents a resource entry, which may have varying values for each defined configuration.
-class ResourceEntry {
+class ResourceEntry : public SlabAllocated {
  public:
   // The name of the resource. Immutable, as this determines the order of this resource
   // when doing lookups.
@@ -29,6 +29,7 @@
 #include "ResourceUtils.h"
 #include "ValueVisitor.h"
 #include "util/Util.h"
+#include "utils/JenkinsHash.h"
 
 using ::aapt::text::Printer;
 using ::android::StringPiece;
@@ -36,6 +37,18 @@ using ::android::base::StringPrintf;
 
 namespace aapt {
 
+static uint32_t HashString(const std::string& str) {
+  return static_cast<uint32_t>(std::hash<std::string>()(str));
+}
+
+static uint32_t HashSections(uint32_t hash, const std::vector<UntranslatableSection>& sections) {
+  for (const UntranslatableSection& section : sections) {
+    hash = android::JenkinsHashMix(hash, static_cast<uint32_t>(section.start));
+    hash = android::JenkinsHashMix(hash, static_cast<uint32_t>(section.end));
+  }
+  return hash;
+}
+
 void Value::PrettyPrint(Printer* printer) const {
   std::ostringstream str_stream;
   Print(&str_stream);
@@ -86,6 +99,10 @@ bool RawString::Equals(const Value* value) const {
   return *this->value == *other->value;
 }
 
+size_t RawString::Hash() const {
+  return HashString(*value);
+}
+
 bool RawString::Flatten(android::Res_value* out_value) const {
   out_value->dataType = android::Res_value::TYPE_STRING;
   out_value->data = android::util::HostToDevice32(static_cast<uint32_t>(value.index()));
@@ -116,6 +133,15 @@ bool Reference::Equals(const Value* value) const {
          id == other->id && name == other->name && type_flags == other->type_flags;
 }
 
+size_t Reference::Hash() const {
+  uint32_t hash = static_cast<uint32_t>(reference_type);
+  hash = android::JenkinsHashMix(hash, private_reference);
+  hash = android::JenkinsHashMix(hash, id.value_or(ResourceId(0)).id);
+  hash = android::JenkinsHashMix(
+      hash, name ? static_cast<uint32_t>(std::hash<ResourceName>()(name.value())) : 0u);
+  return android::JenkinsHashMix(hash, type_flags.value_or(0u));
+}
+
 bool Reference::Flatten(android::Res_value* out_value) const {
   if (name && name.value().type.type == ResourceType::kMacro) {
     return false;
@@ -215,6 +241,10 @@ bool Id::Equals(const Value* value) const {
   return ValueCast<Id>(value) != nullptr;
 }
 
+size_t Id::Hash() const {
+  return 0u;
+}
+
 bool Id::Flatten(android::Res_value* out) const {
   out->dataType = android::Res_value::TYPE_INT_BOOLEAN;
   out->data = android::util::HostToDevice32(0);
@@ -252,6 +282,10 @@ bool String::Equals(const Value* value) const {
   return true;
 }
 
+size_t String::Hash() const {
+  return HashSections(HashString(*value), untranslatable_sections);
+}
+
 bool String::Flatten(android::Res_value* out_value) const {
   // Verify that our StringPool index is within encode-able limits.
   if (value.index() > std::numeric_limits<uint32_t>::max()) {
@@ -300,6 +334,15 @@ bool StyledString::Equals(const Value* value) const {
   return true;
 }
 
+size_t StyledString::Hash() const {
+  uint32_t hash = HashString(value->value);
+  for (const android::StringPool::Span& span : value->spans) {
+    hash = android::JenkinsHashMix(hash, span.first_char);
+    hash = android::JenkinsHashMix(hash, span.last_char);
+  }
+  return HashSections(hash, untranslatable_sections);
+}
+
 bool StyledString::Flatten(android::Res_value* out_value) const {
   if (value.index() > std::numeric_limits<uint32_t>::max()) {
     return false;
@@ -328,6 +371,10 @@ bool FileReference::Equals(const Value* value) const {
   return path == other->path;
 }
 
+size_t FileReference::Hash() const {
+  return HashString(*path);
+}
+
 bool FileReference::Flatten(android::Res_value* out_value) const {
   if (path.index() > std::numeric_limits<uint32_t>::max()) {
     return false;
@@ -372,6 +419,10 @@ bool BinaryPrimitive::Equals(const Value* value) const {
          this->value.data == other->value.data;
 }
 
+size_t BinaryPrimitive::Hash() const {
+  return android::JenkinsHashMix(value.dataType, value.data);
+}
+
 bool BinaryPrimitive::Flatten(::android::Res_value* out_value) const {
   out_value->dataType = value.dataType;
   out_value->data = android::util::HostToDevice32(value.data);
@@ -558,6 +609,18 @@ bool Attribute::Equals(const Value* value) const {
                     });
 }
 
+size_t Attribute::Hash() const {
+  uint32_t hash = android::JenkinsHashMix(type_mask, static_cast<uint32_t>(min_int));
+  hash = android::JenkinsHashMix(hash, static_cast<uint32_t>(max_int));
+  // Equals() ignores the order of the symbols, so they are summed rather than mixed in sequence.
+  uint32_t symbols_hash = 0u;
+  for (const Symbol& symbol : symbols) {
+    symbols_hash += android::JenkinsHashMix(static_cast<uint32_t>(symbol.symbol.Hash()),
+                                            symbol.value);
+  }
+  return android::JenkinsHashMix(hash, symbols_hash);
+}
+
 bool Attribute::IsCompatibleWith(const Attribute& attr) const {
   // If the high bits are set on any of these attribute type masks, then they are incompatible.
   // We don't check that flags and enums are identical.
@@ -878,6 +941,17 @@ bool Style::Equals(const Value* value) const {
                     });
 }
 
+size_t Style::Hash() const {
+  uint32_t hash = parent ? static_cast<uint32_t>(parent.value().Hash()) : 0u;
+  // Equals() ignores the order of the entries, so they are summed rather than mixed in sequence.
+  uint32_t entries_hash = 0u;
+  for (const Entry& entry : entries) {
+    entries_hash += android::JenkinsHashMix(static_cast<uint32_t>(entry.key.Hash()),
+                                            static_cast<uint32_t>(entry.value->Hash()));
+  }
+  return android::JenkinsHashMix(hash, entries_hash);
+}
+
 void Style::Print(std::ostream* out) const {
   *out << "(style) ";
   if (parent && parent.value().name) {
@@ -967,6 +1041,14 @@ bool Array::Equals(const Value* value) const {
                     });
 }
 
+size_t Array::Hash() const {
+  uint32_t hash = static_cast<uint32_t>(elements.size());
+  for (const std::unique_ptr<Item>& element : elements) {
+    hash = android::JenkinsHashMix(hash, static_cast<uint32_t>(element->Hash()));
+  }
+  return hash;
+}
+
 void Array::Print(std::ostream* out) const {
   *out << "(array) [" << util::Joiner(elements, ", ") << "]";
 }
@@ -1004,6 +1086,14 @@ bool Plural::Equals(const Value* value) const {
   return true;
 }
 
+size_t Plural::Hash() const {
+  uint32_t hash = 0u;
+  for (const std::unique_ptr<Item>& item : values) {
+    hash = android::JenkinsHashMix(hash, item ? static_cast<uint32_t>(item->Hash()) : 0u);
+  }
+  return hash;
+}
+
 void Plural::Print(std::ostream* out) const {
   *out << "(plural)";
   if (values[Zero]) {
@@ -1047,6 +1137,14 @@ bool Styleable::Equals(const Value* value) const {
                     });
 }
 
+size_t Styleable::Hash() const {
+  uint32_t hash = static_cast<uint32_t>(entries.size());
+  for (const Reference& entry : entries) {
+    hash = android::JenkinsHashMix(hash, static_cast<uint32_t>(entry.Hash()));
+  }
+  return hash;
+}
+
 void Styleable::Print(std::ostream* out) const {
   *out << "(styleable) "
        << " [" << util::Joiner(entries, ", ") << "]";
@@ -1063,6 +1161,11 @@ bool Macro::Equals(const Value* value) const {
          other->alias_namespaces == alias_namespaces;
 }
 
+size_t Macro::Hash() const {
+  uint32_t hash = android::JenkinsHashMix(HashString(raw_value), HashString(style_string.str));
+  return HashSections(hash, untranslatable_sections);
+}
+
 void Macro::Print(std::ostream* out) const {
   *out << "(macro) ";
 }
@@ -30,6 +30,7 @@
 #include "androidfw/StringPool.h"
 #include "io/File.h"
 #include "text/Printer.h"
+#include "util/SlabAllocator.h"
 
 namespace aapt {
 
@@ -41,7 +42,9 @@ class ConstValueVisitor;
 // type specific operations is to check the Value's type() and
 // cast it to the appropriate subclass. This isn't super clean,
 // but it is the simplest strategy.
-class Value {
+//
+// Values are slab allocated, since a large link creates millions of them.
+class Value : public SlabAllocated {
  public:
   virtual ~Value() = default;
 
@@ -101,6 +104,11 @@ class Value {
 
   virtual bool Equals(const Value* value) const = 0;
 
+  // Returns a hash of the parts of this value that Equals() compares, so equal values always hash
+  // the same. The hash is recomputed on every call; passes that compare many values should compute
+  // it once per value and only call Equals() when two hashes match.
+  virtual size_t Hash() const = 0;
+
   // Calls the appropriate overload of ValueVisitor.
   virtual void Accept(ValueVisitor* visitor) = 0;
 
@@ -184,6 +192,7 @@ struct Reference : public TransformableItem<Reference, BaseItem<Reference>> {
   Reference(const ResourceNameRef& n, const ResourceId& i);
 
   bool Equals(const Value* value) const override;
+  size_t Hash() const override;
   bool Flatten(android::Res_value* out_value) const override;
   void Print(std::ostream* out) const override;
   void PrettyPrint(text::Printer* printer) const override;
@@ -202,6 +211,7 @@ struct Id : public TransformableItem<Id, BaseItem<Id>> {
   }
 
   bool Equals(const Value* value) const override;
+  size_t Hash() const override;
   bool Flatten(android::Res_value* out) const override;
   void Print(std::ostream* out) const override;
 };
@@ -214,6 +224,7 @@ struct RawString : public TransformableItem<RawString, BaseItem<RawString>> {
   explicit RawString(const android::StringPool::Ref& ref);
 
   bool Equals(const Value* value) const override;
+  size_t Hash() const override;
   bool Flatten(android::Res_value* out_value) const override;
   void Print(std::ostream* out) const override;
 };
@@ -247,6 +258,7 @@ struct String : public TransformableItem<String, BaseItem<String>> {
   explicit String(const android::StringPool::Ref& ref);
 
   bool Equals(const Value* value) const override;
+  size_t Hash() const override;
   bool Flatten(android::Res_value* out_value) const override;
   void Print(std::ostream* out) const override;
   void PrettyPrint(text::Printer* printer) const override;
@@ -263,6 +275,7 @@ struct StyledString : public TransformableItem<StyledString, BaseItem<StyledStri
   explicit StyledString(const android::StringPool::StyleRef& ref);
 
   bool Equals(const Value* value) const override;
+  size_t Hash() const override;
   bool Flatten(android::Res_value* out_value) const override;
   void Print(std::ostream* out) const override;
 };
@@ -282,6 +295,7 @@ struct FileReference : public TransformableItem<FileReference, BaseItem<FileRefe
   explicit FileReference(const android::StringPool::Ref& path);
 
   bool Equals(const Value* value) const override;
+  size_t Hash() const override;
   bool Flatten(android::Res_value* out_value) const override;
   void Print(std::ostream* out) const override;
 };
@@ -295,6 +309,7 @@ struct BinaryPrimitive : public TransformableItem<BinaryPrimitive, BaseItem<Bina
   BinaryPrimitive(uint8_t dataType, uint32_t data);
 
   bool Equals(const Value* value) const override;
+  size_t Hash() const override;
   bool Flatten(android::Res_value* out_value) const override;
   void Print(std::ostream* out) const override;
   static const char* DecideFormat(float f);
@@ -318,6 +333,7 @@ struct Attribute : public TransformableValue<Attribute, BaseValue<Attribute>> {
   explicit Attribute(uint32_t t = 0u);
 
   bool Equals(const Value* value) const override;
+  size_t Hash() const override;
 
   // Returns true if this Attribute's format is compatible with the given Attribute. The basic
   // rule is that TYPE_REFERENCE can be ignored for both of the Attributes, and TYPE_FLAGS and
@@ -347,6 +363,7 @@ struct Style : public TransformableValue<Style, BaseValue<Style>> {
   std::vector<Entry> entries;
 
   bool Equals(const Value* value) const override;
+  size_t Hash() const override;
   void Print(std::ostream* out) const override;
 
   // Merges `style` into this Style. All identical attributes of `style` take precedence, including
@@ -358,6 +375,7 @@ struct Array : public TransformableValue<Array, BaseValue<Array>> {
   std::vector<std::unique_ptr<Item>> elements;
 
   bool Equals(const Value* value) const override;
+  size_t Hash() const override;
   void Print(std::ostream* out) const override;
   void RemoveFlagDisabledElements() override;
 };
@@ -368,6 +386,7 @@ struct Plural : public TransformableValue<Plural, BaseValue<Plural>> {
   std::array<std::unique_ptr<Item>, Count> values;
 
   bool Equals(const Value* value) const override;
+  size_t Hash() const override;
   void Print(std::ostream* out) const override;
 };
 
@@ -375,6 +394,7 @@ struct Styleable : public TransformableValue<Styleable, BaseValue<Styleable>> {
   std::vector<Reference> entries;
 
   bool Equals(const Value* value) const override;
+  size_t Hash() const override;
   void Print(std::ostream* out) const override;
   void MergeWith(Styleable* styleable);
 };
@@ -398,6 +418,7 @@ struct Macro : public TransformableValue<Macro, BaseValue<Macro>> {
   std::vector<Namespace> alias_namespaces;
 
   bool Equals(const Value* value) const override;
+  size_t Hash() const override;
   void Print(std::ostream* out) const override;
 };
 
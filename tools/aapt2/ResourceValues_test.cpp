@@ -167,6 +167,42 @@ TEST(ResourceValuesTest, StyleClone) {
   EXPECT_TRUE(a->Equals(b.get()));
 }
 
+TEST(ResourceValuesTest, EqualValuesHashTheSame) {
+  std::unique_ptr<Style> a = test::StyleBuilder()
+      .SetParent("android:style/Parent")
+      .AddItem("android:attr/foo", ResourceUtils::TryParseInt("1"))
+      .AddItem("android:attr/bar", ResourceUtils::TryParseInt("2"))
+      .Build();
+
+  // Same entries in a different order.
+  std::unique_ptr<Style> b = test::StyleBuilder()
+      .SetParent("android:style/Parent")
+      .AddItem("android:attr/bar", ResourceUtils::TryParseInt("2"))
+      .AddItem("android:attr/foo", ResourceUtils::TryParseInt("1"))
+      .Build();
+
+  std::unique_ptr<Style> c = test::StyleBuilder()
+      .SetParent("android:style/Parent")
+      .AddItem("android:attr/foo", ResourceUtils::TryParseInt("1"))
+      .AddItem("android:attr/bar", ResourceUtils::TryParseInt("3"))
+      .Build();
+
+  ASSERT_TRUE(a->Equals(b.get()));
+  EXPECT_EQ(a->Hash(), b->Hash());
+  EXPECT_NE(a->Hash(), c->Hash());
+
+  CloningValueTransformer cloner(nullptr);
+  std::unique_ptr<Style> d(a->Transform(cloner));
+  EXPECT_EQ(a->Hash(), d->Hash());
+
+  android::StringPool pool;
+  String str(pool.MakeRef("hello", android::StringPool::Context(test::ParseConfigOrDie("en"))));
+  String str2(pool.MakeRef("hello"));
+  String str3(pool.MakeRef("how are you"));
+  EXPECT_EQ(str.Hash(), str2.Hash());
+  EXPECT_NE(str.Hash(), str3.Hash());
+}
+
 TEST(ResourcesValuesTest, StringClones) {
   android::StringPool pool_a;
   android::StringPool pool_b;
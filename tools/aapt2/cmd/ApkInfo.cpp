@@ -18,16 +18,23 @@
 
 #include <fcntl.h>
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
+#include <mutex>
 
+#include "Diagnostics.h"
 #include "LoadedApk.h"
 #include "android-base/file.h"  // for O_BINARY
+#include "android-base/parseint.h"
+#include "android-base/unique_fd.h"
 #include "android-base/utf8.h"
 #include "androidfw/IDiagnostics.h"
 #include "androidfw/StringPiece.h"
 #include "dump/DumpManifest.h"
 #include "format/proto/ProtoSerialize.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "util/ThreadPool.h"
 
 using ::android::StringPiece;
 
@@ -42,7 +49,12 @@ int ExportApkInfo(LoadedApk* apk, bool include_resource_table,
   }
 
   if (include_resource_table) {
-    SerializeTableToPb(*apk->GetResourceTable(), out_apk_info->mutable_resource_table(), diag);
+    const ResourceTable* table = apk->GetResourceTable();
+    if (table == nullptr) {
+      diag->Error(android::DiagMessage() << "Failed to retrieve resource table");
+      return 1;
+    }
+    SerializeTableToPb(*table, out_apk_info->mutable_resource_table(), diag);
   }
 
   for (auto& xml_resource : xml_resources) {
@@ -58,37 +70,103 @@ int ExportApkInfo(LoadedApk* apk, bool include_resource_table,
   return 0;
 }
 
+// Loads the APK and exports its ApkInfo. Returns 0 on success.
+static int LoadAndExportApkInfo(StringPiece path, bool include_resource_table,
+                                const std::unordered_set<std::string>& xml_resources,
+                                pb::ApkInfo* out_apk_info, android::IDiagnostics* diag) {
+  std::unique_ptr<LoadedApk> apk = LoadedApk::LoadApkFromPath(path, diag, TableLoading::kLazy);
+  if (!apk) {
+    return 1;
+  }
+
+  int result = ExportApkInfo(apk.get(), include_resource_table, xml_resources, out_apk_info, diag);
+  if (result == 0 && apk->FailedToLoadResourceTable()) {
+    result = 1;
+  }
+  if (result != 0) {
+    diag->Error(android::DiagMessage(path) << "Failed to serialize ApkInfo into proto.");
+  }
+  return result;
+}
+
 int ApkInfoCommand::Action(const std::vector<std::string>& args) {
-  if (args.size() != 1) {
-    std::cerr << "must supply a single APK\n";
+  if (args.empty()) {
+    std::cerr << "must supply an APK\n";
     Usage(&std::cerr);
     return 1;
   }
-  StringPiece path = args[0];
-  std::unique_ptr<LoadedApk> apk = LoadedApk::LoadApkFromPath(path, diag_);
-  if (!apk) {
+  if (args.size() > 1 && !delimited_) {
+    std::cerr << "must pass --delimited to supply more than one APK\n";
+    Usage(&std::cerr);
     return 1;
   }
 
+  size_t jobs = 1;
+  if (jobs_ && !android::base::ParseUint(jobs_.value(), &jobs)) {
+    diag_->Error(android::DiagMessage() << "invalid value for -j: '" << jobs_.value() << "'");
+    return 1;
+  }
+  if (jobs == 0) {
+    jobs = ThreadPool::GetDefaultThreadCount();
+  }
+
   pb::ApkInfo out_apk_info;
-  int result =
-      ExportApkInfo(apk.get(), include_resource_table_, xml_resources_, &out_apk_info, diag_);
-  if (result != 0) {
-    diag_->Error(android::DiagMessage() << "Failed to serialize ApkInfo into proto.");
-    return result;
+  if (!delimited_) {
+    int result = LoadAndExportApkInfo(args[0], include_resource_table_, xml_resources_,
+                                      &out_apk_info, diag_);
+    if (result != 0) {
+      return result;
+    }
   }
 
   int mode = O_WRONLY | O_CREAT | O_TRUNC | O_BINARY;
-  int outfd = ::android::base::utf8::open(output_path_.c_str(), mode, 0666);
-  if (outfd == -1) {
+  android::base::unique_fd outfd(::android::base::utf8::open(output_path_.c_str(), mode, 0666));
+  if (outfd.get() == -1) {
     diag_->Error(android::DiagMessage() << "Failed to open output file.");
     return 1;
   }
 
-  bool is_serialized = out_apk_info.SerializeToFileDescriptor(outfd);
-  close(outfd);
+  if (!delimited_) {
+    return out_apk_info.SerializeToFileDescriptor(outfd.get()) ? 0 : 1;
+  }
 
-  return is_serialized ? 0 : 1;
+  // Every APK is written as soon as it is done, so that the consumer can start on it while the
+  // others are still being processed.
+  std::mutex mutex;
+  bool error = false;
+  ThreadPool pool(std::min(jobs, args.size()));
+  for (const std::string& path : args) {
+    pool.Post([this, &mutex, &error, &outfd, &path] {
+      BufferedDiagnostics diagnostics(diag_);
+      pb::ApkInfo apk_info;
+      std::string data;
+      int result = LoadAndExportApkInfo(path, include_resource_table_, xml_resources_, &apk_info,
+                                        &diagnostics);
+      if (result == 0) {
+        apk_info.set_path(path);
+        if (!apk_info.SerializeToString(&data)) {
+          diagnostics.Error(android::DiagMessage(path) << "Failed to serialize ApkInfo.");
+          result = 1;
+        }
+      }
+
+      // A varint32 takes at most 5 bytes.
+      uint8_t size[5];
+      const uint8_t* size_end = google::protobuf::io::CodedOutputStream::WriteVarint32ToArray(
+          static_cast<uint32_t>(data.size()), size);
+
+      std::lock_guard<std::mutex> lock(mutex);
+      diagnostics.Replay();
+      if (result == 0 && (!android::base::WriteFully(outfd.get(), size, size_end - size) ||
+                          !android::base::WriteFully(outfd.get(), data.data(), data.size()))) {
+        diag_->Error(android::DiagMessage(output_path_) << "Failed to write ApkInfo of " << path);
+        result = 1;
+      }
+      error |= result != 0;
+    });
+  }
+  pool.Wait();
+  return error ? 1 : 0;
 }
 
 }  // namespace aapt
\ No newline at end of file
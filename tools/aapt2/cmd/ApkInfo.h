@@ -27,6 +27,15 @@ class ApkInfoCommand : public Command {
   explicit ApkInfoCommand(android::IDiagnostics* diag) : Command("apkinfo"), diag_(diag) {
     SetDescription("Dump information about an APK in binary proto format.");
     AddRequiredFlag("-o", "Output path", &output_path_, Command::kPath);
+    AddOptionalSwitch("--delimited",
+                      "Write a stream of ApkInfo messages, each preceded by its size as a varint\n"
+                      "and with its path set, one per APK in the order that they are done.\n"
+                      "Required to pass more than one APK.",
+                      &delimited_);
+    AddOptionalFlag("-j",
+                    "Number of APKs to process in parallel with --delimited. Defaults to 1, 0\n"
+                    "uses one thread per CPU core.",
+                    &jobs_);
     AddOptionalSwitch("--include-resource-table", "Include the resource table data into output.",
                       &include_resource_table_);
     AddOptionalFlagList("--include-xml",
@@ -42,6 +51,8 @@ class ApkInfoCommand : public Command {
   std::string output_path_;
   bool include_resource_table_ = false;
   std::unordered_set<std::string> xml_resources_;
+  bool delimited_ = false;
+  std::optional<std::string> jobs_;
 };
 
 }  // namespace aapt
@@ -19,6 +19,7 @@
 #include "ApkInfo.pb.h"
 #include "LoadedApk.h"
 #include "android-base/unique_fd.h"
+#include "google/protobuf/io/coded_stream.h"
 #include "io/StringStream.h"
 #include "test/Test.h"
 
@@ -75,4 +76,48 @@ TEST_F(ApkInfoTest, FullApkInfo) {
   AssertProducedAndExpectedInfo(out_info_path, expected_path);
 }
 
+TEST_F(ApkInfoTest, DelimitedApkInfoOfSeveralApks) {
+  auto apk_path = file::BuildPath(
+      {android::base::GetExecutableDirectory(), "integration-tests", "DumpTest", "components.apk"});
+  auto out_info_path = GetTestPath("apk_infos.pb");
+
+  ApkInfoCommand command(&noop_diag);
+  ASSERT_EQ(command.Execute({"-o", out_info_path, "--delimited", "-j", "2", apk_path, apk_path},
+                            &std::cerr),
+            0);
+
+  std::string data;
+  ASSERT_TRUE(::android::base::ReadFileToString(out_info_path, &data));
+  std::string expected;
+  ::android::base::ReadFileToString(
+      file::BuildPath({android::base::GetExecutableDirectory(), "integration-tests", "DumpTest",
+                       "components_expected_proto.txt"}),
+      &expected);
+
+  google::protobuf::io::CodedInputStream input(reinterpret_cast<const uint8_t*>(data.data()),
+                                               data.size());
+  for (int i = 0; i < 2; i++) {
+    uint32_t size;
+    ASSERT_TRUE(input.ReadVarint32(&size));
+    auto limit = input.PushLimit(size);
+    pb::ApkInfo apk_info;
+    ASSERT_TRUE(apk_info.ParseFromCodedStream(&input));
+    input.PopLimit(limit);
+
+    EXPECT_EQ(apk_info.path(), apk_path);
+    apk_info.clear_path();
+    EXPECT_EQ(apk_info.DebugString(), expected);
+  }
+  EXPECT_EQ(input.CurrentPosition(), static_cast<int>(data.size()));
+}
+
+TEST_F(ApkInfoTest, SeveralApksRequireDelimited) {
+  auto apk_path = file::BuildPath(
+      {android::base::GetExecutableDirectory(), "integration-tests", "DumpTest", "components.apk"});
+
+  ApkInfoCommand command(&noop_diag);
+  EXPECT_NE(command.Execute({"-o", GetTestPath("apk_info.pb"), apk_path, apk_path}, &std::cerr),
+            0);
+}
+
 }  // namespace aapt
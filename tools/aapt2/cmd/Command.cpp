@@ -246,6 +246,7 @@ int Command::Execute(const std::vector<StringPiece>& args, std::ostream* out_err
     }
   }
 
+  executed_args_.assign(args.begin(), args.end());
   return Action(file_args);
 }
 
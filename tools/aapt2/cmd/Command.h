@@ -81,6 +81,12 @@ class Command {
   // The action to preform when the command is executed.
   virtual int Action(const std::vector<std::string>& args) = 0;
 
+ protected:
+  // The arguments the command was executed with, flags included, in the order they were given.
+  const std::vector<std::string>& GetExecutedArgs() const {
+    return executed_args_;
+  }
+
  private:
   struct Flag {
     explicit Flag(android::StringPiece name, android::StringPiece description,
@@ -109,6 +115,7 @@ class Command {
   std::vector<Flag> flags_;
   std::vector<std::unique_ptr<Command>> subcommands_;
   std::vector<std::unique_ptr<Command>> experimental_subcommands_;
+  std::vector<std::string> executed_args_;
 };
 
 }  // namespace aapt
@@ -18,12 +18,20 @@
 
 #include <dirent.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "Diagnostics.h"
 #include "ResourceParser.h"
 #include "ResourceTable.h"
 #include "android-base/errors.h"
 #include "android-base/file.h"
+#include "android-base/parseint.h"
 #include "android-base/utf8.h"
 #include "androidfw/BigBufferStream.h"
 #include "androidfw/ConfigDescription.h"
@@ -33,6 +41,7 @@
 #include "androidfw/Png.h"
 #include "androidfw/StringPiece.h"
 #include "cmd/Util.h"
+#include "compile/CompileCache.h"
 #include "compile/IdAssigner.h"
 #include "compile/InlineXmlFormatParser.h"
 #include "compile/PseudolocaleGenerator.h"
@@ -49,6 +58,7 @@
 #include "process/ProductFilter.h"
 #include "trace/TraceBuffer.h"
 #include "util/Files.h"
+#include "util/ThreadPool.h"
 #include "util/Util.h"
 #include "xml/XmlDom.h"
 #include "xml/XmlPullParser.h"
@@ -540,7 +550,9 @@ static bool CompilePng(IAaptContext* context, const CompileOptions& options,
     }
 
     // Write the crunched PNG.
-    if (!android::WritePng(image.get(), nine_patch.get(), &crunched_png_buffer_out, {},
+    android::PngOptions png_options;
+    png_options.threads = options.jobs == 0 ? ThreadPool::GetDefaultThreadCount() : options.jobs;
+    if (!android::WritePng(image.get(), nine_patch.get(), &crunched_png_buffer_out, png_options,
                            &source_diag, context->IsVerbose())) {
       return false;
     }
@@ -671,80 +683,390 @@ class CompileContext : public IAaptContext {
   bool verbose_ = false;
 };
 
+// Forwards everything to the compile context, except for diagnostics which are buffered.
+class CompileJobContext : public IAaptContext {
+ public:
+  CompileJobContext(IAaptContext* context, android::IDiagnostics* diagnostics)
+      : context_(context), diagnostics_(diagnostics) {
+  }
+
+  PackageType GetPackageType() override {
+    return context_->GetPackageType();
+  }
+
+  bool IsVerbose() override {
+    return context_->IsVerbose();
+  }
+
+  android::IDiagnostics* GetDiagnostics() override {
+    return diagnostics_;
+  }
+
+  NameMangler* GetNameMangler() override {
+    return context_->GetNameMangler();
+  }
+
+  const std::string& GetCompilationPackage() override {
+    return context_->GetCompilationPackage();
+  }
+
+  uint8_t GetPackageId() override {
+    return context_->GetPackageId();
+  }
+
+  SymbolTable* GetExternalSymbols() override {
+    return context_->GetExternalSymbols();
+  }
+
+  int GetMinSdkVersion() override {
+    return context_->GetMinSdkVersion();
+  }
+
+  const std::set<std::string>& GetSplitNameDependencies() override {
+    return context_->GetSplitNameDependencies();
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CompileJobContext);
+
+  IAaptContext* context_;
+  android::IDiagnostics* diagnostics_;
+};
+
+// Holds the entries written for a single input in memory until they can be written to the real
+// archive in input order.
+class BufferedArchiveWriter : public IArchiveWriter {
+ public:
+  BufferedArchiveWriter() = default;
+
+  bool WriteFile(StringPiece path, uint32_t flags, android::InputStream* in) override {
+    if (!StartEntry(path, flags)) {
+      return false;
+    }
+
+    const void* data = nullptr;
+    size_t len = 0;
+    while (in->Next(&data, &len)) {
+      Write(data, static_cast<int>(len));
+    }
+
+    if (in->HadError()) {
+      error_ = in->GetError();
+      return false;
+    }
+    return FinishEntry();
+  }
+
+  bool StartEntry(StringPiece path, uint32_t flags) override {
+    if (in_entry_) {
+      error_ = "entry already started";
+      return false;
+    }
+    entries_.push_back(Entry{std::string(path), flags, android::BigBuffer(kBlockSize)});
+    in_entry_ = true;
+    return true;
+  }
+
+  bool Write(const void* data, int len) override {
+    if (!in_entry_) {
+      error_ = "no entry started";
+      return false;
+    }
+    if (len > 0) {
+      memcpy(entries_.back().data.NextBlock<uint8_t>(len), data, len);
+    }
+    return true;
+  }
+
+  bool FinishEntry() override {
+    if (!in_entry_) {
+      error_ = "no entry started";
+      return false;
+    }
+    in_entry_ = false;
+    return true;
+  }
+
+  bool HadError() const override {
+    return !error_.empty();
+  }
+
+  std::string GetError() const override {
+    return error_;
+  }
+
+  // Returns the contents of a finished entry, or nullptr if there is no such entry.
+  const android::BigBuffer* GetEntryData(StringPiece path) const {
+    if (in_entry_ || entries_.size() != 1 || entries_.front().path != path) {
+      return nullptr;
+    }
+    return &entries_.front().data;
+  }
+
+  // Writes every finished entry to the given archive and releases the memory held by them.
+  bool FlushTo(IArchiveWriter* writer, android::IDiagnostics* diag) {
+    bool success = true;
+    for (Entry& entry : entries_) {
+      android::BigBufferInputStream in(std::move(entry.data));
+      if (!writer->WriteFile(entry.path, entry.flags, &in)) {
+        diag->Error(android::DiagMessage(entry.path)
+                    << "failed to write: " << writer->GetError());
+        success = false;
+      }
+    }
+    entries_.clear();
+    return success;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(BufferedArchiveWriter);
+
+  static constexpr size_t kBlockSize = 64 * 1024;
+
+  struct Entry {
+    std::string path;
+    uint32_t flags;
+    android::BigBuffer data;
+  };
+
+  std::vector<Entry> entries_;
+  bool in_entry_ = false;
+  std::string error_;
+};
+
+using CompileFunc = bool (*)(IAaptContext* context, const CompileOptions& options,
+                             const ResourcePathData& path_data, io::IFile* file,
+                             IArchiveWriter* writer, const std::string& out_path);
+
+// A single input file. Everything it produces is buffered so that inputs can be compiled in
+// any order and still be written out in input order.
+struct CompileJob {
+  explicit CompileJob(IAaptContext* context)
+      : diagnostics(context->GetDiagnostics()), context(context, &diagnostics) {
+  }
+
+  BufferedDiagnostics diagnostics;
+  CompileJobContext context;
+  BufferedArchiveWriter writer;
+
+  io::IFile* file = nullptr;
+  ResourcePathData path_data;
+  CompileFunc compile_func = nullptr;
+  std::string out_path;
+
+  bool succeeded = true;
+  bool done = false;
+};
+
+// Validates the input and decides how it is compiled. Returns false if the input is invalid, in
+// which case the errors have already been logged to the job.
+static bool PrepareCompileJob(const CompileOptions& options, char dir_separator, CompileJob* job) {
+  IAaptContext* context = &job->context;
+  io::IFile* file = job->file;
+  std::string path = file->GetSource().path;
+
+  if (!options.res_zip && !IsValidFile(context, path)) {
+    return false;
+  }
+
+  // Extract resource type information from the full path
+  std::string err_str;
+  ResourcePathData& path_data = job->path_data;
+  if (auto maybe_path_data = ExtractResourcePathData(path, dir_separator, &err_str, options)) {
+    path_data = maybe_path_data.value();
+  } else {
+    context->GetDiagnostics()->Error(android::DiagMessage(file->GetSource()) << err_str);
+    return false;
+  }
+
+  // Determine how to compile the file based on its type.
+  auto compile_func = &CompileFile;
+  if (path_data.resource_dir == "values" && path_data.extension == "xml") {
+    compile_func = &CompileTable;
+    // We use a different extension (not necessary anymore, but avoids altering the existing
+    // build system logic).
+    path_data.extension = "arsc";
+
+  } else if (const ResourceType* type = ParseResourceType(path_data.resource_dir)) {
+    if (*type != ResourceType::kRaw) {
+      if (*type == ResourceType::kXml || path_data.extension == "xml") {
+        compile_func = &CompileXml;
+      } else if ((!options.no_png_crunch && path_data.extension == "png")
+                 || path_data.extension == "9.png") {
+        compile_func = &CompilePng;
+      }
+    }
+  } else {
+    context->GetDiagnostics()->Error(android::DiagMessage()
+                                     << "invalid file path '" << path_data.source << "'");
+    return false;
+  }
+
+  // Treat periods as a reserved character that should not be present in a file name
+  // Legacy support for AAPT which did not reserve periods
+  if (compile_func != &CompileFile && !options.legacy_mode
+      && std::count(path_data.name.begin(), path_data.name.end(), '.') != 0) {
+    context->GetDiagnostics()->Error(android::DiagMessage(file->GetSource())
+                                     << "file name cannot contain '.' other than for"
+                                     << " specifying the extension");
+    return false;
+  }
+
+  job->compile_func = compile_func;
+  job->out_path = BuildIntermediateContainerFilename(path_data);
+  return true;
+}
+
+// Derives the cache key of a job from the input contents and everything else that can change
+// the compiled output. Returns an empty string if the input cannot be read.
+static std::string ComputeCompileCacheKey(const CompileOptions& options, CompileJob* job) {
+  std::unique_ptr<io::IData> data = job->file->OpenAsData();
+  if (!data) {
+    return {};
+  }
+
+  // Bump when the compiled output changes in a way that the tool fingerprint does not capture.
+  static constexpr char kCacheFormatVersion[] = "1";
+
+  CompileCache::KeyBuilder key;
+  key.Add(kCacheFormatVersion)
+      .Add(util::GetToolFingerprint())
+      .Add(job->file->GetSource().path)
+      .Add(job->path_data.source.path)
+      .Add(job->out_path)
+      .Add(options.pseudolocalize ? "pseudolocalize" : "")
+      .Add(options.no_png_crunch ? "no_png_crunch" : "")
+      .Add(options.legacy_mode ? "legacy" : "")
+      .Add(options.preserve_visibility_of_styleables ? "preserve_visibility_of_styleables" : "")
+      .Add(options.visibility ? std::to_string(static_cast<int>(options.visibility.value())) : "")
+      .Add(options.product_.value_or(""))
+      .Add(options.pseudo_localize_gender_values.value_or(""))
+      .Add(options.pseudo_localize_gender_ratio.value_or(""));
+  for (const auto& [name, properties] : options.feature_flag_values) {
+    key.Add(name)
+        .Add(properties.read_only ? "ro" : "rw")
+        .Add(!properties.enabled ? "" : properties.enabled.value() ? "true" : "false");
+  }
+  key.Add(data->data(), data->size());
+  return key.Build();
+}
+
+static void RunCompileJob(const CompileOptions& options, const CompileCache* cache,
+                          CompileJob* job) {
+  std::string cache_key;
+  if (cache != nullptr) {
+    cache_key = ComputeCompileCacheKey(options, job);
+    android::BigBuffer cached(4096);
+    if (!cache_key.empty() && cache->Load(cache_key, &cached)) {
+      if (job->context.IsVerbose()) {
+        job->context.GetDiagnostics()->Note(android::DiagMessage(job->path_data.source)
+                                            << "using cached compile output");
+      }
+      android::BigBufferInputStream in(std::move(cached));
+      job->writer.WriteFile(job->out_path, 0, &in);
+      return;
+    }
+  }
+
+  if (!job->compile_func(&job->context, options, job->path_data, job->file, &job->writer,
+                         job->out_path)) {
+    job->context.GetDiagnostics()->Error(android::DiagMessage(job->file->GetSource())
+                                         << "file failed to compile");
+    job->succeeded = false;
+    return;
+  }
+
+  // Only outputs that compiled cleanly are cached, a cache hit would drop any warnings.
+  if (!cache_key.empty() && !job->diagnostics.HadWarningsOrErrors()) {
+    if (const android::BigBuffer* data = job->writer.GetEntryData(job->out_path)) {
+      cache->Store(cache_key, *data);
+    }
+  }
+}
+
+static size_t GetCompileThreadCount(const CompileOptions& options) {
+  // Entries of a zip input are read through a single shared archive handle, and the text symbols
+  // file is rewritten by every compiled table, so neither can be spread across threads.
+  if (options.res_zip || options.generate_text_symbols_path) {
+    return 1;
+  }
+  return options.jobs == 0 ? ThreadPool::GetDefaultThreadCount() : options.jobs;
+}
+
 int Compile(IAaptContext* context, io::IFileCollection* inputs, IArchiveWriter* output_writer,
              CompileOptions& options) {
   TRACE_CALL();
   bool error = false;
 
-  // Iterate over the input files in a stable, platform-independent manner
-  auto file_iterator  = inputs->Iterator();
-  while (file_iterator->HasNext()) {
-    auto file = file_iterator->Next();
-    std::string path = file->GetSource().path;
-
-    // Skip hidden input files
-    if (file::IsHidden(path)) {
-      continue;
-    }
+  std::mutex mutex;
+  std::condition_variable job_done;
+  std::vector<std::unique_ptr<CompileJob>> jobs;
+  size_t next_to_flush = 0;
 
-    if (!options.res_zip && !IsValidFile(context, path)) {
-      error = true;
-      continue;
+  // The text symbols file is a side effect of compiling a table that the cache cannot replay.
+  std::unique_ptr<CompileCache> cache;
+  if (options.cache_dir && !options.generate_text_symbols_path) {
+    cache = CompileCache::Open(options.cache_dir.value(), context->GetDiagnostics());
+    if (!cache) {
+      return 1;
     }
+  }
 
-    // Extract resource type information from the full path
-    std::string err_str;
-    ResourcePathData path_data;
-    if (auto maybe_path_data = ExtractResourcePathData(
-        path, inputs->GetDirSeparator(), &err_str, options)) {
-      path_data = maybe_path_data.value();
-    } else {
-      context->GetDiagnostics()->Error(android::DiagMessage(file->GetSource()) << err_str);
-      error = true;
-      continue;
-    }
-
-    // Determine how to compile the file based on its type.
-    auto compile_func = &CompileFile;
-    if (path_data.resource_dir == "values" && path_data.extension == "xml") {
-      compile_func = &CompileTable;
-      // We use a different extension (not necessary anymore, but avoids altering the existing
-      // build system logic).
-      path_data.extension = "arsc";
-
-    } else if (const ResourceType* type = ParseResourceType(path_data.resource_dir)) {
-      if (*type != ResourceType::kRaw) {
-        if (*type == ResourceType::kXml || path_data.extension == "xml") {
-          compile_func = &CompileXml;
-        } else if ((!options.no_png_crunch && path_data.extension == "png")
-                   || path_data.extension == "9.png") {
-          compile_func = &CompilePng;
+  // Writes out the results of finished jobs in input order. When `wait` is set, blocks until every
+  // job has been flushed.
+  auto flush_jobs = [&](bool wait) {
+    while (next_to_flush < jobs.size()) {
+      CompileJob* job = jobs[next_to_flush].get();
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (wait) {
+          job_done.wait(lock, [job] { return job->done; });
+        } else if (!job->done) {
+          return;
         }
       }
-    } else {
-      context->GetDiagnostics()->Error(android::DiagMessage()
-                                       << "invalid file path '" << path_data.source << "'");
-      error = true;
-      continue;
+      job->diagnostics.Replay();
+      if (!job->writer.FlushTo(output_writer, context->GetDiagnostics()) || !job->succeeded) {
+        error = true;
+      }
+      jobs[next_to_flush++].reset();
     }
+  };
 
-    // Treat periods as a reserved character that should not be present in a file name
-    // Legacy support for AAPT which did not reserve periods
-    if (compile_func != &CompileFile && !options.legacy_mode
-        && std::count(path_data.name.begin(), path_data.name.end(), '.') != 0) {
-      error = true;
-      context->GetDiagnostics()->Error(android::DiagMessage(file->GetSource())
-                                       << "file name cannot contain '.' other than for"
-                                       << " specifying the extension");
-      continue;
-    }
+  {
+    ThreadPool pool(GetCompileThreadCount(options));
+
+    // Iterate over the input files in a stable, platform-independent manner
+    auto file_iterator  = inputs->Iterator();
+    while (file_iterator->HasNext()) {
+      auto file = file_iterator->Next();
 
-    const std::string out_path = BuildIntermediateContainerFilename(path_data);
-    if (!compile_func(context, options, path_data, file, output_writer, out_path)) {
-      context->GetDiagnostics()->Error(android::DiagMessage(file->GetSource())
-                                       << "file failed to compile");
-      error = true;
+      // Skip hidden input files
+      if (file::IsHidden(file->GetSource().path)) {
+        continue;
+      }
+
+      auto job = util::make_unique<CompileJob>(context);
+      job->file = file;
+      CompileJob* job_ptr = job.get();
+      jobs.push_back(std::move(job));
+
+      if (!PrepareCompileJob(options, inputs->GetDirSeparator(), job_ptr)) {
+        job_ptr->succeeded = false;
+        job_ptr->done = true;
+      } else {
+        pool.Post([&options, &cache, &mutex, &job_done, job_ptr] {
+          RunCompileJob(options, cache.get(), job_ptr);
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            job_ptr->done = true;
+          }
+          job_done.notify_all();
+        });
+      }
+      flush_jobs(false /* wait */);
     }
+    flush_jobs(true /* wait */);
   }
 
   return error ? 1 : 0;
@@ -859,6 +1181,14 @@ int CompileCommand::Action(const std::vector<std::string>& args) {
     }
   }
 
+  if (jobs_) {
+    if (!android::base::ParseUint(jobs_.value(), &options_.jobs)) {
+      context.GetDiagnostics()->Error(android::DiagMessage()
+                                      << "invalid value for -j: '" << jobs_.value() << "'");
+      return 1;
+    }
+  }
+
   return Compile(&context, file_collection.get(), archive_writer.get(), options_);
 }
 
@@ -45,6 +45,10 @@ struct CompileOptions {
   // See comments on aapt::ResourceParserOptions.
   bool preserve_visibility_of_styleables = false;
   bool verbose = false;
+  // The number of inputs to compile in parallel. 0 uses one thread per CPU core.
+  size_t jobs = 1;
+  // Directory of compiled outputs reused across runs, see aapt::CompileCache.
+  std::optional<std::string> cache_dir;
   std::optional<std::string> product_;
   FeatureFlagValues feature_flag_values;
 };
@@ -76,6 +80,17 @@ class CompileCommand : public Command {
         "Sets the visibility of the compiled resources to the specified\n"
             "level. Accepted levels: public, private, default", &visibility_);
     AddOptionalSwitch("-v", "Enables verbose logging", &options_.verbose);
+    AddOptionalFlag("-j",
+                    "Number of files to compile in parallel. Defaults to 1, 0 uses one\n"
+                    "thread per CPU core. Output and diagnostics keep the input order.\n"
+                    "Ignored with --zip or --output-text-symbols.",
+                    &jobs_);
+    AddOptionalFlag("--cache-dir",
+                    "Directory in which to cache compiled files across runs. Entries are keyed\n"
+                    "by the input contents, the aapt2 version and the options that affect the\n"
+                    "output. The directory may be shared by concurrent runs.\n"
+                    "Ignored with --output-text-symbols.",
+                    &options_.cache_dir, Command::kPath);
     AddOptionalFlag("--trace-folder", "Generate systrace json trace fragment to specified folder.",
                     &trace_folder_);
     AddOptionalFlag("--source-path",
@@ -109,6 +124,7 @@ class CompileCommand : public Command {
   CompileOptions options_;
   std::optional<std::string> visibility_;
   std::optional<std::string> trace_folder_;
+  std::optional<std::string> jobs_;
   std::vector<std::string> feature_flags_args_;
 };
 
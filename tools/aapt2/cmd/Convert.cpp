@@ -16,6 +16,7 @@
 
 #include "Convert.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "Diagnostics.h"
@@ -23,6 +24,7 @@
 #include "ValueVisitor.h"
 #include "android-base/file.h"
 #include "android-base/macros.h"
+#include "android-base/parseint.h"
 #include "android-base/stringprintf.h"
 #include "androidfw/BigBufferStream.h"
 #include "androidfw/StringPiece.h"
@@ -34,6 +36,7 @@
 #include "io/Util.h"
 #include "process/IResourceTableConsumer.h"
 #include "process/SymbolTable.h"
+#include "util/ThreadPool.h"
 #include "util/Util.h"
 
 using ::android::StringPiece;
@@ -52,13 +55,114 @@ class IApkSerializer {
   virtual bool SerializeXml(const xml::XmlResource* xml, const std::string& path, bool utf16,
                             IArchiveWriter* writer, uint32_t compression_flags) = 0;
   virtual bool SerializeTable(ResourceTable* table, IArchiveWriter* writer) = 0;
-  virtual bool SerializeFile(FileReference* file, IArchiveWriter* writer) = 0;
+
+  // Whether the file has to be converted to the output format, rather than copied as is.
+  virtual bool NeedsConversion(const FileReference* file) = 0;
+
+  // Converts the contents of the file into the output format. This does not touch the archive,
+  // so different files can be converted in parallel.
+  virtual bool ConvertFile(FileReference* file, const io::IData* data,
+                           android::BigBuffer* out) = 0;
 
   virtual ~IApkSerializer() = default;
 
+  bool SerializeFile(FileReference* file, IArchiveWriter* writer) {
+    if (!NeedsConversion(file)) {
+      return CopyFile(file, writer);
+    }
+
+    unique_ptr<io::IData> data = file->file->OpenAsData();
+    if (!data) {
+      context_->GetDiagnostics()->Error(android::DiagMessage(source_)
+                                        << "failed to open file " << *file->path);
+      return false;
+    }
+
+    android::BigBuffer buffer(4096);
+    return ConvertFile(file, data.get(), &buffer) && WriteConvertedFile(file, &buffer, writer);
+  }
+
+  // Serializes the files in order. With more than one job, the files are converted a window at a
+  // time on a thread pool and then written in order, so the output matches a serial run and only
+  // a window of converted files is held in memory at once.
+  bool SerializeFiles(const vector<FileReference*>& files, size_t jobs, IArchiveWriter* writer) {
+    if (jobs <= 1) {
+      for (FileReference* file : files) {
+        if (!SerializeFile(file, writer)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    struct PendingFile {
+      unique_ptr<io::IData> data;
+      android::BigBuffer buffer{4096};
+      bool converted = false;
+    };
+
+    ThreadPool pool(jobs);
+    const size_t window = jobs * 2;
+    for (size_t start = 0; start < files.size(); start += window) {
+      vector<PendingFile> pending(std::min(window, files.size() - start));
+      bool error = false;
+      for (size_t i = 0; i < pending.size(); i++) {
+        FileReference* file = files[start + i];
+        if (!NeedsConversion(file)) {
+          continue;
+        }
+        pending[i].data = file->file->OpenAsData();
+        if (!pending[i].data) {
+          context_->GetDiagnostics()->Error(android::DiagMessage(source_)
+                                            << "failed to open file " << *file->path);
+          error = true;
+          break;
+        }
+        pool.Post([this, file, p = &pending[i]]() {
+          p->converted = ConvertFile(file, p->data.get(), &p->buffer);
+        });
+      }
+      pool.Wait();
+      if (error) {
+        return false;
+      }
+
+      for (size_t i = 0; i < pending.size(); i++) {
+        FileReference* file = files[start + i];
+        if (!pending[i].data) {
+          if (!CopyFile(file, writer)) {
+            return false;
+          }
+        } else if (!pending[i].converted ||
+                   !WriteConvertedFile(file, &pending[i].buffer, writer)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
  protected:
   IAaptContext* context_;
   android::Source source_;
+
+ private:
+  bool CopyFile(FileReference* file, IArchiveWriter* writer) {
+    if (!io::CopyFileToArchivePreserveCompression(context_, file->file, *file->path, writer)) {
+      context_->GetDiagnostics()->Error(android::DiagMessage(source_)
+                                        << "failed to copy file " << *file->path);
+      return false;
+    }
+    return true;
+  }
+
+  bool WriteConvertedFile(FileReference* file, android::BigBuffer* buffer,
+                          IArchiveWriter* writer) {
+    android::BigBufferInputStream input_stream(buffer);
+    return io::CopyInputStreamToArchive(context_, &input_stream, *file->path,
+                                        file->file->WasCompressed() ? ArchiveEntry::kCompress : 0u,
+                                        writer);
+  }
 };
 
 class BinaryApkSerializer : public IApkSerializer {
@@ -96,48 +200,38 @@ class BinaryApkSerializer : public IApkSerializer {
                                         ArchiveEntry::kAlign, writer);
   }
 
-  bool SerializeFile(FileReference* file, IArchiveWriter* writer) override {
-    if (file->type == ResourceFile::Type::kProtoXml) {
-      unique_ptr<android::InputStream> in = file->file->OpenInputStream();
-      if (in == nullptr) {
-        context_->GetDiagnostics()->Error(android::DiagMessage(source_)
-                                          << "failed to open file " << *file->path);
-        return false;
-      }
-
-      pb::XmlNode pb_node;
-      io::ProtoInputStreamReader proto_reader(in.get());
-      if (!proto_reader.ReadMessage(&pb_node)) {
-        context_->GetDiagnostics()->Error(android::DiagMessage(source_)
-                                          << "failed to parse proto XML " << *file->path);
-        return false;
-      }
+  bool NeedsConversion(const FileReference* file) override {
+    return file->type == ResourceFile::Type::kProtoXml;
+  }
 
-      std::string error;
-      unique_ptr<xml::XmlResource> xml = DeserializeXmlResourceFromPb(pb_node, &error);
-      if (xml == nullptr) {
-        context_->GetDiagnostics()->Error(android::DiagMessage(source_)
-                                          << "failed to deserialize proto XML " << *file->path
-                                          << ": " << error);
-        return false;
-      }
+  bool ConvertFile(FileReference* file, const io::IData* data, android::BigBuffer* out) override {
+    pb::XmlNode pb_node;
+    if (!pb_node.ParseFromArray(data->data(), data->size())) {
+      context_->GetDiagnostics()->Error(android::DiagMessage(source_)
+                                        << "failed to parse proto XML " << *file->path);
+      return false;
+    }
 
-      if (!SerializeXml(xml.get(), *file->path, false /*utf16*/, writer,
-                        file->file->WasCompressed() ? ArchiveEntry::kCompress : 0u)) {
-        context_->GetDiagnostics()->Error(android::DiagMessage(source_)
-                                          << "failed to serialize to binary XML: " << *file->path);
-        return false;
-      }
+    std::string error;
+    unique_ptr<xml::XmlResource> xml = DeserializeXmlResourceFromPb(pb_node, &error);
+    if (xml == nullptr) {
+      context_->GetDiagnostics()->Error(android::DiagMessage(source_)
+                                        << "failed to deserialize proto XML " << *file->path
+                                        << ": " << error);
+      return false;
+    }
 
-      file->type = ResourceFile::Type::kBinaryXml;
-    } else {
-      if (!io::CopyFileToArchivePreserveCompression(context_, file->file, *file->path, writer)) {
-        context_->GetDiagnostics()->Error(android::DiagMessage(source_)
-                                          << "failed to copy file " << *file->path);
-        return false;
-      }
+    // Use a copy of the options, since files may be converted in parallel.
+    XmlFlattenerOptions xml_flattener_options = xml_flattener_options_;
+    xml_flattener_options.use_utf16 = false;
+    XmlFlattener flattener(out, xml_flattener_options);
+    if (!flattener.Consume(context_, xml.get())) {
+      context_->GetDiagnostics()->Error(android::DiagMessage(source_)
+                                        << "failed to serialize to binary XML: " << *file->path);
+      return false;
     }
 
+    file->type = ResourceFile::Type::kBinaryXml;
     return true;
   }
 
@@ -168,39 +262,29 @@ class ProtoApkSerializer : public IApkSerializer {
                                   ArchiveEntry::kCompress, writer);
   }
 
-  bool SerializeFile(FileReference* file, IArchiveWriter* writer) override {
-    if (file->type == ResourceFile::Type::kBinaryXml) {
-      std::unique_ptr<io::IData> data = file->file->OpenAsData();
-      if (!data) {
-        context_->GetDiagnostics()->Error(android::DiagMessage(source_)
-                                          << "failed to open file " << *file->path);
-        return false;
-      }
-
-      std::string error;
-      std::unique_ptr<xml::XmlResource> xml = xml::Inflate(data->data(), data->size(), &error);
-      if (xml == nullptr) {
-        context_->GetDiagnostics()->Error(android::DiagMessage(source_)
-                                          << "failed to parse binary XML: " << error);
-        return false;
-      }
+  bool NeedsConversion(const FileReference* file) override {
+    return file->type == ResourceFile::Type::kBinaryXml;
+  }
 
-      if (!SerializeXml(xml.get(), *file->path, false /*utf16*/, writer,
-                        file->file->WasCompressed() ? ArchiveEntry::kCompress : 0u)) {
-        context_->GetDiagnostics()->Error(android::DiagMessage(source_)
-                                          << "failed to serialize to proto XML: " << *file->path);
-        return false;
-      }
+  bool ConvertFile(FileReference* file, const io::IData* data, android::BigBuffer* out) override {
+    std::string error;
+    std::unique_ptr<xml::XmlResource> xml = xml::Inflate(data->data(), data->size(), &error);
+    if (xml == nullptr) {
+      context_->GetDiagnostics()->Error(android::DiagMessage(source_)
+                                        << "failed to parse binary XML: " << error);
+      return false;
+    }
 
-      file->type = ResourceFile::Type::kProtoXml;
-    } else {
-      if (!io::CopyFileToArchivePreserveCompression(context_, file->file, *file->path, writer)) {
-        context_->GetDiagnostics()->Error(android::DiagMessage(source_)
-                                          << "failed to copy file " << *file->path);
-        return false;
-      }
+    pb::XmlNode pb_node;
+    SerializeXmlResourceToPb(*xml, &pb_node);
+    const size_t size = pb_node.ByteSizeLong();
+    if (size > 0 && !pb_node.SerializeToArray(out->NextBlock<uint8_t>(size), size)) {
+      context_->GetDiagnostics()->Error(android::DiagMessage(source_)
+                                        << "failed to serialize to proto XML: " << *file->path);
+      return false;
     }
 
+    file->type = ResourceFile::Type::kProtoXml;
     return true;
   }
 
@@ -272,7 +356,7 @@ class Context : public IAaptContext {
 
 int Convert(IAaptContext* context, LoadedApk* apk, IArchiveWriter* output_writer,
             ApkFormat output_format, TableFlattenerOptions table_flattener_options,
-            XmlFlattenerOptions xml_flattener_options) {
+            XmlFlattenerOptions xml_flattener_options, size_t jobs) {
   unique_ptr<IApkSerializer> serializer;
   if (output_format == ApkFormat::kBinary) {
     serializer.reset(new BinaryApkSerializer(context, apk->GetSource(), table_flattener_options,
@@ -299,6 +383,7 @@ int Convert(IAaptContext* context, LoadedApk* apk, IArchiveWriter* output_writer
     auto converted_table = apk->GetResourceTable();
 
     std::unordered_set<std::string> files_written;
+    vector<FileReference*> files_to_write;
 
     // Resources
     for (const auto& package : converted_table->packages) {
@@ -315,11 +400,7 @@ int Convert(IAaptContext* context, LoadedApk* apk, IArchiveWriter* output_writer
 
               // Only serialize if we haven't seen this file before
               if (files_written.insert(*file->path).second) {
-                if (!serializer->SerializeFile(file, output_writer)) {
-                  context->GetDiagnostics()->Error(android::DiagMessage(apk->GetSource())
-                                                   << "failed to serialize file " << *file->path);
-                  return 1;
-                }
+                files_to_write.push_back(file);
               }
             } // file
           } // config_value
@@ -327,6 +408,12 @@ int Convert(IAaptContext* context, LoadedApk* apk, IArchiveWriter* output_writer
       } // type
     } // package
 
+    if (!serializer->SerializeFiles(files_to_write, jobs, output_writer)) {
+      context->GetDiagnostics()->Error(android::DiagMessage(apk->GetSource())
+                                       << "failed to serialize the resource files");
+      return 1;
+    }
+
     // Converted resource table
     if (!serializer->SerializeTable(converted_table, output_writer)) {
       context->GetDiagnostics()->Error(android::DiagMessage(apk->GetSource())
@@ -438,8 +525,18 @@ int ConvertCommand::Action(const std::vector<std::string>& args) {
     }
   }
 
+  size_t jobs = 1;
+  if (jobs_ && !android::base::ParseUint(jobs_.value(), &jobs)) {
+    context.GetDiagnostics()->Error(android::DiagMessage()
+                                    << "invalid value for -j: '" << jobs_.value() << "'");
+    return 1;
+  }
+  if (jobs == 0) {
+    jobs = ThreadPool::GetDefaultThreadCount();
+  }
+
   return Convert(&context, apk.get(), writer.get(), format, table_flattener_options_,
-                 xml_flattener_options_);
+                 xml_flattener_options_, jobs);
 }
 
 }  // namespace aapt
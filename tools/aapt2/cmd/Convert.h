@@ -73,6 +73,10 @@ class ConvertCommand : public Command {
         "store the same resource value only once in resource table which decreases APK size.\n"
         "Has no effect on APKs where resource names are kept.",
         &table_flattener_options_.deduplicate_entry_values);
+    AddOptionalFlag("-j",
+                    "Number of threads converting the resource files. Defaults to 1, 0 uses one\n"
+                    "thread per CPU core. The output is the same for any number of threads.",
+                    &jobs_);
     AddOptionalSwitch("-v", "Enables verbose logging", &verbose_);
   }
 
@@ -91,11 +95,12 @@ class ConvertCommand : public Command {
   bool force_sparse_encoding_ = false;
   bool enable_compact_entries_ = false;
   std::optional<std::string> resources_config_path_;
+  std::optional<std::string> jobs_;
 };
 
 int Convert(IAaptContext* context, LoadedApk* input, IArchiveWriter* output_writer,
             ApkFormat output_format,TableFlattenerOptions table_flattener_options,
-            XmlFlattenerOptions xml_flattener_options);
+            XmlFlattenerOptions xml_flattener_options, size_t jobs = 1);
 
 }  // namespace aapt
 
@@ -16,6 +16,8 @@
 
 #include "Convert.h"
 
+#include <map>
+
 #include "LoadedApk.h"
 #include "test/Common.h"
 #include "test/Test.h"
@@ -222,4 +224,58 @@ TEST_F(ConvertTest, ConvertWithResourceNameCollapsing) {
   }
 }
 
+static std::map<std::string, std::string> ReadEntries(const std::string& apk_path) {
+  std::map<std::string, std::string> entries;
+  ZipArchiveHandle handle;
+  if (OpenArchive(apk_path.c_str(), &handle) != 0) {
+    return entries;
+  }
+  void* cookie = nullptr;
+  if (StartIteration(handle, &cookie) == 0) {
+    ZipEntry entry;
+    std::string name;
+    while (Next(cookie, &entry, &name) == 0) {
+      std::string data(entry.uncompressed_length, '\0');
+      ExtractToMemory(handle, &entry, reinterpret_cast<uint8_t*>(data.data()), data.size());
+      entries.emplace(name, std::move(data));
+    }
+    EndIteration(cookie);
+  }
+  CloseArchive(handle);
+  return entries;
+}
+
+TEST_F(ConvertTest, ConvertInParallelMatchesSerialOutput) {
+  StdErrDiagnostics diag;
+  const std::string compiled_files_dir = GetTestPath("compiled");
+  for (int i = 0; i < 10; i++) {
+    ASSERT_TRUE(CompileFile(GetTestPath("res/xml/test" + std::to_string(i) + ".xml"),
+                            "<Item value=\"" + std::to_string(i) + "\"/>", compiled_files_dir,
+                            &diag));
+  }
+
+  const std::string proto_apk = GetTestPath("proto.apk");
+  std::vector<std::string> link_args = {
+      "--proto-format", "--manifest", GetDefaultManifest(), "-o", proto_apk,
+  };
+  ASSERT_TRUE(Link(link_args, compiled_files_dir, &diag));
+
+  for (const char* format : {"binary", "proto"}) {
+    SCOPED_TRACE(format);
+    const std::string serial_apk = GetTestPath("serial.apk");
+    ASSERT_THAT(ConvertCommand().Execute(
+                    {"-o", serial_apk, "--output-format", format, proto_apk}, &std::cerr),
+                Eq(0));
+    const std::string parallel_apk = GetTestPath("parallel.apk");
+    ASSERT_THAT(ConvertCommand().Execute(
+                    {"-o", parallel_apk, "--output-format", format, "-j", "3", proto_apk},
+                    &std::cerr),
+                Eq(0));
+
+    auto serial_entries = ReadEntries(serial_apk);
+    EXPECT_THAT(serial_entries, SizeIs(12));
+    EXPECT_THAT(ReadEntries(parallel_apk), Eq(serial_entries));
+  }
+}
+
 }  // namespace aapt
@@ -16,13 +16,17 @@
 
 #include "Dump.h"
 
+#include <algorithm>
 #include <cinttypes>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 #include "Debug.h"
 #include "Diagnostics.h"
 #include "LoadedApk.h"
 #include "Util.h"
+#include "android-base/parseint.h"
 #include "android-base/stringprintf.h"
 #include "androidfw/ConfigDescription.h"
 #include "androidfw/FileStream.h"
@@ -31,10 +35,12 @@
 #include "format/binary/BinaryResourceParser.h"
 #include "format/binary/XmlFlattener.h"
 #include "format/proto/ProtoDeserialize.h"
+#include "io/StringStream.h"
 #include "io/ZipArchive.h"
 #include "process/IResourceTableConsumer.h"
 #include "text/Printer.h"
 #include "util/Files.h"
+#include "util/ThreadPool.h"
 
 using ::aapt::text::Printer;
 using ::android::StringPiece;
@@ -131,6 +137,109 @@ class DumpContext : public IAaptContext {
 
 }  // namespace
 
+// Escapes the string so it can be placed between the quotes of a JSON string.
+static std::string JsonEscape(StringPiece str) {
+  std::string escaped;
+  escaped.reserve(str.size());
+  for (char c : str) {
+    switch (c) {
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      case '\t':
+        escaped += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          escaped += StringPrintf("\\u%04x", c);
+        } else {
+          escaped += c;
+        }
+        break;
+    }
+  }
+  return escaped;
+}
+
+int DumpApkCommand::DumpApk(const std::string& path, text::Printer* printer,
+                            android::IDiagnostics* diag) {
+  const ApkOutput output{printer, diag};
+  const ApkOutput* previous_output = std::exchange(apk_output_, &output);
+
+  // Most dumps only need the manifest, so the resource table is parsed on first use.
+  bool error = false;
+  auto loaded_apk = LoadedApk::LoadApkFromPath(path, diag, TableLoading::kLazy);
+  if (!loaded_apk) {
+    error = true;
+  } else {
+    error |= Dump(loaded_apk.get()) != 0;
+    error |= loaded_apk->FailedToLoadResourceTable();
+  }
+
+  apk_output_ = previous_output;
+  return error ? 1 : 0;
+}
+
+int DumpApkCommand::Action(const std::vector<std::string>& args) {
+  if (args.size() < 1) {
+    diag_->Error(android::DiagMessage() << "No dump apk specified.");
+    return 1;
+  }
+
+  size_t jobs = 1;
+  if (jobs_ && !android::base::ParseUint(jobs_.value(), &jobs)) {
+    diag_->Error(android::DiagMessage() << "invalid value for -j: '" << jobs_.value() << "'");
+    return 1;
+  }
+  if (jobs == 0) {
+    jobs = ThreadPool::GetDefaultThreadCount();
+  }
+
+  bool error = false;
+  if (jobs == 1 && !ndjson_) {
+    for (const std::string& apk : args) {
+      error |= DumpApk(apk, printer_, diag_) != 0;
+    }
+    return error;
+  }
+
+  // Each APK is dumped into its own buffer, which is written out whole once the APK is done so
+  // that the output of APKs on different threads does not interleave.
+  std::mutex mutex;
+  ThreadPool pool(std::min(jobs, args.size()));
+  for (const std::string& apk : args) {
+    pool.Post([this, &mutex, &error, &apk] {
+      std::string output;
+      BufferedDiagnostics diagnostics(diag_);
+      io::StringOutputStream stream(&output);
+      text::Printer printer(&stream);
+      const int result = DumpApk(apk, &printer, &diagnostics);
+      stream.Flush();
+
+      std::lock_guard<std::mutex> lock(mutex);
+      error |= result != 0;
+      diagnostics.Replay();
+      if (ndjson_) {
+        printer_->Print("{\"path\": \"")
+            .Print(JsonEscape(apk))
+            .Print(StringPrintf("\", \"exit_code\": %d, \"output\": \"", result))
+            .Print(JsonEscape(output))
+            .Println("\"}");
+      } else {
+        printer_->Print(output);
+      }
+    });
+  }
+  pool.Wait();
+  return error;
+}
+
 int DumpAPCCommand::Action(const std::vector<std::string>& args) {
   DumpContext context;
   DebugPrintTableOptions print_options;
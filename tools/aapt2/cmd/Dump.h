@@ -37,14 +37,23 @@ class DumpApkCommand : public Command {
                           android::IDiagnostics* diag)
       : Command(name), printer_(printer), diag_(diag) {
     SetDescription("Dump information about an APK or APC.");
+    AddOptionalFlag("-j",
+                    "Number of APKs to dump in parallel. Defaults to 1, 0 uses one thread per\n"
+                    "CPU core. Each APK is printed as soon as it is done, so with more than one\n"
+                    "job the APKs can be printed out of order.",
+                    &jobs_);
+    AddOptionalSwitch("--ndjson",
+                      "Print a JSON object per APK, one per line, with its \"path\",\n"
+                      "\"exit_code\" and \"output\". Diagnostics are still written to stderr.",
+                      &ndjson_);
   }
 
   text::Printer* GetPrinter() {
-    return printer_;
+    return apk_output_ != nullptr ? apk_output_->printer : printer_;
   }
 
   android::IDiagnostics* GetDiagnostics() {
-    return diag_;
+    return apk_output_ != nullptr ? apk_output_->diag : diag_;
   }
 
   std::optional<std::string> GetPackageName(LoadedApk* apk) {
@@ -65,29 +74,24 @@ class DumpApkCommand : public Command {
   /** Perform the dump operation on the apk. */
   virtual int Dump(LoadedApk* apk) = 0;
 
-  int Action(const std::vector<std::string>& args) final {
-    if (args.size() < 1) {
-      diag_->Error(android::DiagMessage() << "No dump apk specified.");
-      return 1;
-    }
+  int Action(const std::vector<std::string>& args) final;
 
-    bool error = false;
-    for (auto apk : args) {
-      auto loaded_apk = LoadedApk::LoadApkFromPath(apk, diag_);
-      if (!loaded_apk) {
-        error = true;
-        continue;
-      }
+ private:
+  // Where the APK that the calling thread is dumping goes, while APKs are dumped in parallel.
+  struct ApkOutput {
+    text::Printer* printer;
+    android::IDiagnostics* diag;
+  };
 
-      error |= Dump(loaded_apk.get());
-    }
+  // Loads the APK and dumps it to printer and diag. Returns 0 on success.
+  int DumpApk(const std::string& path, text::Printer* printer, android::IDiagnostics* diag);
 
-    return error;
-  }
+  static inline thread_local const ApkOutput* apk_output_ = nullptr;
 
- private:
   text::Printer* printer_;
   android::IDiagnostics* diag_;
+  std::optional<std::string> jobs_;
+  bool ndjson_ = false;
 };
 
 /** Command that prints contents of files generated from the compilation stage. */
@@ -91,6 +91,25 @@ TEST_F(DumpTest, DumpBadgingAllComponents) {
   ASSERT_EQ(output, expected);
 }
 
+TEST_F(DumpTest, DumpBadgingWithLazyTable) {
+  auto apk_path = file::BuildPath(
+      {android::base::GetExecutableDirectory(), "integration-tests", "DumpTest", "components.apk"});
+  auto loaded_apk = LoadedApk::LoadApkFromPath(apk_path, &noop_diag, TableLoading::kLazy);
+  ASSERT_THAT(loaded_apk, Ne(nullptr));
+
+  std::string output;
+  DumpBadgingToString(loaded_apk.get(), &output, /* include_meta_data= */ true);
+  EXPECT_FALSE(loaded_apk->FailedToLoadResourceTable());
+  EXPECT_THAT(loaded_apk->GetResourceTable(), Ne(nullptr));
+
+  std::string expected;
+  auto expected_path =
+      file::BuildPath({android::base::GetExecutableDirectory(), "integration-tests", "DumpTest",
+                       "components_expected.txt"});
+  ::android::base::ReadFileToString(expected_path, &expected);
+  ASSERT_EQ(output, expected);
+}
+
 TEST_F(DumpTest, DumpBadgingPermissionsOnly) {
   auto apk_path = file::BuildPath(
       {android::base::GetExecutableDirectory(), "integration-tests", "DumpTest", "components.apk"});
@@ -125,4 +144,54 @@ TEST_F(DumpTest, DumpBadgingApkBuiltWithAaptAndTagsInWrongPlace) {
   ASSERT_EQ(output, expected);
 }
 
+TEST_F(DumpTest, DumpBadgingOfSeveralApksInParallel) {
+  auto apk_path = file::BuildPath(
+      {android::base::GetExecutableDirectory(), "integration-tests", "DumpTest", "components.apk"});
+
+  std::string output;
+  StringOutputStream output_stream(&output);
+  Printer printer(&output_stream);
+  DumpBadgingCommand command(&printer, &noop_diag);
+  ASSERT_EQ(
+      command.Execute({"--include-meta-data", "-j", "2", apk_path, apk_path}, &std::cerr), 0);
+  output_stream.Flush();
+
+  std::string expected;
+  auto expected_path =
+      file::BuildPath({android::base::GetExecutableDirectory(), "integration-tests", "DumpTest",
+                       "components_expected.txt"});
+  ::android::base::ReadFileToString(expected_path, &expected);
+
+  // Each APK is printed whole, without interleaving with the other.
+  ASSERT_EQ(output, expected + expected);
+}
+
+TEST_F(DumpTest, DumpPackageNameAsNdjson) {
+  auto apk_path = file::BuildPath(
+      {android::base::GetExecutableDirectory(), "integration-tests", "DumpTest", "minimal.apk"});
+
+  std::string output;
+  StringOutputStream output_stream(&output);
+  Printer printer(&output_stream);
+  DumpPackageNameCommand command(&printer, &noop_diag);
+  ASSERT_EQ(command.Execute({"--ndjson", apk_path, apk_path}, &std::cerr), 0);
+  output_stream.Flush();
+
+  std::string package_name;
+  {
+    StringOutputStream package_name_stream(&package_name);
+    Printer package_name_printer(&package_name_stream);
+    DumpPackageNameCommand plain_command(&package_name_printer, &noop_diag);
+    ASSERT_EQ(plain_command.Execute({apk_path}, &std::cerr), 0);
+    package_name_stream.Flush();
+  }
+  ASSERT_FALSE(package_name.empty());
+  ASSERT_EQ(package_name.back(), '\n');
+  package_name.pop_back();
+
+  const std::string line = "{\"path\": \"" + apk_path + "\", \"exit_code\": 0, \"output\": \"" +
+                           package_name + "\\n\"}\n";
+  EXPECT_EQ(output, line + line);
+}
+
 }  // namespace aapt
@@ -20,6 +20,9 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <condition_variable>
+#include <map>
+#include <mutex>
 #include <queue>
 #include <unordered_map>
 #include <vector>
@@ -34,7 +37,9 @@
 #include "android-base/errors.h"
 #include "android-base/expected.h"
 #include "android-base/file.h"
+#include "android-base/parseint.h"
 #include "android-base/stringprintf.h"
+#include "androidfw/BigBuffer.h"
 #include "androidfw/BigBufferStream.h"
 #include "androidfw/FileStream.h"
 #include "androidfw/IDiagnostics.h"
@@ -51,6 +56,7 @@
 #include "format/proto/ProtoDeserialize.h"
 #include "format/proto/ProtoSerialize.h"
 #include "io/FileSystem.h"
+#include "io/StringStream.h"
 #include "io/Util.h"
 #include "io/ZipArchive.h"
 #include "java/JavaClassGenerator.h"
@@ -58,6 +64,7 @@
 #include "java/ProguardRules.h"
 #include "link/FeatureFlagsFilter.h"
 #include "link/FlagDisabledResourceRemover.h"
+#include "link/LinkSnapshot.h"
 #include "link/Linkers.h"
 #include "link/ManifestFixer.h"
 #include "link/NoDefaultResourceRemover.h"
@@ -73,6 +80,7 @@
 #include "split/TableSplitter.h"
 #include "trace/TraceBuffer.h"
 #include "util/Files.h"
+#include "util/ThreadPool.h"
 #include "xml/XmlDom.h"
 
 using ::android::ConfigDescription;
@@ -244,9 +252,10 @@ class FeatureSplitSymbolTableDelegate : public DefaultSymbolTableDelegate {
   IAaptContext* context_;
 };
 
+// If buffer_pool is set, the binary XML is flattened into blocks recycled from previous files.
 static bool FlattenXml(IAaptContext* context, const xml::XmlResource& xml_res, StringPiece path,
                        bool keep_raw_values, bool utf16, OutputFormat format,
-                       IArchiveWriter* writer) {
+                       IArchiveWriter* writer, android::BigBufferPool* buffer_pool = nullptr) {
   TRACE_CALL();
   if (context->IsVerbose()) {
     context->GetDiagnostics()->Note(android::DiagMessage(path)
@@ -256,7 +265,8 @@ static bool FlattenXml(IAaptContext* context, const xml::XmlResource& xml_res, S
 
   switch (format) {
     case OutputFormat::kApk: {
-      android::BigBuffer buffer(1024);
+      android::BigBuffer buffer = buffer_pool != nullptr ? android::BigBuffer(buffer_pool)
+                                                         : android::BigBuffer(1024);
       XmlFlattenerOptions options = {};
       options.keep_raw_values = keep_raw_values;
       options.use_utf16 = utf16;
@@ -382,11 +392,21 @@ class ResourceFileFlattener {
   IAaptContext* context_;
   proguard::KeepSet* keep_set_;
   XmlCompatVersioner::Rules rules_;
+
+  // Shared by all the XML files flattened, so the flags are only indexed once.
+  FeatureFlagsFilter flags_filter_;
+
+  // Shared by all the XML files flattened, which are written out one at a time.
+  android::BigBufferPool xml_buffer_pool_;
 };
 
 ResourceFileFlattener::ResourceFileFlattener(const ResourceFileFlattenerOptions& options,
                                              IAaptContext* context, proguard::KeepSet* keep_set)
-    : options_(options), context_(context), keep_set_(keep_set) {
+    : options_(options),
+      context_(context),
+      keep_set_(keep_set),
+      flags_filter_(options.feature_flag_values, {.flags_must_be_readonly = true}),
+      xml_buffer_pool_(1024) {
   SymbolTable* symm = context_->GetExternalSymbols();
 
   // Build up the rules for degrading newer attributes to older ones.
@@ -673,15 +693,13 @@ bool ResourceFileFlattener::Flatten(ResourceTable* table, IArchiveWriter* archiv
               }
             }
 
-            FeatureFlagsFilterOptions flags_filter_options;
-            flags_filter_options.flags_must_be_readonly = true;
-            FeatureFlagsFilter flags_filter(options_.feature_flag_values, flags_filter_options);
-            if (!flags_filter.Consume(context_, doc.get())) {
+            if (!flags_filter_.Consume(context_, doc.get())) {
               return 1;
             }
 
             error |= !FlattenXml(context_, *doc, dst_path, options_.keep_raw_values,
-                                 false /*utf16*/, options_.output_format, archive_writer);
+                                 false /*utf16*/, options_.output_format, archive_writer,
+                                 &xml_buffer_pool_);
           }
         } else {
           error |= !io::CopyFileToArchive(context_, file_op.file_to_copy, file_op.dst_path,
@@ -1191,7 +1209,7 @@ class Linker {
     if (options_.output_to_directory) {
       return CreateDirectoryArchiveWriter(context_->GetDiagnostics(), out);
     } else {
-      return CreateZipFileArchiveWriter(context_->GetDiagnostics(), out);
+      return CreateZipFileArchiveWriter(context_->GetDiagnostics(), out, options_.jobs);
     }
   }
 
@@ -1272,11 +1290,83 @@ class Linker {
     return true;
   }
 
+  // An R class to compile into the --java-classes-jar.
+  struct RClassJob {
+    std::string package_name_to_generate;
+    std::string out_package;
+    JavaClassGeneratorOptions options;
+
+    std::vector<ClassFile> classes;
+    std::string error;
+    bool succeeded = false;
+  };
+
+  // Compiles the R classes on options_.jobs threads, one package per task, and writes them to the
+  // jar. A class written by several jobs is taken from the last one, as with R.java files.
+  bool WriteJavaClassesJar(std::vector<RClassJob>* jobs) {
+    TRACE_CALL();
+    const std::string& out_path = options_.generate_java_classes_jar_path.value();
+    {
+      ThreadPool pool(std::min(options_.jobs, jobs->size()));
+      for (RClassJob& job : *jobs) {
+        pool.Post([this, &job] {
+          JavaClassGenerator generator(context_, &final_table_, job.options);
+          job.succeeded =
+              generator.GenerateClassFiles(job.package_name_to_generate, job.out_package,
+                                           &job.classes);
+          if (!job.succeeded) {
+            job.error = generator.GetError();
+          }
+        });
+      }
+    }
+
+    std::map<std::string, const ClassFile*> classes_by_path;
+    for (const RClassJob& job : *jobs) {
+      if (!job.succeeded) {
+        context_->GetDiagnostics()->Error(android::DiagMessage(out_path) << job.error);
+        return false;
+      }
+      for (const ClassFile& class_file : job.classes) {
+        classes_by_path[class_file.path] = &class_file;
+      }
+    }
+
+    std::unique_ptr<IArchiveWriter> writer =
+        CreateZipFileArchiveWriter(context_->GetDiagnostics(), out_path, options_.jobs);
+    if (!writer) {
+      return false;
+    }
+    for (const auto& [path, class_file] : classes_by_path) {
+      io::StringInputStream input(class_file->data);
+      if (!writer->WriteFile(path, ArchiveEntry::kCompress, &input)) {
+        context_->GetDiagnostics()->Error(android::DiagMessage(out_path)
+                                          << "failed to write " << path << ": "
+                                          << writer->GetError());
+        return false;
+      }
+    }
+    return true;
+  }
+
   bool GenerateJavaClasses() {
     TRACE_CALL();
     // The set of packages whose R class to call in the main classes onResourcesLoaded callback.
     std::vector<std::string> packages_to_callback;
 
+    // Writes R.java and R.txt as requested, and queues the R class for the jar if there is one.
+    std::vector<RClassJob> class_jobs;
+    auto generate = [&](StringPiece package_name_to_generate, StringPiece out_package,
+                        const JavaClassGeneratorOptions& java_options,
+                        const std::optional<std::string>& out_text_symbols_path = {}) {
+      if (options_.generate_java_classes_jar_path) {
+        class_jobs.push_back(RClassJob{std::string(package_name_to_generate),
+                                       std::string(out_package), java_options});
+      }
+      return WriteJavaFile(&final_table_, package_name_to_generate, out_package, java_options,
+                           out_text_symbols_path);
+    };
+
     JavaClassGeneratorOptions template_options;
     template_options.types = JavaClassGeneratorOptions::SymbolTypes::kAll;
     template_options.javadoc_annotations = options_.javadoc_annotations;
@@ -1305,8 +1395,7 @@ class Linker {
       // to the original package, and private and public symbols to the private package.
       JavaClassGeneratorOptions options = template_options;
       options.types = JavaClassGeneratorOptions::SymbolTypes::kPublicPrivate;
-      if (!WriteJavaFile(&final_table_, actual_package, options_.private_symbols.value(),
-                         options)) {
+      if (!generate(actual_package, options_.private_symbols.value(), options)) {
         return false;
       }
     }
@@ -1318,7 +1407,7 @@ class Linker {
 
       JavaClassGeneratorOptions options = template_options;
       options.types = JavaClassGeneratorOptions::SymbolTypes::kAll;
-      if (!WriteJavaFile(&final_table_, actual_package, extra_package, options)) {
+      if (!generate(actual_package, extra_package, options)) {
         return false;
       }
     }
@@ -1330,7 +1419,7 @@ class Linker {
 
       JavaClassGeneratorOptions options = template_options;
       options.types = JavaClassGeneratorOptions::SymbolTypes::kAll;
-      if (!WriteJavaFile(&final_table_, package, package, options)) {
+      if (!generate(package, package, options)) {
         return false;
       }
     }
@@ -1348,11 +1437,13 @@ class Linker {
           std::move(packages_to_callback);
     }
 
-    if (!WriteJavaFile(&final_table_, actual_package, output_package, options,
-                       options_.generate_text_symbols_path)) {
+    if (!generate(actual_package, output_package, options, options_.generate_text_symbols_path)) {
       return false;
     }
 
+    if (options_.generate_java_classes_jar_path) {
+      return WriteJavaClassesJar(&class_jobs);
+    }
     return true;
   }
 
@@ -1557,131 +1648,252 @@ class Linker {
       return false;
     }
 
-    bool error = false;
+    std::vector<io::IFile*> files;
     for (auto iter = collection->Iterator(); iter->HasNext();) {
-      if (!MergeFile(iter->Next(), override)) {
-        error = true;
-      }
+      files.push_back(iter->Next());
     }
+    const bool result = MergeFiles(files, override, false /* stop_on_error */);
 
     // Make sure to move the collection into the set of IFileCollections.
     collections_.push_back(std::move(collection));
-    return !error;
+    return result;
   }
 
-  // Takes a path to load and merge into the main ResourceTable. If override is true,
+  // Takes paths to load and merge into the main ResourceTable, in order. If override is true,
   // conflicting resources are allowed to override each other, in order of last seen.
-  // If the file path ends with .flata, .jar, .jack, or .zip the file is treated
+  // If a file path ends with .flata, .jar, .jack, or .zip the file is treated
   // as ZIP archive and the files within are merged individually.
-  // Otherwise the file is processed on its own.
-  bool MergePath(const std::string& path, bool override) {
-    if (util::EndsWith(path, ".flata") || util::EndsWith(path, ".jar") ||
-        util::EndsWith(path, ".jack") || util::EndsWith(path, ".zip")) {
-      return MergeArchive(path, override);
-    } else if (util::EndsWith(path, ".apk")) {
-      return MergeStaticLibrary(path, override);
-    }
+  // Otherwise the file is processed on its own, and runs of such files are loaded together.
+  // Stops at the first path that fails to merge.
+  bool MergePaths(const std::vector<std::string>& paths, bool override) {
+    std::vector<io::IFile*> pending_files;
+    auto merge_pending_files = [&]() {
+      const bool result = MergeFiles(pending_files, override, true /* stop_on_error */);
+      pending_files.clear();
+      return result;
+    };
 
-    io::IFile* file = file_collection_->InsertFile(path);
-    return MergeFile(file, override);
+    for (const std::string& path : paths) {
+      const bool is_archive = util::EndsWith(path, ".flata") || util::EndsWith(path, ".jar") ||
+                              util::EndsWith(path, ".jack") || util::EndsWith(path, ".zip");
+      const bool is_static_library = util::EndsWith(path, ".apk");
+      if (!is_archive && !is_static_library) {
+        pending_files.push_back(file_collection_->InsertFile(path));
+        continue;
+      }
+
+      if (!merge_pending_files()) {
+        return false;
+      }
+      if (!(is_archive ? MergeArchive(path, override) : MergeStaticLibrary(path, override))) {
+        return false;
+      }
+    }
+    return merge_pending_files();
   }
 
-  // Takes an AAPT Container file (.apc/.flat) to load and merge into the main ResourceTable.
-  // If override is true, conflicting resources are allowed to override each other, in order of last
-  // seen.
-  // All other file types are ignored. This is because these files could be coming from a zip,
-  // where we could have other files like classes.dex.
-  bool MergeFile(io::IFile* file, bool override) {
-    TRACE_CALL();
-    const android::Source& src = file->GetSource();
+  enum class MergeFileAction { kLoad, kSkip, kRejectUncompiled };
 
+  // Decides what to do with a file given to link. Only AAPT Container files (.apc/.flat) are
+  // merged. All other file types are ignored. This is because these files could be coming from a
+  // zip, where we could have other files like classes.dex.
+  MergeFileAction GetMergeFileAction(io::IFile* file) {
+    const android::Source& src = file->GetSource();
     if (util::EndsWith(src.path, ".xml") || util::EndsWith(src.path, ".png")) {
-      // Since AAPT compiles these file types and appends .flat to them, seeing
-      // their raw extensions is a sign that they weren't compiled.
-      const StringPiece file_type = util::EndsWith(src.path, ".xml") ? "XML" : "PNG";
-      context_->GetDiagnostics()->Error(android::DiagMessage(src)
-                                        << "uncompiled " << file_type
-                                        << " file passed as argument. Must be "
-                                           "compiled first into .flat file.");
-      return false;
+      return MergeFileAction::kRejectUncompiled;
     } else if (!util::EndsWith(src.path, ".apc") && !util::EndsWith(src.path, ".flat")) {
       if (context_->IsVerbose()) {
-        context_->GetDiagnostics()->Warn(android::DiagMessage(src) << "ignoring unrecognized file");
-        return true;
+        return MergeFileAction::kSkip;
       }
     }
+    return MergeFileAction::kLoad;
+  }
 
-    std::unique_ptr<android::InputStream> input_stream = file->OpenInputStream();
-    if (input_stream == nullptr) {
-      context_->GetDiagnostics()->Error(android::DiagMessage(src) << "failed to open file");
-      return false;
-    }
+  // The contents of an AAPT Container file, deserialized ahead of being merged. Containers are
+  // loaded on the thread pool, so errors are recorded here rather than logged.
+  struct LoadedContainer {
+    struct Entry {
+      // Set for a compiled resource table, otherwise the entry is a compiled file.
+      std::unique_ptr<ResourceTable> table;
+      ResourceFile compiled_file;
+      off64_t offset = 0;
+      size_t len = 0;
+    };
 
-    if (input_stream->HadError()) {
-      context_->GetDiagnostics()->Error(android::DiagMessage(src)
-                                        << "failed to open file: " << input_stream->GetError());
-      return false;
+    MergeFileAction action = MergeFileAction::kLoad;
+    // The opened container, the compiled files are segments of it. Keeping it avoids mapping or
+    // extracting the whole container again every time one of its files is opened.
+    std::shared_ptr<io::IData> data;
+    std::vector<Entry> entries;
+    // Set if loading stopped early. The entries before the failure are still merged.
+    std::string error;
+    bool done = false;
+  };
+
+  static void LoadContainer(const android::Source& src, android::InputStream* in,
+                            LoadedContainer* out_container) {
+    if (in->HadError()) {
+      out_container->error = "failed to open file: " + in->GetError();
+      return;
     }
 
     ContainerReaderEntry* entry;
-    ContainerReader reader(input_stream.get());
+    ContainerReader reader(in);
 
     if (reader.HadError()) {
-      context_->GetDiagnostics()->Error(android::DiagMessage(src)
-                                        << "failed to read file: " << reader.GetError());
-      return false;
+      out_container->error = "failed to read file: " + reader.GetError();
+      return;
     }
 
     while ((entry = reader.Next()) != nullptr) {
       if (entry->Type() == ContainerEntryType::kResTable) {
-        TRACE_NAME(std::string("Process ResTable:") + file->GetSource().path);
+        TRACE_NAME(std::string("Process ResTable:") + src.path);
         pb::ResourceTable pb_table;
         if (!entry->GetResTable(&pb_table)) {
-          context_->GetDiagnostics()->Error(
-              android::DiagMessage(src) << "failed to read resource table: " << entry->GetError());
-          return false;
+          out_container->error = "failed to read resource table: " + entry->GetError();
+          return;
         }
 
-        ResourceTable table;
+        auto table = util::make_unique<ResourceTable>();
         std::string error;
-        if (!DeserializeTableFromPb(pb_table, nullptr /*files*/, &table, &error)) {
-          context_->GetDiagnostics()->Error(android::DiagMessage(src)
-                                            << "failed to deserialize resource table: " << error);
-          return false;
-        }
-
-        if (!table_merger_->Merge(src, &table, override)) {
-          context_->GetDiagnostics()->Error(android::DiagMessage(src)
-                                            << "failed to merge resource table");
-          return false;
+        if (!DeserializeTableFromPb(pb_table, nullptr /*files*/, table.get(), &error)) {
+          out_container->error = "failed to deserialize resource table: " + error;
+          return;
         }
+        out_container->entries.push_back(LoadedContainer::Entry{std::move(table)});
       } else if (entry->Type() == ContainerEntryType::kResFile) {
-        TRACE_NAME(std::string("Process ResFile") + file->GetSource().path);
+        TRACE_NAME(std::string("Process ResFile") + src.path);
         pb::internal::CompiledFile pb_compiled_file;
-        off64_t offset;
-        size_t len;
-        if (!entry->GetResFileOffsets(&pb_compiled_file, &offset, &len)) {
-          context_->GetDiagnostics()->Error(
-              android::DiagMessage(src) << "failed to get resource file: " << entry->GetError());
-          return false;
+        LoadedContainer::Entry loaded_entry;
+        if (!entry->GetResFileOffsets(&pb_compiled_file, &loaded_entry.offset, &loaded_entry.len)) {
+          out_container->error = "failed to get resource file: " + entry->GetError();
+          return;
         }
 
-        ResourceFile resource_file;
         std::string error;
-        if (!DeserializeCompiledFileFromPb(pb_compiled_file, &resource_file, &error)) {
-          context_->GetDiagnostics()->Error(android::DiagMessage(src)
-                                            << "failed to read compiled header: " << error);
-          return false;
+        if (!DeserializeCompiledFileFromPb(pb_compiled_file, &loaded_entry.compiled_file, &error)) {
+          out_container->error = "failed to read compiled header: " + error;
+          return;
         }
+        out_container->entries.push_back(std::move(loaded_entry));
+      }
+    }
+  }
+
+  // Merges a container that has finished loading into the main ResourceTable.
+  bool MergeLoadedContainer(io::IFile* file, LoadedContainer* container, bool override) {
+    TRACE_CALL();
+    const android::Source& src = file->GetSource();
+
+    if (container->action == MergeFileAction::kRejectUncompiled) {
+      // Since AAPT compiles these file types and appends .flat to them, seeing
+      // their raw extensions is a sign that they weren't compiled.
+      const StringPiece file_type = util::EndsWith(src.path, ".xml") ? "XML" : "PNG";
+      context_->GetDiagnostics()->Error(android::DiagMessage(src)
+                                        << "uncompiled " << file_type
+                                        << " file passed as argument. Must be "
+                                           "compiled first into .flat file.");
+      return false;
+    } else if (container->action == MergeFileAction::kSkip) {
+      context_->GetDiagnostics()->Warn(android::DiagMessage(src) << "ignoring unrecognized file");
+      return true;
+    }
 
-        if (!MergeCompiledFile(resource_file, file->CreateFileSegment(offset, len), override)) {
+    for (LoadedContainer::Entry& entry : container->entries) {
+      if (entry.table) {
+        if (!table_merger_->Merge(src, entry.table.get(), override)) {
+          context_->GetDiagnostics()->Error(android::DiagMessage(src)
+                                            << "failed to merge resource table");
           return false;
         }
+        entry.table.reset();
+      } else if (!MergeCompiledFile(
+                     entry.compiled_file,
+                     file->CreateFileSegment(entry.offset, entry.len, container->data), override)) {
+        return false;
       }
     }
+
+    if (!container->error.empty()) {
+      context_->GetDiagnostics()->Error(android::DiagMessage(src) << container->error);
+      return false;
+    }
     return true;
   }
 
+  // Takes AAPT Container files (.apc/.flat) to load and merge into the main ResourceTable.
+  // If override is true, conflicting resources are allowed to override each other, in order of
+  // last seen.
+  // Reading and deserializing the containers is independent per file and runs on the thread pool,
+  // while merging happens on this thread in the order the files were given, so the resulting
+  // table does not depend on the number of threads.
+  bool MergeFiles(const std::vector<io::IFile*>& files, bool override, bool stop_on_error) {
+    TRACE_CALL();
+    std::vector<LoadedContainer> containers(files.size());
+    std::mutex mutex;
+    std::condition_variable container_loaded;
+    size_t next_to_merge = 0;
+    bool error = false;
+
+    // Merges the containers that are ready, in order. When `wait` is set, blocks until every
+    // container has been merged. Returns false if merging should stop.
+    auto merge_containers = [&](bool wait) {
+      while (next_to_merge < containers.size()) {
+        LoadedContainer* container = &containers[next_to_merge];
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          if (wait) {
+            container_loaded.wait(lock, [container] { return container->done; });
+          } else if (!container->done) {
+            return true;
+          }
+        }
+        if (!MergeLoadedContainer(files[next_to_merge], container, override)) {
+          error = true;
+          if (stop_on_error) {
+            return false;
+          }
+        }
+        containers[next_to_merge++] = LoadedContainer{};
+      }
+      return true;
+    };
+
+    ThreadPool pool(files.size() > 1 ? options_.jobs : 1);
+    for (size_t i = 0; i < files.size(); i++) {
+      LoadedContainer* container = &containers[i];
+      container->action = GetMergeFileAction(files[i]);
+      std::shared_ptr<io::IData> data;
+      if (container->action == MergeFileAction::kLoad) {
+        // Files are opened on this thread, since entries of the same archive share a handle.
+        data = files[i]->OpenAsData();
+        if (data == nullptr) {
+          container->error = "failed to open file";
+        }
+        container->data = data;
+      }
+
+      if (data == nullptr) {
+        container->done = true;
+      } else {
+        pool.Post([&mutex, &container_loaded, src = files[i]->GetSource(), data, container] {
+          LoadContainer(src, data.get(), container);
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            container->done = true;
+          }
+          container_loaded.notify_all();
+        });
+      }
+
+      if (!merge_containers(false /* wait */)) {
+        return false;
+      }
+    }
+    merge_containers(true /* wait */);
+    return !error;
+  }
+
   bool CopyAssetsDirsToApk(IArchiveWriter* writer) {
     std::map<std::string, std::unique_ptr<io::RegularFile>> merged_assets;
     for (const std::string& assets_dir : options_.assets_dirs) {
@@ -1881,20 +2093,7 @@ class Linker {
     TRACE_CALL();
 
     FlagDisabledStringVisitor visitor(table->string_pool);
-
-    for (auto& package : table->packages) {
-      for (auto& type : package->types) {
-        for (auto& entry : type->entries) {
-          for (auto& config_value : entry->values) {
-            if (config_value->value->GetFlagStatus() == FlagStatus::Disabled) {
-              config_value->value->Accept(&visitor);
-            }
-          }
-        }
-      }
-    }
-
-    if (!FlagDisabledResourceRemover{}.Consume(context_, table)) {
+    if (!FlagDisabledResourceRemover{&visitor}.Consume(context_, table)) {
       context_->GetDiagnostics()->Error(android::DiagMessage()
                                         << "failed removing resources behind disabled flags");
       return 1;
@@ -2098,18 +2297,14 @@ class Linker {
       }
     }
 
-    for (const std::string& input : input_files) {
-      if (!MergePath(input, false)) {
-        context_->GetDiagnostics()->Error(android::DiagMessage() << "failed parsing input");
-        return 1;
-      }
+    if (!MergePaths(input_files, false)) {
+      context_->GetDiagnostics()->Error(android::DiagMessage() << "failed parsing input");
+      return 1;
     }
 
-    for (const std::string& input : options_.overlay_files) {
-      if (!MergePath(input, true)) {
-        context_->GetDiagnostics()->Error(android::DiagMessage() << "failed parsing overlays");
-        return 1;
-      }
+    if (!MergePaths(options_.overlay_files, true)) {
+      context_->GetDiagnostics()->Error(android::DiagMessage() << "failed parsing overlays");
+      return 1;
     }
 
     if (!VerifyNoExternalPackages()) {
@@ -2133,7 +2328,7 @@ class Linker {
       }
 
       // Now grab each ID and emit it as a file.
-      if (options_.resource_id_map_path) {
+      if (options_.resource_id_map_path || options_.incremental_id_map_path) {
         for (auto& package : final_table_.packages) {
           for (auto& type : package->types) {
             for (auto& entry : type->entries) {
@@ -2144,10 +2339,16 @@ class Linker {
           }
         }
 
-        if (!WriteStableIdMapToPath(context_->GetDiagnostics(), options_.stable_id_map,
+        if (options_.resource_id_map_path &&
+            !WriteStableIdMapToPath(context_->GetDiagnostics(), options_.stable_id_map,
                                     options_.resource_id_map_path.value())) {
           return 1;
         }
+        if (options_.incremental_id_map_path &&
+            !WriteStableIdMapToPath(context_->GetDiagnostics(), options_.stable_id_map,
+                                    options_.incremental_id_map_path.value())) {
+          return 1;
+        }
       }
     } else {
       // Static libs are merged with other apps, and ID collisions are bad, so
@@ -2387,7 +2588,8 @@ class Linker {
       return 1;
     };
 
-    if (options_.generate_java_class_path || options_.generate_text_symbols_path) {
+    if (options_.generate_java_class_path || options_.generate_java_classes_jar_path ||
+        options_.generate_text_symbols_path) {
       if (!GenerateJavaClasses()) {
         return 1;
       }
@@ -2519,6 +2721,18 @@ int LinkCommand::Action(const std::vector<std::string>& args) {
     options_.output_format = OutputFormat::kProto;
   }
 
+  if (jobs_) {
+    if (!android::base::ParseUint(jobs_.value(), &options_.jobs)) {
+      context.GetDiagnostics()->Error(android::DiagMessage()
+                                      << "invalid value for -j: '" << jobs_.value() << "'");
+      return 1;
+    }
+    if (options_.jobs == 0) {
+      options_.jobs = ThreadPool::GetDefaultThreadCount();
+    }
+  }
+  options_.table_flattener_options.jobs = options_.jobs;
+
   if (package_id_) {
     if (context.GetPackageType() != PackageType::kApp) {
       context.GetDiagnostics()->Error(
@@ -2652,8 +2866,84 @@ int LinkCommand::Action(const std::vector<std::string>& args) {
     options_.no_version_transitions = true;
   }
 
+  std::unique_ptr<LinkSnapshot> snapshot;
+  if (incremental_dir_) {
+    snapshot = LinkSnapshot::Open(incremental_dir_.value(), context.GetDiagnostics());
+    if (!snapshot) {
+      return 1;
+    }
+
+    for (const std::string& arg : GetExecutedArgs()) {
+      snapshot->AddOption(arg);
+      if (util::StartsWith(arg, "@")) {
+        snapshot->AddInput(arg.substr(1));
+      }
+    }
+    snapshot->AddInput(options_.manifest_path);
+    for (const std::string& path : options_.include_paths) {
+      snapshot->AddInput(path);
+    }
+    for (const std::string& path : options_.assets_dirs) {
+      snapshot->AddInput(path);
+    }
+    for (const std::string& path : arg_list) {
+      snapshot->AddInput(path);
+    }
+    for (const std::string& path : options_.overlay_files) {
+      snapshot->AddInput(path);
+    }
+    if (stable_id_file_path_) {
+      snapshot->AddInput(stable_id_file_path_.value());
+    }
+
+    snapshot->AddOutput(options_.output_path);
+    for (const std::string& path : options_.split_paths) {
+      snapshot->AddOutput(path);
+    }
+    for (const auto& path : {options_.generate_java_class_path,
+                             options_.generate_java_classes_jar_path,
+                             options_.generate_proguard_rules_path,
+                             options_.generate_main_dex_proguard_rules_path,
+                             options_.generate_text_symbols_path,
+                             options_.resource_id_map_path}) {
+      if (path) {
+        snapshot->AddOutput(path.value());
+      }
+    }
+
+    std::vector<std::string> changed_inputs;
+    if (snapshot->IsUpToDate(&changed_inputs)) {
+      if (context.IsVerbose()) {
+        context.GetDiagnostics()->Note(android::DiagMessage()
+                                       << "outputs are up to date, skipping link");
+      }
+      return 0;
+    }
+    if (context.IsVerbose()) {
+      for (const std::string& path : changed_inputs) {
+        context.GetDiagnostics()->Note(android::DiagMessage(path) << "input changed");
+      }
+    }
+
+    // Start from the IDs of the previous link, so that unchanged resources keep their IDs.
+    if (context.GetPackageType() != PackageType::kStaticLib) {
+      options_.incremental_id_map_path = snapshot->GetIdsPath();
+      if (!stable_id_file_path_ &&
+          file::GetFileType(snapshot->GetIdsPath()) == file::FileType::kRegular &&
+          !LoadStableIdMap(context.GetDiagnostics(), snapshot->GetIdsPath(),
+                           &options_.stable_id_map)) {
+        return 1;
+      }
+    }
+  }
+
   Linker cmd(&context, options_);
-  return cmd.Run(arg_list);
+  const int result = cmd.Run(arg_list);
+  if (result == 0 && snapshot) {
+    // A snapshot that could not be saved only costs the next link its shortcut.
+    snapshot->Save();
+  }
+  return result;
 }
 
 }  // namespace aapt
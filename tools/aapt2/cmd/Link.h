@@ -55,6 +55,7 @@ struct LinkOptions {
 
   // Java/Proguard options.
   std::optional<std::string> generate_java_class_path;
+  std::optional<std::string> generate_java_classes_jar_path;
   std::optional<std::string> custom_java_package;
   std::set<std::string> extra_java_packages;
   std::optional<std::string> generate_text_symbols_path;
@@ -107,6 +108,9 @@ struct LinkOptions {
   std::unordered_map<ResourceName, ResourceId> stable_id_map;
   std::optional<std::string> resource_id_map_path;
 
+  // Where to record the assigned IDs for the next incremental link.
+  std::optional<std::string> incremental_id_map_path;
+
   // When 'true', allow reserved package IDs to be used for applications. Pre-O, the platform
   // treats negative resource IDs [those with a package ID of 0x80 or higher] as invalid.
   // In order to work around this limitation, we allow the use of traditionally reserved
@@ -115,6 +119,9 @@ struct LinkOptions {
 
   // Whether we should fail on definitions of a resource with conflicting visibility.
   bool strict_visibility = false;
+
+  // The number of threads used to load compiled files and to compress the output APK.
+  size_t jobs = 1;
 };
 
 class LinkCommand : public Command {
@@ -136,6 +143,11 @@ class LinkCommand : public Command {
             "0x7f and can't be used with --static-lib or --shared-lib.", &package_id_);
     AddOptionalFlag("--java", "Directory in which to generate R.java.",
         &options_.generate_java_class_path, Command::kPath);
+    AddOptionalFlag("--java-classes-jar",
+        "Jar file in which to generate the R classes already compiled, so that they do not\n"
+            "have to go through javac. The R classes of each package are compiled in\n"
+            "parallel, see -j. Not supported with --shared-lib.",
+        &options_.generate_java_classes_jar_path, Command::kPath);
     AddOptionalFlag("--proguard", "Output file for generated Proguard rules.",
         &options_.generate_proguard_rules_path, Command::kPath);
     AddOptionalFlag("--proguard-main-dex",
@@ -330,6 +342,12 @@ class LinkCommand : public Command {
             "should only be used together with the --static-lib flag.",
         &options_.merge_only);
     AddOptionalSwitch("-v", "Enables verbose logging.", &verbose_);
+    AddOptionalFlag("-j",
+        "Number of threads used to load compiled files and to compress the output APK.\n"
+            "Defaults to 1, 0 uses one thread per CPU core. Files are always merged, and APK\n"
+            "entries written, in the order given. With more than one thread, uncompressed\n"
+            "APK entries are also 4-byte aligned.",
+        &jobs_);
     AddOptionalFlagList("--feature-flags",
                         "Specify the values of feature flags. The pairs in the argument\n"
                         "are separated by ',' the name is separated from the value by '='.\n"
@@ -341,6 +359,11 @@ class LinkCommand : public Command {
                       "updatableSystem=\"false\" to the root manifest node, overwriting any\n"
                       "existing attribute. This is ignored if the manifest has a versionCode.",
                       &options_.manifest_fixer_options.non_updatable_system);
+    AddOptionalFlag("--incremental-dir",
+        "Directory in which to keep a snapshot of this link. A later link with the same\n"
+            "options and inputs is skipped if its outputs were not modified since, and\n"
+            "resource IDs are kept stable across links unless --stable-ids is given.",
+        &incremental_dir_, Command::kPath);
   }
 
   int Action(const std::vector<std::string>& args) override;
@@ -365,7 +388,9 @@ class LinkCommand : public Command {
   std::optional<std::string> stable_id_file_path_;
   std::vector<std::string> split_args_;
   std::optional<std::string> trace_folder_;
+  std::optional<std::string> jobs_;
   std::vector<std::string> feature_flags_args_;
+  std::optional<std::string> incremental_dir_;
 };
 
 }// namespace aapt
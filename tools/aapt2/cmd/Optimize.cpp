@@ -29,6 +29,7 @@
 #include "SdkConstants.h"
 #include "ValueVisitor.h"
 #include "android-base/file.h"
+#include "android-base/parseint.h"
 #include "android-base/stringprintf.h"
 #include "androidfw/BigBufferStream.h"
 #include "androidfw/ConfigDescription.h"
@@ -224,7 +225,7 @@ class Optimizer {
       MultiApkGenerator generator{apk.get(), context_};
       MultiApkGeneratorOptions generator_options = {
           options_.output_dir.value(), options_.apk_artifacts.value(),
-          options_.table_flattener_options, options_.kept_artifacts};
+          options_.table_flattener_options, options_.kept_artifacts, options_.jobs};
       if (!generator.FromBaseApk(generator_options)) {
         return 1;
       }
@@ -454,6 +455,13 @@ int OptimizeCommand::Action(const std::vector<std::string>& args) {
     return 1;
   }
 
+  if (jobs_) {
+    if (!android::base::ParseUint(jobs_.value(), &options_.jobs)) {
+      diag->Error(android::DiagMessage() << "invalid value for -j: '" << jobs_.value() << "'");
+      return 1;
+    }
+  }
+
   Optimizer cmd(&context, options_);
   return cmd.Run(std::move(apk));
 }
@@ -69,6 +69,9 @@ struct OptimizeOptions {
 
   // Path to the output map of original resource paths/names to obfuscated paths/names.
   std::optional<std::string> obfuscation_map_path;
+
+  // Number of multi-APK artifacts generated in parallel. 0 uses one thread per CPU core.
+  size_t jobs = 1;
 };
 
 class OptimizeCommand : public Command {
@@ -144,6 +147,11 @@ class OptimizeCommand : public Command {
         "store the same resource value only once in resource table which decreases APK size.\n"
         "Has no effect on APKs where resource names are kept.",
         &options_.table_flattener_options.deduplicate_entry_values);
+    AddOptionalFlag("-j",
+                    "Number of multi-APK artifacts to generate in parallel. Defaults to 1, 0 uses\n"
+                    "one thread per CPU core. Each artifact in progress holds its own copy of the\n"
+                    "resource table.",
+                    &jobs_);
     AddOptionalSwitch("-v", "Enables verbose logging", &verbose_);
   }
 
@@ -158,6 +166,7 @@ class OptimizeCommand : public Command {
   std::optional<std::string> config_path_;
   std::optional<std::string> resources_config_path_;
   std::optional<std::string> target_densities_;
+  std::optional<std::string> jobs_;
   std::vector<std::string> configs_;
   std::vector<std::string> split_args_;
   std::unordered_set<std::string> kept_artifacts_;
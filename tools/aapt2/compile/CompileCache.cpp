@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compile/CompileCache.h"
+
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+#include "android-base/file.h"
+#include "android-base/stringprintf.h"
+#include "android-base/threads.h"
+#include "util/Files.h"
+
+using ::android::StringPiece;
+using ::android::base::StringPrintf;
+
+namespace aapt {
+
+CompileCache::KeyBuilder& CompileCache::KeyBuilder::Add(StringPiece field) {
+  return Add(field.data(), field.size());
+}
+
+CompileCache::KeyBuilder& CompileCache::KeyBuilder::Add(const void* data, size_t size) {
+  uint8_t size_prefix[8];
+  for (int i = 0; i < 8; i++) {
+    size_prefix[i] = static_cast<uint8_t>(static_cast<uint64_t>(size) >> (8 * i));
+  }
+  digest_.Update(size_prefix, sizeof(size_prefix));
+  digest_.Update(data, size);
+  return *this;
+}
+
+std::string CompileCache::KeyBuilder::Build() {
+  return digest_.FinishHex();
+}
+
+std::unique_ptr<CompileCache> CompileCache::Open(const std::string& dir,
+                                                 android::IDiagnostics* diag) {
+  if (file::GetFileType(dir) != file::FileType::kDirectory && !file::mkdirs(dir)) {
+    diag->Error(android::DiagMessage(dir) << "failed to create compile cache directory: "
+                                          << strerror(errno));
+    return {};
+  }
+  return std::unique_ptr<CompileCache>(new CompileCache(dir));
+}
+
+std::string CompileCache::GetEntryPath(const std::string& key) const {
+  std::string path = dir_;
+  file::AppendPath(&path, key + ".flat");
+  return path;
+}
+
+bool CompileCache::Load(const std::string& key, android::BigBuffer* out_data) const {
+  std::string contents;
+  if (!android::base::ReadFileToString(GetEntryPath(key), &contents)) {
+    return false;
+  }
+  if (!contents.empty()) {
+    memcpy(out_data->NextBlock<uint8_t>(contents.size()), contents.data(), contents.size());
+  }
+  return true;
+}
+
+bool CompileCache::Store(const std::string& key, const android::BigBuffer& data) const {
+  std::string contents;
+  contents.reserve(data.size());
+  for (const android::BigBuffer::Block& block : data) {
+    contents.append(reinterpret_cast<const char*>(block.buffer.get()), block.size);
+  }
+
+  // Write to a name that is unique to this writer and rename it into place, so that concurrent
+  // runs sharing the directory never observe a partially written entry.
+  static std::atomic<uint32_t> sequence = 0;
+  const std::string entry_path = GetEntryPath(key);
+  const std::string temp_path =
+      StringPrintf("%s.%d.%llu.%u.tmp", entry_path.c_str(), static_cast<int>(getpid()),
+                   static_cast<unsigned long long>(android::base::GetThreadId()), sequence++);
+  if (!android::base::WriteStringToFile(contents, temp_path)) {
+    unlink(temp_path.c_str());
+    return false;
+  }
+  if (rename(temp_path.c_str(), entry_path.c_str()) != 0) {
+    // Another run may have stored the same entry first, which is just as good.
+    unlink(temp_path.c_str());
+    return file::GetFileType(entry_path) == file::FileType::kRegular;
+  }
+  return true;
+}
+
+}  // namespace aapt
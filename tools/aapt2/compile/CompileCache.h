@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AAPT_COMPILE_COMPILECACHE_H
+#define AAPT_COMPILE_COMPILECACHE_H
+
+#include <memory>
+#include <string>
+
+#include "android-base/macros.h"
+#include "androidfw/BigBuffer.h"
+#include "androidfw/IDiagnostics.h"
+#include "androidfw/StringPiece.h"
+#include "util/Sha256.h"
+
+namespace aapt {
+
+// A directory of compiled files that persists between runs of aapt2 compile, and can be shared
+// by several of them at once. Entries are addressed by a key that the caller derives from
+// everything that affects the compiled output. Entries are never modified once written, so a
+// cache can be cleared by deleting the directory at any time.
+class CompileCache {
+ public:
+  // Builds a key out of a sequence of fields. Fields are length-prefixed, so that no two
+  // different sequences produce the same input to the digest.
+  class KeyBuilder {
+   public:
+    KeyBuilder& Add(android::StringPiece field);
+    KeyBuilder& Add(const void* data, size_t size);
+    std::string Build();
+
+   private:
+    Sha256 digest_;
+  };
+
+  // Creates the cache directory if needed. Returns nullptr and logs an error on failure.
+  static std::unique_ptr<CompileCache> Open(const std::string& dir, android::IDiagnostics* diag);
+
+  // Reads the entry for the key into out_data. Returns false if there is no such entry.
+  bool Load(const std::string& key, android::BigBuffer* out_data) const;
+
+  // Writes the entry for the key. The entry only becomes visible to readers once it has been
+  // written completely.
+  bool Store(const std::string& key, const android::BigBuffer& data) const;
+
+ private:
+  explicit CompileCache(std::string dir) : dir_(std::move(dir)) {
+  }
+
+  std::string GetEntryPath(const std::string& key) const;
+
+  DISALLOW_COPY_AND_ASSIGN(CompileCache);
+
+  const std::string dir_;
+};
+
+}  // namespace aapt
+
+#endif  // AAPT_COMPILE_COMPILECACHE_H
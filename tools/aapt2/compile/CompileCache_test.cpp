@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compile/CompileCache.h"
+
+#include <cstring>
+
+#include "test/Test.h"
+
+using ::testing::Eq;
+using ::testing::Ne;
+using ::testing::NotNull;
+
+namespace aapt {
+
+namespace {
+
+android::BigBuffer MakeBuffer(const std::string& contents) {
+  android::BigBuffer buffer(16);
+  memcpy(buffer.NextBlock<uint8_t>(contents.size()), contents.data(), contents.size());
+  return buffer;
+}
+
+std::string ToString(const android::BigBuffer& buffer) {
+  std::string contents;
+  for (const android::BigBuffer::Block& block : buffer) {
+    contents.append(reinterpret_cast<const char*>(block.buffer.get()), block.size);
+  }
+  return contents;
+}
+
+}  // namespace
+
+using CompileCacheTest = TestDirectoryFixture;
+
+TEST_F(CompileCacheTest, StoreThenLoad) {
+  std::unique_ptr<CompileCache> cache =
+      CompileCache::Open(GetTestPath("cache/nested"), test::GetDiagnostics());
+  ASSERT_THAT(cache, NotNull());
+
+  const std::string key = CompileCache::KeyBuilder().Add("res/values/strings.xml").Build();
+
+  android::BigBuffer missing(16);
+  EXPECT_FALSE(cache->Load(key, &missing));
+
+  ASSERT_TRUE(cache->Store(key, MakeBuffer("compiled contents")));
+  android::BigBuffer loaded(16);
+  ASSERT_TRUE(cache->Load(key, &loaded));
+  EXPECT_THAT(ToString(loaded), Eq("compiled contents"));
+
+  // Storing an entry again replaces it as a whole.
+  ASSERT_TRUE(cache->Store(key, MakeBuffer("recompiled")));
+  android::BigBuffer reloaded(16);
+  ASSERT_TRUE(cache->Load(key, &reloaded));
+  EXPECT_THAT(ToString(reloaded), Eq("recompiled"));
+}
+
+TEST(CompileCacheKeyTest, FieldBoundariesAffectKey) {
+  const std::string key = CompileCache::KeyBuilder().Add("ab").Add("c").Build();
+  EXPECT_THAT(CompileCache::KeyBuilder().Add("ab").Add("c").Build(), Eq(key));
+  EXPECT_THAT(CompileCache::KeyBuilder().Add("a").Add("bc").Build(), Ne(key));
+  EXPECT_THAT(CompileCache::KeyBuilder().Add("abc").Build(), Ne(key));
+}
+
+}  // namespace aapt
@@ -24,6 +24,7 @@
 
 #include "ResourceTable.h"
 #include "process/IResourceTableConsumer.h"
+#include "trace/TraceBuffer.h"
 #include "util/Util.h"
 
 using android::base::expected;
@@ -124,6 +125,7 @@ struct IdAssignerContext {
 }  // namespace
 
 bool IdAssigner::Consume(IAaptContext* context, ResourceTable* table) {
+  TRACE_CALL();
   IdAssignerContext assigned_ids(context->GetCompilationPackage(), context->GetPackageId());
   for (auto& package : table->packages) {
     for (auto& type : package->types) {
@@ -19,6 +19,7 @@
 #include <string>
 
 #include "ResourceUtils.h"
+#include "trace/TraceBuffer.h"
 #include "util/Util.h"
 #include "xml/XmlDom.h"
 #include "xml/XmlUtil.h"
@@ -113,6 +114,7 @@ class Visitor : public xml::PackageAwareVisitor {
 }  // namespace
 
 bool InlineXmlFormatParser::Consume(IAaptContext* context, xml::XmlResource* doc) {
+  TRACE_CALL();
   Visitor visitor(context, doc);
   doc->root->Accept(&visitor);
   if (visitor.HasError()) {
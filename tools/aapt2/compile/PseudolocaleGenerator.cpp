@@ -27,6 +27,7 @@
 #include "androidfw/ResourceTypes.h"
 #include "androidfw/Util.h"
 #include "compile/Pseudolocalizer.h"
+#include "trace/TraceBuffer.h"
 #include "util/Util.h"
 
 using ::android::ConfigDescription;
@@ -529,6 +530,7 @@ bool ParseGenderRatio(const std::string& grammatical_gender_ratio, float* gender
 }
 
 bool PseudolocaleGenerator::Consume(IAaptContext* context, ResourceTable* table) {
+  TRACE_CALL();
   uint32_t gender_state = 0;
   if (!ParseGenderValuesAndSaveState(grammatical_gender_values_, &gender_state,
                                      context->GetDiagnostics())) {
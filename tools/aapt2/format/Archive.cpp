@@ -16,8 +16,14 @@
 
 #include "format/Archive.h"
 
+#include <zlib.h>
+
+#include <algorithm>
+#include <condition_variable>
 #include <cstdio>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -26,6 +32,7 @@
 #include "android-base/utf8.h"
 #include "androidfw/StringPiece.h"
 #include "util/Files.h"
+#include "util/ThreadPool.h"
 #include "util/Util.h"
 #include "ziparchive/zip_writer.h"
 
@@ -254,6 +261,389 @@ class ZipFileWriter : public IArchiveWriter {
   std::string error_;
 };
 
+// Writes a zip file whose entries are deflated in parallel on a thread pool. Entries are buffered
+// until they are compressed and then appended to the file in the order they were added, so the
+// output does not depend on the number of threads.
+//
+// Large entries are split into chunks that are deflated independently, each primed with the tail
+// of the previous chunk as its dictionary, and concatenated into a single deflate stream. Entries
+// that end up stored are aligned to 4 bytes, which is what zipalign would do to them.
+class ParallelZipFileWriter : public IArchiveWriter {
+ public:
+  explicit ParallelZipFileWriter(size_t jobs) : pool_(jobs) {
+  }
+
+  bool Open(StringPiece path) {
+    file_ = {::android::base::utf8::fopen(path.data(), "w+b"), fclose};
+    if (!file_) {
+      error_ = SystemErrorCodeToString(errno);
+      return false;
+    }
+    return true;
+  }
+
+  bool StartEntry(StringPiece path, uint32_t flags) override {
+    if (!file_ || current_entry_ || HadError()) {
+      return false;
+    }
+    current_entry_ = util::make_unique<PendingEntry>();
+    current_entry_->path = std::string(path);
+    current_entry_->flags = flags;
+    return true;
+  }
+
+  bool Write(const void* data, int len) override {
+    if (!current_entry_) {
+      return false;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    current_entry_->data.insert(current_entry_->data.end(), bytes, bytes + len);
+    return true;
+  }
+
+  bool FinishEntry() override {
+    if (!current_entry_) {
+      return false;
+    }
+    if (current_entry_->path.size() > UINT16_MAX) {
+      error_ = "entry name is too long";
+      current_entry_.reset();
+      return false;
+    }
+    if (current_entry_->data.size() > UINT32_MAX) {
+      error_ = "entry is too large for a zip file without ZIP64 support";
+      current_entry_.reset();
+      return false;
+    }
+    Submit(std::move(current_entry_));
+    return WritePendingEntries(false /* wait */);
+  }
+
+  bool WriteFile(StringPiece path, uint32_t flags, android::InputStream* in) override {
+    if (!StartEntry(path, flags)) {
+      return false;
+    }
+
+    const void* data = nullptr;
+    size_t len = 0;
+    while (in->Next(&data, &len)) {
+      if (!Write(data, static_cast<int>(len))) {
+        return false;
+      }
+    }
+
+    if (in->HadError()) {
+      error_ = in->GetError();
+      current_entry_.reset();
+      return false;
+    }
+
+    return FinishEntry();
+  }
+
+  bool HadError() const override {
+    return !error_.empty();
+  }
+
+  std::string GetError() const override {
+    return error_;
+  }
+
+  virtual ~ParallelZipFileWriter() {
+    if (file_) {
+      if (WritePendingEntries(true /* wait */)) {
+        WriteCentralDirectory();
+      }
+    }
+    pool_.Wait();
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ParallelZipFileWriter);
+
+  // Entries larger than this are deflated in several pieces.
+  static constexpr size_t kChunkSize = 1024 * 1024;
+
+  // The most input that may be buffered before the writer waits for entries to be written out.
+  static constexpr size_t kMaxPendingBytes = 64 * 1024 * 1024;
+
+  // The deflate window, and the size of the dictionary each chunk is primed with.
+  static constexpr size_t kDictionarySize = 32 * 1024;
+
+  // Every entry has the same timestamp, 1980-01-01 00:00:00 in MS-DOS format, so that the output
+  // does not depend on when or where it was built.
+  static constexpr uint16_t kDosTime = 0;
+  static constexpr uint16_t kDosDate = (1 << 5) | 1;
+
+  static constexpr uint16_t kMethodStored = 0;
+  static constexpr uint16_t kMethodDeflated = 8;
+
+  struct Chunk {
+    size_t offset;
+    size_t size;
+    uint32_t crc32;
+    std::vector<uint8_t> deflated;
+  };
+
+  struct PendingEntry {
+    std::string path;
+    uint32_t flags;
+    std::vector<uint8_t> data;
+    std::vector<Chunk> chunks;
+
+    // Guarded by ParallelZipFileWriter::mutex_.
+    size_t chunks_remaining = 0;
+    bool deflate_failed = false;
+  };
+
+  struct CentralDirectoryRecord {
+    std::string path;
+    uint16_t method;
+    uint32_t crc32;
+    uint32_t compressed_size;
+    uint32_t uncompressed_size;
+    uint32_t local_header_offset;
+  };
+
+  void Submit(std::unique_ptr<PendingEntry> entry) {
+    const bool compress = (entry->flags & ArchiveEntry::kCompress) != 0;
+    const size_t size = entry->data.size();
+    for (size_t offset = 0; offset < size; offset += kChunkSize) {
+      entry->chunks.push_back(Chunk{offset, std::min(kChunkSize, size - offset), 0, {}});
+    }
+    entry->chunks_remaining = entry->chunks.size();
+    pending_bytes_ += size;
+
+    PendingEntry* raw_entry = entry.get();
+    pending_entries_.push_back(std::move(entry));
+    for (size_t i = 0; i < raw_entry->chunks.size(); i++) {
+      pool_.Post([this, raw_entry, i, compress] {
+        const bool success = ProcessChunk(raw_entry, i, compress);
+        std::lock_guard<std::mutex> lock(mutex_);
+        raw_entry->deflate_failed |= !success;
+        raw_entry->chunks_remaining--;
+        chunk_done_.notify_all();
+      });
+    }
+  }
+
+  static bool ProcessChunk(PendingEntry* entry, size_t index, bool compress) {
+    Chunk& chunk = entry->chunks[index];
+    const uint8_t* data = entry->data.data() + chunk.offset;
+    chunk.crc32 = crc32(0, data, chunk.size);
+    if (!compress) {
+      return true;
+    }
+
+    z_stream stream = {};
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) !=
+        Z_OK) {
+      return false;
+    }
+
+    if (chunk.offset > 0) {
+      const size_t dictionary_size = std::min(kDictionarySize, chunk.offset);
+      deflateSetDictionary(&stream, data - dictionary_size, dictionary_size);
+    }
+
+    // Every chunk but the last ends on a byte boundary without a final block, so the chunks can be
+    // concatenated into one stream.
+    const bool last = index + 1 == entry->chunks.size();
+    chunk.deflated.resize(deflateBound(&stream, chunk.size) + 16);
+    stream.next_in = const_cast<uint8_t*>(data);
+    stream.avail_in = chunk.size;
+    stream.next_out = chunk.deflated.data();
+    stream.avail_out = chunk.deflated.size();
+
+    int result;
+    while (true) {
+      result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+      if (result == Z_STREAM_ERROR || (last && result == Z_STREAM_END) ||
+          (!last && stream.avail_in == 0 && stream.avail_out != 0)) {
+        break;
+      }
+      const size_t used = chunk.deflated.size() - stream.avail_out;
+      chunk.deflated.resize(chunk.deflated.size() * 2);
+      stream.next_out = chunk.deflated.data() + used;
+      stream.avail_out = chunk.deflated.size() - used;
+    }
+    chunk.deflated.resize(chunk.deflated.size() - stream.avail_out);
+    deflateEnd(&stream);
+    return result != Z_STREAM_ERROR;
+  }
+
+  // Writes out the entries at the front of the queue that have finished deflating. When `wait` is
+  // true, waits for every entry, otherwise only waits while too much input is buffered.
+  bool WritePendingEntries(bool wait) {
+    while (!pending_entries_.empty() && !HadError()) {
+      PendingEntry* entry = pending_entries_.front().get();
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (entry->chunks_remaining != 0) {
+          if (!wait && pending_bytes_ <= kMaxPendingBytes) {
+            return true;
+          }
+          chunk_done_.wait(lock, [entry] { return entry->chunks_remaining == 0; });
+        }
+        if (entry->deflate_failed) {
+          error_ = "failed to deflate " + entry->path;
+          break;
+        }
+      }
+
+      WriteEntry(*entry);
+      pending_bytes_ -= entry->data.size();
+      pending_entries_.pop_front();
+    }
+    return !HadError();
+  }
+
+  void WriteEntry(const PendingEntry& entry) {
+    CentralDirectoryRecord record;
+    record.path = entry.path;
+    record.uncompressed_size = static_cast<uint32_t>(entry.data.size());
+    record.crc32 = 0;
+    size_t compressed_size = 0;
+    for (const Chunk& chunk : entry.chunks) {
+      record.crc32 = crc32_combine(record.crc32, chunk.crc32, chunk.size);
+      compressed_size += chunk.deflated.size();
+    }
+
+    // Keep the entry stored if it was not compressed enough. This is preserving behavior of AAPT.
+    record.method = kMethodStored;
+    if ((entry.flags & ArchiveEntry::kCompress) != 0 && !entry.data.empty() &&
+        compressed_size + (compressed_size / 10) <= entry.data.size()) {
+      record.method = kMethodDeflated;
+    }
+    record.compressed_size = record.method == kMethodDeflated
+                                 ? static_cast<uint32_t>(compressed_size)
+                                 : record.uncompressed_size;
+
+    if (offset_ > UINT32_MAX || central_directory_.size() == UINT16_MAX) {
+      error_ = "archive is too large for a zip file without ZIP64 support";
+      return;
+    }
+    record.local_header_offset = static_cast<uint32_t>(offset_);
+
+    // Pad the extra field so that stored data starts on a 4 byte boundary.
+    constexpr size_t kLocalHeaderSize = 30;
+    size_t padding = 0;
+    if (record.method == kMethodStored) {
+      padding = (4 - (offset_ + kLocalHeaderSize + entry.path.size()) % 4) % 4;
+    }
+
+    std::vector<uint8_t> header;
+    header.reserve(kLocalHeaderSize + entry.path.size() + padding);
+    PutLocalHeader(record, padding, &header);
+    WriteBytes(header.data(), header.size());
+
+    if (record.method == kMethodDeflated) {
+      for (const Chunk& chunk : entry.chunks) {
+        WriteBytes(chunk.deflated.data(), chunk.deflated.size());
+      }
+    } else {
+      WriteBytes(entry.data.data(), entry.data.size());
+    }
+    central_directory_.push_back(std::move(record));
+  }
+
+  void WriteCentralDirectory() {
+    const size_t central_directory_offset = offset_;
+    std::vector<uint8_t> buffer;
+    for (const CentralDirectoryRecord& record : central_directory_) {
+      PutU32(0x02014b50, &buffer);  // Central directory file header signature.
+      PutU16(20, &buffer);          // Version made by.
+      PutU16(record.method == kMethodDeflated ? 20 : 10, &buffer);  // Version needed to extract.
+      PutU16(0, &buffer);           // General purpose bit flags.
+      PutU16(record.method, &buffer);
+      PutU16(kDosTime, &buffer);
+      PutU16(kDosDate, &buffer);
+      PutU32(record.crc32, &buffer);
+      PutU32(record.compressed_size, &buffer);
+      PutU32(record.uncompressed_size, &buffer);
+      PutU16(static_cast<uint16_t>(record.path.size()), &buffer);
+      PutU16(0, &buffer);  // Extra field length.
+      PutU16(0, &buffer);  // File comment length.
+      PutU16(0, &buffer);  // Disk number start.
+      PutU16(0, &buffer);  // Internal file attributes.
+      PutU32(0, &buffer);  // External file attributes.
+      PutU32(record.local_header_offset, &buffer);
+      buffer.insert(buffer.end(), record.path.begin(), record.path.end());
+    }
+    const size_t central_directory_size = buffer.size();
+    if (central_directory_offset + central_directory_size > UINT32_MAX) {
+      error_ = "archive is too large for a zip file without ZIP64 support";
+      return;
+    }
+
+    PutU32(0x06054b50, &buffer);  // End of central directory signature.
+    PutU16(0, &buffer);           // Number of this disk.
+    PutU16(0, &buffer);           // Disk where the central directory starts.
+    PutU16(static_cast<uint16_t>(central_directory_.size()), &buffer);
+    PutU16(static_cast<uint16_t>(central_directory_.size()), &buffer);
+    PutU32(static_cast<uint32_t>(central_directory_size), &buffer);
+    PutU32(static_cast<uint32_t>(central_directory_offset), &buffer);
+    PutU16(0, &buffer);  // Comment length.
+
+    WriteBytes(buffer.data(), buffer.size());
+    if (!HadError() && fflush(file_.get()) != 0) {
+      error_ = SystemErrorCodeToString(errno);
+    }
+  }
+
+  static void PutLocalHeader(const CentralDirectoryRecord& record, size_t padding,
+                             std::vector<uint8_t>* out) {
+    PutU32(0x04034b50, out);  // Local file header signature.
+    PutU16(record.method == kMethodDeflated ? 20 : 10, out);  // Version needed to extract.
+    PutU16(0, out);           // General purpose bit flags.
+    PutU16(record.method, out);
+    PutU16(kDosTime, out);
+    PutU16(kDosDate, out);
+    PutU32(record.crc32, out);
+    PutU32(record.compressed_size, out);
+    PutU32(record.uncompressed_size, out);
+    PutU16(static_cast<uint16_t>(record.path.size()), out);
+    PutU16(static_cast<uint16_t>(padding), out);
+    out->insert(out->end(), record.path.begin(), record.path.end());
+    out->insert(out->end(), padding, 0);
+  }
+
+  static void PutU16(uint16_t value, std::vector<uint8_t>* out) {
+    out->push_back(value & 0xff);
+    out->push_back(value >> 8);
+  }
+
+  static void PutU32(uint32_t value, std::vector<uint8_t>* out) {
+    PutU16(value & 0xffff, out);
+    PutU16(value >> 16, out);
+  }
+
+  void WriteBytes(const void* data, size_t len) {
+    if (HadError() || len == 0) {
+      return;
+    }
+    if (fwrite(data, 1, len, file_.get()) != len) {
+      error_ = SystemErrorCodeToString(errno);
+      return;
+    }
+    offset_ += len;
+  }
+
+  std::unique_ptr<FILE, decltype(fclose)*> file_ = {nullptr, fclose};
+  std::unique_ptr<PendingEntry> current_entry_;
+  std::deque<std::unique_ptr<PendingEntry>> pending_entries_;
+  size_t pending_bytes_ = 0;
+  std::vector<CentralDirectoryRecord> central_directory_;
+  size_t offset_ = 0;
+  std::string error_;
+
+  std::mutex mutex_;
+  std::condition_variable chunk_done_;
+
+  // Declared last so that it is destroyed first, after every task touching the entries ran.
+  ThreadPool pool_;
+};
+
 }  // namespace
 
 std::unique_ptr<IArchiveWriter> CreateDirectoryArchiveWriter(android::IDiagnostics* diag,
@@ -276,4 +666,18 @@ std::unique_ptr<IArchiveWriter> CreateZipFileArchiveWriter(android::IDiagnostics
   return std::move(writer);
 }
 
+std::unique_ptr<IArchiveWriter> CreateZipFileArchiveWriter(android::IDiagnostics* diag,
+                                                           StringPiece path, size_t jobs) {
+  if (jobs <= 1) {
+    return CreateZipFileArchiveWriter(diag, path);
+  }
+
+  std::unique_ptr<ParallelZipFileWriter> writer = util::make_unique<ParallelZipFileWriter>(jobs);
+  if (!writer->Open(path)) {
+    diag->Error(android::DiagMessage(path) << writer->GetError());
+    return {};
+  }
+  return std::move(writer);
+}
+
 }  // namespace aapt
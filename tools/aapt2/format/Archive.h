@@ -75,6 +75,12 @@ std::unique_ptr<IArchiveWriter> CreateDirectoryArchiveWriter(android::IDiagnosti
 std::unique_ptr<IArchiveWriter> CreateZipFileArchiveWriter(android::IDiagnostics* diag,
                                                            android::StringPiece path);
 
+// Creates a zip file writer that deflates entries on `jobs` threads. Entries are still written in
+// the order they were added, and uncompressed entries are aligned to 4 bytes as zipalign would.
+// With a single job this is the same as the writer above.
+std::unique_ptr<IArchiveWriter> CreateZipFileArchiveWriter(android::IDiagnostics* diag,
+                                                           android::StringPiece path, size_t jobs);
+
 }  // namespace aapt
 
 #endif /* AAPT_FORMAT_ARCHIVE_H */
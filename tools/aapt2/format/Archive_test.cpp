@@ -82,6 +82,14 @@ std::unique_ptr<IArchiveWriter> MakeZipFileWriter(const std::string& output_path
   return CreateZipFileArchiveWriter(&diag, output_path);
 }
 
+std::unique_ptr<IArchiveWriter> MakeParallelZipFileWriter(const std::string& output_path) {
+  file::mkdirs(std::string(file::GetStem(output_path)));
+  std::remove(output_path.c_str());
+
+  StdErrDiagnostics diag;
+  return CreateZipFileArchiveWriter(&diag, output_path, 4);
+}
+
 void VerifyDirectory(const std::string& path, const std::string& file, const uint8_t array[]) {
   std::string file_path = file::BuildPath({path, file});
   auto buffer = std::make_unique<char[]>(kTestDataLength);
@@ -316,4 +324,71 @@ TEST_F(ArchiveTest, ZipFileTimeZoneEastOfUTC) {
   VerifyZipFileTimestamps(output_path);
 }
 
+TEST_F(ArchiveTest, ParallelZipFileWriteFileSuccess) {
+  std::string output_path = GetTestPath("output.apk");
+  std::unique_ptr<IArchiveWriter> writer = MakeParallelZipFileWriter(output_path);
+
+  std::unique_ptr<uint8_t[]> data1 = MakeTestArray();
+  auto data1_copy = std::make_unique<uint8_t[]>(kTestDataLength);
+  std::copy(data1.get(), data1.get() + kTestDataLength, data1_copy.get());
+
+  std::unique_ptr<uint8_t[]> data2 = MakeTestArray();
+  auto data2_copy = std::make_unique<uint8_t[]>(kTestDataLength);
+  std::copy(data2.get(), data2.get() + kTestDataLength, data2_copy.get());
+
+  auto input1 = std::make_unique<TestData>(data1_copy, kTestDataLength);
+  auto input2 = std::make_unique<TestData>(data2_copy, kTestDataLength);
+
+  ASSERT_TRUE(writer->WriteFile("test1", ArchiveEntry::kCompress, input1.get()));
+  ASSERT_FALSE(writer->HadError());
+  ASSERT_TRUE(writer->WriteFile("test2", 0, input2.get()));
+  ASSERT_FALSE(writer->HadError());
+
+  writer.reset();
+
+  VerifyZipFile(output_path, "test1", data1.get());
+  VerifyZipFile(output_path, "test2", data2.get());
+  VerifyZipFileTimestamps(output_path);
+}
+
+TEST_F(ArchiveTest, ParallelZipFileWriteFileError) {
+  std::string output_path = GetTestPath("output.apk");
+  std::unique_ptr<IArchiveWriter> writer = MakeParallelZipFileWriter(output_path);
+  std::unique_ptr<uint8_t[]> data = MakeTestArray();
+  auto input = std::make_unique<TestData>(data, kTestDataLength);
+  input->error_ = "ParallelZipFileWriteFileError";
+
+  ASSERT_FALSE(writer->WriteFile("test", 0, input.get()));
+  ASSERT_TRUE(writer->HadError());
+  ASSERT_EQ("ParallelZipFileWriteFileError", writer->GetError());
+}
+
+TEST_F(ArchiveTest, ParallelZipFileDeflatesLargeEntriesInChunks) {
+  std::string output_path = GetTestPath("output.apk");
+  std::unique_ptr<IArchiveWriter> writer = MakeParallelZipFileWriter(output_path);
+
+  // Large and compressible enough to be split into several deflated chunks.
+  std::string expected;
+  for (int i = 0; expected.size() < 5 * 1024 * 1024; i++) {
+    expected += "line " + std::to_string(i % 1000) + " of a compressible entry\n";
+  }
+
+  ASSERT_TRUE(writer->StartEntry("large", ArchiveEntry::kCompress));
+  ASSERT_TRUE(writer->Write(expected.data(), static_cast<int>(expected.size())));
+  ASSERT_TRUE(writer->FinishEntry());
+  ASSERT_FALSE(writer->HadError());
+
+  writer.reset();
+
+  std::unique_ptr<io::ZipFileCollection> zip = io::ZipFileCollection::Create(output_path, nullptr);
+  ASSERT_NE(nullptr, zip);
+  io::IFile* file = zip->FindFile("large");
+  ASSERT_NE(nullptr, file);
+  EXPECT_TRUE(file->WasCompressed());
+
+  std::unique_ptr<io::IData> data = file->OpenAsData();
+  ASSERT_NE(nullptr, data);
+  EXPECT_EQ(expected, std::string(static_cast<const char*>(data->data()), data->size()));
+}
+
 }  // namespace aapt
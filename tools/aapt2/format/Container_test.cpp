@@ -18,6 +18,7 @@
 
 #include "google/protobuf/io/zero_copy_stream_impl_lite.h"
 
+#include "io/File.h"
 #include "io/StringStream.h"
 #include "test/Test.h"
 
@@ -87,4 +88,42 @@ TEST(ContainerTest, SerializeCompiledFile) {
   EXPECT_THAT(reader.GetError(), IsEmpty());
 }
 
+TEST(ContainerTest, FileSegmentsReadFromTheOpenedContainer) {
+  const std::string expected_data = "hello";
+
+  std::string output_str;
+  {
+    StringOutputStream out_stream(&output_str);
+    ContainerWriter writer(&out_stream, 1u);
+    pb::internal::CompiledFile pb_compiled_file;
+    pb_compiled_file.set_resource_name("android:raw/hello");
+    io::StringInputStream data(expected_data);
+    ASSERT_TRUE(writer.AddResFileEntry(pb_compiled_file, &data));
+  }
+
+  auto buffer = std::make_unique<uint8_t[]>(output_str.size());
+  memcpy(buffer.get(), output_str.data(), output_str.size());
+  std::shared_ptr<io::IData> container =
+      std::make_shared<io::MallocData>(std::move(buffer), output_str.size());
+
+  ContainerReader reader(container.get());
+  ContainerReaderEntry* entry = reader.Next();
+  ASSERT_THAT(entry, NotNull());
+
+  pb::internal::CompiledFile pb_new_file;
+  off64_t offset;
+  size_t len;
+  ASSERT_TRUE(entry->GetResFileOffsets(&pb_new_file, &offset, &len)) << entry->GetError();
+
+  // The file itself can't be opened, the segment has to use the container data.
+  test::TestFile file("res/raw/hello.flat");
+  io::IFile* segment = file.CreateFileSegment(offset, len, container);
+  std::unique_ptr<io::IData> segment_data = segment->OpenAsData();
+  ASSERT_THAT(segment_data, NotNull());
+  EXPECT_THAT(std::string(static_cast<const char*>(segment_data->data()), segment_data->size()),
+              StrEq(expected_data));
+
+  EXPECT_THAT(file.CreateFileSegment(offset, len)->OpenAsData(), IsNull());
+}
+
 }  // namespace aapt
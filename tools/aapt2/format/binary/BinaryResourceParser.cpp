@@ -329,13 +329,16 @@ bool BinaryResourceParser::ParseTypeSpec(const ResourceTablePackage* package,
   }
 
   // Record the type_spec_flags for later. We don't know resource names yet, and we need those
-  // to mark resources as overlayable.
+  // to mark resources as staged. Only the staged bit is ever looked at, so the (usually empty) set
+  // of staged entries is all that is kept, rather than an entry for every resource in the table.
   const uint32_t* type_spec_flags = reinterpret_cast<const uint32_t*>(
       reinterpret_cast<uintptr_t>(type_spec) +
       android::util::DeviceToHost16(type_spec->header.headerSize));
   for (size_t i = 0; i < entry_count; i++) {
-    ResourceId id(package_id, type_spec->id, static_cast<size_t>(i));
-    entry_type_spec_flags_[id] = android::util::DeviceToHost32(type_spec_flags[i]);
+    const uint32_t flags = android::util::DeviceToHost32(type_spec_flags[i]);
+    if (flags & ResTable_typeSpec::SPEC_STAGED_API) {
+      entry_type_spec_flags_[ResourceId(package_id, type_spec->id, static_cast<size_t>(i))] = flags;
+    }
   }
   return true;
 }
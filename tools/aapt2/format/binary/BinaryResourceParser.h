@@ -118,7 +118,7 @@ class BinaryResourceParser {
   // we use this to convert all resource IDs to symbolic references.
   std::map<ResourceId, ResourceName> id_index_;
 
-  // A mapping of resource ID to type spec flags.
+  // A mapping of resource ID to type spec flags, for the entries that are SPEC_STAGED_API.
   std::unordered_map<ResourceId, uint32_t> entry_type_spec_flags_;
 
   // A collection of staged resources that got finalized already and we're supposed to prune -
@@ -16,6 +16,7 @@
 
 #include "format/binary/TableFlattener.h"
 
+#include <atomic>
 #include <limits>
 #include <sstream>
 #include <type_traits>
@@ -34,6 +35,7 @@
 #include "format/binary/ResourceTypeExtensions.h"
 #include "optimize/Obfuscator.h"
 #include "trace/TraceBuffer.h"
+#include "util/ThreadPool.h"
 
 using namespace android;
 
@@ -72,7 +74,7 @@ class PackageFlattener {
                    SparseEntriesMode sparse_entries, bool compact_entries,
                    bool collapse_key_stringpool,
                    const std::set<ResourceName>& name_collapse_exemptions,
-                   bool deduplicate_entry_values)
+                   bool deduplicate_entry_values, size_t jobs)
       : context_(context),
         diag_(context->GetDiagnostics()),
         package_(package),
@@ -81,7 +83,8 @@ class PackageFlattener {
         compact_entries_(compact_entries),
         collapse_key_stringpool_(collapse_key_stringpool),
         name_collapse_exemptions_(name_collapse_exemptions),
-        deduplicate_entry_values_(deduplicate_entry_values) {
+        deduplicate_entry_values_(deduplicate_entry_values),
+        jobs_(jobs) {
   }
 
   bool FlattenPackage(BigBuffer* buffer) {
@@ -430,7 +433,21 @@ class PackageFlattener {
     return spec_header;
   }
 
+  // The chunks written for one type: its typeSpec followed by one type chunk per configuration.
+  struct FlatType {
+    const ResourceTableTypeView* type;
+    size_t num_entries;
+    android::BigBuffer spec_buffer{1024};
+    std::map<ConfigDescription, std::vector<FlatEntry>> config_to_entry_list_map;
+    std::vector<android::BigBuffer> config_buffers;
+  };
+
   bool FlattenTypes(BigBuffer* buffer) {
+    // The type and key pools are filled in while the entries are grouped by configuration, which
+    // is done in order. The configuration chunks only read from the pools, so they are flattened
+    // on jobs_ threads into their own buffers and appended in the same order as before.
+    std::vector<FlatType> flat_types;
+    size_t config_count = 0;
     size_t expected_type_id = 1;
     for (const ResourceTableTypeView& type : package_.types) {
       if (type.named_type.type == ResourceType::kStyleable ||
@@ -450,13 +467,15 @@ class PackageFlattener {
       expected_type_id++;
       type_pool_.MakeRef(type.named_type.to_string());
 
-      const auto type_spec_header = FlattenTypeSpec(type, type.entries, buffer);
+      FlatType& flat_type = flat_types.emplace_back();
+      flat_type.type = &type;
+      const auto type_spec_header = FlattenTypeSpec(type, type.entries, &flat_type.spec_buffer);
       if (!type_spec_header) {
         return false;
       }
 
       // Since the entries are sorted by ID, the last ID will be the largest.
-      const size_t num_entries = type.entries.back().id.value() + 1;
+      flat_type.num_entries = type.entries.back().id.value() + 1;
 
       // The binary resource table lists resource entries for each
       // configuration.
@@ -464,7 +483,7 @@ class PackageFlattener {
       // each
       // configuration available. Here we reverse this to match the binary
       // table.
-      std::map<ConfigDescription, std::vector<FlatEntry>> config_to_entry_list_map;
+      auto& config_to_entry_list_map = flat_type.config_to_entry_list_map;
 
       for (const ResourceTableEntryView& entry : type.entries) {
         if (entry.staged_id) {
@@ -506,16 +525,39 @@ class PackageFlattener {
         }
       }
 
-      // Flatten a configuration value.
-      for (auto& entry : config_to_entry_list_map) {
-        if (!FlattenConfig(type, entry.first, num_entries, &entry.second, buffer)) {
-          return false;
-        }
-      }
-
       // And now we can update the type entries count in the typeSpec header.
       type_spec_header->typesCount = android::util::HostToDevice16(uint16_t(std::min<uint32_t>(
           config_to_entry_list_map.size(), std::numeric_limits<uint16_t>::max())));
+      config_count += config_to_entry_list_map.size();
+    }
+
+    // Flatten a configuration value.
+    std::atomic<bool> error = false;
+    {
+      ThreadPool pool(std::min(jobs_, config_count));
+      for (FlatType& flat_type : flat_types) {
+        flat_type.config_buffers.reserve(flat_type.config_to_entry_list_map.size());
+        for (auto& entry : flat_type.config_to_entry_list_map) {
+          BigBuffer* config_buffer = &flat_type.config_buffers.emplace_back(512);
+          pool.Post([this, &flat_type, &entry, config_buffer, &error] {
+            if (!FlattenConfig(*flat_type.type, entry.first, flat_type.num_entries, &entry.second,
+                               config_buffer)) {
+              error = true;
+            }
+          });
+        }
+      }
+      pool.Wait();
+    }
+    if (error) {
+      return false;
+    }
+
+    for (FlatType& flat_type : flat_types) {
+      buffer->AppendBuffer(std::move(flat_type.spec_buffer));
+      for (BigBuffer& config_buffer : flat_type.config_buffers) {
+        buffer->AppendBuffer(std::move(config_buffer));
+      }
     }
     return true;
   }
@@ -560,6 +602,7 @@ class PackageFlattener {
   const std::set<ResourceName>& name_collapse_exemptions_;
   std::map<uint32_t, uint32_t> aliases_;
   bool deduplicate_entry_values_;
+  size_t jobs_;
 };
 
 }  // namespace
@@ -614,7 +657,8 @@ bool TableFlattener::Consume(IAaptContext* context, ResourceTable* table) {
                                options_.use_compact_entries,
                                options_.collapse_key_stringpool,
                                options_.name_collapse_exemptions,
-                               options_.deduplicate_entry_values);
+                               options_.deduplicate_entry_values,
+                               options_.jobs);
     if (!flattener.FlattenPackage(&package_buffer)) {
       return false;
     }
@@ -82,6 +82,10 @@ struct TableFlattenerOptions {
 
   // Map from original resource ids to obfuscated names.
   std::unordered_map<uint32_t, std::string> id_resource_map;
+
+  // The number of threads used to flatten the configurations of each package. The output does not
+  // depend on it.
+  size_t jobs = 1;
 };
 
 class TableFlattener : public IResourceTableConsumer {
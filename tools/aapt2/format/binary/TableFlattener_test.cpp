@@ -216,6 +216,38 @@ TEST_F(TableFlattenerTest, FlattenEntriesWithGapsInIds) {
                      Res_value::TYPE_INT_BOOLEAN, 0u, 0u));
 }
 
+TEST_F(TableFlattenerTest, FlattenInParallelMatchesSerialOutput) {
+  auto build_table = [] {
+    return test::ResourceTableBuilder()
+        .AddSimple("com.app.test:id/one", ResourceId(0x7f020000))
+        .AddSimple("com.app.test:id/two", ResourceId(0x7f020001))
+        .AddValue("com.app.test:integer/one", ResourceId(0x7f030000),
+                  util::make_unique<BinaryPrimitive>(uint8_t(Res_value::TYPE_INT_DEC), 1u))
+        .AddValue("com.app.test:integer/one", test::ParseConfigOrDie("v1"),
+                  ResourceId(0x7f030000),
+                  util::make_unique<BinaryPrimitive>(uint8_t(Res_value::TYPE_INT_DEC), 2u))
+        .AddValue("com.app.test:integer/one", test::ParseConfigOrDie("land"),
+                  ResourceId(0x7f030000),
+                  util::make_unique<BinaryPrimitive>(uint8_t(Res_value::TYPE_INT_DEC), 3u))
+        .AddString("com.app.test:string/test", ResourceId(0x7f040000), "foo")
+        .AddString("com.app.test:string/test", test::ParseConfigOrDie("fr"),
+                   ResourceId(0x7f040000), "bar")
+        .Build();
+  };
+
+  std::unique_ptr<ResourceTable> serial_table = build_table();
+  std::string serial_content;
+  ASSERT_TRUE(Flatten(context_.get(), {}, serial_table.get(), &serial_content));
+
+  std::unique_ptr<ResourceTable> parallel_table = build_table();
+  TableFlattenerOptions options;
+  options.jobs = 4;
+  std::string parallel_content;
+  ASSERT_TRUE(Flatten(context_.get(), options, parallel_table.get(), &parallel_content));
+
+  EXPECT_EQ(serial_content, parallel_content);
+}
+
 TEST_F(TableFlattenerTest, FlattenMinMaxAttributes) {
   Attribute attr;
   attr.type_mask = android::ResTable_map::TYPE_INTEGER;
@@ -17,7 +17,8 @@
 #include "format/binary/XmlFlattener.h"
 
 #include <algorithm>
-#include <map>
+#include <deque>
+#include <unordered_map>
 #include <vector>
 
 #include "android-base/logging.h"
@@ -30,6 +31,7 @@
 #include "ValueVisitor.h"
 #include "format/binary/ChunkWriter.h"
 #include "format/binary/ResourceTypeExtensions.h"
+#include "trace/TraceBuffer.h"
 #include "xml/XmlDom.h"
 
 using namespace android;
@@ -60,22 +62,133 @@ static bool cmp_xml_attribute_by_id(const xml::Attribute* a, const xml::Attribut
   return false;
 }
 
-class XmlFlattenerVisitor : public xml::ConstVisitor {
+// The strings of one document, deduplicated by value and priority. This yields the same set of
+// strings as adding them to a StringPool, but only the unique ones are copied and hashed into the
+// pool at the end, already in pool order. The collector is reused across documents so that its
+// storage and hash table don't grow again for every file.
+class XmlStringCollector {
  public:
-  using xml::ConstVisitor::Visit;
+  XmlStringCollector() = default;
+
+  // Returns the handle of the string. `str` must outlive the next Clear().
+  uint32_t Add(StringPiece str, uint32_t priority) {
+    auto [iter, inserted] = index_.try_emplace(str, entries_.size());
+    if (!inserted) {
+      for (uint32_t i = iter->second; i != kNone; i = entries_[i].next) {
+        if (entries_[i].priority == priority) {
+          return i;
+        }
+      }
+      // Same value with another priority, chain it in front of the others.
+      entries_.push_back(Entry{iter->first, priority, iter->second});
+      iter->second = entries_.size() - 1;
+      return entries_.size() - 1;
+    }
+    entries_.push_back(Entry{iter->first, priority, kNone});
+    return entries_.size() - 1;
+  }
 
-  android::StringPool pool;
-  std::map<uint8_t, android::StringPool> package_pools;
+  // Like Add(), for strings that don't outlive the call.
+  uint32_t AddCopy(StringPiece str, uint32_t priority) {
+    if (index_.find(str) != index_.end()) {
+      return Add(str, priority);
+    }
+    if (owned_count_ == owned_.size()) {
+      owned_.emplace_back();
+    }
+    std::string& copy = owned_[owned_count_++];
+    copy.assign(str);
+    return Add(copy, priority);
+  }
+
+  // Adds the strings to `pool` ordered by priority, then value, which is the order
+  // StringPool::Sort() puts them in, and records the pool index of every handle.
+  void MoveToPool(android::StringPool* pool) {
+    order_.resize(entries_.size());
+    for (uint32_t i = 0; i < order_.size(); i++) {
+      order_[i] = i;
+    }
+    std::sort(order_.begin(), order_.end(), [&](uint32_t a, uint32_t b) {
+      const Entry& entry_a = entries_[a];
+      const Entry& entry_b = entries_[b];
+      if (entry_a.priority != entry_b.priority) {
+        return entry_a.priority < entry_b.priority;
+      }
+      return entry_a.value < entry_b.value;
+    });
+
+    pool_index_.resize(entries_.size());
+    pool->HintWillAdd(entries_.size(), 0);
+    for (uint32_t i = 0; i < order_.size(); i++) {
+      const Entry& entry = entries_[order_[i]];
+      pool->MakeRef(entry.value, android::StringPool::Context(entry.priority));
+      pool_index_[order_[i]] = i;
+    }
+  }
+
+  uint32_t PoolIndex(uint32_t handle) const {
+    return pool_index_[handle];
+  }
+
+  void Clear() {
+    entries_.clear();
+    index_.clear();
+    owned_count_ = 0;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(XmlStringCollector);
+
+  static constexpr uint32_t kNone = 0xffffffffu;
 
-  struct StringFlattenDest {
-    android::StringPool::Ref ref;
-    ResStringPool_ref* dest;
+  struct Entry {
+    StringPiece value;
+    uint32_t priority;
+    // The next entry with the same value and a different priority.
+    uint32_t next;
   };
 
+  std::vector<Entry> entries_;
+  std::unordered_map<StringPiece, uint32_t> index_;
+  // Backing storage for AddCopy(), a deque so that growing it doesn't move the strings.
+  std::deque<std::string> owned_;
+  size_t owned_count_ = 0;
+  std::vector<uint32_t> order_;
+  std::vector<uint32_t> pool_index_;
+};
+
+// Where a string handle gets written once the pool order is known.
+struct StringFlattenDest {
+  uint32_t handle;
+  ResStringPool_ref* dest;
+};
+
+// State that is reused by all the documents flattened on a thread, to keep the allocations of
+// flattening many small layouts down.
+struct XmlFlattenerScratch {
+  XmlStringCollector strings;
   std::vector<StringFlattenDest> string_refs;
+  std::vector<const xml::Attribute*> filtered_attrs;
+  std::string processed_str;
+  // Block size of the node buffer, the size of the previous document within bounds.
+  size_t node_buffer_block_size = kMinNodeBufferBlockSize;
+
+  static constexpr size_t kMinNodeBufferBlockSize = 1024;
+  static constexpr size_t kMaxNodeBufferBlockSize = 64 * 1024;
+
+  void Clear() {
+    strings.Clear();
+    string_refs.clear();
+  }
+};
+
+class XmlFlattenerVisitor : public xml::ConstVisitor {
+ public:
+  using xml::ConstVisitor::Visit;
 
-  XmlFlattenerVisitor(BigBuffer* buffer, XmlFlattenerOptions options)
-      : buffer_(buffer), options_(options) {
+  XmlFlattenerVisitor(BigBuffer* buffer, XmlFlattenerOptions options,
+                      XmlFlattenerScratch* scratch)
+      : buffer_(buffer), options_(options), scratch_(scratch) {
   }
 
   void Visit(const xml::Text* node) override {
@@ -100,7 +213,8 @@ class XmlFlattenerVisitor : public xml::ConstVisitor {
     flat_node->comment.index = android::util::HostToDevice32(-1);
 
     ResXMLTree_cdataExt* flat_text = writer.NextBlock<ResXMLTree_cdataExt>();
-    AddString(text, kLowPriority, &flat_text->data);
+    scratch_->string_refs.push_back(
+        StringFlattenDest{scratch_->strings.AddCopy(text, kLowPriority), &flat_text->data});
     writer.Finish();
   }
 
@@ -162,27 +276,20 @@ class XmlFlattenerVisitor : public xml::ConstVisitor {
  private:
   DISALLOW_COPY_AND_ASSIGN(XmlFlattenerVisitor);
 
-  // We are adding strings to a StringPool whose strings will be sorted and merged with other
-  // string pools. That means we can't encode the ID of a string directly. Instead, we defer the
-  // writing of the ID here, until after the StringPool is merged and sorted.
+  // The strings will be sorted once the whole document is visited. That means we can't encode
+  // the ID of a string directly. Instead, we defer the writing of the ID here, until after the
+  // StringPool is built. `str` must outlive the visitor.
   void AddString(StringPiece str, uint32_t priority, android::ResStringPool_ref* dest,
                  bool treat_empty_string_as_null = false) {
     if (str.empty() && treat_empty_string_as_null) {
       // Some parts of the runtime treat null differently than empty string.
       dest->index = android::util::DeviceToHost32(-1);
     } else {
-      string_refs.push_back(
-          StringFlattenDest{pool.MakeRef(str, android::StringPool::Context(priority)), dest});
+      scratch_->string_refs.push_back(
+          StringFlattenDest{scratch_->strings.Add(str, priority), dest});
     }
   }
 
-  // We are adding strings to a StringPool whose strings will be sorted and merged with other
-  // string pools. That means we can't encode the ID of a string directly. Instead, we defer the
-  // writing of the ID here, until after the StringPool is merged and sorted.
-  void AddString(const android::StringPool::Ref& ref, android::ResStringPool_ref* dest) {
-    string_refs.push_back(StringFlattenDest{ref, dest});
-  }
-
   void WriteNamespace(const xml::NamespaceDecl& decl, uint16_t type) {
     ChunkWriter writer(buffer_);
 
@@ -199,30 +306,33 @@ class XmlFlattenerVisitor : public xml::ConstVisitor {
 
   void WriteAttributes(const xml::Element* node, ResXMLTree_attrExt* flat_elem,
                        ChunkWriter* writer) {
-    filtered_attrs_.clear();
-    filtered_attrs_.reserve(node->attributes.size());
+    std::vector<const xml::Attribute*>& filtered_attrs = scratch_->filtered_attrs;
+    filtered_attrs.clear();
 
     // Filter the attributes.
     for (const xml::Attribute& attr : node->attributes) {
       if (attr.namespace_uri != xml::kSchemaTools) {
-        filtered_attrs_.push_back(&attr);
+        filtered_attrs.push_back(&attr);
       }
     }
 
-    if (filtered_attrs_.empty()) {
+    if (filtered_attrs.empty()) {
       return;
     }
 
     const ResourceId kIdAttr(0x010100d0);
 
-    std::sort(filtered_attrs_.begin(), filtered_attrs_.end(), cmp_xml_attribute_by_id);
+    // Linked documents usually list their attributes in ID order already.
+    if (!std::is_sorted(filtered_attrs.begin(), filtered_attrs.end(), cmp_xml_attribute_by_id)) {
+      std::sort(filtered_attrs.begin(), filtered_attrs.end(), cmp_xml_attribute_by_id);
+    }
 
-    flat_elem->attributeCount = android::util::HostToDevice16(filtered_attrs_.size());
+    flat_elem->attributeCount = android::util::HostToDevice16(filtered_attrs.size());
 
     ResXMLTree_attribute* flat_attr =
-        writer->NextBlock<ResXMLTree_attribute>(filtered_attrs_.size());
+        writer->NextBlock<ResXMLTree_attribute>(filtered_attrs.size());
     uint16_t attribute_index = 1;
-    for (const xml::Attribute* xml_attr : filtered_attrs_) {
+    for (const xml::Attribute* xml_attr : filtered_attrs) {
       // Assign the indices for specific attributes.
       if (xml_attr->compiled_attribute && xml_attr->compiled_attribute.value().id &&
           xml_attr->compiled_attribute.value().id.value() == kIdAttr) {
@@ -249,22 +359,13 @@ class XmlFlattenerVisitor : public xml::ConstVisitor {
       } else {
         // Attribute names are stored without packages, but we use
         // their StringPool index to lookup their resource IDs.
-        // This will cause collisions, so we can't dedupe
-        // attribute names from different packages. We use separate
-        // pools that we later combine.
-        //
-        // Lookup the StringPool for this package and make the reference there.
+        // Names are deduplicated by value and resource ID, so the same
+        // name from different packages gets distinct strings.
         const xml::AaptAttribute& aapt_attr = xml_attr->compiled_attribute.value();
-
-        android::StringPool::Ref name_ref =
-            package_pools[aapt_attr.id.value().package_id()].MakeRef(
-                xml_attr->name, android::StringPool::Context(aapt_attr.id.value().id));
-
-        // Add it to the list of strings to flatten.
-        AddString(name_ref, &flat_attr->name);
+        AddString(xml_attr->name, aapt_attr.id.value().id, &flat_attr->name);
       }
 
-      std::string processed_str;
+      bool processed = false;
       std::optional<StringPiece> compiled_text;
       if (xml_attr->compiled_value != nullptr) {
         // Make sure we're not flattening a String. A String can be referencing a string from
@@ -280,20 +381,24 @@ class XmlFlattenerVisitor : public xml::ConstVisitor {
       } else {
         // There is no compiled value, so treat the raw string as compiled, once it is processed to
         // make sure escape sequences are properly interpreted.
-        processed_str =
+        scratch_->processed_str =
             StringBuilder(true /*preserve_spaces*/).AppendText(xml_attr->value).to_string();
-        compiled_text = StringPiece(processed_str);
+        compiled_text = StringPiece(scratch_->processed_str);
+        processed = true;
       }
 
       if (compiled_text) {
-        // Write out the compiled text and raw_text.
+        // Write out the compiled text and raw_text. The processed string is reused by the next
+        // attribute, so it needs to be copied.
+        uint32_t text = processed ? scratch_->strings.AddCopy(compiled_text.value(), kLowPriority)
+                                  : scratch_->strings.Add(compiled_text.value(), kLowPriority);
         flat_attr->typedValue.dataType = android::Res_value::TYPE_STRING;
-        AddString(compiled_text.value(), kLowPriority,
-                  reinterpret_cast<ResStringPool_ref*>(&flat_attr->typedValue.data));
+        scratch_->string_refs.push_back(StringFlattenDest{
+            text, reinterpret_cast<ResStringPool_ref*>(&flat_attr->typedValue.data)});
         if (options_.keep_raw_values) {
           AddString(xml_attr->value, kLowPriority, &flat_attr->rawValue);
         } else {
-          AddString(compiled_text.value(), kLowPriority, &flat_attr->rawValue);
+          scratch_->string_refs.push_back(StringFlattenDest{text, &flat_attr->rawValue});
         }
       } else if (options_.keep_raw_values && !xml_attr->value.empty()) {
         AddString(xml_attr->value, kLowPriority, &flat_attr->rawValue);
@@ -306,32 +411,30 @@ class XmlFlattenerVisitor : public xml::ConstVisitor {
 
   BigBuffer* buffer_;
   XmlFlattenerOptions options_;
-
-  // Scratch vector to filter attributes. We avoid allocations making this a member.
-  std::vector<const xml::Attribute*> filtered_attrs_;
+  XmlFlattenerScratch* scratch_;
 };
 
 }  // namespace
 
 bool XmlFlattener::Flatten(IAaptContext* context, const xml::Node* node) {
-  android::BigBuffer node_buffer(1024);
-  XmlFlattenerVisitor visitor(&node_buffer, options_);
-  node->Accept(&visitor);
+  static thread_local XmlFlattenerScratch scratch;
+  scratch.Clear();
 
-  // Merge the package pools into the main pool.
-  for (auto& package_pool_entry : visitor.package_pools) {
-    visitor.pool.Merge(std::move(package_pool_entry.second));
-  }
+  android::BigBuffer node_buffer(scratch.node_buffer_block_size);
+  XmlFlattenerVisitor visitor(&node_buffer, options_, &scratch);
+  node->Accept(&visitor);
+  scratch.node_buffer_block_size =
+      std::clamp(node_buffer.size(), XmlFlattenerScratch::kMinNodeBufferBlockSize,
+                 XmlFlattenerScratch::kMaxNodeBufferBlockSize);
 
-  // Sort the string pool so that attribute resource IDs show up first.
-  visitor.pool.Sort(
-      [](const android::StringPool::Context& a, const android::StringPool::Context& b) -> int {
-        return util::compare(a.priority, b.priority);
-      });
+  // Build the string pool sorted so that attribute resource IDs show up first.
+  android::StringPool pool;
+  scratch.strings.MoveToPool(&pool);
 
   // Now we flatten the string pool references into the correct places.
-  for (const auto& ref_entry : visitor.string_refs) {
-    ref_entry.dest->index = android::util::HostToDevice32(ref_entry.ref.index());
+  for (const StringFlattenDest& ref_entry : scratch.string_refs) {
+    ref_entry.dest->index =
+        android::util::HostToDevice32(scratch.strings.PoolIndex(ref_entry.handle));
   }
 
   // Write the XML header.
@@ -340,16 +443,16 @@ bool XmlFlattener::Flatten(IAaptContext* context, const xml::Node* node) {
 
   // Flatten the StringPool.
   if (options_.use_utf16) {
-    android::StringPool::FlattenUtf16(buffer_, visitor.pool, context->GetDiagnostics());
+    android::StringPool::FlattenUtf16(buffer_, pool, context->GetDiagnostics());
   } else {
-    android::StringPool::FlattenUtf8(buffer_, visitor.pool, context->GetDiagnostics());
+    android::StringPool::FlattenUtf8(buffer_, pool, context->GetDiagnostics());
   }
 
   {
     // Write the array of resource IDs, indexed by StringPool order.
     ChunkWriter res_id_map_writer(buffer_);
     res_id_map_writer.StartChunk<ResChunk_header>(RES_XML_RESOURCE_MAP_TYPE);
-    for (const auto& str : visitor.pool.strings()) {
+    for (const auto& str : pool.strings()) {
       ResourceId id(str->context.priority);
       if (str->context.priority == kLowPriority || !id.is_valid()) {
         // When we see the first non-resource ID, we're done.
@@ -369,6 +472,7 @@ bool XmlFlattener::Flatten(IAaptContext* context, const xml::Node* node) {
 }
 
 bool XmlFlattener::Consume(IAaptContext* context, const xml::XmlResource* resource) {
+  TRACE_CALL();
   if (!resource->root) {
     return false;
   }
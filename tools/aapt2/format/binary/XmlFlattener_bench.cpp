@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// Flattens a synthetic corpus of layouts that share the framework attributes and namespaces, the
+// way the layouts of a large app do, e.g.
+//   aapt2_benchmarks --benchmark_filter=XmlFlattener
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "android-base/stringprintf.h"
+#include "benchmark/benchmark.h"
+
+#include "format/binary/XmlFlattener.h"
+#include "test/Test.h"
+
+using ::android::base::StringPrintf;
+
+namespace aapt {
+
+namespace {
+
+constexpr int kLayoutCount = 500;
+constexpr int kViewsPerLayout = 40;
+
+struct FrameworkAttr {
+  const char* name;
+  uint32_t id;
+};
+
+constexpr FrameworkAttr kFrameworkAttrs[] = {
+    {"text", 0x0101014f},          {"id", 0x010100d0},
+    {"layout_width", 0x010100f4},  {"layout_height", 0x010100f5},
+    {"orientation", 0x010100c4},   {"padding", 0x010100d5},
+    {"layout_margin", 0x010100f6}, {"gravity", 0x010100af},
+};
+
+std::string BuildLayout(int layout) {
+  std::string xml =
+      "<LinearLayout xmlns:android=\"http://schemas.android.com/apk/res/android\"\n"
+      "    android:orientation=\"vertical\" android:layout_width=\"match_parent\"\n"
+      "    android:layout_height=\"match_parent\">\n";
+  for (int v = 0; v < kViewsPerLayout; v++) {
+    xml += StringPrintf(
+        "  <TextView android:id=\"@+id/view%d\" android:layout_width=\"wrap_content\"\n"
+        "      android:layout_height=\"wrap_content\" android:padding=\"8dp\"\n"
+        "      android:gravity=\"center\" android:text=\"Label %d of layout %d\" />\n",
+        v, v, layout);
+  }
+  return xml + "</LinearLayout>";
+}
+
+// Attaches the framework IDs like XmlReferenceLinker would, listing the attributes in source order.
+void CompileAttributes(xml::Element* el) {
+  for (xml::Attribute& attr : el->attributes) {
+    for (const FrameworkAttr& framework_attr : kFrameworkAttrs) {
+      if (attr.name == framework_attr.name) {
+        attr.compiled_attribute =
+            xml::AaptAttribute(Attribute(), ResourceId(framework_attr.id));
+      }
+    }
+  }
+  for (xml::Element* child : el->GetChildElements()) {
+    CompileAttributes(child);
+  }
+}
+
+void BM_XmlFlattenerLayouts(benchmark::State& state) {
+  std::unique_ptr<IAaptContext> context = test::ContextBuilder().Build();
+  std::vector<std::unique_ptr<xml::XmlResource>> layouts;
+  for (int i = 0; i < kLayoutCount; i++) {
+    layouts.push_back(test::BuildXmlDom(BuildLayout(i)));
+    CompileAttributes(layouts.back()->root.get());
+  }
+
+  size_t bytes = 0;
+  for (auto _ : state) {
+    for (const auto& layout : layouts) {
+      android::BigBuffer buffer(1024);
+      XmlFlattener flattener(&buffer, {});
+      bool result = flattener.Consume(context.get(), layout.get());
+      benchmark::DoNotOptimize(result);
+      bytes += buffer.size();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kLayoutCount);
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_XmlFlattenerLayouts)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+}  // namespace aapt
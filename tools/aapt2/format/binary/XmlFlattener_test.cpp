@@ -134,6 +134,28 @@ TEST_F(XmlFlattenerTest, FlattenXmlWithNoCompiledAttributes) {
   ASSERT_THAT(tree.next(), Eq(android::ResXMLTree::END_DOCUMENT));
 }
 
+TEST_F(XmlFlattenerTest, StringsDoNotLeakIntoTheNextDocument) {
+  std::unique_ptr<xml::XmlResource> first = test::BuildXmlDom(R"(
+      <View xmlns:test="http://com.test" attr="hey" other="hey">
+          <Layout test:hello="hi">Some text</Layout>
+      </View>)");
+  std::unique_ptr<xml::XmlResource> second = test::BuildXmlDom(R"(<Layout attr="hi" />)");
+
+  android::ResXMLTree first_tree;
+  ASSERT_TRUE(Flatten(first.get(), &first_tree));
+  // test, http://com.test, View, attr, other, hey, Layout, hello, hi and the text.
+  EXPECT_THAT(first_tree.getStrings().size(), Eq(10u));
+
+  android::ResXMLTree second_tree;
+  ASSERT_TRUE(Flatten(second.get(), &second_tree));
+  EXPECT_THAT(second_tree.getStrings().size(), Eq(3u));
+
+  ASSERT_THAT(second_tree.next(), Eq(android::ResXMLTree::START_TAG));
+  size_t len;
+  EXPECT_THAT(second_tree.getElementName(&len), StrEq(u"Layout"));
+  EXPECT_THAT(second_tree.getAttributeStringValue(0, &len), StrEq(u"hi"));
+}
+
 TEST_F(XmlFlattenerTest, FlattenCompiledXmlAndStripOnlyTools) {
   std::unique_ptr<xml::XmlResource> doc = test::BuildXmlDom(R"(
       <View xmlns:tools="http://schemas.android.com/tools"
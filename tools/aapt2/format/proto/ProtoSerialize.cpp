@@ -19,6 +19,7 @@
 #include "ValueVisitor.h"
 #include "androidfw/BigBuffer.h"
 #include "optimize/Obfuscator.h"
+#include "trace/TraceBuffer.h"
 
 using android::ConfigDescription;
 
@@ -345,6 +346,7 @@ static void SerializeOverlayableItemToPb(const OverlayableItem& overlayable_item
 
 void SerializeTableToPb(const ResourceTable& table, pb::ResourceTable* out_table,
                         android::IDiagnostics* diag, SerializeTableOptions options) {
+  TRACE_CALL();
   auto source_pool = (options.exclude_sources) ? nullptr : util::make_unique<android::StringPool>();
 
   pb::ToolFingerprint* pb_fingerprint = out_table->add_tool_fingerprint();
@@ -41,7 +41,7 @@ class IData : public android::KnownSizeInputStream {
 
 class DataSegment : public IData {
  public:
-  explicit DataSegment(std::unique_ptr<IData> data, size_t offset, size_t len)
+  explicit DataSegment(std::shared_ptr<IData> data, size_t offset, size_t len)
       : data_(std::move(data)), offset_(offset), len_(len), next_read_(offset) {}
   virtual ~DataSegment() = default;
 
@@ -83,7 +83,8 @@ class DataSegment : public IData {
  private:
   DISALLOW_COPY_AND_ASSIGN(DataSegment);
 
-  std::unique_ptr<IData> data_;
+  // Shared by the segments of an already opened file, only its data() is used.
+  std::shared_ptr<IData> data_;
   size_t offset_;
   size_t len_;
   size_t next_read_;
@@ -22,15 +22,22 @@ namespace aapt {
 namespace io {
 
 IFile* IFile::CreateFileSegment(size_t offset, size_t len) {
-  FileSegment* file_segment = new FileSegment(this, offset, len);
+  return CreateFileSegment(offset, len, {});
+}
+
+IFile* IFile::CreateFileSegment(size_t offset, size_t len, std::shared_ptr<IData> data) {
+  FileSegment* file_segment = new FileSegment(this, offset, len, std::move(data));
   segments_.push_back(std::unique_ptr<IFile>(file_segment));
   return file_segment;
 }
 
 std::unique_ptr<IData> FileSegment::OpenAsData() {
-  std::unique_ptr<IData> data = file_->OpenAsData();
+  std::shared_ptr<IData> data = data_;
   if (!data) {
-    return {};
+    data = file_->OpenAsData();
+    if (!data) {
+      return {};
+    }
   }
 
   if (offset_ <= data->size() - len_) {
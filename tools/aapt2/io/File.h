@@ -52,6 +52,10 @@ class IFile {
 
   IFile* CreateFileSegment(size_t offset, size_t len);
 
+  // Like CreateFileSegment(), but the segment reads from `data`, the already opened contents of
+  // this file, instead of opening the whole file again each time the segment is opened.
+  IFile* CreateFileSegment(size_t offset, size_t len, std::shared_ptr<IData> data);
+
   // Returns whether the file was compressed before it was stored in memory.
   virtual bool WasCompressed() {
     return false;
@@ -74,8 +78,8 @@ class IFile {
 // An IFile that wraps an underlying IFile but limits it to a subsection of that file.
 class FileSegment : public IFile {
  public:
-  explicit FileSegment(IFile* file, size_t offset, size_t len)
-      : file_(file), offset_(offset), len_(len) {}
+  explicit FileSegment(IFile* file, size_t offset, size_t len, std::shared_ptr<IData> data = {})
+      : file_(file), offset_(offset), len_(len), data_(std::move(data)) {}
 
   std::unique_ptr<IData> OpenAsData() override;
   std::unique_ptr<android::InputStream> OpenInputStream() override;
@@ -94,6 +98,8 @@ class FileSegment : public IFile {
   IFile* file_;
   size_t offset_;
   size_t len_;
+  // The contents of file_, if they were opened already.
+  std::shared_ptr<IData> data_;
 };
 
 class IFileCollectionIterator {
@@ -28,8 +28,9 @@ using ::android::StringPiece;
 namespace aapt {
 namespace io {
 
-ZipFile::ZipFile(ZipArchiveHandle handle, const ZipEntry& entry, const android::Source& source)
-    : zip_handle_(handle), zip_entry_(entry), source_(source) {
+ZipFile::ZipFile(ZipArchiveHandle handle, const ZipEntry& entry, const android::Source& source,
+                 std::mutex* extract_mutex)
+    : zip_handle_(handle), zip_entry_(entry), source_(source), extract_mutex_(extract_mutex) {
 }
 
 std::unique_ptr<IData> ZipFile::OpenAsData() {
@@ -52,9 +53,11 @@ std::unique_ptr<IData> ZipFile::OpenAsData() {
   } else {
     std::unique_ptr<uint8_t[]> data =
         std::unique_ptr<uint8_t[]>(new uint8_t[zip_entry_.uncompressed_length]);
+    std::unique_lock<std::mutex> lock(*extract_mutex_);
     int32_t result =
         ExtractToMemory(zip_handle_, &zip_entry_, data.get(),
                         static_cast<uint32_t>(zip_entry_.uncompressed_length));
+    lock.unlock();
     if (result != 0) {
       return {};
     }
@@ -138,8 +141,9 @@ std::unique_ptr<ZipFileCollection> ZipFileCollection::Create(StringPiece path,
       continue;
     }
 
-    std::unique_ptr<IFile> file = util::make_unique<ZipFile>(collection->handle_, zip_data,
-                                                             android::Source(zip_entry_path, path));
+    std::unique_ptr<IFile> file = util::make_unique<ZipFile>(
+        collection->handle_, zip_data, android::Source(zip_entry_path, path),
+        &collection->extract_mutex_);
     collection->files_by_name_[zip_entry_path] = file.get();
     collection->files_.push_back(std::move(file));
   }
@@ -20,6 +20,7 @@
 #include "ziparchive/zip_archive.h"
 
 #include <map>
+#include <mutex>
 
 #include "androidfw/StringPiece.h"
 
@@ -30,9 +31,12 @@ namespace io {
 
 // An IFile representing a file within a ZIP archive. If the file is compressed, it is uncompressed
 // and copied into memory when opened. Otherwise it is mmapped from the ZIP archive.
+// Files of the same archive may be opened from several threads, `extract_mutex` serializes the
+// extractions that go through the shared archive handle.
 class ZipFile : public IFile {
  public:
-  ZipFile(::ZipArchiveHandle handle, const ::ZipEntry& entry, const android::Source& source);
+  ZipFile(::ZipArchiveHandle handle, const ::ZipEntry& entry, const android::Source& source,
+          std::mutex* extract_mutex);
 
   std::unique_ptr<IData> OpenAsData() override;
   std::unique_ptr<android::InputStream> OpenInputStream() override;
@@ -44,6 +48,7 @@ class ZipFile : public IFile {
   ::ZipArchiveHandle zip_handle_;
   ::ZipEntry zip_entry_;
   android::Source source_;
+  std::mutex* extract_mutex_;
 };
 
 class ZipFileCollection;
@@ -76,6 +81,7 @@ class ZipFileCollection : public IFileCollection {
   ZipFileCollection();
 
   ZipArchiveHandle handle_;
+  std::mutex extract_mutex_;
   std::vector<std::unique_ptr<IFile>> files_;
   std::map<std::string, IFile*, std::less<>> files_by_name_;
 };
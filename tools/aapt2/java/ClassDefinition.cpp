@@ -16,10 +16,14 @@
 
 #include "java/ClassDefinition.h"
 
+#include <algorithm>
+
+#include "android-base/stringprintf.h"
 #include "androidfw/StringPiece.h"
 
 using ::aapt::text::Printer;
 using ::android::StringPiece;
+using ::android::base::StringPrintf;
 
 namespace aapt {
 
@@ -27,6 +31,32 @@ void ClassMember::Print(bool /*final*/, Printer* printer, bool strip_api_annotat
   processor_.Print(printer, strip_api_annotations);
 }
 
+bool ClassMember::AppendToClassFile(bool /*final*/, ClassFileBuilder* builder,
+                                    std::vector<ClassFile>* /*out_classes*/,
+                                    std::string* out_error) const {
+  *out_error = StringPrintf("'%s' of class %s can not be compiled to a class file",
+                            GetName().c_str(), builder->GetClassName().c_str());
+  return false;
+}
+
+ClassFileBuilder::ArrayElement ResourceArrayMemberStringConverter::ToArrayElement(
+    const std::variant<ResourceId, FieldReference>& ref) {
+  if (auto id = std::get_if<ResourceId>(&ref)) {
+    return static_cast<int32_t>(id->id);
+  }
+
+  // "com.example.R.attr.foo" is the field "foo" of the class "com/example/R$attr".
+  StringPiece class_name = std::get<FieldReference>(ref).ref;
+  const size_t entry_start = class_name.rfind('.');
+  const std::string field_name(class_name.substr(entry_start + 1));
+  class_name = class_name.substr(0, entry_start);
+  const size_t type_start = class_name.rfind('.');
+  std::string binary_name(class_name.substr(0, type_start));
+  std::replace(binary_name.begin(), binary_name.end(), '.', '/');
+  binary_name.append("$").append(class_name.substr(type_start + 1));
+  return ClassFileBuilder::FieldRef{std::move(binary_name), field_name};
+}
+
 void MethodDefinition::AppendStatement(StringPiece statement) {
   statements_.emplace_back(statement);
 }
@@ -102,6 +132,40 @@ void ClassDefinition::Print(bool final, Printer* printer, bool strip_api_annotat
   printer->Print("}");
 }
 
+bool ClassDefinition::AppendToClassFile(bool final, ClassFileBuilder* builder,
+                                        std::vector<ClassFile>* out_classes,
+                                        std::string* out_error) const {
+  if (empty() && !create_if_empty_) {
+    return true;
+  }
+
+  const std::string class_name = builder->GetClassName() + "$" + name_;
+  const bool is_static = qualifier_ == ClassQualifier::kStatic;
+  builder->AddInnerClass(class_name, builder->GetClassName(), name_, is_static);
+
+  ClassFileBuilder nested_builder(class_name);
+  nested_builder.AddInnerClass(class_name, builder->GetClassName(), name_, is_static);
+  return BuildClassFile(final, &nested_builder, out_classes, out_error);
+}
+
+bool ClassDefinition::BuildClassFile(bool final, ClassFileBuilder* builder,
+                                     std::vector<ClassFile>* out_classes,
+                                     std::string* out_error) const {
+  for (const std::unique_ptr<ClassMember>& member : ordered_members_) {
+    // Overridden members are nullptr, see Print().
+    if (member != nullptr && !member->AppendToClassFile(final, builder, out_classes, out_error)) {
+      return false;
+    }
+  }
+
+  ClassFile class_file;
+  if (!builder->Build(&class_file, out_error)) {
+    return false;
+  }
+  out_classes->push_back(std::move(class_file));
+  return true;
+}
+
 constexpr static const char* sWarningHeader =
     "/* AUTO-GENERATED FILE. DO NOT MODIFY.\n"
     " *\n"
@@ -118,4 +182,15 @@ void ClassDefinition::WriteJavaFile(const ClassDefinition* def, StringPiece pack
   def->Print(final, &printer, strip_api_annotations);
 }
 
+bool ClassDefinition::WriteClassFiles(const ClassDefinition* def, StringPiece package, bool final,
+                                      std::vector<ClassFile>* out_classes,
+                                      std::string* out_error) {
+  std::string class_name(package);
+  std::replace(class_name.begin(), class_name.end(), '.', '/');
+  class_name.append("/").append(def->name_);
+
+  ClassFileBuilder builder(class_name);
+  return def->BuildClassFile(final, &builder, out_classes, out_error);
+}
+
 }  // namespace aapt
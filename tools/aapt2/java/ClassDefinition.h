@@ -18,6 +18,7 @@
 #define AAPT_JAVA_CLASSDEFINITION_H
 
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
@@ -26,6 +27,7 @@
 
 #include "Resource.h"
 #include "java/AnnotationProcessor.h"
+#include "java/ClassFile.h"
 #include "text/Printer.h"
 #include "util/Util.h"
 
@@ -52,6 +54,12 @@ class ClassMember {
   // this member's comments/annotations.
   virtual void Print(bool final, text::Printer* printer, bool strip_api_annotations = false) const;
 
+  // Adds the member to `builder`, the class file of the enclosing class. Nested classes add their
+  // own class files to `out_classes`. Comments and annotations are not kept. Fails with
+  // `out_error` set for members that only exist as Java source.
+  virtual bool AppendToClassFile(bool final, ClassFileBuilder* builder,
+                                 std::vector<ClassFile>* out_classes, std::string* out_error) const;
+
  private:
   AnnotationProcessor processor_;
 };
@@ -92,6 +100,19 @@ class PrimitiveMember : public ClassMember {
     }
   }
 
+  bool AppendToClassFile(bool final, ClassFileBuilder* builder, std::vector<ClassFile>*,
+                         std::string*) const override {
+    uint32_t value;
+    if constexpr (std::is_same_v<T, ResourceId>) {
+      value = val_.id;
+    } else {
+      value = val_;
+    }
+    // Staged APIs are assigned in the static initializer so that they are not inlined.
+    builder->AddIntField(name_, static_cast<int32_t>(value), final, !staged_api_);
+    return true;
+  }
+
  private:
   DISALLOW_COPY_AND_ASSIGN(PrimitiveMember);
 
@@ -127,6 +148,12 @@ class PrimitiveMember<std::string> : public ClassMember {
     printer->Print("String ").Print(name_).Print("=\"").Print(val_).Print("\";");
   }
 
+  bool AppendToClassFile(bool final, ClassFileBuilder* builder, std::vector<ClassFile>*,
+                         std::string*) const override {
+    builder->AddStringField(name_, val_, final);
+    return true;
+  }
+
  private:
   DISALLOW_COPY_AND_ASSIGN(PrimitiveMember);
 
@@ -180,6 +207,17 @@ class PrimitiveArrayMember : public ClassMember {
     printer->Print("};");
   }
 
+  bool AppendToClassFile(bool, ClassFileBuilder* builder, std::vector<ClassFile>*,
+                         std::string*) const override {
+    std::vector<ClassFileBuilder::ArrayElement> elements;
+    elements.reserve(elements_.size());
+    for (const T& element : elements_) {
+      elements.push_back(StringConverter::ToArrayElement(element));
+    }
+    builder->AddIntArrayField(name_, elements);
+    return true;
+  }
+
  private:
   DISALLOW_COPY_AND_ASSIGN(PrimitiveArrayMember);
 
@@ -201,6 +239,9 @@ struct ResourceArrayMemberStringConverter {
       return std::get<FieldReference>(ref).ref;
     }
   }
+
+  static ClassFileBuilder::ArrayElement ToArrayElement(
+      const std::variant<ResourceId, FieldReference>& ref);
 };
 
 using ResourceArrayMember = PrimitiveArrayMember<std::variant<ResourceId, FieldReference>,
@@ -243,6 +284,11 @@ class ClassDefinition : public ClassMember {
   static void WriteJavaFile(const ClassDefinition* def, android::StringPiece package, bool final,
                             bool strip_api_annotations, android::OutputStream* out);
 
+  // Compiles the class and its nested classes to JVM class files, so that they do not have to go
+  // through javac. Fails with `out_error` set if a member only exists as Java source.
+  static bool WriteClassFiles(const ClassDefinition* def, android::StringPiece package, bool final,
+                              std::vector<ClassFile>* out_classes, std::string* out_error);
+
   ClassDefinition(android::StringPiece name, ClassQualifier qualifier, bool createIfEmpty)
       : name_(name), qualifier_(qualifier), create_if_empty_(createIfEmpty) {
   }
@@ -262,9 +308,17 @@ class ClassDefinition : public ClassMember {
 
   void Print(bool final, text::Printer* printer, bool strip_api_annotations = false) const override;
 
+  bool AppendToClassFile(bool final, ClassFileBuilder* builder,
+                         std::vector<ClassFile>* out_classes,
+                         std::string* out_error) const override;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(ClassDefinition);
 
+  // Adds the members to `builder`, the class file of this class, and then builds it.
+  bool BuildClassFile(bool final, ClassFileBuilder* builder, std::vector<ClassFile>* out_classes,
+                      std::string* out_error) const;
+
   std::string name_;
   ClassQualifier qualifier_;
   bool create_if_empty_;
@@ -0,0 +1,374 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "java/ClassFile.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "android-base/stringprintf.h"
+
+using ::android::StringPiece;
+using ::android::base::StringPrintf;
+
+namespace aapt {
+
+namespace {
+
+constexpr uint32_t kMagic = 0xcafebabe;
+// Java 8. The generated methods have no branches, so no StackMapTable is needed.
+constexpr uint16_t kMajorVersion = 52;
+
+constexpr uint16_t kAccPublic = 0x0001;
+constexpr uint16_t kAccStatic = 0x0008;
+constexpr uint16_t kAccFinal = 0x0010;
+constexpr uint16_t kAccSuper = 0x0020;
+
+constexpr uint8_t kConstantUtf8 = 1;
+constexpr uint8_t kConstantInteger = 3;
+constexpr uint8_t kConstantClass = 7;
+constexpr uint8_t kConstantString = 8;
+constexpr uint8_t kConstantFieldref = 9;
+constexpr uint8_t kConstantMethodref = 10;
+constexpr uint8_t kConstantNameAndType = 12;
+
+constexpr uint8_t kOpIconst0 = 0x03;
+constexpr uint8_t kOpBipush = 0x10;
+constexpr uint8_t kOpSipush = 0x11;
+constexpr uint8_t kOpLdc = 0x12;
+constexpr uint8_t kOpLdcW = 0x13;
+constexpr uint8_t kOpAload0 = 0x2a;
+constexpr uint8_t kOpIastore = 0x4f;
+constexpr uint8_t kOpDup = 0x59;
+constexpr uint8_t kOpReturn = 0xb1;
+constexpr uint8_t kOpGetstatic = 0xb2;
+constexpr uint8_t kOpPutstatic = 0xb3;
+constexpr uint8_t kOpInvokespecial = 0xb7;
+constexpr uint8_t kOpNewarray = 0xbc;
+constexpr uint8_t kArrayTypeInt = 10;
+
+constexpr size_t kMaxU2 = 0xffff;
+
+void WriteU1(std::string* out, uint8_t value) {
+  out->push_back(static_cast<char>(value));
+}
+
+void WriteU2(std::string* out, uint16_t value) {
+  WriteU1(out, value >> 8);
+  WriteU1(out, value & 0xff);
+}
+
+void WriteU4(std::string* out, uint32_t value) {
+  WriteU2(out, value >> 16);
+  WriteU2(out, value & 0xffff);
+}
+
+// Class files store strings in "modified UTF-8": NUL takes two bytes, and code points outside of
+// the BMP are stored as their UTF-16 surrogate pair, each encoded on three bytes.
+std::string ToModifiedUtf8(StringPiece value) {
+  std::string out;
+  out.reserve(value.size());
+  for (size_t i = 0; i < value.size(); i++) {
+    const uint8_t c = static_cast<uint8_t>(value[i]);
+    if (c == 0) {
+      out.append("\xc0\x80");
+    } else if ((c & 0xf8) == 0xf0 && i + 3 < value.size()) {
+      const uint32_t code_point = ((c & 0x07) << 18) | ((value[i + 1] & 0x3f) << 12) |
+                                  ((value[i + 2] & 0x3f) << 6) | (value[i + 3] & 0x3f);
+      const uint32_t offset = code_point - 0x10000;
+      for (uint32_t surrogate : {0xd800 + (offset >> 10), 0xdc00 + (offset & 0x3ff)}) {
+        out.push_back(static_cast<char>(0xe0 | (surrogate >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((surrogate >> 6) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (surrogate & 0x3f)));
+      }
+      i += 3;
+    } else {
+      out.push_back(static_cast<char>(c));
+    }
+  }
+  return out;
+}
+
+}  // namespace
+
+ClassFileBuilder::ClassFileBuilder(std::string class_name) : class_name_(std::move(class_name)) {
+  this_class_index_ = AddClass(class_name_);
+  super_class_index_ = AddClass("java/lang/Object");
+}
+
+uint16_t ClassFileBuilder::AddConstant(std::string entry) {
+  auto iter = constant_indices_.find(entry);
+  if (iter != constant_indices_.end()) {
+    return iter->second;
+  }
+
+  // Index 0 is not a valid constant, so at most kMaxU2 - 1 entries fit.
+  if (constant_count_ + 1 >= kMaxU2) {
+    constants_overflowed_ = true;
+    return 0;
+  }
+  const uint16_t index = static_cast<uint16_t>(++constant_count_);
+  constant_pool_.append(entry);
+  constant_indices_.emplace(std::move(entry), index);
+  return index;
+}
+
+uint16_t ClassFileBuilder::AddUtf8(StringPiece value) {
+  const std::string bytes = ToModifiedUtf8(value);
+  if (bytes.size() > kMaxU2) {
+    constants_overflowed_ = true;
+    return 0;
+  }
+  std::string entry;
+  WriteU1(&entry, kConstantUtf8);
+  WriteU2(&entry, static_cast<uint16_t>(bytes.size()));
+  entry.append(bytes);
+  return AddConstant(std::move(entry));
+}
+
+uint16_t ClassFileBuilder::AddClass(StringPiece class_name) {
+  std::string entry;
+  WriteU1(&entry, kConstantClass);
+  WriteU2(&entry, AddUtf8(class_name));
+  return AddConstant(std::move(entry));
+}
+
+uint16_t ClassFileBuilder::AddNameAndType(StringPiece name, StringPiece descriptor) {
+  std::string entry;
+  WriteU1(&entry, kConstantNameAndType);
+  WriteU2(&entry, AddUtf8(name));
+  WriteU2(&entry, AddUtf8(descriptor));
+  return AddConstant(std::move(entry));
+}
+
+uint16_t ClassFileBuilder::AddMemberRef(uint8_t tag, StringPiece class_name, StringPiece name,
+                                        StringPiece descriptor) {
+  std::string entry;
+  WriteU1(&entry, tag);
+  WriteU2(&entry, AddClass(class_name));
+  WriteU2(&entry, AddNameAndType(name, descriptor));
+  return AddConstant(std::move(entry));
+}
+
+uint16_t ClassFileBuilder::AddInteger(int32_t value) {
+  std::string entry;
+  WriteU1(&entry, kConstantInteger);
+  WriteU4(&entry, static_cast<uint32_t>(value));
+  return AddConstant(std::move(entry));
+}
+
+void ClassFileBuilder::EmitPushInt(int32_t value) {
+  if (value >= -1 && value <= 5) {
+    WriteU1(&clinit_code_, static_cast<uint8_t>(kOpIconst0 + value));
+  } else if (value >= INT8_MIN && value <= INT8_MAX) {
+    WriteU1(&clinit_code_, kOpBipush);
+    WriteU1(&clinit_code_, static_cast<uint8_t>(value));
+  } else if (value >= INT16_MIN && value <= INT16_MAX) {
+    WriteU1(&clinit_code_, kOpSipush);
+    WriteU2(&clinit_code_, static_cast<uint16_t>(value));
+  } else {
+    EmitConstantLoad(AddInteger(value));
+  }
+}
+
+void ClassFileBuilder::EmitConstantLoad(uint16_t index) {
+  if (index <= 0xff) {
+    WriteU1(&clinit_code_, kOpLdc);
+    WriteU1(&clinit_code_, static_cast<uint8_t>(index));
+  } else {
+    WriteU1(&clinit_code_, kOpLdcW);
+    WriteU2(&clinit_code_, index);
+  }
+}
+
+void ClassFileBuilder::EmitFieldAccess(uint8_t opcode, StringPiece class_name, StringPiece name,
+                                       StringPiece descriptor) {
+  WriteU1(&clinit_code_, opcode);
+  WriteU2(&clinit_code_, AddMemberRef(kConstantFieldref, class_name, name, descriptor));
+}
+
+void ClassFileBuilder::AddInnerClass(const std::string& inner_class_name,
+                                     const std::string& outer_class_name, StringPiece simple_name,
+                                     bool is_static) {
+  inner_classes_.push_back(InnerClass{
+      AddClass(inner_class_name), AddClass(outer_class_name), AddUtf8(simple_name),
+      static_cast<uint16_t>(kAccPublic | kAccFinal | (is_static ? kAccStatic : 0))});
+}
+
+void ClassFileBuilder::AddIntField(StringPiece name, int32_t value, bool final,
+                                   bool inline_constant) {
+  Field field{static_cast<uint16_t>(kAccPublic | kAccStatic | (final ? kAccFinal : 0)),
+              AddUtf8(name), AddUtf8("I"), 0};
+  if (final && inline_constant) {
+    field.constant_index = AddInteger(value);
+  } else {
+    EmitPushInt(value);
+    EmitFieldAccess(kOpPutstatic, class_name_, name, "I");
+    clinit_max_stack_ = std::max<uint16_t>(clinit_max_stack_, 1);
+  }
+  fields_.push_back(field);
+}
+
+void ClassFileBuilder::AddStringField(StringPiece name, StringPiece value, bool final) {
+  std::string entry;
+  WriteU1(&entry, kConstantString);
+  WriteU2(&entry, AddUtf8(value));
+  const uint16_t string_index = AddConstant(std::move(entry));
+
+  Field field{static_cast<uint16_t>(kAccPublic | kAccStatic | (final ? kAccFinal : 0)),
+              AddUtf8(name), AddUtf8("Ljava/lang/String;"), 0};
+  if (final) {
+    field.constant_index = string_index;
+  } else {
+    EmitConstantLoad(string_index);
+    EmitFieldAccess(kOpPutstatic, class_name_, name, "Ljava/lang/String;");
+    clinit_max_stack_ = std::max<uint16_t>(clinit_max_stack_, 1);
+  }
+  fields_.push_back(field);
+}
+
+void ClassFileBuilder::AddIntArrayField(StringPiece name,
+                                        const std::vector<ArrayElement>& elements) {
+  fields_.push_back(Field{kAccPublic | kAccStatic | kAccFinal, AddUtf8(name), AddUtf8("[I"), 0});
+
+  // array = new int[size]; then for each element: array[i] = value;
+  EmitPushInt(static_cast<int32_t>(elements.size()));
+  WriteU1(&clinit_code_, kOpNewarray);
+  WriteU1(&clinit_code_, kArrayTypeInt);
+  for (size_t i = 0; i < elements.size(); i++) {
+    WriteU1(&clinit_code_, kOpDup);
+    EmitPushInt(static_cast<int32_t>(i));
+    if (const int32_t* value = std::get_if<int32_t>(&elements[i])) {
+      EmitPushInt(*value);
+    } else {
+      const FieldRef& ref = std::get<FieldRef>(elements[i]);
+      EmitFieldAccess(kOpGetstatic, ref.class_name, ref.field_name, "I");
+    }
+    WriteU1(&clinit_code_, kOpIastore);
+  }
+  EmitFieldAccess(kOpPutstatic, class_name_, name, "[I");
+
+  // The array, its copy, the index and the value.
+  clinit_max_stack_ = std::max<uint16_t>(clinit_max_stack_, 4);
+}
+
+bool ClassFileBuilder::Build(ClassFile* out_class, std::string* out_error) {
+  // Everything the methods and attributes refer to must be in the pool before it is written.
+  const uint16_t code_name = AddUtf8("Code");
+  const uint16_t constant_value_name = AddUtf8("ConstantValue");
+  const uint16_t inner_classes_name = inner_classes_.empty() ? 0 : AddUtf8("InnerClasses");
+  const uint16_t init_name = AddUtf8("<init>");
+  const uint16_t void_descriptor = AddUtf8("()V");
+  const uint16_t object_init =
+      AddMemberRef(kConstantMethodref, "java/lang/Object", "<init>", "()V");
+  const uint16_t clinit_name = clinit_code_.empty() ? 0 : AddUtf8("<clinit>");
+
+  if (constants_overflowed_) {
+    *out_error = StringPrintf("too many constants in class %s", class_name_.c_str());
+    return false;
+  }
+  if (fields_.size() > kMaxU2) {
+    *out_error = StringPrintf("too many fields in class %s", class_name_.c_str());
+    return false;
+  }
+
+  std::string clinit_code = clinit_code_;
+  if (!clinit_code.empty()) {
+    WriteU1(&clinit_code, kOpReturn);
+    if (clinit_code.size() > kMaxU2) {
+      *out_error = StringPrintf("static initializer of class %s is too large (%zu bytes)",
+                                class_name_.c_str(), clinit_code.size());
+      return false;
+    }
+  }
+
+  std::string& out = out_class->data;
+  out.clear();
+  WriteU4(&out, kMagic);
+  WriteU2(&out, 0);
+  WriteU2(&out, kMajorVersion);
+  WriteU2(&out, static_cast<uint16_t>(constant_count_ + 1));
+  out.append(constant_pool_);
+  WriteU2(&out, kAccPublic | kAccFinal | kAccSuper);
+  WriteU2(&out, this_class_index_);
+  WriteU2(&out, super_class_index_);
+  WriteU2(&out, 0);  // interfaces_count
+
+  WriteU2(&out, static_cast<uint16_t>(fields_.size()));
+  for (const Field& field : fields_) {
+    WriteU2(&out, field.access_flags);
+    WriteU2(&out, field.name_index);
+    WriteU2(&out, field.descriptor_index);
+    if (field.constant_index != 0) {
+      WriteU2(&out, 1);
+      WriteU2(&out, constant_value_name);
+      WriteU4(&out, 2);
+      WriteU2(&out, field.constant_index);
+    } else {
+      WriteU2(&out, 0);
+    }
+  }
+
+  auto write_method = [&](uint16_t access_flags, uint16_t name_index, uint16_t max_stack,
+                          uint16_t max_locals, const std::string& code) {
+    WriteU2(&out, access_flags);
+    WriteU2(&out, name_index);
+    WriteU2(&out, void_descriptor);
+    WriteU2(&out, 1);  // attributes_count
+    WriteU2(&out, code_name);
+    WriteU4(&out, static_cast<uint32_t>(12 + code.size()));
+    WriteU2(&out, max_stack);
+    WriteU2(&out, max_locals);
+    WriteU4(&out, static_cast<uint32_t>(code.size()));
+    out.append(code);
+    WriteU2(&out, 0);  // exception_table_length
+    WriteU2(&out, 0);  // attributes_count
+  };
+
+  // The implicit constructor javac would generate: super();
+  std::string init_code;
+  WriteU1(&init_code, kOpAload0);
+  WriteU1(&init_code, kOpInvokespecial);
+  WriteU2(&init_code, object_init);
+  WriteU1(&init_code, kOpReturn);
+
+  WriteU2(&out, clinit_code.empty() ? 1 : 2);
+  write_method(kAccPublic, init_name, 1, 1, init_code);
+  if (!clinit_code.empty()) {
+    write_method(kAccStatic, clinit_name, clinit_max_stack_, 0, clinit_code);
+  }
+
+  if (inner_classes_.empty()) {
+    WriteU2(&out, 0);
+  } else {
+    WriteU2(&out, 1);
+    WriteU2(&out, inner_classes_name);
+    WriteU4(&out, static_cast<uint32_t>(2 + 8 * inner_classes_.size()));
+    WriteU2(&out, static_cast<uint16_t>(inner_classes_.size()));
+    for (const InnerClass& inner_class : inner_classes_) {
+      WriteU2(&out, inner_class.inner_class_index);
+      WriteU2(&out, inner_class.outer_class_index);
+      WriteU2(&out, inner_class.name_index);
+      WriteU2(&out, inner_class.access_flags);
+    }
+  }
+
+  out_class->path = class_name_ + ".class";
+  return true;
+}
+
+}  // namespace aapt
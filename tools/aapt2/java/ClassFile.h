@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef AAPT_JAVA_CLASSFILE_H
+#define AAPT_JAVA_CLASSFILE_H
+
+#include <map>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "android-base/macros.h"
+#include "androidfw/StringPiece.h"
+
+namespace aapt {
+
+// A compiled JVM class.
+struct ClassFile {
+  // Path of the class within a jar, such as "com/example/R$string.class".
+  std::string path;
+  std::string data;
+};
+
+// Assembles the class file of a class that only holds static fields, such as an R class, without
+// going through Java source and javac. Field initializers that are not compile-time constants are
+// emitted in a static initializer, with small integers pushed inline and every other constant
+// stored once in the constant pool.
+class ClassFileBuilder {
+ public:
+  // A static int field of another class, e.g. `com/example/R$attr.foo`, read when initializing.
+  struct FieldRef {
+    std::string class_name;
+    std::string field_name;
+  };
+
+  using ArrayElement = std::variant<int32_t, FieldRef>;
+
+  // `class_name` is the binary name of the class, with '/' separating packages, e.g.
+  // "com/example/R$string".
+  explicit ClassFileBuilder(std::string class_name);
+
+  const std::string& GetClassName() const {
+    return class_name_;
+  }
+
+  // Records that `inner_class_name` is the nested class `simple_name` of `outer_class_name`. Both
+  // the outer and the nested class files must record it.
+  void AddInnerClass(const std::string& inner_class_name, const std::string& outer_class_name,
+                     android::StringPiece simple_name, bool is_static);
+
+  // Adds `public static [final] int name = value;`. A final field is a compile-time constant
+  // unless `inline_constant` is false, in which case it is assigned in the static initializer.
+  void AddIntField(android::StringPiece name, int32_t value, bool final, bool inline_constant);
+
+  // Adds `public static [final] String name = value;`.
+  void AddStringField(android::StringPiece name, android::StringPiece value, bool final);
+
+  // Adds `public static final int[] name = {elements...};`.
+  void AddIntArrayField(android::StringPiece name, const std::vector<ArrayElement>& elements);
+
+  // Serializes the class file. Fails if the class exceeds a limit of the class file format, such
+  // as 64KiB of static initializer code.
+  bool Build(ClassFile* out_class, std::string* out_error);
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ClassFileBuilder);
+
+  struct Field {
+    uint16_t access_flags;
+    uint16_t name_index;
+    uint16_t descriptor_index;
+    // Index of the ConstantValue attribute value, or 0 if there is none.
+    uint16_t constant_index;
+  };
+
+  struct InnerClass {
+    uint16_t inner_class_index;
+    uint16_t outer_class_index;
+    uint16_t name_index;
+    uint16_t access_flags;
+  };
+
+  uint16_t AddConstant(std::string entry);
+  uint16_t AddUtf8(android::StringPiece value);
+  uint16_t AddClass(android::StringPiece class_name);
+  uint16_t AddNameAndType(android::StringPiece name, android::StringPiece descriptor);
+  uint16_t AddMemberRef(uint8_t tag, android::StringPiece class_name, android::StringPiece name,
+                        android::StringPiece descriptor);
+  uint16_t AddInteger(int32_t value);
+
+  void EmitPushInt(int32_t value);
+  void EmitConstantLoad(uint16_t index);
+  void EmitFieldAccess(uint8_t opcode, android::StringPiece class_name, android::StringPiece name,
+                       android::StringPiece descriptor);
+
+  std::string class_name_;
+  uint16_t this_class_index_;
+  uint16_t super_class_index_;
+
+  // Serialized constant pool entries and the index of each, as entries are shared.
+  std::string constant_pool_;
+  std::map<std::string, uint16_t> constant_indices_;
+  size_t constant_count_ = 0;
+  // Set when a constant did not fit, the constant pool or one of its strings being too large.
+  bool constants_overflowed_ = false;
+
+  std::vector<Field> fields_;
+  std::vector<InnerClass> inner_classes_;
+
+  // Bytecode of the static initializer, without the final return.
+  std::string clinit_code_;
+  uint16_t clinit_max_stack_ = 0;
+};
+
+}  // namespace aapt
+
+#endif  // AAPT_JAVA_CLASSFILE_H
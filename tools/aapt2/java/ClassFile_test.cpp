@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "java/ClassFile.h"
+
+#include "test/Test.h"
+
+using ::testing::Eq;
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+namespace aapt {
+
+static uint16_t ReadU2(const std::string& data, size_t offset) {
+  return static_cast<uint16_t>((static_cast<uint8_t>(data[offset]) << 8) |
+                               static_cast<uint8_t>(data[offset + 1]));
+}
+
+TEST(ClassFileBuilderTest, WritesHeaderAndPath) {
+  ClassFileBuilder builder("com/example/R$string");
+  builder.AddIntField("foo", 0x7f010000, true /*final*/, true /*inline_constant*/);
+
+  ClassFile class_file;
+  std::string error;
+  ASSERT_TRUE(builder.Build(&class_file, &error));
+
+  EXPECT_THAT(class_file.path, Eq("com/example/R$string.class"));
+  EXPECT_THAT(class_file.data.substr(0, 4), Eq("\xca\xfe\xba\xbe"));
+  EXPECT_THAT(ReadU2(class_file.data, 6), Eq(52));
+  EXPECT_THAT(class_file.data, HasSubstr("ConstantValue"));
+  // Every field is a compile-time constant, so there is no static initializer.
+  EXPECT_THAT(class_file.data, Not(HasSubstr("<clinit>")));
+}
+
+TEST(ClassFileBuilderTest, NonFinalFieldsAreAssignedInStaticInitializer) {
+  ClassFileBuilder builder("com/example/R$string");
+  builder.AddIntField("foo", 0x7f010000, false /*final*/, true /*inline_constant*/);
+  builder.AddIntArrayField("bar", {1, 0x7f010000, ClassFileBuilder::FieldRef{"lib/R$attr", "baz"}});
+
+  ClassFile class_file;
+  std::string error;
+  ASSERT_TRUE(builder.Build(&class_file, &error));
+  EXPECT_THAT(class_file.data, HasSubstr("<clinit>"));
+  EXPECT_THAT(class_file.data, HasSubstr("lib/R$attr"));
+}
+
+TEST(ClassFileBuilderTest, SharesConstants) {
+  ClassFileBuilder one_field("R");
+  one_field.AddIntField("foo", 0x7f010000, false /*final*/, true /*inline_constant*/);
+  ClassFileBuilder two_fields("R");
+  two_fields.AddIntField("foo", 0x7f010000, false /*final*/, true /*inline_constant*/);
+  two_fields.AddIntField("bar", 0x7f010000, false /*final*/, true /*inline_constant*/);
+
+  ClassFile one_field_class;
+  ClassFile two_fields_class;
+  std::string error;
+  ASSERT_TRUE(one_field.Build(&one_field_class, &error));
+  ASSERT_TRUE(two_fields.Build(&two_fields_class, &error));
+
+  // The second field only adds its name and field reference to the constant pool.
+  EXPECT_THAT(ReadU2(two_fields_class.data, 8), Eq(ReadU2(one_field_class.data, 8) + 3));
+}
+
+TEST(ClassFileBuilderTest, FailsWhenStaticInitializerIsTooLarge) {
+  std::vector<ClassFileBuilder::ArrayElement> elements(20000, 0x7f010000);
+  ClassFileBuilder builder("R$styleable");
+  builder.AddIntArrayField("foo", elements);
+
+  ClassFile class_file;
+  std::string error;
+  EXPECT_FALSE(builder.Build(&class_file, &error));
+  EXPECT_THAT(error, HasSubstr("too large"));
+}
+
+}  // namespace aapt
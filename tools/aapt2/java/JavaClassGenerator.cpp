@@ -597,14 +597,46 @@ bool JavaClassGenerator::Generate(StringPiece package_name_to_generate,
                                   StringPiece out_package_name, OutputStream* out,
                                   OutputStream* out_r_txt) {
   ClassDefinition r_class("R", ClassQualifier::kNone, true);
-  std::unique_ptr<MethodDefinition> rewrite_method;
 
   std::unique_ptr<Printer> r_txt_printer;
   if (out_r_txt != nullptr) {
     r_txt_printer = util::make_unique<Printer>(out_r_txt);
   }
+
+  if (!BuildRClass(package_name_to_generate, out != nullptr ? &r_class : nullptr,
+                   r_txt_printer.get())) {
+    return false;
+  }
+
+  if (out != nullptr) {
+    const bool is_public = (options_.types == JavaClassGeneratorOptions::SymbolTypes::kPublic);
+    ClassDefinition::WriteJavaFile(&r_class, out_package_name, options_.use_final, !is_public, out);
+  }
+  return true;
+}
+
+bool JavaClassGenerator::GenerateClassFiles(StringPiece package_name_to_generate,
+                                            StringPiece out_package_name,
+                                            std::vector<ClassFile>* out_classes) {
+  if (options_.rewrite_callback_options) {
+    error_ = "the onResourcesLoaded() callback of shared libraries can only be generated as Java";
+    return false;
+  }
+
+  ClassDefinition r_class("R", ClassQualifier::kNone, true);
+  if (!BuildRClass(package_name_to_generate, &r_class, nullptr)) {
+    return false;
+  }
+  return ClassDefinition::WriteClassFiles(&r_class, out_package_name, options_.use_final,
+                                          out_classes, &error_);
+}
+
+bool JavaClassGenerator::BuildRClass(StringPiece package_name_to_generate,
+                                     ClassDefinition* out_r_class, Printer* r_txt_printer) {
+  std::unique_ptr<MethodDefinition> rewrite_method;
+
   // Generate an onResourcesLoaded() callback if requested.
-  if (out != nullptr && options_.rewrite_callback_options) {
+  if (out_r_class != nullptr && options_.rewrite_callback_options) {
     rewrite_method =
         util::make_unique<MethodDefinition>("public static void onResourcesLoaded(int p)");
     for (const std::string& package_to_callback :
@@ -630,13 +662,13 @@ bool JavaClassGenerator::Generate(StringPiece package_name_to_generate,
       const bool force_creation_if_empty = is_public;
 
       std::unique_ptr<ClassDefinition> class_def;
-      if (out != nullptr) {
+      if (out_r_class != nullptr) {
         class_def = util::make_unique<ClassDefinition>(
             to_string(type->named_type.type), ClassQualifier::kStatic, force_creation_if_empty);
       }
 
       if (!ProcessType(package_name_to_generate, *package, *type, class_def.get(),
-                       rewrite_method.get(), r_txt_printer.get())) {
+                       rewrite_method.get(), r_txt_printer)) {
         return false;
       }
 
@@ -645,32 +677,32 @@ bool JavaClassGenerator::Generate(StringPiece package_name_to_generate,
         if (const ResourceTableType* priv_type =
                 package->FindTypeWithDefaultName(ResourceType::kAttrPrivate)) {
           if (!ProcessType(package_name_to_generate, *package, *priv_type, class_def.get(),
-                           rewrite_method.get(), r_txt_printer.get())) {
+                           rewrite_method.get(), r_txt_printer)) {
             return false;
           }
         }
       }
 
-      if (out != nullptr && type->named_type.type == ResourceType::kStyleable && is_public) {
+      if (out_r_class != nullptr && type->named_type.type == ResourceType::kStyleable &&
+          is_public) {
         // When generating a public R class, we don't want Styleable to be part
         // of the API. It is only emitted for documentation purposes.
         class_def->GetCommentBuilder()->AppendComment("@doconly");
       }
 
-      if (out != nullptr) {
+      if (out_r_class != nullptr) {
         AppendJavaDocAnnotations(options_.javadoc_annotations, class_def->GetCommentBuilder());
-        r_class.AddMember(std::move(class_def));
+        out_r_class->AddMember(std::move(class_def));
       }
     }
   }
 
   if (rewrite_method != nullptr) {
-    r_class.AddMember(std::move(rewrite_method));
+    out_r_class->AddMember(std::move(rewrite_method));
   }
 
-  if (out != nullptr) {
-    AppendJavaDocAnnotations(options_.javadoc_annotations, r_class.GetCommentBuilder());
-    ClassDefinition::WriteJavaFile(&r_class, out_package_name, options_.use_final, !is_public, out);
+  if (out_r_class != nullptr) {
+    AppendJavaDocAnnotations(options_.javadoc_annotations, out_r_class->GetCommentBuilder());
   }
   return true;
 }
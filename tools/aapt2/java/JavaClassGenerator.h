@@ -18,11 +18,13 @@
 #define AAPT_JAVA_CLASS_GENERATOR_H
 
 #include <string>
+#include <vector>
 
 #include "ResourceTable.h"
 #include "ResourceValues.h"
 #include "androidfw/Streams.h"
 #include "androidfw/StringPiece.h"
+#include "java/ClassFile.h"
 #include "process/IResourceTableConsumer.h"
 #include "process/SymbolTable.h"
 #include "text/Printer.h"
@@ -76,11 +78,23 @@ class JavaClassGenerator {
                 android::StringPiece output_package_name, android::OutputStream* out,
                 android::OutputStream* out_r_txt = nullptr);
 
+  // Compiles the R class straight to class files instead of Java source, see Generate(). May be
+  // called from several threads at once, as long as the table is not modified meanwhile. The
+  // onResourcesLoaded() callback of shared libraries is not supported.
+  bool GenerateClassFiles(android::StringPiece package_name_to_generate,
+                          android::StringPiece output_package_name,
+                          std::vector<ClassFile>* out_classes);
+
   const std::string& GetError() const;
 
   static std::string TransformToFieldName(android::StringPiece symbol);
 
  private:
+  // Adds the classes of every resource type to `out_r_class`, and their symbols to
+  // `r_txt_printer`. Either can be nullptr.
+  bool BuildRClass(android::StringPiece package_name_to_generate, ClassDefinition* out_r_class,
+                   text::Printer* r_txt_printer);
+
   bool SkipSymbol(Visibility::Level state);
   bool SkipSymbol(const std::optional<SymbolTable::Symbol>& symbol);
 
@@ -24,10 +24,12 @@
 
 using ::aapt::io::StringOutputStream;
 using ::android::StringPiece;
+using ::testing::Eq;
 using ::testing::HasSubstr;
 using ::testing::Lt;
 using ::testing::Ne;
 using ::testing::Not;
+using ::testing::UnorderedElementsAre;
 
 namespace aapt {
 
@@ -642,4 +644,54 @@ TEST(JavaClassGeneratorTest, SkipMacros) {
   EXPECT_THAT(output, Not(HasSubstr("bar")));
 }
 
+TEST(JavaClassGeneratorTest, GenerateClassFiles) {
+  std::unique_ptr<ResourceTable> table =
+      test::ResourceTableBuilder()
+          .AddSimple("android:id/foo", ResourceId(0x01020000))
+          .AddValue("android:attr/bar", ResourceId(0x01010000), test::AttributeBuilder().Build())
+          .AddValue("android:styleable/Baz", ResourceId(0x01030000),
+                    test::StyleableBuilder()
+                        .AddItem("android:attr/bar", ResourceId(0x01010000))
+                        .Build())
+          .Build();
+
+  std::unique_ptr<IAaptContext> context =
+      test::ContextBuilder()
+          .AddSymbolSource(util::make_unique<ResourceTableSymbolSource>(table.get()))
+          .SetNameManglerPolicy(NameManglerPolicy{"android"})
+          .Build();
+  JavaClassGenerator generator(context.get(), table.get(), {});
+
+  std::vector<ClassFile> classes;
+  ASSERT_TRUE(generator.GenerateClassFiles("android", "com.example", &classes));
+
+  std::vector<std::string> paths;
+  for (const ClassFile& class_file : classes) {
+    paths.push_back(class_file.path);
+    EXPECT_THAT(class_file.data.substr(0, 4), Eq("\xca\xfe\xba\xbe"));
+  }
+  EXPECT_THAT(paths, UnorderedElementsAre("com/example/R.class", "com/example/R$attr.class",
+                                          "com/example/R$id.class",
+                                          "com/example/R$styleable.class"));
+}
+
+TEST(JavaClassGeneratorTest, GenerateClassFilesFailsForOnResourcesLoadedCallback) {
+  std::unique_ptr<ResourceTable> table =
+      test::ResourceTableBuilder()
+          .AddValue("android:id/foo", ResourceId(0x00020000), util::make_unique<Id>())
+          .Build();
+
+  std::unique_ptr<IAaptContext> context =
+      test::ContextBuilder().SetPackageId(0x00).SetCompilationPackage("android").Build();
+
+  JavaClassGeneratorOptions options;
+  options.use_final = false;
+  options.rewrite_callback_options = OnResourcesLoadedCallbackOptions{};
+  JavaClassGenerator generator(context.get(), table.get(), options);
+
+  std::vector<ClassFile> classes;
+  EXPECT_FALSE(generator.GenerateClassFiles("android", "android", &classes));
+  EXPECT_THAT(generator.GetError(), HasSubstr("onResourcesLoaded"));
+}
+
 }  // namespace aapt
@@ -20,6 +20,7 @@
 
 #include "androidfw/IDiagnostics.h"
 #include "androidfw/Source.h"
+#include "trace/TraceBuffer.h"
 #include "util/Util.h"
 #include "xml/XmlDom.h"
 #include "xml/XmlUtil.h"
@@ -33,9 +34,9 @@ namespace aapt {
 class FlagsVisitor : public xml::Visitor {
  public:
   explicit FlagsVisitor(android::IDiagnostics* diagnostics,
-                        const FeatureFlagValues& feature_flag_values,
+                        const FeatureFlagsFilter::FlagIndex& flag_index,
                         const FeatureFlagsFilterOptions& options)
-      : diagnostics_(diagnostics), feature_flag_values_(feature_flag_values), options_(options) {
+      : diagnostics_(diagnostics), flag_index_(flag_index), options_(options) {
   }
 
   void Visit(xml::Element* node) override {
@@ -63,9 +64,10 @@ class FlagsVisitor : public xml::Visitor {
         flag_name = flag_name.substr(1);
       }
 
-      if (auto it = feature_flag_values_.find(flag_name); it != feature_flag_values_.end()) {
-        if (it->second.enabled.has_value()) {
-          if (options_.flags_must_be_readonly && !it->second.read_only) {
+      if (auto it = flag_index_.find(flag_name); it != flag_index_.end()) {
+        const FeatureFlagProperties& properties = *it->second;
+        if (properties.enabled.has_value()) {
+          if (options_.flags_must_be_readonly && !properties.read_only) {
             diagnostics_->Error(android::DiagMessage(node->line_number)
                                 << "attribute 'android:featureFlag' has flag '" << flag_name
                                 << "' which must be readonly but is not");
@@ -74,7 +76,7 @@ class FlagsVisitor : public xml::Visitor {
           }
           if (options_.remove_disabled_elements) {
             // Remove if flag==true && attr=="!flag" (negated) OR flag==false && attr=="flag"
-            return *it->second.enabled == negated;
+            return *properties.enabled == negated;
           }
         } else if (options_.flags_must_have_value) {
           diagnostics_->Error(android::DiagMessage(node->line_number)
@@ -96,13 +98,23 @@ class FlagsVisitor : public xml::Visitor {
   }
 
   android::IDiagnostics* diagnostics_;
-  const FeatureFlagValues& feature_flag_values_;
+  const FeatureFlagsFilter::FlagIndex& flag_index_;
   const FeatureFlagsFilterOptions& options_;
   bool has_error_ = false;
 };
 
+FeatureFlagsFilter::FeatureFlagsFilter(FeatureFlagValues feature_flag_values,
+                                       FeatureFlagsFilterOptions options)
+    : feature_flag_values_(std::move(feature_flag_values)), options_(options) {
+  flag_index_.reserve(feature_flag_values_.size());
+  for (const auto& [name, properties] : feature_flag_values_) {
+    flag_index_.emplace(name, &properties);
+  }
+}
+
 bool FeatureFlagsFilter::Consume(IAaptContext* context, xml::XmlResource* doc) {
-  FlagsVisitor visitor(context->GetDiagnostics(), feature_flag_values_, options_);
+  TRACE_CALL();
+  FlagsVisitor visitor(context->GetDiagnostics(), flag_index_, options_);
   doc->root->Accept(&visitor);
   return !visitor.HasError();
 }
@@ -18,6 +18,7 @@
 
 #include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 
@@ -64,20 +65,26 @@ struct FeatureFlagsFilterOptions {
 // The `Consume()` function will return false if there is an invalid flag found (see
 // FeatureFlagsFilterOptions for customizing the filter's validation behavior). Do not use the XML
 // further if there are errors as there may be elements removed already.
+//
+// The flag values are indexed once on construction, so a single filter should be reused for all
+// the documents that are filtered with the same flags. Consume() may be called from several
+// threads at once.
 class FeatureFlagsFilter : public IXmlResourceConsumer {
  public:
   explicit FeatureFlagsFilter(FeatureFlagValues feature_flag_values,
-                              FeatureFlagsFilterOptions options)
-      : feature_flag_values_(std::move(feature_flag_values)), options_(options) {
-  }
+                              FeatureFlagsFilterOptions options);
 
   bool Consume(IAaptContext* context, xml::XmlResource* doc) override;
 
+  // Flag name to its properties, with keys pointing into `feature_flag_values_`.
+  using FlagIndex = std::unordered_map<std::string_view, const FeatureFlagProperties*>;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(FeatureFlagsFilter);
 
   const FeatureFlagValues feature_flag_values_;
   const FeatureFlagsFilterOptions options_;
+  FlagIndex flag_index_;
 };
 
 }  // namespace aapt
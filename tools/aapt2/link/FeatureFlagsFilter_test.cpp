@@ -236,4 +236,21 @@ TEST(FeatureFlagsFilterTest, OptionFailOnUnrecognizedFlagsIsFalse) {
   ASSERT_THAT(maybe_removed, NotNull());
 }
 
+TEST(FeatureFlagsFilterTest, FilterIsReusedAcrossDocuments) {
+  FeatureFlagsFilter filter({{"enabled", FeatureFlagProperties{true, true}},
+                             {"disabled", FeatureFlagProperties{true, false}}},
+                            {});
+  std::unique_ptr<IAaptContext> context = test::ContextBuilder().Build();
+
+  for (std::string_view flag : {"enabled", "disabled", "!enabled", "!disabled"}) {
+    std::unique_ptr<xml::XmlResource> doc = test::BuildXmlDom(
+        "<manifest xmlns:android=\"http://schemas.android.com/apk/res/android\">"
+        "<permission android:name=\"FOO\" android:featureFlag=\"" + std::string(flag) +
+        "\" /></manifest>");
+    ASSERT_TRUE(filter.Consume(context.get(), doc.get()));
+    bool kept = doc->root->FindChild({}, "permission") != nullptr;
+    EXPECT_EQ(kept, flag == "enabled" || flag == "!disabled") << flag;
+  }
+}
+
 }  // namespace aapt
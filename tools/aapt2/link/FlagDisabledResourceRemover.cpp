@@ -19,12 +19,14 @@
 #include <algorithm>
 
 #include "ResourceTable.h"
+#include "trace/TraceBuffer.h"
 
 using android::ConfigDescription;
 
 namespace aapt {
 
-static bool KeepResourceEntry(const std::unique_ptr<ResourceEntry>& entry) {
+static bool KeepResourceEntry(const std::unique_ptr<ResourceEntry>& entry,
+                              ValueVisitor* removed_value_visitor) {
   if (entry->values.empty()) {
     return true;
   }
@@ -37,6 +39,11 @@ static bool KeepResourceEntry(const std::unique_ptr<ResourceEntry>& entry) {
 
   bool keep = remove_iter != entry->values.begin();
 
+  if (removed_value_visitor != nullptr) {
+    for (auto iter = remove_iter; iter != end_iter; ++iter) {
+      (*iter)->value->Accept(removed_value_visitor);
+    }
+  }
   entry->values.erase(remove_iter, end_iter);
 
   for (auto& value : entry->values) {
@@ -47,12 +54,14 @@ static bool KeepResourceEntry(const std::unique_ptr<ResourceEntry>& entry) {
 }
 
 bool FlagDisabledResourceRemover::Consume(IAaptContext* context, ResourceTable* table) {
+  TRACE_CALL();
   for (auto& pkg : table->packages) {
     for (auto& type : pkg->types) {
       const auto end_iter = type->entries.end();
       const auto remove_iter = std::stable_partition(
-          type->entries.begin(), end_iter, [](const std::unique_ptr<ResourceEntry>& entry) -> bool {
-            return KeepResourceEntry(entry);
+          type->entries.begin(), end_iter,
+          [this](const std::unique_ptr<ResourceEntry>& entry) -> bool {
+            return KeepResourceEntry(entry, removed_value_visitor_);
           });
 
       type->entries.erase(remove_iter, end_iter);
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "ValueVisitor.h"
 #include "android-base/macros.h"
 #include "process/IResourceTableConsumer.h"
 
@@ -26,10 +27,18 @@ class FlagDisabledResourceRemover : public IResourceTableConsumer {
  public:
   FlagDisabledResourceRemover() = default;
 
+  // Lets `removed_value_visitor` visit every value behind a disabled flag just before it is
+  // removed, in the same pass over the table.
+  explicit FlagDisabledResourceRemover(ValueVisitor* removed_value_visitor)
+      : removed_value_visitor_(removed_value_visitor) {
+  }
+
   bool Consume(IAaptContext* context, ResourceTable* table) override;
 
  private:
   DISALLOW_COPY_AND_ASSIGN(FlagDisabledResourceRemover);
+
+  ValueVisitor* removed_value_visitor_ = nullptr;
 };
 
 }  // namespace aapt
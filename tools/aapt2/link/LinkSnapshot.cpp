@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "link/LinkSnapshot.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+
+#include "android-base/file.h"
+#include "util/Files.h"
+#include "util/Sha256.h"
+#include "util/Util.h"
+
+using ::android::StringPiece;
+
+namespace aapt {
+
+namespace {
+
+// Bump when the snapshot records change in an incompatible way.
+constexpr char kSnapshotFormatVersion[] = "1";
+
+// Recorded in place of a digest for paths that do not exist.
+constexpr char kMissingDigest[] = "-";
+
+constexpr char kInputsRecord[] = "inputs";
+constexpr char kOutputsRecord[] = "outputs";
+constexpr char kIdsRecord[] = "ids";
+
+// Parses a record written by WriteRecord() into its header line and its (digest, path) lines.
+bool ReadRecord(const std::string& path, std::string* out_header,
+                std::vector<std::pair<std::string, std::string>>* out_lines) {
+  std::string contents;
+  if (!android::base::ReadFileToString(path, &contents)) {
+    return false;
+  }
+
+  bool first = true;
+  for (StringPiece line : util::Tokenize(contents, '\n')) {
+    if (first) {
+      *out_header = std::string(line);
+      first = false;
+      continue;
+    }
+    if (line.empty()) {
+      continue;
+    }
+    const size_t separator = line.find(' ');
+    if (separator == StringPiece::npos) {
+      return false;
+    }
+    out_lines->emplace_back(std::string(line.substr(0, separator)),
+                            std::string(line.substr(separator + 1)));
+  }
+  return !first;
+}
+
+bool WriteRecord(const std::string& path, const std::string& header,
+                 const std::vector<std::pair<std::string, std::string>>& lines) {
+  std::string contents = header + "\n";
+  for (const auto& [digest, line_path] : lines) {
+    contents += digest + " " + line_path + "\n";
+  }
+
+  // Written to a temporary file first, so that a record is never read half written.
+  const std::string temp_path = path + ".tmp";
+  if (!android::base::WriteStringToFile(contents, temp_path)) {
+    return false;
+  }
+  return rename(temp_path.c_str(), path.c_str()) == 0;
+}
+
+}  // namespace
+
+std::unique_ptr<LinkSnapshot> LinkSnapshot::Open(const std::string& dir,
+                                                 android::IDiagnostics* diag) {
+  if (file::GetFileType(dir) != file::FileType::kDirectory && !file::mkdirs(dir)) {
+    diag->Error(android::DiagMessage(dir) << "failed to create incremental link directory: "
+                                          << strerror(errno));
+    return {};
+  }
+  return std::unique_ptr<LinkSnapshot>(new LinkSnapshot(dir, diag));
+}
+
+void LinkSnapshot::AddOption(StringPiece value) {
+  options_.Add(value);
+}
+
+void LinkSnapshot::AddInput(const std::string& path) {
+  inputs_.emplace_back(HashPath(path), path);
+}
+
+void LinkSnapshot::AddOutput(const std::string& path) {
+  outputs_.push_back(path);
+}
+
+std::string LinkSnapshot::HashPath(const std::string& path) {
+  const file::FileType type = file::GetFileType(path);
+  if (type == file::FileType::kNonExistant) {
+    return kMissingDigest;
+  }
+
+  Sha256 digest;
+  if (type == file::FileType::kDirectory) {
+    std::optional<std::vector<std::string>> files = file::FindFiles(path, diag_);
+    if (!files) {
+      return kMissingDigest;
+    }
+    std::sort(files->begin(), files->end());
+    for (const std::string& file : files.value()) {
+      const std::string file_digest = HashPath(file::BuildPath({path, file}));
+      digest.Update(file);
+      digest.Update(StringPiece("\0", 1));
+      digest.Update(file_digest);
+      digest.Update(StringPiece("\0", 1));
+    }
+    return digest.FinishHex();
+  }
+
+  std::string contents;
+  if (!android::base::ReadFileToString(path, &contents, true /*follow_symlinks*/)) {
+    return kMissingDigest;
+  }
+  digest.Update(contents);
+  return digest.FinishHex();
+}
+
+std::string LinkSnapshot::GetRecordPath(StringPiece name) const {
+  return file::BuildPath({dir_, name});
+}
+
+std::string LinkSnapshot::GetIdsPath() const {
+  return GetRecordPath(kIdsRecord);
+}
+
+std::string LinkSnapshot::BuildKey() {
+  if (key_.empty()) {
+    options_.Add(kSnapshotFormatVersion).Add(util::GetToolFingerprint());
+    for (const auto& [digest, path] : inputs_) {
+      options_.Add(path).Add(digest);
+    }
+    key_ = options_.Build();
+  }
+  return key_;
+}
+
+bool LinkSnapshot::IsUpToDate(std::vector<std::string>* out_changed_inputs) {
+  std::string recorded_key;
+  std::vector<std::pair<std::string, std::string>> recorded_inputs;
+  if (!ReadRecord(GetRecordPath(kInputsRecord), &recorded_key, &recorded_inputs)) {
+    return false;
+  }
+
+  if (recorded_key != BuildKey()) {
+    for (const auto& input : inputs_) {
+      if (std::find(recorded_inputs.begin(), recorded_inputs.end(), input) ==
+          recorded_inputs.end()) {
+        out_changed_inputs->push_back(input.second);
+      }
+    }
+    return false;
+  }
+
+  std::string recorded_version;
+  std::vector<std::pair<std::string, std::string>> recorded_outputs;
+  if (!ReadRecord(GetRecordPath(kOutputsRecord), &recorded_version, &recorded_outputs) ||
+      recorded_version != key_ || recorded_outputs.size() != outputs_.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < outputs_.size(); i++) {
+    const auto& [digest, path] = recorded_outputs[i];
+    if (path != outputs_[i] || digest == kMissingDigest || HashPath(path) != digest) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool LinkSnapshot::Save() {
+  std::vector<std::pair<std::string, std::string>> outputs;
+  for (const std::string& path : outputs_) {
+    outputs.emplace_back(HashPath(path), path);
+  }
+
+  // The outputs are written first and tagged with the key, so that a link that stops in between
+  // leaves a snapshot that no longer matches any link.
+  const std::string key = BuildKey();
+  if (!WriteRecord(GetRecordPath(kOutputsRecord), key, outputs) ||
+      !WriteRecord(GetRecordPath(kInputsRecord), key, inputs_)) {
+    diag_->Warn(android::DiagMessage(dir_) << "failed to write incremental link snapshot: "
+                                           << strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+}  // namespace aapt
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef AAPT_LINK_LINKSNAPSHOT_H
+#define AAPT_LINK_LINKSNAPSHOT_H
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "android-base/macros.h"
+#include "androidfw/IDiagnostics.h"
+#include "androidfw/StringPiece.h"
+#include "compile/CompileCache.h"
+
+namespace aapt {
+
+// A record of the previous aapt2 link into the same outputs, kept in a directory between runs.
+// It holds a digest of every option and input of that link, the digests of the files it wrote and
+// the resource IDs it assigned.
+//
+// A link whose options and inputs match the snapshot, and whose outputs were not touched since,
+// can be skipped entirely. A link that does run can start from the previous IDs, so that the IDs
+// of resources that did not change stay the same.
+class LinkSnapshot {
+ public:
+  // Creates the snapshot directory if needed. Returns nullptr and logs an error on failure.
+  static std::unique_ptr<LinkSnapshot> Open(const std::string& dir, android::IDiagnostics* diag);
+
+  // Adds a value that affects the output of the link, such as a command line argument.
+  void AddOption(android::StringPiece value);
+
+  // Adds a file or directory read by the link. Directories are hashed recursively. A path that
+  // does not exist is recorded as missing.
+  void AddInput(const std::string& path);
+
+  // Adds a file or directory written by the link.
+  void AddOutput(const std::string& path);
+
+  // Returns true if the previous link had the same options and inputs, and every output it wrote
+  // is still as it left it. Otherwise the inputs that differ from the previous link, if one was
+  // recorded, are added to out_changed_inputs.
+  bool IsUpToDate(std::vector<std::string>* out_changed_inputs);
+
+  // The file, in the --stable-ids format, that holds the resource IDs of the previous link.
+  std::string GetIdsPath() const;
+
+  // Records the options, inputs and the current state of the outputs. Must be called after the
+  // link wrote its outputs and its IDs.
+  bool Save();
+
+ private:
+  LinkSnapshot(std::string dir, android::IDiagnostics* diag)
+      : dir_(std::move(dir)), diag_(diag) {
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(LinkSnapshot);
+
+  std::string HashPath(const std::string& path);
+  std::string GetRecordPath(android::StringPiece name) const;
+  std::string BuildKey();
+
+  const std::string dir_;
+  android::IDiagnostics* diag_;
+  CompileCache::KeyBuilder options_;
+  std::vector<std::pair<std::string, std::string>> inputs_;
+  std::vector<std::string> outputs_;
+  std::string key_;
+};
+
+}  // namespace aapt
+
+#endif  // AAPT_LINK_LINKSNAPSHOT_H
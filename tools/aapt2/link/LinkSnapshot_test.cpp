@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "link/LinkSnapshot.h"
+
+#include "android-base/file.h"
+#include "test/Test.h"
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::NotNull;
+
+namespace aapt {
+
+namespace {
+
+class LinkSnapshotTest : public TestDirectoryFixture {
+ protected:
+  std::unique_ptr<LinkSnapshot> OpenSnapshot() {
+    std::unique_ptr<LinkSnapshot> snapshot =
+        LinkSnapshot::Open(GetTestPath("snapshot"), test::GetDiagnostics());
+    if (snapshot != nullptr) {
+      snapshot->AddOption("--manifest");
+      snapshot->AddInput(GetTestPath("input.flat"));
+      snapshot->AddInput(GetTestPath("assets"));
+      snapshot->AddOutput(GetTestPath("out.apk"));
+    }
+    return snapshot;
+  }
+};
+
+}  // namespace
+
+TEST_F(LinkSnapshotTest, UpToDateOnlyAfterSave) {
+  WriteFile(GetTestPath("input.flat"), "compiled");
+  WriteFile(GetTestPath("assets/a.txt"), "asset");
+
+  std::unique_ptr<LinkSnapshot> snapshot = OpenSnapshot();
+  ASSERT_THAT(snapshot, NotNull());
+  std::vector<std::string> changed;
+  EXPECT_FALSE(snapshot->IsUpToDate(&changed));
+  EXPECT_THAT(changed, IsEmpty());
+
+  WriteFile(GetTestPath("out.apk"), "apk");
+  ASSERT_TRUE(snapshot->Save());
+
+  snapshot = OpenSnapshot();
+  ASSERT_THAT(snapshot, NotNull());
+  EXPECT_TRUE(snapshot->IsUpToDate(&changed));
+}
+
+TEST_F(LinkSnapshotTest, ChangedInputsAreReported) {
+  WriteFile(GetTestPath("input.flat"), "compiled");
+  WriteFile(GetTestPath("assets/a.txt"), "asset");
+  WriteFile(GetTestPath("out.apk"), "apk");
+  ASSERT_TRUE(OpenSnapshot()->Save());
+
+  WriteFile(GetTestPath("assets/a.txt"), "modified asset");
+
+  std::unique_ptr<LinkSnapshot> snapshot = OpenSnapshot();
+  std::vector<std::string> changed;
+  EXPECT_FALSE(snapshot->IsUpToDate(&changed));
+  EXPECT_THAT(changed, ElementsAre(GetTestPath("assets")));
+}
+
+TEST_F(LinkSnapshotTest, ModifiedOutputsAreNotUpToDate) {
+  WriteFile(GetTestPath("input.flat"), "compiled");
+  WriteFile(GetTestPath("assets/a.txt"), "asset");
+  WriteFile(GetTestPath("out.apk"), "apk");
+  ASSERT_TRUE(OpenSnapshot()->Save());
+
+  WriteFile(GetTestPath("out.apk"), "something else");
+
+  std::vector<std::string> changed;
+  EXPECT_FALSE(OpenSnapshot()->IsUpToDate(&changed));
+  EXPECT_THAT(changed, IsEmpty());
+}
+
+TEST_F(LinkSnapshotTest, DifferentOptionsAreNotUpToDate) {
+  WriteFile(GetTestPath("input.flat"), "compiled");
+  WriteFile(GetTestPath("out.apk"), "apk");
+  ASSERT_TRUE(OpenSnapshot()->Save());
+
+  std::unique_ptr<LinkSnapshot> snapshot = OpenSnapshot();
+  snapshot->AddOption("--no-auto-version");
+  std::vector<std::string> changed;
+  EXPECT_FALSE(snapshot->IsUpToDate(&changed));
+}
+
+}  // namespace aapt
@@ -21,6 +21,7 @@
 #include <algorithm>
 
 #include "ResourceTable.h"
+#include "trace/TraceBuffer.h"
 
 using android::ConfigDescription;
 
@@ -65,6 +66,7 @@ static bool KeepResource(const std::unique_ptr<ResourceEntry>& entry, int minSdk
 }
 
 bool NoDefaultResourceRemover::Consume(IAaptContext* context, ResourceTable* table) {
+  TRACE_CALL();
   for (auto& pkg : table->packages) {
     for (auto& type : pkg->types) {
       // Gather the entries without defaults that must be removed
@@ -22,6 +22,7 @@
 #include "android-base/logging.h"
 
 #include "ResourceTable.h"
+#include "trace/TraceBuffer.h"
 
 namespace aapt {
 
@@ -56,6 +57,7 @@ OutputIterator move_if(InputContainer& input_container, OutputIterator result, P
 }
 
 bool PrivateAttributeMover::Consume(IAaptContext* context, ResourceTable* table) {
+  TRACE_CALL();
   for (auto& package : table->packages) {
     ResourceTableType* type = package->FindTypeWithDefaultName(ResourceType::kAttr);
     if (!type) {
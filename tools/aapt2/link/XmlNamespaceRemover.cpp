@@ -19,6 +19,7 @@
 #include <algorithm>
 
 #include "ResourceTable.h"
+#include "trace/TraceBuffer.h"
 
 namespace aapt {
 
@@ -50,6 +51,7 @@ class XmlVisitor : public xml::Visitor {
 }  // namespace
 
 bool XmlNamespaceRemover::Consume(IAaptContext* context, xml::XmlResource* resource) {
+  TRACE_CALL();
   if (!resource->root) {
     return false;
   }
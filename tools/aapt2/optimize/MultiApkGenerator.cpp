@@ -17,12 +17,14 @@
 #include "MultiApkGenerator.h"
 
 #include <algorithm>
+#include <atomic>
 #include <regex>
 #include <string>
 
 #include "androidfw/ConfigDescription.h"
 #include "androidfw/StringPiece.h"
 
+#include "Diagnostics.h"
 #include "LoadedApk.h"
 #include "ResourceUtils.h"
 #include "ValueVisitor.h"
@@ -36,6 +38,7 @@
 #include "process/IResourceTableConsumer.h"
 #include "split/TableSplitter.h"
 #include "util/Files.h"
+#include "util/ThreadPool.h"
 #include "xml/XmlDom.h"
 #include "xml/XmlUtil.h"
 
@@ -49,12 +52,16 @@ using ::android::ConfigDescription;
 using ::android::StringPiece;
 
 /**
- * Context wrapper that allows the min Android SDK value to be overridden.
+ * Context wrapper that allows the min Android SDK value and the diagnostics to be overridden.
  */
 class ContextWrapper : public IAaptContext {
  public:
   explicit ContextWrapper(IAaptContext* context)
-      : context_(context), min_sdk_(context_->GetMinSdkVersion()) {
+      : ContextWrapper(context, context->GetDiagnostics()) {
+  }
+
+  ContextWrapper(IAaptContext* context, android::IDiagnostics* diagnostics)
+      : context_(context), diagnostics_(diagnostics), min_sdk_(context_->GetMinSdkVersion()) {
   }
 
   PackageType GetPackageType() override {
@@ -69,7 +76,7 @@ class ContextWrapper : public IAaptContext {
     if (source_diag_) {
       return source_diag_.get();
     }
-    return context_->GetDiagnostics();
+    return diagnostics_;
   }
 
   const std::string& GetCompilationPackage() override {
@@ -97,8 +104,8 @@ class ContextWrapper : public IAaptContext {
   }
 
   void SetSource(const std::string& source) {
-    source_diag_ = util::make_unique<android::SourcePathDiagnostics>(android::Source{source},
-                                                                     context_->GetDiagnostics());
+    source_diag_ =
+        util::make_unique<android::SourcePathDiagnostics>(android::Source{source}, diagnostics_);
   }
 
   const std::set<std::string>& GetSplitNameDependencies() override {
@@ -107,6 +114,7 @@ class ContextWrapper : public IAaptContext {
 
  private:
   IAaptContext* context_;
+  android::IDiagnostics* diagnostics_;
   std::unique_ptr<android::SourcePathDiagnostics> source_diag_;
 
   int min_sdk_ = -1;
@@ -130,14 +138,9 @@ bool MultiApkGenerator::FromBaseApk(const MultiApkGeneratorOptions& options) {
   std::unordered_set<std::string> artifacts_to_keep = options.kept_artifacts;
   std::unordered_set<std::string> filtered_artifacts;
   std::unordered_set<std::string> kept_artifacts;
+  std::vector<const OutputArtifact*> artifacts;
 
-  // For now, just write out the stripped APK since ABI splitting doesn't modify anything else.
   for (const OutputArtifact& artifact : options.apk_artifacts) {
-    FilterChain filters;
-
-    ContextWrapper wrapped_context{context_};
-    wrapped_context.SetSource(artifact.name);
-
     if (!options.kept_artifacts.empty()) {
       const auto& it = artifacts_to_keep.find(artifact.name);
       if (it == artifacts_to_keep.end()) {
@@ -152,43 +155,57 @@ bool MultiApkGenerator::FromBaseApk(const MultiApkGeneratorOptions& options) {
         kept_artifacts.insert(artifact.name);
       }
     }
+    artifacts.push_back(&artifact);
+  }
 
-    std::unique_ptr<ResourceTable> table =
-        FilterTable(context_, artifact, *apk_->GetResourceTable(), &filters);
-    if (!table) {
-      return false;
-    }
-
-    android::IDiagnostics* diag = wrapped_context.GetDiagnostics();
-
-    std::unique_ptr<XmlResource> manifest;
-    if (!UpdateManifest(artifact, &manifest, diag)) {
-      diag->Error(android::DiagMessage()
-                  << "could not update AndroidManifest.xml for output artifact");
-      return false;
-    }
+  if (!artifacts.empty() && !file::mkdirs(options.out_dir)) {
+    context_->GetDiagnostics()->Warn(android::DiagMessage()
+                                     << "could not create out dir: " << options.out_dir);
+  }
 
-    std::string out = options.out_dir;
-    if (!file::mkdirs(out)) {
-      diag->Warn(android::DiagMessage() << "could not create out dir: " << out);
+  // Artifacts are generated concurrently, each from its own copy of the resource table. Their
+  // diagnostics are buffered and replayed in the order of the configuration.
+  struct ArtifactJob {
+    explicit ArtifactJob(android::IDiagnostics* target) : diagnostics(target) {
     }
-    file::AppendPath(&out, artifact.name);
 
-    if (context_->IsVerbose()) {
-      diag->Note(android::DiagMessage() << "Generating split: " << out);
-    }
+    BufferedDiagnostics diagnostics;
+    bool succeeded = true;
+  };
 
-    std::unique_ptr<IArchiveWriter> writer = CreateZipFileArchiveWriter(diag, out);
+  // Load the table before any thread needs it, it may be parsed lazily.
+  const ResourceTable* table = apk_->GetResourceTable();
+  if (table == nullptr) {
+    return false;
+  }
 
-    if (context_->IsVerbose()) {
-      diag->Note(android::DiagMessage() << "Writing output: " << out);
+  std::vector<std::unique_ptr<ArtifactJob>> jobs;
+  std::atomic<bool> failed = false;
+  {
+    size_t thread_count = options.jobs == 0 ? ThreadPool::GetDefaultThreadCount() : options.jobs;
+    ThreadPool pool(std::min(thread_count, artifacts.size()));
+    for (const OutputArtifact* artifact : artifacts) {
+      jobs.push_back(util::make_unique<ArtifactJob>(context_->GetDiagnostics()));
+      ArtifactJob* job = jobs.back().get();
+      pool.Post([this, &options, &failed, table, artifact, job] {
+        // Like a serial run, do not start on more artifacts once one of them failed.
+        if (failed) {
+          return;
+        }
+        job->succeeded = GenerateArtifact(options, *artifact, *table, &job->diagnostics);
+        if (!job->succeeded) {
+          failed = true;
+        }
+      });
     }
+    pool.Wait();
+  }
 
-    filters.AddFilter(util::make_unique<SignatureFilter>());
-    if (!apk_->WriteToArchive(&wrapped_context, table.get(), options.table_flattener_options,
-                              &filters, writer.get(), manifest.get())) {
-      return false;
-    }
+  for (const std::unique_ptr<ArtifactJob>& job : jobs) {
+    job->diagnostics.Replay();
+  }
+  if (failed) {
+    return false;
   }
 
   // Make sure all of the requested artifacts were valid. If there are any kept artifacts left,
@@ -221,6 +238,49 @@ bool MultiApkGenerator::FromBaseApk(const MultiApkGeneratorOptions& options) {
   return true;
 }
 
+bool MultiApkGenerator::GenerateArtifact(const MultiApkGeneratorOptions& options,
+                                         const OutputArtifact& artifact,
+                                         const ResourceTable& base_table,
+                                         android::IDiagnostics* diagnostics) {
+  FilterChain filters;
+
+  // FilterTable() sets the artifact as the source of the messages it reports itself.
+  ContextWrapper job_context{context_, diagnostics};
+  ContextWrapper wrapped_context{context_, diagnostics};
+  wrapped_context.SetSource(artifact.name);
+
+  std::unique_ptr<ResourceTable> table = FilterTable(&job_context, artifact, base_table, &filters);
+  if (!table) {
+    return false;
+  }
+
+  android::IDiagnostics* diag = wrapped_context.GetDiagnostics();
+
+  std::unique_ptr<XmlResource> manifest;
+  if (!UpdateManifest(artifact, &manifest, diag)) {
+    diag->Error(android::DiagMessage()
+                << "could not update AndroidManifest.xml for output artifact");
+    return false;
+  }
+
+  std::string out = options.out_dir;
+  file::AppendPath(&out, artifact.name);
+
+  if (context_->IsVerbose()) {
+    diag->Note(android::DiagMessage() << "Generating split: " << out);
+  }
+
+  std::unique_ptr<IArchiveWriter> writer = CreateZipFileArchiveWriter(diag, out);
+
+  if (context_->IsVerbose()) {
+    diag->Note(android::DiagMessage() << "Writing output: " << out);
+  }
+
+  filters.AddFilter(util::make_unique<SignatureFilter>());
+  return apk_->WriteToArchive(&wrapped_context, table.get(), options.table_flattener_options,
+                              &filters, writer.get(), manifest.get());
+}
+
 std::unique_ptr<ResourceTable> MultiApkGenerator::FilterTable(IAaptContext* context,
                                                               const OutputArtifact& artifact,
                                                               const ResourceTable& old_table,
@@ -34,6 +34,9 @@ struct MultiApkGeneratorOptions {
   std::vector<configuration::OutputArtifact> apk_artifacts;
   TableFlattenerOptions table_flattener_options;
   std::unordered_set<std::string> kept_artifacts;
+  // Number of artifacts generated at the same time, 0 uses one thread per CPU core. Every artifact
+  // in progress holds its own copy of the resource table.
+  size_t jobs = 1;
 };
 
 /**
@@ -61,6 +64,14 @@ class MultiApkGenerator {
     return context_->GetDiagnostics();
   }
 
+  /**
+   * Filters the base table for the artifact and writes its APK. May be called from several threads
+   * at once, reports to `diagnostics` only.
+   */
+  bool GenerateArtifact(const MultiApkGeneratorOptions& options,
+                        const configuration::OutputArtifact& artifact,
+                        const ResourceTable& base_table, android::IDiagnostics* diagnostics);
+
   bool UpdateManifest(const configuration::OutputArtifact& artifact,
                       std::unique_ptr<xml::XmlResource>* updated_manifest,
                       android::IDiagnostics* diag);
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Runs the config-collapsing optimizations over a synthetic table in which every entry has
+// 200 configurations, e.g.
+//   aapt2_benchmarks --benchmark_filter=ResourceDeduper
+
+#include <memory>
+#include <string>
+
+#include "android-base/stringprintf.h"
+#include "benchmark/benchmark.h"
+
+#include "ResourceTable.h"
+#include "optimize/ResourceDeduper.h"
+#include "optimize/VersionCollapser.h"
+#include "test/Test.h"
+
+using ::android::ConfigDescription;
+using ::android::base::StringPrintf;
+
+namespace aapt {
+
+namespace {
+
+constexpr int kEntryCount = 20;
+constexpr int kConfigsPerEntry = 200;
+constexpr int kStyleItemCount = 30;
+constexpr int kMinSdk = 21;
+
+// Styles of the same variant are equal, so a quarter of the values of an entry match the default.
+std::unique_ptr<Style> MakeStyle(int variant) {
+  test::StyleBuilder builder;
+  builder.SetParent("android:style/Parent");
+  for (int i = 0; i < kStyleItemCount; i++) {
+    builder.AddItem(StringPrintf("android:attr/attr%d", i),
+                    ResourceUtils::TryParseInt(std::to_string(i + variant)));
+  }
+  return builder.Build();
+}
+
+// Every entry has a default value plus one value per mobile country code.
+std::unique_ptr<ResourceTable> BuildMccTable() {
+  test::ResourceTableBuilder builder;
+  for (int e = 0; e < kEntryCount; e++) {
+    const std::string name = StringPrintf("android:style/Style%d", e);
+    builder.AddValue(name, ConfigDescription{}, ResourceId{}, MakeStyle(0));
+    for (int c = 1; c < kConfigsPerEntry; c++) {
+      builder.AddValue(name, test::ParseConfigOrDie(StringPrintf("mcc%d", 200 + c)), ResourceId{},
+                       MakeStyle(c % 4));
+    }
+  }
+  return builder.Build();
+}
+
+// Every entry has 40 mobile country codes at 5 SDK levels each, three of them below kMinSdk.
+std::unique_ptr<ResourceTable> BuildVersionedTable() {
+  constexpr const char* kVersions[] = {"", "-v14", "-v17", "-v21", "-v24"};
+  constexpr int kVersionCount = sizeof(kVersions) / sizeof(kVersions[0]);
+  test::ResourceTableBuilder builder;
+  for (int e = 0; e < kEntryCount; e++) {
+    const std::string name = StringPrintf("android:style/Style%d", e);
+    for (int c = 0; c < kConfigsPerEntry; c++) {
+      const std::string config =
+          StringPrintf("mcc%d%s", 200 + c / kVersionCount, kVersions[c % kVersionCount]);
+      builder.AddValue(name, test::ParseConfigOrDie(config), ResourceId{}, MakeStyle(c % 4));
+    }
+  }
+  return builder.Build();
+}
+
+template <typename Consumer>
+void RunConsumer(benchmark::State& state, std::unique_ptr<ResourceTable> (*build_table)()) {
+  std::unique_ptr<IAaptContext> context =
+      test::ContextBuilder().SetMinSdkVersion(kMinSdk).Build();
+  std::unique_ptr<ResourceTable> table;
+  for (auto _ : state) {
+    state.PauseTiming();
+    table = build_table();
+    state.ResumeTiming();
+
+    Consumer consumer;
+    bool result = consumer.Consume(context.get(), table.get());
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+void BM_ResourceDeduper(benchmark::State& state) {
+  RunConsumer<ResourceDeduper>(state, BuildMccTable);
+}
+BENCHMARK(BM_ResourceDeduper)->Unit(benchmark::kMillisecond);
+
+void BM_VersionCollapser(benchmark::State& state) {
+  RunConsumer<VersionCollapser>(state, BuildVersionedTable);
+}
+BENCHMARK(BM_VersionCollapser)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+}  // namespace aapt
+
+BENCHMARK_MAIN();
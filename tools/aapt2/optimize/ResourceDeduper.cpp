@@ -17,6 +17,8 @@
 #include "optimize/ResourceDeduper.h"
 
 #include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "DominatorTree.h"
 #include "ResourceTable.h"
@@ -28,6 +30,9 @@ namespace aapt {
 
 namespace {
 
+// The hash of every value of an entry, computed once before the values are compared.
+using ValueHashes = std::unordered_map<const ResourceConfigValue*, size_t>;
+
 /**
  * Remove duplicated key-value entries from dominated resources.
  *
@@ -43,8 +48,8 @@ class DominatedKeyValueRemover : public DominatorTree::BottomUpVisitor {
  public:
   using Node = DominatorTree::Node;
 
-  explicit DominatedKeyValueRemover(IAaptContext* context, ResourceEntry* entry)
-      : context_(context), entry_(entry) {}
+  DominatedKeyValueRemover(IAaptContext* context, ResourceEntry* entry, const ValueHashes* hashes)
+      : context_(context), entry_(entry), hashes_(hashes) {}
 
   void VisitConfig(Node* node) {
     Node* parent = node->parent();
@@ -56,7 +61,7 @@ class DominatedKeyValueRemover : public DominatorTree::BottomUpVisitor {
     if (!node_value || !parent_value) {
       return;
     }
-    if (!node_value->value->Equals(parent_value->value.get())) {
+    if (!ValuesEqual(node_value, parent_value)) {
       return;
     }
 
@@ -70,7 +75,7 @@ class DominatedKeyValueRemover : public DominatorTree::BottomUpVisitor {
         continue;
       }
       if (node_configuration.IsCompatibleWith(sibling_value->config) &&
-          !node_value->value->Equals(sibling_value->value.get())) {
+          !ValuesEqual(node_value, sibling_value)) {
         // The configurations are compatible, but the value is
         // different, so we can't remove this value.
         return;
@@ -89,13 +94,38 @@ class DominatedKeyValueRemover : public DominatorTree::BottomUpVisitor {
  private:
   DISALLOW_COPY_AND_ASSIGN(DominatedKeyValueRemover);
 
+  // Values with different hashes can never be equal, so Equals() only runs on hash matches.
+  bool ValuesEqual(const ResourceConfigValue* a, const ResourceConfigValue* b) const {
+    return hashes_->at(a) == hashes_->at(b) && a->value->Equals(b->value.get());
+  }
+
   IAaptContext* context_;
   ResourceEntry* entry_;
+  const ValueHashes* hashes_;
 };
 
 static void DedupeEntry(IAaptContext* context, ResourceEntry* entry) {
+  // A value is only removed when another configuration holds an equal value. Bucket the values by
+  // hash first: when every bucket holds a single value, nothing can be removed and the dominator
+  // tree is never built.
+  ValueHashes hashes;
+  hashes.reserve(entry->values.size());
+  std::unordered_set<size_t> buckets;
+  bool has_candidates = false;
+  for (const auto& config_value : entry->values) {
+    if (!config_value->value) {
+      return;
+    }
+    const size_t hash = config_value->value->Hash();
+    hashes.emplace(config_value.get(), hash);
+    has_candidates |= !buckets.insert(hash).second;
+  }
+  if (!has_candidates) {
+    return;
+  }
+
   DominatorTree tree(entry->values);
-  DominatedKeyValueRemover remover(context, entry);
+  DominatedKeyValueRemover remover(context, entry, &hashes);
   tree.Accept(&remover);
 
   // Erase the values that were removed.
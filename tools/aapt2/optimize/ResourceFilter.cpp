@@ -17,6 +17,7 @@
 #include "optimize/ResourceFilter.h"
 
 #include "ResourceTable.h"
+#include "trace/TraceBuffer.h"
 
 namespace aapt {
 
@@ -25,6 +26,7 @@ ResourceFilter::ResourceFilter(const std::unordered_set<ResourceName>& exclude_l
 }
 
 bool ResourceFilter::Consume(IAaptContext* context, ResourceTable* table) {
+  TRACE_CALL();
   for (auto& package : table->packages) {
     for (auto& type : package->types) {
       for (auto it = type->entries.begin(); it != type->entries.end(); ) {
@@ -17,6 +17,7 @@
 #include "optimize/VersionCollapser.h"
 
 #include <algorithm>
+#include <set>
 #include <vector>
 
 #include "ResourceTable.h"
@@ -26,92 +27,34 @@ using android::ConfigDescription;
 
 namespace aapt {
 
-template <typename Iterator, typename Pred>
-class FilterIterator {
- public:
-  FilterIterator(Iterator begin, Iterator end, Pred pred = Pred())
-      : current_(begin), end_(end), pred_(pred) {
-    Advance();
-  }
-
-  bool HasNext() { return current_ != end_; }
-
-  Iterator NextIter() {
-    Iterator iter = current_;
-    ++current_;
-    Advance();
-    return iter;
-  }
-
-  typename Iterator::reference Next() { return *NextIter(); }
-
- private:
-  void Advance() {
-    for (; current_ != end_; ++current_) {
-      if (pred_(*current_)) {
-        return;
-      }
-    }
-  }
-
-  Iterator current_, end_;
-  Pred pred_;
-};
-
-template <typename Iterator, typename Pred>
-FilterIterator<Iterator, Pred> make_filter_iterator(Iterator begin,
-                                                    Iterator end = Iterator(),
-                                                    Pred pred = Pred()) {
-  return FilterIterator<Iterator, Pred>(begin, end, pred);
-}
-
 /**
  * Every Configuration with an SDK version specified that is less than minSdk will be removed. The
  * exception is when there is no exact matching resource for the minSdk. The next smallest one will
  * be kept.
  */
 static void CollapseVersions(IAaptContext* context, int min_sdk, ResourceEntry* entry) {
-  // First look for all sdks less than minSdk.
-  for (auto iter = entry->values.rbegin(); iter != entry->values.rend();
-       ++iter) {
-    // Check if the item was already marked for removal.
-    if (!(*iter)) {
+  // Walk from the highest configuration down. The first configuration with a smaller or equal SDK
+  // level to the minimum MUST be kept, but every other one that differs from it only in SDK version
+  // is overridden by it and removed. Configurations are bucketed by their value without the SDK
+  // version, so each one is visited once instead of rescanning the rest of the entry.
+  std::set<ConfigDescription> kept_configs;
+  for (auto iter = entry->values.rbegin(); iter != entry->values.rend(); ++iter) {
+    const ConfigDescription& config = (*iter)->config;
+    if (config.sdkVersion > min_sdk) {
       continue;
     }
 
-    const ConfigDescription& config = (*iter)->config;
-    if (config.sdkVersion <= min_sdk) {
-      // This is the first configuration we've found with a smaller or equal SDK level to the
-      // minimum. We MUST keep this one, but remove all others we find, which get overridden by this
-      // one.
-
-      ConfigDescription config_without_sdk = config.CopyWithoutSdkVersion();
-      auto pred = [&](const std::unique_ptr<ResourceConfigValue>& val) -> bool {
-        // Check that the value hasn't already been marked for removal.
-        if (!val) {
-          return false;
-        }
-
-        // Only return Configs that differ in SDK version.
-        config_without_sdk.sdkVersion = val->config.sdkVersion;
-        return config_without_sdk == val->config &&
-               val->config.sdkVersion <= min_sdk;
-      };
+    if (kept_configs.insert(config.CopyWithoutSdkVersion()).second) {
+      continue;
+    }
 
-      // Remove the rest that match.
-      auto filter_iter =
-          make_filter_iterator(iter + 1, entry->values.rend(), pred);
-      while (filter_iter.HasNext()) {
-        auto& next = filter_iter.Next();
-        if (context->IsVerbose()) {
-          context->GetDiagnostics()->Note(android::DiagMessage()
-                                          << "removing configuration " << next->config.to_string()
-                                          << " for entry: " << entry->name
-                                          << ", because its SDK version is smaller than minSdk");
-        }
-        next = {};
-      }
+    if (context->IsVerbose()) {
+      context->GetDiagnostics()->Note(android::DiagMessage()
+                                      << "removing configuration " << config.to_string()
+                                      << " for entry: " << entry->name
+                                      << ", because its SDK version is smaller than minSdk");
     }
+    *iter = {};
   }
 
   // Now erase the nullptr values.
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "process/ApkAssetsCache.h"
+
+#include <sys/stat.h>
+
+#include "androidfw/ApkAssets.h"
+#include "trace/TraceBuffer.h"
+
+using ::android::ApkAssets;
+using ::android::StringPiece;
+
+namespace aapt {
+
+ApkAssetsCache* ApkAssetsCache::GetInstance() {
+  static ApkAssetsCache* instance = new ApkAssetsCache();
+  return instance;
+}
+
+void ApkAssetsCache::SetEnabled(bool enabled) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  enabled_ = enabled;
+  if (!enabled) {
+    entries_.clear();
+  }
+}
+
+android::AssetManager2::ApkAssetsPtr ApkAssetsCache::Load(StringPiece path) {
+  TRACE_CALL();
+  const std::string path_str(path);
+  struct stat sb;
+  bool cacheable = stat(path_str.c_str(), &sb) == 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cacheable &= enabled_;
+    if (cacheable) {
+      auto iter = entries_.find(path_str);
+      if (iter != entries_.end() && iter->second.size == sb.st_size &&
+          iter->second.modification_time == sb.st_mtime) {
+        return iter->second.apk_assets;
+      }
+    }
+  }
+
+  // Loaded outside the lock, so that links including different APKs do not wait on each other.
+  // Two links racing on the same new APK both load it and the last one wins the entry.
+  android::AssetManager2::ApkAssetsPtr apk_assets = ApkAssets::Load(path_str);
+  if (apk_assets != nullptr && cacheable) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (enabled_) {
+      entries_[path_str] = Entry{sb.st_size, sb.st_mtime, apk_assets};
+    }
+  }
+  return apk_assets;
+}
+
+}  // namespace aapt
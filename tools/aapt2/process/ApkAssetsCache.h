@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef AAPT_PROCESS_APKASSETSCACHE_H
+#define AAPT_PROCESS_APKASSETSCACHE_H
+
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "android-base/macros.h"
+#include "androidfw/AssetManager2.h"
+#include "androidfw/StringPiece.h"
+
+namespace aapt {
+
+// A process-wide cache of the APKs loaded as include symbol sources, such as android.jar.
+//
+// A single invocation loads each include once anyway, so the cache starts disabled. The daemon
+// enables it so that every link it runs shares the parsed tables. An entry is reused while the
+// size and modification time of its file are unchanged. ApkAssets are immutable once loaded, so
+// they are shared between concurrent links.
+class ApkAssetsCache {
+ public:
+  static ApkAssetsCache* GetInstance();
+
+  void SetEnabled(bool enabled);
+
+  // Loads the APK at `path`, or returns the copy loaded earlier when caching is enabled and the file
+  // has not changed since. Returns nullptr if the APK can not be loaded.
+  android::AssetManager2::ApkAssetsPtr Load(android::StringPiece path);
+
+ private:
+  struct Entry {
+    off_t size;
+    time_t modification_time;
+    android::AssetManager2::ApkAssetsPtr apk_assets;
+  };
+
+  ApkAssetsCache() = default;
+  DISALLOW_COPY_AND_ASSIGN(ApkAssetsCache);
+
+  std::mutex mutex_;
+  bool enabled_ = false;
+  std::map<std::string, Entry> entries_;
+};
+
+}  // namespace aapt
+
+#endif  // AAPT_PROCESS_APKASSETSCACHE_H
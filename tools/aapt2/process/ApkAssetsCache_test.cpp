@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "process/ApkAssetsCache.h"
+
+#include "android-base/file.h"
+#include "test/Test.h"
+#include "util/Files.h"
+
+using ::testing::Eq;
+using ::testing::IsNull;
+using ::testing::Ne;
+using ::testing::NotNull;
+
+namespace aapt {
+
+class ApkAssetsCacheTest : public ::testing::Test {
+ protected:
+  void TearDown() override {
+    ApkAssetsCache::GetInstance()->SetEnabled(false);
+  }
+
+  static std::string GetApkPath() {
+    return file::BuildPath({android::base::GetExecutableDirectory(), "integration-tests",
+                            "DumpTest", "minimal.apk"});
+  }
+};
+
+TEST_F(ApkAssetsCacheTest, LoadsEveryTimeWhenDisabled) {
+  auto first = ApkAssetsCache::GetInstance()->Load(GetApkPath());
+  auto second = ApkAssetsCache::GetInstance()->Load(GetApkPath());
+  ASSERT_THAT(first.get(), NotNull());
+  ASSERT_THAT(second.get(), NotNull());
+  EXPECT_THAT(first.get(), Ne(second.get()));
+}
+
+TEST_F(ApkAssetsCacheTest, ReusesLoadedApkWhenEnabled) {
+  ApkAssetsCache::GetInstance()->SetEnabled(true);
+  auto first = ApkAssetsCache::GetInstance()->Load(GetApkPath());
+  auto second = ApkAssetsCache::GetInstance()->Load(GetApkPath());
+  ASSERT_THAT(first.get(), NotNull());
+  EXPECT_THAT(first.get(), Eq(second.get()));
+}
+
+TEST_F(ApkAssetsCacheTest, MissingApkIsNotCached) {
+  ApkAssetsCache::GetInstance()->SetEnabled(true);
+  const std::string path = GetApkPath() + ".missing";
+  EXPECT_THAT(ApkAssetsCache::GetInstance()->Load(path).get(), IsNull());
+  EXPECT_THAT(ApkAssetsCache::GetInstance()->Load(path).get(), IsNull());
+}
+
+}  // namespace aapt
@@ -30,10 +30,10 @@
 #include "Resource.h"
 #include "ResourceUtils.h"
 #include "ValueVisitor.h"
+#include "process/ApkAssetsCache.h"
 #include "trace/TraceBuffer.h"
 #include "util/Util.h"
 
-using ::android::ApkAssets;
 using ::android::ConfigDescription;
 using ::android::StringPiece;
 using ::android::StringPiece16;
@@ -42,9 +42,7 @@ namespace aapt {
 
 SymbolTable::SymbolTable(NameMangler* mangler)
     : mangler_(mangler),
-      delegate_(util::make_unique<DefaultSymbolTableDelegate>()),
-      cache_(200),
-      id_cache_(200) {
+      delegate_(util::make_unique<DefaultSymbolTableDelegate>()) {
 }
 
 void SymbolTable::SetDelegate(std::unique_ptr<ISymbolTableDelegate> delegate) {
@@ -52,7 +50,7 @@ void SymbolTable::SetDelegate(std::unique_ptr<ISymbolTableDelegate> delegate) {
   delegate_ = std::move(delegate);
 
   // Clear the cache in case this delegate changes the order of lookup.
-  cache_.clear();
+  cache_.Clear();
 }
 
 void SymbolTable::AppendSource(std::unique_ptr<ISymbolSource> source) {
@@ -67,7 +65,7 @@ void SymbolTable::PrependSource(std::unique_ptr<ISymbolSource> source) {
 
   // We must clear the cache in case we did a lookup before adding this
   // resource.
-  cache_.clear();
+  cache_.Clear();
 }
 
 const SymbolTable::Symbol* SymbolTable::FindByName(const ResourceName& name) {
@@ -83,7 +81,7 @@ const SymbolTable::Symbol* SymbolTable::FindByName(const ResourceName& name) {
   }
 
   // We store the name unmangled in the cache, so look it up as-is.
-  if (const std::shared_ptr<Symbol>& s = cache_.get(*name_with_package)) {
+  if (std::shared_ptr<Symbol> s = cache_.Get(*name_with_package)) {
     return s.get();
   }
 
@@ -101,17 +99,15 @@ const SymbolTable::Symbol* SymbolTable::FindByName(const ResourceName& name) {
     return nullptr;
   }
 
-  // Take ownership of the symbol into a shared_ptr. We do this because
-  // LruCache doesn't support unique_ptr.
-  std::shared_ptr<Symbol> shared_symbol(std::move(symbol));
-
   // Since we look in the cache with the unmangled, but package prefixed
-  // name, we must put the same name into the cache.
-  cache_.put(*name_with_package, shared_symbol);
+  // name, we must put the same name into the cache. Another thread may have
+  // cached the same name meanwhile, in which case its symbol is kept.
+  std::shared_ptr<Symbol> shared_symbol =
+      cache_.Put(*name_with_package, std::shared_ptr<Symbol>(std::move(symbol)));
 
   if (shared_symbol->id) {
     // The symbol has an ID, so we can also cache this!
-    id_cache_.put(shared_symbol->id.value(), shared_symbol);
+    id_cache_.Put(shared_symbol->id.value(), shared_symbol);
   }
 
   // Returns the raw pointer. Callers are not expected to hold on to this
@@ -120,7 +116,7 @@ const SymbolTable::Symbol* SymbolTable::FindByName(const ResourceName& name) {
 }
 
 const SymbolTable::Symbol* SymbolTable::FindById(const ResourceId& id) {
-  if (const std::shared_ptr<Symbol>& s = id_cache_.get(id)) {
+  if (std::shared_ptr<Symbol> s = id_cache_.Get(id)) {
     return s.get();
   }
 
@@ -130,10 +126,8 @@ const SymbolTable::Symbol* SymbolTable::FindById(const ResourceId& id) {
     return nullptr;
   }
 
-  // Take ownership of the symbol into a shared_ptr. We do this because LruCache
-  // doesn't support unique_ptr.
-  std::shared_ptr<Symbol> shared_symbol(std::move(symbol));
-  id_cache_.put(id, shared_symbol);
+  std::shared_ptr<Symbol> shared_symbol =
+      id_cache_.Put(id, std::shared_ptr<Symbol>(std::move(symbol)));
 
   // Returns the raw pointer. Callers are not expected to hold on to this
   // between calls to Find*.
@@ -220,9 +214,11 @@ std::unique_ptr<SymbolTable::Symbol> ResourceTableSymbolSource::FindByName(
 
 bool AssetManagerSymbolSource::AddAssetPath(StringPiece path) {
   TRACE_CALL();
-  if (auto apk = ApkAssets::Load(path.data())) {
+  if (auto apk = ApkAssetsCache::GetInstance()->Load(path)) {
     apk_assets_.push_back(std::move(apk));
     asset_manager_.SetApkAssets(apk_assets_);
+    name_index_.clear();
+    name_index_built_ = false;
     return true;
   }
   return false;
@@ -318,8 +314,51 @@ static std::unique_ptr<SymbolTable::Symbol> LookupAttributeInTable(
   return s;
 }
 
+static std::optional<ResourceName> GetResourceName(android::AssetManager2& am, ResourceId id) {
+  auto name = am.GetResourceName(id.id);
+  if (!name.has_value()) {
+    return {};
+  }
+  return ResourceUtils::ToResourceName(*name);
+}
+
+void AssetManagerSymbolSource::BuildNameIndex() {
+  TRACE_CALL();
+  std::unordered_map<std::string, uint8_t> assigned_ids;
+  asset_manager_.ForEachPackage([&](const std::string& package_name, uint8_t id) -> bool {
+    assigned_ids.emplace(package_name, id);
+    return true;
+  });
+
+  for (const auto& assets : apk_assets_) {
+    for (const std::unique_ptr<const android::LoadedPackage>& package :
+         assets->GetLoadedArsc()->GetPackages()) {
+      auto assigned_id = assigned_ids.find(package->GetPackageName());
+      if (assigned_id == assigned_ids.end()) {
+        continue;
+      }
+
+      for (uint32_t res_id : *package) {
+        // Shared libraries are compiled with package ID 0, use the ID assigned at runtime instead.
+        res_id = (res_id & 0x00ffffffu) | (static_cast<uint32_t>(assigned_id->second) << 24);
+        std::optional<ResourceName> res_name = GetResourceName(asset_manager_, ResourceId(res_id));
+        if (res_name) {
+          // Keep the first definition, as AssetManager2 would when looking up the name.
+          name_index_.emplace(std::move(res_name.value()), res_id);
+        }
+      }
+    }
+  }
+  name_index_built_ = true;
+}
+
 std::unique_ptr<SymbolTable::Symbol> AssetManagerSymbolSource::FindByName(
     const ResourceName& name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!name_index_built_) {
+    BuildNameIndex();
+  }
+
   const std::string mangled_entry = NameMangler::MangleEntry(name.package, name.entry);
 
   bool found = false;
@@ -336,12 +375,17 @@ std::unique_ptr<SymbolTable::Symbol> AssetManagerSymbolSource::FindByName(
       real_name.package = package_name;
     }
 
-    auto real_res_id = asset_manager_.GetResourceId(real_name.to_string());
-    if (!real_res_id.has_value()) {
+    auto real_res_id = name_index_.find(real_name);
+    if (real_res_id == name_index_.end() && real_name.type.type == ResourceType::kAttr) {
+      // Private attributes are looked up as public ones, see AssetManager2::GetResourceId.
+      real_res_id = name_index_.find(
+          ResourceName(real_name.package, ResourceType::kAttrPrivate, real_name.entry));
+    }
+    if (real_res_id == name_index_.end()) {
       return true;
     }
 
-    res_id.id = *real_res_id;
+    res_id.id = real_res_id->second;
     if (!res_id.is_valid_static()) {
       return true;
     }
@@ -377,16 +421,9 @@ std::unique_ptr<SymbolTable::Symbol> AssetManagerSymbolSource::FindByName(
   return {};
 }
 
-static std::optional<ResourceName> GetResourceName(android::AssetManager2& am, ResourceId id) {
-  auto name = am.GetResourceName(id.id);
-  if (!name.has_value()) {
-    return {};
-  }
-  return ResourceUtils::ToResourceName(*name);
-}
-
 std::unique_ptr<SymbolTable::Symbol> AssetManagerSymbolSource::FindById(
     ResourceId id) {
+  std::lock_guard<std::mutex> lock(mutex_);
   if (!id.is_valid_static()) {
     // Exit early and avoid the error logs from AssetManager.
     return {};
@@ -18,14 +18,15 @@
 #define AAPT_PROCESS_SYMBOLTABLE_H
 
 #include <algorithm>
+#include <array>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include "android-base/macros.h"
 #include "androidfw/Asset.h"
 #include "androidfw/AssetManager2.h"
-#include "utils/JenkinsHash.h"
-#include "utils/LruCache.h"
 
 #include "Resource.h"
 #include "ResourceTable.h"
@@ -34,19 +35,6 @@
 
 namespace aapt {
 
-inline android::hash_t hash_type(const ResourceName& name) {
-  std::hash<std::string> str_hash;
-  android::hash_t hash = 0;
-  hash = android::JenkinsHashMix(hash, (uint32_t)str_hash(name.package));
-  hash = android::JenkinsHashMix(hash, (uint32_t)str_hash(name.type.name));
-  hash = android::JenkinsHashMix(hash, (uint32_t)str_hash(name.entry));
-  return hash;
-}
-
-inline android::hash_t hash_type(const ResourceId& id) {
-  return android::hash_type(id.id);
-}
-
 class ISymbolSource;
 class ISymbolTableDelegate;
 class NameMangler;
@@ -86,29 +74,72 @@ class SymbolTable {
   // cause the existing cache to be cleared.
   void PrependSource(std::unique_ptr<ISymbolSource> source);
 
-  // NOTE: Never hold on to the result between calls to FindByXXX. The
-  // results are stored in a cache which may evict entries on subsequent calls.
+  // The FindByXXX methods may be called from several threads at once, as long as no source is
+  // added and the delegate is not changed meanwhile, and the sources are not modified.
+  //
+  // NOTE: Never hold on to the result after adding a source or changing the delegate. The
+  // results are stored in a cache which is cleared when that happens.
   const Symbol* FindByName(const ResourceName& name);
 
-  // NOTE: Never hold on to the result between calls to FindByXXX. The
-  // results are stored in a cache which may evict entries on subsequent calls.
+  // NOTE: Never hold on to the result after adding a source or changing the delegate. The
+  // results are stored in a cache which is cleared when that happens.
   const Symbol* FindById(const ResourceId& id);
 
   // Let's the ISymbolSource decide whether looking up by name or ID is faster,
   // if both are available.
-  // NOTE: Never hold on to the result between calls to FindByXXX. The
-  // results are stored in a cache which may evict entries on subsequent calls.
+  // NOTE: Never hold on to the result after adding a source or changing the delegate. The
+  // results are stored in a cache which is cleared when that happens.
   const Symbol* FindByReference(const Reference& ref);
 
  private:
+  // A map from lookup keys to symbols, split into shards that each have their own lock so that
+  // lookups from concurrent link passes rarely contend. An entry is never replaced once added,
+  // which keeps the pointers handed out by FindByXXX valid until Clear().
+  template <typename Key>
+  class ShardedCache {
+   public:
+    std::shared_ptr<Symbol> Get(const Key& key) {
+      Shard& shard = GetShard(key);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto iter = shard.symbols.find(key);
+      return iter != shard.symbols.end() ? iter->second : nullptr;
+    }
+
+    // Adds `symbol` unless `key` was cached meanwhile, and returns the cached symbol.
+    std::shared_ptr<Symbol> Put(const Key& key, std::shared_ptr<Symbol> symbol) {
+      Shard& shard = GetShard(key);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      return shard.symbols.emplace(key, std::move(symbol)).first->second;
+    }
+
+    void Clear() {
+      for (Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.symbols.clear();
+      }
+    }
+
+   private:
+    static constexpr size_t kShardCount = 16;
+
+    struct Shard {
+      std::mutex mutex;
+      std::unordered_map<Key, std::shared_ptr<Symbol>> symbols;
+    };
+
+    Shard& GetShard(const Key& key) {
+      return shards_[std::hash<Key>()(key) % kShardCount];
+    }
+
+    std::array<Shard, kShardCount> shards_;
+  };
+
   NameMangler* mangler_;
   std::unique_ptr<ISymbolTableDelegate> delegate_;
   std::vector<std::unique_ptr<ISymbolSource>> sources_;
 
-  // We use shared_ptr because unique_ptr is not supported and
-  // we need automatic deletion.
-  android::LruCache<ResourceName, std::shared_ptr<Symbol>> cache_;
-  android::LruCache<ResourceId, std::shared_ptr<Symbol>> id_cache_;
+  ShardedCache<ResourceName> cache_;
+  ShardedCache<ResourceId> id_cache_;
 
   DISALLOW_COPY_AND_ASSIGN(SymbolTable);
 };
@@ -147,7 +178,7 @@ class DefaultSymbolTableDelegate : public ISymbolTableDelegate {
 };
 
 // An interface that a symbol source implements in order to surface symbol information
-// to the symbol table.
+// to the symbol table. Lookups must be safe to call from several threads at once.
 class ISymbolSource {
  public:
   virtual ~ISymbolSource() = default;
@@ -207,9 +238,21 @@ class AssetManagerSymbolSource : public ISymbolSource {
   }
 
  private:
+  // Fills name_index_ from every package of the loaded APKs. Called with mutex_ held.
+  void BuildNameIndex();
+
   std::vector<android::AssetManager2::ApkAssetsPtr> apk_assets_;
   android::AssetManager2 asset_manager_;
 
+  // Guards asset_manager_ and name_index_ during lookups, AssetManager2 is not thread-safe.
+  std::mutex mutex_;
+
+  // The ID of every resource of the loaded APKs, built in one pass on the first lookup by name.
+  // Names that are not defined, such as the mangled names probed in every package, then miss in a
+  // hash lookup instead of a search through the package's key strings and entries.
+  std::unordered_map<ResourceName, uint32_t> name_index_;
+  bool name_index_built_ = false;
+
   DISALLOW_COPY_AND_ASSIGN(AssetManagerSymbolSource);
 };
 
@@ -16,6 +16,8 @@
 
 #include "process/SymbolTable.h"
 
+#include <thread>
+
 #include "SdkConstants.h"
 #include "androidfw/BigBuffer.h"
 #include "format/binary/TableFlattener.h"
@@ -76,6 +78,38 @@ TEST(SymbolTableTest, FindByName) {
   EXPECT_THAT(symbol_table.FindByName(test::ParseNameOrDie("com.android.lib:id/foo")), NotNull());
 }
 
+TEST(SymbolTableTest, ConcurrentLookupsShareCachedSymbols) {
+  std::unique_ptr<ResourceTable> table =
+      test::ResourceTableBuilder()
+          .AddSimple("com.android.app:id/foo", ResourceId(0x7f010000))
+          .AddSimple("com.android.app:id/bar", ResourceId(0x7f010001))
+          .Build();
+
+  NameMangler mangler(NameManglerPolicy{"com.android.app"});
+  SymbolTable symbol_table(&mangler);
+  symbol_table.AppendSource(util::make_unique<ResourceTableSymbolSource>(table.get()));
+
+  const SymbolTable::Symbol* foo[8] = {};
+  const SymbolTable::Symbol* missing[8] = {};
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 8; i++) {
+    threads.emplace_back([&, i]() {
+      foo[i] = symbol_table.FindByName(test::ParseNameOrDie("com.android.app:id/foo"));
+      missing[i] = symbol_table.FindByName(test::ParseNameOrDie("com.android.app:id/baz"));
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_THAT(foo[0], NotNull());
+  for (size_t i = 0; i < 8; i++) {
+    EXPECT_THAT(foo[i], Eq(foo[0]));
+    EXPECT_THAT(missing[i], IsNull());
+  }
+  EXPECT_THAT(symbol_table.FindById(ResourceId(0x7f010000)), Eq(foo[0]));
+}
+
 using SymbolTableTestFixture = CommandTestFixture;
 TEST_F(SymbolTableTestFixture, FindByNameWhenSymbolIsMangledInResTable) {
   using namespace android;
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// Replaces the global allocation functions of the aapt2 binary to count how many allocations
+// each thread makes, which the trace events report. Only linked into the binary and not into
+// libaapt2, so the tests and other users of the library keep the default allocator.
+// The over-aligned overloads are left alone, they are rare and pair with their own deletes.
+
+#include <cstdlib>
+#include <new>
+
+#include "trace/TraceBuffer.h"
+
+namespace {
+
+void* Allocate(std::size_t size) noexcept {
+  aapt::tracebuffer::thread_allocations++;
+  if (size == 0) {
+    size = 1;
+  }
+  while (true) {
+    if (void* ptr = std::malloc(size)) {
+      return ptr;
+    }
+    std::new_handler handler = std::get_new_handler();
+    if (handler == nullptr) {
+      return nullptr;
+    }
+    handler();
+  }
+}
+
+void* AllocateOrAbort(std::size_t size) {
+  void* ptr = Allocate(size);
+  if (ptr == nullptr) {
+    // Exceptions are disabled, so there is no std::bad_alloc to throw.
+    std::abort();
+  }
+  return ptr;
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  return AllocateOrAbort(size);
+}
+
+void* operator new[](std::size_t size) {
+  return AllocateOrAbort(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return Allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return Allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+  std::free(ptr);
+}
@@ -16,13 +16,22 @@
 
 #include "TraceBuffer.h"
 
+#include <algorithm>
 #include <chrono>
+#include <ctime>
+#include <map>
+#include <mutex>
 #include <sstream>
 #include <unistd.h>
 #include <vector>
 
 #include <inttypes.h>
 
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "android-base/threads.h"
 #include "android-base/utf8.h"
 
 #include "util/Files.h"
@@ -30,6 +39,8 @@
 namespace aapt {
 namespace tracebuffer {
 
+constinit thread_local uint64_t thread_allocations = 0;
+
 namespace {
 
 constexpr char kBegin = 'B';
@@ -37,12 +48,26 @@ constexpr char kEnd = 'E';
 
 struct TracePoint {
   char type;
-  pid_t tid;
+  pid_t pid;
+  uint64_t tid;
   int64_t time;
   std::string tag;
+  // Set on the end event of scoped traces, holds the usage accumulated while it was open.
+  bool has_usage = false;
+  Trace::Sample usage = {};
+};
+
+// Totals of all the scoped events sharing a name, for the summary table.
+struct Summary {
+  uint64_t calls = 0;
+  int64_t wall_us = 0;
+  Trace::Sample usage = {};
 };
 
+// Guards traces, summaries and startTime, compile jobs may run on several threads at once.
+std::mutex traces_lock;
 std::vector<TracePoint> traces;
+std::map<std::string, Summary, std::less<>> summaries;
 bool enabled = true;
 constinit std::chrono::steady_clock::time_point startTime = {};
 
@@ -55,12 +80,97 @@ int64_t GetTime() noexcept {
 }
 
 void AddWithTime(std::string tag, char type, int64_t time) noexcept {
-  TracePoint t = {type, getpid(), time, std::move(tag)};
+  TracePoint t = {type, getpid(), android::base::GetThreadId(), time, std::move(tag)};
   traces.emplace_back(std::move(t));
 }
 
-void Add(std::string tag, char type) noexcept {
-  AddWithTime(std::move(tag), type, GetTime());
+int64_t Add(std::string tag, char type) noexcept {
+  std::lock_guard<std::mutex> lock(traces_lock);
+  int64_t time = GetTime();
+  AddWithTime(std::move(tag), type, time);
+  return time;
+}
+
+int64_t GetThreadCpuTime() {
+#ifdef _WIN32
+  return 0;
+#else
+  timespec ts = {};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return int64_t(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+int64_t GetPeakRss() {
+#ifdef _WIN32
+  return 0;
+#else
+  rusage usage = {};
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;  // Reported in bytes instead of kilobytes.
+#else
+  return usage.ru_maxrss;
+#endif
+#endif
+}
+
+Trace::Sample SampleUsage() {
+  return {GetThreadCpuTime(), GetPeakRss(), thread_allocations};
+}
+
+void AddWithUsage(std::string tag, size_t name_length, int64_t begin,
+                  const Trace::Sample& start) noexcept {
+  Trace::Sample end = SampleUsage();
+  Trace::Sample usage = {end.cpu_us - start.cpu_us, end.peak_rss_kb - start.peak_rss_kb,
+                         end.allocations - start.allocations};
+
+  std::lock_guard<std::mutex> lock(traces_lock);
+  int64_t time = GetTime();
+  std::string_view name = std::string_view(tag).substr(0, name_length);
+  auto it = summaries.find(name);
+  if (it == summaries.end()) {
+    it = summaries.emplace(std::string(name), Summary{}).first;
+  }
+  Summary& summary = it->second;
+  summary.calls++;
+  summary.wall_us += time - begin;
+  summary.usage.cpu_us += usage.cpu_us;
+  summary.usage.peak_rss_kb += usage.peak_rss_kb;
+  summary.usage.allocations += usage.allocations;
+
+  AddWithTime(std::move(tag), kEnd, time);
+  traces.back().has_usage = true;
+  traces.back().usage = usage;
+}
+
+void FlushSummary(const std::string& basePath) {
+  std::ostringstream s;
+  s << basePath << aapt::file::sDirSep << "summary_aapt2_" << getpid() << ".txt";
+  FILE* f = android::base::utf8::fopen(s.str().c_str(), "a");
+  if (f == nullptr) {
+    return;
+  }
+
+  std::vector<std::pair<std::string_view, const Summary*>> sorted;
+  for (const auto& [name, summary] : summaries) {
+    sorted.emplace_back(name, &summary);
+  }
+  std::stable_sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+    return a.second->wall_us > b.second->wall_us;
+  });
+
+  fprintf(f, "%8s %12s %12s %14s %12s  %s\n", "calls", "wall ms", "cpu ms", "peak rss +kb",
+          "allocs", "name");
+  for (const auto& [name, summary] : sorted) {
+    fprintf(f, "%8" PRIu64 " %12.3f %12.3f %14" PRId64 " %12" PRIu64 "  %.*s\n", summary->calls,
+            summary->wall_us / 1000.0, summary->usage.cpu_us / 1000.0,
+            summary->usage.peak_rss_kb, summary->usage.allocations, int(name.size()),
+            name.data());
+  }
+  fprintf(f, "\n");
+  fclose(f);
+  summaries.clear();
 }
 
 void Flush(const std::string& basePath) {
@@ -68,6 +178,7 @@ void Flush(const std::string& basePath) {
     return;
   }
   BeginTrace(__func__);  // We can't do much here, only record that it happened.
+  std::lock_guard<std::mutex> lock(traces_lock);
 
   std::ostringstream s;
   s << basePath << aapt::file::sDirSep << "report_aapt2_" << getpid() << ".json";
@@ -80,9 +191,17 @@ void Flush(const std::string& basePath) {
   char delimiter = '[';
   for (const TracePoint& trace : traces) {
     fprintf(f,
-            "%c{\"ts\" : \"%" PRIu64
-            "\", \"ph\" : \"%c\", \"tid\" : \"%d\" , \"pid\" : \"%d\", \"name\" : \"%s\" }\n",
-            delimiter, trace.time, trace.type, 0, trace.tid, trace.tag.c_str());
+            "%c{\"ts\" : \"%" PRIu64 "\", \"ph\" : \"%c\", \"tid\" : \"%" PRIu64
+            "\" , \"pid\" : \"%d\", \"name\" : \"%s\"",
+            delimiter, trace.time, trace.type, trace.tid, trace.pid, trace.tag.c_str());
+    if (trace.has_usage) {
+      // Chrome merges the args of an end event into the slice it closes.
+      fprintf(f,
+              ", \"args\" : { \"cpu_us\" : %" PRId64 ", \"peak_rss_delta_kb\" : %" PRId64
+              ", \"allocations\" : %" PRIu64 " }",
+              trace.usage.cpu_us, trace.usage.peak_rss_kb, trace.usage.allocations);
+    }
+    fprintf(f, " }\n");
     delimiter = ',';
   }
   if (!traces.empty()) {
@@ -90,10 +209,62 @@ void Flush(const std::string& basePath) {
   }
   fclose(f);
   traces.clear();
+
+  FlushSummary(basePath);
 }
 
 }  // namespace
 
+std::string FunctionName(std::string_view pretty_function) {
+  constexpr std::string_view kAnonymous = "(anonymous";
+  constexpr std::string_view kOperatorCall = "operator()";
+
+  // The parameter list is the first parenthesis outside of template arguments that is neither
+  // an anonymous scope nor part of operator().
+  size_t start = 0;
+  size_t end = pretty_function.size();
+  int angle_depth = 0;
+  for (size_t i = 0; i < pretty_function.size(); i++) {
+    char c = pretty_function[i];
+    if (c == '<') {
+      angle_depth++;
+    } else if (c == '>') {
+      angle_depth--;
+    } else if (angle_depth == 0 && c == ' ') {
+      start = i + 1;
+    } else if (angle_depth == 0 && c == '(') {
+      if (pretty_function.substr(i).starts_with(kAnonymous)) {
+        i = std::min(pretty_function.find(')', i), pretty_function.size());
+        continue;
+      }
+      if (i + 2 <= pretty_function.size() &&
+          pretty_function.substr(0, i + 2).ends_with(kOperatorCall)) {
+        i++;
+        continue;
+      }
+      end = i;
+      break;
+    }
+  }
+  if (start > end) {
+    start = 0;
+  }
+  std::string_view name = pretty_function.substr(start, end - start);
+  while (!name.empty() && (name.front() == '*' || name.front() == '&')) {
+    name.remove_prefix(1);
+  }
+
+  std::string result(name);
+  constexpr std::string_view kAnonymousNamespace = "(anonymous namespace)::";
+  for (size_t pos; (pos = result.find(kAnonymousNamespace)) != std::string::npos;) {
+    result.erase(pos, kAnonymousNamespace.size());
+  }
+  if (std::string_view(result).starts_with("aapt::")) {
+    result.erase(0, std::string_view("aapt::").size());
+  }
+  return result;
+}
+
 } // namespace tracebuffer
 
 void BeginTrace(std::string tag) {
@@ -110,15 +281,30 @@ bool Trace::enable(bool value) {
   return tracebuffer::enabled = value;
 }
 
+void Trace::Begin() {
+  recording_ = true;
+  start_time_ = tracebuffer::Add(tag_, tracebuffer::kBegin);
+  start_ = tracebuffer::SampleUsage();
+}
+
 Trace::Trace(const char* tag) {
   if (!tracebuffer::enabled) return;
   tag_.assign(tag);
-  tracebuffer::Add(tag_, tracebuffer::kBegin);
+  name_length_ = tag_.size();
+  Begin();
 }
 
 Trace::Trace(std::string tag) : tag_(std::move(tag)) {
   if (!tracebuffer::enabled) return;
-  tracebuffer::Add(tag_, tracebuffer::kBegin);
+  name_length_ = tag_.size();
+  Begin();
+}
+
+Trace::Trace(Function function) {
+  if (!tracebuffer::enabled) return;
+  tag_ = tracebuffer::FunctionName(function.pretty_function);
+  name_length_ = tag_.size();
+  Begin();
 }
 
 template <class SpanOfStrings>
@@ -137,19 +323,20 @@ std::string makeTag(std::string_view tag, const SpanOfStrings& args) {
 Trace::Trace(std::string_view tag, const std::vector<android::StringPiece>& args) {
   if (!tracebuffer::enabled) return;
   tag_ = makeTag(tag, args);
-  tracebuffer::Add(tag_, tracebuffer::kBegin);
+  name_length_ = tag.size();
+  Begin();
 }
 
 Trace::~Trace() {
-  if (!tracebuffer::enabled) return;
-  tracebuffer::Add(std::move(tag_), tracebuffer::kEnd);
+  if (!tracebuffer::enabled || !recording_) return;
+  tracebuffer::AddWithUsage(std::move(tag_), name_length_, start_time_, start_);
 }
 
 FlushTrace::FlushTrace(std::string_view basepath, std::string_view tag) {
   if (!Trace::enable(!basepath.empty())) return;
   basepath_.assign(basepath);
   tag_.assign(tag);
-  tracebuffer::Add(tag_, tracebuffer::kBegin);
+  Begin(tag.size());
 }
 
 FlushTrace::FlushTrace(std::string_view basepath, std::string_view tag,
@@ -157,7 +344,7 @@ FlushTrace::FlushTrace(std::string_view basepath, std::string_view tag,
   if (!Trace::enable(!basepath.empty())) return;
   basepath_.assign(basepath);
   tag_ = makeTag(tag, args);
-  tracebuffer::Add(tag_, tracebuffer::kBegin);
+  Begin(tag.size());
 }
 
 FlushTrace::FlushTrace(std::string_view basepath, std::string_view tag,
@@ -165,12 +352,18 @@ FlushTrace::FlushTrace(std::string_view basepath, std::string_view tag,
   if (!Trace::enable(!basepath.empty())) return;
   basepath_.assign(basepath);
   tag_ = makeTag(tag, args);
-  tracebuffer::Add(tag_, tracebuffer::kBegin);
+  Begin(tag.size());
+}
+
+void FlushTrace::Begin(size_t name_length) {
+  name_length_ = name_length;
+  start_time_ = tracebuffer::Add(tag_, tracebuffer::kBegin);
+  start_ = tracebuffer::SampleUsage();
 }
 
 FlushTrace::~FlushTrace() {
   if (!tracebuffer::enabled) return;
-  tracebuffer::Add(std::move(tag_), tracebuffer::kEnd);
+  tracebuffer::AddWithUsage(std::move(tag_), name_length_, start_time_, start_);
   tracebuffer::Flush(basepath_);
 }
 
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "trace/TraceBuffer.h"
+
+#include "android-base/file.h"
+#include "test/Test.h"
+
+using ::testing::HasSubstr;
+
+namespace aapt {
+
+namespace {
+
+class TracedClass {
+ public:
+  std::string Method(int) {
+    TRACE_CALL();
+    return std::string(64, 'x');
+  }
+};
+
+}  // namespace
+
+TEST(TraceBufferTest, FunctionNameDropsReturnTypeParametersAndNamespaces) {
+  EXPECT_EQ(tracebuffer::FunctionName(
+                "bool aapt::AutoVersioner::Consume(aapt::IAaptContext *, aapt::ResourceTable *)"),
+            "AutoVersioner::Consume");
+  EXPECT_EQ(tracebuffer::FunctionName("void aapt::(anonymous namespace)::Linker::Run() const"),
+            "Linker::Run");
+  EXPECT_EQ(tracebuffer::FunctionName("const std::string &aapt::Foo<int>::Name(int)"),
+            "Foo<int>::Name");
+  EXPECT_EQ(tracebuffer::FunctionName("auto aapt::Foo::operator()(int) const"),
+            "Foo::operator()");
+  EXPECT_EQ(tracebuffer::FunctionName("int main(int, char **)"), "main");
+}
+
+using TraceBufferFlushTest = TestDirectoryFixture;
+
+TEST_F(TraceBufferFlushTest, FlushWritesUsageAndSummary) {
+  {
+    TRACE_FLUSH(GetTestDirectory(), "TraceBufferFlushTest");
+    TracedClass().Method(1);
+    TracedClass().Method(2);
+  }
+  Trace::enable();
+
+  std::string prefix = std::string(GetTestDirectory()) + file::sDirSep;
+  std::string json;
+  ASSERT_TRUE(android::base::ReadFileToString(
+      prefix + "report_aapt2_" + std::to_string(getpid()) + ".json", &json));
+  EXPECT_THAT(json, HasSubstr("\"name\" : \"TracedClass::Method\""));
+  EXPECT_THAT(json, HasSubstr("\"allocations\" : "));
+
+  std::string summary;
+  ASSERT_TRUE(android::base::ReadFileToString(
+      prefix + "summary_aapt2_" + std::to_string(getpid()) + ".txt", &summary));
+  EXPECT_THAT(summary, HasSubstr("peak rss +kb"));
+  EXPECT_THAT(summary, HasSubstr("       2 "));
+  EXPECT_THAT(summary, HasSubstr("  TracedClass::Method\n"));
+  EXPECT_THAT(summary, HasSubstr("  TraceBufferFlushTest\n"));
+}
+
+}  // namespace aapt
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AAPT_UTIL_SHA256_H
+#define AAPT_UTIL_SHA256_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "androidfw/StringPiece.h"
+
+namespace aapt {
+
+// Incrementally computes a SHA-256 digest. Used to build content-addressed keys, not for anything
+// security related.
+class Sha256 {
+ public:
+  Sha256();
+
+  void Update(const void* data, size_t size);
+
+  void Update(android::StringPiece str) {
+    Update(str.data(), str.size());
+  }
+
+  // Finishes the digest and returns it as a lowercase hex string. The object cannot be updated
+  // afterwards.
+  std::string FinishHex();
+
+ private:
+  void ProcessBlock(const uint8_t* block);
+
+  std::array<uint32_t, 8> state_;
+  std::array<uint8_t, 64> buffer_;
+  size_t buffer_size_ = 0;
+  uint64_t total_size_ = 0;
+};
+
+}  // namespace aapt
+
+#endif  // AAPT_UTIL_SHA256_H
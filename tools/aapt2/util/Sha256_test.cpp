@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "util/Sha256.h"
+
+#include <algorithm>
+#include <string>
+
+#include "test/Test.h"
+
+using ::testing::Eq;
+
+namespace aapt {
+
+TEST(Sha256Test, KnownDigests) {
+  Sha256 empty;
+  EXPECT_THAT(empty.FinishHex(),
+              Eq("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+
+  Sha256 abc;
+  abc.Update("abc");
+  EXPECT_THAT(abc.FinishHex(),
+              Eq("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+
+  Sha256 two_blocks;
+  two_blocks.Update("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq");
+  EXPECT_THAT(two_blocks.FinishHex(),
+              Eq("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"));
+}
+
+TEST(Sha256Test, IncrementalUpdatesMatchSingleUpdate) {
+  const std::string input(1000, 'a');
+  Sha256 whole;
+  whole.Update(input);
+
+  Sha256 pieces;
+  for (size_t offset = 0; offset < input.size(); offset += 37) {
+    pieces.Update(input.data() + offset, std::min<size_t>(37, input.size() - offset));
+  }
+  EXPECT_THAT(pieces.FinishHex(), Eq(whole.FinishHex()));
+}
+
+}  // namespace aapt
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "util/SlabAllocator.h"
+
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define AAPT_SLAB_ALLOCATOR_DISABLED 1
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__)
+#define AAPT_SLAB_ALLOCATOR_DISABLED 1
+#endif
+
+namespace aapt {
+
+#ifdef AAPT_SLAB_ALLOCATOR_DISABLED
+
+void* SlabAllocator::Allocate(size_t size) {
+  return ::operator new(size);
+}
+
+void SlabAllocator::Deallocate(void* ptr, size_t size) {
+  ::operator delete(ptr);
+}
+
+#else
+
+namespace {
+
+// Size classes are multiples of the default new alignment, so every object stays aligned.
+constexpr size_t kGranularity = 16;
+constexpr size_t kSizeClassCount = SlabAllocator::kMaxObjectSize / kGranularity;
+constexpr size_t kSlabSize = 256 * 1024;
+// The number of objects moved between a thread and the shared free lists at once.
+constexpr size_t kBatchSize = 64;
+
+struct FreeObject {
+  FreeObject* next;
+};
+
+struct FreeList {
+  FreeObject* head = nullptr;
+  size_t count = 0;
+
+  void Push(void* ptr) {
+    FreeObject* object = static_cast<FreeObject*>(ptr);
+    object->next = head;
+    head = object;
+    count++;
+  }
+
+  void* Pop() {
+    FreeObject* object = head;
+    if (object != nullptr) {
+      head = object->next;
+      count--;
+    }
+    return object;
+  }
+
+  // Moves up to max_count objects to the other list.
+  void MoveTo(FreeList* other, size_t max_count) {
+    for (size_t i = 0; i < max_count && head != nullptr; i++) {
+      other->Push(Pop());
+    }
+  }
+};
+
+// A slab that objects are carved from, front to back.
+struct SlabCursor {
+  uint8_t* next = nullptr;
+  uint8_t* end = nullptr;
+};
+
+// State shared by every thread. Only accessed with the lock held.
+struct SharedState {
+  std::mutex lock;
+  FreeList free_lists[kSizeClassCount];
+  // Keeps every slab reachable, they are never freed.
+  std::vector<void*> slabs;
+  // Used by threads whose cache has already been destroyed.
+  SlabCursor cursor;
+};
+
+SharedState& GetSharedState() {
+  // Deliberately leaked, thread caches flush into it during thread and process exit.
+  static SharedState* state = new SharedState();
+  return *state;
+}
+
+void* CarveObject(SlabCursor* cursor, size_t object_size, SharedState& shared) {
+  if (cursor->next == nullptr || static_cast<size_t>(cursor->end - cursor->next) < object_size) {
+    uint8_t* slab = static_cast<uint8_t*>(::operator new(kSlabSize));
+    shared.slabs.push_back(slab);
+    cursor->next = slab;
+    cursor->end = slab + kSlabSize;
+  }
+  void* object = cursor->next;
+  cursor->next += object_size;
+  return object;
+}
+
+class ThreadCache {
+ public:
+  ~ThreadCache() {
+    SharedState& shared = GetSharedState();
+    std::lock_guard<std::mutex> lock(shared.lock);
+    for (size_t i = 0; i < kSizeClassCount; i++) {
+      free_lists_[i].MoveTo(&shared.free_lists[i], free_lists_[i].count);
+    }
+  }
+
+  void* Allocate(size_t size_class) {
+    FreeList& list = free_lists_[size_class];
+    if (void* object = list.Pop()) {
+      return object;
+    }
+
+    SharedState& shared = GetSharedState();
+    std::lock_guard<std::mutex> lock(shared.lock);
+    shared.free_lists[size_class].MoveTo(&list, kBatchSize);
+    if (void* object = list.Pop()) {
+      return object;
+    }
+    return CarveObject(&cursor_, (size_class + 1) * kGranularity, shared);
+  }
+
+  void Deallocate(void* ptr, size_t size_class) {
+    FreeList& list = free_lists_[size_class];
+    list.Push(ptr);
+    if (list.count > 2 * kBatchSize) {
+      SharedState& shared = GetSharedState();
+      std::lock_guard<std::mutex> lock(shared.lock);
+      list.MoveTo(&shared.free_lists[size_class], kBatchSize);
+    }
+  }
+
+ private:
+  FreeList free_lists_[kSizeClassCount];
+  SlabCursor cursor_;
+};
+
+// Trivially destructible, so it stays readable while other thread_local objects are destroyed.
+thread_local ThreadCache* tls_cache = nullptr;
+thread_local bool tls_cache_destroyed = false;
+
+struct ThreadCacheOwner {
+  ThreadCache cache;
+
+  ThreadCacheOwner() {
+    tls_cache = &cache;
+  }
+
+  ~ThreadCacheOwner() {
+    tls_cache = nullptr;
+    tls_cache_destroyed = true;
+  }
+};
+
+ThreadCache* GetThreadCache() {
+  if (tls_cache == nullptr && !tls_cache_destroyed) {
+    static thread_local ThreadCacheOwner owner;
+  }
+  return tls_cache;
+}
+
+inline size_t GetSizeClass(size_t size) {
+  return size == 0 ? 0 : (size - 1) / kGranularity;
+}
+
+}  // namespace
+
+void* SlabAllocator::Allocate(size_t size) {
+  if (size > kMaxObjectSize) {
+    return ::operator new(size);
+  }
+
+  const size_t size_class = GetSizeClass(size);
+  if (ThreadCache* cache = GetThreadCache()) {
+    return cache->Allocate(size_class);
+  }
+
+  SharedState& shared = GetSharedState();
+  std::lock_guard<std::mutex> lock(shared.lock);
+  if (void* object = shared.free_lists[size_class].Pop()) {
+    return object;
+  }
+  return CarveObject(&shared.cursor, (size_class + 1) * kGranularity, shared);
+}
+
+void SlabAllocator::Deallocate(void* ptr, size_t size) {
+  if (ptr == nullptr) {
+    return;
+  }
+  if (size > kMaxObjectSize) {
+    ::operator delete(ptr);
+    return;
+  }
+
+  const size_t size_class = GetSizeClass(size);
+  if (ThreadCache* cache = GetThreadCache()) {
+    cache->Deallocate(ptr, size_class);
+    return;
+  }
+
+  SharedState& shared = GetSharedState();
+  std::lock_guard<std::mutex> lock(shared.lock);
+  shared.free_lists[size_class].Push(ptr);
+}
+
+#endif  // AAPT_SLAB_ALLOCATOR_DISABLED
+
+}  // namespace aapt
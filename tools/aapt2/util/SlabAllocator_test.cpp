@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "util/SlabAllocator.h"
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "test/Test.h"
+
+using ::testing::Eq;
+
+namespace aapt {
+
+namespace {
+
+struct SmallObject : public SlabAllocated {
+  virtual ~SmallObject() = default;
+  int value = 0;
+};
+
+struct LargerObject : public SmallObject {
+  char payload[200];
+};
+
+}  // namespace
+
+TEST(SlabAllocatorTest, AllocationsAreAlignedAndDistinct) {
+  std::vector<void*> ptrs;
+  for (size_t size = 1; size <= SlabAllocator::kMaxObjectSize; size += 7) {
+    void* ptr = SlabAllocator::Allocate(size);
+    ASSERT_NE(nullptr, ptr);
+    EXPECT_THAT(reinterpret_cast<uintptr_t>(ptr) % alignof(std::max_align_t), Eq(0u));
+    memset(ptr, 0xab, size);
+    ptrs.push_back(ptr);
+  }
+
+  size_t size = 1;
+  for (void* ptr : ptrs) {
+    SlabAllocator::Deallocate(ptr, size);
+    size += 7;
+  }
+}
+
+TEST(SlabAllocatorTest, LargeAllocationsAreSupported) {
+  const size_t size = SlabAllocator::kMaxObjectSize * 4;
+  void* ptr = SlabAllocator::Allocate(size);
+  ASSERT_NE(nullptr, ptr);
+  memset(ptr, 0, size);
+  SlabAllocator::Deallocate(ptr, size);
+}
+
+TEST(SlabAllocatorTest, DerivedObjectsAreDeletedThroughBase) {
+  std::vector<std::unique_ptr<SmallObject>> objects;
+  for (int i = 0; i < 1000; i++) {
+    std::unique_ptr<SmallObject> object;
+    if (i % 2 == 0) {
+      object = std::make_unique<SmallObject>();
+    } else {
+      object = std::make_unique<LargerObject>();
+    }
+    object->value = i;
+    objects.push_back(std::move(object));
+  }
+
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_THAT(objects[i]->value, Eq(i));
+  }
+}
+
+TEST(SlabAllocatorTest, ObjectsCanBeFreedOnAnotherThread) {
+  std::vector<std::unique_ptr<SmallObject>> objects;
+  std::thread producer([&objects] {
+    for (int i = 0; i < 1000; i++) {
+      objects.push_back(std::make_unique<SmallObject>());
+      objects.back()->value = i;
+    }
+  });
+  producer.join();
+
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_THAT(objects[i]->value, Eq(i));
+  }
+  objects.clear();
+
+  // The freed objects are recycled for new allocations on this thread.
+  for (int i = 0; i < 1000; i++) {
+    objects.push_back(std::make_unique<SmallObject>());
+  }
+}
+
+}  // namespace aapt
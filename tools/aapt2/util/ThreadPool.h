@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AAPT_UTIL_THREADPOOL_H
+#define AAPT_UTIL_THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "android-base/macros.h"
+
+namespace aapt {
+
+// A fixed set of worker threads that run posted tasks in FIFO order.
+//
+// A pool created with zero or one thread does not spawn anything and runs each task inline from
+// Post(), so callers can use the same code path for serial and parallel execution.
+class ThreadPool {
+ public:
+  explicit ThreadPool(size_t thread_count);
+
+  // Runs every task that was posted and joins the worker threads.
+  ~ThreadPool();
+
+  void Post(std::function<void()> task);
+
+  // Blocks until every task posted so far has finished running.
+  void Wait();
+
+  size_t GetThreadCount() const {
+    return threads_.empty() ? 1 : threads_.size();
+  }
+
+  // The number of threads to use when the user did not ask for a specific count.
+  static size_t GetDefaultThreadCount();
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ThreadPool);
+
+  void WorkerLoop();
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable task_available_;
+  std::condition_variable idle_;
+  std::deque<std::function<void()>> tasks_;
+  size_t running_ = 0;
+  bool stopping_ = false;
+};
+
+}  // namespace aapt
+
+#endif  // AAPT_UTIL_THREADPOOL_H
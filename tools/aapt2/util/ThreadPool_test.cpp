@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "util/ThreadPool.h"
+
+#include <atomic>
+
+#include "test/Test.h"
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+
+namespace aapt {
+
+TEST(ThreadPoolTest, SingleThreadRunsTasksInline) {
+  ThreadPool pool(1);
+  EXPECT_THAT(pool.GetThreadCount(), Eq(1u));
+
+  std::vector<int> order;
+  for (int i = 0; i < 4; i++) {
+    pool.Post([&order, i] { order.push_back(i); });
+    EXPECT_THAT(order.size(), Eq(static_cast<size_t>(i + 1)));
+  }
+  pool.Wait();
+  EXPECT_THAT(order, ElementsAre(0, 1, 2, 3));
+}
+
+TEST(ThreadPoolTest, WaitBlocksUntilAllTasksFinish) {
+  ThreadPool pool(4);
+  EXPECT_THAT(pool.GetThreadCount(), Eq(4u));
+
+  std::atomic<int> count = 0;
+  for (int i = 0; i < 100; i++) {
+    pool.Post([&count] { count++; });
+  }
+  pool.Wait();
+  EXPECT_THAT(count.load(), Eq(100));
+}
+
+TEST(ThreadPoolTest, DestructorDrainsQueue) {
+  std::atomic<int> count = 0;
+  {
+    ThreadPool pool(3);
+    for (int i = 0; i < 50; i++) {
+      pool.Post([&count] { count++; });
+    }
+  }
+  EXPECT_THAT(count.load(), Eq(50));
+}
+
+}  // namespace aapt
@@ -0,0 +1,601 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "DecisionTable.h"
+
+#include <algorithm>
+#include <climits>
+
+using namespace android;
+
+namespace split {
+
+// "SPDT", followed by the format version.
+static const uint32_t kMagic = 0x54445053u;
+static const uint32_t kVersion = 1;
+
+typedef std::vector<const Rule*> Clause;
+
+DeviceProfile::DeviceProfile()
+: sdkVersion(0)
+, screenDensity(0) {}
+
+DecisionTable::DecisionTable()
+: mClauseCount(0)
+, mWordsPerRow(0) {}
+
+static bool testNumber(const Rule& rule, int value) {
+    if (rule.longArgs.isEmpty()) {
+        return false;
+    }
+
+    switch (rule.op) {
+        case Rule::LESS_THAN:
+            return value < rule.longArgs[0];
+        case Rule::GREATER_THAN:
+            return value > rule.longArgs[0];
+        case Rule::EQUALS:
+            return value == rule.longArgs[0];
+        default:
+            return false;
+    }
+}
+
+// Tests a property that holds a set of strings. LANGUAGE holds exactly one.
+static bool testStrings(const Rule& rule, const Vector<String8>& values) {
+    const size_t argCount = rule.stringArgs.size();
+    switch (rule.op) {
+        case Rule::EQUALS:
+            return argCount > 0 && values.size() == 1 && values[0] == rule.stringArgs[0];
+        case Rule::CONTAINS_ANY:
+            for (size_t i = 0; i < argCount; i++) {
+                if (std::find(values.begin(), values.end(), rule.stringArgs[i]) != values.end()) {
+                    return true;
+                }
+            }
+            return false;
+        case Rule::CONTAINS_ALL:
+            for (size_t i = 0; i < argCount; i++) {
+                if (std::find(values.begin(), values.end(), rule.stringArgs[i]) == values.end()) {
+                    return false;
+                }
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Tests a rule that is not AND_SUBRULES or OR_SUBRULES, ignoring negate. Whichever of
+// number and strings the rule's key does not use is ignored.
+static bool testLeaf(const Rule& rule, int number, const Vector<String8>& strings) {
+    if (rule.op == Rule::ALWAYS_TRUE) {
+        return true;
+    }
+
+    switch (rule.key) {
+        case Rule::SDK_VERSION:
+        case Rule::SCREEN_DENSITY:
+            return testNumber(rule, number);
+        case Rule::LANGUAGE:
+        case Rule::NATIVE_PLATFORM:
+            return testStrings(rule, strings);
+        default:
+            return false;
+    }
+}
+
+bool DecisionTable::evaluateRule(const Rule& rule, const DeviceProfile& device) {
+    bool result;
+    switch (rule.op) {
+        case Rule::AND_SUBRULES:
+        case Rule::OR_SUBRULES: {
+            // An AND is true until a subrule is false, an OR is false until a subrule is true.
+            const bool isAnd = rule.op == Rule::AND_SUBRULES;
+            result = isAnd;
+            const size_t subruleCount = rule.subrules.size();
+            for (size_t i = 0; i < subruleCount; i++) {
+                if (evaluateRule(*rule.subrules[i], device) != isAnd) {
+                    result = !isAnd;
+                    break;
+                }
+            }
+            break;
+        }
+        case Rule::ALWAYS_TRUE:
+            result = true;
+            break;
+        default:
+            switch (rule.key) {
+                case Rule::SDK_VERSION:
+                    result = testNumber(rule, device.sdkVersion);
+                    break;
+                case Rule::SCREEN_DENSITY:
+                    result = testNumber(rule, device.screenDensity);
+                    break;
+                case Rule::LANGUAGE: {
+                    Vector<String8> language;
+                    language.add(device.language);
+                    result = testStrings(rule, language);
+                    break;
+                }
+                case Rule::NATIVE_PLATFORM:
+                    result = testStrings(rule, device.nativePlatforms);
+                    break;
+                default:
+                    result = false;
+                    break;
+            }
+            break;
+    }
+    return rule.negate ? !result : result;
+}
+
+// Adds the tests that must all pass for the clause to pass. Returns false if the rule can not
+// be factored by property, and sets outNeverTrue if the clause can never pass.
+static bool addLeaves(const Rule& rule, Clause& clause, bool& outNeverTrue) {
+    if (rule.op == Rule::AND_SUBRULES && !rule.negate) {
+        const size_t subruleCount = rule.subrules.size();
+        for (size_t i = 0; i < subruleCount; i++) {
+            if (!addLeaves(*rule.subrules[i], clause, outNeverTrue)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    switch (rule.op) {
+        case Rule::ALWAYS_TRUE:
+            outNeverTrue |= rule.negate;
+            return true;
+        case Rule::LESS_THAN:
+        case Rule::GREATER_THAN:
+            if (rule.key != Rule::SDK_VERSION && rule.key != Rule::SCREEN_DENSITY) {
+                return false;
+            }
+            break;
+        case Rule::EQUALS:
+        case Rule::CONTAINS_ANY:
+        case Rule::CONTAINS_ALL:
+            if (rule.key == Rule::NATIVE_PLATFORM) {
+                // The device has a set of native platforms, and only a single CONTAINS_ANY can
+                // be split into one row per platform.
+                if (rule.op != Rule::CONTAINS_ANY || rule.negate) {
+                    return false;
+                }
+                for (const Rule* leaf : clause) {
+                    if (leaf->key == Rule::NATIVE_PLATFORM) {
+                        return false;
+                    }
+                }
+            } else if (rule.key == Rule::LANGUAGE) {
+                // Languages are looked up by value, so are tested as strings.
+            } else if (rule.op != Rule::EQUALS
+                    || (rule.key != Rule::SDK_VERSION && rule.key != Rule::SCREEN_DENSITY)) {
+                return false;
+            }
+            break;
+        default:
+            return false;
+    }
+    clause.push_back(&rule);
+    return true;
+}
+
+static bool collectClauses(const sp<Rule>& rule, std::vector<Clause>& outClauses) {
+    if (rule == NULL) {
+        return false;
+    }
+
+    Vector<sp<Rule> > terms;
+    if (rule->op == Rule::OR_SUBRULES && !rule->negate) {
+        terms = rule->subrules;
+    } else {
+        terms.add(rule);
+    }
+
+    const size_t termCount = terms.size();
+    for (size_t i = 0; i < termCount; i++) {
+        Clause clause;
+        bool neverTrue = false;
+        if (!addLeaves(*terms[i], clause, neverTrue)) {
+            return false;
+        }
+        if (!neverTrue) {
+            outClauses.push_back(clause);
+        }
+    }
+    return true;
+}
+
+// Returns whether every test of key in the clause passes.
+static bool clausePasses(const Clause& clause, Rule::Key key, int number,
+        const Vector<String8>& strings) {
+    for (const Rule* leaf : clause) {
+        if (leaf->key == key && testLeaf(*leaf, number, strings) == leaf->negate) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void addBounds(const Rule& leaf, std::vector<int32_t>& bounds) {
+    // Every test is constant over [x, x + 1) and the ranges either side of it.
+    const int x = leaf.longArgs[0];
+    bounds.push_back(x);
+    if (x < INT_MAX) {
+        bounds.push_back(x + 1);
+    }
+}
+
+static void sortBounds(std::vector<int32_t>& bounds) {
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+}
+
+// A value in the bucket. Bucket 0 can only be empty if its upper bound is INT_MIN.
+static int bucketValue(const std::vector<int32_t>& bounds, size_t bucket) {
+    if (bucket > 0) {
+        return bounds[bucket - 1];
+    }
+    return bounds.empty() || bounds[0] == INT_MIN ? INT_MIN : bounds[0] - 1;
+}
+
+static size_t findBucket(const std::vector<int32_t>& bounds, int value) {
+    return std::upper_bound(bounds.begin(), bounds.end(), value) - bounds.begin();
+}
+
+static inline void setBit(std::vector<uint64_t>& table, size_t words, size_t row, size_t bit) {
+    table[(row * words) + (bit / 64)] |= uint64_t(1) << (bit % 64);
+}
+
+bool DecisionTable::compile(const KeyedVector<String8, sp<Rule> >& rules,
+        DecisionTable* outTable) {
+    DecisionTable table;
+    std::vector<Clause> clauses;
+    const size_t ruleCount = rules.size();
+    for (size_t i = 0; i < ruleCount; i++) {
+        Entry entry;
+        entry.name = rules.keyAt(i);
+        entry.clauseStart = clauses.size();
+        if (!collectClauses(rules.valueAt(i), clauses)) {
+            return false;
+        }
+        entry.clauseEnd = clauses.size();
+        table.mEntries.push_back(entry);
+    }
+
+    // Find the values that the rules tell apart.
+    for (const Clause& clause : clauses) {
+        for (const Rule* leaf : clause) {
+            switch (leaf->key) {
+                case Rule::SDK_VERSION:
+                    addBounds(*leaf, table.mSdkBounds);
+                    break;
+                case Rule::SCREEN_DENSITY:
+                    addBounds(*leaf, table.mDensityBounds);
+                    break;
+                case Rule::LANGUAGE:
+                    for (size_t i = 0; i < leaf->stringArgs.size(); i++) {
+                        table.mLanguages.add(leaf->stringArgs[i]);
+                    }
+                    break;
+                case Rule::NATIVE_PLATFORM:
+                    for (size_t i = 0; i < leaf->stringArgs.size(); i++) {
+                        table.mNativePlatforms.add(leaf->stringArgs[i]);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    sortBounds(table.mSdkBounds);
+    sortBounds(table.mDensityBounds);
+
+    const size_t words = (clauses.size() + 63) / 64;
+    const size_t sdkBuckets = table.mSdkBounds.size() + 1;
+    const size_t densityBuckets = table.mDensityBounds.size() + 1;
+    const size_t languageRows = table.mLanguages.size() + 1;
+    const size_t platformRows = table.mNativePlatforms.size();
+    table.mClauseCount = clauses.size();
+    table.mWordsPerRow = words;
+    table.mSdkTable.assign(sdkBuckets * words, 0);
+    table.mDensityTable.assign(densityBuckets * words, 0);
+    table.mLanguageTable.assign(languageRows * words, 0);
+    table.mNativePlatformTable.assign(platformRows * words, 0);
+    table.mAnyNativePlatform.assign(words, 0);
+
+    const Vector<String8> noStrings;
+    for (size_t c = 0; c < clauses.size(); c++) {
+        const Clause& clause = clauses[c];
+        for (size_t b = 0; b < sdkBuckets; b++) {
+            if (clausePasses(clause, Rule::SDK_VERSION, bucketValue(table.mSdkBounds, b),
+                    noStrings)) {
+                setBit(table.mSdkTable, words, b, c);
+            }
+        }
+
+        for (size_t b = 0; b < densityBuckets; b++) {
+            if (clausePasses(clause, Rule::SCREEN_DENSITY, bucketValue(table.mDensityBounds, b),
+                    noStrings)) {
+                setBit(table.mDensityTable, words, b, c);
+            }
+        }
+
+        // A language that no rule names fails every test of a value.
+        if (clausePasses(clause, Rule::LANGUAGE, 0, noStrings)) {
+            setBit(table.mLanguageTable, words, 0, c);
+        }
+        for (size_t l = 0; l < table.mLanguages.size(); l++) {
+            Vector<String8> language;
+            language.add(table.mLanguages[l]);
+            if (clausePasses(clause, Rule::LANGUAGE, 0, language)) {
+                setBit(table.mLanguageTable, words, l + 1, c);
+            }
+        }
+
+        const Rule* platformRule = NULL;
+        for (const Rule* leaf : clause) {
+            if (leaf->key == Rule::NATIVE_PLATFORM) {
+                platformRule = leaf;
+            }
+        }
+        if (platformRule == NULL) {
+            setBit(table.mAnyNativePlatform, words, 0, c);
+        } else {
+            for (size_t i = 0; i < platformRule->stringArgs.size(); i++) {
+                setBit(table.mNativePlatformTable, words,
+                        table.mNativePlatforms.indexOf(platformRule->stringArgs[i]), c);
+            }
+        }
+    }
+
+    *outTable = table;
+    return true;
+}
+
+Vector<String8> DecisionTable::evaluate(const DeviceProfile& device) const {
+    Vector<String8> matches;
+    if (mEntries.empty()) {
+        return matches;
+    }
+
+    const uint64_t* sdk = row(mSdkTable, findBucket(mSdkBounds, device.sdkVersion));
+    const uint64_t* density = row(mDensityTable,
+            findBucket(mDensityBounds, device.screenDensity));
+    const ssize_t languageIndex = mLanguages.indexOf(device.language);
+    const uint64_t* language = row(mLanguageTable, languageIndex >= 0 ? languageIndex + 1 : 0);
+
+    std::vector<uint64_t> clauses(mAnyNativePlatform);
+    const size_t platformCount = device.nativePlatforms.size();
+    for (size_t i = 0; i < platformCount; i++) {
+        const ssize_t platformIndex = mNativePlatforms.indexOf(device.nativePlatforms[i]);
+        if (platformIndex >= 0) {
+            const uint64_t* platform = row(mNativePlatformTable, platformIndex);
+            for (size_t w = 0; w < mWordsPerRow; w++) {
+                clauses[w] |= platform[w];
+            }
+        }
+    }
+    for (size_t w = 0; w < mWordsPerRow; w++) {
+        clauses[w] &= sdk[w] & density[w] & language[w];
+    }
+
+    for (const Entry& entry : mEntries) {
+        for (uint32_t c = entry.clauseStart; c < entry.clauseEnd; c++) {
+            if (clauses[c / 64] & (uint64_t(1) << (c % 64))) {
+                matches.add(entry.name);
+                break;
+            }
+        }
+    }
+    return matches;
+}
+
+static void writeU32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out.push_back((value >> (i * 8)) & 0xff);
+    }
+}
+
+static void writeU64(std::vector<uint8_t>& out, uint64_t value) {
+    writeU32(out, value & 0xffffffffu);
+    writeU32(out, value >> 32);
+}
+
+static void writeString(std::vector<uint8_t>& out, const String8& str) {
+    writeU32(out, str.size());
+    out.insert(out.end(), str.c_str(), str.c_str() + str.size());
+}
+
+static void writeBounds(std::vector<uint8_t>& out, const std::vector<int32_t>& bounds) {
+    writeU32(out, bounds.size());
+    for (int32_t bound : bounds) {
+        writeU32(out, bound);
+    }
+}
+
+static void writeStrings(std::vector<uint8_t>& out, const SortedVector<String8>& strings) {
+    writeU32(out, strings.size());
+    for (size_t i = 0; i < strings.size(); i++) {
+        writeString(out, strings[i]);
+    }
+}
+
+static void writeRows(std::vector<uint8_t>& out, const std::vector<uint64_t>& rows) {
+    for (uint64_t word : rows) {
+        writeU64(out, word);
+    }
+}
+
+std::vector<uint8_t> DecisionTable::serialize() const {
+    std::vector<uint8_t> out;
+    writeU32(out, kMagic);
+    writeU32(out, kVersion);
+    writeU32(out, mClauseCount);
+    writeBounds(out, mSdkBounds);
+    writeBounds(out, mDensityBounds);
+    writeStrings(out, mLanguages);
+    writeStrings(out, mNativePlatforms);
+    writeRows(out, mSdkTable);
+    writeRows(out, mDensityTable);
+    writeRows(out, mLanguageTable);
+    writeRows(out, mNativePlatformTable);
+    writeRows(out, mAnyNativePlatform);
+    writeU32(out, mEntries.size());
+    for (const Entry& entry : mEntries) {
+        writeString(out, entry.name);
+        writeU32(out, entry.clauseStart);
+        writeU32(out, entry.clauseEnd);
+    }
+    return out;
+}
+
+namespace {
+
+struct Reader {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+
+    // Checks that count items of itemSize bytes remain, before anything is sized to count.
+    bool has(size_t count, size_t itemSize) const {
+        return count <= (size - pos) / itemSize;
+    }
+
+    bool readU32(uint32_t* outValue) {
+        if (!has(1, 4)) {
+            return false;
+        }
+        *outValue = 0;
+        for (int i = 0; i < 4; i++) {
+            *outValue |= uint32_t(data[pos++]) << (i * 8);
+        }
+        return true;
+    }
+
+    bool readU64(uint64_t* outValue) {
+        uint32_t low, high;
+        if (!readU32(&low) || !readU32(&high)) {
+            return false;
+        }
+        *outValue = (uint64_t(high) << 32) | low;
+        return true;
+    }
+
+    bool readString(String8* outStr) {
+        uint32_t length;
+        if (!readU32(&length) || !has(length, 1)) {
+            return false;
+        }
+        *outStr = String8(reinterpret_cast<const char*>(data + pos), length);
+        pos += length;
+        return true;
+    }
+
+    bool readBounds(std::vector<int32_t>* outBounds) {
+        uint32_t count;
+        if (!readU32(&count) || !has(count, 4)) {
+            return false;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t bound;
+            readU32(&bound);
+            if (i > 0 && int32_t(bound) <= outBounds->back()) {
+                return false;
+            }
+            outBounds->push_back(bound);
+        }
+        return true;
+    }
+
+    bool readStrings(SortedVector<String8>* outStrings) {
+        uint32_t count;
+        if (!readU32(&count) || !has(count, 4)) {
+            return false;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            String8 str;
+            // The strings are written in sorted order, and must stay in it for the row numbers.
+            if (!readString(&str) || outStrings->add(str) != ssize_t(i)
+                    || outStrings->size() != i + 1) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool readRows(size_t count, std::vector<uint64_t>* outRows) {
+        if (!has(count, 8)) {
+            return false;
+        }
+        outRows->resize(count);
+        for (size_t i = 0; i < count; i++) {
+            readU64(&(*outRows)[i]);
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+bool DecisionTable::deserialize(const uint8_t* data, size_t size, DecisionTable* outTable) {
+    Reader reader = {data, size, 0};
+    DecisionTable table;
+    uint32_t magic, version;
+    if (!reader.readU32(&magic) || magic != kMagic || !reader.readU32(&version)
+            || version != kVersion || !reader.readU32(&table.mClauseCount)) {
+        return false;
+    }
+    table.mWordsPerRow = (uint64_t(table.mClauseCount) + 63) / 64;
+
+    const size_t words = table.mWordsPerRow;
+    if (!reader.readBounds(&table.mSdkBounds) || !reader.readBounds(&table.mDensityBounds)
+            || !reader.readStrings(&table.mLanguages)
+            || !reader.readStrings(&table.mNativePlatforms)
+            || !reader.readRows((table.mSdkBounds.size() + 1) * words, &table.mSdkTable)
+            || !reader.readRows((table.mDensityBounds.size() + 1) * words, &table.mDensityTable)
+            || !reader.readRows((table.mLanguages.size() + 1) * words, &table.mLanguageTable)
+            || !reader.readRows(table.mNativePlatforms.size() * words,
+                    &table.mNativePlatformTable)
+            || !reader.readRows(words, &table.mAnyNativePlatform)) {
+        return false;
+    }
+
+    uint32_t entryCount;
+    if (!reader.readU32(&entryCount) || !reader.has(entryCount, 12)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < entryCount; i++) {
+        Entry entry;
+        if (!reader.readString(&entry.name) || !reader.readU32(&entry.clauseStart)
+                || !reader.readU32(&entry.clauseEnd) || entry.clauseStart > entry.clauseEnd
+                || entry.clauseEnd > table.mClauseCount) {
+            return false;
+        }
+        table.mEntries.push_back(entry);
+    }
+
+    if (reader.pos != reader.size) {
+        return false;
+    }
+    *outTable = table;
+    return true;
+}
+
+} // namespace split
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef H_ANDROID_SPLIT_DECISION_TABLE
+#define H_ANDROID_SPLIT_DECISION_TABLE
+
+#include "Rule.h"
+
+#include <utils/KeyedVector.h>
+#include <utils/SortedVector.h>
+#include <utils/String8.h>
+#include <utils/Vector.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace split {
+
+// The properties of a device that the generated rules test.
+struct DeviceProfile {
+    DeviceProfile();
+
+    int sdkVersion;
+    int screenDensity;
+    android::String8 language;
+    android::Vector<android::String8> nativePlatforms;
+};
+
+/**
+ * The rules for a set of Split APKs, flattened so that they can be evaluated against many
+ * devices without walking the Rule trees.
+ *
+ * Every rule is split into clauses, the AND_SUBRULES that its top level OR_SUBRULES combines.
+ * The clauses are then factored by property: the SDK version and screen density ranges that the
+ * rules distinguish become buckets, and each bucket, language and native platform has a row with
+ * one bit per clause that it satisfies. Evaluating a device looks up one row per property and
+ * ANDs them together.
+ */
+class DecisionTable {
+public:
+    DecisionTable();
+
+    /**
+     * Compiles the rules, keyed by the name that evaluate() reports for them. Each rule must be
+     * a test of a single property, an AND_SUBRULES of those, or an OR_SUBRULES of either, with
+     * at most one NATIVE_PLATFORM test per AND_SUBRULES, which is what RuleGenerator and
+     * Rule::simplify produce. Returns false for any other rule.
+     */
+    static bool compile(const android::KeyedVector<android::String8, android::sp<Rule> >& rules,
+            DecisionTable* outTable);
+
+    // Returns the names of the rules that the device satisfies.
+    android::Vector<android::String8> evaluate(const DeviceProfile& device) const;
+
+    std::vector<uint8_t> serialize() const;
+    static bool deserialize(const uint8_t* data, size_t size, DecisionTable* outTable);
+
+    // Evaluates the rule tree directly, the reference for what the table computes.
+    static bool evaluateRule(const Rule& rule, const DeviceProfile& device);
+
+private:
+    struct Entry {
+        android::String8 name;
+        uint32_t clauseStart;
+        uint32_t clauseEnd;
+    };
+
+    const uint64_t* row(const std::vector<uint64_t>& rows, size_t index) const {
+        return rows.data() + (index * mWordsPerRow);
+    }
+
+    uint32_t mClauseCount;
+    uint32_t mWordsPerRow;
+
+    // Sorted bucket boundaries. A value falls in the bucket given by the number of boundaries
+    // that are not greater than it.
+    std::vector<int32_t> mSdkBounds;
+    std::vector<int32_t> mDensityBounds;
+
+    // The language rows are offset by one, row 0 is for the languages that no rule names.
+    android::SortedVector<android::String8> mLanguages;
+    android::SortedVector<android::String8> mNativePlatforms;
+
+    std::vector<uint64_t> mSdkTable;
+    std::vector<uint64_t> mDensityTable;
+    std::vector<uint64_t> mLanguageTable;
+    std::vector<uint64_t> mNativePlatformTable;
+    // The clauses that do not test the native platform.
+    std::vector<uint64_t> mAnyNativePlatform;
+
+    std::vector<Entry> mEntries;
+};
+
+} // namespace split
+
+#endif // H_ANDROID_SPLIT_DECISION_TABLE
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "DecisionTable.h"
+
+#include "SplitDescription.h"
+#include "SplitSelector.h"
+#include "TestRules.h"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <utils/KeyedVector.h>
+#include <utils/String8.h>
+#include <utils/Vector.h>
+
+using namespace android;
+using namespace split::test;
+
+namespace split {
+
+static KeyedVector<String8, sp<Rule> > generateRules(const char* const* splitStrs, size_t count) {
+    Vector<SplitDescription> splits;
+    for (size_t i = 0; i < count; i++) {
+        SplitDescription split;
+        EXPECT_TRUE(SplitDescription::parse(String8(splitStrs[i]), &split)) << splitStrs[i];
+        splits.add(split);
+    }
+
+    KeyedVector<String8, sp<Rule> > rules;
+    KeyedVector<SplitDescription, sp<Rule> > splitRules = SplitSelector(splits).getRules();
+    for (size_t i = 0; i < splitRules.size(); i++) {
+        rules.add(splitRules.keyAt(i).toString(), splitRules.valueAt(i));
+    }
+    return rules;
+}
+
+static Vector<String8> evaluateRules(const KeyedVector<String8, sp<Rule> >& rules,
+        const DeviceProfile& device) {
+    Vector<String8> matches;
+    for (size_t i = 0; i < rules.size(); i++) {
+        if (DecisionTable::evaluateRule(*rules.valueAt(i), device)) {
+            matches.add(rules.keyAt(i));
+        }
+    }
+    return matches;
+}
+
+static ::testing::AssertionResult matchesRulesForAllDevices(
+        const KeyedVector<String8, sp<Rule> >& rules, const DecisionTable& table) {
+    const int sdkVersions[] = { 1, 4, 20, 21, 22, 34 };
+    const int densities[] = { 0, 120, 160, 213, 240, 262, 263, 320, 480, 640, 0xfffe };
+    const char* languages[] = { "", "en", "en-US", "fr", "de-DE", "pl" };
+    const char* platforms[][2] = {
+        { NULL, NULL },
+        { "armeabi", NULL },
+        { "armeabi-v7a", "armeabi" },
+        { "arm64-v8a", "armeabi-v7a" },
+        { "x86_64", "x86" },
+    };
+
+    for (int sdkVersion : sdkVersions) {
+        for (int density : densities) {
+            for (const char* language : languages) {
+                for (const auto& platform : platforms) {
+                    DeviceProfile device;
+                    device.sdkVersion = sdkVersion;
+                    device.screenDensity = density;
+                    device.language = String8(language);
+                    for (const char* abi : platform) {
+                        if (abi != NULL) {
+                            device.nativePlatforms.add(String8(abi));
+                        }
+                    }
+
+                    const Vector<String8> expected = evaluateRules(rules, device);
+                    const Vector<String8> actual = table.evaluate(device);
+                    if (expected.size() != actual.size()
+                            || !std::equal(expected.begin(), expected.end(), actual.begin())) {
+                        return ::testing::AssertionFailure()
+                                << "sdk=" << sdkVersion << " density=" << density
+                                << " language=" << language << " platform="
+                                << (platform[0] != NULL ? platform[0] : "") << ": expected "
+                                << expected.size() << " matches, got " << actual.size();
+                    }
+                }
+            }
+        }
+    }
+    return ::testing::AssertionSuccess();
+}
+
+TEST(DecisionTableTest, matchesRulesForSplits) {
+    const char* splits[] = {
+        "hdpi", "xhdpi", "xxhdpi", "anydpi", "mdpi",
+        "en", "fr", "de-rDE", "v21",
+        ":armeabi", ":armeabi-v7a", ":arm64-v8a", ":x86",
+    };
+    KeyedVector<String8, sp<Rule> > rules = generateRules(splits, sizeof(splits) / sizeof(*splits));
+    ASSERT_FALSE(rules.isEmpty());
+
+    DecisionTable table;
+    ASSERT_TRUE(DecisionTable::compile(rules, &table));
+    EXPECT_TRUE(matchesRulesForAllDevices(rules, table));
+}
+
+TEST(DecisionTableTest, matchesRulesCombinedPerApk) {
+    KeyedVector<String8, sp<Rule> > apkRules;
+    sp<Rule> density = new Rule(OrRule()
+            .add(AndRule()
+                    .add(GtRule(Rule::SCREEN_DENSITY, 180))
+                    .add(LtRule(Rule::SCREEN_DENSITY, 263)))
+            .add(GtRule(Rule::SCREEN_DENSITY, 600)));
+    apkRules.add(String8("density.apk"), density);
+
+    sp<Rule> native = new Rule(AndRule()
+            .add(ContainsAnyRule(Rule::NATIVE_PLATFORM, "armeabi-v7a", "arm64-v8a"))
+            .add(GtRule(Rule::SDK_VERSION, 20)));
+    apkRules.add(String8("native.apk"), native);
+
+    Rule notFrench;
+    notFrench.op = Rule::EQUALS;
+    notFrench.key = Rule::LANGUAGE;
+    notFrench.stringArgs.add(String8("fr"));
+    notFrench.negate = true;
+    apkRules.add(String8("language.apk"), new Rule(notFrench));
+
+    apkRules.add(String8("always.apk"), new Rule(AlwaysTrue()));
+
+    DecisionTable table;
+    ASSERT_TRUE(DecisionTable::compile(apkRules, &table));
+    EXPECT_TRUE(matchesRulesForAllDevices(apkRules, table));
+}
+
+TEST(DecisionTableTest, survivesSerialization) {
+    const char* splits[] = { "hdpi", "xhdpi", "en", "fr", ":armeabi", ":x86" };
+    KeyedVector<String8, sp<Rule> > rules = generateRules(splits, sizeof(splits) / sizeof(*splits));
+
+    DecisionTable table;
+    ASSERT_TRUE(DecisionTable::compile(rules, &table));
+    const std::vector<uint8_t> data = table.serialize();
+
+    DecisionTable restored;
+    ASSERT_TRUE(DecisionTable::deserialize(data.data(), data.size(), &restored));
+    EXPECT_TRUE(matchesRulesForAllDevices(rules, restored));
+    EXPECT_EQ(data, restored.serialize());
+
+    for (size_t size = 0; size < data.size(); size++) {
+        EXPECT_FALSE(DecisionTable::deserialize(data.data(), size, &restored)) << size;
+    }
+}
+
+TEST(DecisionTableTest, rejectsRulesThatCanNotBeFactored) {
+    KeyedVector<String8, sp<Rule> > rules;
+    rules.add(String8("a.apk"), new Rule(AndRule()
+            .add(OrRule()
+                    .add(GtRule(Rule::SDK_VERSION, 10))
+                    .add(LtRule(Rule::SCREEN_DENSITY, 5)))));
+
+    DecisionTable table;
+    EXPECT_FALSE(DecisionTable::compile(rules, &table));
+
+    rules.replaceValueFor(String8("a.apk"), new Rule(AndRule()
+            .add(ContainsAnyRule(Rule::NATIVE_PLATFORM, "x86"))
+            .add(ContainsAnyRule(Rule::NATIVE_PLATFORM, "x86_64"))));
+    EXPECT_FALSE(DecisionTable::compile(rules, &table));
+}
+
+} // namespace split
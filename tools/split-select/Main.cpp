@@ -19,6 +19,7 @@
 
 #include "aapt/AaptUtil.h"
 
+#include "DecisionTable.h"
 #include "Grouper.h"
 #include "Rule.h"
 #include "RuleGenerator.h"
@@ -39,10 +40,13 @@ static void usage() {
             "split-select --help\n"
             "split-select --target <config> --base <path/to/apk> [--split <path/to/apk> [...]]\n"
             "split-select --generate --base <path/to/apk> [--split <path/to/apk> [...]]\n"
+            "split-select --generate-table <path/to/table> --base <path/to/apk> [--split <path/to/apk> [...]]\n"
             "\n"
             "  --help                   Displays more information about this program.\n"
             "  --target <config>        Performs the Split APK selection on the given configuration.\n"
             "  --generate               Generates the logic for selecting the Split APK, in JSON format.\n"
+            "  --generate-table <path>  Compiles the logic for selecting the Split APK into a binary\n"
+            "                           decision table, written to <path>.\n"
             "  --base <path/to/apk>     Specifies the base APK, from which all Split APKs must be based off.\n"
             "  --split <path/to/apk>    Includes a Split APK in the selection process.\n"
             "\n"
@@ -60,7 +64,8 @@ static void help() {
             "  Using the flag --generate will emit a JSON encoded tree of rules that must be satisfied in order\n"
             "  to install the given Split APK. Using the flag --target along with the device configuration\n"
             "  will emit the set of Split APKs to install, following the same logic that would have been emitted\n"
-            "  via JSON.\n");
+            "  via JSON. Using the flag --generate-table will compile the same rules into a table that can be\n"
+            "  loaded with DecisionTable::deserialize and evaluated against many devices.\n");
 }
 
 Vector<SplitDescription> select(const SplitDescription& target, const Vector<SplitDescription>& splits) {
@@ -68,7 +73,9 @@ Vector<SplitDescription> select(const SplitDescription& target, const Vector<Spl
     return selector.getBestSplits(target);
 }
 
-void generate(const KeyedVector<String8, Vector<SplitDescription> >& splits, const String8& base) {
+// Returns the rule for each Split APK, other than the base.
+static KeyedVector<String8, sp<Rule> > generateApkRules(
+        const KeyedVector<String8, Vector<SplitDescription> >& splits, const String8& base) {
     Vector<SplitDescription> allSplits;
     const size_t apkSplitCount = splits.size();
     for (size_t i = 0; i < apkSplitCount; i++) {
@@ -77,19 +84,13 @@ void generate(const KeyedVector<String8, Vector<SplitDescription> >& splits, con
     const SplitSelector selector(allSplits);
     KeyedVector<SplitDescription, sp<Rule> > rules(selector.getRules());
 
-    bool first = true;
-    fprintf(stdout, "[\n");
+    KeyedVector<String8, sp<Rule> > apkRules;
     for (size_t i = 0; i < apkSplitCount; i++) {
         if (splits.keyAt(i) == base) {
             // Skip the base.
             continue;
         }
 
-        if (!first) {
-            fprintf(stdout, ",\n");
-        }
-        first = false;
-
         sp<Rule> masterRule = new Rule();
         masterRule->op = Rule::OR_SUBRULES;
         const Vector<SplitDescription>& splitDescriptions = splits[i];
@@ -97,13 +98,48 @@ void generate(const KeyedVector<String8, Vector<SplitDescription> >& splits, con
         for (size_t j = 0; j < splitDescriptionCount; j++) {
             masterRule->subrules.add(rules.valueFor(splitDescriptions[j]));
         }
-        masterRule = Rule::simplify(masterRule);
+        apkRules.add(splits.keyAt(i), Rule::simplify(masterRule));
+    }
+    return apkRules;
+}
+
+void generate(const KeyedVector<String8, Vector<SplitDescription> >& splits, const String8& base) {
+    const KeyedVector<String8, sp<Rule> > apkRules = generateApkRules(splits, base);
+
+    fprintf(stdout, "[\n");
+    const size_t apkCount = apkRules.size();
+    for (size_t i = 0; i < apkCount; i++) {
+        if (i != 0) {
+            fprintf(stdout, ",\n");
+        }
         fprintf(stdout, "  {\n    \"path\": \"%s\",\n    \"rules\": %s\n  }",
-                splits.keyAt(i).c_str(), masterRule->toJson(2).c_str());
+                apkRules.keyAt(i).c_str(), apkRules.valueAt(i)->toJson(2).c_str());
     }
     fprintf(stdout, "\n]\n");
 }
 
+static bool generateTable(const KeyedVector<String8, Vector<SplitDescription> >& splits,
+        const String8& base, const String8& tablePath) {
+    DecisionTable table;
+    if (!DecisionTable::compile(generateApkRules(splits, base), &table)) {
+        fprintf(stderr, "error: the Split APK rules can not be compiled into a table.\n");
+        return false;
+    }
+
+    const std::vector<uint8_t> data = table.serialize();
+    FILE* fp = fopen(tablePath.c_str(), "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "error: unable to open '%s' for writing.\n", tablePath.c_str());
+        return false;
+    }
+    const bool written = fwrite(data.data(), 1, data.size(), fp) == data.size();
+    if (fclose(fp) != 0 || !written) {
+        fprintf(stderr, "error: failed to write '%s'.\n", tablePath.c_str());
+        return false;
+    }
+    return true;
+}
+
 static void removeRuntimeQualifiers(ConfigDescription* outConfig) {
     outConfig->imsi = 0;
     outConfig->orientation = ResTable_config::ORIENTATION_ANY;
@@ -244,6 +280,7 @@ static int main(int argc, char** argv) {
     argv++;
 
     bool generateFlag = false;
+    String8 tablePath;
     String8 targetConfigStr;
     Vector<String8> splitApkPaths;
     String8 baseApkPath;
@@ -284,6 +321,16 @@ static int main(int argc, char** argv) {
             baseApkPath = *argv;
         } else if (arg == "--generate") {
             generateFlag = true;
+        } else if (arg == "--generate-table") {
+            argc--;
+            argv++;
+            if (argc < 1) {
+                fprintf(stderr, "error: missing parameter for --generate-table.\n");
+                usage();
+                return 1;
+            }
+            generateFlag = true;
+            tablePath = *argv;
         } else if (arg == "--help") {
             help();
             return 0;
@@ -363,6 +410,10 @@ static int main(int argc, char** argv) {
                 fprintf(stdout, "%s\n", matchingSplitPaths[i].c_str());
             }
         }
+    } else if (tablePath.size() > 0) {
+        if (!generateTable(apkPathSplitMap, baseApkPath, tablePath)) {
+            return 1;
+        }
     } else {
         generate(apkPathSplitMap, baseApkPath);
     }
@@ -12,6 +12,9 @@ using namespace std;
 
 const bool GENERATE_MAPPING = true;
 
+// Generator parameter that turns on the typed writers, see write_typed_writer().
+const string TYPED_WRITERS_PARAMETER = "typed_writers";
+
 static string
 make_filename(const FileDescriptorProto& file_descriptor)
 {
@@ -73,8 +76,127 @@ write_field(stringstream& text, const FieldDescriptorProto& field, const string&
     text << endl;
 }
 
+/**
+ * Writes the bytes of a fixed-size value, least significant first, as ProtoOutputStream does.
+ */
+static void
+write_fixed_bytes(stringstream& text, const string& value, int size, const string& indent)
+{
+    text << indent << "for (int i = 0; i < " << size << "; i++) {" << endl;
+    text << indent << INDENT << "proto->writeRawByte((uint8_t)(" << value << " >> (8 * i)));"
+            << endl;
+    text << indent << "}" << endl;
+}
+
+/**
+ * Writes an inline writer for a scalar field that emits the field's wire tag, computed here,
+ * and its encoded value directly, skipping the field type dispatch in ProtoOutputStream::write().
+ * The bytes written are the same as ProtoOutputStream::write() would produce. Sub-messages and
+ * packed fields are left to the generic ProtoOutputStream API.
+ */
 static void
-write_message(stringstream& text, const DescriptorProto& message, const string& indent)
+write_typed_writer(stringstream& text, const FieldDescriptorProto& field, const string& indent)
+{
+    if (field.options().packed()) {
+        return;
+    }
+
+    const uint32_t number = (uint32_t)field.number();
+    string type;
+    string varint;
+    int fixed_size = 0;
+    switch (field.type()) {
+        case FieldDescriptorProto::TYPE_INT64:
+            type = "int64_t";
+            varint = "(uint64_t)val";
+            break;
+        case FieldDescriptorProto::TYPE_UINT64:
+            type = "uint64_t";
+            varint = "val";
+            break;
+        case FieldDescriptorProto::TYPE_INT32:
+            type = "int32_t";
+            varint = "(uint32_t)val";
+            break;
+        case FieldDescriptorProto::TYPE_UINT32:
+            type = "uint32_t";
+            varint = "val";
+            break;
+        case FieldDescriptorProto::TYPE_ENUM:
+            type = "int";
+            varint = "(uint32_t)val";
+            break;
+        case FieldDescriptorProto::TYPE_BOOL:
+            type = "bool";
+            varint = "(val ? 1 : 0)";
+            break;
+        case FieldDescriptorProto::TYPE_SINT32:
+            type = "int32_t";
+            varint = "(((uint32_t)val << 1) ^ (uint32_t)(val >> 31))";
+            break;
+        case FieldDescriptorProto::TYPE_SINT64:
+            type = "int64_t";
+            varint = "(((uint64_t)val << 1) ^ (uint64_t)(val >> 63))";
+            break;
+        case FieldDescriptorProto::TYPE_FIXED32:
+            type = "uint32_t";
+            fixed_size = 4;
+            break;
+        case FieldDescriptorProto::TYPE_SFIXED32:
+            type = "int32_t";
+            fixed_size = 4;
+            break;
+        case FieldDescriptorProto::TYPE_FLOAT:
+            type = "float";
+            fixed_size = 4;
+            break;
+        case FieldDescriptorProto::TYPE_FIXED64:
+            type = "uint64_t";
+            fixed_size = 8;
+            break;
+        case FieldDescriptorProto::TYPE_SFIXED64:
+            type = "int64_t";
+            fixed_size = 8;
+            break;
+        case FieldDescriptorProto::TYPE_DOUBLE:
+            type = "double";
+            fixed_size = 8;
+            break;
+        case FieldDescriptorProto::TYPE_STRING:
+        case FieldDescriptorProto::TYPE_BYTES:
+            type = "std::string_view";
+            break;
+        default:
+            return;
+    }
+
+    const string indented = indent + INDENT;
+    text << indent << "inline void write_" << field.name()
+            << "(::android::util::ProtoOutputStream* proto, " << type << " val) {" << endl;
+    if (type == "std::string_view") {
+        text << indented << "proto->writeLengthDelimitedHeader(" << number << ", val.size());"
+                << endl;
+        text << indented << "for (char c : val) {" << endl;
+        text << indented << INDENT << "proto->writeRawByte((uint8_t)c);" << endl;
+        text << indented << "}" << endl;
+    } else if (fixed_size == 0) {
+        text << indented << "proto->writeRawVarint(" << ((number << 3) | 0) << "u);" << endl;
+        text << indented << "proto->writeRawVarint(" << varint << ");" << endl;
+    } else {
+        const int wire_type = fixed_size == 8 ? 1 : 5;
+        const string bits_type = fixed_size == 8 ? "uint64_t" : "uint32_t";
+        text << indented << "proto->writeRawVarint(" << ((number << 3) | wire_type) << "u);"
+                << endl;
+        text << indented << bits_type << " bits;" << endl;
+        text << indented << "memcpy(&bits, &val, sizeof(bits));" << endl;
+        write_fixed_bytes(text, "bits", fixed_size, indented);
+    }
+    text << indent << "}" << endl << endl;
+}
+
+static void
+write_message(stringstream& text, const DescriptorProto& message, const string& indent,
+              bool typed_writers)
 {
     int N;
     const string indented = indent + INDENT;
@@ -91,7 +213,7 @@ write_message(stringstream& text, const DescriptorProto& message, const string&
     // Nested classes
     N = message.nested_type_size();
     for (int i=0; i<N; i++) {
-        write_message(text, message.nested_type(i), indented);
+        write_message(text, message.nested_type(i), indented, typed_writers);
     }
 
     // Fields
@@ -100,6 +222,12 @@ write_message(stringstream& text, const DescriptorProto& message, const string&
         write_field(text, message.field(i), indented);
     }
 
+    if (typed_writers) {
+        for (int i=0; i<N; i++) {
+            write_typed_writer(text, message.field(i), indented);
+        }
+    }
+
     if (GENERATE_MAPPING) {
         N = message.field_size();
         text << indented << "static const int _FIELD_COUNT = " << N << ";" << endl;
@@ -122,6 +250,7 @@ write_message(stringstream& text, const DescriptorProto& message, const string&
 static void write_header_file(const string& request_parameter, CodeGeneratorResponse* response,
                               const FileDescriptorProto& file_descriptor) {
     stringstream text;
+    const bool typed_writers = request_parameter.find(TYPED_WRITERS_PARAMETER) != string::npos;
 
     text << "// Generated by protoc-gen-cppstream. DO NOT MODIFY." << endl;
     text << "// source: " << file_descriptor.name() << endl << endl;
@@ -134,6 +263,15 @@ static void write_header_file(const string& request_parameter, CodeGeneratorResp
     text << "#define " << header << endl;
     text << endl;
 
+    if (typed_writers) {
+        text << "#include <android/util/ProtoOutputStream.h>" << endl;
+        text << "#include <stdint.h>" << endl;
+        text << "#include <string.h>" << endl;
+        text << endl;
+        text << "#include <string_view>" << endl;
+        text << endl;
+    }
+
     vector<string> namespaces = split(file_descriptor.package(), '.');
     for (vector<string>::iterator it = namespaces.begin(); it != namespaces.end(); it++) {
         text << "namespace " << *it << " {" << endl;
@@ -148,7 +286,7 @@ static void write_header_file(const string& request_parameter, CodeGeneratorResp
 
     N = file_descriptor.message_type_size();
     for (size_t i=0; i<N; i++) {
-        write_message(text, file_descriptor.message_type(i), "");
+        write_message(text, file_descriptor.message_type(i), "", typed_writers);
     }
 
     for (vector<string>::reverse_iterator it = namespaces.rbegin(); it != namespaces.rend(); it++) {